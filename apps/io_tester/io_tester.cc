@@ -24,6 +24,8 @@
 #include <seastar/core/future.hh>
 #include <seastar/core/shared_ptr.hh>
 #include <seastar/core/file.hh>
+#include <seastar/core/fstream.hh>
+#include <seastar/core/gate.hh>
 #include <seastar/core/sleep.hh>
 #include <seastar/core/align.hh>
 #include <seastar/core/timer.hh>
@@ -34,7 +36,9 @@
 #include <seastar/core/metrics_api.hh>
 #include <seastar/core/io_intent.hh>
 #include <seastar/util/later.hh>
+#include <seastar/util/short_streams.hh>
 #include <chrono>
+#include <cstring>
 #include <vector>
 #include <boost/range/irange.hpp>
 #include <boost/algorithm/string.hpp>
@@ -60,7 +64,7 @@ static auto random_seed = std::chrono::duration_cast<std::chrono::microseconds>(
 static std::default_random_engine random_generator(random_seed);
 
 class context;
-enum class request_type { seqread, seqwrite, randread, randwrite, append, cpu };
+enum class request_type { seqread, seqwrite, randread, randwrite, append, cpu, trace };
 
 namespace std {
 
@@ -196,6 +200,10 @@ struct job_config {
     // of the disk's cache
     uint64_t file_size;
     uint64_t offset_in_bdev;
+    // trace replay (type: trace): binary trace to replay and how much to
+    // compress the recorded inter-arrival times
+    std::string trace_file;
+    float trace_speedup = 1.0f;
     std::unique_ptr<class_data> gen_class_data();
 };
 
@@ -323,7 +331,7 @@ private:
     }
 
 public:
-    future<> issue_requests(std::chrono::steady_clock::time_point stop) {
+    virtual future<> issue_requests(std::chrono::steady_clock::time_point stop) {
         _start = std::chrono::steady_clock::now();
         return with_scheduling_group(_sg, [this, stop] {
             if (rps() == 0) {
@@ -383,6 +391,7 @@ protected:
             { request_type::randwrite, "RAND WRITE" },
             { request_type::append , "APPEND" },
             { request_type::cpu , "CPU" },
+            { request_type::trace , "TRACE" },
         }[_config.type];;
     }
 
@@ -646,6 +655,117 @@ public:
     }
 };
 
+// Replays a captured block trace instead of generating a synthetic access
+// pattern. The trace is a flat array of little-endian trace_record entries
+// captured from production (offset, size, read/write flag, think time).
+// Requests are issued open-loop at their recorded arrival times, optionally
+// compressed by the configured speedup factor, so queueing at the io_queue
+// behaves the way it did when the trace was taken; the trace wraps around if
+// it is exhausted before the test duration elapses. Every shard replays the
+// same trace against its own file, with offsets folded into the file size.
+class trace_io_class_data : public io_class_data {
+    struct trace_record {
+        uint64_t offset;   // byte offset of the request
+        uint32_t size;     // request length, in bytes
+        uint32_t flags;    // bit 0: write, otherwise read
+        uint64_t think_us; // gap between this request and the next, in usec
+    };
+    static_assert(sizeof(trace_record) == 24, "compact trace records are packed");
+
+    std::vector<trace_record> _trace;
+
+public:
+    trace_io_class_data(job_config cfg) : io_class_data(std::move(cfg)) {}
+
+    future<> do_start(sstring path, directory_entry_type type) override {
+        return io_class_data::do_start(std::move(path), type).then([this] {
+            return load_trace();
+        });
+    }
+
+    future<> issue_requests(std::chrono::steady_clock::time_point stop) override {
+        _start = std::chrono::steady_clock::now();
+        return with_scheduling_group(_sg, [this, stop] {
+            return replay(stop);
+        }).then([this] {
+            _total_duration = std::chrono::steady_clock::now() - _start;
+        });
+    }
+
+private:
+    future<> load_trace() {
+        if (_config.trace_file.empty()) {
+            throw std::runtime_error(format("Job {} has type trace but no trace file", name()));
+        }
+        return open_file_dma(_config.trace_file, open_flags::ro).then([this] (file f) {
+            return do_with(make_file_input_stream(std::move(f)), [this] (input_stream<char>& in) {
+                return util::read_entire_stream_contiguous(in).then([this] (sstring data) {
+                    if (data.empty() || (data.size() % sizeof(trace_record))) {
+                        throw std::runtime_error(format("Trace {} is empty or not a multiple of the record size", _config.trace_file));
+                    }
+                    _trace.resize(data.size() / sizeof(trace_record));
+                    std::memcpy(_trace.data(), data.data(), data.size());
+                }).finally([&in] {
+                    return in.close();
+                });
+            });
+        });
+    }
+
+    future<size_t> issue_request(char* buf, io_intent* intent) override {
+        // never called; replay() drives the requests itself
+        return make_ready_future<size_t>(0);
+    }
+
+    future<size_t> issue_trace_request(const trace_record& rec, char* buf, size_t len) {
+        // fold the production offset into this shard's file, preserving
+        // alignment
+        auto pos = align_down<uint64_t>(rec.offset % (_config.file_size - len + 1), _alignment) + _offset;
+        auto f = (rec.flags & 1) ? _file.dma_write(pos, buf, len, _iop)
+                                 : _file.dma_read(pos, buf, len, _iop);
+        return on_io_completed(std::move(f));
+    }
+
+    future<> replay(std::chrono::steady_clock::time_point stop) {
+        return do_with(gate(), size_t(0), _start, [this, stop] (gate& g, size_t& idx, std::chrono::steady_clock::time_point& due) {
+            return do_until([this, stop] {
+                return std::chrono::steady_clock::now() > stop || requests() > limit();
+            }, [this, stop, &g, &idx, &due] {
+                if (idx == _trace.size()) {
+                    idx = 0;
+                }
+                const auto& rec = _trace[idx++];
+                auto len = std::min<uint64_t>(align_up<uint64_t>(std::max<uint32_t>(rec.size, 1), _alignment), _config.file_size);
+                auto bufptr = allocate_aligned_buffer<char>(len, _alignment);
+                auto buf = bufptr.get();
+                auto start = std::chrono::steady_clock::now();
+                // issue open-loop: the next arrival does not wait for this
+                // request to complete, like in the traced system
+                (void)issue_trace_request(rec, buf, len).then_wrapped([this, start, stop, bufptr = std::move(bufptr), gh = g.hold()] (future<size_t> size_f) {
+                    if (size_f.failed()) {
+                        size_f.ignore_ready_future();
+                        return;
+                    }
+                    auto now = std::chrono::steady_clock::now();
+                    if (now < stop) {
+                        this->add_result(size_f.get0(), std::chrono::duration_cast<std::chrono::microseconds>(now - start));
+                    }
+                });
+                due += std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::micro>(rec.think_us / _config.trace_speedup));
+                auto now = std::chrono::steady_clock::now();
+                if (due > now) {
+                    return _sleep_fn(due, now);
+                }
+                // behind schedule (the disk or the speedup can't keep up);
+                // issue the next request immediately
+                return make_ready_future<>();
+            }).then([&g] {
+                return g.close();
+            });
+        });
+    }
+};
+
 class cpu_class_data : public class_data {
 public:
     cpu_class_data(job_config cfg) : class_data(std::move(cfg)) {}
@@ -673,6 +793,8 @@ public:
 std::unique_ptr<class_data> job_config::gen_class_data() {
     if (type == request_type::cpu) {
         return std::make_unique<cpu_class_data>(*this);
+    } else if (type == request_type::trace) {
+        return std::make_unique<trace_io_class_data>(*this);
     } else if ((type == request_type::seqread) || (type == request_type::randread)) {
         return std::make_unique<read_io_class_data>(*this);
     } else {
@@ -754,6 +876,7 @@ struct convert<request_type> {
             { "randwrite", request_type::randwrite },
             { "append", request_type::append},
             { "cpu", request_type::cpu},
+            { "trace", request_type::trace},
         };
         auto reqstr = node.as<std::string>();
         if (!mappings.count(reqstr)) {
@@ -853,6 +976,15 @@ struct convert<job_config> {
         if (node["options"]) {
             cl.options = node["options"].as<options>();
         }
+        if (node["trace"]) {
+            cl.trace_file = node["trace"].as<std::string>();
+        }
+        if (node["speedup"]) {
+            cl.trace_speedup = node["speedup"].as<float>();
+            if (cl.trace_speedup <= 0.0f) {
+                throw std::runtime_error(format("Invalid speedup {}", cl.trace_speedup));
+            }
+        }
         return true;
     }
 };
@@ -208,6 +208,13 @@ struct row_stats {
     float stdev_percents() const {
         return points > 0 ? stdev / average : 0.0;
     }
+
+    // Half-width of the 95% confidence interval for the mean, relative
+    // to the mean. Used by the quick-check mode to separate real drift
+    // from measurement noise on short runs.
+    double ci95_percents() const {
+        return points > 0 && average > 0 ? 1.96 * stdev / (average * std::sqrt(points)) : 0.0;
+    }
 };
 
 template <typename T>
@@ -659,6 +666,41 @@ void write_property_file(sstring conf_file, std::vector<disk_descriptor> disk_de
     string_to_file(conf_file, sstring(out.c_str(), out.size()));
 }
 
+// Loads the disk descriptors of a previously written properties file, for
+// the quick-check mode to compare fresh measurements against.
+std::vector<disk_descriptor> read_property_file(sstring conf_file) {
+    std::vector<disk_descriptor> descs;
+    YAML::Node doc = YAML::LoadFile(conf_file.c_str());
+    for (auto&& node : doc["disks"]) {
+        disk_descriptor desc;
+        desc.mountpoint = node["mountpoint"].as<std::string>();
+        desc.read_iops = node["read_iops"].as<uint64_t>();
+        desc.read_bw = node["read_bandwidth"].as<uint64_t>();
+        desc.write_iops = node["write_iops"].as<uint64_t>();
+        desc.write_bw = node["write_bandwidth"].as<uint64_t>();
+        if (node["read_saturation_length"]) {
+            desc.read_sat_len = node["read_saturation_length"].as<uint64_t>();
+        }
+        if (node["write_saturation_length"]) {
+            desc.write_sat_len = node["write_saturation_length"].as<uint64_t>();
+        }
+        descs.push_back(std::move(desc));
+    }
+    return descs;
+}
+
+// Reports a re-measured metric against its stored value and returns whether
+// it drifted: outside both the tolerated threshold and the measurement's own
+// confidence interval, so short noisy runs do not trigger spurious updates.
+bool metric_drifted(const char* name, uint64_t stored, uint64_t measured, const row_stats& rates, unsigned threshold) {
+    double drift = stored ? std::abs(double(measured) - double(stored)) / double(stored) : 1.0;
+    double ci = rates.ci95_percents();
+    bool drifted = drift * 100.0 > threshold && drift > ci;
+    fmt::print("  {}: stored {}, measured {} +/-{:.1f}% (95% CI), drift {:.1f}%{}\n",
+            name, stored, measured, ci * 100.0, drift * 100.0, drifted ? " <- exceeds threshold" : "");
+    return drifted;
+}
+
 // Returns the mountpoint of a path. It works by walking backwards from the canonical path
 // (absolute, with symlinks resolved), until we find a point that crosses a device ID.
 fs::path mountpoint_of(sstring filename) {
@@ -682,6 +724,7 @@ fs::path mountpoint_of(sstring filename) {
 int main(int ac, char** av) {
     namespace bpo = boost::program_options;
     bool fs_check = false;
+    bool quick_check = false;
 
     app_template::config app_cfg;
     app_cfg.name = "IOTune";
@@ -697,6 +740,8 @@ int main(int ac, char** av) {
         ("fs-check", bpo::bool_switch(&fs_check), "perform FS check only")
         ("accuracy", bpo::value<unsigned>()->default_value(3), "acceptable deviation of measurements (percents)")
         ("saturation", bpo::value<sstring>()->default_value(""), "measure saturation lengths (read | write | both) (this is very slow!)")
+        ("quick-check", bpo::bool_switch(&quick_check), "briefly re-measure and update the properties file only if results drifted beyond --drift-threshold; requires an existing --properties-file")
+        ("drift-threshold", bpo::value<unsigned>()->default_value(10), "tolerated drift from the stored profile (percents) in quick-check mode")
     ;
 
     return app.run(ac, av, [&] {
@@ -726,6 +771,32 @@ int main(int ac, char** av) {
                 return 1;
             }
 
+            auto drift_threshold = configuration["drift-threshold"].as<unsigned>();
+            std::vector<disk_descriptor> stored_descriptors;
+            bool profile_drifted = false;
+            if (quick_check) {
+                if (!configuration.count("properties-file")) {
+                    iotune_logger.error("--quick-check requires --properties-file pointing at an existing profile");
+                    return 1;
+                }
+                if (read_saturation || write_saturation) {
+                    iotune_logger.warn("--saturation is ignored in quick-check mode");
+                    read_saturation = false;
+                    write_saturation = false;
+                }
+                if (configuration["duration"].defaulted()) {
+                    // A sparse re-measurement only needs enough samples for a
+                    // usable confidence interval
+                    duration = std::chrono::duration<double>(12s);
+                }
+                try {
+                    stored_descriptors = read_property_file(configuration["properties-file"].as<sstring>());
+                } catch (...) {
+                    iotune_logger.error("Can't read stored profile {}: {}", configuration["properties-file"].as<sstring>(), std::current_exception());
+                    return 1;
+                }
+            }
+
             std::vector<disk_descriptor> disk_descriptors;
             std::unordered_map<sstring, sstring> mountpoint_map;
             // We want to evaluate once per mountpoint, but we still want to write in one of the
@@ -803,6 +874,7 @@ int main(int ac, char** av) {
                 }
                 write_bw.bytes_per_sec /= smp::count;
                 rates = iotune_tests.get_serial_rates().get0();
+                auto write_bw_stats = rates;
                 fmt::print("{} MB/s{}\n", uint64_t(write_bw.bytes_per_sec / (1024 * 1024)), accuracy_msg());
 
                 std::optional<uint64_t> write_sat;
@@ -818,6 +890,7 @@ int main(int ac, char** av) {
                 std::cout.flush();
                 auto read_bw = iotune_tests.read_sequential_data(0, sequential_buffer_size, duration * 0.1).get0();
                 rates = iotune_tests.get_serial_rates().get0();
+                auto read_bw_stats = rates;
                 fmt::print("{} MB/s{}\n", uint64_t(read_bw.bytes_per_sec / (1024 * 1024)), accuracy_msg());
 
                 std::optional<uint64_t> read_sat;
@@ -833,12 +906,14 @@ int main(int ac, char** av) {
                 std::cout.flush();
                 auto write_iops = iotune_tests.write_random_data(test_directory.minimum_io_size(), duration * 0.1).get0();
                 rates = iotune_tests.get_sharded_worst_rates().get0();
+                auto write_iops_stats = rates;
                 fmt::print("{} IOPS{}\n", uint64_t(write_iops.iops), accuracy_msg());
 
                 fmt::print("Measuring random read IOPS: ");
                 std::cout.flush();
                 auto read_iops = iotune_tests.read_random_data(test_directory.minimum_io_size(), duration * 0.1).get0();
                 rates = iotune_tests.get_sharded_worst_rates().get0();
+                auto read_iops_stats = rates;
                 fmt::print("{} IOPS{}\n", uint64_t(read_iops.iops), accuracy_msg());
 
                 struct disk_descriptor desc;
@@ -849,6 +924,34 @@ int main(int ac, char** av) {
                 desc.write_iops = write_iops.iops;
                 desc.write_bw = write_bw.bytes_per_sec;
                 desc.write_sat_len = write_sat;
+
+                if (quick_check) {
+                    auto stored = std::find_if(stored_descriptors.begin(), stored_descriptors.end(), [&mountpoint] (const disk_descriptor& d) {
+                        return d.mountpoint == mountpoint;
+                    });
+                    if (stored == stored_descriptors.end()) {
+                        iotune_logger.warn("No stored profile for {}; adding the measured values", mountpoint);
+                        profile_drifted = true;
+                    } else {
+                        fmt::print("Comparing against stored profile for {}:\n", mountpoint);
+                        bool drifted = false;
+                        drifted |= metric_drifted("write bandwidth", stored->write_bw, desc.write_bw, write_bw_stats, drift_threshold);
+                        drifted |= metric_drifted("read bandwidth", stored->read_bw, desc.read_bw, read_bw_stats, drift_threshold);
+                        drifted |= metric_drifted("write IOPS", stored->write_iops, desc.write_iops, write_iops_stats, drift_threshold);
+                        drifted |= metric_drifted("read IOPS", stored->read_iops, desc.read_iops, read_iops_stats, drift_threshold);
+                        if (drifted) {
+                            profile_drifted = true;
+                            // The quick check does not re-measure saturation
+                            // lengths; carry the stored ones over
+                            desc.read_sat_len = stored->read_sat_len;
+                            desc.write_sat_len = stored->write_sat_len;
+                        } else {
+                            // Within noise of the stored profile: keep it
+                            // verbatim so repeated checks do not churn it
+                            desc = *stored;
+                        }
+                    }
+                }
                 disk_descriptors.push_back(std::move(desc));
             }
 
@@ -856,6 +959,12 @@ int main(int ac, char** av) {
                 return 0;
             }
 
+            if (quick_check && !profile_drifted) {
+                fmt::print("All metrics within {}% of the stored profile; not updating {}\n",
+                        drift_threshold, configuration["properties-file"].as<sstring>());
+                return 0;
+            }
+
             auto file = "properties file";
             try {
                 if (configuration.count("properties-file")) {
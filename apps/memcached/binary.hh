@@ -0,0 +1,195 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#pragma once
+
+#include <seastar/core/sstring.hh>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+
+//
+// Wire format of the memcached binary protocol: the fixed 24-byte
+// header and helpers to parse requests and serialize responses. Kept
+// separate from the protocol logic in memcache.cc so the perf harness
+// in tests/ can exercise it directly.
+//
+namespace memcache {
+namespace binary {
+
+using namespace seastar;
+
+static constexpr uint8_t magic_request = 0x80;
+static constexpr uint8_t magic_response = 0x81;
+static constexpr size_t header_size = 24;
+
+enum class opcode : uint8_t {
+    get        = 0x00,
+    set        = 0x01,
+    add        = 0x02,
+    replace    = 0x03,
+    del        = 0x04,
+    increment  = 0x05,
+    decrement  = 0x06,
+    quit       = 0x07,
+    flush      = 0x08,
+    getq       = 0x09,
+    noop       = 0x0a,
+    version    = 0x0b,
+    getk       = 0x0c,
+    getkq      = 0x0d,
+    stat       = 0x10,
+    setq       = 0x11,
+    addq       = 0x12,
+    replaceq   = 0x13,
+    deleteq    = 0x14,
+    incrementq = 0x15,
+    decrementq = 0x16,
+    quitq      = 0x17,
+    flushq     = 0x18,
+};
+
+enum class status : uint16_t {
+    ok                = 0x0000,
+    key_not_found     = 0x0001,
+    key_exists        = 0x0002,
+    value_too_large   = 0x0003,
+    invalid_arguments = 0x0004,
+    not_stored        = 0x0005,
+    non_numeric_value = 0x0006,
+    unknown_command   = 0x0081,
+    out_of_memory     = 0x0082,
+};
+
+// Quiet variants suppress the response unless it carries an error (or,
+// for getq/getkq, unless the key was found).
+inline bool is_quiet(opcode op) noexcept {
+    switch (op) {
+    case opcode::getq:
+    case opcode::getkq:
+    case opcode::setq:
+    case opcode::addq:
+    case opcode::replaceq:
+    case opcode::deleteq:
+    case opcode::incrementq:
+    case opcode::decrementq:
+    case opcode::quitq:
+    case opcode::flushq:
+        return true;
+    default:
+        return false;
+    }
+}
+
+inline uint16_t read_be16(const char* p) noexcept {
+    return (uint16_t(uint8_t(p[0])) << 8) | uint8_t(p[1]);
+}
+
+inline uint32_t read_be32(const char* p) noexcept {
+    return (uint32_t(read_be16(p)) << 16) | read_be16(p + 2);
+}
+
+inline uint64_t read_be64(const char* p) noexcept {
+    return (uint64_t(read_be32(p)) << 32) | read_be32(p + 4);
+}
+
+inline void write_be16(char* p, uint16_t v) noexcept {
+    p[0] = char(v >> 8);
+    p[1] = char(v);
+}
+
+inline void write_be32(char* p, uint32_t v) noexcept {
+    write_be16(p, uint16_t(v >> 16));
+    write_be16(p + 2, uint16_t(v));
+}
+
+inline void write_be64(char* p, uint64_t v) noexcept {
+    write_be32(p, uint32_t(v >> 32));
+    write_be32(p + 4, uint32_t(v));
+}
+
+struct request_header {
+    opcode op;
+    uint16_t key_length;
+    uint8_t extras_length;
+    uint32_t total_body_length;
+    uint32_t opaque;
+    uint64_t cas;
+
+    size_t value_length() const noexcept {
+        return total_body_length - key_length - extras_length;
+    }
+};
+
+// Parses the fixed request header from a 24-byte buffer. Returns
+// nullopt on bad magic or on body fields which are inconsistent with
+// each other.
+inline std::optional<request_header> parse_header(const char* p) noexcept {
+    if (uint8_t(p[0]) != magic_request) {
+        return std::nullopt;
+    }
+    request_header h;
+    h.op = opcode(uint8_t(p[1]));
+    h.key_length = read_be16(p + 2);
+    h.extras_length = uint8_t(p[4]);
+    // p[5] is the data type, always raw; p[6..7] is vbucket, unused
+    h.total_body_length = read_be32(p + 8);
+    h.opaque = read_be32(p + 12);
+    h.cas = read_be64(p + 16);
+    if (h.total_body_length < size_t(h.key_length) + h.extras_length) {
+        return std::nullopt;
+    }
+    return h;
+}
+
+// Serializes a response header, echoing the request opcode and opaque.
+// The extras area (extras_length bytes right after the header) is
+// zero-filled; the caller writes its content in place.
+inline sstring make_response_header(opcode op, status st, uint8_t extras_length, uint16_t key_length,
+        size_t value_length, uint32_t opaque, uint64_t cas) {
+    sstring s(header_size + extras_length, '\0');
+    char* p = &s[0];
+    p[0] = char(magic_response);
+    p[1] = char(op);
+    write_be16(p + 2, key_length);
+    p[4] = char(extras_length);
+    write_be16(p + 6, uint16_t(st));
+    write_be32(p + 8, extras_length + key_length + value_length);
+    write_be32(p + 12, opaque);
+    write_be64(p + 16, cas);
+    return s;
+}
+
+// Serializes a request header the same way; used by tests and the
+// perf harness to generate client traffic.
+inline sstring make_request_header(opcode op, uint8_t extras_length, uint16_t key_length,
+        size_t value_length, uint32_t opaque, uint64_t cas) {
+    sstring s(header_size + extras_length, '\0');
+    char* p = &s[0];
+    p[0] = char(magic_request);
+    p[1] = char(op);
+    write_be16(p + 2, key_length);
+    p[4] = char(extras_length);
+    write_be32(p + 8, extras_length + key_length + value_length);
+    write_be32(p + 12, opaque);
+    write_be64(p + 16, cas);
+    return s;
+}
+
+}
+}
@@ -46,7 +46,9 @@
 #include <seastar/util/std-compat.hh>
 #include <seastar/util/log.hh>
 #include "ascii.hh"
+#include "binary.hh"
 #include "memcached.hh"
+#include <charconv>
 #include <unistd.h>
 
 #define PLATFORM "seastar"
@@ -1219,6 +1221,312 @@ public:
     };
 };
 
+//
+// Memcached binary protocol (24-byte-header framing). Built around
+// pipelined multi-gets: quiet gets (getq/getkq) are parked until the
+// pipeline ends with a non-quiet request (typically noop), the parked
+// keys are then resolved in parallel and every hit is serialized into
+// one scattered_message instead of one write per key. Quiet mutations
+// respond only on error, per the protocol.
+//
+class binary_protocol {
+private:
+    sharded_cache& _cache;
+    distributed<system_stats>& _system_stats;
+    struct get_entry {
+        binary::opcode op;
+        uint32_t opaque;
+        item_key key;
+        item_ptr item;
+    };
+    std::vector<get_entry> _pending_gets;
+    item_insertion_data _insertion;
+    item_key _item_key;
+    bool _quit = false;
+    // Bound on parked quiet gets; a longer pipeline is drained in chunks.
+    static constexpr size_t max_pending_gets = 256;
+private:
+    static bool is_get(binary::opcode op) {
+        return op == binary::opcode::get || op == binary::opcode::getq
+            || op == binary::opcode::getk || op == binary::opcode::getkq;
+    }
+
+    static bool includes_key(binary::opcode op) {
+        return op == binary::opcode::getk || op == binary::opcode::getkq;
+    }
+
+    // Items store their flags in the ascii protocol's " <flags> <size>"
+    // prefix, which keeps both protocols interoperable on one cache.
+    static uint32_t flags_of(std::string_view ascii_prefix) {
+        uint32_t flags = 0;
+        for (auto c : ascii_prefix.substr(1)) {
+            if (c == ' ') {
+                break;
+            }
+            flags = flags * 10 + (c - '0');
+        }
+        return flags;
+    }
+
+    bool append_get_response(scattered_message<char>& msg, get_entry& e) {
+        uint16_t key_length = includes_key(e.op) ? e.key.key().size() : 0;
+        if (e.item) {
+            auto hdr = binary::make_response_header(e.op, binary::status::ok, sizeof(uint32_t),
+                key_length, e.item->value_size(), e.opaque, e.item->version());
+            binary::write_be32(&hdr[binary::header_size], flags_of(e.item->ascii_prefix()));
+            msg.append(std::move(hdr));
+            if (key_length) {
+                msg.append_static(e.item->key());
+            }
+            msg.append_static(e.item->value());
+            msg.on_delete([item = std::move(e.item)] {});
+            return true;
+        }
+        if (binary::is_quiet(e.op)) {
+            return false;
+        }
+        msg.append(binary::make_response_header(e.op, binary::status::key_not_found, 0,
+            key_length, 0, e.opaque, 0));
+        if (key_length) {
+            msg.append(sstring(e.key.key()));
+        }
+        return true;
+    }
+
+    future<> drain_pending_gets(output_stream<char>& out) {
+        if (_pending_gets.empty()) {
+            return make_ready_future<>();
+        }
+        _system_stats.local()._cmd_get += _pending_gets.size();
+        return do_with(std::exchange(_pending_gets, {}), [this, &out] (std::vector<get_entry>& batch) {
+            return parallel_for_each(batch.begin(), batch.end(), [this] (get_entry& e) {
+                return _cache.get(e.key).then([&e] (item_ptr item) {
+                    e.item = std::move(item);
+                });
+            }).then([this, &batch, &out] {
+                scattered_message<char> msg;
+                bool any = false;
+                for (auto& e : batch) {
+                    any |= append_get_response(msg, e);
+                }
+                if (!any) {
+                    return make_ready_future<>();
+                }
+                return out.write(std::move(msg));
+            });
+        });
+    }
+
+    future<> respond_status(output_stream<char>& out, const binary::request_header& h, binary::status st) {
+        if (binary::is_quiet(h.op) && st == binary::status::ok) {
+            return make_ready_future<>();
+        }
+        return out.write(binary::make_response_header(h.op, st, 0, 0, 0, h.opaque, 0));
+    }
+
+    future<> handle_numeric(output_stream<char>& out, const binary::request_header& h, std::pair<item_ptr, bool> result) {
+        auto item = std::move(result.first);
+        if (!item) {
+            return respond_status(out, h, binary::status::key_not_found);
+        }
+        if (!result.second) {
+            return respond_status(out, h, binary::status::non_numeric_value);
+        }
+        if (binary::is_quiet(h.op)) {
+            return make_ready_future<>();
+        }
+        uint64_t value = 0;
+        auto v = item->value();
+        std::from_chars(v.data(), v.data() + v.size(), value);
+        auto hdr = binary::make_response_header(h.op, binary::status::ok, 0, 0, sizeof(uint64_t),
+            h.opaque, item->version());
+        sstring payload(sizeof(uint64_t), '\0');
+        binary::write_be64(&payload[0], value);
+        return out.write(std::move(hdr)).then([&out, payload = std::move(payload)] () mutable {
+            return out.write(std::move(payload));
+        });
+    }
+
+    future<> do_dispatch(binary::request_header h, temporary_buffer<char> body, output_stream<char>& out) {
+        using op = binary::opcode;
+        const char* extras = body.get();
+        auto key = sstring(body.get() + h.extras_length, h.key_length);
+        auto value = std::string_view(body.get() + h.extras_length + h.key_length, h.value_length());
+        switch (h.op) {
+            case op::get:
+            case op::getk:
+            case op::getq:
+            case op::getkq:
+                _pending_gets.push_back(get_entry{h.op, h.opaque, item_key(std::move(key)), {}});
+                if (binary::is_quiet(h.op) && _pending_gets.size() < max_pending_gets) {
+                    return make_ready_future<>();
+                }
+                return drain_pending_gets(out);
+
+            case op::noop:
+                return respond_status(out, h, binary::status::ok);
+
+            case op::set:
+            case op::setq:
+            case op::add:
+            case op::addq:
+            case op::replace:
+            case op::replaceq:
+            {
+                _system_stats.local()._cmd_set++;
+                if (h.extras_length != 8) {
+                    return respond_status(out, h, binary::status::invalid_arguments);
+                }
+                auto flags = binary::read_be32(extras);
+                auto expiry = binary::read_be32(extras + 4);
+                _insertion = item_insertion_data{
+                    .key = item_key(std::move(key)),
+                    .ascii_prefix = make_sstring(" ", to_sstring(flags), " ", to_sstring(h.value_length())),
+                    .data = sstring(value.data(), value.size()),
+                    .expiry = expiration(_cache.get_wc_to_clock_type_delta(), expiry)
+                };
+                if (h.op == op::set || h.op == op::setq) {
+                    if (h.cas) {
+                        return _cache.cas(_insertion, h.cas).then([this, &out, h] (cas_result result) {
+                            switch (result) {
+                                case cas_result::stored:
+                                    return respond_status(out, h, binary::status::ok);
+                                case cas_result::not_found:
+                                    return respond_status(out, h, binary::status::key_not_found);
+                                case cas_result::bad_version:
+                                    return respond_status(out, h, binary::status::key_exists);
+                                default:
+                                    std::abort();
+                            }
+                        });
+                    }
+                    return _cache.set(_insertion).then([this, &out, h] (...) {
+                        return respond_status(out, h, binary::status::ok);
+                    });
+                }
+                if (h.op == op::add || h.op == op::addq) {
+                    return _cache.add(_insertion).then([this, &out, h] (bool added) {
+                        return respond_status(out, h, added ? binary::status::ok : binary::status::key_exists);
+                    });
+                }
+                return _cache.replace(_insertion).then([this, &out, h] (bool replaced) {
+                    return respond_status(out, h, replaced ? binary::status::ok : binary::status::key_not_found);
+                });
+            }
+
+            case op::del:
+            case op::deleteq:
+                _item_key = item_key(std::move(key));
+                return _cache.remove(_item_key).then([this, &out, h] (bool removed) {
+                    return respond_status(out, h, removed ? binary::status::ok : binary::status::key_not_found);
+                });
+
+            case op::increment:
+            case op::incrementq:
+            case op::decrement:
+            case op::decrementq:
+            {
+                if (h.extras_length != 20) {
+                    return respond_status(out, h, binary::status::invalid_arguments);
+                }
+                // note: the auto-create semantics of the initial/expiration
+                // extras are not supported; a miss is a miss
+                auto delta = binary::read_be64(extras);
+                _item_key = item_key(std::move(key));
+                auto f = (h.op == op::increment || h.op == op::incrementq)
+                    ? _cache.incr(_item_key, delta)
+                    : _cache.decr(_item_key, delta);
+                return std::move(f).then([this, &out, h] (std::pair<item_ptr, bool> result) {
+                    return handle_numeric(out, h, std::move(result));
+                });
+            }
+
+            case op::version:
+            {
+                static const sstring version_string = VERSION_STRING;
+                return out.write(binary::make_response_header(h.op, binary::status::ok, 0, 0,
+                        version_string.size(), h.opaque, 0)).then([&out] {
+                    return out.write(version_string);
+                });
+            }
+
+            case op::flush:
+            case op::flushq:
+            {
+                _system_stats.local()._cmd_flush++;
+                uint32_t expiry = h.extras_length >= 4 ? binary::read_be32(extras) : 0;
+                auto f = expiry ? _cache.flush_at(expiry) : _cache.flush_all();
+                return std::move(f).then([this, &out, h] {
+                    return respond_status(out, h, binary::status::ok);
+                });
+            }
+
+            case op::stat:
+                // no stats over the binary protocol yet; terminate the
+                // stream with the empty end-of-stats packet
+                return out.write(binary::make_response_header(h.op, binary::status::ok, 0, 0, 0, h.opaque, 0));
+
+            case op::quit:
+            case op::quitq:
+                _quit = true;
+                return respond_status(out, h, binary::status::ok);
+
+            default:
+                return out.write(binary::make_response_header(h.op, binary::status::unknown_command, 0, 0, 0, h.opaque, 0));
+        }
+    }
+
+    future<> dispatch(binary::request_header h, temporary_buffer<char> body, output_stream<char>& out) {
+        if (!_pending_gets.empty() && !is_get(h.op)) {
+            // responses go out in request order: the parked multi-get
+            // batch must be answered before this request is
+            return drain_pending_gets(out).then([this, h, body = std::move(body), &out] () mutable {
+                return do_dispatch(h, std::move(body), out);
+            });
+        }
+        return do_dispatch(h, std::move(body), out);
+    }
+public:
+    binary_protocol(sharded_cache& cache, distributed<system_stats>& system_stats)
+        : _cache(cache)
+        , _system_stats(system_stats)
+    {}
+
+    bool quit() const {
+        return _quit;
+    }
+
+    future<> handle(input_stream<char>& in, output_stream<char>& out) {
+        return in.read_exactly(binary::header_size).then([this, &in, &out] (temporary_buffer<char> hdr) -> future<> {
+            if (hdr.size() < binary::header_size) {
+                // eof (mid-header means the peer went away)
+                return make_ready_future<>();
+            }
+            auto h = binary::parse_header(hdr.get());
+            if (!h) {
+                // framing is lost, there is no way to resync
+                _quit = true;
+                return make_ready_future<>();
+            }
+            return in.read_exactly(h->total_body_length).then([this, &out, h = *h] (temporary_buffer<char> body) {
+                if (body.size() < h.total_body_length) {
+                    _quit = true;
+                    return make_ready_future<>();
+                }
+                return dispatch(h, std::move(body), out);
+            });
+        }).then_wrapped([this, &out] (auto&& f) -> future<> {
+            try {
+                f.get();
+            } catch (std::bad_alloc& e) {
+                return out.write(binary::make_response_header(binary::opcode::noop,
+                    binary::status::out_of_memory, 0, 0, 0, 0, 0));
+            }
+            return make_ready_future<>();
+        });
+    }
+};
+
 class udp_server {
 public:
     static const size_t default_max_datagram_size = 1400;
@@ -1341,19 +1649,24 @@ private:
     sharded_cache& _cache;
     distributed<system_stats>& _system_stats;
     uint16_t _port;
+    bool _binary;
     struct connection {
         connected_socket _socket;
         socket_address _addr;
         input_stream<char> _in;
         output_stream<char> _out;
         ascii_protocol _proto;
+        binary_protocol _binary_proto;
+        bool _binary;
         distributed<system_stats>& _system_stats;
-        connection(connected_socket&& socket, socket_address addr, sharded_cache& c, distributed<system_stats>& system_stats)
+        connection(connected_socket&& socket, socket_address addr, sharded_cache& c, distributed<system_stats>& system_stats, bool binary)
             : _socket(std::move(socket))
             , _addr(addr)
             , _in(_socket.input())
             , _out(_socket.output())
             , _proto(c, system_stats)
+            , _binary_proto(c, system_stats)
+            , _binary(binary)
             , _system_stats(system_stats)
         {
             _system_stats.local()._curr_connections++;
@@ -1362,12 +1675,19 @@ private:
         ~connection() {
             _system_stats.local()._curr_connections--;
         }
+        future<> process_one() {
+            return _binary ? _binary_proto.handle(_in, _out) : _proto.handle(_in, _out);
+        }
+        bool done() const {
+            return _in.eof() || (_binary && _binary_proto.quit());
+        }
     };
 public:
-    tcp_server(sharded_cache& cache, distributed<system_stats>& system_stats, uint16_t port = 11211)
+    tcp_server(sharded_cache& cache, distributed<system_stats>& system_stats, uint16_t port = 11211, bool binary = false)
         : _cache(cache)
         , _system_stats(system_stats)
         , _port(port)
+        , _binary(binary)
     {}
 
     void start() {
@@ -1379,9 +1699,9 @@ public:
             return _listener->accept().then([this] (accept_result ar) mutable {
                 connected_socket fd = std::move(ar.connection);
                 socket_address addr = std::move(ar.remote_address);
-                auto conn = make_lw_shared<connection>(std::move(fd), addr, _cache, _system_stats);
-                (void)do_until([conn] { return conn->_in.eof(); }, [conn] {
-                    return conn->_proto.handle(conn->_in, conn->_out).then([conn] {
+                auto conn = make_lw_shared<connection>(std::move(fd), addr, _cache, _system_stats, _binary);
+                (void)do_until([conn] { return conn->done(); }, [conn] {
+                    return conn->process_one().then([conn] {
                         return conn->_out.flush();
                     });
                 }).finally([conn] {
@@ -1450,6 +1770,8 @@ int main(int ac, char** av) {
              "Print basic statistics periodically (every second)")
         ("port", bpo::value<uint16_t>()->default_value(11211),
              "Specify UDP and TCP ports for memcached server to listen on")
+        ("protocol", bpo::value<sstring>()->default_value("ascii"),
+             "TCP protocol to serve: ascii or binary (UDP is always ascii)")
         ;
 
     return app.run_deprecated(ac, av, [&] {
@@ -1462,13 +1784,14 @@ int main(int ac, char** av) {
         uint16_t port = config["port"].as<uint16_t>();
         uint64_t per_cpu_slab_size = config["max-slab-size"].as<uint64_t>() * MB;
         uint64_t slab_page_size = config["slab-page-size"].as<uint64_t>() * MB;
+        bool binary = config["protocol"].as<sstring>() == "binary";
         return cache_peers.start(std::move(per_cpu_slab_size), std::move(slab_page_size)).then([&system_stats] {
             return system_stats.start(memcache::clock_type::now());
         }).then([&] {
             std::cout << PLATFORM << " memcached " << VERSION << "\n";
             return make_ready_future<>();
-        }).then([&, port] {
-            return tcp_server.start(std::ref(cache), std::ref(system_stats), port);
+        }).then([&, port, binary] {
+            return tcp_server.start(std::ref(cache), std::ref(system_stats), port, binary);
         }).then([&tcp_server] {
             return tcp_server.invoke_on_all(&memcache::tcp_server::start);
         }).then([&, port] {
@@ -0,0 +1,112 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB
+ */
+
+//
+// Perf harness for the binary protocol wire format: measures how fast
+// a pipelined multi-get batch (getq ... getq noop) can be parsed and
+// how fast the corresponding hit responses can be serialized, without
+// any networking or cache behind it. This bounds what the protocol
+// layer itself can sustain, to compare against ascii parsing.
+//
+// Run manually:  app_memcached_perf_binary [batch_size] [seconds]
+//
+
+#include "binary.hh"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace memcache;
+
+static std::string make_pipeline(size_t batch_size, size_t key_size) {
+    std::string pipeline;
+    std::string key(key_size, 'k');
+    for (size_t i = 0; i < batch_size; ++i) {
+        auto hdr = binary::make_request_header(binary::opcode::getq, 0, key_size, 0, i, 0);
+        pipeline.append(hdr.data(), hdr.size());
+        pipeline.append(key);
+    }
+    auto noop = binary::make_request_header(binary::opcode::noop, 0, 0, 0, batch_size, 0);
+    pipeline.append(noop.data(), noop.size());
+    return pipeline;
+}
+
+template <typename Fn>
+static void measure(const char* name, size_t requests_per_round, double seconds, Fn&& round) {
+    using clock = std::chrono::steady_clock;
+    // warm up
+    for (int i = 0; i < 1000; ++i) {
+        round();
+    }
+    size_t rounds = 0;
+    auto start = clock::now();
+    auto deadline = start + std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(seconds));
+    do {
+        round();
+        rounds++;
+    } while (clock::now() < deadline);
+    auto elapsed = std::chrono::duration<double>(clock::now() - start).count();
+    auto rate = double(rounds) * requests_per_round / elapsed;
+    std::printf("%-20s %12.0f requests/s (%zu rounds in %.2fs)\n", name, rate, rounds, elapsed);
+}
+
+int main(int argc, char** argv) {
+    size_t batch_size = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 64;
+    double seconds = argc > 2 ? std::strtod(argv[2], nullptr) : 2.0;
+    constexpr size_t key_size = 16;
+    constexpr size_t value_size = 128;
+
+    auto pipeline = make_pipeline(batch_size, key_size);
+    std::printf("batch of %zu getq + noop, %zu byte keys, %zu byte values\n",
+        batch_size, key_size, value_size);
+
+    uint64_t sink = 0;
+    measure("parse", batch_size + 1, seconds, [&] {
+        const char* p = pipeline.data();
+        const char* end = p + pipeline.size();
+        while (p + binary::header_size <= end) {
+            auto h = binary::parse_header(p);
+            if (!h) {
+                std::abort();
+            }
+            sink += h->opaque + uint8_t(h->op);
+            p += binary::header_size + h->total_body_length;
+        }
+    });
+
+    measure("serialize hits", batch_size, seconds, [&] {
+        for (size_t i = 0; i < batch_size; ++i) {
+            auto hdr = binary::make_response_header(binary::opcode::getq, binary::status::ok,
+                sizeof(uint32_t), 0, value_size, i, 1);
+            binary::write_be32(&hdr[binary::header_size], 42);
+            sink += uint8_t(hdr[1]);
+        }
+    });
+
+    // defeat over-eager optimization of the measured loops
+    if (sink == 0x5eed) {
+        std::printf("\n");
+    }
+    return 0;
+}
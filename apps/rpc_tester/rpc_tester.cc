@@ -168,11 +168,22 @@ struct server_config {
     bool nodelay = true;
 };
 
+struct payload_mix_entry {
+    size_t size;
+    unsigned weight = 1;
+};
+
 struct job_config {
     std::string name;
     std::string type;
     std::string verb;
     unsigned parallelism;
+    unsigned connections = 1;
+    // Offered load steps, messages per second per shard; each step runs
+    // for an equal slice of the job duration. Empty means closed-loop
+    // (send as fast as responses come back).
+    std::vector<unsigned> rps;
+    std::vector<payload_mix_entry> payload_mix;
     unsigned shares = 100;
     std::chrono::duration<double> exec_time;
     std::optional<duration_range> exec_time_range;
@@ -225,6 +236,17 @@ struct convert<server_config> {
     }
 };
 
+template <>
+struct convert<payload_mix_entry> {
+    static bool decode(const Node& node, payload_mix_entry& e) {
+        e.size = node["payload"].as<byte_size>().size;
+        if (node["weight"]) {
+            e.weight = node["weight"].as<unsigned>();
+        }
+        return true;
+    }
+};
+
 template <>
 struct convert<job_config> {
     static bool decode(const Node& node, job_config& cfg) {
@@ -233,8 +255,20 @@ struct convert<job_config> {
         cfg.parallelism = node["parallelism"].as<unsigned>();
         if (cfg.type == "rpc") {
             cfg.verb = node["verb"].as<std::string>();
-            cfg.payload = node["payload"].as<byte_size>().size;
+            if (node["payload_mix"]) {
+                cfg.payload_mix = node["payload_mix"].as<std::vector<payload_mix_entry>>();
+            } else {
+                cfg.payload = node["payload"].as<byte_size>().size;
+            }
             cfg.client = true;
+            if (node["connections"]) {
+                cfg.connections = node["connections"].as<unsigned>();
+            }
+            if (node["rps"]) {
+                cfg.rps.push_back(node["rps"].as<unsigned>());
+            } else if (node["rps_sweep"]) {
+                cfg.rps = node["rps_sweep"].as<std::vector<unsigned>>();
+            }
             if (node["sleep_time"]) {
                 cfg.sleep_time = node["sleep_time"].as<duration_time>().time;
             }
@@ -362,47 +396,152 @@ public:
 class job_rpc : public job {
     using accumulator_type = accumulator_set<double, stats<tag::extended_p_square_quantile(quadratic), tag::mean, tag::max>>;
 
+    // One offered-load step of the sweep; rps == 0 means closed-loop
+    struct load_step {
+        unsigned rps;
+        uint64_t messages = 0;
+        std::chrono::duration<double> elapsed = {};
+        accumulator_type latencies;
+        explicit load_step(unsigned rps) : rps(rps), latencies(extended_p_square_probabilities = quantiles) { }
+    };
+
     job_config _cfg;
     socket_address _caddr;
     client_config _ccfg;
     rpc_protocol& _rpc;
-    std::unique_ptr<rpc_protocol::client> _client;
+    std::vector<std::unique_ptr<rpc_protocol::client>> _clients;
     std::function<future<>(unsigned)> _call;
     std::chrono::steady_clock::time_point _stop;
-    uint64_t _total_messages = 0;
-    accumulator_type _latencies;
+    std::vector<payload_t> _payloads;
+    std::random_device _rd;
+    std::mt19937 _rng;
+    std::discrete_distribution<unsigned> _pick;
+    std::vector<load_step> _steps;
+
+    rpc_protocol::client& client_for(unsigned dummy) {
+        // fan requests in over the connections, fiber-sticky so each
+        // fiber keeps at most one request in flight per connection
+        return *_clients[dummy % _clients.size()];
+    }
 
     future<> call_echo(unsigned dummy) {
         auto cln = _rpc.make_client<uint64_t(uint64_t)>(rpc_verb::ECHO);
         if (_cfg.timeout) {
-            return cln(*_client, std::chrono::duration_cast<seastar::rpc::rpc_clock_type::duration>(*_cfg.timeout), dummy).discard_result();
+            return cln(client_for(dummy), std::chrono::duration_cast<seastar::rpc::rpc_clock_type::duration>(*_cfg.timeout), dummy).discard_result();
         } else {
-            return cln(*_client, dummy).discard_result();
+            return cln(client_for(dummy), dummy).discard_result();
         }
     }
 
     future<> call_write(unsigned dummy, const payload_t& pl) {
-        return _rpc.make_client<uint64_t(payload_t)>(rpc_verb::WRITE)(*_client, pl).then([exp = pl.size()] (auto res) {
+        return _rpc.make_client<uint64_t(payload_t)>(rpc_verb::WRITE)(client_for(dummy), pl).then([exp = pl.size()] (auto res) {
             assert(res == exp);
             return make_ready_future<>();
         });
     }
 
+    // Closed loop: the next message is sent when the previous response
+    // arrives (plus the optional sleep), so the achieved rate follows
+    // the server and the measured latency suffers from coordinated
+    // omission under overload.
+    future<> run_closed_loop(load_step& step, unsigned dummy) {
+        auto f = make_ready_future<>();
+        if (_cfg.sleep_time) {
+            // Do initial small delay to de-synchronize fibers
+            f = seastar::sleep(std::chrono::duration_cast<std::chrono::nanoseconds>(*_cfg.sleep_time / _cfg.parallelism * dummy));
+        }
+        return std::move(f).then([this, &step, dummy] {
+            return do_until([this] {
+                return std::chrono::steady_clock::now() > _stop;
+            }, [this, &step, dummy] {
+                step.messages++;
+                auto now = std::chrono::steady_clock::now();
+                return _call(dummy).then([&step, start = now] {
+                    std::chrono::microseconds lat = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+                    step.latencies(lat.count());
+                }).then([this] {
+                    if (_cfg.sleep_time) {
+                        return seastar::sleep(std::chrono::duration_cast<std::chrono::nanoseconds>(*_cfg.sleep_time));
+                    } else {
+                        return make_ready_future<>();
+                    }
+                });
+            });
+        });
+    }
+
+    // Fixed schedule: send times are laid out up front by the offered
+    // load and latency is measured from the scheduled send time, not
+    // the actual one. A slow response cannot push later sends back, so
+    // queueing delay under overload shows up in the numbers instead of
+    // being silently omitted.
+    future<> run_fixed_schedule(load_step& step, unsigned dummy, std::chrono::steady_clock::time_point start) {
+        auto period = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double>(double(_cfg.parallelism) / step.rps));
+        // stagger fibers across one period
+        auto first = start + (period * dummy) / _cfg.parallelism;
+        return do_until([this] {
+            return std::chrono::steady_clock::now() > _stop;
+        }, [this, &step, dummy, period, next = first] () mutable {
+            auto scheduled = next;
+            next += period;
+            auto now = std::chrono::steady_clock::now();
+            auto f = scheduled > now ? seastar::sleep(scheduled - now) : make_ready_future<>();
+            return std::move(f).then([this, &step, dummy, scheduled] {
+                step.messages++;
+                return _call(dummy).then([&step, scheduled] {
+                    std::chrono::microseconds lat = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - scheduled);
+                    step.latencies(lat.count());
+                });
+            });
+        });
+    }
+
+    static void emit_latencies(YAML::Emitter& out, const accumulator_type& acc) {
+        out << YAML::Key << "latencies" << YAML::Comment("usec");
+        out << YAML::BeginMap;
+        out << YAML::Key << "average" << YAML::Value << (uint64_t)mean(acc);
+        for (auto& q: quantiles) {
+            out << YAML::Key << fmt::format("p{}", q) << YAML::Value << (uint64_t)quantile(acc, quantile_probability = q);
+        }
+        out << YAML::Key << "max" << YAML::Value << (uint64_t)max(acc);
+        out << YAML::EndMap;
+    }
+
 public:
     job_rpc(job_config cfg, rpc_protocol& rpc, client_config ccfg, socket_address caddr)
             : _cfg(cfg)
             , _caddr(std::move(caddr))
             , _ccfg(ccfg)
             , _rpc(rpc)
-            , _stop(std::chrono::steady_clock::now() + _cfg.duration)
-            , _latencies(extended_p_square_probabilities = quantiles)
+            , _rng(_rd())
     {
+        if (_cfg.rps.empty()) {
+            _steps.emplace_back(0u);
+        } else {
+            for (auto rps : _cfg.rps) {
+                _steps.emplace_back(rps);
+            }
+        }
         if (_cfg.verb == "echo") {
             _call = [this] (unsigned x) { return call_echo(x); };
         } else if (_cfg.verb == "write") {
-            payload_t payload;
-            payload.resize(_cfg.payload / sizeof(payload_t::value_type), 0);
-            _call = [this, payload = std::move(payload)] (unsigned x) { return call_write(x, payload); };
+            if (_cfg.payload_mix.empty()) {
+                payload_t payload;
+                payload.resize(_cfg.payload / sizeof(payload_t::value_type), 0);
+                _payloads.push_back(std::move(payload));
+            } else {
+                std::vector<double> weights;
+                for (auto& e : _cfg.payload_mix) {
+                    payload_t payload;
+                    payload.resize(e.size / sizeof(payload_t::value_type), 0);
+                    _payloads.push_back(std::move(payload));
+                    weights.push_back(e.weight);
+                }
+                _pick = std::discrete_distribution<unsigned>(weights.begin(), weights.end());
+            }
+            _call = [this] (unsigned x) {
+                return call_write(x, _payloads.size() == 1 ? _payloads[0] : _payloads[_pick(_rng)]);
+            };
         } else if (_cfg.verb == "vecho") {
             _call = [this] (unsigned x) {
                 fmt::print("{}.{} send echo\n", this_shard_id(), x);
@@ -424,47 +563,45 @@ public:
         rpc::client_options co;
         co.tcp_nodelay = _ccfg.nodelay;
         co.isolation_cookie = _cfg.sg_name;
-        _client = std::make_unique<rpc_protocol::client>(_rpc, co, _caddr);
-        return parallel_for_each(boost::irange(0u, _cfg.parallelism), [this] (auto dummy) {
-          auto f = make_ready_future<>();
-          if (_cfg.sleep_time) {
-              // Do initial small delay to de-synchronize fibers
-              f = seastar::sleep(std::chrono::duration_cast<std::chrono::nanoseconds>(*_cfg.sleep_time / _cfg.parallelism * dummy));
-          }
-          return std::move(f).then([this, dummy] {
-            return do_until([this] {
-                return std::chrono::steady_clock::now() > _stop;
-            }, [this, dummy] {
-                _total_messages++;
-                auto now = std::chrono::steady_clock::now();
-                return _call(dummy).then([this, start = now] {
-                    std::chrono::microseconds lat = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
-                    _latencies(lat.count());
-                }).then([this] {
-                    if (_cfg.sleep_time) {
-                        return seastar::sleep(std::chrono::duration_cast<std::chrono::nanoseconds>(*_cfg.sleep_time));
-                    } else {
-                        return make_ready_future<>();
-                    }
-                });
+        for (unsigned i = 0; i < _cfg.connections; i++) {
+            _clients.push_back(std::make_unique<rpc_protocol::client>(_rpc, co, _caddr));
+        }
+        // each sweep step gets an equal slice of the job duration
+        auto step_duration = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double>(_cfg.duration) / _steps.size());
+        return do_for_each(_steps, [this, step_duration] (load_step& step) {
+            auto start = std::chrono::steady_clock::now();
+            _stop = start + step_duration;
+            return parallel_for_each(boost::irange(0u, _cfg.parallelism), [this, &step, start] (auto dummy) {
+                if (step.rps == 0) {
+                    return run_closed_loop(step, dummy);
+                }
+                return run_fixed_schedule(step, dummy, start);
+            }).then([&step, start] {
+                step.elapsed = std::chrono::steady_clock::now() - start;
             });
-          });
         }).finally([this] {
-            return _client->stop();
+            return parallel_for_each(_clients, [] (auto& c) { return c->stop(); });
         });
       });
     }
 
     virtual void emit_result(YAML::Emitter& out) const override {
-        out << YAML::Key << "messages" << YAML::Value << _total_messages;
-        out << YAML::Key << "latencies" << YAML::Comment("usec");
-        out << YAML::BeginMap;
-        out << YAML::Key << "average" << YAML::Value << (uint64_t)mean(_latencies);
-        for (auto& q: quantiles) {
-            out << YAML::Key << fmt::format("p{}", q) << YAML::Value << (uint64_t)quantile(_latencies, quantile_probability = q);
+        if (_steps.size() == 1 && _steps.front().rps == 0) {
+            out << YAML::Key << "messages" << YAML::Value << _steps.front().messages;
+            emit_latencies(out, _steps.front().latencies);
+            return;
         }
-        out << YAML::Key << "max" << YAML::Value << (uint64_t)max(_latencies);
-        out << YAML::EndMap;
+        out << YAML::Key << "curve" << YAML::Value;
+        out << YAML::BeginSeq;
+        for (const auto& step : _steps) {
+            out << YAML::BeginMap;
+            out << YAML::Key << "rps" << YAML::Value << step.rps;
+            out << YAML::Key << "achieved_rps" << YAML::Value << (uint64_t)(step.messages / step.elapsed.count());
+            out << YAML::Key << "messages" << YAML::Value << step.messages;
+            emit_latencies(out, step.latencies);
+            out << YAML::EndMap;
+        }
+        out << YAML::EndSeq;
     }
 };
 
@@ -95,11 +95,13 @@ macro (seastar_find_dependencies)
     Sanitizers
     SourceLocation
     StdAtomic
+    ZLIB
     hwloc
     lksctp-tools # No version information published.
     numactl # No version information published.
     rt
-    yaml-cpp)
+    yaml-cpp
+    zstd)
 
   # Arguments to `find_package` for each 3rd-party dependency.
   # Note that the version specification is a "minimal" version requirement.
@@ -130,6 +132,8 @@ macro (seastar_find_dependencies)
     VERSION 2.0
     OPTION ${Seastar_IO_URING})
   seastar_set_dep_args (StdAtomic REQUIRED)
+  seastar_set_dep_args (ZLIB REQUIRED
+    VERSION 1.2.8)
   seastar_set_dep_args (hwloc
     VERSION 1.11.2
     OPTION ${Seastar_HWLOC})
@@ -139,6 +143,8 @@ macro (seastar_find_dependencies)
     OPTION ${Seastar_NUMA})
   seastar_set_dep_args (yaml-cpp REQUIRED
     VERSION 0.5.1)
+  seastar_set_dep_args (zstd REQUIRED
+    VERSION 1.4.0)
 
   foreach (third_party ${_seastar_all_dependencies})
     if (NOT _seastar_dep_skip_${third_party})
@@ -27,6 +27,7 @@
 #include <seastar/util/std-compat.hh>
 #include <boost/intrusive/list.hpp>
 
+#include <array>
 #include <exception>
 #include <optional>
 #include <type_traits>
@@ -174,6 +175,12 @@ public:
         return bool(_ex);
     }
 
+    /// Returns the exception with which an abort was requested, or a null
+    /// \c exception_ptr if no abort was requested.
+    std::exception_ptr abort_requested_exception_ptr() const noexcept {
+        return _ex;
+    }
+
 
     /// Throws a \ref abort_requested_exception if cancellation has been requested.
     void check() const {
@@ -189,6 +196,56 @@ public:
     }
 };
 
+/// An \ref abort_source that is aborted as soon as any of its parent abort
+/// sources is aborted, with the parent's exception. This lets a fiber that
+/// must honor several cancellation triggers (for example a timeout, a
+/// client disconnect and a service shutdown) register a single callback
+/// with the combined source instead of one per trigger. The subscriptions
+/// to the parents are embedded in the object itself, so constructing one
+/// performs no allocation.
+///
+/// The parents must outlive this object. The object cannot be moved, as
+/// the embedded subscriptions point back into it; it is intended to be
+/// constructed in place, typically on a fiber's stack or in a request
+/// object:
+///
+/// ```
+/// composite_abort_source as(timeout_as, disconnect_as, shutdown_as);
+/// co_await do_work(as);
+/// ```
+template <std::size_t N>
+class composite_abort_source final : public abort_source {
+    std::array<optimized_optional<subscription>, N> _parent_subs;
+
+    void subscribe_to(std::size_t idx, abort_source& parent) {
+        _parent_subs[idx] = parent.subscribe([this] (const std::optional<std::exception_ptr>& ex) noexcept {
+            if (ex) {
+                request_abort_ex(*ex);
+            } else {
+                request_abort();
+            }
+        });
+        if (!_parent_subs[idx]) {
+            // The parent was aborted before we subscribed
+            request_abort_ex(parent.abort_requested_exception_ptr());
+        }
+    }
+
+public:
+    template <typename... AbortSources>
+    SEASTAR_CONCEPT(requires (sizeof...(AbortSources) == N) && (std::is_base_of_v<abort_source, AbortSources> && ...))
+    explicit composite_abort_source(AbortSources&... parents) {
+        std::size_t idx = 0;
+        (subscribe_to(idx++, parents), ...);
+    }
+
+    composite_abort_source(composite_abort_source&&) = delete;
+    composite_abort_source& operator=(composite_abort_source&&) = delete;
+};
+
+template <typename... AbortSources>
+composite_abort_source(AbortSources&...) -> composite_abort_source<sizeof...(AbortSources)>;
+
 /// @}
 
 }
@@ -31,9 +31,13 @@
 
 #include <seastar/core/future.hh>
 #include <seastar/core/cacheline.hh>
+#include <seastar/core/posix.hh>
 #include <seastar/core/sstring.hh>
 #include <seastar/core/metrics_registration.hh>
 #include <seastar/util/concepts.hh>
+#include <seastar/util/noncopyable_function.hh>
+#include <seastar/util/spinlock.hh>
+#include <optional>
 #include <type_traits>
 
 /// \file
@@ -228,5 +232,187 @@ std::future<T> submit_to(unsigned shard, Func func) {
     return submit_to(*internal::default_instance, shard, std::move(func));
 }
 
+/// A bounded, lock-free, multi-producer single-consumer queue for feeding
+/// a shard with data items from alien threads.
+///
+/// run_on() and submit_to() post one message -- and possibly one reactor
+/// wakeup -- per call, which is wasteful when foreign threads produce items
+/// at a high rate. Producers instead push() items into a shared ring and
+/// ring the doorbell only when the consumer has caught up and gone idle;
+/// the consuming shard then drain()s whatever has accumulated in one go.
+///
+/// push() may be called from any number of non-reactor threads concurrently;
+/// drain() and set_notify_action() must be called on the owning shard only.
+///
+/// \tparam T item type; must be nothrow move constructible.
+template <typename T>
+SEASTAR_CONCEPT(requires std::is_nothrow_move_constructible_v<T>)
+class mpsc_queue {
+    struct cell {
+        std::atomic<size_t> sequence;
+        std::optional<T> data;
+    };
+    instance& _instance;
+    unsigned _shard;
+    std::unique_ptr<cell[]> _cells;
+    size_t _mask;
+    // shard side
+    noncopyable_function<void ()> _notify_action = [] {};
+    alignas(seastar::cache_line_size) size_t _dequeue_pos = 0;
+    // producer side
+    alignas(seastar::cache_line_size) std::atomic<size_t> _enqueue_pos{0};
+    // true while the consumer is idle and wants a doorbell on the next push
+    alignas(seastar::cache_line_size) std::atomic<bool> _need_notify{true};
+private:
+    void notify() {
+        run_on(_instance, _shard, [this]() noexcept {
+            _notify_action();
+        });
+    }
+    bool pop(std::optional<T>& out) {
+        cell& c = _cells[_dequeue_pos & _mask];
+        if (c.sequence.load(std::memory_order_acquire) != _dequeue_pos + 1) {
+            return false;
+        }
+        out = std::move(c.data);
+        c.data.reset();
+        c.sequence.store(_dequeue_pos + _mask + 1, std::memory_order_release);
+        ++_dequeue_pos;
+        return true;
+    }
+public:
+    /// Constructs a queue owned by (and drained on) the given shard.
+    ///
+    /// \param inst the seastar instance the consuming shard belongs to
+    /// \param shard the shard drain() will be called on
+    /// \param capacity ring capacity; rounded up to a power of two
+    mpsc_queue(instance& inst, unsigned shard, size_t capacity)
+        : _instance(inst), _shard(shard) {
+        size_t n = 2;
+        while (n < capacity) {
+            n <<= 1;
+        }
+        _cells = std::make_unique<cell[]>(n);
+        _mask = n - 1;
+        for (size_t i = 0; i != n; ++i) {
+            _cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /// Sets the action to run on the owning shard when the ring transitions
+    /// from empty to non-empty. Typically drains the queue, directly or from
+    /// a woken-up fiber.
+    void set_notify_action(noncopyable_function<void ()> action) {
+        _notify_action = std::move(action);
+    }
+
+    /// \brief Push an item, from any thread.
+    ///
+    /// Returns false if the ring was full and the item was not pushed; the
+    /// producer should back off and retry.
+    bool push(T&& item) {
+        size_t pos = _enqueue_pos.load(std::memory_order_relaxed);
+        cell* c;
+        while (true) {
+            c = &_cells[pos & _mask];
+            size_t seq = c->sequence.load(std::memory_order_acquire);
+            auto diff = intptr_t(seq) - intptr_t(pos);
+            if (diff == 0) {
+                if (_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = _enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        c->data.emplace(std::move(item));
+        c->sequence.store(pos + 1, std::memory_order_release);
+        if (_need_notify.exchange(false, std::memory_order_seq_cst)) {
+            notify();
+        }
+        return true;
+    }
+
+    /// Consumes all available items, passing each to \c func.
+    ///
+    /// Re-arms the doorbell when the ring is found empty, so the next push()
+    /// triggers the notify action again. Must run on the owning shard.
+    ///
+    /// Returns the number of items consumed.
+    template <typename Func>
+    size_t drain(Func func) {
+        size_t count = 0;
+        std::optional<T> item;
+        while (true) {
+            while (pop(item)) {
+                ++count;
+                func(std::move(*item));
+            }
+            _need_notify.store(true, std::memory_order_seq_cst);
+            cell& c = _cells[_dequeue_pos & _mask];
+            if (c.sequence.load(std::memory_order_acquire) != _dequeue_pos + 1) {
+                // Really empty; the next producer rings the doorbell.
+                return count;
+            }
+            // An item raced in between draining and re-arming. Its producer
+            // saw the doorbell disarmed, so take responsibility for it --
+            // unless another push got there first, in which case a notify
+            // is already on its way.
+            if (!_need_notify.exchange(false, std::memory_order_seq_cst)) {
+                return count;
+            }
+        }
+    }
+};
+
+/// A mutual-exclusion lock for state shared between alien threads and
+/// reactors.
+///
+/// util::spinlock busy-waits, which can stall a whole shard when the
+/// holder -- typically an alien thread -- is preempted while holding the
+/// lock. adaptive_lock spins only for a short bound: an alien thread
+/// which fails to acquire the lock within the bound parks on an eventfd
+/// until the holder hands the lock over, and a reactor thread acquires
+/// the lock with lock_async(), whose future is made ready through the
+/// shard's alien message queue when its turn comes. The lock is handed
+/// over directly to a waiter on unlock, so a stream of spinning
+/// newcomers cannot starve parked waiters.
+class adaptive_lock {
+    static constexpr unsigned spin_iterations = 128;
+    struct reactor_waiter {
+        promise<> pr;
+        unsigned shard;
+    };
+    instance& _instance;
+    util::spinlock _mutex; // protects the fields below; only held briefly
+    bool _locked = false;
+    unsigned _parked = 0; // alien threads blocked on _efd
+    std::deque<std::unique_ptr<reactor_waiter>> _reactor_waiters;
+    file_desc _efd;
+public:
+    explicit adaptive_lock(instance& inst = *internal::default_instance);
+    adaptive_lock(const adaptive_lock&) = delete;
+    ~adaptive_lock();
+
+    /// Acquires the lock if it is free. Safe from any thread.
+    bool try_lock() noexcept;
+    /// Acquires the lock from an alien thread: spins for a short bound,
+    /// then blocks on the eventfd until the lock is handed over. Do not
+    /// call on a reactor thread -- it would block the whole shard; use
+    /// lock_async() there. Together with unlock() this satisfies
+    /// BasicLockable, so std::lock_guard and friends work.
+    void lock();
+    /// Releases the lock, handing it over to a parked alien thread if
+    /// there is one, or else to the oldest lock_async() waiter. Safe
+    /// from any thread.
+    void unlock();
+    /// Acquires the lock from a reactor thread. The returned future
+    /// resolves on the calling shard once the lock is held; release
+    /// with unlock().
+    future<> lock_async();
+};
+
 }
 }
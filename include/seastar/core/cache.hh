@@ -0,0 +1,303 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB
+ */
+
+#pragma once
+
+#include <seastar/core/future.hh>
+#include <seastar/core/shared_future.hh>
+#include <seastar/core/sharded.hh>
+#include <seastar/core/gate.hh>
+#include <seastar/core/lowres_clock.hh>
+#include <seastar/core/memory.hh>
+#include <seastar/core/metrics.hh>
+#include <seastar/core/sstring.hh>
+#include <seastar/util/noncopyable_function.hh>
+#include <boost/intrusive/list.hpp>
+#include <chrono>
+#include <optional>
+#include <unordered_map>
+
+namespace seastar {
+
+/// \addtogroup future-util
+/// @{
+
+/// \brief Read-through cache with miss coalescing.
+///
+/// Caches the results of an asynchronous loader function, keyed by \c Key.
+/// A lookup that misses invokes the loader; further lookups of the same key
+/// arriving while the load is in flight piggyback on it instead of starting
+/// duplicate loads, so a popular key cannot stampede its backing store.
+/// Loaded values are served for \ref config::ttl and then re-loaded on the
+/// next lookup; a loader returning a disengaged optional can be remembered
+/// as a negative entry for \ref config::negative_ttl, so repeated lookups
+/// of absent keys do not hammer the loader either.
+///
+/// The cache holds at most \ref config::max_entries entries, evicting the
+/// least recently used beyond that, and registers a memory reclaimer (at a
+/// higher tier than the default, since its contents are cheap to restore)
+/// so entries are also dropped under memory pressure.
+///
+/// A cache instance is per-shard. To partition a key space across shards,
+/// run one instance per shard inside a \ref sharded container and route
+/// lookups with \ref sharded_cache. \c Value must be copy-constructible:
+/// hits copy the cached value out, and coalesced misses hand the loaded
+/// value to every waiter.
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class cache {
+public:
+    /// Loads the value for a key missing from the cache. Returning a
+    /// disengaged optional means the key does not exist; an exceptional
+    /// future is propagated to all coalesced waiters and is not cached.
+    using loader_type = noncopyable_function<future<std::optional<Value>> (const Key&)>;
+
+    struct config {
+        /// Maximum number of entries, positive and negative together; the
+        /// least recently used entries are evicted beyond it.
+        size_t max_entries = 10000;
+        /// How long a loaded value is served before a lookup re-loads it.
+        lowres_clock::duration ttl = std::chrono::seconds(10);
+        /// How long a loader miss (disengaged optional) is remembered and
+        /// served without re-loading. Zero disables negative caching.
+        lowres_clock::duration negative_ttl = lowres_clock::duration::zero();
+        /// When non-empty, hit/miss/load counters are exported in the
+        /// "cache" metrics group, labeled with this name.
+        sstring metrics_name;
+    };
+
+    struct stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        /// loader invocations (at most one per key at a time)
+        uint64_t loads = 0;
+        /// misses that piggybacked on an in-flight load of the same key
+        uint64_t coalesced_misses = 0;
+        uint64_t evictions = 0;
+        uint64_t expirations = 0;
+    };
+
+private:
+    struct entry {
+        const Key* key;
+        std::optional<Value> value;
+        lowres_clock::time_point expiry;
+        boost::intrusive::list_member_hook<> lru_link;
+    };
+    using lru_list = boost::intrusive::list<entry,
+        boost::intrusive::member_hook<entry, boost::intrusive::list_member_hook<>, &entry::lru_link>,
+        boost::intrusive::constant_time_size<false>>;
+
+    config _cfg;
+    loader_type _loader;
+    std::unordered_map<Key, entry, Hash> _entries;
+    lru_list _lru; // least recently used first
+    std::unordered_map<Key, shared_future<std::optional<Value>>, Hash> _loading;
+    stats _stats;
+    gate _gate;
+    // declared after the containers they reference, so they unregister first
+    memory::reclaimer _reclaimer;
+    metrics::metric_groups _metrics;
+
+private:
+    void evict_one() noexcept {
+        auto& victim = _lru.front();
+        auto* key = victim.key;
+        _lru.pop_front();
+        _entries.erase(*key);
+        ++_stats.evictions;
+    }
+
+    memory::reclaiming_result reclaim() noexcept {
+        if (_lru.empty()) {
+            return memory::reclaiming_result::reclaimed_nothing;
+        }
+        auto n = std::max<size_t>(_entries.size() / 8, 1);
+        while (n-- && !_lru.empty()) {
+            evict_one();
+        }
+        return memory::reclaiming_result::reclaimed_something;
+    }
+
+    void store(const Key& key, const std::optional<Value>& v) {
+        auto ttl = v ? _cfg.ttl : _cfg.negative_ttl;
+        if (ttl == lowres_clock::duration::zero()) {
+            return;
+        }
+        while (_entries.size() >= _cfg.max_entries && !_lru.empty()) {
+            evict_one();
+        }
+        auto [it, inserted] = _entries.try_emplace(key);
+        auto& e = it->second;
+        if (!inserted) {
+            _lru.erase(_lru.iterator_to(e));
+        }
+        e.key = &it->first;
+        e.value = v;
+        e.expiry = lowres_clock::now() + ttl;
+        _lru.push_back(e);
+    }
+
+    void setup_metrics() {
+        namespace sm = seastar::metrics;
+        auto name = sm::label_instance("cache", _cfg.metrics_name);
+        _metrics.add_group("cache", {
+            sm::make_counter("hits", sm::description("Lookups served from the cache"),
+                    { name }, [this] { return _stats.hits; }),
+            sm::make_counter("misses", sm::description("Lookups that had to consult the loader"),
+                    { name }, [this] { return _stats.misses; }),
+            sm::make_counter("loads", sm::description("Loader invocations"),
+                    { name }, [this] { return _stats.loads; }),
+            sm::make_counter("coalesced_misses", sm::description("Misses that piggybacked on an in-flight load of the same key"),
+                    { name }, [this] { return _stats.coalesced_misses; }),
+            sm::make_counter("evictions", sm::description("Entries evicted by the size limit or memory pressure"),
+                    { name }, [this] { return _stats.evictions; }),
+            sm::make_counter("expirations", sm::description("Entries dropped because their TTL elapsed"),
+                    { name }, [this] { return _stats.expirations; }),
+        });
+    }
+
+public:
+    cache(config cfg, loader_type loader)
+        : _cfg(std::move(cfg))
+        , _loader(std::move(loader))
+        , _reclaimer([this] { return reclaim(); }, memory::reclaimer_scope::async, 1)
+    {
+        if (!_cfg.metrics_name.empty()) {
+            setup_metrics();
+        }
+    }
+
+    cache(cache&&) = delete;
+    cache(const cache&) = delete;
+
+    /// \brief Look up a key, loading it on a miss.
+    ///
+    /// Returns the cached value, or invokes the loader and caches what it
+    /// returns. A disengaged result means the key does not exist. Lookups
+    /// of a key whose load is already in flight share that load's future.
+    future<std::optional<Value>> get(const Key& key) {
+        auto it = _entries.find(key);
+        if (it != _entries.end()) {
+            auto& e = it->second;
+            if (e.expiry > lowres_clock::now()) {
+                ++_stats.hits;
+                _lru.erase(_lru.iterator_to(e));
+                _lru.push_back(e);
+                return make_ready_future<std::optional<Value>>(e.value);
+            }
+            ++_stats.expirations;
+            _lru.erase(_lru.iterator_to(e));
+            _entries.erase(it);
+        }
+        ++_stats.misses;
+        if (auto lit = _loading.find(key); lit != _loading.end()) {
+            ++_stats.coalesced_misses;
+            return lit->second.get_future();
+        }
+        ++_stats.loads;
+        auto f = with_gate(_gate, [this, &key] {
+            return _loader(key);
+        }).then_wrapped([this, key] (future<std::optional<Value>> f) {
+            _loading.erase(key);
+            if (f.failed()) {
+                return f;
+            }
+            auto v = f.get0();
+            store(key, v);
+            return make_ready_future<std::optional<Value>>(std::move(v));
+        });
+        auto [lit, inserted] = _loading.emplace(key, shared_future<std::optional<Value>>(std::move(f)));
+        return lit->second.get_future();
+    }
+
+    /// Drops a key from the cache, if present. Does not affect a load
+    /// already in flight for it.
+    void invalidate(const Key& key) {
+        auto it = _entries.find(key);
+        if (it != _entries.end()) {
+            _lru.erase(_lru.iterator_to(it->second));
+            _entries.erase(it);
+        }
+    }
+
+    /// Drops all cached entries.
+    void clear() noexcept {
+        _lru.clear();
+        _entries.clear();
+    }
+
+    size_t size() const noexcept {
+        return _entries.size();
+    }
+
+    const stats& get_stats() const noexcept {
+        return _stats;
+    }
+
+    /// Waits for in-flight loads; required by \ref sharded.
+    future<> stop() {
+        return _gate.close();
+    }
+};
+
+/// \brief Routes \ref cache lookups to the shard owning each key.
+///
+/// A \ref cache instance is per-shard; running one per shard inside a
+/// \ref sharded container and going through sharded_cache partitions the
+/// key space by hash, so every key is loaded and cached on exactly one
+/// shard and the duplicate-load protection is system-wide rather than
+/// per-shard. Lookups of locally-owned keys stay on the fast path.
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class sharded_cache {
+    sharded<cache<Key, Value, Hash>>& _cache;
+public:
+    explicit sharded_cache(sharded<cache<Key, Value, Hash>>& c) noexcept : _cache(c) {}
+
+    /// The shard a key is cached on.
+    unsigned shard_of(const Key& key) const noexcept {
+        return Hash()(key) % smp::count;
+    }
+
+    /// \brief Look up a key on its owning shard, loading it on a miss.
+    ///
+    /// See \ref cache::get(). \c Key and \c Value must be safe to copy
+    /// across shards.
+    future<std::optional<Value>> get(const Key& key) {
+        auto shard = shard_of(key);
+        if (shard == this_shard_id()) {
+            return _cache.local().get(key);
+        }
+        return _cache.invoke_on(shard, [key] (cache<Key, Value, Hash>& c) {
+            return c.get(key);
+        });
+    }
+
+    /// Drops a key from its owning shard's cache, if present.
+    future<> invalidate(const Key& key) {
+        return _cache.invoke_on(shard_of(key), [key] (cache<Key, Value, Hash>& c) {
+            c.invalidate(key);
+        });
+    }
+};
+
+/// @}
+
+} // namespace seastar
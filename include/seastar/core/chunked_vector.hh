@@ -0,0 +1,270 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB Ltd.
+ */
+
+#pragma once
+
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace seastar {
+
+// An unbounded vector of objects of type T with O(1) random access.
+//
+// chunked_vector is to std::vector what chunked_fifo is to std::deque:
+// the items are stored in fixed-size, separately allocated chunks, so the
+// container never performs a large contiguous allocation, no matter how
+// big it grows. The only contiguous structure is the directory of chunk
+// pointers, which is smaller than the data by a factor of items_per_chunk
+// and is the only thing reallocated on growth - the items themselves never
+// move, so growing never copies or moves a T, and references to items are
+// invalidated only by erasing them (via pop_back(), resize() or clear()).
+//
+// This matters for large accumulations (e.g. multi-gigabyte result sets):
+// std::vector's doubling both requires a huge contiguous allocation, which
+// may be impossible when memory is fragmented, and transiently holds up to
+// 2x the needed memory while copying into the new buffer.
+//
+// Unlike chunked_fifo, chunked_vector grows and shrinks only at the back:
+// it provides push_back()/emplace_back()/pop_back() but no pop_front().
+// Like chunked_fifo, it makes the chunk size a template parameter, keeps
+// it a power of two so that locating an item is a shift and a mask, and
+// uses uninitialized storage for unoccupied slots.
+//
+// reserve() allocates whole chunks, so reserving for an estimated size
+// that turns out to be too large wastes at most one chunk of memory per
+// reserve() call once the vector is shrunk back (see shrink_to_fit()).
+
+template <typename T, size_t items_per_chunk = 128>
+class chunked_vector {
+    static_assert((items_per_chunk & (items_per_chunk - 1)) == 0,
+            "chunked_vector chunk size must be power of two");
+    union maybe_item {
+        maybe_item() noexcept {}
+        ~maybe_item() {}
+        T data;
+    };
+    struct chunk {
+        maybe_item items[items_per_chunk];
+    };
+    // Directory of chunks. The first size()/items_per_chunk chunks are
+    // full, the following one (if any) holds the vector's tail, and any
+    // further chunks are reserved capacity. Only this array is
+    // reallocated as the vector grows; the chunks themselves stay put.
+    std::vector<chunk*> _chunks;
+    size_t _size = 0;
+public:
+    using value_type = T;
+    using size_type = size_t;
+    using reference = T&;
+    using pointer = T*;
+    using const_reference = const T&;
+    using const_pointer = const T*;
+
+public:
+    template <typename U>
+    class basic_iterator {
+        friend class chunked_vector;
+        template <typename> friend class basic_iterator;
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using difference_type = std::ptrdiff_t;
+        using value_type = U;
+        using pointer = U*;
+        using reference = U&;
+
+    private:
+        chunk* const* _chunks = nullptr;
+        size_t _index = 0;
+
+        inline basic_iterator(chunk* const* chunks, size_t index) noexcept
+                : _chunks(chunks), _index(index) {}
+
+    public:
+        basic_iterator() noexcept = default;
+        // iterator converts to const_iterator
+        template <typename V>
+        basic_iterator(const basic_iterator<V>& o) noexcept
+                requires (std::is_const_v<U> && std::is_same_v<V, std::remove_const_t<U>>)
+                : _chunks(o._chunks), _index(o._index) {}
+        bool operator==(const basic_iterator& o) const noexcept { return _index == o._index; }
+        bool operator!=(const basic_iterator& o) const noexcept { return _index != o._index; }
+        bool operator<(const basic_iterator& o) const noexcept { return _index < o._index; }
+        bool operator>(const basic_iterator& o) const noexcept { return _index > o._index; }
+        bool operator<=(const basic_iterator& o) const noexcept { return _index <= o._index; }
+        bool operator>=(const basic_iterator& o) const noexcept { return _index >= o._index; }
+        pointer operator->() const noexcept {
+            return &_chunks[_index / items_per_chunk]->items[chunked_vector::mask(_index)].data;
+        }
+        reference operator*() const noexcept { return *operator->(); }
+        reference operator[](difference_type n) const noexcept { return *(*this + n); }
+        basic_iterator& operator++() noexcept { ++_index; return *this; }
+        basic_iterator operator++(int) noexcept { auto it = *this; ++_index; return it; }
+        basic_iterator& operator--() noexcept { --_index; return *this; }
+        basic_iterator operator--(int) noexcept { auto it = *this; --_index; return it; }
+        basic_iterator& operator+=(difference_type n) noexcept { _index += n; return *this; }
+        basic_iterator& operator-=(difference_type n) noexcept { _index -= n; return *this; }
+        basic_iterator operator+(difference_type n) const noexcept { auto it = *this; it += n; return it; }
+        basic_iterator operator-(difference_type n) const noexcept { auto it = *this; it -= n; return it; }
+        friend basic_iterator operator+(difference_type n, basic_iterator it) noexcept { return it + n; }
+        difference_type operator-(const basic_iterator& o) const noexcept {
+            return difference_type(_index) - difference_type(o._index);
+        }
+    };
+
+    using iterator = basic_iterator<T>;
+    using const_iterator = basic_iterator<const T>;
+
+public:
+    chunked_vector() noexcept = default;
+    chunked_vector(chunked_vector&& x) noexcept
+            : _chunks(std::move(x._chunks)), _size(std::exchange(x._size, 0)) {
+        x._chunks.clear();
+    }
+    chunked_vector(const chunked_vector&) = delete;
+    ~chunked_vector() {
+        clear();
+        shrink_to_fit();
+    }
+    chunked_vector& operator=(const chunked_vector&) = delete;
+    chunked_vector& operator=(chunked_vector&& x) noexcept {
+        if (&x != this) {
+            this->~chunked_vector();
+            new (this) chunked_vector(std::move(x));
+        }
+        return *this;
+    }
+
+    bool empty() const noexcept { return !_size; }
+    size_t size() const noexcept { return _size; }
+    size_t capacity() const noexcept { return _chunks.size() * items_per_chunk; }
+
+    T& operator[](size_t i) noexcept {
+        return _chunks[i / items_per_chunk]->items[mask(i)].data;
+    }
+    const T& operator[](size_t i) const noexcept {
+        return _chunks[i / items_per_chunk]->items[mask(i)].data;
+    }
+    T& at(size_t i) {
+        check_bounds(i);
+        return (*this)[i];
+    }
+    const T& at(size_t i) const {
+        check_bounds(i);
+        return (*this)[i];
+    }
+    T& front() noexcept { return (*this)[0]; }
+    const T& front() const noexcept { return (*this)[0]; }
+    T& back() noexcept { return (*this)[_size - 1]; }
+    const T& back() const noexcept { return (*this)[_size - 1]; }
+
+    template <typename... Args>
+    T& emplace_back(Args&&... args) {
+        if (_size == capacity()) {
+            add_chunk();
+        }
+        auto p = &_chunks[_size / items_per_chunk]->items[mask(_size)].data;
+        // If the constructor throws, the new chunk (if any) simply remains
+        // as reserved capacity, so there is nothing to undo.
+        new (p) T(std::forward<Args>(args)...);
+        ++_size;
+        return *p;
+    }
+    void push_back(const T& data) {
+        emplace_back(data);
+    }
+    void push_back(T&& data) {
+        emplace_back(std::move(data));
+    }
+    void pop_back() noexcept {
+        --_size;
+        (*this)[_size].~T();
+    }
+
+    void clear() noexcept {
+        while (_size) {
+            pop_back();
+        }
+    }
+    // reserve(n) ensures that at least (n - size()) further push_back()
+    // calls can be served without needing new memory allocation. Memory is
+    // allocated in whole chunks; reserve() does not reduce the amount of
+    // memory already reserved - use shrink_to_fit() for that.
+    void reserve(size_t n) {
+        auto needed_chunks = (n + items_per_chunk - 1) / items_per_chunk;
+        if (needed_chunks <= _chunks.size()) {
+            return;
+        }
+        _chunks.reserve(needed_chunks);
+        while (_chunks.size() < needed_chunks) {
+            add_chunk();
+        }
+    }
+    // resize() appends default-constructed items, or destroys items from
+    // the back, until size() == n.
+    void resize(size_t n) {
+        reserve(n);
+        while (_size > n) {
+            pop_back();
+        }
+        while (_size < n) {
+            emplace_back();
+        }
+    }
+    // shrink_to_fit() frees whole chunks of memory held, but unused, by
+    // the vector. Such unused memory might exist after pops or because of
+    // reserve(). The partially-filled tail chunk, if any, is kept.
+    void shrink_to_fit() noexcept {
+        auto used_chunks = (_size + items_per_chunk - 1) / items_per_chunk;
+        while (_chunks.size() > used_chunks) {
+            delete _chunks.back();
+            _chunks.pop_back();
+        }
+    }
+
+    iterator begin() noexcept { return iterator(_chunks.data(), 0); }
+    iterator end() noexcept { return iterator(_chunks.data(), _size); }
+    const_iterator begin() const noexcept { return const_iterator(_chunks.data(), 0); }
+    const_iterator end() const noexcept { return const_iterator(_chunks.data(), _size); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+private:
+    void add_chunk() {
+        // Reserve the directory slot first, so that a directory
+        // reallocation failure cannot leak the new chunk.
+        _chunks.reserve(_chunks.size() + 1);
+        _chunks.push_back(new chunk);
+    }
+    void check_bounds(size_t i) const {
+        if (i >= _size) {
+            throw std::out_of_range("chunked_vector::at() out of range");
+        }
+    }
+    static size_t mask(size_t idx) noexcept {
+        return idx & (items_per_chunk - 1);
+    }
+};
+
+}
@@ -0,0 +1,195 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright 2026 ScyllaDB
+ */
+
+#pragma once
+
+#include <seastar/core/memory.hh>
+#include <boost/intrusive/list.hpp>
+
+namespace seastar {
+
+/// \addtogroup utilities-module
+/// @{
+
+/// Entry size functor for \ref clock_lru elements whose memory
+/// footprint is not tracked; every entry counts as one byte, so
+/// eviction targets degenerate to entry counts.
+template <typename T>
+struct uniform_entry_size {
+    size_t operator()(const T&) const noexcept {
+        return 1;
+    }
+};
+
+template <typename T, typename EntrySize = uniform_entry_size<T>>
+class clock_lru;
+
+/// Intrusive hook making a class usable with \ref clock_lru.
+///
+/// Derive the cached element from this hook. touch() is the hot-path
+/// operation: it marks the element as recently used with a single
+/// plain (non-atomic) bit write — clock_lru, like all Seastar
+/// containers, is a per-shard structure and needs no synchronization.
+class lru_hook : public boost::intrusive::list_base_hook<> {
+    bool _referenced = false;
+    template <typename T, typename EntrySize>
+    friend class clock_lru;
+public:
+    /// Marks the element as recently used. May be called whether or
+    /// not the element is currently held by a clock_lru.
+    void touch() noexcept {
+        _referenced = true;
+    }
+};
+
+/// An intrusive cache eviction order with CLOCK-style approximate
+/// recency.
+///
+/// A classic LRU list splices the element to the front on every hit,
+/// costing two pointer updates and dirtying list nodes on a read-only
+/// path. clock_lru instead keeps elements in insertion order and
+/// tracks recency with a referenced bit: a hit just sets the bit (see
+/// \ref lru_hook::touch()), and the eviction scan gives marked
+/// elements a second chance, clearing their bit and rotating them to
+/// the back. The result approximates LRU while making cache hits
+/// nearly free, which is what a read-heavy cache wants.
+///
+/// The container does not own its elements and never destroys them;
+/// eviction hands victims to a caller-supplied disposer, and batch
+/// eviction (\ref evict()) amortizes the scan. Memory accounting is
+/// built in: EntrySize reports each element's footprint (it must
+/// return the same value at insert and removal time), and
+/// \ref make_reclaimer() hooks the accounted total up to the memory
+/// subsystem so the cache shrinks under allocation pressure.
+///
+/// Elements must be removed (or evicted) before they are destroyed
+/// and before the container is destroyed.
+template <typename T, typename EntrySize>
+class clock_lru {
+    // Front is the clock hand (next eviction candidate), back is the
+    // most recently inserted or second-chanced element.
+    boost::intrusive::list<T, boost::intrusive::base_hook<lru_hook>, boost::intrusive::constant_time_size<false>> _list;
+    size_t _size = 0;
+    size_t _bytes = 0;
+    [[no_unique_address]] EntrySize _entry_size;
+public:
+    clock_lru() = default;
+    clock_lru(EntrySize entry_size) : _entry_size(std::move(entry_size)) {}
+    clock_lru(clock_lru&&) = default;
+    clock_lru& operator=(clock_lru&&) = default;
+
+    /// Inserts an element, initially unreferenced, as the most
+    /// recently used.
+    void insert(T& e) noexcept {
+        static_cast<lru_hook&>(e)._referenced = false;
+        _list.push_back(e);
+        _size++;
+        _bytes += _entry_size(e);
+    }
+
+    /// Removes an element, e.g. because it was invalidated or is
+    /// about to be destroyed. Must not be called on elements already
+    /// handed out by evict_one()/evict().
+    void remove(T& e) noexcept {
+        _list.erase(_list.iterator_to(e));
+        _size--;
+        _bytes -= _entry_size(e);
+    }
+
+    /// Runs the clock hand and unlinks the least recently used
+    /// unreferenced element. Referenced elements passed over get
+    /// their bit cleared and a second chance at the back, so an
+    /// element survives eviction exactly as long as it keeps being
+    /// touched between scans.
+    ///
+    /// \return the victim, or nullptr if the container is empty. The
+    ///         caller takes ownership.
+    T* evict_one() noexcept {
+        while (!_list.empty()) {
+            T& e = _list.front();
+            auto& hook = static_cast<lru_hook&>(e);
+            if (!hook._referenced) {
+                remove(e);
+                return &e;
+            }
+            // second chance; the cleared bit bounds the scan to one
+            // full rotation
+            hook._referenced = false;
+            _list.pop_front();
+            _list.push_back(e);
+        }
+        return nullptr;
+    }
+
+    /// Evicts elements until at least \c bytes of accounted footprint
+    /// have been released or the container is empty, passing each
+    /// victim to \c dispose.
+    ///
+    /// \return the number of bytes released.
+    template <typename Disposer>
+    size_t evict(size_t bytes, Disposer&& dispose) noexcept {
+        size_t released = 0;
+        while (released < bytes) {
+            T* victim = evict_one();
+            if (!victim) {
+                break;
+            }
+            released += _entry_size(*victim);
+            dispose(victim);
+        }
+        return released;
+    }
+
+    /// Registers this container with the memory subsystem: under
+    /// allocation pressure the reclaimer evicts a batch covering the
+    /// requested amount via \c dispose. The disposer must free the
+    /// victim's memory synchronously and must not allocate.
+    ///
+    /// The returned \ref memory::reclaimer must not outlive the
+    /// container.
+    template <typename Disposer>
+    memory::reclaimer make_reclaimer(Disposer dispose, memory::reclaimer_scope scope = memory::reclaimer_scope::sync, memory::reclaimer_tier tier = 0) {
+        return memory::reclaimer([this, dispose = std::move(dispose)] (memory::reclaimer::request r) {
+            if (evict(r.bytes_to_reclaim, dispose)) {
+                return memory::reclaiming_result::reclaimed_something;
+            }
+            return memory::reclaiming_result::reclaimed_nothing;
+        }, scope, tier);
+    }
+
+    /// The number of elements held.
+    size_t size() const noexcept {
+        return _size;
+    }
+
+    /// The accounted memory footprint of the elements held.
+    size_t bytes() const noexcept {
+        return _bytes;
+    }
+
+    bool empty() const noexcept {
+        return _list.empty();
+    }
+};
+
+/// @}
+
+}
@@ -34,6 +34,14 @@ namespace seastar {
 
 namespace internal {
 
+/// \cond internal
+// Coroutine frames are carved from a dedicated per-shard, size-classed
+// freelist arena instead of going through operator new for every frame;
+// see memory.cc.
+void* allocate_coroutine_frame(size_t size);
+void free_coroutine_frame(void* ptr, size_t size) noexcept;
+/// \endcond
+
 template <typename T = void>
 class coroutine_traits_base {
 public:
@@ -44,6 +52,13 @@ public:
         promise_type(promise_type&&) = delete;
         promise_type(const promise_type&) = delete;
 
+        void* operator new(std::size_t size) {
+            return allocate_coroutine_frame(size);
+        }
+        void operator delete(void* ptr, std::size_t size) noexcept {
+            free_coroutine_frame(ptr, size);
+        }
+
         template<typename... U>
         void return_value(U&&... value) {
             _promise.set_value(std::forward<U>(value)...);
@@ -96,6 +111,13 @@ public:
         promise_type(promise_type&&) = delete;
         promise_type(const promise_type&) = delete;
 
+        void* operator new(std::size_t size) {
+            return allocate_coroutine_frame(size);
+        }
+        void operator delete(void* ptr, std::size_t size) noexcept {
+            free_coroutine_frame(ptr, size);
+        }
+
         void return_void() noexcept {
             _promise.set_value();
         }
@@ -25,6 +25,8 @@
 #include <cassert>
 #include <cstdlib>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace seastar {
 
@@ -73,7 +75,16 @@ public:
     /// deleter are both destroyed.
     ///
     /// \return a deleter with the same encapsulated action as this one.
-    deleter share();
+    deleter share() &;
+    /// Shares an expiring deleter.  Since the original is known at compile
+    /// time to be going away, its reference is handed over to the result
+    /// instead of manipulating reference counts.  Equivalent to share()
+    /// immediately followed by destroying the original.
+    ///
+    /// \return a deleter with the same encapsulated action as this one.
+    deleter share() && noexcept {
+        return deleter(std::exchange(_impl, nullptr));
+    }
     /// Checks whether the deleter has an associated action.
     explicit operator bool() const noexcept { return bool(_impl); }
     /// \cond internal
@@ -112,6 +123,9 @@ struct deleter::impl {
     deleter next;
     impl(deleter next) : next(std::move(next)) {}
     virtual ~impl() {}
+    // Lets append() fold a plain free into this impl instead of growing
+    // the chain; overridden by free_vector_deleter_impl.
+    virtual bool try_append_free(void*) { return false; }
 };
 /// \endcond
 
@@ -188,11 +202,27 @@ struct free_deleter_impl final : deleter::impl {
     free_deleter_impl(void* obj) : impl(deleter()), obj(obj) {}
     virtual ~free_deleter_impl() override { std::free(obj); }
 };
+
+// Flattened form of a chain of plain frees: one impl, one virtual call,
+// however many buffers accumulated.
+struct free_vector_deleter_impl final : deleter::impl {
+    std::vector<void*> objs;
+    free_vector_deleter_impl() : impl(deleter()) {}
+    virtual ~free_vector_deleter_impl() override {
+        for (auto obj : objs) {
+            std::free(obj);
+        }
+    }
+    virtual bool try_append_free(void* obj) override {
+        objs.push_back(obj);
+        return true;
+    }
+};
 /// \endcond
 
 inline
 deleter
-deleter::share() {
+deleter::share() & {
     if (!_impl) {
         return deleter();
     }
@@ -218,9 +248,25 @@ void deleter::append(deleter d) {
             return; // Already appended
         }
         if (is_raw_object(next_impl)) {
+            if (is_raw_object(d._impl)) {
+                // Two plain frees: flatten into a single impl that later
+                // appends can keep folding into, instead of starting a chain
+                auto fv = std::make_unique<free_vector_deleter_impl>();
+                fv->objs.reserve(2);
+                fv->objs.push_back(to_raw_object(next_impl));
+                fv->objs.push_back(d.to_raw_object());
+                d._impl = nullptr;
+                next_d->_impl = fv.release();
+                return;
+            }
             next_d->_impl = next_impl = new free_deleter_impl(to_raw_object(next_impl));
         }
 
+        if (next_impl->refs == 1 && is_raw_object(d._impl) && next_impl->try_append_free(d.to_raw_object())) {
+            d._impl = nullptr;
+            return;
+        }
+
         if (next_impl->refs != 1) {
             next_d->_impl = next_impl = make_object_deleter_impl(deleter(next_impl), std::move(d));
             return;
@@ -106,16 +106,28 @@ class fair_queue_entry {
 
     fair_queue_ticket _ticket;
     bi::slist_member_hook<> _hook;
+    std::chrono::steady_clock::time_point _deadline = no_deadline;
 
 public:
+    /// Entries with no deadline are dispatched in FIFO order within their class.
+    static constexpr std::chrono::steady_clock::time_point no_deadline = std::chrono::steady_clock::time_point::max();
+
     fair_queue_entry(fair_queue_ticket t) noexcept
         : _ticket(std::move(t)) {}
+    /// Constructs an entry carrying a target completion time. Within its
+    /// class, such entries are dispatched earliest-deadline-first, ahead
+    /// of deadline-less ones, while consuming the class's share budget
+    /// as usual.
+    fair_queue_entry(fair_queue_ticket t, std::chrono::steady_clock::time_point deadline) noexcept
+        : _ticket(std::move(t))
+        , _deadline(deadline) {}
     using container_list_t = bi::slist<fair_queue_entry,
             bi::constant_time_size<false>,
             bi::cache_last<true>,
             bi::member_hook<fair_queue_entry, bi::slist_member_hook<>, &fair_queue_entry::_hook>>;
 
     fair_queue_ticket ticket() const noexcept { return _ticket; }
+    std::chrono::steady_clock::time_point deadline() const noexcept { return _deadline; }
 };
 
 /// \brief Group of queues class
@@ -186,6 +198,25 @@ public:
     using rate_resolution = std::milli;
     using token_bucket_t = internal::shared_token_bucket<capacity_t, rate_resolution, internal::capped_release::yes>;
 
+    /// \brief Pool of spare capacity shared by several fair groups
+    ///
+    /// When one device is managed by more than one group each of them gets
+    /// a fraction of the device rate. A group that doesn't use its fraction
+    /// up deposits the unused tokens here, and a group that ran out of its
+    /// own tokens claims them back in bounded leases, so the device
+    /// utilization tracks demand rather than the static partitioning. The
+    /// pool size is capped, so a long-idle group cannot accumulate an
+    /// unbounded burst.
+    class capacity_pool {
+        std::atomic<capacity_t> _spare = 0;
+        const capacity_t _limit;
+    public:
+        explicit capacity_pool(capacity_t limit) noexcept : _limit(limit) {}
+        capacity_pool(capacity_pool&&) = delete;
+        void deposit(capacity_t cap) noexcept;
+        capacity_t claim(capacity_t upto) noexcept;
+    };
+
 private:
 
     /*
@@ -209,6 +240,8 @@ private:
 
     const fair_queue_ticket _cost_capacity;
     token_bucket_t _token_bucket;
+    // not owned, lives in the io_group that groups share the device with
+    capacity_pool* _spare_pool = nullptr;
 
 public:
 
@@ -245,6 +278,9 @@ public:
 
     fair_queue_ticket cost_capacity() const noexcept { return _cost_capacity; }
     capacity_t maximum_capacity() const noexcept { return _token_bucket.limit(); }
+    // May only be set while the group is quiescent (during setup); the pool
+    // must outlive the group.
+    void set_spare_pool(capacity_pool* pool) noexcept { _spare_pool = pool; }
     capacity_t grab_capacity(capacity_t cap) noexcept;
     clock_type::time_point replenished_ts() const noexcept { return _token_bucket.replenished_ts(); }
     void release_capacity(capacity_t cap) noexcept;
@@ -254,6 +290,12 @@ public:
     capacity_t capacity_deficiency(capacity_t from) const noexcept;
     capacity_t ticket_capacity(fair_queue_ticket ticket) const noexcept;
 
+    /// \returns the capacity the token bucket replenishes over \c delta
+    template <typename Rep, typename Per>
+    capacity_t accumulated_in(std::chrono::duration<Rep, Per> delta) const noexcept {
+        return _token_bucket.accumulated_in(delta);
+    }
+
     std::chrono::duration<double> rate_limit_duration() const noexcept {
         std::chrono::duration<double, rate_resolution> dur((double)_token_bucket.limit() / _token_bucket.rate());
         return std::chrono::duration_cast<std::chrono::duration<double>>(dur);
@@ -292,18 +334,42 @@ public:
 
     using class_id = unsigned int;
     class priority_class_data;
+    /// Identifies a group of priority classes (a "service"); see
+    /// \ref register_class_group.
+    using group_id = unsigned int;
+    class class_group_data;
     using capacity_t = fair_group::capacity_t;
     using signed_capacity_t = std::make_signed<capacity_t>::type;
 
 private:
     using clock_type = std::chrono::steady_clock;
     using priority_class_ptr = priority_class_data*;
+    /*
+     * The part common to both levels of the class tree -- a priority
+     * class or a class group. The dispatch heaps are ordered by the
+     * node's accumulated (shares-scaled) cost.
+     */
+    struct dispatch_node {
+        uint32_t _shares;
+        capacity_t _accumulated = 0;
+        bool _queued = false;
+        const bool _is_group;
+
+        dispatch_node(uint32_t shares, bool is_group) noexcept
+            : _shares(std::max(shares, 1u))
+            , _is_group(is_group) {}
+
+        void update_shares(uint32_t shares) noexcept {
+            _shares = (std::max(shares, 1u));
+        }
+    };
+    using dispatch_node_ptr = dispatch_node*;
     struct class_compare {
-        bool operator() (const priority_class_ptr& lhs, const priority_class_ptr & rhs) const noexcept;
+        bool operator() (const dispatch_node_ptr& lhs, const dispatch_node_ptr& rhs) const noexcept;
     };
 
-    class priority_queue : public std::priority_queue<priority_class_ptr, std::vector<priority_class_ptr>, class_compare> {
-        using super = std::priority_queue<priority_class_ptr, std::vector<priority_class_ptr>, class_compare>;
+    class priority_queue : public std::priority_queue<dispatch_node_ptr, std::vector<dispatch_node_ptr>, class_compare> {
+        using super = std::priority_queue<dispatch_node_ptr, std::vector<dispatch_node_ptr>, class_compare>;
     public:
         void reserve(size_t len) {
             c.reserve(len);
@@ -323,7 +389,9 @@ private:
     unsigned _requests_queued = 0;
     priority_queue _handles;
     std::vector<std::unique_ptr<priority_class_data>> _priority_classes;
+    std::vector<std::unique_ptr<class_group_data>> _class_groups;
     size_t _nr_classes = 0;
+    size_t _nr_groups = 0;
     capacity_t _last_accumulated = 0;
 
     /*
@@ -348,9 +416,14 @@ private:
 
     void push_priority_class(priority_class_data& pc) noexcept;
     void push_priority_class_from_idle(priority_class_data& pc) noexcept;
+    void push_group_from_idle(class_group_data& g) noexcept;
     void pop_priority_class(priority_class_data& pc) noexcept;
     void plug_priority_class(priority_class_data& pc) noexcept;
     void unplug_priority_class(priority_class_data& pc) noexcept;
+    // Adds req_cost to the node's accumulated cost, rebasing all the
+    // nodes of the same domain (the classes of \c domain, or the
+    // top-level nodes when it's nullptr) on signed overflow.
+    void charge(dispatch_node& n, capacity_t req_cost, class_group_data* domain) noexcept;
 
     enum class grab_result { grabbed, cant_preempt, pending };
     grab_result grab_capacity(const fair_queue_entry& ent) noexcept;
@@ -370,6 +443,13 @@ public:
     /// \param shares how many shares to create this class with
     void register_priority_class(class_id c, uint32_t shares);
 
+    /// Registers a priority class as a member of a class group.
+    ///
+    /// The class competes by \c shares with the other member classes of
+    /// \c parent only; the group as a whole competes with its siblings
+    /// (see \ref register_class_group).
+    void register_priority_class(class_id c, uint32_t shares, group_id parent);
+
     /// Unregister a priority class.
     ///
     /// It is illegal to unregister a priority class that still have pending requests.
@@ -377,6 +457,31 @@ public:
 
     void update_shares_for_class(class_id c, uint32_t new_shares);
 
+    /// Registers a class group (a "service") against this fair queue.
+    ///
+    /// A class group forms the middle level of a two-level hierarchy:
+    /// member classes (tenants) compete with each other by their shares,
+    /// while the group as a whole competes against other groups and
+    /// ungrouped classes with \c shares. Dispatched capacity is charged
+    /// on both levels, so one tenant cannot starve another tenant of the
+    /// same service no matter how the service itself is scheduled.
+    ///
+    /// \param g group identifier
+    /// \param shares how many shares the group has among its siblings
+    /// \param cap if non-zero, the fraction (0.0 < \c cap <= 1.0) of the
+    ///            underlying \ref fair_group rate that the member classes
+    ///            together may consume from this queue -- even when the
+    ///            rest of the queue is idle
+    void register_class_group(group_id g, uint32_t shares, float cap = 0.0f);
+
+    /// Unregister a class group.
+    ///
+    /// It is illegal to unregister a group that still has member classes
+    /// registered.
+    void unregister_class_group(group_id g);
+
+    void update_shares_for_class_group(group_id g, uint32_t new_shares);
+
     /// \return how many waiters are currently queued for all classes.
     [[deprecated("fair_queue users should not track individual requests, but resources (weight, size) passing through the queue")]]
     size_t waiters() const;
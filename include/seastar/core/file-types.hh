@@ -59,6 +59,25 @@ inline void operator&=(open_flags& a, open_flags b) {
     a = (a & b);
 }
 
+/// Expected lifetime of the data written to a file, hinted to the device.
+///
+/// Flash devices use the hint to place data with similar lifetimes in the
+/// same erase units, so that, for example, short-lived commit log pages do
+/// not share erase blocks with long-lived data pages and inflate write
+/// amplification when the log wraps. Maps to the kernel's
+/// RWH_WRITE_LIFE_* fcntl hints; it is advisory and ignored by devices
+/// and kernels that do not support it.
+///
+/// \see file_open_options::lifetime_hint
+enum class write_lifetime_hint {
+    not_set,     ///< Leave the kernel default (or inherited) hint in place
+    none,        ///< Explicitly no hint
+    short_lived, ///< Data is expected to be overwritten or deleted soon
+    medium,      ///< Lifetime longer than short_lived, shorter than long_lived
+    long_lived,  ///< Data is expected to stay for a long time
+    extreme,     ///< Lifetime longer than all other hints
+};
+
 /// Enumeration describing the type of a directory entry being listed.
 ///
 /// \see file::list_directory()
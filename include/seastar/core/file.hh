@@ -73,6 +73,21 @@ struct stat_data {
     std::chrono::system_clock::time_point time_changed;   // Time of last status change (either content or attributes)
 };
 
+/// A range of offsets within a file.
+struct file_range {
+    uint64_t offset;
+    uint64_t length;
+};
+
+/// A contiguous range of file offsets backed by allocated storage, as
+/// reported by \ref file::query_extents().
+struct file_extent {
+    uint64_t offset;
+    uint64_t length;
+    /// The extent is allocated but was never written; reads return zeros.
+    bool unwritten;
+};
+
 /// File open options
 ///
 /// Options used to configure an open file.
@@ -84,6 +99,7 @@ struct file_open_options {
     uint64_t sloppy_size_hint = 1 << 20; ///< Hint as to what the eventual file size will be
     file_permissions create_permissions = file_permissions::default_file_permissions; ///< File permissions to use when creating a file
     bool append_is_unlikely = false; ///< Hint that user promises (or at least tries hard) not to write behind file size
+    write_lifetime_hint lifetime_hint = write_lifetime_hint::not_set; ///< Expected lifetime of the file's data, forwarded to the device (see \ref write_lifetime_hint)
 
     // The fsxattr.fsx_extsize is 32-bit
     static constexpr uint64_t max_extent_allocation_size_hint = 1 << 31;
@@ -143,6 +159,8 @@ public:
     virtual future<int> fcntl(int op, uintptr_t arg) noexcept;
     virtual future<int> fcntl_short(int op, uintptr_t arg) noexcept;
     virtual future<> allocate(uint64_t position, uint64_t length) = 0;
+    virtual future<std::vector<file_extent>> query_extents(uint64_t offset, uint64_t length);
+    virtual future<> discard_ranges(std::vector<file_range> ranges);
     virtual future<uint64_t> size(void) = 0;
     virtual future<> close() = 0;
     virtual std::unique_ptr<file_handle_impl> dup();
@@ -152,11 +170,23 @@ public:
         return dma_read_bulk(offset, range_size, pc);
     }
 
+    // The kernel file descriptor backing this file, if any. Enables
+    // zero-copy paths such as output_stream::sendfile(); the descriptor
+    // remains owned by the file_impl.
+    virtual std::optional<int> native_fd() const noexcept {
+        return std::nullopt;
+    }
+
     friend class reactor;
 };
 
 future<shared_ptr<file_impl>> make_file_impl(int fd, file_open_options options, int oflags) noexcept;
 
+namespace internal {
+// Sorts ranges and merges adjacent and overlapping ones; drops empty ranges.
+std::vector<file_range> merge_file_ranges(std::vector<file_range> ranges);
+}
+
 /// \endcond
 
 /// A data file on persistent storage.
@@ -340,6 +370,30 @@ public:
     ///         read may happen due to end-of-file or an I/O error.
     future<size_t> dma_read(uint64_t pos, std::vector<iovec> iov, const io_priority_class& pc = default_priority_class(), io_intent* intent = nullptr) noexcept;
 
+    /// Performs DMA reads of multiple discontiguous file extents into a
+    /// single caller-provided buffer.
+    ///
+    /// Physically contiguous extents are merged and submitted as a single
+    /// I/O, so a fragmented read costs one trip through the I/O queue per
+    /// contiguous run instead of one per extent. Data lands into \c buffer
+    /// in extent order, packed back to back.
+    ///
+    /// \param extents (offset, length) pairs describing the file ranges to
+    ///                read. Both must be aligned to \ref disk_read_dma_alignment.
+    /// \param buffer aligned buffer to read into. Must hold at least the sum
+    ///               of the extent lengths and exist until the future resolves.
+    /// \param pc the IO priority class under which to queue this operation
+    /// \param intent the IO intention confirmation (\ref seastar::io_intent)
+    ///
+    /// \return a future representing the total number of bytes actually
+    ///         read. On a short read (end-of-file or I/O error in one of the
+    ///         runs) the contents of \c buffer for extents past the shortfall
+    ///         are undefined.
+    template <typename CharType>
+    future<size_t> dma_read_scattered(std::vector<std::pair<uint64_t, size_t>> extents, CharType* buffer, const io_priority_class& pc = default_priority_class(), io_intent* intent = nullptr) noexcept {
+        return dma_read_scattered_impl(std::move(extents), reinterpret_cast<uint8_t*>(buffer), pc, intent);
+    }
+
     /// Performs a DMA write from the specified buffer.
     ///
     /// \param pos offset to write into.  Must be aligned to \ref disk_write_dma_alignment.
@@ -400,6 +454,29 @@ public:
     /// (which be aligned) is no longer needed and can be reused.
     future<> discard(uint64_t offset, uint64_t length) noexcept;
 
+    /// Discard several unneeded ranges from the file at once.
+    ///
+    /// Adjacent and overlapping ranges are merged, and the merged ranges are
+    /// punched in one batch on the syscall thread, so reclaiming many small
+    /// ranges costs one cross-thread round trip instead of one per range.
+    ///
+    /// \param ranges ranges of offsets to discard, in any order.
+    future<> discard_ranges(std::vector<file_range> ranges) noexcept;
+
+    /// Query the extents of allocated storage backing a range of the file.
+    ///
+    /// Holes (ranges not covered by a returned extent) consume no storage.
+    /// The underlying FIEMAP result is cached on the file handle and
+    /// invalidated by writes, truncation, allocation and discards through
+    /// this handle, so repeated queries during a space-reclamation pass
+    /// issue a single ioctl. Not all file systems support extent queries;
+    /// on those the returned future fails with \c std::system_error.
+    ///
+    /// \param offset beginning of the range to query.
+    /// \param length length of the range to query.
+    /// \return the extents intersecting the range, in file order.
+    future<std::vector<file_extent>> query_extents(uint64_t offset, uint64_t length) noexcept;
+
     /// Generic ioctl syscall support for special file handling.
     ///
     /// This interface is useful for many non-standard operations on seastar::file.
@@ -515,6 +592,13 @@ public:
     /// Gets the file size.
     future<uint64_t> size() const noexcept;
 
+    /// \cond internal
+    /// The kernel file descriptor backing this file, if any. Used by
+    /// zero-copy paths such as \ref output_stream::sendfile(); the
+    /// descriptor remains owned by the file.
+    std::optional<int> native_fd() const noexcept;
+    /// \endcond
+
     /// Closes the file.
     ///
     /// Flushes any pending operations and release any resources associated with
@@ -574,6 +658,9 @@ private:
     future<size_t>
     dma_read_impl(uint64_t aligned_pos, uint8_t* aligned_buffer, size_t aligned_len, const io_priority_class& pc, io_intent* intent) noexcept;
 
+    future<size_t>
+    dma_read_scattered_impl(std::vector<std::pair<uint64_t, size_t>> extents, uint8_t* buffer, const io_priority_class& pc, io_intent* intent) noexcept;
+
     future<temporary_buffer<uint8_t>>
     dma_read_exactly_impl(uint64_t pos, size_t len, const io_priority_class& pc, io_intent* intent) noexcept;
 
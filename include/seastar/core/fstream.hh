@@ -68,6 +68,13 @@ struct file_input_stream_options {
 /// \param options A set of options controlling the stream.
 ///
 /// \note Multiple input streams may exist concurrently for the same file.
+///
+/// \note The stream passes the DMA buffers read from the device through to
+///       the consumer without copying: a consumer that drains the stream with
+///       input_stream::read(), or with input_stream::read_exactly() calls
+///       matching the buffer size from an aligned offset, takes ownership of
+///       the device buffers directly. Only reads spanning multiple internal
+///       buffers are assembled through a copy.
 input_stream<char> make_file_input_stream(
         file file, uint64_t offset, uint64_t len, file_input_stream_options options = {});
 
@@ -118,4 +125,23 @@ future<output_stream<char>> make_file_output_stream(
 /// Closes the file if the sink creation fails.
 future<data_sink> make_file_data_sink(file, file_output_stream_options) noexcept;
 
+/// \cond internal
+namespace internal {
+
+// Drives output_stream::sendfile(): transfers [pos, pos + len) of f into
+// the sink, using the sink's zero-copy path when both the sink and the
+// file support it, and a chunked read+put loop otherwise.
+future<> sendfile_to_sink(data_sink& out, file f, uint64_t pos, size_t len);
+
+}
+/// \endcond
+
+template <typename CharType>
+inline
+future<> output_stream<CharType>::sendfile(file f, uint64_t pos, size_t len) noexcept {
+    return flush().then([this, f = std::move(f), pos, len] () mutable {
+        return internal::sendfile_to_sink(_fd, std::move(f), pos, len);
+    });
+}
+
 }
@@ -168,23 +168,32 @@ future<T> make_ready_future(A&&... value) noexcept;
 /// state.  This is useful when no I/O needs to be performed to perform
 /// a computation (for example, because the connection is closed and
 /// we cannot read from it).
+// The exception-future factories below are marked cold so the compiler
+// keeps them (and the branches leading to them) out of the hot
+// instruction stream of then()/await; the value path is by far the
+// common one.
 template <typename T = void>
+[[gnu::cold]]
 future<T> make_exception_future(std::exception_ptr&& value) noexcept;
 
 template <typename T = void, typename Exception>
+[[gnu::cold]]
 future<T> make_exception_future(Exception&& ex) noexcept;
 
 template <typename T = void>
+[[gnu::cold]]
 future<T> make_exception_future(const std::exception_ptr& ex) noexcept {
     return make_exception_future<T>(std::exception_ptr(ex));
 }
 
 template <typename T = void>
+[[gnu::cold]]
 future<T> make_exception_future(std::exception_ptr& ex) noexcept {
     return make_exception_future<T>(static_cast<const std::exception_ptr&>(ex));
 }
 
 template <typename T = void>
+[[gnu::cold]]
 future<T> make_exception_future(const std::exception_ptr&& ex) noexcept {
     // as ex is const, we cannot move it, but can copy it.
     return make_exception_future<T>(std::exception_ptr(ex));
@@ -193,8 +202,10 @@ future<T> make_exception_future(const std::exception_ptr&& ex) noexcept {
 /// \cond internal
 void engine_exit(std::exception_ptr eptr = {});
 
+[[gnu::cold]]
 void report_failed_future(const std::exception_ptr& ex) noexcept;
 
+[[gnu::cold]]
 void report_failed_future(const future_state_base& state) noexcept;
 
 void with_allow_abandoned_failed_futures(unsigned count, noncopyable_function<void ()> func);
@@ -217,6 +228,7 @@ struct broken_promise : std::logic_error {
 /// make_exception_future(std::current_exception()), but expands to
 /// less code.
 template <typename T = void>
+[[gnu::cold]]
 future<T> current_exception_as_future() noexcept;
 
 extern template
@@ -502,15 +514,22 @@ struct future_state_base {
     // We never need to destruct this polymorphicly, so we can make it
     // protected instead of virtual.
 protected:
+    // The exceptional-state constructors and rethrow helpers live out
+    // of line in future.cc and are marked cold, keeping every
+    // continuation's inline footprint to the value path plus a
+    // predicted-untaken branch.
     struct current_exception_future_marker {};
+    [[gnu::cold]]
     future_state_base(current_exception_future_marker) noexcept;
     struct nested_exception_marker {};
+    [[gnu::cold]]
     future_state_base(nested_exception_marker, future_state_base&& old) noexcept;
+    [[gnu::cold]]
     future_state_base(nested_exception_marker, future_state_base&& n, future_state_base&& old) noexcept;
     ~future_state_base() noexcept = default;
 
-    void rethrow_exception() &&;
-    void rethrow_exception() const&;
+    [[gnu::cold]] void rethrow_exception() &&;
+    [[gnu::cold]] void rethrow_exception() const&;
 
 public:
 
@@ -518,6 +537,7 @@ public:
     bool available() const noexcept { return _u.available(); }
     bool failed() const noexcept { return _u.failed(); }
 
+    [[gnu::cold]]
     void ignore() noexcept;
 
     void set_exception(std::exception_ptr&& ex) noexcept {
@@ -548,6 +568,7 @@ public:
     friend struct futurize;
 };
 
+[[gnu::cold]]
 void report_failed_future(future_state_base::any&& state) noexcept;
 
 inline void future_state_base::any::check_failure() noexcept {
@@ -749,9 +770,48 @@ struct continuation final : continuation_base_with_promise<Promise, T> {
     [[no_unique_address]] Wrapper _wrapper;
 };
 
+// Same as continuation, but living in caller-provided storage (see
+// future::then_inplace()); disposing of it runs the destructor only,
+// the storage itself is owned by the caller.
+template <typename Promise, typename Func, typename Wrapper, typename T = void>
+struct inplace_continuation final : continuation_base_with_promise<Promise, T> {
+    inplace_continuation(Promise&& pr, Func&& func, Wrapper&& wrapper) noexcept
+        : continuation_base_with_promise<Promise, T>(std::move(pr))
+        , _func(std::move(func))
+        , _wrapper(std::move(wrapper)) {}
+    virtual void run_and_dispose() noexcept override {
+        try {
+            _wrapper(std::move(this->_pr), _func, std::move(this->_state));
+        } catch (...) {
+            this->_pr.set_to_current_exception();
+        }
+        this->~inplace_continuation();
+    }
+    Func _func;
+    [[no_unique_address]] Wrapper _wrapper;
+};
+
+/// \brief Caller-provided storage for one continuation.
+///
+/// Passing one of these to \ref future::then_inplace() constructs the
+/// continuation state inside it instead of allocating the state on the
+/// heap. Like the state provided by \ref do_with(), the storage must
+/// remain alive until the continuation has run; it may then be reused
+/// for a later continuation.
+template <size_t Size = 128>
+class continuation_storage {
+public:
+    static constexpr size_t alignment = alignof(std::max_align_t);
+private:
+    alignas(alignment) char _buf[Size];
+public:
+    void* get() noexcept { return _buf; }
+};
+
 namespace internal {
 
 template <typename T = void>
+[[gnu::cold]]
 future<T> make_exception_future(future_state_base&& state) noexcept;
 
 template <typename... T, typename U>
@@ -791,7 +851,10 @@ protected:
     template<urgent Urgent>
     void make_ready() noexcept;
 
+    // Fulfilling a promise with an exception is rare; force the body
+    // (and its diagnostics for abandoned futures) out of callers.
     template<typename T>
+    [[gnu::cold]] [[gnu::noinline]]
     void set_exception_impl(T&& val) noexcept {
         if (_state) {
             _state->set_exception(std::move(val));
@@ -833,6 +896,7 @@ public:
     ///
     /// This is equivalent to set_exception(std::current_exception()),
     /// but expands to less code.
+    [[gnu::cold]]
     void set_to_current_exception() noexcept;
 
     /// Returns the task which is waiting for this promise to resolve, or nullptr.
@@ -1275,6 +1339,22 @@ private:
         schedule(tws);
         _state._u.st = future_state_base::state::invalid;
     }
+    template <size_t Size, typename Pr, typename Func, typename Wrapper>
+    void schedule_inplace(continuation_storage<Size>& storage, Pr&& pr, Func&& func, Wrapper&& wrapper) noexcept {
+        using con_type = inplace_continuation<Pr, Func, Wrapper, T>;
+        static_assert(sizeof(con_type) <= Size, "continuation_storage is too small, increase its Size parameter");
+        static_assert(alignof(con_type) <= continuation_storage<Size>::alignment);
+        auto tws = new (storage.get()) con_type(std::move(pr), std::move(func), std::move(wrapper));
+#ifdef SEASTAR_DEBUG
+        if (_state.available()) {
+            tws->set_state(get_available_state_ref());
+            ::seastar::schedule(tws);
+            return;
+        }
+#endif
+        schedule(tws);
+        _state._u.st = future_state_base::state::invalid;
+    }
 
     [[gnu::always_inline]]
     future_state&& get_available_state_ref() noexcept {
@@ -1395,6 +1475,18 @@ public:
 #ifndef SEASTAR_TYPE_ERASE_MORE
         return then_impl(std::move(func));
 #else
+#ifndef SEASTAR_DEBUG
+        // The ready-future fast path in then_impl() never looks at the
+        // continuation as a task, so take it before paying for the
+        // noncopyable_function wrapper below: the wrapper may allocate,
+        // while a ready future completes inline with no allocation at all.
+        using futurator = futurize<internal::future_result_t<Func, T>>;
+        if (failed()) {
+            return futurator::make_exception_future(static_cast<future_state_base&&>(get_available_state_ref()));
+        } else if (available()) {
+            return futurator::invoke(std::forward<Func>(func), get_available_state_ref().take_value());
+        }
+#endif
         using func_type = typename internal::future_result<Func, T>::func_type;
         noncopyable_function<func_type> ncf;
         {
@@ -1436,6 +1528,39 @@ public:
         });
     }
 
+    /// \brief Schedule a block of code to run when the future is ready,
+    ///        placing the continuation in caller-provided storage.
+    ///
+    /// Like \ref then(), but if a continuation is needed it is constructed
+    /// in \c storage instead of being allocated, removing one small-pool
+    /// round trip per link of a statically bounded chain. The storage must
+    /// remain alive until the continuation has run (\ref do_with() is a
+    /// convenient way to provide it); afterwards it may be reused for a
+    /// later continuation. A ready future completes inline, as with
+    /// \ref then(), and does not touch the storage.
+    ///
+    /// \param storage - storage for the continuation state; its size
+    ///                  parameter is checked at compile time.
+    /// \param func - function to be called when the future becomes
+    ///               available, unless it has failed.
+    /// \return a \c future representing the return value of \c func,
+    ///         applied to the eventual value of this future.
+    template <size_t Size, typename Func, typename Result = typename internal::future_result<Func, T>::future_type>
+    SEASTAR_CONCEPT( requires std::invocable<Func, T>
+                 || (std::same_as<std::tuple<void>, std::tuple<T>> && std::invocable<Func>) )
+    Result
+    then_inplace(continuation_storage<Size>& storage, Func&& func) noexcept {
+#ifndef SEASTAR_DEBUG
+        using futurator = futurize<internal::future_result_t<Func, T>>;
+        if (failed()) {
+            return futurator::make_exception_future(static_cast<future_state_base&&>(get_available_state_ref()));
+        } else if (available()) {
+            return futurator::invoke(std::forward<Func>(func), get_available_state_ref().take_value());
+        }
+#endif
+        return then_inplace_nrvo<Size, Func, Result>(storage, std::forward<Func>(func));
+    }
+
 private:
 
     // Keep this simple so that Named Return Value Optimization is used.
@@ -1459,6 +1584,27 @@ private:
         return fut;
     }
 
+    // Keep this simple so that Named Return Value Optimization is used.
+    template <size_t Size, typename Func, typename Result>
+    Result then_inplace_nrvo(continuation_storage<Size>& storage, Func&& func) noexcept {
+        using futurator = futurize<internal::future_result_t<Func, T>>;
+        typename futurator::type fut(future_for_get_promise_marker{});
+        using pr_type = decltype(fut.get_promise());
+        schedule_inplace(storage, fut.get_promise(), std::move(func), [](pr_type&& pr, Func& func, future_state&& state) {
+            if (state.failed()) {
+                pr.set_exception(static_cast<future_state_base&&>(std::move(state)));
+            } else {
+                futurator::satisfy_with_result_of(std::move(pr), [&func, &state] {
+                    // clang thinks that "state" is not used, below, for future<>.
+                    // Make it think it is used to avoid an unused-lambda-capture warning.
+                    (void)state;
+                    return internal::future_invoke(func, std::move(state).get_value());
+                });
+            }
+        });
+        return fut;
+    }
+
     template <typename Func, typename Result = futurize_t<internal::future_result_t<Func, T>>>
     Result
     then_impl(Func&& func) noexcept {
@@ -1795,6 +1941,7 @@ struct futurize_base {
 
     /// Makes an exceptional future of type \ref type.
     template <typename Arg>
+    [[gnu::cold]]
     static inline type make_exception_future(Arg&& arg) noexcept;
 };
 
@@ -1808,6 +1955,7 @@ struct futurize_base<void> {
         return std::move(value);
     }
     template <typename Arg>
+    [[gnu::cold]]
     static inline type make_exception_future(Arg&& arg) noexcept;
 };
 
@@ -1852,6 +2000,7 @@ struct futurize : public internal::futurize_base<T> {
         return invoke(std::forward<Func>(func), std::forward<FuncArgs>(args)...);
     }
 
+    [[gnu::cold]]
     static type current_exception_as_future() noexcept {
         return type(future_state_base::current_exception_future_marker());
     }
@@ -1954,11 +2103,28 @@ future<T> make_exception_future_with_backtrace(Exception&& ex) noexcept {
 
 /// \cond internal
 
+namespace internal {
+
+// Whether invoking the callable and converting its result into a future
+// cannot throw, i.e. whether the try/catch machinery in futurize can be
+// skipped altogether. Doing so lets the compiler fully inline short
+// noexcept continuations into the caller. T is the futurized value type:
+// when the callable returns a different (convertible) type, convert()
+// performs an implicit T conversion which can itself throw, so it is the
+// construction of T from the returned value that must be nothrow, not
+// just moving the returned value.
+template <typename T, typename Ret, bool NothrowInvoke>
+inline constexpr bool futurize_invoke_is_nothrow =
+        NothrowInvoke && (std::is_void_v<Ret> || is_future<Ret>::value ||
+                (std::is_nothrow_constructible_v<T, std::add_rvalue_reference_t<Ret>> && std::is_nothrow_move_constructible_v<T>));
+
+} // namespace internal
+
 template<typename T>
 template<typename Func, typename... FuncArgs>
 typename futurize<T>::type futurize<T>::apply(Func&& func, std::tuple<FuncArgs...>&& args) noexcept {
-    try {
-        using ret_t = decltype(std::apply(std::forward<Func>(func), std::move(args)));
+    using ret_t = decltype(std::apply(std::forward<Func>(func), std::move(args)));
+    auto apply_nothrow = [&] () noexcept (internal::futurize_invoke_is_nothrow<T, ret_t, std::is_nothrow_invocable_v<Func, FuncArgs...>>) -> type {
         if constexpr (std::is_void_v<ret_t>) {
             std::apply(std::forward<Func>(func), std::move(args));
             return make_ready_future<>();
@@ -1967,8 +2133,15 @@ typename futurize<T>::type futurize<T>::apply(Func&& func, std::tuple<FuncArgs..
         } else {
             return convert(std::apply(std::forward<Func>(func), std::move(args)));
         }
-    } catch (...) {
-        return current_exception_as_future();
+    };
+    if constexpr (noexcept(apply_nothrow())) {
+        return apply_nothrow();
+    } else {
+        try {
+            return apply_nothrow();
+        } catch (...) {
+            return current_exception_as_future();
+        }
     }
 }
 
@@ -1990,8 +2163,8 @@ void futurize<T>::satisfy_with_result_of(promise_base_with_type&& pr, Func&& fun
 template<typename T>
 template<typename Func, typename... FuncArgs>
 typename futurize<T>::type futurize<T>::invoke(Func&& func, FuncArgs&&... args) noexcept {
-    try {
-        using ret_t = decltype(func(std::forward<FuncArgs>(args)...));
+    using ret_t = decltype(func(std::forward<FuncArgs>(args)...));
+    auto invoke_nothrow = [&] () noexcept (internal::futurize_invoke_is_nothrow<T, ret_t, std::is_nothrow_invocable_v<Func, FuncArgs...>>) -> type {
         if constexpr (std::is_void_v<ret_t>) {
             func(std::forward<FuncArgs>(args)...);
             return make_ready_future<>();
@@ -2000,8 +2173,15 @@ typename futurize<T>::type futurize<T>::invoke(Func&& func, FuncArgs&&... args)
         } else {
             return convert(func(std::forward<FuncArgs>(args)...));
         }
-    } catch (...) {
-        return current_exception_as_future();
+    };
+    if constexpr (noexcept(invoke_nothrow())) {
+        return invoke_nothrow();
+    } else {
+        try {
+            return invoke_nothrow();
+        } catch (...) {
+            return current_exception_as_future();
+        }
     }
 }
 
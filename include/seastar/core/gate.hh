@@ -22,6 +22,7 @@
 #pragma once
 
 #include <seastar/core/future.hh>
+#include <seastar/core/waiter_registry.hh>
 #include <seastar/util/std-compat.hh>
 #include <cassert>
 #include <exception>
@@ -54,6 +55,8 @@ public:
 class gate {
     size_t _count = 0;
     std::optional<promise<>> _stopped;
+    // Set by track_waiters(); null (and costless) otherwise.
+    lw_shared_ptr<internal::waiter_tracker> _tracker;
 
 #ifdef SEASTAR_GATE_HOLDER_DEBUG
     size_t _holders = 0;
@@ -73,7 +76,8 @@ public:
     gate() = default;
     gate(const gate&) = delete;
     gate(gate&& x) noexcept
-        : _count(std::exchange(x._count, 0)), _stopped(std::exchange(x._stopped, std::nullopt)) {
+        : _count(std::exchange(x._count, 0)), _stopped(std::exchange(x._stopped, std::nullopt))
+        , _tracker(std::exchange(x._tracker, nullptr)) {
         x.assert_not_held_when_moved();
     }
     gate& operator=(gate&& x) noexcept {
@@ -82,6 +86,7 @@ public:
             x.assert_not_held_when_moved();
             _count = std::exchange(x._count, 0);
             _stopped = std::exchange(x._stopped, std::nullopt);
+            _tracker = std::exchange(x._tracker, nullptr);
         }
         return *this;
     }
@@ -109,6 +114,18 @@ public:
             throw gate_closed_exception();
         }
     }
+    /// Registers an in-progress request without checking whether the
+    /// gate is closed.
+    ///
+    /// May only be used when the caller already holds the gate, so the
+    /// new reference cannot race with \ref close() — the same reasoning
+    /// that lets copying a \ref holder skip the check. Unlike
+    /// \ref enter() this never throws, and compiles down to a plain
+    /// increment. Must be balanced by \ref leave().
+    void enter_unchecked() noexcept {
+        assert(_count && "gate::enter_unchecked() requires the gate to be held");
+        ++_count;
+    }
     /// Unregisters an in-progress request.
     ///
     /// If the gate is closed, and there are no more in-progress requests,
@@ -143,8 +160,15 @@ public:
         _stopped = std::make_optional(promise<>());
         if (!_count) {
             _stopped->set_value();
+            return _stopped->get_future();
         }
-        return _stopped->get_future();
+        auto f = _stopped->get_future();
+        if (_tracker) {
+            // The closer is the gate's waiter; its age is how long the
+            // close has been stuck behind outstanding requests.
+            return internal::track_wait(_tracker, std::move(f));
+        }
+        return f;
     }
 
     /// Returns a current number of registered in-progress requests.
@@ -152,6 +176,13 @@ public:
         return _count;
     }
 
+    /// Registers this gate in the shard's waiter registry under \c name,
+    /// so \ref dump_waiter_registry() reports a pending \ref close() and
+    /// how long it has been waiting for requests to drain.
+    void track_waiters(sstring name) {
+        _tracker = make_lw_shared<internal::waiter_tracker>("gate", std::move(name));
+    }
+
     /// Returns whether the gate is closed.
     bool is_closed() const noexcept {
         return bool(_stopped);
@@ -169,6 +200,17 @@ public:
     class holder {
         gate* _g;
 
+        struct unchecked_tag {};
+
+        /// Construct a \ref holder under an existing hold on the gate,
+        /// bypassing the closed check; see \ref gate::hold_unchecked().
+        holder(gate& g, unchecked_tag) noexcept : _g(&g) {
+            _g->enter_unchecked();
+            debug_hold_gate();
+        }
+
+        friend class gate;
+
     public:
         /// Construct a default \ref holder, referencing no \ref gate.
         /// Never throws.
@@ -262,10 +304,28 @@ public:
     holder hold() {
         return holder(*this);
     }
+
+    /// Like \ref hold(), but without checking whether the gate is
+    /// closed; see \ref enter_unchecked() for when this is allowed.
+    /// Never throws, so branches of request processing that already
+    /// run under a holder can take extra references for free.
+    holder hold_unchecked() noexcept {
+        return holder(*this, holder::unchecked_tag{});
+    }
 };
 
 namespace internal {
 
+// A closed gate rejecting a flood of late requests materializes one
+// exception per request; during shutdown of a busy service this throw
+// storm shows up as a latency spike. The exception carries no state,
+// so it is materialized once per shard and shared by all rejections
+// on the non-throwing paths.
+inline const std::exception_ptr& cached_gate_closed_exception() {
+    static thread_local std::exception_ptr ex = std::make_exception_ptr(gate_closed_exception());
+    return ex;
+}
+
 template <typename Func>
 inline
 auto
@@ -308,7 +368,7 @@ auto
 try_with_gate(gate& g, Func&& func) noexcept {
     if (!g.try_enter()) {
         using futurator = futurize<std::invoke_result_t<Func>>;
-        return futurator::make_exception_future(gate_closed_exception());
+        return futurator::make_exception_future(internal::cached_gate_closed_exception());
     }
     return internal::invoke_func_with_gate(g, std::forward<Func>(func));
 }
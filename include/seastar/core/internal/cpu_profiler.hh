@@ -0,0 +1,105 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB
+ */
+
+#pragma once
+
+#include <seastar/core/circular_buffer.hh>
+#include <seastar/core/scheduling.hh>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <typeinfo>
+#include <vector>
+
+namespace seastar {
+
+class task;
+
+namespace internal {
+
+inline uint64_t read_cycle_counter() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#elif defined(__aarch64__)
+    uint64_t cnt;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(cnt));
+    return cnt;
+#else
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+// One sample taken by the cpu_profiler: which task type was dispatched
+// under which scheduling group when the cycle counter passed a sampling
+// boundary. The task type identifies the continuation, including the
+// lambda it was built from.
+struct cpu_profiler_trace {
+    std::chrono::steady_clock::time_point timestamp;
+    scheduling_group sg;
+    const std::type_info* task_type;
+};
+
+// Deterministic counter-based sampling profiler, complementing the
+// cpu_stall_detector: where the stall detector only fires on outliers,
+// the profiler attributes steady-state CPU time. The reactor calls
+// maybe_sample() for every task it dispatches; whenever at least
+// `period` cycles have elapsed since the last sample the dispatched
+// task is recorded into a bounded per-shard ring, overwriting (and
+// accounting) the oldest samples when full. The fast path is a single
+// compare, so the profiler can stay always-on.
+class cpu_profiler {
+public:
+    struct config {
+        bool enabled = false;
+        // Cycles between samples (~1ms at 4GHz)
+        uint64_t period = 4'000'000;
+        // Samples retained per shard
+        size_t capacity = 1024;
+    };
+private:
+    config _cfg;
+    circular_buffer<cpu_profiler_trace> _traces;
+    uint64_t _dropped_samples = 0;
+    uint64_t _next_sample_at = std::numeric_limits<uint64_t>::max();
+public:
+    bool enabled() const noexcept {
+        return _cfg.enabled;
+    }
+    const config& get_config() const noexcept {
+        return _cfg;
+    }
+    void update_config(config cfg);
+    // Called by the reactor for every task it dispatches
+    void maybe_sample(const task& t) noexcept {
+        if (__builtin_expect(read_cycle_counter() >= _next_sample_at, false)) {
+            take_sample(t);
+        }
+    }
+    // Moves the collected samples out, oldest first, and returns the
+    // number of samples overwritten before they could be retrieved.
+    uint64_t drain(std::vector<cpu_profiler_trace>& out);
+private:
+    void take_sample(const task& t) noexcept;
+};
+
+}
+
+}
@@ -0,0 +1,112 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB
+ */
+
+#pragma once
+
+#include <seastar/core/bitops.hh>
+#include <seastar/core/deleter.hh>
+#include <seastar/core/smp.hh>
+#include <seastar/core/temporary_buffer.hh>
+#include <array>
+#include <cstdlib>
+#include <functional>
+
+namespace seastar {
+namespace internal {
+
+// Per-shard pool of pre-aligned, size-classed buffers for DMA bounce
+// paths (unaligned dma_read()/dma_write() tails, fstream buffers), so
+// those paths don't pay an aligned allocation per operation.
+//
+// Buffers can end up deleted on another shard (e.g. a dma_read() result
+// moved via foreign_ptr); only the owner shard recycles them. Backends
+// that register pool buffers with the kernel (io_uring fixed buffers)
+// can install hooks to observe buffer creation and destruction; a
+// buffer freed off its owner shard bypasses the destroy hook, so such
+// backends must treat registrations as a cache, not an inventory.
+class dma_buffer_pool {
+public:
+    static constexpr size_t buffer_alignment = 4096;
+    static constexpr size_t min_buffer_size = 4096;
+    static constexpr size_t max_buffer_size = 128 * 1024;
+    static constexpr size_t max_pooled_bytes = 2 * 1024 * 1024;
+
+    using buffer_hook = std::function<void(void* buf, size_t size)>;
+private:
+    struct free_buffer {
+        free_buffer* next;
+    };
+    static unsigned size_class(size_t size) noexcept {
+        return log2ceil(std::max(size, min_buffer_size)) - log2ceil(min_buffer_size);
+    }
+    static size_t class_size(unsigned cls) noexcept {
+        return min_buffer_size << cls;
+    }
+    static constexpr unsigned nr_classes = 6; // 4k .. 128k
+
+    std::array<free_buffer*, nr_classes> _free = {};
+    size_t _pooled_bytes = 0;
+    buffer_hook _on_create;
+    buffer_hook _on_destroy;
+
+    void* take(size_t size);
+    void put_back(void* ptr, unsigned cls, size_t bytes) noexcept;
+public:
+    ~dma_buffer_pool();
+
+    // Hooks invoked when the pool carves a new buffer or frees one on
+    // the owner shard, for backends that register fixed buffers.
+    void set_registration_hooks(buffer_hook on_create, buffer_hook on_destroy);
+
+    // Returns an uninitialized buffer of exactly the requested size,
+    // aligned to at least \c alignment. Requests the pool cannot serve
+    // (alignment above buffer_alignment, size above max_buffer_size)
+    // fall back to a plain aligned allocation.
+    template <typename CharType>
+    temporary_buffer<CharType> allocate(size_t alignment, size_t size) {
+        static_assert(sizeof(CharType) == 1, "must buffer stream of bytes");
+        if (alignment > buffer_alignment || size > max_buffer_size) {
+            return temporary_buffer<CharType>::aligned(alignment, size);
+        }
+        auto cls = size_class(size);
+        auto bytes = class_size(cls);
+        auto ptr = static_cast<CharType*>(take(bytes));
+        return temporary_buffer<CharType>(ptr, size, make_deleter([this, owner = this_shard_id(), ptr, cls, bytes] {
+            if (this_shard_id() == owner) {
+                put_back(ptr, cls, bytes);
+            } else {
+                std::free(ptr);
+            }
+        }));
+    }
+};
+
+#ifdef SEASTAR_BUILD_SHARED_LIBS
+dma_buffer_pool& local_dma_buffer_pool() noexcept;
+#else
+extern thread_local dma_buffer_pool g_dma_buffer_pool;
+inline dma_buffer_pool& local_dma_buffer_pool() noexcept {
+    return g_dma_buffer_pool;
+}
+#endif
+
+} // namespace internal
+} // namespace seastar
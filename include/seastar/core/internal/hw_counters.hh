@@ -0,0 +1,74 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB
+ */
+
+#pragma once
+
+#include <cstdint>
+
+struct perf_event_mmap_page; // from <linux/perf_event.h>
+
+namespace seastar {
+
+namespace internal {
+
+// A hardware performance counter for the calling thread, read from
+// userspace with rdpmc through the perf mmap page -- cheap enough to
+// sample at every task-queue switch. Degrades to unavailable (read()
+// returns 0) when perf_event_open() fails, e.g. in constrained
+// environments such as containers, or when the kernel does not allow
+// userspace counter reads on this architecture.
+class hw_perf_counter {
+    int _fd = -1;
+    struct ::perf_event_mmap_page* _mmap = nullptr;
+public:
+    hw_perf_counter(uint32_t type, uint64_t config) noexcept;
+    hw_perf_counter(const hw_perf_counter&) = delete;
+    ~hw_perf_counter();
+    bool available() const noexcept { return _mmap != nullptr; }
+    uint64_t read() const noexcept;
+};
+
+struct hw_counter_sample {
+    uint64_t instructions = 0;
+    uint64_t cycles = 0;
+    uint64_t llc_misses = 0;
+};
+
+// The counters the reactor samples around each task-queue run in order
+// to attribute hardware resource consumption -- instructions, cycles
+// and last-level-cache misses -- to scheduling groups.
+class hw_counters {
+    hw_perf_counter _instructions;
+    hw_perf_counter _cycles;
+    hw_perf_counter _llc_misses;
+public:
+    hw_counters() noexcept;
+    bool available() const noexcept {
+        return _instructions.available() || _cycles.available() || _llc_misses.available();
+    }
+    hw_counter_sample sample() const noexcept {
+        return {_instructions.read(), _cycles.read(), _llc_misses.read()};
+    }
+};
+
+}
+
+}
@@ -32,4 +32,15 @@ protected:
 public:
     virtual void complete_with(ssize_t res) = 0;
 };
+
+class io_completion : public kernel_completion {
+public:
+    virtual void complete_with(ssize_t res) final override;
+
+    virtual void complete(size_t res) noexcept = 0;
+    virtual void set_exception(std::exception_ptr eptr) noexcept = 0;
+    // Called when the request leaves the io_sink, i.e. is handed over
+    // to the kernel.
+    virtual void submitted() noexcept {}
+};
 }
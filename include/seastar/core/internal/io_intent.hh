@@ -61,13 +61,28 @@ public:
             cq.push_back(*this);
         }
 
-        void maybe_dequeue() noexcept {
+        // Unlinks the request on dispatch and returns the queue it sat
+        // on, so the caller can keep tracking the request in its
+        // in-flight stage (see track_inflight() below).
+        cancellable_queue* maybe_dequeue() noexcept {
             if (_ref != nullptr) {
-                _ref->pop_front();
+                cancellable_queue* cq = _ref;
+                cq->pop_front();
+                return cq;
             }
+            return nullptr;
         }
     };
 
+    /*
+     * The hook for requests that were already handed over to the kernel.
+     * Unlike the queued links above completions arrive in arbitrary
+     * order, so these sit on a doubly-linked auto-unlink list and just
+     * disappear from it when the request completes.
+     */
+    class inflight_link : public bi::list_base_hook<bi::link_mode<bi::auto_unlink>> {};
+    using inflight_list_t = bi::list<inflight_link, bi::constant_time_size<false>>;
+
 private:
     static_assert(sizeof(link) == sizeof(void*), "cancellable_queue::link size is too big");
     using list_of_links_t = bi::slist<link,
@@ -77,12 +92,16 @@ private:
 
     link* _first;
     list_of_links_t _rest;
+    inflight_list_t _inflight;
 
     void push_back(link& il) noexcept;
     void pop_front() noexcept;
 
 public:
     cancellable_queue() noexcept : _first(nullptr) {}
+    void track_inflight(inflight_link& il) noexcept {
+        _inflight.push_back(il);
+    }
     cancellable_queue(const cancellable_queue&) = delete;
     cancellable_queue(cancellable_queue&& o) noexcept;
     cancellable_queue& operator=(cancellable_queue&& o) noexcept;
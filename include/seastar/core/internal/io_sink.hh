@@ -22,17 +22,18 @@
 #pragma once
 
 #include <seastar/core/circular_buffer.hh>
+#include <seastar/core/internal/io_desc.hh>
 #include <seastar/core/internal/io_request.hh>
 #include <seastar/util/concepts.hh>
+#include <seastar/util/noncopyable_function.hh>
 
+#include <chrono>
 #include <cstddef>
 #include <type_traits>
 #include <utility>
 
 namespace seastar {
 
-class io_completion;
-
 namespace internal {
 
 class io_sink;
@@ -50,14 +51,77 @@ public:
 
 class io_sink {
     circular_buffer<pending_io_request> _pending_io;
+    // Write combining (see enable_write_combining()): while only writes
+    // are pending and the batch is small and young, drain() holds them
+    // back so the next io_submit()/ring doorbell carries more requests.
+    std::chrono::microseconds _combine_deadline = {};
+    size_t _combine_batch = 0;
+    std::chrono::steady_clock::time_point _oldest_pending;
+    bool _release = false;
+    bool _holding = false;
+    // Asks the reactor backend to cancel a request that had already
+    // been drained towards the kernel; see cancel()
+    noncopyable_function<bool (io_completion*)> _kernel_cancel;
+private:
+    bool should_hold() noexcept {
+        if (_combine_batch == 0 || _release || _pending_io.empty()
+                || _pending_io.size() >= _combine_batch
+                || std::chrono::steady_clock::now() - _oldest_pending >= _combine_deadline) {
+            _holding = false;
+            return false;
+        }
+        _holding = true;
+        return true;
+    }
 public:
     void submit(io_completion* desc, internal::io_request req) noexcept;
 
+    /// Best-effort cancellation of a submitted request. If the request
+    /// is still sitting in the sink it is plucked out and true is
+    /// returned -- the caller then owns its completion. Otherwise the
+    /// request is with the kernel already: the backend is asked to
+    /// cancel it there (if it knows how to) and false is returned, the
+    /// completion arriving the usual way, possibly with ECANCELED.
+    bool cancel(io_completion* desc) noexcept;
+
+    /// Installs the backend hook cancel() forwards in-kernel requests to.
+    void set_kernel_cancel(noncopyable_function<bool (io_completion*)> fn) noexcept {
+        _kernel_cancel = std::move(fn);
+    }
+
+    /// Hold small all-write batches in the sink for up to \c deadline
+    /// before letting drain() see them, so each kernel submission
+    /// carries more requests. Reads and the other latency-critical
+    /// operations are never delayed: their arrival releases the held
+    /// batch, which then goes to the kernel alongside them.
+    void enable_write_combining(std::chrono::microseconds deadline, size_t batch) noexcept {
+        _combine_deadline = deadline;
+        _combine_batch = deadline.count() != 0 ? batch : 0;
+    }
+
+    /// Stop holding back the currently pending requests. Returns true
+    /// if requests were being held, in which case the caller must poll
+    /// the sink again before idling; the reactor calls this before
+    /// going to sleep so combining never delays a write by more than
+    /// the deadline.
+    bool flush_held() noexcept {
+        if (!_holding) {
+            return false;
+        }
+        _holding = false;
+        _release = true;
+        return true;
+    }
+
     template <typename Fn>
     // Fn should return whether the request was consumed and
     // draining should try to drain more
     SEASTAR_CONCEPT( requires std::is_invocable_r<bool, Fn, internal::io_request&, io_completion*>::value )
     size_t drain(Fn&& consume) {
+        if (should_hold()) {
+            return 0;
+        }
+
         size_t pending = _pending_io.size();
         size_t drained = 0;
 
@@ -67,10 +131,14 @@ public:
             if (!consume(req, req._completion)) {
                 break;
             }
+            req._completion->submitted();
             drained++;
         }
 
         _pending_io.erase(_pending_io.begin(), _pending_io.begin() + drained);
+        if (_pending_io.empty()) {
+            _release = false;
+        }
         return drained;
     }
 };
@@ -25,6 +25,9 @@ namespace seastar {
 
 struct pollfn {
     virtual ~pollfn() {}
+    // A short name identifying the poller in metrics. Pollers returning
+    // nullptr (the default) are not exported.
+    virtual const char* name() const { return nullptr; }
     // Returns true if work was done (false = idle)
     virtual bool poll() = 0;
     // Checks if work needs to be done, but without actually doing any
@@ -111,6 +111,7 @@ public:
     future<temporary_buffer<char>> recv_some(internal::buffer_allocator* ba);
     future<size_t> sendmsg(struct msghdr *msg);
     future<size_t> recvmsg(struct msghdr *msg);
+    future<size_t> recvmmsg(struct mmsghdr *msg, unsigned vlen);
     future<size_t> sendto(socket_address addr, const void* buf, size_t len);
     future<> poll_rdhup();
 
@@ -182,6 +183,9 @@ public:
     future<size_t> recvmsg(struct msghdr *msg) {
         return _s->recvmsg(msg);
     }
+    future<size_t> recvmmsg(struct mmsghdr *msg, unsigned vlen) {
+        return _s->recvmmsg(msg, vlen);
+    }
     future<size_t> sendto(socket_address addr, const void* buf, size_t len) {
         return _s->sendto(addr, buf, len);
     }
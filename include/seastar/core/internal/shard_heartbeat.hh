@@ -0,0 +1,64 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <seastar/core/cacheline.hh>
+
+namespace seastar {
+namespace internal {
+
+// Layout of the shared heartbeat region.
+//
+// Every poll iteration each reactor stores the current cycle counter
+// (rdtsc / cntvct_el0) into its slot, so the age of the newest heartbeat
+// bounds how long the shard has gone without completing a poll loop. The
+// region lives in a memfd named "seastar-heartbeat" that stays open for
+// the lifetime of the process; an external watchdog can map it through
+// /proc/<pid>/fd/<n> and detect a wedged shard with a plain memory read,
+// without attaching to or signalling the process. In-process consumers
+// use smp::shard_heartbeat() and smp::shard_is_stalled() instead.
+//
+// The region starts with a shard_heartbeat_header followed by nshards
+// cache-line sized shard_heartbeat_slot entries.
+
+struct alignas(cache_line_size) shard_heartbeat_header {
+    static constexpr uint64_t magic_value = 0x73737472'68727462; // "sstrhrtb"
+    static constexpr uint32_t layout_version = 1;
+    uint64_t magic;
+    uint32_t version;
+    uint32_t nshards;
+    // Nanoseconds per cycle-counter tick as IEEE-754 double bits, for
+    // converting heartbeat ages into wall time. Zero until the first
+    // calibration, about a second after startup.
+    std::atomic<uint64_t> ns_per_cycle_bits;
+};
+
+struct alignas(cache_line_size) shard_heartbeat_slot {
+    // Cycle counter sampled at the top of the shard's last poll
+    // iteration; zero until the shard's event loop starts.
+    std::atomic<uint64_t> last_poll_tsc;
+};
+
+}
+}
@@ -0,0 +1,103 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace seastar {
+
+namespace internal {
+
+enum class trace_event_type : uint16_t {
+    task_start = 1,
+    task_end = 2,
+    io_dispatch = 3,
+    io_complete = 4,
+    sleep_enter = 5,
+    sleep_exit = 6,
+};
+
+// Fixed-size binary trace record. Dumps are decoded by
+// scripts/trace2chrome.py, so keep the layout in sync with it.
+struct trace_record {
+    uint64_t ts_ns;     // steady_clock nanoseconds, comparable across shards
+    uint16_t type;      // trace_event_type
+    uint16_t a;
+    uint32_t b;
+    uint64_t arg;
+};
+
+static_assert(sizeof(trace_record) == 24, "trace_record layout is part of the dump format");
+
+// Leads every trace dump file.
+struct trace_file_header {
+    char magic[8];      // "SSTRACE1"
+    uint32_t shard;
+    uint32_t record_size;
+};
+
+// Per-shard fixed-size binary event ring. The probe points are always
+// compiled in; when tracing is disabled their only cost is one
+// well-predicted branch. The ring overwrites its oldest records, so a
+// dump holds the most recent window of activity.
+class trace_ring {
+    static constexpr size_t default_capacity = 128 * 1024; // records, must be a power of two
+    std::unique_ptr<trace_record[]> _buf;
+    size_t _mask = 0;
+    uint64_t _head = 0; // total records ever written
+    bool _enabled = false;
+public:
+    bool enabled() const noexcept {
+        return _enabled;
+    }
+    // Allocates the ring on first use
+    void enable();
+    void disable() noexcept {
+        _enabled = false;
+    }
+    void trace(trace_event_type type, uint16_t a, uint32_t b, uint64_t arg) noexcept {
+        if (__builtin_expect(!_enabled, true)) {
+            return;
+        }
+        auto& r = _buf[_head++ & _mask];
+        r.ts_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        r.type = uint16_t(type);
+        r.a = a;
+        r.b = b;
+        r.arg = arg;
+    }
+    // Copies the buffered records in chronological order
+    std::vector<trace_record> snapshot() const;
+};
+
+extern thread_local trace_ring g_trace_ring;
+
+inline trace_ring& local_trace_ring() noexcept {
+    return g_trace_ring;
+}
+
+}
+
+}
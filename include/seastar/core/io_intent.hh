@@ -24,9 +24,65 @@
 #include <boost/container/small_vector.hpp>
 #include <seastar/core/internal/io_intent.hh>
 #include <seastar/core/io_priority_class.hh>
+#include <seastar/util/shared_token_bucket.hh>
+#include <stdexcept>
 
 namespace seastar {
 
+/// \brief A tenant of the I/O queue
+///
+/// Identifies a flow of requests that must not consume disk bandwidth
+/// past the given limit even when the \ref io_priority_class shares
+/// would let it, e.g. when several tenants of the service are
+/// multiplexed over one priority class. Requests join the tenant by
+/// being issued under an \ref io_intent pointing at it; once the tenant
+/// runs out of tokens its subsequent requests wait behind its token
+/// bucket and don't compete with other tenants' requests in the
+/// \ref fair_queue.
+///
+/// The bucket is shared between shards, so the limit applies to the
+/// tenant as a whole. The object must remain alive as long as any
+/// request issued under it is in flight.
+class io_tenant {
+public:
+    /// @private
+    using token_bucket_t = internal::shared_token_bucket<uint64_t, std::ratio<1>, internal::capped_release::no>;
+
+    static constexpr uint64_t default_burst = 10 << 20; // 10MB
+
+private:
+    static constexpr uint64_t bandwidth_threshold = 128 << 10; // 128kB
+
+    token_bucket_t _tb;
+
+    static uint64_t check_rate(uint64_t bandwidth) {
+        if (bandwidth > token_bucket_t::max_rate) {
+            throw std::runtime_error("Too large tenant bandwidth");
+        }
+        return bandwidth;
+    }
+
+public:
+    /// Constructs a tenant limited to \c bandwidth bytes per second.
+    /// An idle tenant accumulates up to \c burst bytes worth of tokens
+    /// to spend at once.
+    explicit io_tenant(uint64_t bandwidth, uint64_t burst = default_burst)
+        : _tb(check_rate(bandwidth), burst, bandwidth_threshold)
+    {
+    }
+
+    io_tenant(const io_tenant&) = delete;
+    io_tenant& operator=(const io_tenant&) = delete;
+
+    /// Updates the tenant's bandwidth limit
+    void update_bandwidth(uint64_t bandwidth) {
+        _tb.update_rate(check_rate(bandwidth));
+    }
+
+    /// @private
+    token_bucket_t& bucket() noexcept { return _tb; }
+};
+
 /// \example file_demo.cc
 /// A handle confirming the caller's intent to do the IO
 ///
@@ -37,6 +93,9 @@ namespace seastar {
 ///
 /// If no intent is provided, then the request is processed till its
 /// completion be it success or error
+///
+/// An intent can also attach its requests to an \ref io_tenant,
+/// subjecting them to the tenant's bandwidth limit
 class io_intent {
     struct intents_for_queue {
         dev_t dev;
@@ -68,16 +127,21 @@ class io_intent {
 
     boost::container::small_vector<intents_for_queue, 1> _intents;
     references _refs;
+    io_tenant* _tenant = nullptr;
     friend internal::intent_reference::intent_reference(io_intent*) noexcept;
 
 public:
     io_intent() = default;
     ~io_intent() = default;
 
+    /// Constructs an intent whose requests belong to \c tenant. The
+    /// tenant must outlive all the requests issued under this intent
+    explicit io_intent(io_tenant& tenant) noexcept : _tenant(&tenant) {}
+
     io_intent(const io_intent&) = delete;
     io_intent& operator=(const io_intent&) = delete;
     io_intent& operator=(io_intent&&) = delete;
-    io_intent(io_intent&& o) noexcept : _intents(std::move(o._intents)), _refs(std::move(o._refs)) {
+    io_intent(io_intent&& o) noexcept : _intents(std::move(o._intents)), _refs(std::move(o._refs)), _tenant(o._tenant) {
         for (auto&& r : _refs.list) {
             r._intent = this;
         }
@@ -91,6 +155,11 @@ public:
         _intents.clear();
     }
 
+    /// @private
+    io_tenant* tenant() const noexcept {
+        return _tenant;
+    }
+
     /// @private
     internal::cancellable_queue& find_or_create_cancellable_queue(dev_t dev, io_priority_class_id qid) {
         for (auto&& i : _intents) {
@@ -30,6 +30,8 @@
 #include <seastar/util/spinlock.hh>
 #include <chrono>
 #include <memory>
+#include <optional>
+#include <unordered_map>
 #include <vector>
 #include <sys/uio.h>
 
@@ -44,6 +46,7 @@ future<>
 rename_priority_class(io_priority_class pc, sstring new_name);
 
 class io_intent;
+class io_tenant;
 
 namespace internal {
 class io_sink;
@@ -83,6 +86,33 @@ private:
     // decoupling and is temporary
     size_t _queued_requests = 0;
     size_t _requests_executing = 0;
+
+    // Physically adjacent reads (resp. writes) dispatched during the same
+    // poll tick are accumulated here and merged into a single vectored
+    // request before they reach the sink (see config::max_merge_length).
+    struct pending_merge {
+        internal::io_request::operation op;
+        int fd;
+        uint64_t pos;
+        size_t length;
+        bool nowait_works;
+        boost::container::small_vector<std::pair<io_desc_read_write*, size_t>, 4> parts;
+        std::vector<::iovec> iovs;
+    };
+    std::optional<pending_merge> _pending_merge;
+
+    bool try_merge_request(io_desc_read_write* desc, const internal::io_request& req) noexcept;
+    void flush_pending_merge() noexcept;
+
+    // Requests issued under an io_tenant wait here while the tenant is
+    // over its bandwidth and join the fair queue as the tenant's token
+    // bucket replenishes (see io_intent).
+    struct tenant_queue;
+    std::unordered_map<io_tenant*, std::unique_ptr<tenant_queue>> _tenant_queues;
+
+    tenant_queue& find_or_create_tenant_queue(io_tenant& tenant);
+    bool park_throttled_tenant(tenant_queue& tq, queued_io_request& req) noexcept;
+    void unpark_tenant(tenant_queue& tq) noexcept;
 public:
 
     using clock_type = std::chrono::steady_clock;
@@ -111,6 +141,13 @@ public:
         float rate_factor = 1.0;
         std::chrono::duration<double> rate_limit_duration = std::chrono::milliseconds(1);
         size_t block_count_limit_min = 1;
+        // Maximum length of a request built by merging physically adjacent
+        // requests dispatched in the same poll tick. Zero disables merging.
+        size_t max_merge_length = 0;
+        // Number of io groups the device rate is split between. When
+        // larger than one the groups borrow each other's unused budget
+        // (see io_group spare pools).
+        unsigned nr_groups = 1;
     };
 
     io_queue(io_group_ptr group, internal::io_sink& sink);
@@ -127,6 +164,7 @@ public:
     future<size_t> queue_one_request(const io_priority_class& pc, internal::io_direction_and_length dnl, internal::io_request req, io_intent* intent, iovec_keeper iovs) noexcept;
     void submit_request(io_desc_read_write* desc, internal::io_request req) noexcept;
     void cancel_request(queued_io_request& req) noexcept;
+    void cancel_dispatched_request(io_desc_read_write& desc) noexcept;
     void complete_cancelled_request(queued_io_request& req) noexcept;
     void complete_request(io_desc_read_write& desc) noexcept;
 
@@ -171,7 +209,10 @@ private:
 
 class io_group {
 public:
-    explicit io_group(io_queue::config io_cfg);
+    // Groups serving the same device should be created with the first of
+    // them as the peer, so they share the spare capacity pools and can
+    // borrow the device rate fractions each other leaves unused.
+    explicit io_group(io_queue::config io_cfg, const io_group* peer = nullptr);
     ~io_group();
     struct priority_class_data;
 
@@ -182,6 +223,7 @@ private:
     const io_queue::config _config;
     size_t _max_request_length[2];
     std::vector<std::unique_ptr<fair_group>> _fgs;
+    std::vector<std::shared_ptr<fair_group::capacity_pool>> _spare_pools;
     std::vector<std::unique_ptr<priority_class_data>> _priority_classes;
     util::spinlock _lock;
     const shard_id _allocated_on;
@@ -26,6 +26,7 @@
 #include <seastar/core/do_with.hh>
 #include <seastar/core/loop.hh>
 #include <seastar/net/packet.hh>
+#include <seastar/util/critical_alloc_section.hh>
 #include <seastar/util/variant_utils.hh>
 
 namespace seastar {
@@ -73,6 +74,34 @@ future<> output_stream<CharType>::write(scattered_message<CharType> msg) noexcep
     return write(std::move(msg).release());
 }
 
+template<typename CharType>
+future<>
+output_stream<CharType>::put_to_sink(temporary_buffer<CharType> buf) noexcept {
+    if (!_bp) {
+        return _fd.put(std::move(buf));
+    }
+    auto n = buf.size();
+    return _bp->acquire(n).then([this, buf = std::move(buf)] () mutable {
+        return _fd.put(std::move(buf));
+    }).finally([bp = _bp, n] {
+        bp->release(n);
+    });
+}
+
+template<typename CharType>
+future<>
+output_stream<CharType>::put_to_sink(net::packet p) noexcept {
+    if (!_bp) {
+        return _fd.put(std::move(p));
+    }
+    auto n = p.len();
+    return _bp->acquire(n).then([this, p = std::move(p)] () mutable {
+        return _fd.put(std::move(p));
+    }).finally([bp = _bp, n] {
+        bp->release(n);
+    });
+}
+
 template<typename CharType>
 future<>
 output_stream<CharType>::zero_copy_put(net::packet p) noexcept {
@@ -81,10 +110,10 @@ output_stream<CharType>::zero_copy_put(net::packet p) noexcept {
     if (_flushing) {
         // flush in progress, wait for it to end before continuing
         return _in_batch.value().get_future().then([this, p = std::move(p)] () mutable {
-            return _fd.put(std::move(p));
+            return put_to_sink(std::move(p));
         });
     } else {
-        return _fd.put(std::move(p));
+        return put_to_sink(std::move(p));
     }
 }
 
@@ -149,6 +178,31 @@ future<> output_stream<CharType>::write(temporary_buffer<CharType> p) noexcept {
   }
 }
 
+template <typename CharType>
+future<temporary_buffer<CharType>>
+input_stream<CharType>::get_from_source() noexcept {
+    if (!_bp) {
+        return _fd.get();
+    }
+    return _fd.get().then([this] (tmp_buf buf) {
+        if (buf.empty()) {
+            return make_ready_future<tmp_buf>(std::move(buf));
+        }
+        // Charge the budget for the buffer and return the charge from its
+        // deleter, so the bytes stay accounted for while any share of the
+        // buffer is alive anywhere in the pipeline. If the budget is
+        // exhausted, waiting here stalls the source's read-ahead.
+        auto n = buf.size();
+        return _bp->acquire(n).then([bp = _bp, n, buf = std::move(buf)] () mutable {
+            auto ptr = buf.get_write();
+            auto d = make_deleter(buf.release(), [bp = std::move(bp), n] {
+                bp->release(n);
+            });
+            return tmp_buf(ptr, n, std::move(d));
+        });
+    });
+}
+
 template <typename CharType>
 future<temporary_buffer<CharType>>
 input_stream<CharType>::read_exactly_part(size_t n, tmp_buf out, size_t completed) noexcept {
@@ -163,7 +217,7 @@ input_stream<CharType>::read_exactly_part(size_t n, tmp_buf out, size_t complete
     }
 
     // _buf is now empty
-    return _fd.get().then([this, n, out = std::move(out), completed] (auto buf) mutable {
+    return get_from_source().then([this, n, out = std::move(out), completed] (auto buf) mutable {
         if (buf.size() == 0) {
             _eof = true;
             out.trim(completed);
@@ -187,7 +241,7 @@ input_stream<CharType>::read_exactly(size_t n) noexcept {
         return make_ready_future<tmp_buf>(std::move(front));
     } else if (_buf.size() == 0) {
         // buffer is empty: grab one and retry
-        return _fd.get().then([this, n] (auto buf) mutable {
+        return get_from_source().then([this, n] (auto buf) mutable {
             if (buf.size() == 0) {
                 _eof = true;
                 return make_ready_future<tmp_buf>(std::move(buf));
@@ -213,7 +267,7 @@ future<>
 input_stream<CharType>::consume(Consumer&& consumer) noexcept(std::is_nothrow_move_constructible_v<Consumer>) {
     return repeat([consumer = std::move(consumer), this] () mutable {
         if (_buf.empty() && !_eof) {
-            return _fd.get().then([this] (tmp_buf buf) {
+            return get_from_source().then([this] (tmp_buf buf) {
                 _buf = std::move(buf);
                 _eof = _buf.empty();
                 return make_ready_future<stop_iteration>(stop_iteration::no);
@@ -258,7 +312,7 @@ input_stream<CharType>::read_up_to(size_t n) noexcept {
         if (_eof) {
             return make_ready_future<tmp_buf>();
         } else {
-            return _fd.get().then([this, n] (tmp_buf buf) {
+            return get_from_source().then([this, n] (tmp_buf buf) {
                 _eof = buf.empty();
                 _buf = std::move(buf);
                 return read_up_to(n);
@@ -287,7 +341,7 @@ input_stream<CharType>::read() noexcept {
         return make_ready_future<tmp_buf>();
     }
     if (_buf.empty()) {
-        return _fd.get().then([this] (tmp_buf buf) {
+        return get_from_source().then([this] (tmp_buf buf) {
             _eof = buf.empty();
             return make_ready_future<tmp_buf>(std::move(buf));
         });
@@ -320,6 +374,38 @@ input_stream<CharType>::detach() && {
     return std::move(_fd);
 }
 
+// Returns a batch buffer of _size bytes, reusing the storage of a previous
+// batch if the sink already released it, so steady-state buffered writes
+// don't allocate.
+template <typename CharType>
+temporary_buffer<CharType>
+output_stream<CharType>::allocate_buffer() {
+    if (_spare && _spare->buf.size() == _size) {
+        return std::move(_spare->buf);
+    }
+    return _fd.allocate_buffer(_size);
+}
+
+// Hands off the first @len bytes of _buf for writing to the sink. The
+// handed-off buffer keeps the whole batch buffer alive and returns it, at
+// its full capacity, to the stream's spare slot once the sink releases it.
+template <typename CharType>
+temporary_buffer<CharType>
+output_stream<CharType>::detach_buffer(size_t len) noexcept {
+    memory::scoped_critical_alloc_section _;
+    if (!_spare) {
+        _spare = make_lw_shared<internal::stream_spare_buffer<CharType>>();
+    }
+    auto data = _buf.get_write();
+    temporary_buffer<CharType> head(data, len, make_deleter([spare = _spare, buf = std::move(_buf)] () mutable {
+        if (!spare->buf) {
+            spare->buf = std::move(buf);
+        }
+    }));
+    _end = 0;
+    return head;
+}
+
 // Writes @buf in chunks of _size length. The last chunk is buffered if smaller.
 template <typename CharType>
 future<>
@@ -329,7 +415,7 @@ output_stream<CharType>::split_and_put(temporary_buffer<CharType> buf) noexcept
     return repeat([this, buf = std::move(buf)] () mutable {
         if (buf.size() < _size) {
             if (!_buf) {
-                _buf = _fd.allocate_buffer(_size);
+                _buf = allocate_buffer();
             }
             std::copy(buf.get(), buf.get() + buf.size(), _buf.get_write());
             _end = buf.size();
@@ -367,9 +453,7 @@ output_stream<CharType>::slow_write(const char_type* buf, size_t n) noexcept {
             _end = _size;
             temporary_buffer<char> tmp = _fd.allocate_buffer(n - now);
             std::copy(buf + now, buf + n, tmp.get_write());
-            _buf.trim(_end);
-            _end = 0;
-            return put(std::move(_buf)).then([this, tmp = std::move(tmp)]() mutable {
+            return put(detach_buffer(_size)).then([this, tmp = std::move(tmp)]() mutable {
                 if (_trim_to_size) {
                     return split_and_put(std::move(tmp));
                 } else {
@@ -388,7 +472,7 @@ output_stream<CharType>::slow_write(const char_type* buf, size_t n) noexcept {
     }
 
     if (!_buf) {
-        _buf = _fd.allocate_buffer(_size);
+        _buf = allocate_buffer();
     }
 
     auto now = std::min(n, _size - _end);
@@ -397,11 +481,12 @@ output_stream<CharType>::slow_write(const char_type* buf, size_t n) noexcept {
     if (now == n) {
         return make_ready_future<>();
     } else {
-        temporary_buffer<char> next = _fd.allocate_buffer(_size);
+        temporary_buffer<CharType> next = allocate_buffer();
         std::copy(buf + now, buf + n, next.get_write());
+        auto head = detach_buffer(_size);
+        _buf = std::move(next);
         _end = n - now;
-        std::swap(next, _buf);
-        return put(std::move(next));
+        return put(std::move(head));
     }
   } catch (...) {
     return current_exception_as_future();
@@ -413,13 +498,11 @@ void add_to_flush_poller(output_stream<char>& x) noexcept;
 template <typename CharType>
 future<> output_stream<CharType>::do_flush() noexcept {
     if (_end) {
-        _buf.trim(_end);
-        _end = 0;
-        return _fd.put(std::move(_buf)).then([this] {
+        return put_to_sink(detach_buffer(_end)).then([this] {
             return _fd.flush();
         });
     } else if (_zc_bufs) {
-        return _fd.put(std::move(_zc_bufs)).then([this] {
+        return put_to_sink(std::move(_zc_bufs)).then([this] {
             return _fd.flush();
         });
     } else {
@@ -430,6 +513,16 @@ future<> output_stream<CharType>::do_flush() noexcept {
 template <typename CharType>
 future<>
 output_stream<CharType>::flush() noexcept {
+    if (_corked) {
+        // corked: remember the request, the real flush happens when the
+        // last corked_region goes away
+        _flush_deferred = true;
+        if (_ex) {
+            // flush is a good time to deliver outstanding errors
+            return make_exception_future<>(std::move(_ex));
+        }
+        return make_ready_future<>();
+    }
     if (!_batch_flushes) {
         return do_flush();
     } else {
@@ -455,10 +548,10 @@ output_stream<CharType>::put(temporary_buffer<CharType> buf) noexcept {
     if (_flushing) {
         // flush in progress, wait for it to end before continuing
         return _in_batch.value().get_future().then([this, buf = std::move(buf)] () mutable {
-            return _fd.put(std::move(buf));
+            return put_to_sink(std::move(buf));
         });
     } else {
-        return _fd.put(std::move(buf));
+        return put_to_sink(std::move(buf));
     }
 }
 
@@ -473,6 +566,23 @@ output_stream<CharType>::poll_flush() noexcept {
         return;
     }
 
+    if (_flush_period != std::chrono::microseconds(0)) {
+        auto now = steady_clock_type::now();
+        // pacing only aggregates sub-buffer-size batches; once a full
+        // buffer has accumulated there is nothing to gain from waiting
+        auto buffered = _end + (_zc_bufs ? _zc_bufs.len() : 0);
+        if (now < _next_flush && buffered < _size) {
+            // paced mode: the previous flush was too recent. Keep the
+            // batch open, let writers proceed, and come back when the
+            // cadence allows another transmission.
+            _flushing = false;
+            _flush_timer.set_callback([this] { add_to_flush_poller(*this); });
+            _flush_timer.arm(_next_flush);
+            return;
+        }
+        _next_flush = now + _flush_period;
+    }
+
     _flush = false;
     _flushing = true; // make whoever wants to write into the fd to wait for flush to complete
 
@@ -36,13 +36,18 @@
 #pragma once
 
 #include <boost/intrusive/slist.hpp>
+#include <seastar/core/chunked_fifo.hh>
 #include <seastar/core/future.hh>
 #include <seastar/core/temporary_buffer.hh>
 #include <seastar/core/scattered_message.hh>
+#include <seastar/core/shared_ptr.hh>
+#include <seastar/core/timer.hh>
 #include <seastar/util/std-compat.hh>
 #include <algorithm>
+#include <chrono>
 #include <memory>
 #include <optional>
+#include <stdexcept>
 #include <variant>
 #include <vector>
 
@@ -52,6 +57,8 @@ namespace seastar {
 
 namespace net { class packet; }
 
+class file;
+
 class data_source_impl {
 public:
     virtual ~data_source_impl() {}
@@ -106,18 +113,36 @@ public:
         net::packet p;
         p.reserve(data.size());
         for (auto& buf : data) {
-            p = net::packet(std::move(p), net::fragment{buf.get_write(), buf.size()}, buf.release());
+            // release() first: it moves internally-stored buffers to the
+            // stable storage the deleter owns
+            auto d = buf.release();
+            p = net::packet(std::move(p), net::fragment{buf.get_write(), buf.size()}, std::move(d));
         }
         return put(std::move(p));
     }
     virtual future<> put(temporary_buffer<char> buf) {
-        return put(net::packet(net::fragment{buf.get_write(), buf.size()}, buf.release()));
+        auto d = buf.release();
+        return put(net::packet(net::fragment{buf.get_write(), buf.size()}, std::move(d)));
     }
     virtual future<> flush() {
         return make_ready_future<>();
     }
     virtual future<> close() = 0;
 
+    // Whether the sink can transfer bytes into itself directly from a kernel
+    // file descriptor (see sendfile() below).
+    virtual bool can_sendfile() const noexcept {
+        return false;
+    }
+
+    // Send len bytes starting at pos from the given file descriptor into the
+    // sink without bouncing them through userspace. Returns the number of
+    // bytes actually sent; zero means the descriptor hit end-of-file. Only
+    // called when can_sendfile() returns true.
+    virtual future<size_t> sendfile(int fd, uint64_t pos, size_t len) {
+        return make_exception_future<size_t>(std::logic_error("sendfile not supported by this sink"));
+    }
+
     // The method should return the maximum buffer size that's acceptable by
     // the sink. It's used when the output stream is constructed without any
     // specific buffer size. In this case the stream accepts this value as its
@@ -175,6 +200,77 @@ public:
     }
 
     size_t buffer_size() const noexcept { return _dsi->buffer_size(); }
+
+    bool can_sendfile() const noexcept { return _dsi->can_sendfile(); }
+    future<size_t> sendfile(int fd, uint64_t pos, size_t len) noexcept {
+        try {
+            return _dsi->sendfile(fd, pos, len);
+        } catch (...) {
+            return current_exception_as_future<size_t>();
+        }
+    }
+};
+
+/// A shared byte budget coupling both ends of a pipeline.
+///
+/// When a pipeline reads from one stream and writes to another (disk to
+/// socket, say), a stalled consumer does not by itself stop the producer:
+/// read-ahead keeps buffering until memory pressure does. Attaching the
+/// same \c pipeline_backpressure to the \c input_stream and the
+/// \c output_stream bounds the bytes buffered end to end: the input
+/// stream charges the budget for every buffer it hands out and the
+/// charge is returned when the buffer is finally freed (for zero-copy
+/// writes, after the sink is done with it), while the output stream
+/// charges bytes it queues towards its sink until the sink accepts them.
+/// When the budget is exhausted, reads stall, which in turn stalls the
+/// source's read-ahead.
+///
+/// The budget should be at least twice the largest buffer flowing through
+/// the pipeline, since a buffer in transit can be charged by both ends at
+/// once; a request larger than the whole budget is admitted alone once
+/// everything else drains, so progress is always possible. Credits are
+/// granted in FIFO order.
+class pipeline_backpressure {
+    size_t _budget;
+    size_t _used = 0;
+    struct waiter {
+        size_t bytes;
+        promise<> pr;
+    };
+    chunked_fifo<waiter> _waiters;
+private:
+    bool may_grant(size_t bytes) const noexcept {
+        return _used + bytes <= _budget || !_used;
+    }
+public:
+    explicit pipeline_backpressure(size_t budget_bytes) noexcept : _budget(budget_bytes) {}
+    pipeline_backpressure(const pipeline_backpressure&) = delete;
+    pipeline_backpressure(pipeline_backpressure&&) = delete;
+    /// Waits until \c bytes credits are available and takes them.
+    future<> acquire(size_t bytes) noexcept {
+        if (_waiters.empty() && may_grant(bytes)) {
+            _used += bytes;
+            return make_ready_future<>();
+        }
+        try {
+            _waiters.push_back(waiter{bytes, promise<>()});
+            return _waiters.back().pr.get_future();
+        } catch (...) {
+            return current_exception_as_future<>();
+        }
+    }
+    /// Returns \c bytes credits taken by a previous \ref acquire().
+    void release(size_t bytes) noexcept {
+        _used -= bytes;
+        while (!_waiters.empty() && may_grant(_waiters.front().bytes)) {
+            _used += _waiters.front().bytes;
+            _waiters.front().pr.set_value();
+            _waiters.pop_front();
+        }
+    }
+    /// Credits not currently taken.
+    size_t available() const noexcept { return _budget - std::min(_budget, _used); }
+    size_t budget() const noexcept { return _budget; }
 };
 
 struct continue_consuming {};
@@ -263,10 +359,11 @@ class input_stream final {
     static_assert(sizeof(CharType) == 1, "must buffer stream of bytes");
     data_source _fd;
     temporary_buffer<CharType> _buf;
+    lw_shared_ptr<pipeline_backpressure> _bp;
     bool _eof = false;
 private:
     using tmp_buf = temporary_buffer<CharType>;
-    size_t available() const noexcept { return _buf.size(); }
+    future<tmp_buf> get_from_source() noexcept;
 protected:
     void reset() noexcept { _buf = {}; }
     data_source* fd() noexcept { return &_fd; }
@@ -279,6 +376,10 @@ public:
     explicit input_stream(data_source fd) noexcept : _fd(std::move(fd)), _buf() {}
     input_stream(input_stream&&) = default;
     input_stream& operator=(input_stream&&) = default;
+    /// Returns the number of bytes currently buffered in the stream.
+    /// A read of up to this many bytes completes immediately, without
+    /// going back to the underlying data_source.
+    size_t available() const noexcept { return _buf.size(); }
     /// Reads n bytes from the stream, or fewer if reached the end of stream.
     ///
     /// \returns a future that waits until n bytes are available in the
@@ -335,6 +436,28 @@ public:
     ///
     /// \returns the data_source
     data_source detach() &&;
+
+    /// Releases the stream's buffered-but-unconsumed bytes, leaving the
+    /// buffer empty.
+    ///
+    /// Intended for handing the underlying source off to another consumer
+    /// (for example when migrating a connection to another shard), where
+    /// the released bytes must be replayed before any new reads from the
+    /// source. After calling \c release_buffer() the stream can be
+    /// detached with \ref detach() even if it has been read from.
+    ///
+    /// \returns the unconsumed bytes, possibly empty
+    tmp_buf release_buffer() noexcept {
+        return std::move(_buf);
+    }
+
+    /// Attaches a shared byte budget to the stream, see
+    /// \ref pipeline_backpressure. Every buffer the stream hands out is
+    /// charged against the budget until it is freed; when the budget is
+    /// exhausted further reads wait, stalling the source's read-ahead.
+    void set_backpressure(lw_shared_ptr<pipeline_backpressure> bp) noexcept {
+        _bp = std::move(bp);
+    }
 private:
     future<temporary_buffer<CharType>> read_exactly_part(size_t n, tmp_buf buf, size_t completed) noexcept;
 };
@@ -343,8 +466,29 @@ struct output_stream_options {
     bool trim_to_size = false; ///< Make sure that buffers put into sink haven't
                                ///< grown larger than the configured size
     bool batch_flushes = false; ///< Try to merge flushes with each other
+    std::chrono::microseconds flush_period = std::chrono::microseconds(0);
+                               ///< When nonzero, space consecutive sink flushes
+                               ///< at least this far apart, coalescing whatever
+                               ///< accumulates in between. Smooths bursty fan-in
+                               ///< (incast) traffic at the cost of up to one
+                               ///< period of added latency. Implies batch_flushes.
+};
+
+/// \cond internal
+namespace internal {
+
+// Holds an output_stream's spare batch buffer. Shared between the stream
+// and the deleter of buffers handed to the data sink, so the storage of a
+// completed batch finds its way back to the stream even if the stream was
+// moved while the sink still referenced the buffer.
+template <typename CharType>
+struct stream_spare_buffer {
+    temporary_buffer<CharType> buf;
 };
 
+}
+/// \endcond
+
 /// Facilitates data buffering before it's handed over to data_sink.
 ///
 /// When trim_to_size is true it's guaranteed that data sink will not receive
@@ -361,40 +505,62 @@ class output_stream final {
     static_assert(sizeof(CharType) == 1, "must buffer stream of bytes");
     data_sink _fd;
     temporary_buffer<CharType> _buf;
+    lw_shared_ptr<pipeline_backpressure> _bp;
+    lw_shared_ptr<internal::stream_spare_buffer<CharType>> _spare;
     net::packet _zc_bufs = net::packet::make_null_packet(); //zero copy buffers
     size_t _size = 0;
     size_t _begin = 0;
     size_t _end = 0;
     bool _trim_to_size = false;
     bool _batch_flushes = false;
+    std::chrono::microseconds _flush_period = std::chrono::microseconds(0);
+    steady_clock_type::time_point _next_flush = {};
+    timer<> _flush_timer;
     std::optional<promise<>> _in_batch;
     bool _flush = false;
     bool _flushing = false;
+    unsigned _corked = 0;
+    bool _flush_deferred = false;
     std::exception_ptr _ex;
     bi::slist_member_hook<> _in_poller;
 
 private:
     size_t available() const noexcept { return _end - _begin; }
+    temporary_buffer<CharType> allocate_buffer();
+    temporary_buffer<CharType> detach_buffer(size_t len) noexcept;
     future<> split_and_put(temporary_buffer<CharType> buf) noexcept;
     future<> put(temporary_buffer<CharType> buf) noexcept;
     void poll_flush() noexcept;
     future<> do_flush() noexcept;
     future<> zero_copy_put(net::packet p) noexcept;
     future<> zero_copy_split_and_put(net::packet p) noexcept;
+    future<> put_to_sink(temporary_buffer<CharType> buf) noexcept;
+    future<> put_to_sink(net::packet p) noexcept;
     [[gnu::noinline]]
     future<> slow_write(const CharType* buf, size_t n) noexcept;
 public:
     using char_type = CharType;
     output_stream() noexcept = default;
     output_stream(data_sink fd, size_t size, output_stream_options opts = {}) noexcept
-        : _fd(std::move(fd)), _size(size), _trim_to_size(opts.trim_to_size), _batch_flushes(opts.batch_flushes) {}
+        : _fd(std::move(fd)), _size(size), _trim_to_size(opts.trim_to_size)
+        , _batch_flushes(opts.batch_flushes || opts.flush_period != std::chrono::microseconds(0))
+        , _flush_period(opts.flush_period) {}
     [[deprecated("use output_stream_options instead of booleans")]]
     output_stream(data_sink fd, size_t size, bool trim_to_size, bool batch_flushes = false) noexcept
         : _fd(std::move(fd)), _size(size), _trim_to_size(trim_to_size), _batch_flushes(batch_flushes) {}
     output_stream(data_sink fd) noexcept
         : _fd(std::move(fd)), _size(_fd.buffer_size()), _trim_to_size(true) {}
     output_stream(output_stream&&) noexcept = default;
-    output_stream& operator=(output_stream&&) noexcept = default;
+    // not defaulted: timer<> is not move-assignable. The stream must be
+    // quiescent (no pending flush) when moved, so dropping the target's
+    // state through its destructor is equivalent to member-wise moving.
+    output_stream& operator=(output_stream&& o) noexcept {
+        if (this != &o) {
+            this->~output_stream();
+            new (this) output_stream(std::move(o));
+        }
+        return *this;
+    }
     ~output_stream() {
         if (_batch_flushes) {
             assert(!_in_batch && "Was this stream properly closed?");
@@ -412,8 +578,93 @@ public:
     future<> write(net::packet p) noexcept;
     future<> write(scattered_message<char_type> msg) noexcept;
     future<> write(temporary_buffer<char_type>) noexcept;
+
+    /// Sends the byte range [pos, pos + len) of the given file to the
+    /// underlying sink, bypassing the stream buffer (buffered data is
+    /// flushed first). Sinks that support it (posix-stack sockets) transfer
+    /// the bytes with sendfile(2), without a userspace copy; other sinks
+    /// fall back to reading and writing in chunks.
+    ///
+    /// Defined in <seastar/core/fstream.hh>.
+    future<> sendfile(file f, uint64_t pos, size_t len) noexcept;
+
     future<> flush() noexcept;
 
+    /// RAII region suppressing flushes, see \ref cork().
+    ///
+    /// While at least one \c corked_region is alive, \ref flush() only
+    /// records that a flush was requested and the written data stays in
+    /// the stream buffer. \ref release() uncorks and performs the
+    /// deferred flush. Destroying the region without calling
+    /// \c release() also uncorks, but folds a deferred flush into the
+    /// next \ref flush() or \ref close() instead of issuing it.
+    ///
+    /// The stream must not be moved or closed while corked regions
+    /// referencing it are alive.
+    class corked_region {
+        output_stream* _stream = nullptr;
+
+        explicit corked_region(output_stream& s) noexcept : _stream(&s) {
+            _stream->_corked++;
+        }
+        friend class output_stream;
+    public:
+        corked_region() noexcept = default;
+        corked_region(const corked_region&) = delete;
+        corked_region(corked_region&& o) noexcept : _stream(std::exchange(o._stream, nullptr)) { }
+        corked_region& operator=(corked_region&& o) noexcept {
+            if (this != &o) {
+                this->~corked_region();
+                _stream = std::exchange(o._stream, nullptr);
+            }
+            return *this;
+        }
+        ~corked_region() {
+            if (_stream) {
+                _stream->_corked--;
+                // in batch-flush mode re-requesting the flush is cheap
+                // and non-blocking, so don't sit on the data
+                if (!_stream->_corked && _stream->_flush_deferred && _stream->_batch_flushes) {
+                    _stream->_flush_deferred = false;
+                    (void)_stream->flush();
+                }
+            }
+        }
+        /// Uncorks the stream and issues the flush deferred while the
+        /// region was held, if any.
+        future<> release() noexcept {
+            if (!_stream) {
+                return make_ready_future<>();
+            }
+            auto s = std::exchange(_stream, nullptr);
+            if (!--s->_corked && std::exchange(s->_flush_deferred, false)) {
+                return s->flush();
+            }
+            return make_ready_future<>();
+        }
+    };
+
+    /// Corks the stream: until the returned region is released, calls
+    /// to \ref flush() keep the data buffered instead of handing it to
+    /// the sink, so a sequence of small writes interleaved with flushes
+    /// (e.g. a multi-part response assembled by layered code) goes out
+    /// as one aggregated batch. This is the application-controlled
+    /// replacement for Nagle's algorithm, which \ref
+    /// connected_socket::set_nodelay() disables; combine with \ref
+    /// output_stream_options::flush_period for a time bound instead of
+    /// an explicit scope.
+    corked_region cork() noexcept {
+        return corked_region(*this);
+    }
+
+    /// Attaches a shared byte budget to the stream, see
+    /// \ref pipeline_backpressure. Bytes handed to the underlying sink are
+    /// charged against the budget until the sink accepts them, so a slow
+    /// sink pushes back on the producing end of the pipeline.
+    void set_backpressure(lw_shared_ptr<pipeline_backpressure> bp) noexcept {
+        _bp = std::move(bp);
+    }
+
     /// Flushes the stream before closing it (and the underlying data sink) to
     /// any further writes.  The resulting future must be waited on before
     /// destroying this object.
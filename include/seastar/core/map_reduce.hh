@@ -22,10 +22,15 @@
 
 #pragma once
 
+#include <algorithm>
 #include <iterator>
+#include <tuple>
+#include <vector>
 
 #include <seastar/core/future.hh>
 #include <seastar/core/shared_ptr.hh>
+#include <seastar/core/smp.hh>
+#include <seastar/core/when_all.hh>
 
 namespace seastar {
 
@@ -258,6 +263,121 @@ map_reduce(Range&& range, Mapper&& mapper, Initial initial, Reduce reduce) {
             std::move(initial), std::move(reduce));
 }
 
+/// \cond internal
+
+namespace internal {
+
+// Splits a shard list ordered so that shards sharing a NUMA node are
+// contiguous. Prefers the inter-node boundary closest to the middle, so
+// subtrees stay node-local and cross-node hops happen only near the root
+// of the reduction tree.
+inline
+size_t
+tree_reduction_split(const std::vector<shard_id>& shards) {
+    size_t mid = shards.size() / 2;
+    size_t best = mid;
+    size_t best_distance = shards.size();
+    for (size_t i = 1; i < shards.size(); ++i) {
+        if (smp::numa_node_id(shards[i]) != smp::numa_node_id(shards[i - 1])) {
+            auto distance = i < mid ? mid - i : i - mid;
+            if (distance < best_distance) {
+                best = i;
+                best_distance = distance;
+            }
+        }
+    }
+    return best;
+}
+
+// Runs on shards.front(); maps every shard in the list and reduces the
+// results pairwise, delegating the right half of the list to its first
+// shard. Each shard therefore combines at most O(log n) payloads.
+template <typename Initial, typename Mapper, typename Reduce>
+future<Initial>
+do_map_reduce_tree(std::vector<shard_id> shards, Mapper mapper, Reduce reduce) {
+    if (shards.size() == 1) {
+        return futurize_invoke(mapper).then([] (auto v) {
+            return Initial(std::move(v));
+        });
+    }
+    auto split = tree_reduction_split(shards);
+    std::vector<shard_id> right(shards.begin() + split, shards.end());
+    shards.resize(split);
+    auto right_leader = right.front();
+    auto left = do_map_reduce_tree<Initial>(std::move(shards), mapper, reduce);
+    auto rhs = smp::submit_to(right_leader, [right = std::move(right), mapper, reduce] () mutable {
+        return do_map_reduce_tree<Initial>(std::move(right), std::move(mapper), std::move(reduce));
+    });
+    return when_all(std::move(left), std::move(rhs)).then([reduce = std::move(reduce)] (std::tuple<future<Initial>, future<Initial>> vals) mutable {
+        auto& [l, r] = vals;
+        if (l.failed() || r.failed()) {
+            auto ex = l.failed() ? l.get_exception() : r.get_exception();
+            l.ignore_ready_future();
+            r.ignore_ready_future();
+            return seastar::make_exception_future<Initial>(std::move(ex));
+        }
+        return futurize_invoke(reduce, l.get0(), r.get0());
+    });
+}
+
+} // namespace internal
+
+/// \endcond
+
+/// Asynchronous map/reduce over all shards with tree-topology reduction.
+///
+/// Invokes \c mapper on every shard and combines the results pairwise
+/// along a binary tree laid out over the machine topology: shards on the
+/// same NUMA node are reduced among themselves first, and only the
+/// per-node partial results cross node boundaries. Compared with
+/// \ref sharded::map_reduce0(), which reduces all results serially on the
+/// calling shard, reduction latency scales with O(log n) instead of O(n)
+/// and no single shard combines more than O(log n) intermediate values,
+/// which matters when the intermediate values are large (e.g. per-shard
+/// histograms).
+///
+/// Requirements:
+///    - Mapper: nullary function invoked on each shard, returning
+///      \c Initial or \c future<Initial> (or a type convertible to
+///      \c Initial); must be copyable as it is sent to every shard.
+///    - Reduce: a binary function combining two \c Initial values into an
+///      \c Initial; must be associative and copyable.
+///
+/// \param mapper map function invoked on each shard
+/// \param initial initial input value to the reduce function
+/// \param reduce binary function for merging two result values
+///
+/// \return all mapped values reduced with \c reduce, folded with
+///         \c initial, resolved on the calling shard.
+template <typename Mapper, typename Initial, typename Reduce>
+SEASTAR_CONCEPT( requires requires (Mapper mapper, Initial initial, Reduce reduce) {
+     { futurize_invoke(mapper).get0() } -> std::convertible_to<Initial>;
+     { reduce(std::move(initial), std::move(initial)) } -> std::convertible_to<Initial>;
+} )
+inline
+future<Initial>
+map_reduce_tree(Mapper mapper, Initial initial, Reduce reduce) {
+    std::vector<shard_id> shards;
+    shards.reserve(smp::count);
+    for (auto s : smp::all_cpus()) {
+        shards.push_back(s);
+    }
+    // Order shards so NUMA nodes are contiguous, with the calling shard's
+    // node first and the calling shard leading it, so the root of the
+    // reduction tree runs here and the final result needs no extra hop.
+    auto my_node = smp::numa_node_id(this_shard_id());
+    std::sort(shards.begin(), shards.end(), [my_node] (shard_id a, shard_id b) {
+        auto key = [my_node] (shard_id s) {
+            return std::make_tuple(smp::numa_node_id(s) != my_node, smp::numa_node_id(s), s != this_shard_id(), s);
+        };
+        return key(a) < key(b);
+    });
+    return internal::do_map_reduce_tree<Initial>(std::move(shards), std::move(mapper), reduce)
+            .then([initial = std::move(initial), reduce] (Initial v) mutable {
+        return futurize_invoke(reduce, std::move(initial), std::move(v));
+    });
+}
+
 /// Implements @Reducer concept. Calculates the result by
 /// adding elements to the accumulator.
 template <typename Result, typename Addend = Result>
@@ -0,0 +1,97 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB
+ */
+
+#pragma once
+
+#include <seastar/core/future.hh>
+#include <seastar/core/file.hh>
+#include <seastar/core/posix.hh>
+#include <seastar/core/sstring.hh>
+#include <vector>
+
+namespace seastar {
+
+/// \addtogroup fileio-module
+/// @{
+
+/// A read-only memory mapping of a file with reactor-friendly fault handling.
+///
+/// Plain mmap() is attractive for read-mostly index files — access is a
+/// pointer dereference — but a major page fault blocks the whole reactor
+/// thread for the duration of the disk read. mapped_file keeps the pointer
+/// access model while routing the faults off the reactor: \ref touch()
+/// faults a range in on the syscall thread pool, and \ref lock() pins it
+/// with mlock() so later dereferences cannot fault at all.
+///
+/// Dereferencing goes through \ref get(), which verifies the requested
+/// range was previously touched or locked and throws instead of risking
+/// a synchronous fault on the reactor. Touched (but unlocked) pages can
+/// still be reclaimed under memory pressure, so the guard is advisory
+/// for them; lock() gives a hard guarantee.
+class mapped_file {
+    mmap_area _area = { nullptr, mmap_deleter{0} };
+    uint64_t _size = 0;
+    // Ranges already faulted in via touch() or lock(), merged and sorted.
+    std::vector<file_range> _resident;
+private:
+    void add_resident(uint64_t offset, uint64_t length);
+public:
+    mapped_file() noexcept = default;
+    mapped_file(mapped_file&&) noexcept = default;
+    mapped_file& operator=(mapped_file&&) noexcept = default;
+
+    /// Maps the file \c name read-only in its entirety.
+    ///
+    /// The open, fstat and mmap run on the syscall thread pool; no page
+    /// is faulted in yet.
+    static future<mapped_file> map(sstring name) noexcept;
+
+    /// Size of the mapped file, in bytes.
+    uint64_t size() const noexcept {
+        return _size;
+    }
+
+    /// Returns a pointer to \c length bytes of file data starting at
+    /// \c offset.
+    ///
+    /// Throws std::out_of_range if the range extends past the end of the
+    /// file and std::runtime_error if it was not previously faulted in
+    /// with \ref touch() or \ref lock().
+    const char* get(uint64_t offset, uint64_t length) const;
+
+    /// Faults the pages covering [offset, offset + length) in by reading
+    /// them on the syscall thread pool, so the reactor never blocks on
+    /// the disk. The range becomes accessible through \ref get().
+    future<> touch(uint64_t offset, uint64_t length) noexcept;
+
+    /// Faults the pages covering [offset, offset + length) in and pins
+    /// them with mlock(), guaranteeing fault-free access until
+    /// \ref unlock() or destruction. Runs on the syscall thread pool.
+    future<> lock(uint64_t offset, uint64_t length) noexcept;
+
+    /// Releases the mlock() taken by \ref lock(). The pages stay
+    /// resident and accessible, but may now be reclaimed.
+    future<> unlock(uint64_t offset, uint64_t length) noexcept;
+};
+
+/// @}
+
+}
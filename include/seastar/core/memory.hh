@@ -23,6 +23,8 @@
 
 #include <seastar/core/resource.hh>
 #include <seastar/core/bitops.hh>
+#include <seastar/core/scheduling.hh>
+#include <array>
 #include <new>
 #include <cstdint>
 #include <functional>
@@ -185,6 +187,14 @@ enum class reclaimer_scope {
     sync
 };
 
+// Determines the order in which reclaimers are drained under memory
+// pressure. Reclaimers in a higher tier hold colder, cheaper-to-restore
+// data and are exhausted before any reclaimer in a lower tier is invoked,
+// so a hot cache is only touched once nothing colder is left to evict.
+// Reclaimers sharing a tier are invoked round-robin, like before tiers
+// existed.
+using reclaimer_tier = unsigned;
+
 class reclaimer {
 public:
     struct request {
@@ -197,14 +207,27 @@ public:
 private:
     std::function<reclaiming_result (request)> _reclaim;
     reclaimer_scope _scope;
+    reclaimer_tier _tier;
+    std::optional<scheduling_group> _owner;
 public:
     // Installs new reclaimer which will be invoked when system is falling
     // low on memory. 'scope' determines when reclaimer can be executed.
-    reclaimer(std::function<reclaiming_result ()> reclaim, reclaimer_scope scope = reclaimer_scope::async);
-    reclaimer(std::function<reclaiming_result (request)> reclaim, reclaimer_scope scope = reclaimer_scope::async);
+    // 'tier' determines where the reclaimer stands in the eviction order:
+    // higher tiers are fully drained before lower tiers are asked to
+    // release anything.
+    // 'owner' attributes the reclaimer to a scheduling group: when that
+    // group exceeds its memory soft limit (see
+    // set_scheduling_group_memory_soft_limit()) its own reclaimers are
+    // invoked before anything else. Ownerless reclaimers belong to no
+    // group and only serve global memory pressure and soft-limit
+    // fallback.
+    reclaimer(std::function<reclaiming_result ()> reclaim, reclaimer_scope scope = reclaimer_scope::async, reclaimer_tier tier = 0, std::optional<scheduling_group> owner = std::nullopt);
+    reclaimer(std::function<reclaiming_result (request)> reclaim, reclaimer_scope scope = reclaimer_scope::async, reclaimer_tier tier = 0, std::optional<scheduling_group> owner = std::nullopt);
     ~reclaimer();
     reclaiming_result do_reclaim(size_t bytes_to_reclaim) { return _reclaim(request{bytes_to_reclaim}); }
     reclaimer_scope scope() const { return _scope; }
+    reclaimer_tier tier() const { return _tier; }
+    const std::optional<scheduling_group>& owner() const { return _owner; }
 };
 
 extern std::pmr::polymorphic_allocator<char>* malloc_allocator;
@@ -312,6 +335,42 @@ public:
     friend statistics stats();
 };
 
+/// Fragmentation diagnostics for a single small-object pool on this lcore.
+///
+/// \see pool_diagnostics()
+struct pool_diagnostics_entry {
+    /// Size, in bytes, of the objects served by this pool.
+    size_t object_size;
+    /// Number of objects currently allocated from this pool.
+    uint64_t live_objects;
+    /// Number of free objects held by the pool, in its own freelist or
+    /// attached to its spans.
+    uint64_t free_objects;
+    /// Total memory, in bytes, of the pages owned by this pool.
+    size_t memory;
+    /// Histogram of span occupancy: `span_occupancy[i]` counts the pool's
+    /// spans whose fraction of allocated objects falls in the bucket
+    /// `[i/8, (i+1)/8)` (the last bucket also includes fully-used spans).
+    /// Many spans in the low buckets indicate fragmentation: the memory
+    /// is mostly free, but cannot be returned to the page allocator
+    /// because a few live objects pin each span.
+    std::array<uint64_t, 8> span_occupancy;
+};
+
+/// Capture per-pool fragmentation diagnostics for the small-object pools
+/// on this lcore. Pools too small to be usable are skipped. Supported only
+/// when the seastar allocator is enabled; returns an empty vector otherwise.
+std::vector<pool_diagnostics_entry> pool_diagnostics();
+
+/// Release free memory held by the small-object pools back to the page
+/// allocator. Each pool's freelist is returned to the spans the objects
+/// came from, and spans with no remaining live objects are freed. Intended
+/// to be called when the shard is idle; subsequent small allocations will
+/// be somewhat slower while the pools repopulate their freelists.
+///
+/// \return the number of bytes released.
+size_t trim();
+
 struct memory_layout {
     uintptr_t start;
     uintptr_t end;
@@ -331,6 +390,30 @@ size_t min_free_memory();
 /// Sets the value of free memory low water mark in memory::page_size units.
 void set_min_free_pages(size_t pages);
 
+/// Returns the bytes of live memory attributed to the given scheduling
+/// group on this shard.
+///
+/// An allocation is charged to the group that is current when it is made
+/// and the charge is released by whichever group performs the free, so
+/// for objects that routinely change hands between groups the attribution
+/// is approximate (and can even go negative for a group that mostly frees
+/// other groups' memory). Memory allocated outside any reactor thread is
+/// not attributed at all.
+int64_t scheduling_group_live_memory(scheduling_group sg);
+
+/// Sets a per-shard soft limit, in bytes, on the memory attributed to the
+/// given scheduling group.
+///
+/// When the group's attributed bytes exceed the limit, the reclaimers
+/// owned by that group (see \ref reclaimer) are asked to release the
+/// excess, falling back to ownerless reclaimers if the group's own are
+/// exhausted; reclaimers owned by other groups are never invoked on this
+/// path. The limit is soft: allocations over it still succeed, it only
+/// directs which caches are shrunk first.
+///
+/// \param limit the new limit, 0 (the default) disables the limit.
+void set_scheduling_group_memory_soft_limit(scheduling_group sg, size_t limit);
+
 /// Enable the large allocation warning threshold.
 ///
 /// Warn when allocation above a given threshold are performed.
@@ -396,6 +479,41 @@ public:
 /// [example flame graph](https://user-images.githubusercontent.com/1389273/72920437-f0cf8a80-3d51-11ea-92f0-f3dbeb698871.png)).
 void set_heap_profiling_enabled(bool);
 
+/// Enable sampled heap profiling.
+///
+/// Like \ref set_heap_profiling_enabled(), but only every \c rate-th
+/// allocation (randomized around the rate to avoid aliasing with
+/// periodic allocation patterns) records its call chain into the
+/// shard's allocation site table. Frees of sampled objects are
+/// tracked exactly, so the table holds a statistical profile of the
+/// shard's live memory by allocation site. Rates of a few thousand
+/// keep the overhead well below 1%, making the profiler suitable for
+/// always-on production use; slow leaks then show up as sites whose
+/// sampled live size only grows.
+///
+/// A rate of 1 records every allocation (equivalent to
+/// \ref set_heap_profiling_enabled(true)), 0 disables profiling.
+/// Requires `SEASTAR_HEAPPROF`, like the unsampled profiler.
+void set_heap_profiling_sampling_rate(unsigned rate);
+
+/// Returns the current sampling rate, 0 if profiling is disabled.
+unsigned get_heap_profiling_sampling_rate();
+
+/// One entry of the sampled memory profile, see
+/// \ref sampled_memory_profile().
+struct allocation_site_info {
+    size_t count;          ///< estimated live objects allocated at the site
+    size_t size;           ///< estimated live bytes allocated at the site
+    std::string backtrace; ///< the allocation site's call chain
+};
+
+/// Returns the shard's top allocation sites by sampled live size, at
+/// most \c max_sites entries. The counters are scaled by the sampling
+/// rate, so they estimate the real live object counts and sizes. The
+/// result is suitable for exposure through an application's monitoring
+/// or HTTP endpoint.
+std::vector<allocation_site_info> sampled_memory_profile(size_t max_sites = 64);
+
 /// Enable heap profiling for the duration of the scope.
 ///
 /// For more information about heap profiling see
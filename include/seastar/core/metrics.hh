@@ -110,6 +110,20 @@ using metric_name_type = sstring; /*!<  The metric name'*/
 using instance_id_type = sstring; /*!<  typically used for the shard id*/
 using skip_when_empty = bool_class<class skip_when_empty_tag>;
 
+/*!
+ * \brief How samples are combined when a family is aggregated over labels
+ *
+ * Used with \ref metric_definition_impl::aggregate(). sum is the right
+ * choice for counters; min/max suit gauges tracking watermarks.
+ * Histograms and summaries are always merged bucket-wise regardless of
+ * the mode.
+ */
+enum class aggregate_mode {
+    sum,
+    min,
+    max,
+};
+
 /*!
  * \brief Human-readable description of a metric/group.
  *
@@ -375,11 +389,12 @@ struct metric_definition_impl {
     bool enabled = true;
     skip_when_empty _skip_when_empty = skip_when_empty::no;
     std::vector<std::string> aggregate_labels;
+    aggregate_mode _aggregate_mode = aggregate_mode::sum;
     std::map<sstring, sstring> labels;
     metric_definition_impl& operator ()(bool enabled);
     metric_definition_impl& operator ()(const label_instance& label);
     metric_definition_impl& operator ()(skip_when_empty skip) noexcept;
-    metric_definition_impl& aggregate(const std::vector<label>& labels) noexcept;
+    metric_definition_impl& aggregate(const std::vector<label>& labels, aggregate_mode mode = aggregate_mode::sum) noexcept;
     metric_definition_impl& set_skip_when_empty(bool skip=true) noexcept;
     metric_definition_impl& set_type(const sstring& type_name);
     metric_definition_impl(
@@ -37,7 +37,94 @@ namespace seastar {
 namespace metrics {
 namespace impl {
 
-using labels_type = std::map<sstring, sstring>;
+/*!
+ * \brief refcounted immutable string, hash-consed in a per-shard pool
+ *
+ * Label keys and values repeat across metric series (every series
+ * carries the same shard id, endpoint name etc.), so storing them as
+ * plain strings duplicates the same bytes once per series. Interning
+ * collapses each distinct string to one shared allocation per shard,
+ * and makes equality a pointer compare.
+ *
+ * Instances may be read from other shards (the scraping shard walks
+ * all shards' metadata in place), but must only be copied or destroyed
+ * on the owning shard -- the same rule as any lw_shared_ptr.
+ */
+class interned_string {
+    lw_shared_ptr<const sstring> _s;
+    static lw_shared_ptr<const sstring> intern(sstring s);
+public:
+    interned_string() : interned_string(sstring()) {}
+    interned_string(sstring s) : _s(intern(std::move(s))) {}
+    interned_string(const char* s) : interned_string(sstring(s)) {}
+
+    const sstring& str() const noexcept {
+        return *_s;
+    }
+    operator const sstring&() const noexcept {
+        return *_s;
+    }
+    operator std::string_view() const noexcept {
+        return std::string_view(*_s);
+    }
+    const char* c_str() const noexcept {
+        return _s->c_str();
+    }
+    auto begin() const noexcept {
+        return _s->begin();
+    }
+    auto end() const noexcept {
+        return _s->end();
+    }
+    size_t size() const noexcept {
+        return _s->size();
+    }
+    bool empty() const noexcept {
+        return _s->empty();
+    }
+    // Hash-consing guarantees one allocation per distinct content, so
+    // comparing the pointers compares the strings.
+    bool operator==(const interned_string& o) const noexcept {
+        return _s.get() == o._s.get();
+    }
+    bool operator!=(const interned_string& o) const noexcept {
+        return !(*this == o);
+    }
+    bool operator<(const interned_string& o) const noexcept {
+        return *this != o && str() < o.str();
+    }
+    size_t hash() const noexcept {
+        return std::hash<const sstring*>()(_s.get());
+    }
+};
+
+inline std::ostream& operator<<(std::ostream& os, const interned_string& s) {
+    return os << s.str();
+}
+
+// Transparent, so lookups by plain strings do not intern (important
+// when inspecting another shard's labels, where interning would touch
+// a foreign pool).
+struct interned_string_compare {
+    using is_transparent = void;
+    bool operator()(const interned_string& a, const interned_string& b) const noexcept {
+        return a < b;
+    }
+    bool operator()(const interned_string& a, const sstring& b) const noexcept {
+        return a.str() < b;
+    }
+    bool operator()(const sstring& a, const interned_string& b) const noexcept {
+        return a < b.str();
+    }
+    bool operator()(const interned_string& a, const char* b) const noexcept {
+        return std::string_view(a.str()) < b;
+    }
+    bool operator()(const char* a, const interned_string& b) const noexcept {
+        return a < std::string_view(b.str());
+    }
+};
+
+using labels_type = std::map<interned_string, interned_string, interned_string_compare>;
 
 int default_handle();
 
@@ -51,6 +138,22 @@ template<>
 struct hash<seastar::metrics::impl::labels_type> {
     using argument_type = seastar::metrics::impl::labels_type;
     using result_type = ::std::size_t;
+    result_type operator()(argument_type const& s) const {
+        result_type h = 0;
+        for (auto&& i : s) {
+            // interned strings hash by identity
+            boost::hash_combine(h, i.second.hash());
+        }
+        return h;
+    }
+};
+
+// For plain label maps, e.g. de-interned copies of another shard's
+// labels (see prometheus.cc)
+template<>
+struct hash<std::map<seastar::sstring, seastar::sstring>> {
+    using argument_type = std::map<seastar::sstring, seastar::sstring>;
+    using result_type = ::std::size_t;
     result_type operator()(argument_type const& s) const {
         result_type h = 0;
         for (auto&& i : s) {
@@ -177,6 +280,7 @@ struct metric_family_info {
     description d;
     sstring name;
     std::vector<std::string> aggregate_labels;
+    metrics::aggregate_mode aggregate_mode = metrics::aggregate_mode::sum;
 };
 
 
@@ -374,7 +478,7 @@ public:
         return _value_map;
     }
 
-    void add_registration(const metric_id& id, const metric_type& type, metric_function f, const description& d, bool enabled, skip_when_empty skip, const std::vector<std::string>& aggregate_labels, int handle = default_handle());
+    void add_registration(const metric_id& id, const metric_type& type, metric_function f, const description& d, bool enabled, skip_when_empty skip, const std::vector<std::string>& aggregate_labels, aggregate_mode mode, int handle = default_handle());
     void remove_registration(const metric_id& id);
     future<> stop() {
         return make_ready_future<>();
@@ -443,6 +547,16 @@ using values_reference = shared_ptr<values_copy>;
 
 foreign_ptr<values_reference> get_values(int handle = default_handle());
 
+/*!
+ * \brief get a snapshot of the current metric values, sampling only matching families
+ *
+ * Families for which \c filter returns false (by family name) are not sampled:
+ * their value callbacks are never invoked and their entry in the returned
+ * values is left empty, with the metadata intact. This lets scrapers that
+ * request a subset of the families avoid paying for the rest.
+ */
+foreign_ptr<values_reference> get_values(const std::function<bool(const sstring&)>& filter, int handle = default_handle());
+
 shared_ptr<impl> get_local_impl(int handle = default_handle());
 
 
@@ -0,0 +1,199 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB
+ */
+
+#pragma once
+
+#include <seastar/core/future.hh>
+#include <seastar/core/idle_cpu_handler.hh>
+#include <seastar/core/loop.hh>
+#include <seastar/core/smp.hh>
+#include <seastar/util/later.hh>
+#include <cassert>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace seastar {
+
+/// \addtogroup memory-module
+/// @{
+
+/// A per-shard pool of `T` objects which recycles their storage.
+///
+/// Connection objects, parser states and request contexts are
+/// allocated and freed once per request; at steady state the
+/// allocator round trip is pure overhead. An object_pool keeps the
+/// storage of returned objects on a free list, so after a brief
+/// ramp-up \ref get() costs a placement-new and releasing the object
+/// costs a destructor call - no allocation on either side. Unlike an
+/// ad-hoc freelist the pooled object is constructed afresh on every
+/// \ref get(), with whatever constructor arguments the call site
+/// supplies, so no stale state leaks between uses.
+///
+/// The free list is bounded: at most \c max_free object storages are
+/// retained, and returns beyond that free the memory normally.
+/// Storage can be pre-allocated ahead of traffic with \ref warm_up()
+/// (asynchronously, in the background) or \ref warm_up_some() (from
+/// an idle CPU handler), and shards with unequal load can move spare
+/// storage between their pools with \ref rebalance_to().
+///
+/// The pool and its handles are owned by a single shard: \ref get()
+/// must be called, and the returned handles destroyed, on the shard
+/// which created the pool. The pool must outlive its handles.
+template <typename T>
+class object_pool {
+    // Free storage forms an intrusive list through the slots
+    // themselves, so the pool needs no bookkeeping allocations.
+    union slot {
+        slot* next;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+public:
+    /// Destroys the pooled object and recycles its storage.
+    class deleter {
+        object_pool* _pool = nullptr;
+    public:
+        deleter() = default;
+        explicit deleter(object_pool* pool) noexcept : _pool(pool) {}
+        void operator()(T* obj) noexcept {
+            obj->~T();
+            _pool->put(reinterpret_cast<slot*>(obj));
+        }
+    };
+
+    /// An owning handle to a pooled object. Destroying it returns the
+    /// object's storage to the pool.
+    using ptr = std::unique_ptr<T, deleter>;
+
+private:
+    slot* _free = nullptr;
+    size_t _free_count = 0;
+    size_t _max_free;
+    shard_id _owner_shard;
+
+public:
+    /// Creates a pool retaining at most \c max_free free object
+    /// storages.
+    explicit object_pool(size_t max_free) noexcept
+        : _max_free(max_free)
+        , _owner_shard(this_shard_id()) {
+    }
+    object_pool(const object_pool&) = delete;
+    object_pool& operator=(const object_pool&) = delete;
+    ~object_pool() {
+        while (_free) {
+            ::operator delete(std::exchange(_free, _free->next));
+        }
+    }
+
+    /// Constructs a `T` from \c args in recycled storage, allocating
+    /// only when the free list is empty.
+    template <typename... Args>
+    ptr get(Args&&... args) {
+        slot* s;
+        if (_free) {
+            s = std::exchange(_free, _free->next);
+            --_free_count;
+        } else {
+            s = static_cast<slot*>(::operator new(sizeof(slot)));
+        }
+        try {
+            return ptr(new (s->storage) T(std::forward<Args>(args)...), deleter(this));
+        } catch (...) {
+            put(s);
+            throw;
+        }
+    }
+
+    /// The number of free object storages currently cached.
+    size_t free_objects() const noexcept {
+        return _free_count;
+    }
+
+    /// Grows the free list to \c goal storages (capped by the pool's
+    /// bound), yielding to the reactor between allocations. Run it in
+    /// the background before traffic arrives.
+    future<> warm_up(size_t goal) {
+        goal = std::min(goal, _max_free);
+        return do_until([this, goal] { return _free_count >= goal; }, [this] {
+            put(static_cast<slot*>(::operator new(sizeof(slot))));
+            return maybe_yield();
+        });
+    }
+
+    /// The \ref warm_up() flavor for an idle CPU handler (\ref
+    /// set_idle_cpu_handler()): grows the free list towards \c goal
+    /// until done or \c poll reports that real work arrived.
+    idle_cpu_handler_result warm_up_some(work_waiting_on_reactor poll, size_t goal) {
+        goal = std::min(goal, _max_free);
+        while (_free_count < goal) {
+            put(static_cast<slot*>(::operator new(sizeof(slot))));
+            if (poll()) {
+                return idle_cpu_handler_result::interrupted_by_higher_priority_task;
+            }
+        }
+        return idle_cpu_handler_result::no_more_work;
+    }
+
+    /// Moves up to \c n free object storages from this pool into \c
+    /// peer, which belongs to another shard. Must run on this pool's
+    /// shard; resolves with the number of storages moved. Storage
+    /// adopted beyond the peer's bound is freed (a cross-shard free,
+    /// which the allocator handles).
+    future<size_t> rebalance_to(object_pool& peer, size_t n) {
+        assert(this_shard_id() == _owner_shard);
+        slot* chain = nullptr;
+        size_t moved = 0;
+        while (moved < n && _free) {
+            auto s = std::exchange(_free, _free->next);
+            --_free_count;
+            s->next = std::exchange(chain, s);
+            ++moved;
+        }
+        if (!moved) {
+            return make_ready_future<size_t>(0);
+        }
+        return smp::submit_to(peer._owner_shard, [&peer, chain] {
+            peer.adopt(chain);
+        }).then([moved] {
+            return moved;
+        });
+    }
+
+private:
+    void put(slot* s) noexcept {
+        if (_free_count < _max_free) {
+            s->next = std::exchange(_free, s);
+            ++_free_count;
+        } else {
+            ::operator delete(s);
+        }
+    }
+    void adopt(slot* chain) noexcept {
+        while (chain) {
+            put(std::exchange(chain, chain->next));
+        }
+    }
+};
+
+/// @}
+
+}
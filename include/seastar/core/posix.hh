@@ -250,6 +250,14 @@ public:
         throw_system_error_on(r == -1, "recvmsg");
         return { size_t(r) };
     }
+    std::optional<size_t> recvmmsg(mmsghdr* mh, unsigned vlen, int flags) {
+        auto r = ::recvmmsg(_fd, mh, vlen, flags, nullptr);
+        if (r == -1 && errno == EAGAIN) {
+            return {};
+        }
+        throw_system_error_on(r == -1, "recvmmsg");
+        return { size_t(r) };
+    }
     std::optional<size_t> send(const void* buffer, size_t len, int flags) {
         auto r = ::send(_fd, buffer, len, flags);
         if (r == -1 && errno == EAGAIN) {
@@ -23,6 +23,7 @@
 
 #include <seastar/core/circular_buffer.hh>
 #include <seastar/core/future.hh>
+#include <seastar/core/waiter_registry.hh>
 #include <queue>
 #include <seastar/util/std-compat.hh>
 
@@ -43,9 +44,17 @@ class queue {
     std::optional<promise<>> _not_empty;
     std::optional<promise<>> _not_full;
     std::exception_ptr _ex = nullptr;
+    // Set by track_waiters(); null (and costless) otherwise.
+    lw_shared_ptr<internal::waiter_tracker> _tracker;
 private:
     void notify_not_empty() noexcept;
     void notify_not_full() noexcept;
+    future<> maybe_track(future<> f) noexcept {
+        if (_tracker) {
+            return internal::track_wait(_tracker, std::move(f));
+        }
+        return f;
+    }
 public:
     explicit queue(size_t size);
 
@@ -87,6 +96,14 @@ public:
     /// A producer-side operation. Cannot be called concurrently with other producer-side operations.
     future<> not_full() noexcept;
 
+    /// Registers this queue in the shard's waiter registry under \c name,
+    /// so \ref dump_waiter_registry() reports fibers blocked waiting for
+    /// the queue to become non-empty or non-full, and how long the oldest
+    /// has been waiting.
+    void track_waiters(sstring name) {
+        _tracker = make_lw_shared<internal::waiter_tracker>("queue", std::move(name));
+    }
+
     /// Pops element now or when there is some. Returns a future that becomes
     /// available when some element is available.
     /// If the queue is, or already was, abort()ed, the future resolves with
@@ -309,7 +326,7 @@ future<> queue<T>::not_empty() noexcept {
         return make_ready_future<>();
     } else {
         _not_empty = promise<>();
-        return _not_empty->get_future();
+        return maybe_track(_not_empty->get_future());
     }
 }
 
@@ -324,7 +341,7 @@ future<> queue<T>::not_full() noexcept {
         return make_ready_future<>();
     } else {
         _not_full = promise<>();
-        return _not_full->get_future();
+        return maybe_track(_not_full->get_future());
     }
 }
 
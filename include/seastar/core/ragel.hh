@@ -27,6 +27,7 @@
 #include <algorithm>
 #include <memory>
 #include <cassert>
+#include <string_view>
 #include <seastar/util/std-compat.hh>
 #include <seastar/core/future.hh>
 
@@ -59,6 +60,12 @@ public:
         _value = {};
         _start = nullptr;
     }
+    // True when nothing was collected from previous segments, i.e. the
+    // string under construction lies entirely within the current segment
+    // and can be borrowed with guard::borrow() instead of copied.
+    bool contiguous() const {
+        return _value.empty();
+    }
     friend class guard;
 };
 
@@ -80,6 +87,15 @@ public:
     void mark_start(const char* p) {
         _builder._start = p;
     }
+    // Alternative to mark_end() + get(): returns the string built so far
+    // as a view into the current segment, without copying. Only valid
+    // when the builder is contiguous(), and only for as long as the
+    // caller keeps the underlying buffer alive.
+    std::string_view borrow(const char* p) {
+        auto view = std::string_view(_builder._start, p - _builder._start);
+        _builder._start = nullptr;
+        return view;
+    }
     void mark_end(const char* p) {
         if (_builder._value.empty()) {
             // avoid an allocation in the common case
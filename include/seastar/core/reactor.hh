@@ -31,6 +31,9 @@
 #include <seastar/core/file.hh>
 #include <seastar/core/future.hh>
 #include <seastar/core/idle_cpu_handler.hh>
+#include <seastar/core/internal/cpu_profiler.hh>
+#include <seastar/core/internal/hw_counters.hh>
+#include <seastar/core/internal/io_desc.hh>
 #include <seastar/core/internal/io_request.hh>
 #include <seastar/core/internal/io_sink.hh>
 #include <seastar/core/iostream.hh>
@@ -40,6 +43,7 @@
 #include <seastar/core/manual_clock.hh>
 #include <seastar/core/memory.hh>
 #include <seastar/core/metrics_registration.hh>
+#include <seastar/core/metrics_types.hh>
 #include <seastar/core/posix.hh>
 #include <seastar/core/reactor_config.hh>
 #include <seastar/core/scattered_message.hh>
@@ -47,6 +51,7 @@
 #include <seastar/core/scheduling_specific.hh>
 #include <seastar/core/seastar.hh>
 #include <seastar/core/semaphore.hh>
+#include <seastar/core/shared_ptr.hh>
 #include <seastar/core/smp.hh>
 #include <seastar/core/sstring.hh>
 #include <seastar/core/temporary_buffer.hh>
@@ -168,19 +173,31 @@ void increase_thrown_exceptions_counter() noexcept;
 
 }
 
-class kernel_completion;
 class io_queue;
 class io_intent;
 class disk_config_params;
 
-class io_completion : public kernel_completion {
-public:
-    virtual void complete_with(ssize_t res) final override;
-
-    virtual void complete(size_t res) noexcept = 0;
-    virtual void set_exception(std::exception_ptr eptr) noexcept = 0;
+/// An immutable, versioned snapshot of the reactor tunables that can be
+/// changed while the application runs. A snapshot is propagated to every
+/// shard by \ref update_runtime_tunables() and picked up by the reactor's
+/// periodic load timer, so a new configuration takes effect within about a
+/// second without a restart.
+struct runtime_tunables {
+    /// Monotonically growing snapshot version, assigned by
+    /// \ref update_runtime_tunables().
+    uint64_t version = 0;
+    /// \see reactor_options::task_quota_ms
+    std::chrono::duration<double, std::milli> task_quota_ms = std::chrono::duration<double, std::milli>(0.5);
+    /// \see reactor_options::task_quota_adaptive
+    bool task_quota_adaptive = false;
+    /// \see reactor_options::blocked_reactor_notify_ms
+    std::chrono::milliseconds blocked_reactor_notify_ms = std::chrono::milliseconds(25);
+    /// \see reactor_options::max_task_backlog
+    unsigned max_task_backlog = 1000;
 };
 
+future<> update_runtime_tunables(runtime_tunables cfg);
+
 class reactor {
 private:
     struct task_queue;
@@ -261,7 +278,27 @@ private:
     std::unique_ptr<reactor_backend> _backend;
 #endif
     sigset_t _active_sigmask; // holds sigmask while sleeping with sig disabled
-    std::vector<pollfn*> _pollers;
+    // A registered poller with hit-rate accounting and adaptive backoff
+    // state. A poller that keeps finding no work is checked progressively
+    // less often, up to every max_poller_backoff-th loop iteration, and is
+    // promoted back to every iteration as soon as it finds work again.
+    static constexpr unsigned max_poller_backoff = 8;
+    // Pollers disfavored by the shard's poller_profile may back off
+    // further, so their completions are reaped at batch points.
+    static constexpr unsigned max_deferred_poller_backoff = 32;
+    struct poller_entry {
+        pollfn* fn;
+        uint64_t polls = 0;
+        uint64_t work = 0;
+        unsigned backoff = 1;
+        unsigned countdown = 0;
+        unsigned max_backoff = max_poller_backoff;
+        metrics::metric_groups metric_groups;
+        explicit poller_entry(pollfn* p) : fn(p) {}
+    };
+    std::vector<poller_entry> _pollers;
+    uint64_t poller_stat(pollfn* p, uint64_t poller_entry::*stat) const;
+    unsigned poller_backoff_limit(const pollfn* p) const;
 
     static constexpr unsigned max_aio_per_queue = 128;
     static constexpr unsigned max_queues = 8;
@@ -289,6 +326,8 @@ private:
     uint64_t _global_tasks_processed = 0;
     uint64_t _polls = 0;
     std::unique_ptr<internal::cpu_stall_detector> _cpu_stall_detector;
+    internal::cpu_profiler _cpu_profiler;
+    internal::hw_counters _hw_counters;
 
     unsigned _max_task_backlog = 1000;
     timer_set<timer<>, &timer<>::_link> _timers;
@@ -314,13 +353,44 @@ private:
         sched_clock::duration _waittime = {};
         sched_clock::duration _starvetime = {};
         uint64_t _tasks_processed = 0;
+        // hardware counter consumption while this queue's tasks ran;
+        // stays zero when the counters are unavailable
+        uint64_t _instructions = 0;
+        uint64_t _cycles = 0;
+        uint64_t _llc_misses = 0;
         circular_buffer<task*> _q;
         sstring _name;
+        // CPU cap (see scheduling_group::set_cpu_cap()): the queue may run
+        // for at most _cap_quota per cap_window; zero means no cap.
+        static constexpr std::chrono::milliseconds cap_window{100};
+        sched_clock::duration _cap_quota = {};
+        sched_clock::duration _cap_consumed = {};
+        sched_clock::time_point _cap_window_start;
+        bool _throttled = false;
         int64_t to_vruntime(sched_clock::duration runtime) const;
         void set_shares(float shares) noexcept;
         struct indirect_compare;
         sched_clock::duration _time_spent_on_task_quota_violations = {};
         seastar::metrics::metric_groups _metrics;
+        // Queueing-delay (sojourn time) distribution, which is what
+        // actually predicts tail latency. Timestamping every task would be
+        // too expensive, so every sojourn_sample_interval-th enqueued task
+        // is stamped and accounted when it reaches the front of the queue;
+        // at most one sample is in flight per queue.
+        static constexpr unsigned sojourn_sample_interval = 64;
+        metrics::histogram _sojourn_hist;
+        task* _sampled_task = nullptr;
+        sched_clock::time_point _sampled_enqueued_at;
+        unsigned _sample_countdown = 0;
+        void sample_enqueue(task* t) noexcept;
+        void account_sojourn() noexcept;
+        // Load-shedding early warning (see scheduling_group::set_shed_hook()):
+        // fired from account_sojourn() when a sampled queueing delay crosses
+        // the threshold, re-armed when a sample drops back below it.
+        sched_clock::duration _shed_threshold = {};
+        noncopyable_function<void(sched_clock::duration)> _shed_hook;
+        bool _shed_triggered = false;
+        void set_shed_hook(sched_clock::duration threshold, noncopyable_function<void(sched_clock::duration)> hook) noexcept;
         void rename(sstring new_name);
     private:
         void register_stats();
@@ -331,8 +401,16 @@ private:
     int64_t _last_vruntime = 0;
     task_queue_list _active_task_queues;
     task_queue_list _activating_task_queues;
+    std::vector<task_queue*> _throttled_task_queues;
+    timer<lowres_clock> _cpu_cap_release_timer;
     task_queue* _at_destroy_tasks;
     sched_clock::duration _task_quota;
+    bool _task_quota_adaptive = false;
+    sched_clock::duration _configured_task_quota;
+    sched_clock::duration _last_task_quota_violation_time = {};
+    lw_shared_ptr<const runtime_tunables> _runtime_tunables;
+    // set from update_runtime_tunables(), applied by the load timer
+    lw_shared_ptr<const runtime_tunables> _pending_runtime_tunables;
     task* _current_task = nullptr;
     /// Handler that will be called when there is no task to execute on cpu.
     /// It represents a low priority work.
@@ -353,6 +431,10 @@ private:
     sched_clock::duration _total_sleep;
     sched_clock::time_point _start_time = now();
     std::chrono::nanoseconds _max_poll_time = calculate_poll_time();
+    // Exponentially-smoothed length of recent idle periods; used by
+    // effective_max_poll_time() to cut the pre-sleep spin short when
+    // work arrivals are sparse.
+    std::chrono::nanoseconds _smoothed_idle_gap{0};
     output_stream<char>::batch_flush_list_t _flush_batching;
     std::atomic<bool> _sleeping alignas(seastar::cache_line_size){0};
     pthread_t _thread_id alignas(seastar::cache_line_size) = pthread_self();
@@ -365,6 +447,7 @@ private:
     gate _background_gate;
 private:
     static std::chrono::nanoseconds calculate_poll_time();
+    std::chrono::nanoseconds effective_max_poll_time() const noexcept;
     static void block_notifier(int);
     bool flush_pending_aio();
     steady_clock_type::time_point next_pending_aio() const noexcept;
@@ -425,13 +508,21 @@ private:
     void run_tasks(task_queue& tq);
     bool have_more_tasks() const;
     bool posix_reuseport_detect();
+    static void attach_reuseport_steering_bpf(file_desc& fd, unsigned nr_sockets);
     void run_some_tasks();
     void activate(task_queue& tq);
     void insert_active_task_queue(task_queue* tq);
     task_queue* pop_active_task_queue(sched_clock::time_point now);
     void insert_activating_task_queues();
     void account_runtime(task_queue& tq, sched_clock::duration runtime);
+    void account_hw_counters(task_queue& tq, const internal::hw_counter_sample& begin, const internal::hw_counter_sample& end);
     void account_idle(sched_clock::duration idletime);
+    void adjust_task_quota();
+    void apply_runtime_tunables(const runtime_tunables& cfg);
+    friend future<> update_runtime_tunables(runtime_tunables cfg);
+    void throttle(task_queue& tq) noexcept;
+    void release_throttled_queues() noexcept;
+    void update_cpu_cap(task_queue& tq, float utilization) noexcept;
     void allocate_scheduling_group_specific_data(scheduling_group sg, scheduling_group_key key);
     future<> rename_scheduling_group_specific_data(scheduling_group sg);
     future<> init_scheduling_group(scheduling_group sg, sstring name, float shares);
@@ -532,6 +623,10 @@ public:
     future<fs_type> file_system_at(std::string_view pathname) noexcept;
     future<struct statvfs> statvfs(std::string_view pathname) noexcept;
     future<> remove_file(std::string_view pathname) noexcept;
+    // Unlinks a batch of non-directory entries of a directory in one
+    // syscall-thread round trip, resolving the names relative to a single
+    // directory fd instead of walking the full path per file.
+    future<> remove_files_at(std::string_view dir, std::vector<sstring> names) noexcept;
     future<> rename_file(std::string_view old_pathname, std::string_view new_pathname) noexcept;
     future<> link_file(std::string_view oldpath, std::string_view newpath) noexcept;
     future<> chmod(std::string_view name, file_permissions permissions) noexcept;
@@ -546,6 +641,13 @@ public:
     future<int> waitpid(pid_t pid);
     void kill(pid_t pid, int sig);
 
+    /// Runs a blocking or compute-heavy function on the syscall thread
+    /// pool, resolving with its return value once it completes. The
+    /// function runs on a foreign thread and must not touch reactor
+    /// state. Used to keep long-running third-party library calls
+    /// (e.g. TLS handshake crypto) from stalling the reactor.
+    future<int> run_on_syscall_thread(noncopyable_function<int ()> func) noexcept;
+
     int run() noexcept;
     void exit(int ret);
     future<> when_started() { return _start_promise.get_future(); }
@@ -651,6 +753,7 @@ private:
     friend struct pollable_fd_state_deleter;
     friend class posix_file_impl;
     friend class blockdev_file_impl;
+    friend class mapped_file;
     friend class timer<>;
     friend class timer<lowres_clock>;
     friend class timer<manual_clock>;
@@ -658,6 +761,7 @@ private:
     friend class smp_message_queue;
     friend class internal::poller;
     friend class scheduling_group;
+    friend void internal::account_inline_group_run(scheduling_group prev, scheduling_group sg, sched_clock::duration runtime) noexcept;
     friend void add_to_flush_poller(output_stream<char>& os) noexcept;
     friend void seastar::internal::increase_thrown_exceptions_counter() noexcept;
     friend void report_failed_future(const std::exception_ptr& eptr) noexcept;
@@ -705,11 +809,23 @@ public:
     void set_bypass_fsync(bool value);
     void update_blocked_reactor_notify_ms(std::chrono::milliseconds ms);
     std::chrono::milliseconds get_blocked_reactor_notify_ms() const;
+    /// The tunables snapshot currently in effect on this shard.
+    lw_shared_ptr<const runtime_tunables> get_runtime_tunables() const noexcept {
+        return _runtime_tunables;
+    }
     /// For testing, sets the stall reporting function which is called when
     /// a stall is detected (and not suppressed). Setting the function also
     /// resets the supression state.
     void set_stall_detector_report_function(std::function<void ()> report);
     std::function<void ()> get_stall_detector_report_function() const;
+    /// Reconfigures this shard's sampling CPU profiler. Changing the
+    /// capacity discards samples collected so far.
+    void set_cpu_profiler_config(internal::cpu_profiler::config cfg);
+    internal::cpu_profiler::config get_cpu_profiler_config() const;
+    /// Moves the profiler samples collected on this shard into \c out and
+    /// returns the number of samples that were overwritten before they
+    /// could be retrieved.
+    uint64_t drain_cpu_profiler_traces(std::vector<internal::cpu_profiler_trace>& out);
 };
 
 template <typename Func>
@@ -27,10 +27,23 @@
 
 namespace seastar {
 
+/// Polling priority profile of a shard.
+///
+/// Shards dedicated to network or storage work can bias the reactor's
+/// adaptive poller backoff towards their hot event sources instead of
+/// polling everything uniformly; see \ref smp_options::poller_profiles.
+enum class poller_profile {
+    balanced,
+    network,
+    storage,
+};
+
 /// \cond internal
 struct reactor_config {
     bool auto_handle_sigint_sigterm = true;
     unsigned max_networking_aio_io_control_blocks = 10000;
+    bool force_io_uring_sqpoll = false;
+    poller_profile profile = poller_profile::balanced;
 };
 /// \endcond
 
@@ -61,6 +74,13 @@ struct reactor_options : public program_options::option_group {
     ///
     /// Default: 0.5.
     program_options::value<double> task_quota_ms;
+    /// \brief Automatically adjust the task quota based on observed stalls.
+    ///
+    /// When enabled, the reactor shrinks the task quota while tasks overrun
+    /// it (improving scheduling latency) and grows it back towards the
+    /// \ref task_quota_ms value when they do not.
+    /// Default: false.
+    program_options::value<bool> task_quota_adaptive;
     /// \brief Max time (ms) IO operations must take.
     ///
     /// Default: 1.5 * task_quota_ms value
@@ -71,6 +91,25 @@ struct reactor_options : public program_options::option_group {
     /// until it goes back below the limit.
     /// Default: 1000.
     program_options::value<unsigned> max_task_backlog;
+    /// \brief Timer expiry coalescing window in microseconds.
+    ///
+    /// When non-zero, high-resolution timer expiry is delayed by up to this
+    /// long so that timers expiring close together are delivered in one
+    /// batch (a single wakeup running their callbacks back to back) instead
+    /// of one wakeup per timer. Useful for workloads arming many thousands
+    /// of near-simultaneous timers, such as connection expiry scans, at the
+    /// cost of that much timer precision.
+    /// Default: 0 (precise delivery).
+    program_options::value<unsigned> timer_coalescing_us;
+    /// When non-zero, small all-write batches are held in the I/O
+    /// submission sink for up to this many microseconds so each
+    /// io_submit()/ring doorbell carries more requests. Reads and other
+    /// latency-critical operations are never delayed; they release the
+    /// held batch immediately. Useful for write-heavy workloads issuing
+    /// tens of thousands of small submissions per second, at the cost of
+    /// that much added write latency.
+    /// Default: 0 (submit as soon as the poller runs).
+    program_options::value<unsigned> io_combine_deadline_us;
     /// \brief Threshold in milliseconds over which the reactor is considered
     /// blocked if no progress is made.
     ///
@@ -137,6 +176,14 @@ struct reactor_options : public program_options::option_group {
     ///
     /// This reduces latency. Requires Linux 4.18 or later.
     program_options::value<bool> aio_fsync;
+    /// \brief Use a kernel thread to poll the io_uring submission queue
+    /// (SQPOLL).
+    ///
+    /// Eliminates the system call on the I/O submission path at the cost of
+    /// a busy-polling kernel thread per shard. Only valid for the \p io_uring
+    /// reactor backend (see \ref reactor_backend).
+    /// Default: \p false.
+    program_options::value<bool> io_uring_sqpoll;
     /// \brief Maximum number of I/O control blocks (IOCBs) to allocate per shard.
     ///
     /// This translates to the number of sockets supported per shard. Requires
@@ -149,6 +196,14 @@ struct reactor_options : public program_options::option_group {
     ///
     /// \note Unused when seastar was compiled without heap profiling support.
     program_options::value<> heapprof;
+    /// \brief Enable sampled heap profiling, recording every Nth allocation.
+    ///
+    /// See \ref memory::set_heap_profiling_sampling_rate(). Rates of a few
+    /// thousand keep the overhead low enough for always-on production use.
+    /// Default: 0 (disabled). \ref heapprof takes precedence when set.
+    ///
+    /// \note Unused when seastar was compiled without heap profiling support.
+    program_options::value<unsigned> heapprof_sample_rate;
     /// Ignore SIGINT (for gdb).
     program_options::value<> no_handle_interrupt;
 
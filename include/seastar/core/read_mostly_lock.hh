@@ -0,0 +1,253 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB
+ */
+
+#pragma once
+
+#include <seastar/core/future.hh>
+#include <seastar/core/chunked_fifo.hh>
+#include <cassert>
+#include <optional>
+#include <utility>
+
+namespace seastar {
+
+/// \addtogroup fiber-module
+/// @{
+
+/// \brief Shared/exclusive mutual exclusion optimized for read-mostly data.
+///
+/// Like \ref shared_mutex, this class protects a resource with shared
+/// and exclusive access levels, but it is tuned for the case where
+/// nearly all acquisitions are reads and writes are rare (e.g. a
+/// configuration that is consulted per request and updated a few times
+/// per day).  The read fast path is a plain counter increment that
+/// returns a RAII guard synchronously — no future, no continuation and
+/// no allocation — and only falls back to a future when an exclusive
+/// holder or waiter is present.  Writers wait for the reader count to
+/// drain; the last departing reader wakes them directly, which is the
+/// in-shard analogue of a quiescence period (seastar shards are
+/// cooperatively scheduled, so no cross-thread synchronization is
+/// involved).
+///
+/// Use \ref with_read_lock(read_mostly_lock&, Func&&) and
+/// \ref with_write_lock(read_mostly_lock&, Func&&) for exception-safe
+/// access; on the read fast path \c with_read_lock invokes the
+/// function without allocating a future for the lock itself.
+///
+/// \see shared_mutex when reads and writes are similarly frequent
+class read_mostly_lock {
+public:
+    /// An opaque object releasing shared access when destroyed.
+    class read_guard {
+        read_mostly_lock* _lock = nullptr;
+        explicit read_guard(read_mostly_lock* lock) noexcept : _lock(lock) {}
+        friend class read_mostly_lock;
+    public:
+        read_guard() noexcept = default;
+        read_guard(read_guard&& x) noexcept : _lock(std::exchange(x._lock, nullptr)) {}
+        read_guard& operator=(read_guard&& x) noexcept {
+            if (this != &x) {
+                release();
+                _lock = std::exchange(x._lock, nullptr);
+            }
+            return *this;
+        }
+        read_guard(const read_guard&) = delete;
+        void operator=(const read_guard&) = delete;
+        ~read_guard() {
+            release();
+        }
+        /// Releases shared access early, before the guard is destroyed.
+        void release() noexcept {
+            if (_lock) {
+                _lock->read_unlock();
+                _lock = nullptr;
+            }
+        }
+    };
+private:
+    uint64_t _readers = 0;
+    bool _writer = false;
+    struct waiter {
+        waiter(promise<>&& pr, bool for_write) : pr(std::move(pr)), for_write(for_write) {}
+        promise<> pr;
+        bool for_write;
+    };
+    chunked_fifo<waiter> _waiters;
+public:
+    read_mostly_lock() = default;
+    read_mostly_lock(read_mostly_lock&&) = default;
+    read_mostly_lock& operator=(read_mostly_lock&&) = default;
+    read_mostly_lock(const read_mostly_lock&) = delete;
+    void operator=(const read_mostly_lock&) = delete;
+    /// Try to acquire shared access without waiting.
+    ///
+    /// This is the fast path: when no writer holds or awaits the lock
+    /// it bumps the reader count and returns a guard, with no future
+    /// involved.  Waiting writers block new readers, so a steady stream
+    /// of reads cannot starve an update.
+    ///
+    /// \return a \ref read_guard, or \c std::nullopt if exclusive
+    ///         access is held or waited for.
+    std::optional<read_guard> try_read_lock() noexcept {
+        if (!_writer && _waiters.empty()) {
+            ++_readers;
+            return read_guard(this);
+        }
+        return std::nullopt;
+    }
+    /// Acquire shared access, waiting if a writer holds or awaits the lock.
+    ///
+    /// \return a future resolving to a \ref read_guard; ready
+    ///         immediately on the fast path.
+    future<read_guard> read_lock() noexcept {
+        if (auto g = try_read_lock()) {
+            return make_ready_future<read_guard>(std::move(*g));
+        }
+        try {
+            _waiters.emplace_back(promise<>(), false);
+            return _waiters.back().pr.get_future().then([this] {
+                return read_guard(this);
+            });
+        } catch (...) {
+            return current_exception_as_future<read_guard>();
+        }
+    }
+    /// Acquire exclusive access.
+    ///
+    /// \return a future that becomes ready once every reader has
+    ///         departed and no other writer is active.
+    future<> write_lock() noexcept {
+        if (try_write_lock()) {
+            return make_ready_future<>();
+        }
+        try {
+            _waiters.emplace_back(promise<>(), true);
+            return _waiters.back().pr.get_future();
+        } catch (...) {
+            return current_exception_as_future();
+        }
+    }
+    /// Try to acquire exclusive access without waiting.
+    ///
+    /// \return true iff the lock was acquired.
+    bool try_write_lock() noexcept {
+        if (!_readers && !_writer) {
+            _writer = true;
+            return true;
+        }
+        return false;
+    }
+    /// Releases exclusive access after a previous call to \ref write_lock().
+    void write_unlock() noexcept {
+        assert(_writer);
+        _writer = false;
+        wake();
+    }
+private:
+    void read_unlock() noexcept {
+        assert(_readers > 0);
+        --_readers;
+        if (!_readers) {
+            wake();
+        }
+    }
+    void wake() noexcept {
+        while (!_waiters.empty()) {
+            auto& w = _waiters.front();
+            // note: _writer == false in wake()
+            if (w.for_write) {
+                if (!_readers) {
+                    _writer = true;
+                    w.pr.set_value();
+                    _waiters.pop_front();
+                }
+                break;
+            } else { // for read
+                ++_readers;
+                w.pr.set_value();
+                _waiters.pop_front();
+            }
+        }
+    }
+};
+
+/// Executes a function while holding shared access to a resource.
+///
+/// On the fast path — no writer holding or waiting — the function is
+/// invoked without any future being allocated for the lock; the guard
+/// is released when the function's resulting future resolves.
+///
+/// \param rml a \ref read_mostly_lock guarding access to the shared resource
+/// \param func callable object to invoke while the lock is held for shared access
+/// \return whatever \c func returns, as a future
+///
+/// \relates read_mostly_lock
+template <typename Func>
+SEASTAR_CONCEPT(
+    requires (std::invocable<Func> && std::is_nothrow_move_constructible_v<Func>)
+    inline
+    futurize_t<std::invoke_result_t<Func>>
+)
+SEASTAR_NO_CONCEPT(
+    inline
+    std::enable_if_t<std::is_nothrow_move_constructible_v<Func>, futurize_t<std::result_of_t<Func ()>>>
+)
+with_read_lock(read_mostly_lock& rml, Func&& func) noexcept {
+    if (auto g = rml.try_read_lock()) {
+        return futurize_invoke(std::forward<Func>(func)).finally([g = std::move(*g)] {});
+    }
+    return rml.read_lock().then([func = std::forward<Func>(func)] (read_mostly_lock::read_guard g) mutable {
+        return futurize_invoke(func).finally([g = std::move(g)] {});
+    });
+}
+
+/// Executes a function while holding exclusive access to a resource.
+///
+/// The lock is acquired once all readers have departed, and released
+/// when the function returns.
+///
+/// \param rml a \ref read_mostly_lock guarding access to the shared resource
+/// \param func callable object to invoke while the lock is held for exclusive access
+/// \return whatever \c func returns, as a future
+///
+/// \relates read_mostly_lock
+template <typename Func>
+SEASTAR_CONCEPT(
+    requires (std::invocable<Func> && std::is_nothrow_move_constructible_v<Func>)
+    inline
+    futurize_t<std::invoke_result_t<Func>>
+)
+SEASTAR_NO_CONCEPT(
+    inline
+    std::enable_if_t<std::is_nothrow_move_constructible_v<Func>, futurize_t<std::result_of_t<Func ()>>>
+)
+with_write_lock(read_mostly_lock& rml, Func&& func) noexcept {
+    return rml.write_lock().then([&rml, func = std::forward<Func>(func)] () mutable {
+        return futurize_invoke(func).finally([&rml] {
+            rml.write_unlock();
+        });
+    });
+}
+
+/// @}
+
+}
@@ -0,0 +1,73 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright 2026 ScyllaDB
+ */
+
+#pragma once
+
+#include <seastar/core/file.hh>
+
+namespace seastar {
+
+/// \addtogroup fileio-module
+/// @{
+
+/// Tunables for \ref make_readahead_file().
+struct file_readahead_options {
+    /// Size of each readahead buffer. Reads are prefetched in
+    /// buffer_size-aligned chunks; a dma_read contained in a single
+    /// chunk can be served from the cache. Must be a multiple of the
+    /// file's disk read DMA alignment.
+    uint64_t buffer_size = 128 << 10;
+    /// How many chunks to keep in flight or cached ahead of the
+    /// detected read position.
+    unsigned max_buffers = 4;
+    /// Number of consecutive sequential reads observed before
+    /// readahead starts. Purely random workloads never trigger it.
+    unsigned sequential_trigger = 2;
+};
+
+/// Wraps an open file with a per-handle readahead advisor.
+///
+/// Files opened with DMA bypass the OS page cache, so applications that
+/// cannot use \ref make_file_input_stream() — for example because they
+/// interleave random index probes with sequential range scans on the
+/// same handle — get no readahead at all and pay full device latency on
+/// every read. The returned file watches the offsets passed to its
+/// dma_read() calls; once it observes a sequential run it prefetches
+/// the next few chunks through the underlying file and serves
+/// subsequent reads from those buffers, keeping several requests in the
+/// device queue without any cooperation from the caller. A read outside
+/// the run falls through to the underlying file and resets the
+/// detector, so random accesses behave exactly as before.
+///
+/// Writes, truncate and discard invalidate the cache, but the wrapper
+/// does not observe other handles to the same file; do not use it when
+/// the file is concurrently written through a different handle.
+/// Prefetched reads are issued with the priority class of the read that
+/// triggered them and are not cancellable via \ref io_intent.
+///
+/// \param f an open file
+/// \param options readahead tunables
+/// \return a \ref file performing transparent readahead
+file make_readahead_file(file f, file_readahead_options options = {});
+
+/// @}
+
+}
@@ -27,6 +27,7 @@
 #include <seastar/core/sstring.hh>
 #include <seastar/core/function_traits.hh>
 #include <seastar/util/concepts.hh>
+#include <seastar/util/noncopyable_function.hh>
 
 /// \file
 
@@ -50,6 +51,11 @@ namespace internal {
 unsigned scheduling_group_index(scheduling_group sg) noexcept;
 scheduling_group scheduling_group_from_index(unsigned index) noexcept;
 
+// Charges an inline run in \c sg (see with_scheduling_group()) to its
+// task queue, and deducts it from \c prev, whose batch accounting in the
+// reactor would otherwise absorb the time.
+void account_inline_group_run(scheduling_group prev, scheduling_group sg, sched_clock::duration runtime) noexcept;
+
 unsigned long scheduling_group_key_id(scheduling_group_key) noexcept;
 
 template<typename T>
@@ -93,6 +99,24 @@ future<> destroy_scheduling_group(scheduling_group sg) noexcept;
 /// \return a future that is ready when the scheduling group has been renamed
 future<> rename_scheduling_group(scheduling_group sg, sstring new_name) noexcept;
 
+/// Migrates the current continuation chain to another scheduling group.
+///
+/// Unlike \ref with_scheduling_group(), which scopes a callable to a group,
+/// this re-tags the running fiber in place: every continuation chained after
+/// the returned future resolves is created in, and runs from, \c sg. It is
+/// meant for work that is classified as expensive only after it has started
+/// (e.g. a query that turns out to be heavy mid-parse), letting the scheduler
+/// isolate it retroactively instead of it finishing in the group it began in.
+///
+/// Inside a \ref seastar::thread the thread itself is re-tagged and requeued,
+/// so the call returns with the migration already done.
+///
+/// Continuations that were already created elsewhere on the chain keep the
+/// group they were created in; only what is chained after this call follows.
+///
+/// \param sg the scheduling group the rest of the chain should run in
+/// \return a future that resolves from within \c sg's task queue
+future<> migrate_to_scheduling_group(scheduling_group sg) noexcept;
 
 /**
  * Represents a configuration for a specific scheduling group value,
@@ -256,6 +280,11 @@ public:
     /// Creates a `scheduling_group` object denoting the default group
     constexpr scheduling_group() noexcept : _id(0) {} // must be constexpr for current_scheduling_group_holder
     bool active() const noexcept;
+    /// Returns true if a task tagged with this group may run right now
+    /// without being queued: either the group is already current, or it
+    /// has no queued tasks to jump ahead of, is not throttled by a cpu
+    /// cap, and the current task quota has not been exhausted.
+    bool may_run_immediately() const noexcept;
     const sstring& name() const noexcept;
     bool operator==(scheduling_group x) const noexcept { return _id == x._id; }
     bool operator!=(scheduling_group x) const noexcept { return _id != x._id; }
@@ -283,6 +312,40 @@ public:
     /// \param shares number of shares allotted to the group. Use numbers
     ///               in the 1-1000 range.
     void set_shares(float shares) noexcept;
+    /// Caps the CPU time available to the group.
+    ///
+    /// While set_shares() divides the CPU proportionally when several groups
+    /// compete, it does not stop a single group from consuming an otherwise
+    /// idle shard. The cap is absolute: the group may run for at most the
+    /// given fraction of each 100ms window even when the shard has nothing
+    /// else to do, bounding the cache and latency impact of background work
+    /// on foreground tasks that arrive later. Like set_shares(), the
+    /// adjustment is local to the shard.
+    ///
+    /// \param utilization fraction of CPU time the group may consume, in the
+    ///                    (0, 1] range. Zero (the default) removes the cap.
+    void set_cpu_cap(float utilization) noexcept;
+    /// Registers a load-shedding hook for the group on this shard.
+    ///
+    /// The scheduler periodically samples the queueing delay of the group's
+    /// tasks (the time from enqueueing a task until it starts running).
+    /// When a sampled delay crosses \p threshold the hook is invoked with
+    /// the measured delay, and not again until a later sample drops back
+    /// below the threshold. This is an early warning that the queue is
+    /// building up faster than it drains: the application can react by
+    /// shedding cheap-to-reject work while that is still enough to recover,
+    /// rather than discovering the overload from a stall report.
+    ///
+    /// The hook runs directly from the scheduler, between tasks, when the
+    /// delayed task finally reaches the front of the queue; it must not
+    /// throw and should do no more than set a flag or adjust a value that
+    /// the application consults. Like set_shares(), the setting is local
+    /// to the shard.
+    ///
+    /// \param threshold queueing delay at which the hook fires.
+    /// \param hook callback invoked with the sampled delay; a disengaged
+    ///             function removes a previously registered hook.
+    void set_shed_hook(sched_clock::duration threshold, noncopyable_function<void(sched_clock::duration)> hook) noexcept;
     friend future<scheduling_group> create_scheduling_group(sstring name, float shares) noexcept;
     friend future<> destroy_scheduling_group(scheduling_group sg) noexcept;
     friend future<> rename_scheduling_group(scheduling_group sg, sstring new_name) noexcept;
@@ -20,8 +20,10 @@
  */
 
 #include <boost/range/adaptor/filtered.hpp>
+#include <boost/range/irange.hpp>
 #include <seastar/core/scheduling.hh>
 #include <seastar/core/map_reduce.hh>
+#include <algorithm>
 #include <array>
 #include <typeindex>
 #include <vector>
@@ -35,15 +37,41 @@ namespace internal {
 struct scheduling_group_specific_thread_local_data {
     struct per_scheduling_group {
         bool queue_is_initialized = false;
-        /**
-         * This array holds pointers to the scheduling group specific
-         * data. The pointer is not use as is but is cast to a reference
-         * to the appropriate type that is actually pointed to.
-         */
-        std::vector<void*> specific_vals;
     };
     std::array<per_scheduling_group, max_scheduling_groups()> per_scheduling_group_data;
     std::vector<scheduling_group_key_config> scheduling_group_key_configs;
+    /**
+     * A flat (group × key) table of pointers to the scheduling group
+     * specific data, laid out row-per-group so that a lookup is one
+     * multiplication and one load. The pointers are not used as is but
+     * are cast to the appropriate type that is actually pointed to.
+     * Entries of uninitialized groups are null.
+     */
+    std::vector<void*> specific_vals;
+    size_t vals_stride = 0; // key slots per group row
+
+    void* get_specific_val(unsigned sg_id, unsigned long key_id) const noexcept {
+        return specific_vals[sg_id * vals_stride + key_id];
+    }
+    void*& get_specific_val(unsigned sg_id, unsigned long key_id) noexcept {
+        return specific_vals[sg_id * vals_stride + key_id];
+    }
+    // Re-lays out the table when a new key does not fit in the current
+    // stride. The values themselves are individually allocated, so only
+    // the pointers move.
+    void ensure_stride(size_t nr_keys) {
+        if (nr_keys <= vals_stride) {
+            return;
+        }
+        auto new_stride = std::max(nr_keys, vals_stride * 2);
+        std::vector<void*> new_vals(max_scheduling_groups() * new_stride);
+        for (size_t sg_id = 0; sg_id < max_scheduling_groups(); sg_id++) {
+            std::copy_n(specific_vals.begin() + sg_id * vals_stride, vals_stride,
+                    new_vals.begin() + sg_id * new_stride);
+        }
+        specific_vals = std::move(new_vals);
+        vals_stride = new_stride;
+    }
 };
 
 #ifdef SEASTAR_BUILD_SHARED_LIBS
@@ -77,9 +105,9 @@ T* scheduling_group_get_specific_ptr(scheduling_group sg, scheduling_group_key k
     assert(std::type_index(typeid(T)) == data.scheduling_group_key_configs[key.id()].type_index);
 #endif
     auto sg_id = internal::scheduling_group_index(sg);
-    if (__builtin_expect(sg_id < data.per_scheduling_group_data.size() &&
-            data.per_scheduling_group_data[sg_id].queue_is_initialized, true)) {
-        return reinterpret_cast<T*>(data.per_scheduling_group_data[sg_id].specific_vals[key.id()]);
+    if (__builtin_expect(key.id() < data.vals_stride, true)) {
+        // entries of uninitialized groups are null, no separate check needed
+        return reinterpret_cast<T*>(data.get_specific_val(sg_id, key.id()));
     }
     return nullptr;
 }
@@ -119,7 +147,7 @@ T& scheduling_group_get_specific(scheduling_group_key key) noexcept {
     auto& data = internal::get_scheduling_group_specific_thread_local_data();
     assert(std::type_index(typeid(T)) == data.scheduling_group_key_configs[key.id()].type_index);
     auto sg_id = internal::scheduling_group_index(current_scheduling_group());
-    return *reinterpret_cast<T*>(data.per_scheduling_group_data[sg_id].specific_vals[key.id()]);
+    return *reinterpret_cast<T*>(data.get_specific_val(sg_id, key.id()));
 }
 
 /**
@@ -144,17 +172,18 @@ SEASTAR_CONCEPT( requires requires(SpecificValType specific_val, Mapper mapper,
 future<typename function_traits<Reducer>::return_type>
 map_reduce_scheduling_group_specific(Mapper mapper, Reducer reducer,
         Initial initial_val, scheduling_group_key key) {
-    using per_scheduling_group = internal::scheduling_group_specific_thread_local_data::per_scheduling_group;
     auto& data = internal::get_scheduling_group_specific_thread_local_data();
-    auto wrapped_mapper = [key, mapper] (per_scheduling_group& psg) {
+    auto wrapped_mapper = [&data, key, mapper] (unsigned sg_id) {
         auto id = internal::scheduling_group_key_id(key);
         return make_ready_future<typename function_traits<Mapper>::return_type>
-            (mapper(*reinterpret_cast<SpecificValType*>(psg.specific_vals[id])));
+            (mapper(*reinterpret_cast<SpecificValType*>(data.get_specific_val(sg_id, id))));
     };
 
     return map_reduce(
-            data.per_scheduling_group_data
-            | boost::adaptors::filtered(std::mem_fn(&per_scheduling_group::queue_is_initialized)),
+            boost::irange<unsigned>(0, max_scheduling_groups())
+            | boost::adaptors::filtered([&data] (unsigned sg_id) {
+                return data.per_scheduling_group_data[sg_id].queue_is_initialized;
+            }),
             wrapped_mapper, std::move(initial_val), reducer);
 }
 
@@ -177,17 +206,18 @@ SEASTAR_CONCEPT( requires requires(SpecificValType specific_val, Reducer reducer
 })
 future<typename function_traits<Reducer>::return_type>
 reduce_scheduling_group_specific(Reducer reducer, Initial initial_val, scheduling_group_key key) {
-    using per_scheduling_group = internal::scheduling_group_specific_thread_local_data::per_scheduling_group;
     auto& data = internal::get_scheduling_group_specific_thread_local_data();
 
-    auto mapper = [key] (per_scheduling_group& psg) {
+    auto mapper = [&data, key] (unsigned sg_id) {
         auto id = internal::scheduling_group_key_id(key);
-        return make_ready_future<SpecificValType>(*reinterpret_cast<SpecificValType*>(psg.specific_vals[id]));
+        return make_ready_future<SpecificValType>(*reinterpret_cast<SpecificValType*>(data.get_specific_val(sg_id, id)));
     };
 
     return map_reduce(
-            data.per_scheduling_group_data
-            | boost::adaptors::filtered(std::mem_fn(&per_scheduling_group::queue_is_initialized)),
+            boost::irange<unsigned>(0, max_scheduling_groups())
+            | boost::adaptors::filtered([&data] (unsigned sg_id) {
+                return data.per_scheduling_group_data[sg_id].queue_is_initialized;
+            }),
             mapper, std::move(initial_val), reducer);
 }
 
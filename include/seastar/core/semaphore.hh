@@ -23,10 +23,13 @@
 
 #include <seastar/core/future.hh>
 #include <seastar/core/chunked_fifo.hh>
+#include <seastar/core/shared_ptr.hh>
 #include <seastar/core/timer.hh>
 #include <seastar/core/abortable_fifo.hh>
 #include <seastar/core/timed_out_error.hh>
 #include <seastar/core/abort_on_expiry.hh>
+#include <seastar/core/waiter_registry.hh>
+#include <seastar/util/later.hh>
 #include <cassert>
 #include <exception>
 #include <optional>
@@ -187,6 +190,18 @@ private:
         }
     };
     internal::abortable_fifo<entry, expiry_handler> _wait_list;
+    // signal() does not service the wait list inline; the first signal
+    // that makes the front waiter satisfiable schedules one drain task
+    // which wakes every waiter the accumulated units can satisfy, so a
+    // burst of signals pays for a single list walk. _backref (allocated
+    // lazily, on the first deferred wakeup) points back at the semaphore
+    // and is the only state the drain task captures: moving the
+    // semaphore re-homes the task by updating the pointer, and
+    // destruction cancels it by clearing the pointer.
+    bool _wakeup_scheduled = false;
+    lw_shared_ptr<basic_semaphore*> _backref;
+    // Set by track_waiters(); null (and costless) otherwise.
+    lw_shared_ptr<internal::waiter_tracker> _tracker;
 
 #ifdef SEASTAR_SEMAPHORE_DEBUG
     struct used_flag {
@@ -216,12 +231,44 @@ private:
 
     [[no_unique_address]] used_flag _used;
 
+    future<> maybe_track(future<> f) noexcept {
+        if (_tracker) {
+            return internal::track_wait(_tracker, std::move(f));
+        }
+        return f;
+    }
     bool has_available_units(size_t nr) const noexcept {
         return _count >= 0 && (static_cast<size_t>(_count) >= nr);
     }
     bool may_proceed(size_t nr) const noexcept {
         return has_available_units(nr) && _wait_list.empty();
     }
+    void wake_waiters() noexcept {
+        while (!_wait_list.empty() && has_available_units(_wait_list.front().nr)) {
+            auto& x = _wait_list.front();
+            _count -= x.nr;
+            x.pr.set_value();
+            _wait_list.pop_front();
+        }
+    }
+    void schedule_wakeup() noexcept {
+        try {
+            if (!_backref) {
+                _backref = make_lw_shared<basic_semaphore*>(this);
+            }
+        } catch (...) {
+            // cannot defer without the back-reference; wake inline
+            wake_waiters();
+            return;
+        }
+        _wakeup_scheduled = true;
+        (void)yield().then([backref = _backref] {
+            if (auto* sem = *backref) {
+                sem->_wakeup_scheduled = false;
+                sem->wake_waiters();
+            }
+        });
+    }
 public:
     /// Returns the maximum number of units the semaphore counter can hold
     static constexpr size_t max_counter() noexcept {
@@ -245,6 +292,56 @@ public:
     {
         static_assert(std::is_nothrow_move_constructible_v<expiry_handler>);
     }
+    basic_semaphore(basic_semaphore&& other) noexcept(std::is_nothrow_move_constructible_v<exception_factory>)
+        : exception_factory(static_cast<exception_factory&&>(other))
+        , _count(other._count)
+        , _ex(std::move(other._ex))
+        , _wait_list(std::move(other._wait_list))
+        , _wakeup_scheduled(std::exchange(other._wakeup_scheduled, false))
+        , _backref(std::move(other._backref))
+        , _tracker(std::move(other._tracker))
+        , _used(std::move(other._used))
+    {
+        if (_backref) {
+            // re-home the pending drain task to the new address
+            *_backref = this;
+        }
+    }
+    basic_semaphore& operator=(basic_semaphore&& other) noexcept(std::is_nothrow_move_assignable_v<exception_factory>) {
+        if (this != &other) {
+            if (_wakeup_scheduled) {
+                // honor signals that were delivered before the overwrite
+                wake_waiters();
+            }
+            if (_backref) {
+                // detach any drain task still pointing at us
+                *_backref = nullptr;
+            }
+            exception_factory::operator=(static_cast<exception_factory&&>(other));
+            _count = other._count;
+            _ex = std::move(other._ex);
+            _wait_list = std::move(other._wait_list);
+            _wakeup_scheduled = std::exchange(other._wakeup_scheduled, false);
+            _backref = std::move(other._backref);
+            _tracker = std::move(other._tracker);
+            _used = std::move(other._used);
+            if (_backref) {
+                *_backref = this;
+            }
+        }
+        return *this;
+    }
+    ~basic_semaphore() {
+        if (_wakeup_scheduled) {
+            // honor signals that were delivered before destruction;
+            // the waiters' futures resolve even though the semaphore
+            // is going away.
+            wake_waiters();
+        }
+        if (_backref) {
+            *_backref = nullptr;
+        }
+    }
     /// Waits until at least a specific number of units are available in the
     /// counter, and reduces the counter by that amount of units.
     ///
@@ -288,7 +385,7 @@ public:
                 abort_source& as = e.timer->abort_source();
                 _wait_list.make_back_abortable(as);
             }
-            return f;
+            return maybe_track(std::move(f));
         } catch (...) {
             return make_exception_future(std::current_exception());
         }
@@ -321,7 +418,7 @@ public:
             // taking future here since make_back_abortable may expire the entry
             auto f = e.pr.get_future();
             _wait_list.make_back_abortable(as);
-            return f;
+            return maybe_track(std::move(f));
         } catch (...) {
             return make_exception_future(std::current_exception());
         }
@@ -351,18 +448,22 @@ public:
     /// ready, and the value of the counter is reduced according to
     /// the amount requested.
     ///
+    /// With no waiters present this is a pure counter increment.
+    /// Waiters are not serviced inline: the first signal that makes
+    /// the front waiter satisfiable schedules a single drain task, so
+    /// a burst of signals in one reactor iteration wakes all the
+    /// waiters it covers in one pass over the wait list.
+    ///
     /// \param nr Number of units to deposit (default 1).
     void signal(size_t nr = 1) noexcept {
         if (_ex) {
             return;
         }
         _count += nr;
-        while (!_wait_list.empty() && has_available_units(_wait_list.front().nr)) {
-            auto& x = _wait_list.front();
-            _count -= x.nr;
-            x.pr.set_value();
-            _wait_list.pop_front();
+        if (_wait_list.empty() || _wakeup_scheduled || !has_available_units(_wait_list.front().nr)) {
+            return;
         }
+        schedule_wakeup();
     }
 
     /// Consume the specific number of units without blocking
@@ -413,6 +514,14 @@ public:
     /// Returns the current number of waiters
     size_t waiters() const noexcept { return _wait_list.size(); }
 
+    /// Registers this semaphore in the shard's waiter registry under
+    /// \c name, so \ref dump_waiter_registry() reports its waiter count
+    /// and oldest-waiter age. Untracked semaphores (the default) pay
+    /// nothing beyond a null pointer check on the wait slow path.
+    void track_waiters(sstring name) {
+        _tracker = make_lw_shared<internal::waiter_tracker>("semaphore", std::move(name));
+    }
+
     /// Signal to waiters that an error occurred.  \ref wait() will see
     /// an exceptional future<> containing a \ref broken_semaphore exception.
     /// The future is made available immediately.
@@ -454,6 +563,11 @@ inline
 void
 basic_semaphore<ExceptionFactory, Clock>::broken(std::exception_ptr xp) noexcept {
     static_assert(std::is_nothrow_copy_constructible_v<std::exception_ptr>);
+    if (_wakeup_scheduled) {
+        // waiters covered by signals that preceded the break must
+        // still succeed
+        wake_waiters();
+    }
     _ex = xp;
     _count = 0;
     while (!_wait_list.empty()) {
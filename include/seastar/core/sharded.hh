@@ -29,6 +29,7 @@
 #include <seastar/core/do_with.hh>
 #include <seastar/util/concepts.hh>
 #include <seastar/util/log.hh>
+#include <seastar/util/later.hh>
 #include <seastar/core/reactor.hh>
 #include <boost/iterator/counting_iterator.hpp>
 #include <functional>
@@ -172,6 +173,23 @@ class sharded {
         promise<> freed;
     };
     std::vector<entry> _instances;
+
+    // One batched cross-shard call; created by batch_invoke_on().
+    struct batch_item {
+        virtual ~batch_item() {}
+        // Runs on the destination shard and stores the (ready) result.
+        virtual future<> run(Service&) = 0;
+        // Runs back on the source shard; ex is set if the batch as a whole
+        // failed before this item could produce a result.
+        virtual void complete(std::exception_ptr ex) noexcept = 0;
+    };
+    struct shard_batch {
+        std::vector<std::unique_ptr<batch_item>> items;
+        bool flush_scheduled = false;
+    };
+    // _batches[source][destination]; the outer vector is sized when the
+    // service starts, each inner vector is touched by its source shard only.
+    std::vector<std::vector<shard_batch>> _batches;
 private:
     using invoke_on_all_func_type = std::function<future<> (Service&)>;
 private:
@@ -196,6 +214,39 @@ private:
     sharded_parallel_for_each(internal::on_each_shard_func func) noexcept(std::is_nothrow_move_constructible_v<internal::on_each_shard_func>) {
         return internal::sharded_parallel_for_each(_instances.size(), std::move(func));
     }
+
+    shard_batch& get_shard_batch(unsigned id) {
+        auto& mine = _batches[this_shard_id()];
+        if (mine.size() != smp::count) {
+            mine.resize(smp::count);
+        }
+        return mine[id];
+    }
+
+    void flush_batch(unsigned id) noexcept {
+        auto& b = get_shard_batch(id);
+        b.flush_scheduled = false;
+        if (b.items.empty()) {
+            return;
+        }
+        auto items = make_lw_shared<std::vector<std::unique_ptr<batch_item>>>(std::exchange(b.items, {}));
+        // The items stay owned by this shard; the destination only gets a
+        // pointer, runs them, and the results travel back with the reply.
+        (void)smp::submit_to(id, [this, raw = items.get()] {
+            auto inst = get_local_service();
+            return parallel_for_each(*raw, [inst] (std::unique_ptr<batch_item>& item) {
+                return item->run(*inst);
+            });
+        }).then_wrapped([items] (future<> f) {
+            std::exception_ptr ex;
+            if (f.failed()) {
+                ex = f.get_exception();
+            }
+            for (auto& item : *items) {
+                item->complete(ex);
+            }
+        });
+    }
 public:
     /// Constructs an empty \c sharded object.  No instances of the service are
     /// created.
@@ -410,6 +461,115 @@ public:
                             std::move(reduce));
     }
 
+    /// NUMA-staged version of \ref map_reduce0(Mapper map, Initial initial, Reduce reduce).
+    ///
+    /// The reduction is performed in two stages: each NUMA node's shards are
+    /// first reduced on one shard of that node, and only the per-node partial
+    /// results are shipped to the caller and reduced there. On multi-socket
+    /// machines this replaces `smp::count - 1` cross-socket transfers with one
+    /// per remote socket, at the cost of an extra reduction step.
+    ///
+    /// Unlike \ref map_reduce0, \c reduce is applied both to mapped values and
+    /// to partial results, so the mapped value type must be convertible to
+    /// \c Initial, \c reduce must be associative, and \c initial must be an
+    /// identity element of \c reduce (it seeds the fold on every node).
+    ///
+    /// On single-node topologies this is equivalent to \ref map_reduce0.
+    template <typename Mapper, typename Initial, typename Reduce>
+    inline
+    future<Initial>
+    map_reduce0_staged(Mapper map, Initial initial, Reduce reduce) {
+        auto nodes = smp::shards_by_numa_node();
+        if (nodes.size() <= 1) {
+            return map_reduce0(std::move(map), std::move(initial), std::move(reduce));
+        }
+        return ::seastar::map_reduce(nodes.begin(), nodes.end(),
+            [this, map, initial, reduce] (const std::vector<unsigned>& members) {
+                return smp::submit_to(members.front(), [this, map, initial, reduce, members] {
+                    return ::seastar::map_reduce(members.begin(), members.end(),
+                        [this, map] (unsigned c) {
+                            return smp::submit_to(c, [this, map] {
+                                auto inst = get_local_service();
+                                return std::invoke(map, *inst);
+                            });
+                        },
+                        initial,
+                        reduce);
+                });
+            },
+            std::move(initial),
+            std::move(reduce));
+    }
+
+    /// Incremental version of \ref map_reduce0(Mapper map, Initial initial, Reduce reduce)
+    /// that allows the caller to short-circuit the gather.
+    ///
+    /// \c map is invoked on every shard as usual, but results are folded into
+    /// the accumulator on the calling shard in arrival order, not shard order:
+    /// `reduce(acc, value)` may mutate \c acc and returns \ref stop_iteration.
+    /// Returning \c stop_iteration::yes resolves the returned future with the
+    /// accumulator immediately; results from shards that have not yet replied
+    /// are discarded when they arrive. This lets quorum-style operations
+    /// complete as soon as enough shards have answered instead of waiting for
+    /// the slowest one.
+    ///
+    /// Shard failures do not fail the operation as long as \c reduce stops it:
+    /// exceptions are remembered, and the first one is reported only if all
+    /// shards complete without \c reduce returning \c stop_iteration::yes.
+    template <typename Mapper, typename Initial, typename Reduce>
+    SEASTAR_CONCEPT(requires requires (Initial acc, Reduce reduce, Mapper map, Service& service) {
+        { reduce(acc, futurize_invoke(map, service).get0()) } -> std::convertible_to<stop_iteration>;
+    })
+    inline
+    future<Initial>
+    map_reduce0_incremental(Mapper map, Initial initial, Reduce reduce) {
+        struct state {
+            Initial acc;
+            Reduce reduce;
+            promise<Initial> pr;
+            unsigned remaining;
+            bool done = false;
+            std::exception_ptr ex;
+        };
+        auto s = make_lw_shared<state>(state{std::move(initial), std::move(reduce), {}, smp::count});
+        for (auto c : smp::all_cpus()) {
+            (void)smp::submit_to(c, [this, map] {
+                auto inst = get_local_service();
+                return std::invoke(map, *inst);
+            }).then_wrapped([s] (auto&& f) {
+                --s->remaining;
+                if (s->done) {
+                    f.ignore_ready_future();
+                } else if (f.failed()) {
+                    if (!s->ex) {
+                        s->ex = f.get_exception();
+                    } else {
+                        f.ignore_ready_future();
+                    }
+                } else {
+                    try {
+                        if (s->reduce(s->acc, f.get0()) == stop_iteration::yes) {
+                            s->done = true;
+                            s->pr.set_value(std::move(s->acc));
+                        }
+                    } catch (...) {
+                        s->done = true;
+                        s->pr.set_exception(std::current_exception());
+                    }
+                }
+                if (!s->done && !s->remaining) {
+                    s->done = true;
+                    if (s->ex) {
+                        s->pr.set_exception(std::move(s->ex));
+                    } else {
+                        s->pr.set_value(std::move(s->acc));
+                    }
+                }
+            });
+        }
+        return s->pr.get_future();
+    }
+
     /// Applies a map function to all shards, and return a vector of the result.
     ///
     /// \param mapper callable with the signature `Value (Service&)` or
@@ -446,7 +606,9 @@ public:
     ///        `future<Value> (Service&, Args...)` (for some `Value` type), or a pointer
     ///        to a member function of Service
     /// \param args parameters to the callable; will be copied or moved. To pass by reference,
-    ///              use std::ref().
+    ///              use std::ref(). Small packs of trivially-copyable values - the
+    ///              common key-plus-opcode case - ship in a recycled fixed-size
+    ///              message slot, with no per-call memory allocation.
     ///
     /// \return result of calling `func(instance)` on the designated instance
     template <typename Func, typename... Args, typename Ret = futurize_t<std::invoke_result_t<Func, Service&, Args...>>>
@@ -474,6 +636,67 @@ public:
         return invoke_on(id, smp_submit_to_options(), std::forward<Func>(func), std::forward<Args>(args)...);
     }
 
+    /// Invoke a callable on a specific instance of `Service`, batching it
+    /// with other calls to the same destination shard.
+    ///
+    /// Unlike \ref invoke_on(), which ships one message per call through the
+    /// inter-shard queues, calls made within the same reactor poll period to
+    /// the same destination are accumulated and shipped as a single message,
+    /// amortizing the queue slot, memory barrier and wakeup costs across the
+    /// batch. Intended for high-rate fine-grained calls such as single-key
+    /// cross-shard lookups; for occasional calls \ref invoke_on() has lower
+    /// latency, since batched calls are only flushed when the current task
+    /// queue run ends.
+    ///
+    /// \param id shard id to call
+    /// \param func a callable with signature `Value (Service&, Args...)` or
+    ///        `future<Value> (Service&, Args...)` (for some `Value` type), or a pointer
+    ///        to a member function of Service
+    /// \param args parameters to the callable; will be copied or moved. To pass by reference,
+    ///              use std::ref().
+    ///
+    /// \return result of calling `func(instance)` on the designated instance
+    template <typename Func, typename... Args, typename Ret = futurize_t<std::invoke_result_t<Func, Service&, Args...>>>
+    SEASTAR_CONCEPT(requires std::invocable<Func, Service&, Args&&...>)
+    Ret
+    batch_invoke_on(unsigned id, Func&& func, Args&&... args) {
+        if (id == this_shard_id()) {
+            return invoke_on(id, std::forward<Func>(func), std::forward<Args>(args)...);
+        }
+        struct item final : batch_item {
+            std::decay_t<Func> func;
+            std::tuple<std::decay_t<Args>...> args;
+            typename Ret::promise_type pr;
+            std::optional<Ret> res;
+            item(Func&& f, Args&&... a) : func(std::forward<Func>(f)), args(std::move(a)...) {}
+            virtual future<> run(Service& s) override {
+                using futurator = futurize<std::invoke_result_t<Func, Service&, Args...>>;
+                return futurator::apply(func, std::tuple_cat(std::forward_as_tuple(s), std::move(args))).then_wrapped([this] (Ret f) {
+                    res = std::move(f);
+                });
+            }
+            virtual void complete(std::exception_ptr ex) noexcept override {
+                if (res) {
+                    res->forward_to(std::move(pr));
+                } else {
+                    pr.set_exception(std::move(ex));
+                }
+            }
+        };
+        auto& b = get_shard_batch(id);
+        b.items.push_back(std::make_unique<item>(std::forward<Func>(func), std::forward<Args>(args)...));
+        auto fut = static_cast<item*>(b.items.back().get())->pr.get_future();
+        if (!b.flush_scheduled) {
+            b.flush_scheduled = true;
+            // Flush once the current task queue run ends, so all calls made
+            // within this poll period share one message.
+            (void)yield().then([this, id] {
+                flush_batch(id);
+            });
+        }
+        return fut;
+    }
+
     /// Gets a reference to the local instance.
     const Service& local() const noexcept;
 
@@ -605,6 +828,7 @@ future<>
 sharded<Service>::start(Args&&... args) noexcept {
   try {
     _instances.resize(smp::count);
+    _batches.resize(smp::count);
     return sharded_parallel_for_each(
         [this, args = std::make_tuple(std::forward<Args>(args)...)] (unsigned c) mutable {
             return smp::submit_to(c, [this, args] () mutable {
@@ -634,6 +858,7 @@ sharded<Service>::start_single(Args&&... args) noexcept {
   try {
     assert(_instances.empty());
     _instances.resize(1);
+    _batches.resize(smp::count);
     return smp::submit_to(0, [this, args = std::make_tuple(std::forward<Args>(args)...)] () mutable {
         _instances[0].service = std::apply([this] (Args... args) {
             return create_local_service(internal::unwrap_sharded_arg(std::forward<Args>(args))...);
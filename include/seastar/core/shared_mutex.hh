@@ -23,6 +23,7 @@
 
 #include <seastar/core/future.hh>
 #include <seastar/core/chunked_fifo.hh>
+#include <seastar/core/waiter_registry.hh>
 #include <cassert>
 #include <utility>
 
@@ -57,6 +58,15 @@ class shared_mutex {
         bool for_write;
     };
     chunked_fifo<waiter> _waiters;
+    // Set by track_waiters(); null (and costless) otherwise.
+    lw_shared_ptr<internal::waiter_tracker> _tracker;
+private:
+    future<> maybe_track(future<> f) noexcept {
+        if (_tracker) {
+            return internal::track_wait(_tracker, std::move(f));
+        }
+        return f;
+    }
 public:
     shared_mutex() = default;
     shared_mutex(shared_mutex&&) = default;
@@ -73,7 +83,7 @@ public:
         }
         try {
             _waiters.emplace_back(promise<>(), false);
-            return _waiters.back().pr.get_future();
+            return maybe_track(_waiters.back().pr.get_future());
         } catch (...) {
             return current_exception_as_future();
         }
@@ -104,7 +114,7 @@ public:
         }
         try {
             _waiters.emplace_back(promise<>(), true);
-            return _waiters.back().pr.get_future();
+            return maybe_track(_waiters.back().pr.get_future());
         } catch (...) {
             return current_exception_as_future();
         }
@@ -125,6 +135,12 @@ public:
         _writer = false;
         wake();
     }
+    /// Registers this mutex in the shard's waiter registry under
+    /// \c name, so \ref dump_waiter_registry() reports its waiter count
+    /// and oldest-waiter age.
+    void track_waiters(sstring name) {
+        _tracker = make_lw_shared<internal::waiter_tracker>("shared_mutex", std::move(name));
+    }
 private:
     void wake() noexcept {
         while (!_waiters.empty()) {
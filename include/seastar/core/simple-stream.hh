@@ -26,6 +26,7 @@
 #include <algorithm>
 #include <cstddef>
 #include <stdexcept>
+#include <string_view>
 #include <type_traits>
 
 namespace seastar {
@@ -372,6 +373,24 @@ public:
     size_t size() const {
         return _size;
     }
+
+    /// Returns the largest contiguous byte range at the current
+    /// position without consuming it; for a simple stream that is
+    /// everything that is left. Consume with \ref skip().
+    [[gnu::always_inline]]
+    std::string_view peek_contiguous() const {
+        return std::string_view(_p, _size);
+    }
+
+    /// Copies out an array of trivially copyable elements with a single
+    /// bounds check and bulk memcpy instead of a checked read per
+    /// element.
+    template<typename T>
+    [[gnu::always_inline]]
+    void read_array(T* p, size_t count) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        read(reinterpret_cast<char*>(p), count * sizeof(T));
+    }
 };
 
 template<typename Iterator>
@@ -436,9 +455,28 @@ public:
         return _size;
     }
 
-    const char* first_fragment_data() const { return _current.begin(); }
-    size_t first_fragment_size() const { return _current.size(); }
-    Iterator fragment_iterator() const { return _it; }
+    /// Returns the largest contiguous byte range at the current
+    /// position without consuming it, stepping to the next fragment
+    /// first if the current one is exhausted. Empty only when the
+    /// stream is. Consume with \ref skip(); readers can iterate
+    /// peek/skip to process the whole stream one flat view at a time.
+    std::string_view peek_contiguous() {
+        if (!_current.size() && _size) {
+            _current = simple(reinterpret_cast<const char*>((*_it).begin()), (*_it).size());
+            _it++;
+        }
+        // a substream may end inside the underlying fragment
+        return std::string_view(_current.begin(), std::min(_current.size(), _size));
+    }
+
+    /// Copies out an array of trivially copyable elements with a single
+    /// bounds check and one bulk copy per fragment spanned, instead of
+    /// a checked read per element.
+    template<typename T>
+    void read_array(T* p, size_t count) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        read(reinterpret_cast<char*>(p), count * sizeof(T));
+    }
 };
 
 /*
@@ -586,6 +624,23 @@ public:
         });
     }
 
+    /// See \ref fragmented_memory_input_stream::peek_contiguous().
+    [[gnu::always_inline]]
+    std::string_view peek_contiguous() {
+        return with_stream([] (auto& stream) {
+            return stream.peek_contiguous();
+        });
+    }
+
+    /// See \ref fragmented_memory_input_stream::read_array().
+    template<typename T>
+    [[gnu::always_inline]]
+    void read_array(T* p, size_t count) {
+        with_stream([p, count] (auto& stream) {
+            stream.read_array(p, count);
+        });
+    }
+
     template<typename Stream, typename StreamVisitor>
     friend decltype(auto) with_serialized_stream(Stream& stream, StreamVisitor&& visitor);
 };
@@ -141,6 +141,9 @@ private:
         boost::intrusive::member_hook<slab_item_base, boost::intrusive::list_member_hook<>,
         &slab_item_base::_lru_link>> _lru;
     size_t _size; // size of objects
+    size_t _pages_count = 0;
+    size_t _used_objects = 0;
+    size_t _total_objects = 0;
     uint8_t _slab_class_id;
 private:
     template<typename... Args>
@@ -148,6 +151,7 @@ private:
     Item* create_item(void *object, uint32_t slab_page_index, Args&&... args) {
         Item *new_item = new(object) Item(slab_page_index, std::forward<Args>(args)...);
         _lru.push_front(reinterpret_cast<slab_item_base&>(*new_item));
+        _used_objects++;
         return new_item;
     }
 
@@ -161,6 +165,7 @@ private:
         uint32_t index = victim.get_slab_page_index();
         assert(victim.is_unlocked());
         _lru.erase(_lru.iterator_to(reinterpret_cast<slab_item_base&>(victim)));
+        _used_objects--;
         // WARNING: You need to make sure that erase_func will not release victim back to slab.
         erase_func(victim);
 
@@ -182,6 +187,18 @@ public:
         return _size;
     }
 
+    size_t pages_count() const {
+        return _pages_count;
+    }
+
+    size_t used_objects() const {
+        return _used_objects;
+    }
+
+    size_t total_objects() const {
+        return _total_objects;
+    }
+
     bool empty() const {
         return _free_slab_pages.empty();
     }
@@ -226,6 +243,8 @@ public:
 
         _free_slab_pages.push_front(*desc);
         insert_slab_page_desc(*desc);
+        _pages_count++;
+        _total_objects += max_object_size / _size;
 
         // first object from the allocated slab page is returned.
         return create_item(slab_page, slab_page_index, std::forward<Args>(args)...);
@@ -244,6 +263,7 @@ public:
         void *object = item;
         _lru.erase(_lru.iterator_to(reinterpret_cast<slab_item_base&>(*item)));
         desc.free_object(object);
+        _used_objects--;
         if (desc.size() == 1) {
             // push back desc into the list of slab pages with free objects.
             _free_slab_pages.push_back(desc);
@@ -270,6 +290,14 @@ public:
         assert(desc.slab_class_id() == _slab_class_id);
         _free_slab_pages.erase(_free_slab_pages.iterator_to(desc));
     }
+
+    // Account a slab page evicted by the reclaimer, together with the
+    // items that were still allocated from it.
+    void account_page_removal(size_t objects, size_t used) {
+        _pages_count--;
+        _total_objects -= objects;
+        _used_objects -= used;
+    }
 };
 
 template<typename Item>
@@ -289,7 +317,7 @@ private:
     struct collectd_stats {
         uint64_t allocs;
         uint64_t frees;
-    } _stats;
+    } _stats = {};
     memory::reclaimer *_reclaimer = nullptr;
     bool _reclaimed = false;
 private:
@@ -324,6 +352,7 @@ private:
         uintptr_t object = reinterpret_cast<uintptr_t>(slab_page);
         auto object_size = slab_class->size();
         auto objects = _max_object_size / object_size;
+        auto used = 0u;
         for (auto i = 0u; i < objects; i++, object += object_size) {
             if (!desc.empty()) {
                 // if binary_search returns true, it means that object at the current
@@ -337,7 +366,9 @@ private:
             slab_class->remove_item_from_lru(item);
             _erase_func(*item);
             _stats.frees++;
+            used++;
         }
+        slab_class->account_page_removal(objects, used);
 #ifdef SEASTAR_DEBUG
         printf("lru slab page eviction succeeded! desc_empty?=%d\n", desc.empty());
 #endif
@@ -357,7 +388,7 @@ private:
         return evict_lru_slab_page();
     }
 
-    void initialize_slab_allocator(double growth_factor, uint64_t limit) {
+    void initialize_slab_allocator(double growth_factor, uint64_t limit, memory::reclaimer_tier tier) {
         constexpr size_t alignment = std::alignment_of<Item>::value;
         constexpr size_t initial_size = 96;
         size_t size = initial_size; // initial object size
@@ -376,7 +407,7 @@ private:
 
         // If slab limit is zero, enable reclaimer.
         if (!limit) {
-            _reclaimer = new memory::reclaimer([this] { return reclaim(); });
+            _reclaimer = new memory::reclaimer([this] { return reclaim(); }, memory::reclaimer_scope::async, tier);
         } else {
             _slab_pages_vector.reserve(_available_slab_pages);
         }
@@ -406,6 +437,19 @@ private:
                 return _stats.allocs - _stats.frees;
             })
         });
+        // _slab_classes is fully populated by now and never changes, so the
+        // per-class getters can safely hold references into it.
+        auto class_label = sm::label("class");
+        for (auto& sc : _slab_classes) {
+            _metrics.add_group("slab", {
+                sm::make_gauge("class_pages", [&sc] { return sc.pages_count(); },
+                    sm::description("Number of slab pages currently allocated to the slab class"), {class_label(sc.size())}),
+                sm::make_gauge("class_used_objects", [&sc] { return sc.used_objects(); },
+                    sm::description("Number of objects currently allocated from the slab class"), {class_label(sc.size())}),
+                sm::make_gauge("class_free_objects", [&sc] { return sc.total_objects() - sc.used_objects(); },
+                    sm::description("Number of free object slots in the slab class pages"), {class_label(sc.size())}),
+            });
+        }
     }
 
     inline slab_page_desc& get_slab_page_desc(Item *item)
@@ -421,21 +465,27 @@ private:
             (_available_slab_pages > 0 || sc.has_no_slab_pages());
     }
 public:
-    slab_allocator(double growth_factor, uint64_t limit, uint64_t max_object_size)
+    // When limit is zero the allocator grows on demand and registers a
+    // memory reclaimer that evicts the least recently used slab page under
+    // memory pressure; 'tier' places that reclaimer in the eviction order
+    // (see memory::reclaimer_tier) relative to other caches on the shard.
+    slab_allocator(double growth_factor, uint64_t limit, uint64_t max_object_size,
+                   memory::reclaimer_tier tier = 0)
         : _max_object_size(max_object_size)
         , _available_slab_pages(limit / max_object_size)
     {
-        initialize_slab_allocator(growth_factor, limit);
+        initialize_slab_allocator(growth_factor, limit, tier);
         register_metrics();
     }
 
     slab_allocator(double growth_factor, uint64_t limit, uint64_t max_object_size,
-                   std::function<void (Item& item_ref)> erase_func)
+                   std::function<void (Item& item_ref)> erase_func,
+                   memory::reclaimer_tier tier = 0)
         : _erase_func(std::move(erase_func))
         , _max_object_size(max_object_size)
         , _available_slab_pages(limit / max_object_size)
     {
-        initialize_slab_allocator(growth_factor, limit);
+        initialize_slab_allocator(growth_factor, limit, tier);
         register_metrics();
     }
 
@@ -31,6 +31,7 @@
 #include <boost/lockfree/spsc_queue.hpp>
 #include <boost/thread/barrier.hpp>
 #include <boost/range/irange.hpp>
+#include <cstddef>
 #include <deque>
 #include <optional>
 #include <thread>
@@ -177,6 +178,14 @@ smp_service_group_semaphore& get_smp_service_groups_semaphore(unsigned ssg_id, s
 class smp_message_queue {
     static constexpr size_t queue_length = 128;
     static constexpr size_t batch_size = 16;
+    // Crossing the NUMA interconnect costs considerably more than staying
+    // on-socket, so queues connecting shards on different NUMA nodes batch
+    // more aggressively to amortize the cost of each crossing.
+    static constexpr size_t cross_node_batch_size = 64;
+    // The adaptive flush policy never shrinks its batch target below
+    // this; flushing fewer items spends more on the queue push than
+    // the batching saves.
+    static constexpr size_t min_flush_batch = 4;
     static constexpr size_t prefetch_cnt = 2;
     struct work_item;
     struct lf_queue_remote {
@@ -198,6 +207,17 @@ class smp_message_queue {
         size_t _last_snt_batch = 0;
         size_t _last_cmpl_batch = 0;
         size_t _current_queue_length = 0;
+        // Adaptive flush policy: requests accumulate until either
+        // _flush_batch of them are pending or the oldest has waited
+        // _flush_deadline cycle-counter ticks, whichever comes first.
+        // The deadline is derived from an estimate of the queue round
+        // trip, sampled one batch at a time.
+        size_t _flush_batch = batch_size;
+        uint64_t _flush_deadline = 0;
+        uint64_t _first_pending_tsc = 0;
+        uint64_t _round_trip_cycles = 0;
+        uint64_t _rtt_sample_start_tsc = 0;
+        size_t _rtt_sample_target = 0;
     };
     // keep this between two structures with statistics
     // this makes sure that they have at least one cache line
@@ -216,6 +236,27 @@ class smp_message_queue {
         void process();
         virtual void complete() = 0;
     };
+    // Recycled storage for small work items. A work item is allocated on the
+    // sending shard and freed there when the response is processed, so the
+    // free list needs no synchronization; recycling fixed-size slots keeps
+    // the common case - an invoke_on()/submit_to() whose callable captures a
+    // few trivially-copyable arguments - from taking an allocator round trip
+    // on every cross-shard call. Larger work items fall back to the
+    // allocator.
+    static constexpr size_t work_item_slot_size = 192;
+    static constexpr size_t max_free_work_item_slots = 128;
+    union work_item_slot {
+        work_item_slot* next;
+        alignas(std::max_align_t) char storage[work_item_slot_size];
+    };
+    struct work_item_slot_list {
+        work_item_slot* head = nullptr;
+        size_t count = 0;
+        ~work_item_slot_list();
+    };
+    static work_item_slot_list& free_work_item_slots() noexcept;
+    static void* alloc_work_item(size_t size);
+    static void free_work_item(void* p, size_t size) noexcept;
     template <typename Func>
     struct async_work_item : work_item {
         smp_message_queue& _queue;
@@ -227,6 +268,12 @@ class smp_message_queue {
         std::exception_ptr _ex; // if !_result
         typename futurator::promise_type _promise; // used on local side
         async_work_item(smp_message_queue& queue, smp_service_group ssg, Func&& func) : work_item(ssg), _queue(queue), _func(std::move(func)) {}
+        static void* operator new(size_t size) {
+            return alloc_work_item(size);
+        }
+        static void operator delete(void* p, size_t size) noexcept {
+            free_work_item(p, size);
+        }
         virtual void fail_with(std::exception_ptr ex) override {
             _promise.set_exception(std::move(ex));
         }
@@ -267,8 +314,10 @@ class smp_message_queue {
         } a;
     } _tx;
     std::vector<work_item*> _completed_fifo;
+    // read-only after construction; used by both sides of the queue
+    size_t _batch_size;
 public:
-    smp_message_queue(reactor* from, reactor* to);
+    smp_message_queue(reactor* from, reactor* to, bool cross_numa_node);
     ~smp_message_queue();
     template <typename Func>
     futurize_t<std::invoke_result_t<Func>> submit(shard_id t, smp_submit_to_options options, Func&& func) noexcept {
@@ -290,6 +339,7 @@ private:
     void respond(work_item* wi);
     void move_pending();
     void flush_request_batch();
+    void force_flush_request_batch();
     void flush_response_batch();
     bool has_unflushed_responses() const;
     bool pure_poll_rx() const;
@@ -313,6 +363,7 @@ class smp : public std::enable_shared_from_this<smp> {
     std::unique_ptr<smp_message_queue*[], qs_deleter> _qs_owner;
     static thread_local smp_message_queue**_qs;
     static thread_local std::thread::id _tmain;
+    static std::vector<unsigned> _numa_node_ids; // indexed by shard, filled by configure()
     bool _using_dpdk = false;
 
     template <typename Func>
@@ -386,9 +437,48 @@ public:
     }
     static bool poll_queues();
     static bool pure_poll_queues();
+    static void flush_request_batches();
+    /// Returns the cycle counter value shard \c id published at the top of
+    /// its last poll iteration, or 0 if the shard's event loop has not
+    /// started yet. The heartbeats also live in a shared-memory page
+    /// (a memfd named \c seastar-heartbeat, reachable through
+    /// <tt>/proc/\<pid\>/fd</tt>) so external watchdogs can observe them
+    /// with a plain memory read.
+    static uint64_t shard_heartbeat(shard_id id) noexcept;
+    /// Returns whether shard \c id has gone at least \c threshold without
+    /// completing a poll iteration, i.e. appears wedged in a task or a
+    /// blocking system call. Returns \c false while the shard has not
+    /// started or the cycle-counter frequency has not been calibrated yet
+    /// (roughly the first second after startup).
+    ///
+    /// A stalled shard still drains its message queues once it resumes, so
+    /// cross-shard callers remain correct either way; this is a cheap local
+    /// read meant for shedding or redirecting traffic away from a wedged
+    /// peer instead of queueing behind it.
+    static bool shard_is_stalled(shard_id id, std::chrono::nanoseconds threshold) noexcept;
     static boost::integer_range<unsigned> all_cpus() noexcept {
         return boost::irange(0u, count);
     }
+    /// Returns the id of the NUMA node that shard \c shard is bound to,
+    /// or 0 if the machine topology is unknown.
+    static unsigned numa_node_id(shard_id shard) noexcept {
+        return shard < _numa_node_ids.size() ? _numa_node_ids[shard] : 0;
+    }
+    /// Returns the shards of each NUMA node, one non-empty group per node
+    /// that has shards bound to it. On machines with unknown topology a
+    /// single group holding all shards is returned.
+    static std::vector<std::vector<unsigned>> shards_by_numa_node() {
+        std::vector<std::vector<unsigned>> nodes;
+        for (auto c : all_cpus()) {
+            auto n = numa_node_id(c);
+            if (n >= nodes.size()) {
+                nodes.resize(n + 1);
+            }
+            nodes[n].push_back(c);
+        }
+        std::erase_if(nodes, [] (const std::vector<unsigned>& v) { return v.empty(); });
+        return nodes;
+    }
     /// Invokes func on all shards.
     ///
     /// \param options the options to forward to the \ref smp::submit_to()
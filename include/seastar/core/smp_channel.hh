@@ -0,0 +1,384 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB
+ */
+
+#pragma once
+
+#include <seastar/core/cacheline.hh>
+#include <seastar/core/chunked_fifo.hh>
+#include <seastar/core/future.hh>
+#include <seastar/core/loop.hh>
+#include <seastar/core/pipe.hh>
+#include <seastar/core/smp.hh>
+
+#include <atomic>
+#include <bit>
+#include <memory>
+
+namespace seastar {
+
+/// \addtogroup smp-module
+/// @{
+
+/// \cond internal
+namespace internal {
+
+// Shared state of an smp_channel: a fixed-size single-producer
+// single-consumer ring of T plus one doorbell per direction.
+//
+// Items move through the ring with plain loads and stores; the only
+// cross-shard messages are the doorbells, and a doorbell is sent only
+// when the other side has announced (via the _*_asleep flag) that it ran
+// out of items or room and went to sleep. A side that finds the ring
+// usable never pays submit_to() overhead, so a saturated channel moves
+// batches at memory speed with no messages at all.
+//
+// The state is shared between shards through std::shared_ptr (like
+// io_group): the last reference can be dropped by a doorbell task on
+// either shard, and leftover items are destroyed wherever that happens.
+template <typename T>
+class smp_channel_state {
+    static_assert(std::is_nothrow_move_constructible_v<T>,
+                  "smp_channel<T> requires a nothrow move constructor, since items are moved through the ring");
+
+    const size_t _mask; // ring capacity - 1; capacity is a power of two
+    T* _slots;
+
+    // Producer-written line. _head_cache avoids re-reading the
+    // consumer's line while the producer still knows about free room.
+    alignas(cache_line_size) std::atomic<size_t> _tail{0}; // next slot to write
+    std::atomic<bool> _write_open{true};
+    size_t _head_cache{0};
+    shard_id _producer_shard{0}; // valid while _producer_asleep
+    promise<> _producer_wakeup;  // producer-shard only
+    std::atomic<bool> _producer_asleep{false};
+
+    // Consumer-written line, symmetric with the above.
+    alignas(cache_line_size) std::atomic<size_t> _head{0}; // next slot to read
+    std::atomic<bool> _read_open{true};
+    size_t _tail_cache{0};
+    shard_id _consumer_shard{0}; // valid while _consumer_asleep
+    promise<> _consumer_wakeup;  // consumer-shard only
+    std::atomic<bool> _consumer_asleep{false};
+
+    size_t capacity() const noexcept {
+        return _mask + 1;
+    }
+    // Ring a side's doorbell if it went to sleep. The exchange claims the
+    // doorbell, so each sleep gets exactly one wakeup task.
+    static void wake(std::atomic<bool>& asleep, shard_id shard, promise<>& wakeup, const std::shared_ptr<smp_channel_state>& self) noexcept {
+        if (asleep.exchange(false, std::memory_order_seq_cst)) {
+            // failure here means the process is out of memory; allow the
+            // exception to propagate to the caller doing the transition
+            (void)smp::submit_to(shard, [&wakeup, self] () noexcept {
+                wakeup.set_value();
+            });
+        }
+    }
+public:
+    explicit smp_channel_state(size_t capacity)
+            : _mask(std::bit_ceil(std::max<size_t>(capacity, 2)) - 1)
+            , _slots(std::allocator<T>().allocate(_mask + 1)) {
+    }
+    ~smp_channel_state() {
+        for (auto i = _head.load(std::memory_order_relaxed); i != _tail.load(std::memory_order_relaxed); ++i) {
+            std::destroy_at(&_slots[i & _mask]);
+        }
+        std::allocator<T>().deallocate(_slots, _mask + 1);
+    }
+    smp_channel_state(const smp_channel_state&) = delete;
+
+    // Producer side; must be called on the producer's shard.
+
+    size_t try_push(T* items, size_t n, const std::shared_ptr<smp_channel_state>& self) noexcept {
+        auto tail = _tail.load(std::memory_order_relaxed);
+        auto room = capacity() - (tail - _head_cache);
+        if (room < n) {
+            _head_cache = _head.load(std::memory_order_acquire);
+            room = capacity() - (tail - _head_cache);
+        }
+        n = std::min(n, room);
+        for (size_t i = 0; i != n; ++i) {
+            new (&_slots[(tail + i) & _mask]) T(std::move(items[i]));
+        }
+        if (n) {
+            _tail.store(tail + n, std::memory_order_release);
+            wake(_consumer_asleep, _consumer_shard, _consumer_wakeup, self);
+        }
+        return n;
+    }
+    future<> wait_for_room(const std::shared_ptr<smp_channel_state>& self) noexcept {
+        if (!_read_open.load(std::memory_order_relaxed)) {
+            return make_exception_future<>(broken_pipe_exception());
+        }
+        auto tail = _tail.load(std::memory_order_relaxed);
+        _head_cache = _head.load(std::memory_order_acquire);
+        if (tail - _head_cache < capacity()) {
+            return make_ready_future<>();
+        }
+        _producer_shard = this_shard_id();
+        _producer_wakeup = promise<>();
+        _producer_asleep.store(true, std::memory_order_seq_cst);
+        // Re-check after announcing the sleep: the consumer may have made
+        // room (or closed) without seeing the flag.
+        if (_head.load(std::memory_order_seq_cst) != _head_cache || !_read_open.load(std::memory_order_seq_cst)) {
+            if (_producer_asleep.exchange(false, std::memory_order_seq_cst)) {
+                return make_ready_future<>();
+            }
+            // the consumer claimed the doorbell; its wakeup task will
+            // resolve the promise
+        }
+        return _producer_wakeup.get_future();
+    }
+    future<> push(std::vector<T> batch, const std::shared_ptr<smp_channel_state>& self) noexcept {
+        return do_with(std::move(batch), size_t(0), [this, self] (std::vector<T>& batch, size_t& done) {
+            return do_until([&batch, &done] { return done == batch.size(); }, [this, self, &batch, &done] {
+                if (!_read_open.load(std::memory_order_relaxed)) {
+                    return make_exception_future<>(broken_pipe_exception());
+                }
+                done += try_push(batch.data() + done, batch.size() - done, self);
+                if (done != batch.size()) {
+                    return wait_for_room(self);
+                }
+                return make_ready_future<>();
+            });
+        });
+    }
+    void close_write(const std::shared_ptr<smp_channel_state>& self) noexcept {
+        _write_open.store(false, std::memory_order_seq_cst);
+        wake(_consumer_asleep, _consumer_shard, _consumer_wakeup, self);
+    }
+
+    // Consumer side; must be called on the consumer's shard.
+
+    size_t try_pop(T* out, size_t n, const std::shared_ptr<smp_channel_state>& self) noexcept {
+        auto head = _head.load(std::memory_order_relaxed);
+        auto avail = _tail_cache - head;
+        if (avail < n) {
+            _tail_cache = _tail.load(std::memory_order_acquire);
+            avail = _tail_cache - head;
+        }
+        n = std::min(n, avail);
+        for (size_t i = 0; i != n; ++i) {
+            auto& slot = _slots[(head + i) & _mask];
+            out[i] = std::move(slot);
+            std::destroy_at(&slot);
+        }
+        if (n) {
+            // releasing the room is the credit; a producer asleep on a
+            // full ring is woken here
+            _head.store(head + n, std::memory_order_release);
+            wake(_producer_asleep, _producer_shard, _producer_wakeup, self);
+        }
+        return n;
+    }
+    bool eof() noexcept {
+        return !_write_open.load(std::memory_order_seq_cst)
+                && _head.load(std::memory_order_relaxed) == _tail.load(std::memory_order_seq_cst);
+    }
+    future<> wait_for_items(const std::shared_ptr<smp_channel_state>& self) noexcept {
+        _tail_cache = _tail.load(std::memory_order_acquire);
+        auto head = _head.load(std::memory_order_relaxed);
+        if (_tail_cache != head || !_write_open.load(std::memory_order_seq_cst)) {
+            return make_ready_future<>();
+        }
+        _consumer_shard = this_shard_id();
+        _consumer_wakeup = promise<>();
+        _consumer_asleep.store(true, std::memory_order_seq_cst);
+        // Re-check: the producer may have pushed (or closed) without
+        // seeing the flag.
+        if (_tail.load(std::memory_order_seq_cst) != head || !_write_open.load(std::memory_order_seq_cst)) {
+            if (_consumer_asleep.exchange(false, std::memory_order_seq_cst)) {
+                return make_ready_future<>();
+            }
+            // the producer claimed the doorbell; its wakeup task will
+            // resolve the promise
+        }
+        return _consumer_wakeup.get_future();
+    }
+    future<chunked_fifo<T>> read(const std::shared_ptr<smp_channel_state>& self) noexcept {
+        return wait_for_items(self).then([this, self] {
+            chunked_fifo<T> batch;
+            auto head = _head.load(std::memory_order_relaxed);
+            _tail_cache = _tail.load(std::memory_order_acquire);
+            auto n = _tail_cache - head;
+            batch.reserve(n);
+            for (size_t i = 0; i != n; ++i) {
+                auto& slot = _slots[(head + i) & _mask];
+                batch.push_back(std::move(slot));
+                std::destroy_at(&slot);
+            }
+            if (n) {
+                _head.store(head + n, std::memory_order_release);
+                wake(_producer_asleep, _producer_shard, _producer_wakeup, self);
+            }
+            // an empty batch (only possible at eof) marks end of stream
+            return make_ready_future<chunked_fifo<T>>(std::move(batch));
+        });
+    }
+    void close_read(const std::shared_ptr<smp_channel_state>& self) noexcept {
+        _read_open.store(false, std::memory_order_seq_cst);
+        wake(_producer_asleep, _producer_shard, _producer_wakeup, self);
+    }
+};
+
+} // namespace internal
+/// \endcond
+
+template <typename T>
+class smp_channel;
+
+/// \brief Consuming end of an \ref smp_channel
+///
+/// Allows only reading from the channel, on the shard it was moved to. A
+/// reader cannot be created separately, but only as part of a
+/// reader/writer pair through \ref smp_channel.
+template <typename T>
+class smp_channel_reader {
+    std::shared_ptr<internal::smp_channel_state<T>> _state;
+    smp_channel_reader(std::shared_ptr<internal::smp_channel_state<T>> state) noexcept : _state(std::move(state)) { }
+    friend class smp_channel<T>;
+public:
+    /// Moves up to \c n items into \c out without blocking, returning how
+    /// many were moved (0 when the ring is empty). This is the
+    /// memory-bandwidth path: no allocation, no cross-shard message
+    /// unless the producer is blocked on a full ring.
+    size_t try_pop(T* out, size_t n) noexcept {
+        return _state->try_pop(out, n, _state);
+    }
+    /// Returns a future satisfied when \ref try_pop can make progress or
+    /// \ref eof became true. Single-consumer: do not call again until the
+    /// returned future resolves.
+    future<> wait_for_items() noexcept {
+        return _state->wait_for_items(_state);
+    }
+    /// Returns whether the write side closed and everything it pushed has
+    /// been popped.
+    bool eof() noexcept {
+        return _state->eof();
+    }
+    /// \brief Read everything accumulated in the channel
+    ///
+    /// Returns a future which is fulfilled with every item currently in
+    /// the ring, in push order, when the ring becomes non-empty or the
+    /// write side is closed. An empty batch marks the end of the stream.
+    future<chunked_fifo<T>> read() noexcept {
+        return _state->read(_state);
+    }
+    ~smp_channel_reader() {
+        if (_state) {
+            _state->close_read(_state);
+        }
+    }
+    // Allow move, but not copy, of smp_channel_reader
+    smp_channel_reader(smp_channel_reader&&) noexcept = default;
+    smp_channel_reader& operator=(smp_channel_reader&& other) noexcept {
+        std::swap(_state, other._state);
+        return *this;
+    }
+};
+
+/// \brief Producing end of an \ref smp_channel
+///
+/// Allows only writing to the channel, on the shard it was moved to (or
+/// created on). A writer cannot be created separately, but only as part
+/// of a reader/writer pair through \ref smp_channel.
+template <typename T>
+class smp_channel_writer {
+    std::shared_ptr<internal::smp_channel_state<T>> _state;
+    smp_channel_writer(std::shared_ptr<internal::smp_channel_state<T>> state) noexcept : _state(std::move(state)) { }
+    friend class smp_channel<T>;
+public:
+    /// Moves up to \c n items from \c items into the ring without
+    /// blocking, returning how many were moved (0 when the ring is
+    /// full). This is the memory-bandwidth path: no allocation, no
+    /// cross-shard message unless the consumer is blocked on an empty
+    /// ring.
+    size_t try_push(T* items, size_t n) noexcept {
+        return _state->try_push(items, n, _state);
+    }
+    /// Returns a future satisfied when \ref try_push can make progress.
+    /// Fails with \ref broken_pipe_exception if the read side was closed.
+    /// Single-producer: do not call again until the returned future
+    /// resolves.
+    future<> wait_for_room() noexcept {
+        return _state->wait_for_room(_state);
+    }
+    /// \brief Write a batch of items to the channel
+    ///
+    /// Moves the whole batch into the ring, waiting for the consumer to
+    /// make room whenever the ring fills up. If the read side was closed,
+    /// the future fails with \ref broken_pipe_exception.
+    future<> write(std::vector<T> batch) noexcept {
+        return _state->push(std::move(batch), _state);
+    }
+    ~smp_channel_writer() {
+        if (_state) {
+            _state->close_write(_state);
+        }
+    }
+    // Allow move, but not copy, of smp_channel_writer
+    smp_channel_writer(smp_channel_writer&&) noexcept = default;
+    smp_channel_writer& operator=(smp_channel_writer&& other) noexcept {
+        std::swap(_state, other._state);
+        return *this;
+    }
+};
+
+/// \brief A typed, batched single-producer single-consumer channel
+/// between two shards.
+///
+/// \ref smp::submit_to carries one function call per item: every message
+/// allocates, is routed through the general-purpose smp queues and runs
+/// a continuation on the remote side, which is the right tool for
+/// control-plane calls but too heavy for streaming millions of records
+/// between shards. An smp_channel<T> instead moves the records
+/// themselves through a fixed-size ring negotiated at creation: each
+/// side transfers batches with \ref smp_channel_writer::try_push and
+/// \ref smp_channel_reader::try_pop at plain memcpy-like cost, and
+/// cross-shard messages are reduced to one "doorbell" per sleep/wake
+/// transition — none at all while both sides keep up. The ring's
+/// capacity is the flow-control credit: a producer that outruns the
+/// consumer blocks in \ref smp_channel_writer::wait_for_room until the
+/// consumer frees slots.
+///
+/// Like \ref seastar::pipe, the channel object itself is just a factory
+/// for the two endpoints; move the reader to the consuming shard (e.g.
+/// with \ref smp::submit_to) and keep the writer on the producing one.
+/// Each endpoint must only be used from one shard at a time, and
+/// destroying either endpoint unblocks the other (EOF for the reader,
+/// \ref broken_pipe_exception for the writer). Items still in the ring
+/// when the last endpoint goes away are destroyed on whichever shard
+/// drops the last reference.
+template <typename T>
+class smp_channel {
+public:
+    smp_channel_reader<T> reader;
+    smp_channel_writer<T> writer;
+    /// Creates a channel whose ring holds \c capacity items, rounded up
+    /// to a power of two.
+    explicit smp_channel(size_t capacity) : smp_channel(std::make_shared<internal::smp_channel_state<T>>(capacity)) { }
+private:
+    smp_channel(std::shared_ptr<internal::smp_channel_state<T>> state) noexcept : reader(state), writer(std::move(state)) { }
+};
+
+/// @}
+
+} // namespace seastar
@@ -79,6 +79,18 @@ struct smp_options : public program_options::option_group {
     /// them to remote ones.
     /// \note Unused when seastar is compiled without \p HWLOC support.
     program_options::value<bool> allow_cpus_in_remote_numa_nodes;
+    /// \brief Per-shard poller priority profiles.
+    ///
+    /// A comma-separated list of <shard-range>:<profile> entries, e.g.
+    /// "0-3:network,4-7:storage", where the profile is \p network or
+    /// \p storage. A network-profile shard keeps its networking pollers
+    /// at the highest polling frequency while letting storage completions
+    /// back off further, so they are reaped at batch points; a
+    /// storage-profile shard does the opposite. Unlisted shards (the
+    /// default) poll all event sources uniformly. Shard numbers beyond
+    /// \ref smp are ignored, so the same profile string can serve
+    /// deployments of different sizes.
+    program_options::value<std::string> poller_profiles;
 
     /// Memory allocator to use.
     ///
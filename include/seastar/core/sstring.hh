@@ -24,6 +24,7 @@
 #include <stdint.h>
 #include <algorithm>
 #include <cassert>
+#include <charconv>
 #if __has_include(<compare>)
 #include <compare>
 #endif
@@ -716,12 +717,32 @@ static String make_sstring(Args&&... args)
 }
 
 namespace internal {
+
+// Arithmetic types whose textual form std::to_chars() produces and which
+// matches what fmt would print: all integers except the character types
+// and bool, plus the floating point types (both print the shortest
+// round-trippable representation).
+template <typename T>
+constexpr bool use_to_chars_for_to_sstring =
+        (std::is_integral_v<T> && !std::is_same_v<T, bool> && !std::is_same_v<T, char>)
+        || std::is_floating_point_v<T>;
+
 template <typename string_type, typename T>
 string_type to_sstring(T value) {
-    auto size = fmt::formatted_size("{}", value);
-    auto formatted = uninitialized_string<string_type>(size);
-    fmt::format_to(formatted.data(), "{}", value);
-    return formatted;
+    if constexpr (use_to_chars_for_to_sstring<T> && std::is_same_v<typename string_type::value_type, char>) {
+        // Convert on the stack with std::to_chars() instead of going
+        // through fmt; short results then land in the string's internal
+        // storage without touching the allocator at all.
+        char buffer[64]; // fits any arithmetic type
+        auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        assert(ec == std::errc());
+        return string_type(buffer, end - buffer);
+    } else {
+        auto size = fmt::formatted_size("{}", value);
+        auto formatted = uninitialized_string<string_type>(size);
+        fmt::format_to(formatted.data(), "{}", value);
+        return formatted;
+    }
 }
 
 template <typename string_type>
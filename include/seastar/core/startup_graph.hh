@@ -0,0 +1,91 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB
+ */
+
+#pragma once
+
+#include <seastar/core/future.hh>
+#include <seastar/core/shared_future.hh>
+#include <seastar/core/sstring.hh>
+#include <seastar/util/noncopyable_function.hh>
+#include <chrono>
+#include <vector>
+
+namespace seastar {
+
+/// Runs application start-up steps concurrently where their declared
+/// dependencies allow.
+///
+/// An application with many \c sharded<> services typically starts
+/// them one after another inside its \ref app_template::run()
+/// function, even though most of them do not depend on each other, so
+/// cold start takes the sum of all the starts instead of the length of
+/// the longest dependency chain. A startup_graph makes the
+/// dependencies explicit: each step names the steps it needs, \ref
+/// run() launches every step the moment its dependencies have
+/// completed, and independent steps run concurrently.
+///
+/// Steps may only depend on previously added steps, which rules out
+/// dependency cycles by construction. If a step fails, steps depending
+/// on it (directly or transitively) are not started, steps not
+/// depending on it run to completion, and \ref run() resolves with the
+/// first failure once every started step has finished. Each step's run
+/// time is recorded for start-up profiling and logged at debug level.
+///
+/// Example:
+/// \code
+/// startup_graph g;
+/// auto cfg = g.add_step("config", {}, [&] { return config.start(); });
+/// auto db = g.add_step("database", {cfg}, [&] { return db.start(std::ref(config)); });
+/// auto api = g.add_step("api", {cfg}, [&] { return api.start(std::ref(config)); });
+/// g.add_step("server", {db, api}, [&] { return server.start(std::ref(db), std::ref(api)); });
+/// return g.run();
+/// \endcode
+class startup_graph {
+public:
+    using step_id = size_t;
+private:
+    struct step {
+        sstring name;
+        std::vector<step_id> dependencies;
+        noncopyable_function<future<> ()> action;
+        shared_promise<> done;
+        std::chrono::steady_clock::duration duration = {};
+    };
+    std::vector<step> _steps;
+    bool _ran = false;
+public:
+    /// Adds a step running \c action once every step in \c
+    /// dependencies has completed. All dependencies must have been
+    /// added already. Returns the step's id, for use as a dependency
+    /// of later steps.
+    step_id add_step(sstring name, std::vector<step_id> dependencies, noncopyable_function<future<> ()> action);
+
+    /// Runs all the steps, as concurrently as the declared
+    /// dependencies allow. May be called at most once.
+    future<> run();
+
+    /// How long a step's action ran, valid after \ref run() resolved.
+    std::chrono::steady_clock::duration step_duration(step_id id) const noexcept {
+        return _steps[id].duration;
+    }
+};
+
+}
@@ -0,0 +1,57 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright 2026 ScyllaDB
+ */
+
+#pragma once
+
+#include <seastar/core/file.hh>
+
+namespace seastar {
+
+/// \addtogroup fileio-module
+/// @{
+
+/// Wraps an open file so that its I/O is striped across all shards.
+///
+/// A regular \ref file issues its requests through the io_queue of the
+/// shard that opened it, so a single large file can only consume one
+/// shard's share of the device bandwidth. make_striped_file() duplicates
+/// the file onto every shard and routes each DMA request to a shard
+/// determined by the request's offset (offset / stripe_size, modulo the
+/// shard count); requests crossing stripe boundaries are split and their
+/// completions aggregated. This lets one file saturate the full device,
+/// at the cost of a cross-shard message per remote stripe, so it pays
+/// off for large sequential transfers, not small random I/O.
+///
+/// The returned file must be used from the calling shard, like any
+/// other. Metadata operations (flush, stat, truncate, size, ...) go
+/// through the original file. An \ref io_intent passed to a request is
+/// honored only for the parts served by the calling shard; the remote
+/// parts are not cancellable.
+///
+/// \param f an open file; its implementation must support dup()
+/// \param stripe_size the striping unit; must be a multiple of the
+///        file's DMA alignments. The 1 MiB default suits bulk reads.
+/// \return a \ref file striping its I/O across all shards
+future<file> make_striped_file(file f, uint64_t stripe_size = 1 << 20);
+
+/// @}
+
+}
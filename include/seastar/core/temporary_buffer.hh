@@ -51,6 +51,13 @@ namespace seastar {
 /// Unless you created a \c temporary_buffer yourself, do not modify its contents, as they
 /// may be shared with another user that does not expect the data to change.
 ///
+/// Buffers of up to \ref internal_size bytes allocated with the size
+/// constructor (or \ref copy_of() / \ref clone()) store their data inside the
+/// object itself, with no allocation and no deleter. For such buffers the
+/// pointers returned by \ref get() and \ref get_write() are invalidated by
+/// moving the \c temporary_buffer object; \ref share() and \ref release()
+/// transparently move the data to stable external storage first.
+///
 /// Use cases for a \c temporary_buffer include:
 ///  - passing a substring of a tcp packet for the user to consume (zero-copy
 ///    tcp input)
@@ -62,19 +69,48 @@ namespace seastar {
 template <typename CharType>
 class temporary_buffer {
     static_assert(sizeof(CharType) == 1, "must buffer stream of bytes");
+public:
+    /// Largest size, in bytes, stored inside the object itself rather than
+    /// in an external allocation.
+    static constexpr size_t internal_size = 64;
+private:
     CharType* _buffer;
     size_t _size;
     deleter _deleter;
+    CharType _internal[internal_size]; // only used when is_internal()
+
+    bool is_internal() const noexcept {
+        return _buffer >= _internal && _buffer < _internal + internal_size;
+    }
+
+    // Moves the data to external storage, so that it can outlive this
+    // object. get() and get_write() return the stable pointer afterwards.
+    void promote_to_external() {
+        auto buf = static_cast<CharType*>(malloc(_size * sizeof(CharType)));
+        if (_size && !buf) {
+            throw std::bad_alloc();
+        }
+        std::copy_n(_buffer, _size, buf);
+        _buffer = buf;
+        _deleter = make_free_deleter(buf);
+    }
 public:
     /// Creates a \c temporary_buffer of a specified size.  The buffer is not shared
     /// with anyone, and is not initialized.
     ///
     /// \param size buffer size, in bytes
     explicit temporary_buffer(size_t size)
-        : _buffer(static_cast<CharType*>(malloc(size * sizeof(CharType)))), _size(size)
-        , _deleter(make_free_deleter(_buffer)) {
-        if (size && !_buffer) {
-            throw std::bad_alloc();
+        : _size(size) {
+        if (size <= internal_size) {
+            // Small buffers live inside the object: no allocation and no
+            // deleter
+            _buffer = _internal;
+        } else {
+            _buffer = static_cast<CharType*>(malloc(size * sizeof(CharType)));
+            if (!_buffer) {
+                throw std::bad_alloc();
+            }
+            _deleter = make_free_deleter(_buffer);
         }
     }
     //explicit temporary_buffer(CharType* borrow, size_t size) : _buffer(borrow), _size(size) {}
@@ -84,8 +120,16 @@ public:
         , _size(0) {}
     temporary_buffer(const temporary_buffer&) = delete;
 
-    /// Moves a \c temporary_buffer.
-    temporary_buffer(temporary_buffer&& x) noexcept : _buffer(x._buffer), _size(x._size), _deleter(std::move(x._deleter)) {
+    /// Moves a \c temporary_buffer. If the data is stored inside the source
+    /// object it is copied over, and pointers previously obtained with
+    /// \ref get() or \ref get_write() are invalidated.
+    temporary_buffer(temporary_buffer&& x) noexcept : _size(x._size), _deleter(std::move(x._deleter)) {
+        if (x.is_internal()) {
+            std::copy_n(x._buffer, x._size, _internal);
+            _buffer = _internal;
+        } else {
+            _buffer = x._buffer;
+        }
         x._buffer = nullptr;
         x._size = 0;
     }
@@ -109,9 +153,14 @@ public:
     /// Moves a \c temporary_buffer.
     temporary_buffer& operator=(temporary_buffer&& x) noexcept {
         if (this != &x) {
-            _buffer = x._buffer;
             _size = x._size;
             _deleter = std::move(x._deleter);
+            if (x.is_internal()) {
+                std::copy_n(x._buffer, x._size, _internal);
+                _buffer = _internal;
+            } else {
+                _buffer = x._buffer;
+            }
             x._buffer = nullptr;
             x._size = 0;
         }
@@ -154,6 +203,9 @@ public:
     ///
     /// \return a clone of the buffer object.
     temporary_buffer share() {
+        if (is_internal()) {
+            promote_to_external();
+        }
         return temporary_buffer(_buffer, _size, _deleter.share());
     }
     /// Create a new \c temporary_buffer object referring to a substring of the
@@ -195,8 +247,15 @@ public:
     /// Instead, it is the caller's responsibility to destroy the deleter object
     /// when the data is no longer needed.
     ///
+    /// Data stored inside the object is first moved to external storage
+    /// owned by the returned deleter; call \ref get() or \ref get_write()
+    /// after release() to obtain the stable pointer.
+    ///
     /// \return \ref deleter object managing the data's lifetime.
-    deleter release() noexcept {
+    deleter release() {
+        if (is_internal()) {
+            promote_to_external();
+        }
         return std::move(_deleter);
     }
     /// Creates a \c temporary_buffer object with a specified size, with
@@ -216,6 +275,9 @@ public:
     }
 
     static temporary_buffer copy_of(std::string_view view) {
+        if (view.size() <= internal_size) {
+            return temporary_buffer(reinterpret_cast<const CharType*>(view.data()), view.size());
+        }
         void* ptr = ::malloc(view.size());
         if (!ptr) {
             throw std::bad_alloc();
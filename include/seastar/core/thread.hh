@@ -80,12 +80,46 @@ public:
     std::optional<seastar::scheduling_group> sched_group;
     // For stack_size 0, a default value will be used (128KiB when writing this comment)
     size_t stack_size = 0;
+    // When non-zero, the thread carries a bump arena of this many bytes
+    // for per-operation temporaries, see thread_arena_allocator.
+    size_t arena_size = 0;
 };
 
 
 /// \cond internal
 extern thread_local jmp_buf_link g_unthreaded_context;
 
+namespace internal {
+
+// A bump allocator attached to a seastar::thread: like the stack, but for
+// dynamic sizes. Allocation moves a pointer, deallocation is a no-op; the
+// whole arena is recycled when the thread exits or via thread::reset_arena().
+class thread_arena {
+    std::unique_ptr<char[]> _mem;
+    size_t _size;
+    size_t _used = 0;
+public:
+    explicit thread_arena(size_t size) : _mem(new char[size]), _size(size) {}
+    void* alloc(size_t n, size_t align) noexcept {
+        auto offset = (_used + align - 1) & ~(align - 1);
+        if (offset + n > _size) {
+            return nullptr;
+        }
+        _used = offset + n;
+        return _mem.get() + offset;
+    }
+    bool owns(const void* p) const noexcept {
+        return p >= _mem.get() && p < _mem.get() + _size;
+    }
+    void reset() noexcept { _used = 0; }
+};
+
+// The arena of the currently running seastar::thread, or nullptr when not
+// in a thread or the thread was created without one.
+thread_arena* current_thread_arena() noexcept;
+
+}
+
 // Internal class holding thread state.  We can't hold this in
 // \c thread itself because \c thread is movable, and we want pointers
 // to this state to be captured.
@@ -100,6 +134,7 @@ class thread_context final : private task {
     stack_holder _stack;
     noncopyable_function<void ()> _func;
     jmp_buf_link _context;
+    std::unique_ptr<internal::thread_arena> _arena;
     promise<> _done;
     bool _joined = false;
 
@@ -124,7 +159,11 @@ public:
     bool should_yield() const;
     void reschedule();
     void yield();
+    // Re-tags this thread with a new scheduling group and requeues it
+    // there; returns once the thread resumes from the new group's queue.
+    void migrate_to(scheduling_group sg);
     task* waiting_task() noexcept override { return _done.waiting_task(); }
+    internal::thread_arena* arena() const noexcept { return _arena.get(); }
     friend class thread;
     friend void thread_impl::switch_in(thread_context*);
     friend void thread_impl::switch_out(thread_context*);
@@ -193,6 +232,56 @@ public:
     static bool running_in_thread() {
         return thread_impl::get() != nullptr;
     }
+
+    /// \brief Recycles the current thread's bump arena.
+    ///
+    /// Invalidates every allocation made through \ref thread_arena_allocator
+    /// in this thread; the caller must ensure none of them are still live.
+    /// Typically called between items of a batch job, so each item's
+    /// temporaries are freed in one pointer reset. Does nothing when the
+    /// thread has no arena (see thread_attributes::arena_size).
+    static void reset_arena() noexcept;
+};
+
+/// \brief Allocator adaptor for a seastar::thread's bump arena.
+///
+/// When used inside a \ref seastar::thread created with a non-zero
+/// thread_attributes::arena_size, allocations are served by moving a
+/// pointer in the thread's arena and deallocation is a no-op — like the
+/// stack, but for dynamic sizes. Outside a thread, without an arena, or
+/// when the arena is full, it falls back to the global allocator.
+///
+/// Arena-backed storage is reclaimed only when the thread exits or
+/// \ref thread::reset_arena() is called, so objects allocated through the
+/// adaptor must not outlive either, and must be destroyed (not just
+/// abandoned) in the thread that allocated them.
+template <typename T>
+class thread_arena_allocator {
+public:
+    using value_type = T;
+    thread_arena_allocator() noexcept = default;
+    template <typename U>
+    thread_arena_allocator(const thread_arena_allocator<U>&) noexcept {}
+    T* allocate(size_t n) {
+        if (auto* arena = internal::current_thread_arena()) {
+            if (auto* p = arena->alloc(n * sizeof(T), alignof(T))) {
+                return static_cast<T*>(p);
+            }
+        }
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+    void deallocate(T* p, size_t) noexcept {
+        if (auto* arena = internal::current_thread_arena()) {
+            if (arena->owns(p)) {
+                return;
+            }
+        }
+        ::operator delete(p);
+    }
+    template <typename U>
+    bool operator==(const thread_arena_allocator<U>&) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const thread_arena_allocator<U>&) const noexcept { return false; }
 };
 
 template <typename Func>
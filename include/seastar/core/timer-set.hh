@@ -52,6 +52,7 @@ private:
     std::array<timer_list_t, n_buckets> _buckets;
     timestamp_t _last;
     timestamp_t _next;
+    duration _coalescing_window{};
 
     std::bitset<n_buckets> _non_empty_buckets;
 private:
@@ -217,7 +218,26 @@ public:
      */
     time_point get_next_timeout() const noexcept
     {
-        return time_point(duration(std::max(_last, _next)));
+        auto t = time_point(duration(std::max(_last, _next)));
+        if (_coalescing_window != duration() && _next != max_timestamp) {
+            t += _coalescing_window;
+        }
+        return t;
+    }
+
+    /**
+     * Sets the expiry coalescing window.
+     *
+     * With a non-zero window, the time point returned by get_next_timeout()
+     * is pushed past the earliest expiry by the window, so all timers
+     * expiring within it are collected by a single expire() call and their
+     * callbacks run back to back, instead of one wakeup per timer. Each
+     * timer may as a result fire up to the window later than requested.
+     * A zero window (the default) preserves precise delivery.
+     */
+    void set_coalescing_window(duration window) noexcept
+    {
+        _coalescing_window = window;
     }
 
     /**
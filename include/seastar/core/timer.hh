@@ -87,6 +87,7 @@ private:
     scheduling_group _sg;
     callback_t _callback;
     time_point _expiry;
+    time_point _deferred_expiry;
     std::optional<duration> _period;
     bool _armed = false;
     bool _queued = false;
@@ -98,6 +99,7 @@ private:
         _armed = true;
         _expired = false;
         _expiry = until;
+        _deferred_expiry = until;
         _queued = true;
     }
 public:
@@ -108,7 +110,7 @@ public:
     ///
     /// \note care should be taken when moving a timer whose callback captures `this`,
     ///       since the object pointed to by `this` may have been moved as well.
-    timer(timer&& t) noexcept : _sg(t._sg), _callback(std::move(t._callback)), _expiry(std::move(t._expiry)), _period(std::move(t._period)),
+    timer(timer&& t) noexcept : _sg(t._sg), _callback(std::move(t._callback)), _expiry(std::move(t._expiry)), _deferred_expiry(std::move(t._deferred_expiry)), _period(std::move(t._period)),
             _armed(t._armed), _queued(t._queued), _expired(t._expired) {
         _link.swap_nodes(t._link);
         t._queued = false;
@@ -195,6 +197,36 @@ public:
         }
         arm_periodic(delta);
     }
+    /// Pushes the expiration time of an armed timer further into the
+    /// future, lazily.
+    ///
+    /// Unlike rearm(), postponing to a later time point does not move the
+    /// timer within the timer wheel; the timer stays put and is quietly
+    /// re-inserted when its old position is reached. This makes the common
+    /// "bump the idle timeout on every request" pattern very cheap.
+    /// Postponing to an earlier time point falls back to rearm(), and
+    /// postponing an unarmed timer is equivalent to arm().
+    ///
+    /// \note until the lazy move happens, get_timeout() keeps reporting
+    ///       the original expiration time.
+    ///
+    /// \param until the new time when the timer expires
+    void postpone(time_point until) noexcept {
+        if (!_armed) {
+            arm(until);
+        } else if (until < _expiry) {
+            rearm(until);
+        } else {
+            _deferred_expiry = until;
+        }
+    }
+    /// Pushes the expiration time of an armed timer further into the
+    /// future, lazily, relative to now. See postpone(time_point).
+    ///
+    /// \param delta the new time when the timer expires, relative to now
+    void postpone(duration delta) noexcept {
+        postpone(Clock::now() + delta);
+    }
     /// Returns whether the timer is armed
     ///
     /// \return `true` if the timer is armed and has not expired yet.
@@ -0,0 +1,50 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB
+ */
+
+#pragma once
+
+#include <seastar/core/future.hh>
+#include <seastar/core/sstring.hh>
+
+namespace seastar {
+
+/// \file
+/// Lightweight per-shard binary event tracing.
+///
+/// The reactor records microsecond-resolution events (task execution,
+/// I/O dispatch and completion, sleep transitions) into a fixed-size
+/// per-shard ring buffer that overwrites its oldest entries. Tracing
+/// is compiled in unconditionally and costs one branch per probe point
+/// while disabled.
+
+/// Enables or disables event tracing on the calling shard. Enabling
+/// allocates the ring buffer on first use.
+void set_tracing_enabled(bool enabled);
+
+/// Returns whether event tracing is active on the calling shard.
+bool tracing_enabled() noexcept;
+
+/// Writes the calling shard's trace ring to \c path in the binary
+/// format understood by scripts/trace2chrome.py, which merges dumps
+/// from several shards into Chrome trace format.
+future<> dump_trace(sstring path);
+
+}
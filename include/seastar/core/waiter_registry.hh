@@ -0,0 +1,98 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB
+ */
+
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <vector>
+#include <seastar/core/future.hh>
+#include <seastar/core/shared_ptr.hh>
+#include <seastar/core/sstring.hh>
+
+namespace seastar {
+
+/// \addtogroup fiber-module
+/// @{
+
+/// One instrumented synchronization primitive in this shard's waiter
+/// registry, as reported by \ref dump_waiter_registry().
+struct waiter_registry_entry {
+    /// The primitive's type: "semaphore", "gate", "shared_mutex" or "queue".
+    const char* kind;
+    /// The tag the primitive was instrumented with.
+    sstring name;
+    /// Number of fibers currently waiting on it.
+    size_t waiters;
+    /// How long the oldest current waiter has been waiting.
+    std::chrono::steady_clock::duration oldest_waiter_age;
+};
+
+namespace internal {
+
+/// \cond internal
+
+// Per-object bookkeeping behind the waiter registry. Owned by the
+// instrumented primitive via lw_shared_ptr; tracked wait futures keep a
+// reference too, so a waiter resolving after the primitive was destroyed
+// does not touch freed memory.
+class waiter_tracker {
+    const char* _kind;
+    sstring _name;
+    // Wait start times in arrival order. Waits completing out of FIFO
+    // order (timeouts, aborts) make the reported ages approximate.
+    std::deque<std::chrono::steady_clock::time_point> _waits;
+public:
+    waiter_tracker(const char* kind, sstring name);
+    ~waiter_tracker();
+    waiter_tracker(const waiter_tracker&) = delete;
+    waiter_tracker& operator=(const waiter_tracker&) = delete;
+    const char* kind() const noexcept { return _kind; }
+    const sstring& name() const noexcept { return _name; }
+    size_t waiters() const noexcept { return _waits.size(); }
+    std::chrono::steady_clock::duration oldest_waiter_age() const noexcept;
+    void on_wait() noexcept;
+    void on_wake() noexcept;
+};
+
+// Wraps a wait future so the tracker sees the waiter until the future
+// resolves, however it resolves.
+inline future<> track_wait(const lw_shared_ptr<waiter_tracker>& tracker, future<> f) noexcept {
+    tracker->on_wait();
+    return f.finally([tracker] { tracker->on_wake(); });
+}
+
+/// \endcond
+
+}
+
+/// Returns the instrumented primitives on this shard that currently have
+/// waiters, longest-stuck first.
+///
+/// Primitives opt in individually via their \c track_waiters(name)
+/// method; untagged primitives cost nothing and do not appear here. See
+/// \ref httpd::add_waiter_registry_routes() for exposing the dump over
+/// HTTP.
+std::vector<waiter_registry_entry> dump_waiter_registry();
+
+/// @}
+
+}
@@ -22,10 +22,12 @@
 
 #pragma once
 
+#include <seastar/core/align.hh>
 #include <seastar/core/future.hh>
 #include <seastar/core/loop.hh>
 #include <seastar/util/tuple_utils.hh>
 #include <seastar/util/critical_alloc_section.hh>
+#include <algorithm>
 #include <cstddef>
 #include <exception>
 #include <tuple>
@@ -470,6 +472,102 @@ struct extract_values_from_futures_vector<future<>> {
     }
 };
 
+// Flattened state for the iterator version of when_all_succeed(): the
+// countdown, the promise and one continuation slot per unready sub-future
+// all live in a single allocation sized at call time, instead of chaining
+// a separate continuation per future. The sub-futures themselves stay in
+// the vector the caller's range was collected into, which doubles as the
+// result storage.
+template <typename ResolvedVectorTransform, typename Future>
+class when_all_vector_state final {
+    using promise_type = typename ResolvedVectorTransform::future_type::promise_type;
+
+    class component final : public continuation_base_from_future_t<Future> {
+        when_all_vector_state* _base;
+        Future* _final_resting_place;
+    public:
+        component(when_all_vector_state* base, Future* future) noexcept : _base(base), _final_resting_place(future) {}
+        task* waiting_task() noexcept override { return _base->_p.waiting_task(); }
+        virtual void run_and_dispose() noexcept override {
+            using futurator = futurize<Future>;
+            if (__builtin_expect(this->_state.failed(), false)) {
+                *_final_resting_place = futurator::make_exception_future(std::move(this->_state).get_exception());
+            } else {
+                *_final_resting_place = futurator::from_tuple(std::move(this->_state).get_value());
+            }
+            auto base = _base;
+            this->~component();
+            base->complete_one();
+        }
+    };
+
+    std::vector<Future> _futures;
+    size_t _nr_remain;
+    promise_type _p;
+
+    when_all_vector_state(std::vector<Future> futures, size_t nr_remain) noexcept
+            : _futures(std::move(futures)), _nr_remain(nr_remain) {
+    }
+
+    // The component slots follow the state in the same allocation.
+    component* components() noexcept {
+        return reinterpret_cast<component*>(align_up(reinterpret_cast<uintptr_t>(this + 1), uintptr_t(alignof(component))));
+    }
+
+    void complete_one() noexcept {
+        // No atomics needed: sub-futures complete on the owning shard only.
+        if (--_nr_remain) {
+            return;
+        }
+        auto p = std::move(_p);
+        auto futures = std::move(_futures);
+        this->~when_all_vector_state();
+        ::operator delete(this);
+        ResolvedVectorTransform::run(std::move(futures)).forward_to(std::move(p));
+    }
+public:
+    static typename ResolvedVectorTransform::future_type wait_all(std::vector<Future> futures) noexcept {
+        size_t nr_unready = std::count_if(futures.begin(), futures.end(), [] (const Future& f) { return !f.available(); });
+        if (!nr_unready) {
+            return ResolvedVectorTransform::run(std::move(futures));
+        }
+        auto state = [&] () noexcept {
+            memory::scoped_critical_alloc_section _;
+            auto mem = ::operator new(sizeof(when_all_vector_state) + nr_unready * sizeof(component) + alignof(component));
+            return new (mem) when_all_vector_state(std::move(futures), nr_unready);
+        }();
+        auto ret = state->_p.get_future();
+        // Nothing can complete the sub-futures while we register the
+        // continuations, so the count taken above stays accurate.
+        auto slot = state->components();
+        for (auto& f : state->_futures) {
+            if (!f.available()) {
+                auto c = new (slot++) component(state, &f);
+                set_callback(std::move(f), c);
+            }
+        }
+        return ret;
+    }
+};
+
+template<typename ResolvedVectorTransform, typename FutureIterator>
+inline auto
+do_when_all_succeed(FutureIterator begin, FutureIterator end) noexcept {
+    using itraits = std::iterator_traits<FutureIterator>;
+    auto make_values_vector = [] (size_t size) noexcept {
+        memory::scoped_critical_alloc_section _;
+        std::vector<typename itraits::value_type> ret;
+        ret.reserve(size);
+        return ret;
+    };
+    std::vector<typename itraits::value_type> ret =
+            make_values_vector(iterator_range_estimate_vector_capacity(begin, end, typename itraits::iterator_category()));
+    // Important to invoke the *begin here, in case it's a function iterator,
+    // so we launch all computation in parallel.
+    std::move(begin, end, std::back_inserter(ret));
+    return when_all_vector_state<ResolvedVectorTransform, typename itraits::value_type>::wait_all(std::move(ret));
+}
+
 template<typename... Futures>
 SEASTAR_CONCEPT( requires seastar::AllAreFutures<Futures...> )
 inline auto when_all_succeed_impl(Futures&&... futures) noexcept {
@@ -515,7 +613,7 @@ when_all_succeed(FutureIterator begin, FutureIterator end) noexcept {
     using itraits = std::iterator_traits<FutureIterator>;
     using result_transform = internal::extract_values_from_futures_vector<typename itraits::value_type>;
     try {
-        return internal::do_when_all<result_transform>(std::move(begin), std::move(end));
+        return internal::do_when_all_succeed<result_transform>(std::move(begin), std::move(end));
     } catch (...) {
         return result_transform::current_exception_as_future();
     }
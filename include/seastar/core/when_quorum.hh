@@ -0,0 +1,189 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (C) 2026 ScyllaDB
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+#include <seastar/core/abort_source.hh>
+#include <seastar/core/future.hh>
+#include <seastar/core/shared_ptr.hh>
+
+namespace seastar {
+
+/// \addtogroup future-util
+/// @{
+
+/// The result of \ref when_quorum(): the values of the first \c quorum
+/// input futures to succeed, stored contiguously in completion order,
+/// and the positions in the input range they came from.
+template <typename T>
+struct when_quorum_result {
+    std::vector<T> values;
+    std::vector<std::size_t> indices;
+};
+
+template <>
+struct when_quorum_result<void> {
+    std::vector<std::size_t> indices;
+};
+
+namespace internal {
+
+// future<>::value_type is monostate, not void; map it back so
+// when_quorum() of void futures produces a value-less result.
+template <typename Future>
+using when_quorum_value_type =
+        std::conditional_t<std::is_same_v<typename Future::value_type, monostate>, void, typename Future::value_type>;
+
+template <typename T>
+class quorum_waiter {
+    using result_type = when_quorum_result<T>;
+    promise<result_type> _promise;
+    result_type _result;
+    std::size_t _quorum;
+    std::size_t _max_failures;
+    std::size_t _failures = 0;
+    bool _done = false;
+    abort_source* _cancel;
+private:
+    template <typename Finish>
+    void finish(Finish&& fin) {
+        _done = true;
+        fin();
+        if (_cancel && !_cancel->abort_requested()) {
+            _cancel->request_abort();
+        }
+    }
+    void record(std::size_t index) {
+        _result.indices.push_back(index);
+        if (_result.indices.size() == _quorum) {
+            finish([this] { _promise.set_value(std::move(_result)); });
+        }
+    }
+public:
+    quorum_waiter(std::size_t quorum, std::size_t total, abort_source* cancel)
+            : _quorum(quorum), _max_failures(total - quorum), _cancel(cancel) {
+        _result.indices.reserve(quorum);
+        if constexpr (!std::is_void_v<T>) {
+            _result.values.reserve(quorum);
+        }
+        if (quorum == 0) {
+            // An empty quorum is decided before any input resolves.
+            finish([this] { _promise.set_value(std::move(_result)); });
+        }
+    }
+    template <typename U = T>
+    std::enable_if_t<!std::is_void_v<U>> succeed(std::size_t index, U value) {
+        if (_done) {
+            // A late success past the quorum; dropping the value here
+            // releases its memory as soon as the loser resolves.
+            return;
+        }
+        _result.values.push_back(std::move(value));
+        record(index);
+    }
+    template <typename U = T>
+    std::enable_if_t<std::is_void_v<U>> succeed(std::size_t index) {
+        if (_done) {
+            return;
+        }
+        record(index);
+    }
+    void fail(std::exception_ptr ex) {
+        if (_done) {
+            return;
+        }
+        if (_failures++ == _max_failures) {
+            // Not enough futures are left for the quorum to succeed;
+            // report the failure that sealed it.
+            finish([&] { _promise.set_exception(std::move(ex)); });
+        }
+    }
+    future<result_type> get_future() {
+        return _promise.get_future();
+    }
+};
+
+} // namespace internal
+
+/// Waits for a quorum of futures to succeed.
+///
+/// Resolves as soon as \c quorum of the input futures resolve
+/// successfully, with their values stored contiguously in completion
+/// order, or fails as soon as enough inputs have failed to make the
+/// quorum impossible, with the exception that sealed the outcome.
+/// Unlike \ref when_all(), the remaining futures are not awaited:
+/// they keep running detached and their results are dropped as each
+/// one resolves, so memory held by the losers is released without
+/// waiting for the whole set.
+///
+/// If \c cancel is provided, \c cancel->request_abort() is called when
+/// the outcome is decided. Callers that wire the abort source into the
+/// I/O behind the remaining futures (e.g. via \c io_intent) get the
+/// losers cancelled instead of merely ignored.
+///
+/// \param begin an \c InputIterator designating the beginning of the range of futures
+/// \param end an \c InputIterator designating the end of the range of futures
+/// \param quorum the number of successful futures to wait for; must not
+///        exceed the size of the range
+/// \param cancel an optional abort source to trigger once the outcome is decided
+/// \return a \ref when_quorum_result with the quorum's values and input positions
+template <class FutureIterator>
+SEASTAR_CONCEPT( requires requires (FutureIterator i) { { *i++ }; requires is_future<std::remove_reference_t<decltype(*i)>>::value; } )
+auto when_quorum(FutureIterator begin, FutureIterator end, std::size_t quorum, abort_source* cancel = nullptr) noexcept
+  -> future<when_quorum_result<internal::when_quorum_value_type<std::decay_t<typename std::iterator_traits<FutureIterator>::value_type>>>>
+{
+    using future_type = std::decay_t<typename std::iterator_traits<FutureIterator>::value_type>;
+    using value_type = internal::when_quorum_value_type<future_type>;
+    using result_type = when_quorum_result<value_type>;
+    std::size_t total = std::distance(begin, end);
+    if (quorum > total) {
+        // Consume the inputs anyway so no future is abandoned.
+        for (auto it = begin; it != end; ++it) {
+            (void)it->then_wrapped([] (future_type f) { f.ignore_ready_future(); });
+        }
+        return make_exception_future<result_type>(std::invalid_argument("when_quorum: quorum exceeds the number of futures"));
+    }
+    auto waiter = make_lw_shared<internal::quorum_waiter<value_type>>(quorum, total, cancel);
+    std::size_t index = 0;
+    for (auto it = begin; it != end; ++it) {
+        (void)it->then_wrapped([waiter, index] (future_type f) {
+            if (f.failed()) {
+                waiter->fail(f.get_exception());
+            } else if constexpr (std::is_void_v<value_type>) {
+                f.ignore_ready_future();
+                waiter->succeed(index);
+            } else {
+                waiter->succeed(index, f.get0());
+            }
+        });
+        index++;
+    }
+    return waiter->get_future();
+}
+
+/// @}
+
+} // namespace seastar
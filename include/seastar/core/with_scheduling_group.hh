@@ -68,6 +68,20 @@ with_scheduling_group(scheduling_group sg, Func func, Args&&... args) noexcept {
     using futurator = futurize<return_type>;
     if (sg.active()) {
         return futurator::invoke(func, std::forward<Args>(args)...);
+    } else if (sg.may_run_immediately()) {
+        // Inline switch: run under the target group right away instead of
+        // round-tripping through its task queue. Continuations created by
+        // func are tagged with sg, and the time spent is charged to it.
+        auto prev = current_scheduling_group();
+        *internal::current_scheduling_group_ptr() = sg;
+        auto start = sched_clock::now();
+        // Any exception is captured in the returned future, so the group
+        // is always restored below
+        auto f = futurator::invoke(func, std::forward<Args>(args)...);
+        auto runtime = sched_clock::now() - start;
+        *internal::current_scheduling_group_ptr() = prev;
+        internal::account_inline_group_run(prev, sg, runtime);
+        return f;
     } else {
         return internal::schedule_in_group(sg, [func = std::move(func), args = std::make_tuple(std::forward<Args>(args)...)] () mutable {
             return futurator::apply(func, std::move(args));
@@ -0,0 +1,85 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB Ltd.
+ */
+
+#pragma once
+
+#include <seastar/core/future.hh>
+#include <seastar/core/circular_buffer.hh>
+#include <seastar/core/cacheline.hh>
+#include <seastar/util/noncopyable_function.hh>
+#include <seastar/util/spinlock.hh>
+#include <atomic>
+#include <memory>
+#include <optional>
+
+namespace seastar {
+
+/// \brief Pool of shard-neutral work items shared by all shards.
+///
+/// The shared-nothing model pins every task to the shard that created it,
+/// so bursty per-shard skew can leave some shards idle while their
+/// neighbors are saturated. A work_stealing_pool holds work that was
+/// explicitly submitted as carrying no shard affinity: each shard pushes
+/// to and pops from its own queue, and a shard whose queue is empty
+/// steals a batch from the most loaded peer, so a backlog drains at the
+/// speed of the idle shards instead of the overloaded one.
+///
+/// A work item runs on whichever shard popped it and therefore must not
+/// capture references to shard-local state.
+///
+/// Create one instance and use it from all shards, for example by holding
+/// it in a std::shared_ptr distributed to a \ref sharded service.
+class work_stealing_pool {
+public:
+    using work_item = noncopyable_function<future<> ()>;
+private:
+    // Upper bound on how much of a victim's queue one steal may take;
+    // keeps a single thief from bouncing the whole backlog around.
+    static constexpr size_t steal_batch = 16;
+    struct alignas(cache_line_size) shard_queue {
+        util::spinlock lock;
+        circular_buffer<work_item> items; // guarded by lock
+        std::atomic<size_t> size = {};    // mirrors items.size(); lock-free load-balancing hint
+    };
+    std::unique_ptr<shard_queue[]> _queues;
+private:
+    std::optional<work_item> steal();
+public:
+    work_stealing_pool();
+    ~work_stealing_pool();
+
+    /// Adds a work item to the current shard's queue.
+    void submit(work_item wi);
+
+    /// Removes one work item, preferring the current shard's queue and
+    /// stealing from the most loaded peer when it is empty. Returns
+    /// \c std::nullopt when the whole pool is empty.
+    std::optional<work_item> try_get();
+
+    /// Runs work items, one at a time, until try_get() finds none.
+    future<> drain();
+
+    /// Total number of queued work items, across all shards. The value is
+    /// approximate while other shards are submitting or stealing.
+    size_t size() const noexcept;
+};
+
+}
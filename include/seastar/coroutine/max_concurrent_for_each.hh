@@ -0,0 +1,206 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2022-present ScyllaDB
+ */
+
+#pragma once
+
+#include <cassert>
+#include <ranges>
+
+#include <seastar/core/loop.hh>
+#include <seastar/core/coroutine.hh>
+
+namespace seastar::coroutine {
+
+/// Invoke a function on all elements in a range with bounded concurrency
+/// and wait for all invocations to complete in a coroutine.
+///
+/// `max_concurrent_for_each` is a windowed variant of
+/// \ref coroutine::parallel_for_each: at most \c max_concurrent invocations
+/// of \c func are in flight at any time, and a new element is consumed from
+/// the range whenever an invocation completes. Unlike `parallel_for_each`,
+/// which starts every iteration eagerly and buffers all unready futures,
+/// memory use is O(\c max_concurrent) rather than O(range size), so it is
+/// suitable for fanning out over very large ranges without hand-rolled
+/// chunking. Waiting is performed by `co_await` and returns a future.
+///
+/// If one or more of the function invocations resolve to an exception
+/// then one of the exceptions is re-thrown. No new invocations are
+/// started after a failure is observed, but all invocations already
+/// started are waited for.
+///
+/// Example
+///
+/// ```
+/// future<> flush_all(std::vector<entry>& entries) {
+///     co_await coroutine::max_concurrent_for_each(entries, 10, [] (entry& e) {
+///         return e.flush();
+///     });
+/// };
+/// ```
+///
+/// Safe for use with lambda coroutines.
+///
+/// \note max_concurrent_for_each() schedules all invocations of \c func on the
+///       current shard. If you want to run a function on all shards in parallel,
+///       have a look at \ref smp::invoke_on_all() instead.
+template <typename Func, typename Iterator, typename Sentinel>
+// constraints for Func are defined at the max_concurrent_for_each constructor
+class [[nodiscard("must co_await an max_concurrent_for_each() object")]] max_concurrent_for_each final {
+    using coroutine_handle_t = std::coroutine_handle<void>;
+
+    // One continuation frame per in-flight unready future. Completed
+    // frames are recycled through an intrusive free list rather than
+    // a vector of futures, so at most max_concurrent frames are ever
+    // allocated regardless of the range size.
+    struct waiter final : continuation_base<> {
+        max_concurrent_for_each& _outer;
+        waiter* _next_free = nullptr;
+
+        explicit waiter(max_concurrent_for_each& outer) noexcept : _outer(outer) { }
+
+        virtual void run_and_dispose() noexcept override {
+            auto& outer = _outer;
+            if (this->_state.failed()) {
+                outer._ex = std::move(this->_state).get_exception();
+            }
+            // Recycle ourselves before starting more invocations,
+            // which may immediately reattach us to a new future.
+            this->_state = {};
+            _next_free = std::exchange(outer._free, this);
+            --outer._in_flight;
+            outer.start_more();
+            if (outer._in_flight == 0) {
+                // Resuming may destroy outer (and us with it),
+                // so this must be the very last step.
+                outer._when_ready.resume();
+            }
+        }
+
+        virtual task* waiting_task() noexcept override {
+            return _outer._waiting_task;
+        }
+    };
+
+    Func _func;
+    Iterator _it;
+    Sentinel _end;
+    size_t _max_concurrent;
+    size_t _in_flight = 0;
+    waiter* _free = nullptr;
+    std::exception_ptr _ex;
+    coroutine_handle_t _when_ready;
+    task* _waiting_task = nullptr;
+
+    // Consume elements from the range until the concurrency window is
+    // full, the range is exhausted, or a failure was observed.
+    void start_more() noexcept {
+        while (_it != _end && _in_flight < _max_concurrent && !_ex) {
+            auto fut = futurize_invoke(_func, *_it);
+            ++_it;
+            if (fut.available()) {
+                if (fut.failed()) {
+                    _ex = fut.get_exception();
+                }
+            } else {
+                memory::scoped_critical_alloc_section _;
+                waiter* w = _free ? std::exchange(_free, _free->_next_free) : new waiter(*this);
+                ++_in_flight;
+                seastar::internal::set_callback(std::move(fut), w);
+            }
+        }
+    }
+
+public:
+    // clang 13.0.1 doesn't support subrange
+    // so provide also a Iterator/Sentinel based constructor.
+    // See https://github.com/llvm/llvm-project/issues/46091
+    template <typename Iterator1, typename Sentinel1, typename Func1>
+    requires (std::same_as<Sentinel, Iterator> || std::sentinel_for<Sentinel, Iterator>)
+        && std::same_as<future<>, futurize_t<std::invoke_result_t<Func, typename std::iterator_traits<Iterator>::reference>>>
+    explicit max_concurrent_for_each(Iterator1&& begin, Sentinel1&& end, size_t max_concurrent, Func1&& func) noexcept
+        : _func(std::forward<Func1>(func))
+        , _it(std::forward<Iterator1>(begin))
+        , _end(std::forward<Sentinel1>(end))
+        , _max_concurrent(max_concurrent)
+    {
+        assert(max_concurrent > 0);
+    }
+
+    template <std::ranges::range Range, typename Func1>
+    requires std::invocable<Func, std::ranges::range_reference_t<Range>>
+    explicit max_concurrent_for_each(Range&& range, size_t max_concurrent, Func1&& func) noexcept
+        : max_concurrent_for_each(std::ranges::begin(range), std::ranges::end(range), max_concurrent, std::forward<Func1>(func))
+    { }
+
+    max_concurrent_for_each(const max_concurrent_for_each&) = delete;
+
+    // Invocations only start once the object is awaited, so moving is
+    // only legal before co_await: nothing is in flight yet and no
+    // waiter frame points back at the moved-from object.
+    max_concurrent_for_each(max_concurrent_for_each&& o) noexcept
+        : _func(std::move(o._func))
+        , _it(std::move(o._it))
+        , _end(std::move(o._end))
+        , _max_concurrent(o._max_concurrent)
+    {
+        assert(o._in_flight == 0 && !o._free);
+    }
+
+    ~max_concurrent_for_each() {
+        while (_free) {
+            delete std::exchange(_free, _free->_next_free);
+        }
+    }
+
+    bool await_ready() const noexcept {
+        return _it == _end;
+    }
+
+    template <typename T>
+    bool await_suspend(std::coroutine_handle<T> h) {
+        _when_ready = h;
+        _waiting_task = &h.promise();
+        start_more();
+        if (_in_flight == 0) {
+            // Every invocation completed synchronously.
+            _waiting_task = nullptr;
+            return false;
+        }
+        return true;
+    }
+
+    void await_resume() const {
+        if (_ex) [[unlikely]] {
+            std::rethrow_exception(std::move(_ex));
+        }
+    }
+};
+
+template <typename Iterator, typename Sentinel, typename Func>
+requires (std::same_as<Sentinel, Iterator> || std::sentinel_for<Sentinel, Iterator>)
+    && std::same_as<future<>, futurize_t<std::invoke_result_t<Func, typename std::iterator_traits<Iterator>::reference>>>
+max_concurrent_for_each(Iterator begin, Sentinel end, size_t max_concurrent, Func&& func) -> max_concurrent_for_each<Func, Iterator, Sentinel>;
+
+template <std::ranges::range Range, typename Func>
+requires std::invocable<Func, std::ranges::range_reference_t<Range>>
+max_concurrent_for_each(Range&& range, size_t max_concurrent, Func&& func) -> max_concurrent_for_each<Func, std::ranges::iterator_t<Range>, std::ranges::sentinel_t<Range>>;
+
+}
@@ -0,0 +1,126 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#pragma once
+
+#include <seastar/core/coroutine.hh>
+#include <seastar/core/execution_stage.hh>
+
+namespace seastar::coroutine {
+
+/// \addtogroup execution-stages
+/// @{
+
+/// \brief An execution stage for coroutine resumptions
+///
+/// Execution stages batch calls to a plain function so that its code stays
+/// hot in the instruction cache; \ref resumption_stage does the same for
+/// coroutines. Coroutines that `co_await` the stage are suspended and
+/// queued, and later resumed back to back in a single task, so the code
+/// after the `co_await` runs in contiguous batches by type instead of
+/// interleaved with unrelated tasks.
+///
+/// Placing the await at the start of a hot coroutine effectively turns the
+/// whole coroutine into a staged call:
+///
+/// ```
+/// thread_local seastar::coroutine::resumption_stage parse_stage("parse");
+///
+/// future<request> parse(input_stream<char>& in) {
+///     co_await parse_stage();
+///     // parser code now runs batched with other parse() resumptions
+///     ...
+/// }
+/// ```
+///
+/// Like other execution stages, the queue is flushed when it grows past a
+/// threshold and whenever the reactor polls, and the flushing task runs in
+/// the stage's scheduling group, so resumed coroutines continue in that
+/// group rather than their original one. Statistics are reported the same
+/// way as for function stages, with a resumption counted as a call.
+class resumption_stage final : public execution_stage {
+    static constexpr size_t flush_threshold = 128;
+    static constexpr size_t max_queue_length = 1024;
+
+    chunked_fifo<std::coroutine_handle<>, flush_threshold> _queue;
+private:
+    virtual void do_flush() noexcept override {
+        if (_batch_tuner) {
+            _batch_tuner->batch_begin();
+        }
+        auto limit = batch_limit();
+        size_t executed = 0;
+        while (!_queue.empty()) {
+            auto h = _queue.front();
+            _queue.pop_front();
+            h.resume();
+            _stats.function_calls_executed++;
+
+            if (++executed == limit) {
+                // Leftovers are picked up when the reactor polls the stage.
+                break;
+            }
+            if (need_preempt()) {
+                _stats.tasks_preempted++;
+                break;
+            }
+        }
+        if (_batch_tuner) {
+            _batch_tuner->batch_end(executed);
+        }
+        _empty = _queue.empty();
+    }
+
+    void enqueue(std::coroutine_handle<> h) {
+        if (_queue.size() >= max_queue_length) {
+            do_flush();
+        }
+        _queue.push_back(h);
+        _empty = false;
+        _stats.function_calls_enqueued++;
+        flush();
+    }
+public:
+    class awaiter {
+        resumption_stage& _stage;
+    public:
+        explicit awaiter(resumption_stage& stage) noexcept : _stage(stage) {}
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h) {
+            _stage.enqueue(h);
+        }
+        void await_resume() noexcept {}
+    };
+
+    explicit resumption_stage(const sstring& name, scheduling_group sg = {})
+        : execution_stage(name, sg)
+    {
+        _queue.reserve(flush_threshold);
+    }
+
+    /// Returns an awaitable that suspends the calling coroutine and
+    /// resumes it in a batch together with other coroutines awaiting this
+    /// stage.
+    awaiter operator()() noexcept {
+        return awaiter(*this);
+    }
+};
+
+/// @}
+
+}
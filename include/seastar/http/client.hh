@@ -22,6 +22,7 @@
 #pragma once
 
 #include <boost/intrusive/list.hpp>
+#include <limits>
 #include <seastar/net/api.hh>
 #include <seastar/http/reply.hh>
 #include <seastar/core/iostream.hh>
@@ -54,6 +55,14 @@ class connection : public enable_shared_from_this<connection> {
     output_stream<char> _write_buf;
     hook_t _hook;
     future<> _closed;
+    // Pipelining support (driven by \ref client). Requests on one
+    // connection serialize their writes on _send_order and their
+    // reply-plus-body reads on _recv_order.
+    future<> _send_order = make_ready_future<>();
+    future<> _recv_order = make_ready_future<>();
+    unsigned _in_flight = 0;
+    bool _retired = false;   // a request on this connection failed, don't reuse
+    bool _exclusive = false; // running an Expect: 100-continue dialog, don't pipeline onto it
 
 public:
     /**
@@ -138,22 +147,44 @@ public:
  */
 
 class client {
+public:
+    using reply_handler = noncopyable_function<future<>(const reply&, input_stream<char>&& body)>;
+
+    /**
+     * \brief Pool statistics
+     *
+     * Counters describing how well the connection pool serves the
+     * request flow. All counters are monotonic except idle_connections.
+     */
+    struct stats {
+        uint64_t connections_created = 0; ///< sockets withdrawn from the factory
+        uint64_t pool_hits = 0;           ///< requests served by an idle pooled connection
+        uint64_t pipelined_requests = 0;  ///< requests pipelined onto a busy keep-alive connection
+        uint64_t connections_dropped = 0; ///< connections retired after a failed request
+        uint64_t connections_evicted = 0; ///< idle connections closed to respect the max-idle limit
+        unsigned idle_connections = 0;    ///< connections currently sitting in the pool
+    };
+
+    /// Keep any number of idle connections pooled (the default)
+    static constexpr unsigned no_idle_limit = std::numeric_limits<unsigned>::max();
+
+private:
     using connections_list_t = bi::list<connection, bi::member_hook<connection, typename connection::hook_t, &connection::_hook>, bi::constant_time_size<false>>;
 
     std::unique_ptr<connection_factory> _new_connections;
-    connections_list_t _pool;
+    unsigned _max_idle;
+    unsigned _max_pipeline;
+    connections_list_t _pool; // idle connections, most recently used at the back
+    connections_list_t _busy; // connections with requests in flight
+    unsigned _nr_idle = 0;
+    stats _stats;
 
     using connection_ptr = seastar::shared_ptr<connection>;
 
-    future<connection_ptr> get_connection();
-    future<> put_connection(connection_ptr con, bool can_cache);
-
-    template <typename Fn>
-    SEASTAR_CONCEPT( requires std::invocable<Fn, connection&> )
-    auto with_connection(Fn&& fn);
+    future<> do_make_request(connection_ptr con, request req, reply_handler handle, reply::status_type expected);
+    future<> release_connection(connection_ptr con, bool can_cache);
 
 public:
-    using reply_handler = noncopyable_function<future<>(const reply&, input_stream<char>&& body)>;
     /**
      * \brief Construct a simple client
      *
@@ -186,9 +217,15 @@ public:
      * may re-use the sockets on its own
      *
      * \param f -- the factory pointer
+     * \param max_idle_connections -- maximum number of idle keep-alive connections kept
+     *        pooled; the least recently used connection is closed when the limit is hit
+     * \param max_pipelined_requests -- maximum number of requests in flight on a single
+     *        keep-alive connection. When larger than 1 and no idle connection is
+     *        available, requests are pipelined onto the least loaded busy connection
+     *        instead of opening a new one
      *
      */
-    explicit client(std::unique_ptr<connection_factory> f);
+    explicit client(std::unique_ptr<connection_factory> f, unsigned max_idle_connections = no_idle_limit, unsigned max_pipelined_requests = 1);
 
     /**
      * \brief Send the request and handle the response
@@ -211,6 +248,13 @@ public:
      * Client must be closed before destruction unconditionally
      */
     future<> close();
+
+    /**
+     * \brief Returns the pool statistics
+     *
+     * See \ref stats for the counters' meaning
+     */
+    stats get_stats() const noexcept;
 };
 
 } // experimental namespace
@@ -33,6 +33,12 @@ output_stream<char> make_http_chunked_output_stream(output_stream<char>& out);
 // The len parameter defines the maximum number of bytes to be written. After the
 // stream is closed, the len is updated with the actual number of bytes written.
 output_stream<char> make_http_content_length_output_stream(output_stream<char>& out, size_t& len);
+// The current date in the "preferred format" of RFC 7231, Section 7.1.1.1,
+// a.k.a. IMF (Internet Message Format) fixdate, e.g.
+// "Sun, 06 Nov 1994 08:49:37 GMT". The rendered string is cached per shard
+// and re-rendered at most once per second, so it is cheap enough to stamp
+// on every response.
+const sstring& http_date();
 } // internal namespace
 } // http namespace
 
@@ -58,8 +64,8 @@ public:
         return params.find(key) != params.end();
     }
 
-    void set(const sstring& key, const sstring& value) {
-        params[key] = value;
+    void set(const sstring& key, sstring value) {
+        params[key] = std::move(value);
     }
 
     void clear() {
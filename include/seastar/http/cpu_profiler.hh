@@ -0,0 +1,46 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB
+ */
+
+#pragma once
+
+#include <seastar/http/httpd.hh>
+
+namespace seastar {
+
+namespace httpd {
+
+/// \defgroup add_cpu_profiler_routes exposes the reactor's sampling CPU
+///    profiler on the given route (defaults to /cpu_profiler).
+///
+/// GET drains the samples collected on all shards and returns them as a
+/// JSON array of per-shard objects, each listing the dropped-sample count
+/// and the retained samples (timestamp, scheduling group, task type).
+/// POST reconfigures the profiler on all shards; it accepts the optional
+/// query parameters \c enabled (true/false), \c period (cycles between
+/// samples) and \c capacity (samples retained per shard).
+/// @{
+future<> add_cpu_profiler_routes(distributed<http_server>& server, sstring route = "/cpu_profiler");
+future<> add_cpu_profiler_routes(http_server& server, sstring route = "/cpu_profiler");
+/// @}
+
+}
+
+}
@@ -51,6 +51,23 @@ public:
     virtual future<std::unique_ptr<http::reply> > handle(const sstring& path,
             std::unique_ptr<http::request> req, std::unique_ptr<http::reply> rep) = 0;
 
+    /**
+     * Handlers that return true here receive the request body via
+     * req->content_stream - an input stream over the connection's raw
+     * buffers (with chunked transfer decoding applied) - instead of having
+     * it accumulated into req->content. This bounds the memory used by a
+     * request to a single buffer, which matters for large uploads.
+     *
+     * The handler must then read the stream to eof, see
+     * http::request::content_stream. Has no effect when content streaming
+     * is already enabled server-wide with
+     * http_server::set_content_streaming().
+     * @param req the request, with headers parsed but no body read yet
+     */
+    virtual bool is_content_streamed(const http::request& req) const {
+        return false;
+    }
+
     virtual ~handler_base() = default;
 
     /**
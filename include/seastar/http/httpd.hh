@@ -34,6 +34,7 @@
 #include <seastar/util/std-compat.hh>
 #include <iostream>
 #include <algorithm>
+#include <atomic>
 #include <unordered_map>
 #include <queue>
 #include <bitset>
@@ -103,6 +104,7 @@ public:
     future<> start_response();
 
     future<bool> generate_reply(std::unique_ptr<http::request> req);
+    static void maybe_compress_reply(http::reply& rep, const sstring& accept_encoding);
     void generate_error_reply_and_close(std::unique_ptr<http::request> req, reply::status_type status, const sstring& msg, const sstring &content_type={});
 
     future<> write_body();
@@ -121,16 +123,19 @@ class http_server {
     uint64_t _read_errors = 0;
     uint64_t _respond_errors = 0;
     shared_ptr<seastar::tls::server_credentials> _credentials;
-    sstring _date = http_date();
-    timer<> _date_format_timer { [this] {_date = http_date();} };
     size_t _content_length_limit = std::numeric_limits<size_t>::max();
     bool _content_streaming = false;
+    bool _content_compression = false;
     gate _task_gate;
+    // load reporting for connection-distribution balancing, see publish_load()
+    std::atomic<unsigned>* _load_slot = nullptr;
+    uint64_t _requests_sampled = 0;
+    unsigned _smoothed_request_rate = 0;
+    timer<> _load_sample_timer { [this] { sample_load(); } };
 public:
     routes _routes;
     using connection = seastar::httpd::connection;
     explicit http_server(const sstring& name) : _stats(*this, name) {
-        _date_format_timer.arm_periodic(1s);
     }
     /*!
      * \brief set tls credentials for the server
@@ -168,12 +173,35 @@ public:
 
     void set_content_streaming(bool b);
 
+    bool get_content_compression() const;
+
+    /*!
+     * \brief enable reply body compression
+     *
+     * When enabled, reply bodies are compressed with zstd if the client's
+     * Accept-Encoding allows it and the handler did not set a
+     * Content-Encoding of its own. Streamed (chunked) replies are
+     * compressed incrementally as the handler writes them.
+     */
+    void set_content_compression(bool b);
+
     future<> listen(socket_address addr, shared_ptr<seastar::tls::server_credentials> credentials);
     future<> listen(socket_address addr, listen_options lo, shared_ptr<seastar::tls::server_credentials> credentials);
     future<> listen(socket_address addr, listen_options lo);
     future<> listen(socket_address addr);
     future<> stop();
 
+    /*!
+     * \brief periodically publish this shard's load into \c slot
+     *
+     * The server stores its current number of connections plus a smoothed
+     * requests-per-second figure into the slot, so a listening shard can
+     * dispatch new connections to the shard that is genuinely least loaded
+     * (see listen_options::shard_load_hint). The slot must stay valid until
+     * the server is stopped.
+     */
+    void publish_load(std::atomic<unsigned>& slot);
+
     future<> do_accepts(int which, bool tls = false);
 
     uint64_t total_connections() const;
@@ -182,10 +210,13 @@ public:
     uint64_t read_errors() const;
     uint64_t reply_errors() const;
     // Write the current date in the specific "preferred format" defined in
-    // RFC 7231, Section 7.1.1.1.
+    // RFC 7231, Section 7.1.1.1. Delegates to the per-shard cached date in
+    // http::internal::http_date().
     static sstring http_date();
 private:
     future<> do_accept_one(int which, bool tls);
+    void sample_load();
+    void update_load() noexcept;
     boost::intrusive::list<connection> _connections;
     friend class seastar::httpd::connection;
     friend class http_server_tester;
@@ -212,9 +243,14 @@ public:
  *              });
  */
 class http_server_control {
+    // per-shard load figures published by the servers, consulted by the
+    // listening shard when distributing new connections; declared before
+    // _server_dist so it outlives the listeners holding a pointer to it
+    std::unique_ptr<std::atomic<unsigned>[]> _shard_load;
     std::unique_ptr<distributed<http_server>> _server_dist;
 private:
     static sstring generate_server_name();
+    future<> publish_shard_load(listen_options& lo);
 public:
     http_server_control() : _server_dist(new distributed<http_server>) {
     }
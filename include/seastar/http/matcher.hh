@@ -78,6 +78,22 @@ public:
 
     virtual size_t match(const sstring& url, size_t ind, parameters& param)
             override;
+
+    /**
+     * The parameter name, used as the key in the parameters object
+     * @return the parameter name
+     */
+    const sstring& name() const {
+        return _name;
+    }
+
+    /**
+     * Check if the matcher consumes the remainder of the url
+     * @return true when the match extends until the end of the url
+     */
+    bool entire_path() const {
+        return _entire_path;
+    }
 private:
     sstring _name;
     bool _entire_path;
@@ -101,6 +117,14 @@ public:
 
     virtual size_t match(const sstring& url, size_t ind, parameters& param)
             override;
+
+    /**
+     * The fixed string the matcher compares against
+     * @return the string to match
+     */
+    const sstring& str() const {
+        return _cmp;
+    }
 private:
     sstring _cmp;
     unsigned _len;
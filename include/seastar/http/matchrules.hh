@@ -112,6 +112,22 @@ public:
         return *this;
     }
 
+    /**
+     * The matchers composing this rule, in match order
+     * @return the matcher list
+     */
+    const std::vector<matcher*>& matchers() const {
+        return _match_list;
+    }
+
+    /**
+     * The handler the rule resolves to
+     * @return the handler
+     */
+    handler_base* get_handler() const {
+        return _handler;
+    }
+
 private:
     std::vector<matcher*> _match_list;
     handler_base* _handler;
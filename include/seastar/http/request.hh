@@ -32,7 +32,10 @@
 
 #include <seastar/core/iostream.hh>
 #include <seastar/core/sstring.hh>
+#include <seastar/core/temporary_buffer.hh>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <strings.h>
 #include <seastar/http/common.hh>
@@ -55,16 +58,82 @@ struct request {
     };
 
     struct case_insensitive_cmp {
-        bool operator()(const sstring& s1, const sstring& s2) const {
+        using is_transparent = void;
+        bool operator()(std::string_view s1, std::string_view s2) const {
             return std::equal(s1.begin(), s1.end(), s2.begin(), s2.end(),
                     [](char a, char b) { return ::tolower(a) == ::tolower(b); });
         }
     };
 
     struct case_insensitive_hash {
-        size_t operator()(sstring s) const {
-            std::transform(s.begin(), s.end(), s.begin(), ::tolower);
-            return std::hash<sstring>()(s);
+        using is_transparent = void;
+        size_t operator()(std::string_view s) const {
+            // FNV-1a over the lower-cased characters, so hashing does not
+            // need a lower-cased copy of the input
+            uint64_t h = 0xcbf29ce484222325ull;
+            for (char c : s) {
+                h = (h ^ uint8_t(::tolower(c))) * 0x100000001b3ull;
+            }
+            return h;
+        }
+    };
+
+    /**
+     * A flat open-addressing table of headers whose names and values are
+     * views into the connection buffers retained in _header_buffers. It is
+     * filled by the request parser when borrowed-header mode is enabled
+     * (see http_request_parser::set_borrow_headers()), making header
+     * parsing allocation-free apart from the table itself. Headers that
+     * cannot be borrowed — a name or value spanning two buffers, or a
+     * repeated name whose values must be comma-combined — go to _headers
+     * instead, so lookups must consult both tables; get_header() does.
+     */
+    class borrowed_header_table {
+        struct entry {
+            std::string_view name;
+            std::string_view value;
+        };
+        // power-of-two number of slots; an entry with a null name is vacant
+        std::vector<entry> _slots;
+        size_t _size = 0;
+    private:
+        void rehash();
+    public:
+        /**
+         * Adds a header to the table. The caller must keep the memory the
+         * views point into alive for the lifetime of the table.
+         * @return whether the header was added; false if the name is
+         *         already present, in which case the table is unchanged
+         */
+        bool insert(std::string_view name, std::string_view value);
+        /**
+         * Search for a header of a given name (case-insensitive)
+         * @return a pointer to the header value, valid until the table is
+         *         modified, or nullptr if there is no such header
+         */
+        const std::string_view* find(std::string_view name) const noexcept;
+        /**
+         * Removes a header of a given name from the table
+         * @return the removed header's value, if it was present
+         */
+        std::optional<std::string_view> extract(std::string_view name);
+        size_t size() const noexcept {
+            return _size;
+        }
+        bool empty() const noexcept {
+            return _size == 0;
+        }
+        /**
+         * Invokes func(name, value) for each header in the table, in
+         * unspecified order
+         */
+        template <typename Func>
+        void for_each(Func&& func) const {
+            for (auto& e : _slots) {
+                if (e.name.data()) {
+                    func(e.name, e.value);
+                }
+            }
         }
     };
 
@@ -74,6 +143,9 @@ struct request {
     ctclass content_type_class;
     size_t content_length = 0;
     std::unordered_map<sstring, sstring, case_insensitive_hash, case_insensitive_cmp> _headers;
+    borrowed_header_table borrowed_headers;
+    // buffers the views in borrowed_headers point into
+    std::vector<temporary_buffer<char>> _header_buffers;
     std::unordered_map<sstring, sstring> query_parameters;
     httpd::parameters param;
     sstring content; // server-side deprecated: use content_stream instead
@@ -96,10 +168,13 @@ struct request {
      */
     sstring get_header(const sstring& name) const {
         auto res = _headers.find(name);
-        if (res == _headers.end()) {
-            return "";
+        if (res != _headers.end()) {
+            return res->second;
         }
-        return res->second;
+        if (auto borrowed = borrowed_headers.find(name)) {
+            return sstring(borrowed->data(), borrowed->size());
+        }
+        return "";
     }
 
     /**
@@ -152,12 +227,17 @@ struct request {
 
         // TODO: handle HTTP/2.0 when it releases
 
-        auto it = _headers.find("Connection");
+        std::optional<std::string_view> connection;
+        if (auto it = _headers.find("Connection"); it != _headers.end()) {
+            connection = std::string_view(it->second);
+        } else if (auto borrowed = borrowed_headers.find("Connection")) {
+            connection = *borrowed;
+        }
         if (_version == "1.0") {
-            return it != _headers.end()
-                 && case_insensitive_cmp()(it->second, "keep-alive");
+            return connection
+                 && case_insensitive_cmp()(*connection, "keep-alive");
         } else { // HTTP/1.1
-            return it == _headers.end() || !case_insensitive_cmp()(it->second, "close");
+            return !connection || !case_insensitive_cmp()(*connection, "close");
         }
     }
 
@@ -27,6 +27,8 @@
 #include <seastar/http/reply.hh>
 
 #include <boost/program_options/variables_map.hpp>
+#include <memory>
+#include <string_view>
 #include <unordered_map>
 
 namespace seastar {
@@ -67,12 +69,70 @@ public:
 
 struct path_description;
 
+namespace internal {
+
+/**
+ * A compiled form of the registered match rules.
+ * Rules composed only of fixed strings and parameters are flattened
+ * into a trie of url segments, so finding a handler costs a single
+ * pass over the url regardless of how many routes are registered.
+ * Parameter values are captured as spans into the url while walking
+ * the trie and are copied into the parameters object only for the
+ * rule that finally matches, so a lookup does not allocate until a
+ * handler is found.
+ */
+class route_trie {
+public:
+    using rule_cookie = uint64_t;
+
+    route_trie();
+    ~route_trie();
+
+    /**
+     * Compile a rule into the trie.
+     * @param cookie the registration cookie of the rule
+     * @param rule the rule to compile
+     * @return true if the rule was compiled, false if it uses matchers
+     * the trie cannot represent, so it must be matched the generic way
+     */
+    bool add(rule_cookie cookie, const match_rule& rule);
+
+    /**
+     * Drop all compiled rules
+     */
+    void clear();
+
+    struct found {
+        handler_base* handler = nullptr;
+        rule_cookie cookie = 0;
+    };
+
+    /**
+     * Search for a handler matching the url.
+     * @param url the normalized request url
+     * @param params filled with the matched parameters on success
+     * @return the handler and its registration cookie, or a null handler
+     */
+    found find(std::string_view url, parameters& params) const;
+
+private:
+    struct node;
+    struct walk_state;
+    static constexpr unsigned max_captures = 8;
+    static bool descend(const node& n, std::string_view url, size_t pos, walk_state& state);
+    std::unique_ptr<node> _root;
+};
+
+}
+
 /**
  * routes object do the request dispatching according to the url.
  * It uses two decision mechanism exact match, if a url matches exactly
  * (an optional leading slash is permitted) it is choosen
  * If not, the matching rules are used.
- * matching rules are evaluated by their insertion order
+ * rules are compiled into a trie of url segments when registered, so
+ * the match cost does not grow with the number of rules; rules using
+ * custom matchers are evaluated by their insertion order after the trie
  */
 class routes {
 public:
@@ -106,7 +166,7 @@ public:
      * @return it self
      */
     routes& add(match_rule* rule, operation_type type = GET) {
-        _rules[type][_rover++] = rule;
+        add_cookie(rule, type);
         return *this;
     }
 
@@ -160,6 +220,13 @@ public:
     handler_base* get_handler(operation_type type, const sstring& url,
             parameters& params);
 
+    /**
+     * Search and return a handler matching a request, normalizing its url
+     * @param req the request; its path parameters are filled on a match
+     * @return the handler if one exists or nullptr otherwise
+     */
+    handler_base* get_handler(http::request& req);
+
 private:
     /**
      * Normalize the url to remove the last / if exists
@@ -176,8 +243,19 @@ public:
 private:
     rule_cookie _rover = 0;
     std::map<rule_cookie, match_rule*> _rules[NUM_OPERATION];
+    internal::route_trie _trie[NUM_OPERATION];
+    // rules that could not be compiled into the trie, searched in
+    // registration order
+    std::map<rule_cookie, match_rule*> _fallback_rules[NUM_OPERATION];
     //default Handler -- for any HTTP Method and Path (/*)
     handler_base* _default_handler = nullptr;
+
+    /**
+     * Recompile the trie and the fallback list of an operation from
+     * the registered rules
+     * @param type the operation type
+     */
+    void rebuild_trie(operation_type type);
 public:
     using exception_handler_fun = std::function<std::unique_ptr<http::reply>(std::exception_ptr eptr)>;
     using exception_handler_id = size_t;
@@ -222,11 +300,7 @@ public:
      * @param type the operation type
      * @return a cookie using which the rule can be removed
      */
-    rule_cookie add_cookie(match_rule* rule, operation_type type) {
-        auto pos = _rover++;
-        _rules[type][pos] = rule;
-        return pos;
-    }
+    rule_cookie add_cookie(match_rule* rule, operation_type type);
 
     /**
      * Del a rule by cookie
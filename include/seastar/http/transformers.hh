@@ -23,9 +23,32 @@
 
 #include <seastar/http/handlers.hh>
 #include <seastar/http/file_handler.hh>
+#include <optional>
+#include <string_view>
 
 namespace seastar {
 
+namespace http {
+namespace internal {
+
+// Returns whether an Accept-Encoding header value allows the given
+// content-coding, honoring wildcards and q=0 exclusions.
+bool accept_encoding_allows(const sstring& accept_encoding, std::string_view coding);
+
+// Wraps an output stream with streaming zstd compression. The returned
+// stream owns \c out; closing it finishes the zstd frame, flushes and
+// closes \c out. The compression context is borrowed from a per-shard
+// pool, and the compression window is capped so the per-response memory
+// footprint is bounded.
+output_stream<char> make_zstd_compressing_output_stream(output_stream<char>&& out);
+
+// One-shot compression for non-streamed reply bodies. Returns a
+// disengaged optional if compression would not shrink the content.
+std::optional<sstring> zstd_compress_oneshot(const sstring& content);
+
+} // internal namespace
+} // http namespace
+
 namespace httpd {
 
 /**
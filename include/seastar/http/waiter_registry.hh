@@ -0,0 +1,45 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB
+ */
+
+#pragma once
+
+#include <seastar/http/httpd.hh>
+
+namespace seastar {
+
+namespace httpd {
+
+/// \defgroup add_waiter_registry_routes exposes the per-shard waiter
+///    registry on the given route (defaults to /waiter_registry).
+///
+/// GET returns a JSON array of per-shard objects, each listing the
+/// instrumented primitives (see \c track_waiters() on semaphore, gate,
+/// shared_mutex and queue) that currently have waiters: kind, tag,
+/// waiter count and oldest-waiter age in milliseconds, longest-stuck
+/// first.
+/// @{
+future<> add_waiter_registry_routes(distributed<http_server>& server, sstring route = "/waiter_registry");
+future<> add_waiter_registry_routes(http_server& server, sstring route = "/waiter_registry");
+/// @}
+
+}
+
+}
@@ -22,6 +22,8 @@
 #pragma once
 
 #include <string>
+#include <string_view>
+#include <tuple>
 #include <vector>
 #include <time.h>
 #include <sstream>
@@ -79,6 +81,9 @@ public:
 
     virtual future<> write(output_stream<char>& s) const = 0;
     std::string _name;
+    // The ready-made key fragment (',"name":'), precomputed at
+    // registration so streaming an object allocates nothing per field
+    std::string _key;
     bool _mandatory;
     bool _set;
 };
@@ -355,6 +360,110 @@ std::function<future<>(output_stream<char>&&)> stream_object(T val) {
     };
 }
 
+/*!
+ * \brief binds one member of a class to its JSON key for \ref json_object_layout.
+ *
+ * The key fragment (separating comma, quoted name and colon) is
+ * precomputed when the field is constructed, so streaming an object
+ * formats nothing but the values.
+ */
+template<class Class, class T>
+struct json_layout_field {
+    T Class::*member;
+    sstring key;
+    json_layout_field(T Class::*m, std::string_view name)
+            : member(m), key(",\"" + sstring(name) + "\":") {
+    }
+};
+
+/*!
+ * \brief a compile-time description of how a class serializes to a JSON object.
+ *
+ * Unlike \ref json_base, which discovers its members through a runtime
+ * element list and virtual calls, the layout knows the members at compile
+ * time and streams them straight into an \ref output_stream with no
+ * intermediate strings. Members derived from \ref json_base_element
+ * (e.g. \ref json_element) are unwrapped and honor their set flag; any
+ * other member type is written with \ref formatter::write.
+ *
+ * Build one layout per class (typically as a function-local static) and
+ * reuse it for every object:
+ *
+ *     static const json::json_object_layout<my_obj, int, sstring> layout({
+ *             {&my_obj::id, "id"}, {&my_obj::name, "name"}});
+ *     return layout.write(out, obj);
+ */
+template<class Class, class... T>
+class json_object_layout {
+    std::tuple<json_layout_field<Class, T>...> _fields;
+public:
+    explicit json_object_layout(json_layout_field<Class, T>... fields)
+            : _fields(std::move(fields)...) {
+    }
+
+    /*!
+     * \brief stream \c obj as a JSON object.
+     *
+     * The caller must keep \c obj alive until the returned future
+     * resolves.
+     */
+    future<> write(output_stream<char>& out, const Class& obj) const {
+        return out.write("{").then([this, &out, &obj] {
+            return write_fields<0>(out, obj, true);
+        }).then([&out] {
+            return out.write("}");
+        });
+    }
+private:
+    template<size_t I>
+    future<> write_fields(output_stream<char>& out, const Class& obj, bool first) const {
+        if constexpr (I == sizeof...(T)) {
+            return make_ready_future<>();
+        } else {
+            auto& field = std::get<I>(_fields);
+            auto& value = obj.*(field.member);
+            using value_type = std::remove_reference_t<decltype(value)>;
+            if constexpr (std::is_base_of_v<json_base_element, value_type>) {
+                if (!value._set) {
+                    return write_fields<I + 1>(out, obj, first);
+                }
+            }
+            // The first written field skips the leading comma of the
+            // precomputed key fragment
+            auto skip = size_t(first);
+            return out.write(field.key.data() + skip, field.key.size() - skip).then([&out, &value] {
+                if constexpr (std::is_base_of_v<json_base_element, value_type>) {
+                    return value.write(out);
+                } else {
+                    return formatter::write(out, value);
+                }
+            }).then([this, &out, &obj] {
+                return write_fields<I + 1>(out, obj, false);
+            });
+        }
+    }
+};
+
+/*!
+ * \brief capture an object and return a serialize function streaming it
+ * through a \ref json_object_layout.
+ *
+ * The layout is captured by reference and must outlive the returned
+ * function (a static layout satisfies this naturally):
+ *
+ * return make_ready_future<json::json_return_type>(stream_object_as_json(layout, std::move(res)));
+ */
+template<class Class, class... T>
+std::function<future<>(output_stream<char>&&)> stream_object_as_json(const json_object_layout<Class, T...>& layout, Class val) {
+    return [&layout, val = std::move(val)](output_stream<char>&& s) mutable {
+        return do_with(output_stream<char>(std::move(s)), Class(std::move(val)), [&layout](output_stream<char>& s, const Class& val) {
+            return layout.write(s, val).finally([&s] {
+                return s.close();
+            });
+        });
+    };
+}
+
 }
 
 }
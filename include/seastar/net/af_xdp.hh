@@ -0,0 +1,74 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB
+ */
+
+#pragma once
+
+#include <memory>
+
+#include <seastar/util/program-options.hh>
+
+namespace seastar {
+
+namespace net {
+
+class device;
+
+/// AF_XDP device configuration.
+///
+/// AF_XDP is a kernel-bypass receive/transmit path that shares a NIC with
+/// the regular kernel stack: packets the driver's XDP program redirects to
+/// an XSK socket are delivered through memory-mapped rings into a
+/// user-registered buffer area (UMEM), without per-packet syscalls. Unlike
+/// DPDK it does not take over the device, so it can be used on shared
+/// hosts.
+///
+/// One XSK socket is bound per hardware queue; configure the NIC with as
+/// many queues as shards (e.g. `ethtool -L eth0 combined N`) for best
+/// results. An XDP program that redirects traffic to the sockets must be
+/// attached to the interface by the operator (for example the default
+/// program installed by `xdp-loader`/libxdp, or a custom filter that
+/// passes management traffic to the kernel); seastar deliberately does not
+/// load one, both to avoid a libbpf dependency and so the redirect policy
+/// stays in the operator's hands.
+struct xdp_options : public program_options::option_group {
+    /// \brief Network interface to bind AF_XDP sockets to.
+    ///
+    /// Selects the AF_XDP datapath for the native stack when set.
+    program_options::value<std::string> xdp_device;
+    /// \brief Number of hardware queues (and XSK sockets) to use.
+    ///
+    /// Default: the number of channels the NIC reports, capped at the
+    /// number of shards.
+    program_options::value<unsigned> xdp_queues;
+    /// \brief Force copy mode instead of attempting zero-copy first.
+    ///
+    /// Zero-copy requires driver support; by default it is attempted and
+    /// copy mode is used as a fallback.
+    program_options::value<bool> xdp_force_copy;
+
+    xdp_options(program_options::option_group* parent_group);
+};
+
+std::unique_ptr<device> create_xdp_net_device(const xdp_options& opts);
+
+}
+
+}
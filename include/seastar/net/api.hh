@@ -22,6 +22,7 @@
 #pragma once
 
 #include <chrono>
+#include <functional>
 #include <memory>
 #include <vector>
 #include <cstring>
@@ -118,8 +119,20 @@ public:
     socket_address local_address() const;
 
     future<udp_datagram> receive();
+    /// Receives all datagrams pending in the socket queue, up to
+    /// \c max_datagrams, with a single system call where the stack
+    /// supports it. Resolves as soon as at least one datagram is
+    /// available; the implementation may cap the batch size.
+    future<std::vector<udp_datagram>> receive_batch(size_t max_datagrams = 32);
     future<> send(const socket_address& dst, const char* msg);
     future<> send(const socket_address& dst, packet p);
+    /// Sends \c p as a train of datagrams carrying at most \c segment_size
+    /// payload bytes each. Segments share the underlying buffer, and stacks
+    /// with a segmentation path build the per-datagram headers from one
+    /// template and resolve the destination once for the whole train,
+    /// instead of paying the full per-send cost for every MTU-sized piece
+    /// of a large buffer.
+    future<> send_segmented(const socket_address& dst, packet p, size_t segment_size);
     bool is_closed() const;
     /// Causes a pending receive() to complete (possibly with an exception)
     void shutdown_input();
@@ -190,6 +203,17 @@ public:
     ///
     /// Gets an object returning data sent from the remote endpoint.
     input_stream<char> input(connected_socket_input_stream_config csisc = {});
+    /// Reads whatever has already arrived on the socket as a chain of
+    /// buffers, like \ref net::packet's fragment list.
+    ///
+    /// Waits until at least one byte is available, then delivers every
+    /// buffer the implementation can hand over without further waiting in
+    /// a single future resolution, saving a future/task round trip per
+    /// buffer compared to reading them one at a time. An empty chain
+    /// signifies the remote endpoint shut down the connection.
+    ///
+    /// Must not be mixed with reading through input() on the same socket.
+    future<std::vector<temporary_buffer<char>>> recv_batch();
     /// Gets the output stream.
     ///
     /// Gets an object that sends data to the remote endpoint.
@@ -291,6 +315,18 @@ public:
     /// Gets O_REUSEADDR option
     /// \return whether the reuseaddr option is enabled or not
     bool get_reuseaddr() const;
+    /// Chooses the congestion-control algorithm for the connection this
+    /// socket will establish. Must be called before \ref connect();
+    /// stacks without pluggable congestion control ignore the request.
+    void set_congestion_control(tcp_congestion_algorithm algo);
+    /// Requests TCP fast open for the connection this socket will
+    /// establish: \ref connect() completes immediately and the first
+    /// write carries the SYN, so a peer holding a fast-open cookie
+    /// receives it one RTT early. Connection errors then surface on the
+    /// first read or write rather than at connect(). Must be called
+    /// before \ref connect(); stacks without fast open support ignore
+    /// the request.
+    void set_fast_open(bool enabled);
     /// Stops any in-flight connection attempt.
     ///
     /// Cancels the connection attempt if it's still in progress, and
@@ -382,6 +418,16 @@ struct listen_options {
     transport proto = transport::TCP;
     int listen_backlog = 100;
     unsigned fixed_cpu = 0u;
+    // Optional per-shard load estimate, consulted by the
+    // connection_distribution load balancing algorithm in addition to its
+    // own count of the connections it dispatched to each shard. The
+    // function is called on the listening shard and must return figures
+    // that are comparable across shards (e.g. open connections plus the
+    // recent request rate); a new connection is dispatched to the shard
+    // with the lowest sum. This lets the application steer long-lived
+    // connections away from shards that are busy rather than merely
+    // popular.
+    std::function<unsigned (unsigned shard)> shard_load_hint;
     void set_fixed_cpu(unsigned cpu) {
         lba = server_socket::load_balancing_algorithm::fixed;
         fixed_cpu = cpu;
@@ -25,6 +25,8 @@
 #include <seastar/net/net.hh>
 #include <seastar/core/byteorder.hh>
 #include <seastar/net/ethernet.hh>
+#include <seastar/util/noncopyable_function.hh>
+#include <limits>
 #include <unordered_map>
 
 namespace seastar {
@@ -132,29 +134,58 @@ private:
         std::vector<promise<l2addr>> _waiters;
         timer<> _timeout_timer;
     };
+    // Resolved entries are stamped with the epoch they were learned in.
+    // The epoch advances periodically; an entry one epoch behind is still
+    // served but refreshed in the background, older entries are dropped,
+    // so a stale peer never serves forever from the cache.
+    struct table_entry {
+        l2addr mac;
+        uint64_t epoch;
+    };
+    // entries that must never age out (broadcast, our own address)
+    static constexpr uint64_t pinned_epoch = std::numeric_limits<uint64_t>::max();
+    static constexpr std::chrono::seconds epoch_period{60};
 private:
     l3addr _l3self = L3::broadcast_address();
-    std::unordered_map<l3addr, l2addr> _table;
+    std::unordered_map<l3addr, table_entry> _table;
     std::unordered_map<l3addr, resolution> _in_progress;
+    uint64_t _epoch = 0;
+    timer<> _epoch_timer;
+    noncopyable_function<future<l2addr> (const l3addr&)> _remote_resolver;
 private:
     packet make_query_packet(l3addr paddr);
     virtual future<> received(packet p) override;
     future<> handle_request(arp_hdr* ah);
     l2addr l2self() const noexcept { return _arp.l2self(); }
     void send(l2addr to, packet p);
+    void refresh(const l3addr& paddr);
 public:
     future<> send_query(const l3addr& paddr);
     explicit arp_for(arp& a) : arp_for_protocol(a, L3::arp_protocol_type()) {
-        _table[L3::broadcast_address()] = ethernet::broadcast_address();
+        _table.emplace(L3::broadcast_address(), table_entry{ethernet::broadcast_address(), pinned_epoch});
+        _epoch_timer.set_callback([this] { advance_epoch(); });
+        _epoch_timer.arm_periodic(epoch_period);
     }
     future<ethernet_address> lookup(const l3addr& addr);
     void learn(l2addr l2, l3addr l3);
     void run();
     void set_self_addr(l3addr addr) {
         _table.erase(_l3self);
-        _table[addr] = l2self();
+        _table[addr] = table_entry{l2self(), pinned_epoch};
         _l3self = addr;
     }
+    /// Ages the cache by one epoch. Driven by an internal periodic timer;
+    /// exposed so the stack can force invalidation (e.g. after a link flap).
+    void advance_epoch() noexcept {
+        ++_epoch;
+    }
+    /// Routes cache misses through another shard instead of broadcasting a
+    /// query from this one. With entries replicated to every shard on
+    /// learn, shards other than the resolving one can keep a read-only
+    /// replica and only hop on a miss.
+    void set_remote_resolver(noncopyable_function<future<l2addr> (const l3addr&)> resolver) {
+        _remote_resolver = std::move(resolver);
+    }
     friend class arp;
 };
 
@@ -204,12 +235,47 @@ public:
     arp_queue_full_error() : arp_error("ARP waiter's queue is full") {}
 };
 
+template <typename L3>
+void
+arp_for<L3>::refresh(const l3addr& paddr) {
+    if (_remote_resolver) {
+        // FIXME: future is discarded
+        (void)_remote_resolver(paddr).then([this, paddr] (l2addr hwaddr) {
+            learn(hwaddr, paddr);
+        }).handle_exception([] (std::exception_ptr) {
+            // refresh is best effort; the entry ages out if the peer is gone
+        });
+    } else {
+        // FIXME: future is discarded
+        (void)send_query(paddr);
+    }
+}
+
 template <typename L3>
 future<ethernet_address>
 arp_for<L3>::lookup(const l3addr& paddr) {
     auto i = _table.find(paddr);
     if (i != _table.end()) {
-        return make_ready_future<ethernet_address>(i->second);
+        auto& e = i->second;
+        if (e.epoch == pinned_epoch || e.epoch == _epoch) {
+            return make_ready_future<ethernet_address>(e.mac);
+        }
+        if (_epoch - e.epoch == 1) {
+            // one epoch behind: serve it, refresh in the background.
+            // Re-stamping caps the refresh rate at one per epoch; if the
+            // refresh fails the entry simply ages out later.
+            e.epoch = _epoch;
+            refresh(paddr);
+            return make_ready_future<ethernet_address>(e.mac);
+        }
+        // too old to trust, resolve from scratch
+        _table.erase(i);
+    }
+    if (_remote_resolver) {
+        return _remote_resolver(paddr).then([this, paddr] (l2addr hwaddr) {
+            learn(hwaddr, paddr);
+            return hwaddr;
+        });
     }
     auto j = _in_progress.find(paddr);
     auto first_request = j == _in_progress.end();
@@ -240,7 +306,7 @@ arp_for<L3>::lookup(const l3addr& paddr) {
 template <typename L3>
 void
 arp_for<L3>::learn(l2addr hwaddr, l3addr paddr) {
-    _table[paddr] = hwaddr;
+    _table[paddr] = table_entry{hwaddr, _epoch};
     auto i = _in_progress.find(paddr);
     if (i != _in_progress.end()) {
         auto& res = i->second;
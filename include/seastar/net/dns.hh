@@ -86,6 +86,55 @@ public:
             tcp_port, udp_port;
         std::optional<std::vector<sstring>>
             domains;
+        /**
+         * Keeps the per-nameserver connections open between queries
+         * instead of tearing them down once the last outstanding query
+         * completes. This mainly matters for queries forced over TCP
+         * (truncated replies, or \c use_tcp_query): concurrent queries
+         * are pipelined on the shared connection and matched to replies
+         * by DNS message id, so repeated lookups skip the per-burst
+         * connection setup.
+         *
+         * Disabled by default.
+         */
+        std::optional<bool>
+            keep_connections;
+        /**
+         * EDNS0 UDP payload size to advertise to the servers. Replies
+         * up to this size arrive over UDP instead of triggering the
+         * truncation-driven TCP fallback that answers larger than the
+         * classic 512-byte limit (e.g. large SRV sets) otherwise force.
+         *
+         * Unset leaves EDNS0 off.
+         */
+        std::optional<uint16_t>
+            edns_udp_payload_size;
+        /**
+         * Enables a shard-local, TTL-honoring cache of name lookups.
+         *
+         * Positive entries expire when the shortest record TTL in the
+         * answer does; failed lookups are cached for \c cache_negative_ttl.
+         * Concurrent queries for the same name are collapsed into a single
+         * c-ares round trip.
+         *
+         * Note: cached lookups query the DNS servers directly and thus
+         * bypass the hosts file.
+         *
+         * Disabled by default.
+         */
+        std::optional<bool>
+            cache;
+        /**
+         * Upper bound on how long a positive entry is cached, regardless
+         * of the record TTL. Default: 1 hour.
+         */
+        std::optional<std::chrono::seconds>
+            cache_max_ttl;
+        /**
+         * How long a failed lookup is cached. Default: 5 seconds.
+         */
+        std::optional<std::chrono::seconds>
+            cache_negative_ttl;
     };
 
     enum class srv_proto {
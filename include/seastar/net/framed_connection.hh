@@ -0,0 +1,125 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB
+ */
+
+#pragma once
+
+#include <seastar/core/iostream.hh>
+#include <seastar/core/scattered_message.hh>
+#include <seastar/core/semaphore.hh>
+#include <seastar/core/temporary_buffer.hh>
+#include <seastar/net/api.hh>
+#include <seastar/net/packet.hh>
+#include <seastar/util/noncopyable_function.hh>
+#include <deque>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+namespace seastar {
+
+namespace net {
+
+/// Raised when the peer violates the framing: a truncated frame, a
+/// header rejected by the protocol, or an over-sized payload.
+class framing_error : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+/// A frame received from the peer: the fixed-size header and the
+/// payload assembled straight from the receive buffers. Large payloads
+/// arrive from the network in several chunks, so the payload is a
+/// sequence of fragments rather than one contiguous buffer.
+struct incoming_frame {
+    temporary_buffer<char> header;
+    std::vector<temporary_buffer<char>> payload;
+    uint64_t payload_size = 0;
+};
+
+/// The frame-based connection engine generalized from the rpc
+/// connection core, for building custom wire protocols on the same
+/// plumbing instead of forking it: a one-shot negotiation exchange,
+/// frame assembly which does not linearize large payloads, and a send
+/// queue which batches concurrent send()s into scattered writes with a
+/// single flush and bounded buffering.
+///
+/// A protocol wraps a connected_socket in a framed_connection, runs
+/// its negotiation, then loops on read_frame() while any number of
+/// fibers send() frames. All methods must be called on the owning
+/// shard.
+class framed_connection {
+public:
+    struct config {
+        /// Fixed size, in bytes, of a frame header.
+        size_t header_size;
+        /// Parses a frame header and returns the number of payload
+        /// bytes following it, or nullopt to reject the frame and fail
+        /// the connection.
+        noncopyable_function<std::optional<uint64_t> (std::string_view header)> parse_header;
+        /// Frames announcing more than this many payload bytes fail the
+        /// connection; guards against corrupt or hostile length fields.
+        uint64_t max_payload_size = 16 << 20;
+        /// How many bytes of queued-but-unwritten frames send() may
+        /// buffer before making callers wait.
+        size_t send_queue_bytes = 1 << 20;
+    };
+
+    framed_connection(connected_socket fd, config cfg);
+
+    /// Exchanges fixed-size negotiation blobs: writes ours, flushes,
+    /// and reads the peer's. The returned buffer is shorter than
+    /// \c size_of_theirs if the peer closed the connection early.
+    future<temporary_buffer<char>> negotiate(temporary_buffer<char> ours, size_t size_of_theirs);
+
+    /// Reads one frame. Returns nullopt on a clean connection close
+    /// between frames; fails with \ref framing_error on a truncated
+    /// frame, a rejected header or an over-sized payload.
+    future<std::optional<incoming_frame>> read_frame();
+
+    /// Queues a frame for sending. Frames queued while a write or
+    /// flush is in progress are batched behind it and covered by one
+    /// flush. Resolves once the frame is queued, which may wait for
+    /// queue space; frames are delivered in send() order.
+    future<> send(scattered_message<char> frame);
+
+    /// Waits for queued frames to drain, then closes both directions.
+    /// Do not send() or read_frame() after (or concurrently with)
+    /// calling this.
+    future<> close();
+private:
+    future<std::vector<temporary_buffer<char>>> read_payload(uint64_t size);
+    void start_send_loop();
+
+    config _cfg;
+    connected_socket _fd;
+    input_stream<char> _in;
+    output_stream<char> _out;
+    semaphore _send_sem;
+    std::deque<packet> _send_queue;
+    bool _send_loop_active = false;
+    bool _error = false;
+    future<> _send_done = make_ready_future<>();
+};
+
+}
+
+}
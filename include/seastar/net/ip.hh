@@ -219,6 +219,7 @@ public:
     udp_channel make_channel(ipv4_addr addr);
     virtual void received(packet p, ipv4_address from, ipv4_address to) override;
     void send(uint16_t src_port, ipv4_addr dst, packet &&p);
+    void send_segments(uint16_t src_port, ipv4_addr dst, packet &&p, size_t segment_size);
     bool forward(forward_hash& out_hash_data, packet& p, size_t off) override;
     void set_queue_size(int size) { _queue_size = size; }
 
@@ -348,6 +349,14 @@ public:
     void learn(ethernet_address l2, ipv4_address l3) {
         _arp.learn(l2, l3);
     }
+    future<ethernet_address> arp_lookup(ipv4_address addr) {
+        return _arp.lookup(addr);
+    }
+    // Route this shard's ARP cache misses through another shard, see
+    // arp_for::set_remote_resolver().
+    void set_arp_remote_resolver(noncopyable_function<future<ethernet_address> (const ipv4_address&)> f) {
+        _arp.set_remote_resolver(std::move(f));
+    }
     void register_packet_provider(ipv4_traits::packet_provider_type&& func) {
         _pkt_providers.push_back(std::move(func));
     }
@@ -32,6 +32,15 @@ namespace net {
 
 uint16_t ip_checksum(const void* data, size_t len);
 
+/// Incrementally updates a ones-complement checksum after a 16-bit field
+/// covered by it changed, without re-summing the rest of the data
+/// (RFC 1624, eqn. 3). All three values are in the byte order the
+/// checksum was computed in.
+uint16_t checksum_update(uint16_t csum, uint16_t old_val, uint16_t new_val) noexcept;
+
+/// Same as above for an even-offset 32-bit field.
+uint16_t checksum_update(uint16_t csum, uint32_t old_val, uint32_t new_val) noexcept;
+
 struct checksummer {
     __int128 csum = 0;
     bool odd = false;
@@ -67,6 +76,22 @@ struct checksummer {
         sum(data);
         sum_many(rest...);
     }
+    // The folded sum accumulated so far, suitable for caching and merging
+    // into another checksummer with sum_partial(). Only meaningful when an
+    // even number of bytes was summed.
+    uint16_t partial() const {
+        return ~ntohs(get());
+    }
+    // Merges a cached partial sum (see partial()) of a block sitting at an
+    // even offset of the summed stream.
+    void sum_partial(uint16_t partial) {
+        if (odd) {
+            sum(uint8_t(partial >> 8));
+            sum(uint8_t(partial));
+        } else {
+            csum += partial;
+        }
+    }
     uint16_t get() const;
 };
 
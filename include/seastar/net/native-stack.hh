@@ -24,6 +24,7 @@
 #include <seastar/net/net.hh>
 #include <seastar/net/virtio.hh>
 #include <seastar/net/dpdk.hh>
+#include <seastar/net/af_xdp.hh>
 #include <seastar/util/program-options.hh>
 
 namespace seastar {
@@ -76,6 +77,16 @@ struct native_stack_options : public program_options::option_group {
     ///
     /// Default: \p on.
     program_options::value<std::string> lro;
+    /// \brief Delayed-ACK timeout, in milliseconds, for native TCP.
+    ///
+    /// \p 0 disables delayed acks: every received segment is acked immediately.
+    ///
+    /// Default: 200.
+    program_options::value<unsigned> tcp_delayed_ack_ms;
+    /// \brief Number of received full-sized segments that force an immediate ACK.
+    ///
+    /// Default: 2.
+    program_options::value<unsigned> tcp_delayed_ack_segments;
 
     /// Virtio configuration.
     virtio_options virtio_opts;
@@ -83,6 +94,8 @@ struct native_stack_options : public program_options::option_group {
     ///
     /// \note Unused when seastar is compiled without DPDK support.
     dpdk_options dpdk_opts;
+    /// AF_XDP configuration.
+    xdp_options xdp_opts;
 
     /// \cond internal
     bool _hugepages;
@@ -30,6 +30,7 @@
 #include <seastar/net/ethernet.hh>
 #include <seastar/net/packet.hh>
 #include <seastar/net/const.hh>
+#include <set>
 #include <unordered_map>
 
 namespace seastar {
@@ -85,6 +86,11 @@ struct hw_features {
     bool tx_tso = false;
     // Enable tx UDP fragmentation offload
     bool tx_ufo = false;
+    // Oversized tx TCP packets are accepted and segmented to mss-sized
+    // packets in software by the interface layer before they reach the
+    // device. Set by the interface as a fallback when tx_tso is off, so
+    // the TCP stack builds (up to) 64KB packets either way.
+    bool tx_gso = false;
     // Maximum Transmission Unit
     uint16_t mtu = 1500;
     // Maximun packet len when TCP/UDP offload is enabled
@@ -285,6 +291,23 @@ public:
     virtual unsigned hash2qid(uint32_t hash) {
         return hash % hw_queues_count();
     }
+    /// Reprogram the receive-side-scaling redirection table at runtime.
+    ///
+    /// Each entry maps one hash bucket to a hw queue index, so traffic can
+    /// be steered away from queues serving latency-critical shards without
+    /// a restart. The table must have \c 1 << _rss_table_bits entries, each
+    /// below hw_queues_count(). The returned future resolves once every
+    /// queue has drained the packets it received under the old mapping, so
+    /// per-flow packet ordering is preserved across the switch.
+    ///
+    /// The default implementation fails: not every backend can redirect.
+    virtual future<> update_rss_table(std::vector<uint8_t> redir_table);
+    /// Rebuild the redirection table so that no bucket points at any of
+    /// \c drained_queues, spreading their share round-robin over the
+    /// remaining queues. An empty set restores the even distribution.
+    /// Implemented on top of update_rss_table(), with the same ordering
+    /// guarantee.
+    future<> drain_rx_queues(const std::set<unsigned>& drained_queues);
     void set_local_queue(std::unique_ptr<qp> dev);
     template <typename Func>
     unsigned forward_dst(unsigned src_cpuid, Func&& hashfn) {
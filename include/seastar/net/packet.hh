@@ -36,6 +36,17 @@
 
 namespace seastar {
 
+namespace internal {
+
+// Thread-local freelist for net::packet::impl headers (impl plus its
+// trailing fragment array). Headers come and go at packet rate, so
+// the common size is served with a pointer pop instead of a general
+// allocation; oversized fragment arrays fall back to the heap.
+void* packet_impl_alloc(size_t size);
+void packet_impl_free(void* ptr) noexcept;
+
+}
+
 namespace net {
 
 struct fragment {
@@ -82,7 +93,9 @@ struct offload_info {
 class packet final {
     // enough for lots of headers, not quite two cache lines:
     static constexpr size_t internal_data_size = 128 - 16;
-    static constexpr size_t default_nr_frags = 4;
+    // Covers typical scattered RPC responses (~6 fragments) without
+    // reallocating the impl while appending.
+    static constexpr size_t default_nr_frags = 8;
 
     struct pseudo_vector {
         fragment* _start;
@@ -144,15 +157,15 @@ class packet final {
         }
         void* operator new(size_t size, size_t nr_frags = default_nr_frags) {
             assert(nr_frags == uint16_t(nr_frags));
-            return ::operator new(size + nr_frags * sizeof(fragment));
+            return internal::packet_impl_alloc(size + nr_frags * sizeof(fragment));
         }
         // Matching the operator new above
         void operator delete(void* ptr, size_t) {
-            return ::operator delete(ptr);
+            return internal::packet_impl_free(ptr);
         }
         // Since the above "placement delete" hides the global one, expose it
         void operator delete(void* ptr) {
-            return ::operator delete(ptr);
+            return internal::packet_impl_free(ptr);
         }
 
         bool using_internal_data() const noexcept {
@@ -294,7 +307,13 @@ public:
         }
         while (idx < nr_frags()) {
             auto&& f = frag(idx++);
-            func(temporary_buffer<char>(f.base, f.size, _impl->_deleter.share()));
+            if (idx == nr_frags()) {
+                // the packet is released; hand the last fragment our own
+                // reference instead of taking a new one
+                func(temporary_buffer<char>(f.base, f.size, std::move(_impl->_deleter).share()));
+            } else {
+                func(temporary_buffer<char>(f.base, f.size, _impl->_deleter.share()));
+            }
         }
     }
     std::vector<temporary_buffer<char>> release() {
@@ -477,12 +496,18 @@ packet::packet(packet&& x, deleter d)
 
 inline
 packet::packet(packet&& x, temporary_buffer<char> buf)
-    : packet(std::move(x), fragment{buf.get_write(), buf.size()}, buf.release()) {
+    : packet(std::move(x)) {
+    // Sequence release() before taking the pointer: it moves small buffers
+    // to the stable storage the deleter owns
+    auto d = buf.release();
+    *this = packet(std::move(*this), fragment{buf.get_write(), buf.size()}, std::move(d));
 }
 
 inline
-packet::packet(temporary_buffer<char> buf)
-    : packet(fragment{buf.get_write(), buf.size()}, buf.release()) {}
+packet::packet(temporary_buffer<char> buf) {
+    auto d = buf.release();
+    *this = packet(fragment{buf.get_write(), buf.size()}, std::move(d));
+}
 
 inline
 void packet::append(packet&& p) {
@@ -22,11 +22,14 @@
 #pragma once
 
 #include <seastar/core/sharded.hh>
+#include <seastar/core/circular_buffer.hh>
 #include <seastar/core/internal/pollable_fd.hh>
 #include <seastar/net/stack.hh>
 #include <seastar/core/polymorphic_temporary_buffer.hh>
 #include <seastar/core/internal/buffer_allocator.hh>
 #include <seastar/util/program-options.hh>
+#include <deque>
+#include <functional>
 
 namespace seastar {
 
@@ -40,6 +43,12 @@ using namespace seastar;
 //
 // Right now this class is used by the posix_server_socket_impl, but it could be used by any other.
 class conntrack {
+public:
+    // A per-shard load estimate supplied by the application, consulted in
+    // addition to the balancer's own per-shard connection counts, see
+    // listen_options::shard_load_hint.
+    using load_hint = std::function<unsigned (unsigned shard)>;
+private:
     class load_balancer {
         std::vector<unsigned> _cpu_load;
     public:
@@ -47,12 +56,20 @@ class conntrack {
         void closed_cpu(shard_id cpu) {
             _cpu_load[cpu]--;
         }
-        shard_id next_cpu() {
-            // FIXME: The naive algorithm will just round robin the connections around the shards.
-            // A more complex version can keep track of the amount of activity in each connection,
-            // and use that information.
-            auto min_el = std::min_element(_cpu_load.begin(), _cpu_load.end());
-            auto cpu = shard_id(std::distance(_cpu_load.begin(), min_el));
+        shard_id next_cpu(const load_hint& hint = {}) {
+            // Pick the shard with the smallest number of connections we
+            // dispatched to it, weighted by the load the application
+            // reports for it, so a few long-lived busy connections do not
+            // count the same as many idle ones.
+            auto cpu = shard_id(0);
+            auto cpu_load = uint64_t(_cpu_load[0]) + (hint ? hint(0) : 0);
+            for (shard_id i = 1; i < _cpu_load.size(); i++) {
+                auto load = uint64_t(_cpu_load[i]) + (hint ? hint(i) : 0);
+                if (load < cpu_load) {
+                    cpu_load = load;
+                    cpu = i;
+                }
+            }
             _cpu_load[cpu]++;
             return cpu;
         }
@@ -99,6 +116,9 @@ public:
     handle get_handle() {
         return handle(_lb->next_cpu(), _lb);
     }
+    handle get_handle(const load_hint& hint) {
+        return handle(_lb->next_cpu(hint), _lb);
+    }
     handle get_handle(shard_id cpu) {
         return handle(_lb->force_cpu(cpu), _lb);
     }
@@ -108,28 +128,102 @@ class posix_data_source_impl final : public data_source_impl, private internal::
     std::pmr::polymorphic_allocator<char>* _buffer_allocator;
     pollable_fd _fd;
     connected_socket_input_stream_config _config;
+    // Bytes read from the socket by a previous owner (e.g. before the
+    // connection migrated to this shard), delivered before new reads
+    temporary_buffer<char> _residue;
 private:
     virtual temporary_buffer<char> allocate_buffer() override;
 public:
     explicit posix_data_source_impl(pollable_fd fd, connected_socket_input_stream_config config,
-            std::pmr::polymorphic_allocator<char>* allocator=memory::malloc_allocator)
-            : _buffer_allocator(allocator), _fd(std::move(fd)), _config(config) {
+            std::pmr::polymorphic_allocator<char>* allocator=memory::malloc_allocator,
+            temporary_buffer<char> residue={})
+            : _buffer_allocator(allocator), _fd(std::move(fd)), _config(config), _residue(std::move(residue)) {
     }
     future<temporary_buffer<char>> get() override;
+    future<std::vector<temporary_buffer<char>>> get_chain();
     future<> close() override;
 };
 
 class posix_data_sink_impl : public data_sink_impl {
     pollable_fd _fd;
     packet _p;
+    // MSG_ZEROCOPY state. Writes of at least zerocopy_threshold bytes are
+    // sent with MSG_ZEROCOPY, which makes the kernel pin the payload pages
+    // instead of copying them into socket buffers. The payload must then
+    // stay alive until the kernel posts a completion on the socket error
+    // queue, so the packets (whose deleters own the buffers) are parked in
+    // _zc_pending until their completion arrives.
+    static constexpr size_t zerocopy_threshold = 64 * 1024;
+    enum class zerocopy_state : uint8_t { unknown, enabled, unavailable };
+    zerocopy_state _zc_state = zerocopy_state::unknown;
+    // sequence number the kernel will assign to our next MSG_ZEROCOPY send;
+    // the kernel numbers them 0, 1, 2, ... per socket
+    uint32_t _zc_next_seq = 0;
+    // highest completed sequence number (one before 0 initially)
+    uint32_t _zc_acked_seq = uint32_t(-1);
+    // in-flight sends: sequence number of the packet's last send, and the
+    // packet keeping the payload alive
+    std::deque<std::pair<uint32_t, packet>> _zc_pending;
+private:
+    bool try_enable_zerocopy() noexcept;
+    future<> put_zerocopy(packet p);
+    void process_zerocopy_completions() noexcept;
 public:
     explicit posix_data_sink_impl(pollable_fd fd) : _fd(std::move(fd)) {}
+    ~posix_data_sink_impl();
     using data_sink_impl::put;
     future<> put(packet p) override;
     future<> put(temporary_buffer<char> buf) override;
     future<> close() override;
+    bool can_sendfile() const noexcept override;
+    future<size_t> sendfile(int fd, uint64_t pos, size_t len) override;
 };
 
+/// The quiesced state of a posix connection: the raw socket file
+/// descriptor plus any bytes that were read from it but not yet consumed
+/// by the application. A handoff is movable across shards, so a live
+/// connection can be rebalanced to another shard without closing and
+/// reconnecting:
+///
+/// ```
+/// auto handoff = net::detach_connected_socket(std::move(cs), std::move(in));
+/// co_await smp::submit_to(target, [h = std::move(handoff)] () mutable {
+///     auto cs = net::attach_connected_socket(std::move(h));
+///     return serve(std::move(cs));
+/// });
+/// ```
+///
+/// The caller must quiesce the connection first: no reads or writes may
+/// be outstanding, and any \c output_stream must be flushed and detached
+/// (or closed) before detaching the socket.
+class connected_socket_handoff {
+    file_desc _fd;
+    temporary_buffer<char> _input_residue;
+
+    connected_socket_handoff(file_desc fd, temporary_buffer<char> input_residue)
+        : _fd(std::move(fd)), _input_residue(std::move(input_residue)) {}
+public:
+    connected_socket_handoff(connected_socket_handoff&&) noexcept = default;
+    connected_socket_handoff& operator=(connected_socket_handoff&&) noexcept = default;
+
+    friend connected_socket_handoff detach_connected_socket(connected_socket s, input_stream<char> in);
+    friend connected_socket attach_connected_socket(connected_socket_handoff handoff, std::pmr::polymorphic_allocator<char>* allocator);
+};
+
+/// Quiesce a posix \c connected_socket and capture its state for
+/// migration to another shard. The socket is unregistered from this
+/// shard's reactor; unconsumed bytes buffered in \c in are carried in
+/// the handoff and replayed by the reattached socket's input stream.
+///
+/// \throws std::invalid_argument if \c s is not a posix stack socket.
+connected_socket_handoff detach_connected_socket(connected_socket s, input_stream<char> in);
+
+/// Resume a migrated connection on the calling shard. Returns a
+/// \c connected_socket equivalent to the detached one; its first input
+/// stream delivers the carried-over bytes before reading from the socket.
+connected_socket attach_connected_socket(connected_socket_handoff handoff,
+        std::pmr::polymorphic_allocator<char>* allocator=memory::malloc_allocator);
+
 class posix_ap_server_socket_impl : public server_socket_impl {
     using protocol_and_socket_address = std::tuple<int, socket_address>;
     struct connection {
@@ -165,11 +259,23 @@ class posix_server_socket_impl : public server_socket_impl {
     conntrack _conntrack;
     server_socket::load_balancing_algorithm _lba;
     shard_id _fixed_cpu;
+    conntrack::load_hint _shard_load_hint;
     std::pmr::polymorphic_allocator<char>* _allocator;
+    // connections drained from the listen backlog but not yet returned
+    // from accept()
+    struct pending_accept {
+        pollable_fd fd;
+        socket_address sa;
+    };
+    circular_buffer<pending_accept> _pending;
+private:
+    std::optional<accept_result> try_dispatch(pollable_fd fd, socket_address sa);
+    void drain_accept_backlog();
 public:
     explicit posix_server_socket_impl(int protocol, socket_address sa, pollable_fd lfd,
         server_socket::load_balancing_algorithm lba, shard_id fixed_cpu,
-        std::pmr::polymorphic_allocator<char>* allocator=memory::malloc_allocator) : _sa(sa), _protocol(protocol), _lfd(std::move(lfd)), _lba(lba), _fixed_cpu(fixed_cpu), _allocator(allocator) {}
+        conntrack::load_hint shard_load_hint = {},
+        std::pmr::polymorphic_allocator<char>* allocator=memory::malloc_allocator) : _sa(sa), _protocol(protocol), _lfd(std::move(lfd)), _lba(lba), _fixed_cpu(fixed_cpu), _shard_load_hint(std::move(shard_load_hint)), _allocator(allocator) {}
     virtual future<accept_result> accept() override;
     virtual void abort_accept() override;
     virtual socket_address local_address() const override;
@@ -105,6 +105,13 @@ enum class transport {
     SCTP = IPPROTO_SCTP
 };
 
+// Congestion-control algorithm for a TCP connection. Stacks with
+// pluggable congestion control honor the selection; others ignore it.
+enum class tcp_congestion_algorithm : uint8_t {
+    new_reno,
+    bbr,
+};
+
 struct ipv4_addr {
     uint32_t ip;
     uint16_t port;
@@ -35,6 +35,7 @@ public:
     virtual ~connected_socket_impl() {}
     virtual data_source source() = 0;
     virtual data_source source(connected_socket_input_stream_config csisc);
+    virtual future<std::vector<temporary_buffer<char>>> recv_batch();
     virtual data_sink sink() = 0;
     virtual void shutdown_input() = 0;
     virtual void shutdown_output() = 0;
@@ -50,12 +51,34 @@ public:
     virtual future<> wait_input_shutdown() = 0;
 };
 
+// Gives stack implementations access to the connected_socket's impl
+// pointer, e.g. to wrap it or to tear the socket apart for migration.
+class get_impl {
+public:
+    static std::unique_ptr<connected_socket_impl> get(connected_socket s) {
+        return std::move(s._csi);
+    }
+
+    static connected_socket_impl* maybe_get_ptr(connected_socket& s) {
+        if (s._csi) {
+            return s._csi.get();
+        }
+        return nullptr;
+    }
+};
+
 class socket_impl {
 public:
     virtual ~socket_impl() {}
     virtual future<connected_socket> connect(socket_address sa, socket_address local, transport proto = transport::TCP) = 0;
     virtual void set_reuseaddr(bool reuseaddr) = 0;
     virtual bool get_reuseaddr() const = 0;
+    // Stacks with pluggable congestion control override this; others
+    // ignore the request.
+    virtual void set_congestion_control(tcp_congestion_algorithm) {}
+    // Stacks supporting TCP fast open override this; others ignore the
+    // request.
+    virtual void set_fast_open(bool) {}
     virtual void shutdown() = 0;
 };
 
@@ -73,8 +96,14 @@ public:
     virtual ~udp_channel_impl() {}
     virtual socket_address local_address() const = 0;
     virtual future<udp_datagram> receive() = 0;
+    // Stacks that can reap several datagrams per syscall override this;
+    // the default resolves with a single-datagram batch.
+    virtual future<std::vector<udp_datagram>> receive_batch(size_t max_datagrams);
     virtual future<> send(const socket_address& dst, const char* msg) = 0;
     virtual future<> send(const socket_address& dst, packet p) = 0;
+    // Stacks with a segmentation-offload path override this; the default
+    // splits the packet and sends the segments one by one.
+    virtual future<> send_segmented(const socket_address& dst, packet p, size_t segment_size);
     virtual void shutdown_input() = 0;
     virtual void shutdown_output() = 0;
     virtual bool is_closed() const = 0;
@@ -0,0 +1,300 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB
+ */
+
+#pragma once
+
+#include <seastar/core/lowres_clock.hh>
+#include <seastar/net/socket_defs.hh>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+namespace seastar {
+
+namespace net {
+
+// Per-connection congestion-control policy for the native TCP stack.
+//
+// The tcb keeps ownership of loss detection and recovery bookkeeping
+// (duplicate-ACK counting, the RFC6582 recover point, retransmission)
+// and reports the events below. The policy only answers how many bytes
+// may be in flight (window()) and, for paced policies, how many of
+// those may leave right now (pacing_allowance()).
+class tcp_congestion_control {
+public:
+    virtual ~tcp_congestion_control() {}
+    // Connection established; peer_window is the scaled receive window
+    // from the handshake.
+    virtual void on_established(uint32_t smss, uint32_t peer_window) = 0;
+    // acked_bytes of new data were acknowledged.
+    virtual void on_ack(uint32_t acked_bytes, uint32_t smss) = 0;
+    // A round-trip sample from a segment that was transmitted exactly once.
+    virtual void on_rtt_sample(std::chrono::milliseconds) {}
+    // Third duplicate ACK. entered is false if RFC6582 suppressed the
+    // retransmit because the ACK does not cover the recover point.
+    virtual void on_fast_retransmit(uint32_t flight_size, uint32_t limited_transfer, uint32_t smss, bool entered) = 0;
+    // A further duplicate ACK while in fast recovery.
+    virtual void on_dup_ack(uint32_t smss) = 0;
+    // A partial ACK in fast recovery acknowledged acked_bytes of new data.
+    virtual void on_partial_ack(uint32_t acked_bytes, uint32_t smss) = 0;
+    // An ACK covering the recover point completed fast recovery.
+    virtual void on_full_ack(uint32_t flight_size, uint32_t smss) = 0;
+    // Retransmission timeout; first is true for the first timeout of the
+    // oldest unacknowledged segment.
+    virtual void on_rto(uint32_t flight_size, uint32_t smss, bool first) = 0;
+    // bytes of new data left the tcb towards the NIC.
+    virtual void on_segment_sent(uint32_t) {}
+    // How many bytes may be in flight.
+    virtual uint32_t window() const = 0;
+    // How many of the window-permitted bytes may leave right now;
+    // unpaced policies release everything.
+    virtual uint32_t pacing_allowance(uint32_t bytes) { return bytes; }
+    // When pacing_allowance() held bytes back: the time at which the
+    // output path should be retried.
+    virtual lowres_clock::time_point pacing_replenish_time() { return lowres_clock::now(); }
+};
+
+// The classic RFC5681/RFC6582 window arithmetic that the native stack
+// has always used: slow start, congestion avoidance, and halving on
+// every loss indication.
+class tcp_new_reno final : public tcp_congestion_control {
+    // Congestion window
+    uint32_t _cwnd = 0;
+    // Slow start threshold
+    uint32_t _ssthresh = 0;
+public:
+    virtual void on_established(uint32_t smss, uint32_t peer_window) override {
+        // Setup initial congestion window per RFC3390
+        if (2190 < smss) {
+            _cwnd = 2 * smss;
+        } else if (1095 < smss && smss <= 2190) {
+            _cwnd = 3 * smss;
+        } else {
+            _cwnd = 4 * smss;
+        }
+        // Setup initial slow start threshold
+        _ssthresh = peer_window;
+    }
+    virtual void on_ack(uint32_t acked_bytes, uint32_t smss) override {
+        if (_cwnd < _ssthresh) {
+            // In slow start phase
+            _cwnd += std::min(acked_bytes, smss);
+        } else {
+            // In congestion avoidance phase
+            uint32_t round_up = 1;
+            _cwnd += std::max(round_up, smss * smss / _cwnd);
+        }
+    }
+    virtual void on_fast_retransmit(uint32_t flight_size, uint32_t limited_transfer, uint32_t smss, bool entered) override {
+        if (entered) {
+            // RFC5681 Step 3.2
+            _ssthresh = std::max((flight_size - limited_transfer) / 2, 2 * smss);
+        }
+        // RFC5681 Step 3.3
+        _cwnd = _ssthresh + 3 * smss;
+    }
+    virtual void on_dup_ack(uint32_t smss) override {
+        // RFC5681 Step 3.4
+        _cwnd += smss;
+    }
+    virtual void on_partial_ack(uint32_t acked_bytes, uint32_t smss) override {
+        // Deflate the congestion window by the amount of new data
+        // acknowledged by the Cumulative Acknowledgment field
+        _cwnd -= acked_bytes;
+        // If the partial ACK acknowledges at least one SMSS of new
+        // data, then add back SMSS bytes to the congestion window
+        if (acked_bytes >= smss) {
+            _cwnd += smss;
+        }
+    }
+    virtual void on_full_ack(uint32_t flight_size, uint32_t smss) override {
+        // Set cwnd to min (ssthresh, max(FlightSize, SMSS) + SMSS)
+        _cwnd = std::min(_ssthresh, std::max(flight_size, smss) + smss);
+    }
+    virtual void on_rto(uint32_t flight_size, uint32_t smss, bool first) override {
+        // According to RFC5681
+        // Update ssthresh only for the first retransmit
+        if (first) {
+            _ssthresh = std::max(flight_size / 2, 2 * smss);
+        }
+        // Start the slow start process
+        _cwnd = smss;
+    }
+    virtual uint32_t window() const override {
+        return _cwnd;
+    }
+};
+
+// A simplified BBR-style policy (after Cardwell et al., "BBR:
+// Congestion-Based Congestion Control"). Instead of backing off on
+// every loss indication it models the path: the delivery rate of
+// returning ACKs bounds the bottleneck bandwidth, the minimum observed
+// round-trip time bounds the propagation delay, and the window is kept
+// at a small multiple of their product. Sends are paced at the
+// estimated bottleneck rate so bursts do not overflow shallow buffers.
+// On lossy long-haul paths this avoids the repeated window collapses
+// that make NewReno throughput inversely proportional to the loss rate.
+class tcp_bbr final : public tcp_congestion_control {
+    using clock_type = lowres_clock;
+    // Length of the bottleneck-bandwidth max-filter, in delivery-rate
+    // sample periods (one period per round trip, roughly)
+    static constexpr unsigned bw_filter_len = 8;
+    // How long a min-RTT sample stays valid
+    static constexpr std::chrono::seconds min_rtt_expiry{10};
+    // The model runs off lowres_clock, so pace in one-tick quanta
+    static constexpr std::chrono::milliseconds pacing_quantum{10};
+
+    uint32_t _smss = 536;
+    uint32_t _cwnd = 0;
+    // Delivery accounting for the current sample period
+    uint64_t _delivered = 0;
+    clock_type::time_point _period_start;
+    // Max-filter over recent per-period delivery rates, in bytes/sec
+    std::array<uint64_t, bw_filter_len> _bw = {};
+    unsigned _bw_idx = 0;
+    // Windowed-min round-trip estimate
+    std::chrono::milliseconds _min_rtt{0};
+    clock_type::time_point _min_rtt_ts;
+    // Startup: grow the window like slow start until the delivery rate
+    // stops increasing
+    bool _startup = true;
+    uint64_t _full_bw = 0;
+    unsigned _full_bw_count = 0;
+    // Pacing token bucket, refilled at the estimated bottleneck rate
+    uint64_t _budget = 0;
+    clock_type::time_point _last_refill;
+
+    uint64_t max_bw() const {
+        return *std::max_element(_bw.begin(), _bw.end());
+    }
+    std::chrono::milliseconds sample_period() const {
+        return std::max(_min_rtt, std::chrono::milliseconds(pacing_quantum));
+    }
+public:
+    virtual void on_established(uint32_t smss, uint32_t) override {
+        _smss = smss;
+        // Startup window as in slow start; the bandwidth-delay product
+        // takes over once the filters have samples
+        _cwnd = 4 * smss;
+        auto now = clock_type::now();
+        _period_start = now;
+        _min_rtt_ts = now;
+        _last_refill = now;
+    }
+    virtual void on_rtt_sample(std::chrono::milliseconds rtt) override {
+        auto now = clock_type::now();
+        if (_min_rtt.count() == 0 || rtt < _min_rtt || now - _min_rtt_ts > min_rtt_expiry) {
+            _min_rtt = rtt;
+            _min_rtt_ts = now;
+        }
+    }
+    virtual void on_ack(uint32_t acked_bytes, uint32_t smss) override {
+        _smss = smss;
+        _delivered += acked_bytes;
+        auto now = clock_type::now();
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - _period_start);
+        if (elapsed >= sample_period()) {
+            // Close the sample period: ACKed bytes over elapsed time is
+            // a lower bound for the bottleneck bandwidth
+            _bw[_bw_idx] = _delivered * 1000 / elapsed.count();
+            _bw_idx = (_bw_idx + 1) % bw_filter_len;
+            _delivered = 0;
+            _period_start = now;
+            // Startup ends after three consecutive periods that did not
+            // grow the rate by at least 25%
+            if (_startup) {
+                if (max_bw() >= _full_bw + _full_bw / 4) {
+                    _full_bw = max_bw();
+                    _full_bw_count = 0;
+                } else if (++_full_bw_count >= 3) {
+                    _startup = false;
+                }
+            }
+        }
+        if (_startup || _min_rtt.count() == 0) {
+            // Probe for bandwidth the way slow start does
+            _cwnd += std::min(acked_bytes, smss);
+        } else {
+            // Steady state: two bandwidth-delay products of headroom so
+            // delayed and aggregated ACKs do not starve the pipe
+            uint64_t bdp = max_bw() * _min_rtt.count() / 1000;
+            _cwnd = std::max<uint64_t>(2 * bdp, 4 * smss);
+        }
+    }
+    virtual void on_fast_retransmit(uint32_t, uint32_t, uint32_t, bool) override {
+        // Loss is not a congestion signal for the model; the tcb's
+        // retransmit machinery handles the repair
+    }
+    virtual void on_dup_ack(uint32_t) override {
+    }
+    virtual void on_partial_ack(uint32_t, uint32_t) override {
+    }
+    virtual void on_full_ack(uint32_t, uint32_t) override {
+    }
+    virtual void on_rto(uint32_t, uint32_t smss, bool) override {
+        // A whole window was lost: restart from a modest window, but
+        // keep the path model, about which a timeout says nothing
+        _cwnd = 4 * smss;
+    }
+    virtual void on_segment_sent(uint32_t bytes) override {
+        _budget -= std::min<uint64_t>(_budget, bytes);
+    }
+    virtual uint32_t window() const override {
+        return _cwnd;
+    }
+    virtual uint32_t pacing_allowance(uint32_t bytes) override {
+        auto bw = max_bw();
+        if (_startup || bw == 0) {
+            // No usable rate estimate yet, send window-limited
+            return bytes;
+        }
+        auto now = clock_type::now();
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - _last_refill);
+        if (elapsed.count() > 0) {
+            // One quantum worth of budget per quantum of elapsed time,
+            // capped so an idle period does not accumulate into a burst
+            auto cap = std::max<uint64_t>(bw * pacing_quantum.count() / 1000, 2 * _smss);
+            _budget = std::min(_budget + bw * elapsed.count() / 1000, cap);
+            _last_refill = now;
+        }
+        return std::min<uint64_t>(bytes, _budget);
+    }
+    virtual clock_type::time_point pacing_replenish_time() override {
+        return clock_type::now() + pacing_quantum;
+    }
+};
+
+inline std::unique_ptr<tcp_congestion_control>
+make_tcp_congestion_control(tcp_congestion_algorithm algo) {
+    switch (algo) {
+    case tcp_congestion_algorithm::bbr:
+        return std::make_unique<tcp_bbr>();
+    case tcp_congestion_algorithm::new_reno:
+        break;
+    }
+    return std::make_unique<tcp_new_reno>();
+}
+
+}
+
+}
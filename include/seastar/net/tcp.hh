@@ -31,12 +31,15 @@
 #include <seastar/net/ip.hh>
 #include <seastar/net/const.hh>
 #include <seastar/net/packet-util.hh>
+#include <seastar/net/tcp-cc.hh>
 #include <seastar/util/std-compat.hh>
 #include <unordered_map>
 #include <map>
+#include <array>
 #include <functional>
 #include <deque>
 #include <chrono>
+#include <optional>
 #include <random>
 #include <stdexcept>
 #include <system_error>
@@ -326,6 +329,9 @@ private:
             uint16_t data_len;
             unsigned nr_transmits;
             clock_type::time_point tx_time;
+            // cached partial checksum of the payload; the payload does not
+            // change between transmits, so retransmits only re-sum the header
+            uint16_t payload_csum = 0;
         };
         struct send {
             tcp_seq unacknowledged;
@@ -355,10 +361,6 @@ private:
             std::chrono::milliseconds srtt;
             bool first_rto_sample = true;
             clock_type::time_point syn_tx_time;
-            // Congestion window
-            uint32_t cwnd;
-            // Slow start threshold
-            uint32_t ssthresh;
             // Duplicated ACKs
             uint16_t dupacks = 0;
             unsigned syn_retransmit = 0;
@@ -381,9 +383,24 @@ private:
             size_t data_size = 0;
             tcp_packet_merger out_of_order;
             std::optional<promise<>> _data_received_promise;
-            // The maximun memory buffer size allowed for receiving
-            // Currently, it is the same as default receive window size when window scaling is enabled
+            // The maximum memory buffer size allowed for receiving, which
+            // also bounds the advertised window. Starts at the default
+            // window size and is grown by update_rcv_buf_size() as the
+            // consumer proves it drains full windows, within the stack-wide
+            // budget.
             size_t max_receive_buf_size = 3737600;
+            // Memory reserved from the stack budget to grow
+            // max_receive_buf_size beyond its default, returned in cleanup()
+            size_t reserved_buf_mem = 0;
+            // Receiver-side round-trip estimate, measured as the time it
+            // takes the peer to fill a full receive window, see
+            // update_rcv_rtt()
+            std::chrono::milliseconds rtt{0};
+            tcp_seq rtt_seq;
+            std::optional<clock_type::time_point> rtt_ts;
+            // Bytes handed to the user since the last buffer adjustment
+            size_t bytes_consumed = 0;
+            clock_type::time_point consume_ts;
         } _rcv;
         tcp_option _option;
         timer<lowres_clock> _delayed_ack;
@@ -397,6 +414,10 @@ private:
         static constexpr uint16_t _max_nr_retransmit{5};
         timer<lowres_clock> _retransmit;
         timer<lowres_clock> _persist;
+        // Resumes output when a pacing policy withheld part of the window
+        timer<lowres_clock> _pacing_timer;
+        // Congestion-control policy; owns the cwnd/ssthresh-style state
+        std::unique_ptr<tcp_congestion_control> _cc = std::make_unique<tcp_new_reno>();
         uint16_t _nr_full_seg_received = 0;
         struct isn_secret {
             // 512 bits secretkey for ISN generating
@@ -415,14 +436,17 @@ private:
         circular_buffer<typename InetTraits::l4packet> _packetq;
         bool _poll_active = false;
         uint32_t get_default_receive_window_size() {
-            // Linux's default window size
+            // Linux's default window size, scaled as if with a window scale
+            // of 7. The larger scale we actually advertise does not inflate
+            // the initial window, it only provides the headroom
+            // update_rcv_buf_size() grows into.
             constexpr uint32_t size = 29200;
-            return size << _rcv.window_scale;
+            return std::min<uint32_t>(size << _rcv.window_scale, size << 7);
         }
         // Returns the current receive window according to available receiving buffer size
         uint32_t get_modified_receive_window_size() {
             uint32_t left =  _rcv.data_size > _rcv.max_receive_buf_size ? 0 : _rcv.max_receive_buf_size - _rcv.data_size;
-            return std::min(left, get_default_receive_window_size());
+            return left;
         }
     public:
         tcb(tcp& t, connid id);
@@ -439,6 +463,11 @@ private:
         void connect();
         packet read();
         void close() noexcept;
+        // Must be called before the connection is established; the
+        // policy sizes its initial window at handshake completion
+        void set_congestion_control(tcp_congestion_algorithm algo) {
+            _cc = make_tcp_congestion_control(algo);
+        }
         void remove_from_tcbs() {
             auto id = connid{_local_ip, _foreign_ip, _local_port, _foreign_port};
             _tcp._tcbs.erase(id);
@@ -509,6 +538,8 @@ private:
         void retransmit();
         void fast_retransmit();
         void update_rto(clock_type::time_point tx_time);
+        void update_rcv_rtt();
+        void update_rcv_buf_size(size_t consumed);
         void update_cwnd(uint32_t acked_bytes);
         void cleanup();
         uint32_t can_send() {
@@ -531,12 +562,12 @@ private:
             auto x = std::min(_snd.window - window_used, _snd.unsent_len);
 
             // Can not send more than congestion window allows
-            x = std::min(_snd.cwnd, x);
+            x = std::min(_cc->window(), x);
             if (_snd.dupacks == 1 || _snd.dupacks == 2) {
                 // RFC5681 Step 3.1
                 // Send cwnd + 2 * smss per RFC3042
                 auto flight = flight_size();
-                auto max = _snd.cwnd + 2 * _snd.mss;
+                auto max = _cc->window() + 2 * _snd.mss;
                 x = flight <= max ? std::min(x, max - flight) : 0;
                 _snd.limited_transfer += x;
             } else if (_snd.dupacks >= 3) {
@@ -544,7 +575,13 @@ private:
                 // Sent 1 full-sized segment at most
                 x = std::min(uint32_t(_snd.mss), x);
             }
-            return x;
+            // Paced policies may release only part of the window now; if
+            // so, retry the output path when the budget replenishes
+            auto paced = _cc->pacing_allowance(x);
+            if (paced < x && !_pacing_timer.armed()) {
+                _pacing_timer.arm(_cc->pacing_replenish_time());
+            }
+            return paced;
         }
         uint32_t flight_size() {
             uint32_t size = 0;
@@ -658,12 +695,40 @@ private:
     std::unordered_map<uint16_t, listener*> _listening;
     std::random_device _rd;
     std::default_random_engine _e;
-    std::uniform_int_distribution<uint16_t> _port_dist{41952, 65535};
+    static constexpr uint16_t min_local_port = 41952;
+    static constexpr uint16_t max_local_port = 65535;
+    std::uniform_int_distribution<uint16_t> _port_dist{min_local_port, max_local_port};
+    // Toeplitz contribution of every value of the two local-port bytes
+    // (offsets 10 and 11 of the hashed tuple), built on first connect();
+    // lets connect() steer the local port to this shard without
+    // re-hashing the whole tuple per candidate port
+    struct port_contrib_tables {
+        std::array<uint32_t, 256> hi;
+        std::array<uint32_t, 256> lo;
+    };
+    std::optional<port_contrib_tables> _port_contrib;
     circular_buffer<std::pair<lw_shared_ptr<tcb>, ethernet_address>> _poll_tcbs;
     // queue for packets that do not belong to any tcb
     circular_buffer<ipv4_traits::l4packet> _packetq;
     semaphore _queue_space = {212992};
     metrics::metric_groups _metrics;
+    // Delayed-ack tuning, see set_delayed_ack(). The default timeout follows
+    // common practice (RFC 1122 allows up to 500ms, most stacks use 200ms)
+    // and the default segment threshold acks every second full-sized segment.
+    std::chrono::milliseconds _delayed_ack_timeout{200};
+    uint16_t _delayed_ack_full_segments = 2;
+    // Memory budget, shared by all connections on this stack, for growing
+    // receive buffers beyond their default size, so auto-tuned windows
+    // cannot take over the shard's memory. See tcb::update_rcv_buf_size().
+    size_t _rcv_buf_mem_budget = 128 * 1024 * 1024;
+    size_t reserve_receive_buffer_memory(size_t want) noexcept {
+        auto granted = std::min(want, _rcv_buf_mem_budget);
+        _rcv_buf_mem_budget -= granted;
+        return granted;
+    }
+    void release_receive_buffer_memory(size_t amount) noexcept {
+        _rcv_buf_mem_budget += amount;
+    }
 public:
     const inet_type& inet() const {
         return _inet;
@@ -712,6 +777,9 @@ public:
         uint16_t local_port() {
             return _tcb->_local_port;
         }
+        void set_congestion_control(tcp_congestion_algorithm algo) {
+            _tcb->set_congestion_control(algo);
+        }
         void shutdown_connect();
         void close_read() noexcept;
         void close_write() noexcept;
@@ -772,6 +840,20 @@ public:
             it->second->dec_pending();
         }
     }
+    // Tune ack generation: an ack is delayed for up to timeout, or until
+    // full_segments full-sized segments have been received, whichever comes
+    // first. A zero timeout disables delayed acks altogether. Applies to
+    // tcbs created afterwards as well as existing ones.
+    void set_delayed_ack(std::chrono::milliseconds timeout, uint16_t full_segments) noexcept {
+        _delayed_ack_timeout = timeout;
+        _delayed_ack_full_segments = std::max<uint16_t>(full_segments, 1);
+    }
+    // Set the memory budget available for growing connection receive
+    // buffers beyond their default size. Does not reclaim memory already
+    // granted to connections.
+    void set_receive_buffer_memory_budget(size_t budget) noexcept {
+        _rcv_buf_mem_budget = budget;
+    }
 private:
     void send_packet_without_tcb(ipaddr from, ipaddr to, packet p);
     void respond_with_reset(tcp_hdr* rth, ipaddr local_ip, ipaddr foreign_ip);
@@ -829,18 +911,46 @@ auto tcp<InetTraits>::listen(uint16_t port, size_t queue_length) -> listener {
 
 template <typename InetTraits>
 auto tcp<InetTraits>::connect(socket_address sa) -> connection {
-    uint16_t src_port;
     connid id;
     auto src_ip = _inet._inet.host_address();
     auto dst_ip = ipv4_address(sa);
     auto dst_port = net::ntoh(sa.u.in.sin_port);
 
-    do {
-        src_port = _port_dist(_e);
-        id = connid{src_ip, dst_ip, src_port, dst_port};
-    } while (_inet._inet.netif()->hw_queues_count() > 1 &&
-             (_inet._inet.netif()->hash2cpu(id.hash(_inet._inet.netif()->rss_key())) != this_shard_id()
-              || _tcbs.find(id) != _tcbs.end()));
+    auto* netif = _inet._inet.netif();
+    if (netif->hw_queues_count() > 1) {
+        // The local port is the only free variable in the RSS tuple, and
+        // the Toeplitz hash is linear in it. Hash the tuple with a zero
+        // port once, then re-derive each candidate's hash with two table
+        // lookups and an XOR, scanning from a random starting point until
+        // a free port steers to this shard.
+        auto rss_key = netif->rss_key();
+        if (!_port_contrib) {
+            _port_contrib.emplace(port_contrib_tables{toeplitz_byte_contrib(rss_key, 10), toeplitz_byte_contrib(rss_key, 11)});
+        }
+        id = connid{src_ip, dst_ip, 0, dst_port};
+        auto base_hash = id.hash(rss_key);
+        constexpr uint32_t nr_ports = max_local_port - min_local_port + 1;
+        auto start = _port_dist(_e);
+        uint32_t i = 0;
+        for (; i < nr_ports; i++) {
+            uint16_t src_port = min_local_port + (uint32_t(start) - min_local_port + i) % nr_ports;
+            auto hash = base_hash ^ _port_contrib->hi[src_port >> 8] ^ _port_contrib->lo[src_port & 0xff];
+            if (netif->hash2cpu(hash) != this_shard_id()) {
+                continue;
+            }
+            id.local_port = src_port;
+            if (_tcbs.find(id) == _tcbs.end()) {
+                break;
+            }
+        }
+        if (i == nr_ports) {
+            throw std::system_error(EADDRNOTAVAIL, std::system_category());
+        }
+    } else {
+        do {
+            id = connid{src_ip, dst_ip, _port_dist(_e), dst_port};
+        } while (_tcbs.find(id) != _tcbs.end());
+    }
 
     auto tcbp = make_lw_shared<tcb>(*this, id);
     _tcbs.insert({id, tcbp});
@@ -970,7 +1080,8 @@ tcp<InetTraits>::tcb::tcb(tcp& t, connid id)
     , _foreign_port(id.foreign_port)
     , _delayed_ack([this] { _nr_full_seg_received = 0; output(); })
     , _retransmit([this] { retransmit(); })
-    , _persist([this] { persist(); }) {
+    , _persist([this] { persist(); })
+    , _pacing_timer([this] { output(); }) {
 }
 
 template <typename InetTraits>
@@ -1091,6 +1202,7 @@ void tcp<InetTraits>::tcb::init_from_options(tcp_hdr* th, uint8_t* opt_start, ui
     _rcv.mss = _option._local_mss = local_mss();
 
     _rcv.window = get_default_receive_window_size();
+    _rcv.max_receive_buf_size = _rcv.window;
     _snd.window = th->window << _snd.window_scale;
 
     // Segment sequence number used for last window update
@@ -1098,17 +1210,8 @@ void tcp<InetTraits>::tcb::init_from_options(tcp_hdr* th, uint8_t* opt_start, ui
     // Segment acknowledgment number used for last window update
     _snd.wl2 = th->ack;
 
-    // Setup initial congestion window
-    if (2190 < _snd.mss) {
-        _snd.cwnd = 2 * _snd.mss;
-    } else if (1095 < _snd.mss && _snd.mss <= 2190) {
-        _snd.cwnd = 3 * _snd.mss;
-    } else {
-        _snd.cwnd = 4 * _snd.mss;
-    }
-
-    // Setup initial slow start threshold
-    _snd.ssthresh = th->window << _snd.window_scale;
+    // Let the congestion-control policy set up its initial window
+    _cc->on_established(_snd.mss, th->window << _snd.window_scale);
 }
 
 template <typename InetTraits>
@@ -1362,8 +1465,7 @@ void tcp<InetTraits>::tcb::input_handle_other_state(tcp_hdr* th, packet p) {
                     uint32_t smss = _snd.mss;
                     if (seg_ack > _snd.recover) {
                         tcp_debug("ack: full_ack\n");
-                        // Set cwnd to min (ssthresh, max(FlightSize, SMSS) + SMSS)
-                        _snd.cwnd = std::min(_snd.ssthresh, std::max(flight_size(), smss) + smss);
+                        _cc->on_full_ack(flight_size(), smss);
                         // Exit the fast recovery procedure
                         exit_fast_recovery();
                         set_retransmit_timer();
@@ -1371,14 +1473,7 @@ void tcp<InetTraits>::tcb::input_handle_other_state(tcp_hdr* th, packet p) {
                         tcp_debug("ack: partial_ack\n");
                         // Retransmit the first unacknowledged segment
                         fast_retransmit();
-                        // Deflate the congestion window by the amount of new data
-                        // acknowledged by the Cumulative Acknowledgment field
-                        _snd.cwnd -= acked_bytes;
-                        // If the partial ACK acknowledges at least one SMSS of new
-                        // data, then add back SMSS bytes to the congestion window
-                        if (acked_bytes >= smss) {
-                            _snd.cwnd += smss;
-                        }
+                        _cc->on_partial_ack(acked_bytes, smss);
                         // Send a new segment if permitted by the new value of
                         // cwnd.  Do not exit the fast recovery procedure For
                         // the first partial ACK that arrives during fast
@@ -1420,17 +1515,15 @@ void tcp<InetTraits>::tcb::input_handle_other_state(tcp_hdr* th, packet p) {
                     // RFC6582 Step 3.2
                     if (seg_ack - 1 > _snd.recover) {
                         _snd.recover = _snd.next - 1;
-                        // RFC5681 Step 3.2
-                        _snd.ssthresh = std::max((flight_size() - _snd.limited_transfer) / 2, 2 * smss);
+                        _cc->on_fast_retransmit(flight_size(), _snd.limited_transfer, smss, true);
                         fast_retransmit();
                     } else {
                         // Do not enter fast retransmit and do not reset ssthresh
+                        _cc->on_fast_retransmit(flight_size(), _snd.limited_transfer, smss, false);
                     }
-                    // RFC5681 Step 3.3
-                    _snd.cwnd = _snd.ssthresh + 3 * smss;
                 } else if (_snd.dupacks > 3) {
                     // RFC5681 Step 3.4
-                    _snd.cwnd += smss;
+                    _cc->on_dup_ack(smss);
                     // RFC5681 Step 3.5
                     do_output_data = true;
                 }
@@ -1504,6 +1597,7 @@ void tcp<InetTraits>::tcb::input_handle_other_state(tcp_hdr* th, packet p) {
             _rcv.data.push_back(std::move(p));
             _rcv.next += seg_len;
             auto merged = merge_out_of_order();
+            update_rcv_rtt();
             _rcv.window = get_modified_receive_window_size();
             signal_data_received();
             // Send an acknowledgment of the form:
@@ -1583,7 +1677,7 @@ packet tcp<InetTraits>::tcb::get_transmit_packet() {
     auto can_send = this->can_send();
     // Max number of TCP payloads we can pass to NIC
     uint32_t len;
-    if (_tcp.hw_features().tx_tso) {
+    if (_tcp.hw_features().tx_tso || _tcp.hw_features().tx_gso) {
         // FIXME: Info tap device the size of the splitted packet
         len = _tcp.hw_features().max_packet_len - net::tcp_hdr_len_min - InetTraits::ip_hdr_len_min;
     } else {
@@ -1632,6 +1726,10 @@ void tcp<InetTraits>::tcb::output_one(bool data_retransmit) {
     packet p = data_retransmit ? _snd.data.front().p.share() : get_transmit_packet();
     packet clone = p.share();  // early clone to prevent share() from calling packet::unuse_internal_data() on header.
     uint16_t len = p.len();
+    if (len && !data_retransmit) {
+        // Debit the pacing budget for new data leaving the tcb
+        _cc->on_segment_sent(len);
+    }
     bool syn_on = syn_needs_on();
     bool ack_on = ack_needs_on();
 
@@ -1689,7 +1787,7 @@ void tcp<InetTraits>::tcb::output_one(bool data_retransmit) {
         // segment length set to 0. All the rest is the same as for a TCP Tx
         // CSUM offload case.
         //
-        if (_tcp.hw_features().tx_tso && len > _snd.mss) {
+        if ((_tcp.hw_features().tx_tso || _tcp.hw_features().tx_gso) && len > _snd.mss) {
             oi.tso_seg_size = _snd.mss;
         } else {
             pseudo_hdr_seg_len = tcp_hdr::len + options_size + len;
@@ -1703,8 +1801,22 @@ void tcp<InetTraits>::tcb::output_one(bool data_retransmit) {
                                            pseudo_hdr_seg_len);
 
     uint16_t checksum;
+    uint16_t payload_csum = 0;
     if (_tcp.hw_features().tx_csum_l4_offload) {
         checksum = ~csum.get();
+    } else if (data_retransmit && len) {
+        // The payload did not change since the original transmit, reuse
+        // its cached sum and only re-sum the freshly built header.
+        csum.sum(th, oi.tcp_hdr_len);
+        csum.sum_partial(_snd.data.front().payload_csum);
+        checksum = csum.get();
+    } else if (len) {
+        checksummer body;
+        body.sum(clone);
+        payload_csum = body.partial();
+        csum.sum(th, oi.tcp_hdr_len);
+        csum.sum_partial(payload_csum);
+        checksum = csum.get();
     } else {
         csum.sum(p);
         checksum = csum.get();
@@ -1720,7 +1832,7 @@ void tcp<InetTraits>::tcb::output_one(bool data_retransmit) {
         if (len) {
             unsigned nr_transmits = 0;
             _snd.data.emplace_back(unacked_segment{std::move(clone),
-                                   len, nr_transmits, now});
+                                   len, nr_transmits, now, payload_csum});
         }
         if (!_retransmit.armed()) {
             start_retransmit_timer(now);
@@ -1783,10 +1895,11 @@ void tcp<InetTraits>::tcb::connect() {
     do_setup_isn();
 
     // Local receive window scale factor
-    _rcv.window_scale = _option._local_win_scale = 7;
+    _rcv.window_scale = _option._local_win_scale = 10;
     // Maximum segment size local can receive
     _rcv.mss = _option._local_mss = local_mss();
     _rcv.window = get_default_receive_window_size();
+    _rcv.max_receive_buf_size = _rcv.window;
 
     do_syn_sent();
 }
@@ -1797,9 +1910,10 @@ packet tcp<InetTraits>::tcb::read() {
     for (auto&& q : _rcv.data) {
         p.append(std::move(q));
     }
+    update_rcv_buf_size(_rcv.data_size);
     _rcv.data_size = 0;
     _rcv.data.clear();
-    _rcv.window = get_default_receive_window_size();
+    _rcv.window = get_modified_receive_window_size();
     return p;
 }
 
@@ -1858,16 +1972,17 @@ void tcp<InetTraits>::tcb::close() noexcept {
 
 template <typename InetTraits>
 bool tcp<InetTraits>::tcb::should_send_ack(uint16_t seg_len) {
-    // We've received a TSO packet, do ack immediately
-    if (seg_len > _rcv.mss) {
+    // Delayed acks are disabled, or we've received a TSO packet: ack immediately
+    if (_tcp._delayed_ack_timeout == std::chrono::milliseconds::zero() || seg_len > _rcv.mss) {
         _nr_full_seg_received = 0;
         _delayed_ack.cancel();
         return true;
     }
 
-    // We've received a full sized segment, ack for every second full sized segment
+    // We've received a full sized segment, ack for every
+    // _delayed_ack_full_segments (by default, second) full sized segment
     if (seg_len == _rcv.mss) {
-        if (_nr_full_seg_received++ >= 1) {
+        if (++_nr_full_seg_received >= _tcp._delayed_ack_full_segments) {
             _nr_full_seg_received = 0;
             _delayed_ack.cancel();
             return true;
@@ -1882,7 +1997,7 @@ bool tcp<InetTraits>::tcb::should_send_ack(uint16_t seg_len) {
     // If the timer is not armed, schedule a delayed ACK.
     // The maximum delayed ack timer allowed by RFC1122 is 500ms, most
     // implementations use 200ms.
-    _delayed_ack.arm(200ms);
+    _delayed_ack.arm(_tcp._delayed_ack_timeout);
     return false;
 }
 
@@ -1992,16 +2107,10 @@ void tcp<InetTraits>::tcb::retransmit() {
     // If there are unacked data, retransmit the earliest segment
     auto& unacked_seg = _snd.data.front();
 
-    // According to RFC5681
-    // Update ssthresh only for the first retransmit
     uint32_t smss = _snd.mss;
-    if (unacked_seg.nr_transmits == 0) {
-        _snd.ssthresh = std::max(flight_size() / 2, 2 * smss);
-    }
+    _cc->on_rto(flight_size(), smss, unacked_seg.nr_transmits == 0);
     // RFC6582 Step 4
     _snd.recover = _snd.next - 1;
-    // Start the slow start process
-    _snd.cwnd = smss;
     // End fast recovery
     exit_fast_recovery();
 
@@ -2031,6 +2140,7 @@ template <typename InetTraits>
 void tcp<InetTraits>::tcb::update_rto(clock_type::time_point tx_time) {
     // Update RTO according to RFC6298
     auto R = std::chrono::duration_cast<std::chrono::milliseconds>(clock_type::now() - tx_time);
+    _cc->on_rtt_sample(R);
     if (_snd.first_rto_sample) {
         _snd.first_rto_sample = false;
         // RTTVAR <- R/2
@@ -2054,16 +2164,56 @@ void tcp<InetTraits>::tcb::update_rto(clock_type::time_point tx_time) {
 }
 
 template <typename InetTraits>
-void tcp<InetTraits>::tcb::update_cwnd(uint32_t acked_bytes) {
-    uint32_t smss = _snd.mss;
-    if (_snd.cwnd < _snd.ssthresh) {
-        // In slow start phase
-        _snd.cwnd += std::min(acked_bytes, smss);
-    } else {
-        // In congestion avoidance phase
-        uint32_t round_up = 1;
-        _snd.cwnd += std::max(round_up, smss * smss / _snd.cwnd);
+void tcp<InetTraits>::tcb::update_rcv_rtt() {
+    // A connection that mostly receives never gets the sender-side RTT
+    // samples update_rto() relies on, so estimate the round-trip time
+    // from how long the peer takes to fill one full receive window, the
+    // same way Linux does in the absence of timestamps.
+    auto now = clock_type::now();
+    if (!_rcv.rtt_ts) {
+        _rcv.rtt_seq = _rcv.next + _rcv.window;
+        _rcv.rtt_ts = now;
+        return;
+    }
+    if (_rcv.next < _rcv.rtt_seq) {
+        return;
     }
+    auto r = std::chrono::duration_cast<std::chrono::milliseconds>(now - *_rcv.rtt_ts);
+    // Smooth with the same alpha = 1/8 as update_rto()
+    _rcv.rtt = _rcv.rtt.count() ? _rcv.rtt * 7 / 8 + r / 8 : r;
+    _rcv.rtt_seq = _rcv.next + _rcv.window;
+    _rcv.rtt_ts = now;
+}
+
+template <typename InetTraits>
+void tcp<InetTraits>::tcb::update_rcv_buf_size(size_t consumed) {
+    _rcv.bytes_consumed += consumed;
+    if (!_rcv.rtt.count()) {
+        // No round-trip estimate yet
+        return;
+    }
+    auto now = clock_type::now();
+    if (now - _rcv.consume_ts < _rcv.rtt) {
+        return;
+    }
+    // The consumer drained this much in one round-trip, so a window of
+    // twice that keeps the pipe full while leaving the rate room to grow,
+    // following Linux's tcp_moderate_rcvbuf. The window scale advertised
+    // in the handshake bounds how far we can ever grow.
+    auto target = std::min(_rcv.bytes_consumed * 2, size_t(65535) << _rcv.window_scale);
+    _rcv.bytes_consumed = 0;
+    _rcv.consume_ts = now;
+    if (target > _rcv.max_receive_buf_size) {
+        auto granted = _tcp.reserve_receive_buffer_memory(target - _rcv.max_receive_buf_size);
+        _rcv.max_receive_buf_size += granted;
+        _rcv.reserved_buf_mem += granted;
+    }
+}
+
+template <typename InetTraits>
+void tcp<InetTraits>::tcb::update_cwnd(uint32_t acked_bytes) {
+    // The policy owns the window arithmetic
+    _cc->on_ack(acked_bytes, _snd.mss);
 }
 
 template <typename InetTraits>
@@ -2073,8 +2223,11 @@ void tcp<InetTraits>::tcb::cleanup() {
     _rcv.out_of_order.map.clear();
     _rcv.data_size = 0;
     _rcv.data.clear();
+    _tcp.release_receive_buffer_memory(_rcv.reserved_buf_mem);
+    _rcv.reserved_buf_mem = 0;
     stop_retransmit_timer();
     clear_delayed_ack();
+    _pacing_timer.cancel();
     remove_from_tcbs();
 }
 
@@ -23,6 +23,7 @@
 #include <functional>
 #include <unordered_set>
 #include <map>
+#include <vector>
 
 #include <boost/any.hpp>
 
@@ -211,6 +212,33 @@ namespace tls {
          */
         void set_dn_verification_callback(dn_callback);
 
+        /**
+         * Runs the CPU-heavy part of the TLS handshake (asymmetric crypto)
+         * on the syscall thread pool instead of inline on the reactor, so
+         * that a burst of new connections does not stall record processing
+         * for established ones. Symmetric record encryption remains inline.
+         *
+         * Applies to all sessions created with these credentials.
+         * Disabled by default.
+         */
+        void enable_handshake_offload(bool enable = true);
+
+        /**
+         * After the handshake completes, tries to move record
+         * encryption/decryption into the kernel (TLS_TX/TLS_RX), so bulk
+         * streaming avoids the userspace encrypt-copy. Falls back
+         * transparently to userspace record processing when the kernel,
+         * the network stack or the negotiated cipher does not support it
+         * (currently requires an AES-GCM cipher suite).
+         *
+         * Note that with kernel TLS active, connection shutdown closes
+         * the transport without sending a close_notify alert.
+         *
+         * Applies to all sessions created with these credentials.
+         * Disabled by default.
+         */
+        void enable_kernel_tls(bool enable = true);
+
     private:
         class impl;
         friend class session;
@@ -232,6 +260,16 @@ namespace tls {
         NONE, REQUEST, REQUIRE
     };
 
+    /**
+     * A session ticket encryption key (STEK). Tickets are
+     * self-contained - the server state needed to resume is encrypted
+     * under this key into the ticket itself - so shards need not share
+     * a session store, only the key: every shard terminating
+     * connections for the same service must use the same STEK for a
+     * ticket issued on one shard to be redeemable on any other.
+     */
+    using session_ticket_key = std::vector<uint8_t>;
+
     /**
      * Extending certificates and keys for server usage.
      * More probably goes in here...
@@ -249,6 +287,46 @@ namespace tls {
         server_credentials& operator=(const server_credentials&) = delete;
 
         void set_client_auth(client_auth);
+
+        /** Generates a fresh session ticket encryption key. */
+        static session_ticket_key generate_session_ticket_key();
+
+        /**
+         * Enables issuing of session tickets, allowing clients to
+         * resume with an abbreviated handshake instead of a full one.
+         * Calling again with a different key rotates the STEK:
+         * sessions created afterwards issue and accept tickets under
+         * the new key only, so outstanding tickets are invalidated.
+         */
+        void enable_session_tickets(const session_ticket_key&);
+
+        /**
+         * Attaches a DER-encoded OCSP response to staple into full
+         * handshakes (RFC 6066 status_request), saving clients a round
+         * trip to the responder. The response is kept by the
+         * credentials and handed out per handshake; calling again
+         * replaces it, so it can be refreshed while sessions are being
+         * served.
+         */
+        void set_ocsp_staple(const blob& der);
+
+        /**
+         * Keeps the stapled OCSP response fresh in the background.
+         *
+         * Every \c refresh_period (and once immediately), a response
+         * for the leaf certificate is fetched with \ref http::client
+         * from the responder named in the certificate's Authority
+         * Information Access extension, or from \c responder_override
+         * if given (only http:// responders are supported). The fetch
+         * runs off the handshake path on the calling shard; on failure
+         * the previous staple is kept and the fetch retried at the
+         * next period. Refreshing stops when the credentials are
+         * destroyed.
+         *
+         * Requires the issuer certificate to be present in the loaded
+         * chain, as it is needed to build the OCSP request.
+         */
+        void enable_ocsp_stapling(std::chrono::milliseconds refresh_period, sstring responder_override = {});
     };
 
     class reloadable_credentials_base;
@@ -282,6 +360,33 @@ namespace tls {
         future<> set_system_trust();
         void set_client_auth(client_auth);
         void set_priority_string(const sstring&);
+        void enable_handshake_offload(bool = true);
+        void enable_kernel_tls(bool = true);
+
+        /**
+         * Enables session tickets on server credentials built from
+         * this builder, generating a key if none is given. The builder
+         * is the copyable cross-shard carrier of credential options,
+         * so credentials built from copies of it on different shards
+         * share the STEK and can resume each other's sessions.
+         * Rotate by calling \ref rotate_session_ticket_key() and
+         * re-applying to live credentials with
+         * \ref server_credentials::enable_session_tickets().
+         */
+        void enable_session_tickets(session_ticket_key = {});
+        void rotate_session_ticket_key();
+        const session_ticket_key& get_session_ticket_key() const;
+
+        /**
+         * Attaches a DER-encoded OCSP response to credentials built
+         * from this builder (see
+         * \ref server_credentials::set_ocsp_staple()).
+         */
+        void set_ocsp_staple(const blob& der);
+        /** Loads the stapled OCSP response from a DER file. The file
+         * participates in reloadable credentials like the certificate
+         * files do, so an externally refreshed staple is picked up. */
+        future<> set_ocsp_staple_file(const sstring& file);
 
         void apply_to(certificate_credentials&) const;
 
@@ -298,6 +403,9 @@ namespace tls {
         std::multimap<sstring, boost::any> _blobs;
         client_auth _client_auth = client_auth::NONE;
         sstring _priority;
+        bool _offload_handshake = false;
+        bool _kernel_tls = false;
+        session_ticket_key _session_ticket_key;
     };
 
     /**
@@ -43,6 +43,7 @@
 
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <string_view>
 #include <vector>
@@ -97,4 +98,37 @@ toeplitz_hash(rss_key_type key, const T& data)
 	return (hash);
 }
 
+// The Toeplitz hash is linear over GF(2): flipping an input bit always
+// flips the same set of hash bits, whatever the rest of the input is. So
+// for any input byte offset the contribution of that byte to the hash can
+// be tabulated once per key, and the hash of a tuple differing only in
+// that byte re-derived with one lookup and an XOR instead of re-hashing
+// the whole tuple:
+//
+//   hash(tuple) == hash(tuple with data[off] = 0) ^ table[data[off]]
+static inline std::array<uint32_t, 256>
+toeplitz_byte_contrib(rss_key_type key, size_t off)
+{
+	// The sliding key windows the 8 bits of data[off] are folded against
+	uint32_t v[8];
+	v[0] = (key[off]<<24) + (key[off+1]<<16) + (key[off+2]<<8) + key[off+3];
+	for (unsigned b = 1; b < 8; b++) {
+		v[b] = v[b-1] << 1;
+		if ((off + 4) < key.size() &&
+		    (key[off+4] & (1<<(7-(b-1)))))
+			v[b] |= 1;
+	}
+
+	std::array<uint32_t, 256> table;
+	for (unsigned val = 0; val < 256; val++) {
+		uint32_t hash = 0;
+		for (unsigned b = 0; b < 8; b++) {
+			if (val & (1<<(7-b)))
+				hash ^= v[b];
+		}
+		table[val] = hash;
+	}
+	return table;
+}
+
 }
@@ -37,6 +37,7 @@
 #include <seastar/core/byteorder.hh>
 #include <seastar/core/shared_future.hh>
 #include <seastar/core/queue.hh>
+#include <seastar/core/metrics_registration.hh>
 #include <seastar/core/weak_ptr.hh>
 #include <seastar/core/scheduling.hh>
 #include <seastar/util/backtrace.hh>
@@ -117,6 +118,23 @@ struct client_options {
     ///
     /// \see resource_limits::isolate_connection
     sstring isolation_cookie;
+    /// Messages smaller than this threshold may be transmitted ahead of
+    /// already queued messages at or above it, so a multi-megabyte payload
+    /// does not head-of-line block small latency-sensitive verbs. Replies
+    /// are matched by message id, so the reordering is not visible to rpc
+    /// users. Zero (the default) preserves strict FIFO transmission.
+    size_t large_message_threshold = 0;
+};
+
+/// Per-verb client-side options, passed to \ref protocol::make_client() or
+/// \ref protocol::register_handler().
+struct handler_options {
+    /// Skip the flush after sending a call of this verb when more calls are
+    /// already queued on the connection, letting a burst of frames share one
+    /// flush (and typically one TCP segment). The last queued call always
+    /// flushes, so a lone call goes out immediately. Enable for verbs that
+    /// issue many small calls to the same server.
+    bool coalesce_sends = false;
 };
 
 /// @}
@@ -154,9 +172,16 @@ struct server_options {
     server_socket::load_balancing_algorithm load_balancing_algorithm = server_socket::load_balancing_algorithm::default_;
     // optional filter function. If set, will be called with remote 
     // (connecting) address.    
-    // Returning false will refuse the incoming connection. 
+    // Returning false will refuse the incoming connection.
     // Returning true will allow the mechanism to proceed.
     std::function<bool(const socket_address&)> filter_connection = {};
+    /// \see client_options::large_message_threshold
+    size_t large_message_threshold = 0;
+    /// When non-empty, the server registers a metrics group exporting
+    /// message and byte rates aggregated over all of its connections,
+    /// labeled with this name. Servers sharing a shard must use distinct
+    /// names. Empty (the default) registers nothing.
+    sstring metrics_domain;
 };
 
 /// @}
@@ -243,6 +268,7 @@ protected:
     std::optional<shared_promise<>> _negotiated = shared_promise<>();
     promise<> _stopped;
     stats _stats;
+    connection_rollup _rollup;
     const logger& _logger;
     // The owner of the pointer below is an instance of rpc::protocol<typename Serializer> class.
     // The type of the pointer is erased here, but the original type is Serializer
@@ -252,7 +278,9 @@ protected:
         snd_buf buf;
         promise<> done;
         cancellable* pcancel = nullptr;
-        outgoing_entry(snd_buf b) : buf(std::move(b)) {}
+        // entry's flush may ride with a later queued entry (see handler_options)
+        bool coalesce = false;
+        outgoing_entry(snd_buf b, bool coalesce = false) : buf(std::move(b)), coalesce(coalesce) {}
 
         outgoing_entry(outgoing_entry&&) = delete;
         outgoing_entry(const outgoing_entry&) = delete;
@@ -277,9 +305,14 @@ protected:
     future<> _outgoing_queue_ready = _negotiated->get_shared_future();
     outgoing_entry::container_t _outgoing_queue;
     size_t _outgoing_queue_size = 0;
+    // set when a coalescing entry deferred its flush to a later entry
+    bool _needs_flush = false;
     std::unique_ptr<compressor> _compressor;
     bool _propagate_timeout = false;
     bool _timeout_negotiated = false;
+    // messages below the threshold may overtake queued messages at or above
+    // it; zero preserves strict FIFO transmission (see {client,server}_options)
+    size_t _large_msg_threshold = 0;
     // stream related fields
     bool _is_stream = false;
     connection_id _id = invalid_connection_id;
@@ -326,7 +359,7 @@ public:
     future<> send_negotiation_frame(feature_map features);
     // functions below are public because they are used by external heavily templated functions
     // and I am not smart enough to know how to define them as friends
-    future<> send(snd_buf buf, std::optional<rpc_clock_type::time_point> timeout = {}, cancellable* cancel = nullptr);
+    future<> send(snd_buf buf, std::optional<rpc_clock_type::time_point> timeout = {}, cancellable* cancel = nullptr, bool coalesce = false);
     bool error() const noexcept { return _error; }
     void abort();
     future<> stop() noexcept;
@@ -359,13 +392,19 @@ public:
         return _logger;
     }
 
+    connection_rollup& rollup() noexcept {
+        return _rollup;
+    }
+
     template<typename Serializer>
     Serializer& serializer() {
         return *static_cast<Serializer*>(_serializer);
     }
 
+    // account is cleared when re-parsing an already accounted decompressed
+    // frame from read_frame_compressed()
     template <typename FrameType>
-    typename FrameType::return_type read_frame(socket_address info, input_stream<char>& in);
+    typename FrameType::return_type read_frame(socket_address info, input_stream<char>& in, bool account = true);
 
     template <typename FrameType>
     typename FrameType::return_type read_frame_compressed(socket_address info, std::unique_ptr<compressor>& compressor, input_stream<char>& in);
@@ -466,6 +505,8 @@ private:
     read_response_frame(input_stream<char>& in);
     future<std::tuple<int64_t, std::optional<rcv_buf>>>
     read_response_frame_compressed(input_stream<char>& in);
+    void dispatch_response(int64_t msg_id, std::optional<rcv_buf> data);
+    future<> handle_response_frames();
 public:
     /**
      * Create client object which will attempt to connect to the remote address.
@@ -607,6 +648,9 @@ private:
     gate _reply_gate;
     server_options _options;
     uint64_t _next_client_id = 1;
+    metrics::metric_groups _metrics;
+
+    void setup_metrics();
 
 public:
     server(protocol_base* proto, const socket_address& addr, resource_limits memory_limit = resource_limits());
@@ -797,12 +841,13 @@ public:
     /// \tparam Func The signature of the verb. Has to be either the same or
     ///     compatible with the one passed to register_handler on the server.
     /// \param t the verb to invoke on the remote.
+    /// \param ho per-verb options, e.g. send coalescing for chatty verbs.
     ///
     /// \returns a callable whose signature is derived from Func as follows:
     ///     given `Func == Ret(Args...)` the returned callable has the following
     ///     signature: `future<Ret>(protocol::client&, Args...)`.
     template<typename Func>
-    auto make_client(MsgType t);
+    auto make_client(MsgType t, handler_options ho = {});
 
     /// Register a handler to be called when this verb is invoked.
     ///
@@ -888,7 +933,7 @@ private:
     void put_handler(rpc_handler*) override;
 
     template<typename Ret, typename... In>
-    auto make_client(signature<Ret(In...)> sig, MsgType t);
+    auto make_client(signature<Ret(In...)> sig, MsgType t, handler_options ho = {});
 
     void register_receiver(MsgType t, rpc_handler&& handler) {
         auto r = _handlers.emplace(t, std::move(handler));
@@ -30,6 +30,7 @@
 #include <boost/range/adaptor/transformed.hpp>
 #include <seastar/net/packet-data-source.hh>
 #include <seastar/core/print.hh>
+#include <cstring>
 
 namespace seastar {
 
@@ -244,6 +245,15 @@ struct marshall_one {
             std::apply(do_do_marshall, arg);
         }
     };
+    template <typename Char> struct helper<basic_borrowed_buf<Char>> {
+        static void doit(Serializer&, Output& out, const basic_borrowed_buf<Char>& arg) {
+            uint32_t size = cpu_to_le(arg.size);
+            out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+            for (auto& b : arg.bufs) {
+                out.write(reinterpret_cast<const char*>(b.get()), b.size());
+            }
+        }
+    };
 };
 
 template <typename Serializer, typename Output, typename... T>
@@ -252,6 +262,22 @@ inline void do_marshall(Serializer& serializer, Output& out, const T&... args) {
     (void)std::initializer_list<int>{(marshall_one<Serializer, Output>::template helper<T>::doit(serializer, out, args), 1)...};
 }
 
+// Argument types eligible for the raw_serializer fast path: plain
+// trivially-copyable values, excluding the types the marshalling layer
+// itself treats specially (reference wrappers, optionals, sinks, sources
+// and nested tuples).
+template <typename T>
+struct is_trivially_marshallable
+    : std::bool_constant<std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T> && !is_smart_ptr<T>::value> {};
+template <typename T>
+struct is_trivially_marshallable<std::reference_wrapper<const T>> : std::false_type {};
+template <typename T>
+struct is_trivially_marshallable<optional<T>> : std::false_type {};
+
+template <typename Serializer, typename... T>
+constexpr bool marshall_at_compile_time = raw_serializer<Serializer>::value && sizeof...(T) != 0
+        && (... && is_trivially_marshallable<T>::value);
+
 static inline memory_output_stream<snd_buf::iterator> make_serializer_stream(snd_buf& output) {
     auto* b = std::get_if<temporary_buffer<char>>(&output.bufs);
     if (b) {
@@ -264,18 +290,89 @@ static inline memory_output_stream<snd_buf::iterator> make_serializer_stream(snd
 
 template <typename Serializer, typename... T>
 inline snd_buf marshall(Serializer& serializer, size_t head_space, const T&... args) {
-    measuring_output_stream measure;
-    do_marshall(serializer, measure, args...);
-    snd_buf ret(measure.size() + head_space);
-    auto out = make_serializer_stream(ret);
-    out.skip(head_space);
-    do_marshall(serializer, out, args...);
-    return ret;
+    if constexpr (marshall_at_compile_time<Serializer, T...>) {
+        // The frame layout is known at compile time: skip the measuring
+        // pass and copy each argument at its constant offset; the
+        // compiler folds the memcpy()s of the packed prefix into one.
+        constexpr size_t payload_size = (0 + ... + sizeof(T));
+        snd_buf ret(payload_size + head_space);
+        if (auto* b = std::get_if<temporary_buffer<char>>(&ret.bufs)) {
+            auto p = b->get_write() + head_space;
+            size_t offset = 0;
+            (..., (std::memcpy(p + offset, std::addressof(args), sizeof(T)), offset += sizeof(T)));
+            return ret;
+        }
+        // head_space pushed us over the chunk size; fall through to the
+        // fragmented stream (the serializer produces the same bytes)
+        auto out = make_serializer_stream(ret);
+        out.skip(head_space);
+        do_marshall(serializer, out, args...);
+        return ret;
+    } else {
+        measuring_output_stream measure;
+        do_marshall(serializer, measure, args...);
+        snd_buf ret(measure.size() + head_space);
+        auto out = make_serializer_stream(ret);
+        out.skip(head_space);
+        do_marshall(serializer, out, args...);
+        return ret;
+    }
 }
 
 template <typename Serializer, typename Input, typename... T>
 std::tuple<T...> do_unmarshall(connection& c, Input& in);
 
+// Deserialization stream which also remembers the rcv_buf it was made
+// from, so that borrowed_buf arguments can take views of the underlying
+// receive buffers instead of copying them out. To the user-supplied
+// Serializer it looks like the plain memory_input_stream it derives
+// from.
+class borrowing_deserializer_stream : public memory_input_stream<rcv_buf::iterator> {
+    rcv_buf& _buf;
+public:
+    explicit borrowing_deserializer_stream(rcv_buf& buf)
+        : memory_input_stream<rcv_buf::iterator>(make_deserializer_stream(buf)), _buf(buf) {}
+
+    // Returns the next size bytes as views sharing the underlying
+    // receive buffers, one view per receive fragment the range spans,
+    // and advances the stream past them.
+    template <typename Char>
+    std::vector<temporary_buffer<Char>> read_fragments(size_t size) {
+        if (size > this->size()) {
+            throw std::out_of_range("deserialization buffer underflow");
+        }
+        auto share = [] (temporary_buffer<char>& b, size_t pos, size_t len) {
+            auto v = b.share(pos, len);
+            return temporary_buffer<Char>(reinterpret_cast<Char*>(v.get_write()), v.size(), v.release());
+        };
+        // the stream only ever consumes from the front, so the amount it
+        // has left locates the current position within the rcv_buf
+        size_t pos = _buf.size - this->size();
+        auto left = size;
+        std::vector<temporary_buffer<Char>> ret;
+        if (auto* b = std::get_if<temporary_buffer<char>>(&_buf.bufs)) {
+            if (left) {
+                ret.push_back(share(*b, pos, left));
+            }
+        } else {
+            auto it = std::get<std::vector<temporary_buffer<char>>>(_buf.bufs).begin();
+            while (pos && pos >= it->size()) {
+                pos -= it->size();
+                ++it;
+            }
+            while (left) {
+                auto this_size = std::min(it->size() - pos, left);
+                ret.push_back(share(*it, pos, this_size));
+                left -= this_size;
+                pos = 0;
+                ++it;
+            }
+        }
+        this->skip(size);
+        return ret;
+    }
+};
+
 template<typename Serializer, typename Input>
 struct unmarshal_one {
     template<typename T> struct helper {
@@ -317,25 +414,54 @@ struct unmarshal_one {
             return do_unmarshall<Serializer, Input, T...>(c, in);
         }
     };
+    template <typename Char> struct helper<basic_borrowed_buf<Char>> {
+        static basic_borrowed_buf<Char> doit(connection&, Input& in) {
+            uint32_t size;
+            in.read(reinterpret_cast<char*>(&size), sizeof(size));
+            size = le_to_cpu(size);
+            return basic_borrowed_buf<Char>(in.template read_fragments<Char>(size), size);
+        }
+    };
 };
 
 template <typename Serializer, typename Input, typename... T>
 inline std::tuple<T...> do_unmarshall(connection& c, Input& in) {
-    // Argument order processing is unspecified, but we need to deserialize
-    // left-to-right. So we deserialize into something that can be lazily
-    // constructed (and can conditionally destroy itself if we only constructed some
-    // of the arguments).
-    std::tuple<std::optional<T>...> temporary;
-    return std::apply([&] (auto&... args) {
-        // Comma-expression preserves left-to-right order
-        (..., (args = unmarshal_one<Serializer, Input>::template helper<typename std::remove_reference_t<decltype(args)>::value_type>::doit(c, in)));
-        return std::tuple(std::move(*args)...);
-    }, temporary);
+    if constexpr (marshall_at_compile_time<Serializer, T...>) {
+        // mirror image of the marshall() fast path: the arguments are the
+        // raw object representations at constant offsets
+        std::tuple<T...> ret;
+        std::apply([&in] (auto&... args) {
+            constexpr size_t total = (0 + ... + sizeof(T));
+            auto flat = in.peek_contiguous();
+            if (__builtin_expect(flat.size() >= total, true)) {
+                // all arguments live in one contiguous fragment: unpack
+                // them with plain memcpy behind a single bounds check
+                size_t offset = 0;
+                (..., (std::memcpy(std::addressof(args), flat.data() + offset, sizeof(args)), offset += sizeof(args)));
+                in.skip(total);
+            } else {
+                // Comma-expression preserves left-to-right order
+                (..., in.read(reinterpret_cast<char*>(std::addressof(args)), sizeof(args)));
+            }
+        }, ret);
+        return ret;
+    } else {
+        // Argument order processing is unspecified, but we need to deserialize
+        // left-to-right. So we deserialize into something that can be lazily
+        // constructed (and can conditionally destroy itself if we only constructed some
+        // of the arguments).
+        std::tuple<std::optional<T>...> temporary;
+        return std::apply([&] (auto&... args) {
+            // Comma-expression preserves left-to-right order
+            (..., (args = unmarshal_one<Serializer, Input>::template helper<typename std::remove_reference_t<decltype(args)>::value_type>::doit(c, in)));
+            return std::tuple(std::move(*args)...);
+        }, temporary);
+    }
 }
 
 template <typename Serializer, typename... T>
 inline std::tuple<T...> unmarshall(connection& c, rcv_buf input) {
-    auto in = make_deserializer_stream(input);
+    auto in = borrowing_deserializer_stream(input);
     return do_unmarshall<Serializer, decltype(in), T...>(c, in);
 }
 
@@ -456,10 +582,11 @@ relative_timeout_to_absolute(rpc_clock_type::duration relative) {
 // to a server and waits for a reply. After receiving reply it unmarshalls it and signal completion
 // to a caller.
 template<typename Serializer, typename MsgType, typename Ret, typename... InArgs>
-auto send_helper(MsgType xt, signature<Ret (InArgs...)> xsig) {
+auto send_helper(MsgType xt, signature<Ret (InArgs...)> xsig, handler_options xho = {}) {
     struct shelper {
         MsgType t;
         signature<Ret (InArgs...)> sig;
+        handler_options ho;
         auto send(rpc::client& dst, std::optional<rpc_clock_type::time_point> timeout, cancellable* cancel, const InArgs&... args) {
             if (dst.error()) {
                 using cleaned_ret_type = typename wait_signature<Ret>::cleaned_type;
@@ -477,7 +604,7 @@ auto send_helper(MsgType xt, signature<Ret (InArgs...)> xsig) {
 
             // prepare reply handler, if return type is now_wait_type this does nothing, since no reply will be sent
             using wait = wait_signature_t<Ret>;
-            return when_all(dst.send(std::move(data), timeout, cancel), wait_for_reply<Serializer>(wait(), timeout, cancel, dst, msg_id, sig)).then([] (auto r) {
+            return when_all(dst.send(std::move(data), timeout, cancel, ho.coalesce_sends), wait_for_reply<Serializer>(wait(), timeout, cancel, dst, msg_id, sig)).then([] (auto r) {
                     std::get<0>(r).ignore_ready_future();
                     return std::move(std::get<1>(r)); // return future of wait_for_reply
             });
@@ -496,7 +623,7 @@ auto send_helper(MsgType xt, signature<Ret (InArgs...)> xsig) {
         }
 
     };
-    return shelper{xt, xsig};
+    return shelper{xt, xsig, xho};
 }
 
 template<typename Serializer, typename RetTypes>
@@ -649,15 +776,15 @@ public:
 
 template<typename Serializer, typename MsgType>
 template<typename Ret, typename... In>
-auto protocol<Serializer, MsgType>::make_client(signature<Ret(In...)>, MsgType t) {
+auto protocol<Serializer, MsgType>::make_client(signature<Ret(In...)>, MsgType t, handler_options ho) {
     using sig_type = signature<typename client_function_type<Ret, In...>::type>;
-    return send_helper<Serializer>(t, sig_type());
+    return send_helper<Serializer>(t, sig_type(), ho);
 }
 
 template<typename Serializer, typename MsgType>
 template<typename Func>
-auto protocol<Serializer, MsgType>::make_client(MsgType t) {
-    return make_client(typename signature<typename function_traits<Func>::signature>::clean(), t);
+auto protocol<Serializer, MsgType>::make_client(MsgType t, handler_options ho) {
+    return make_client(typename signature<typename function_traits<Func>::signature>::clean(), t, ho);
 }
 
 template<typename Serializer, typename MsgType>
@@ -22,6 +22,7 @@
 #pragma once
 
 #include <seastar/net/api.hh>
+#include <cmath>
 #include <stdexcept>
 #include <string>
 #include <boost/any.hpp>
@@ -55,6 +56,69 @@ struct stats {
     counter_type timeout = 0;
 };
 
+// Exponentially weighted moving average of an event rate. Events are
+// accumulated into a pending counter and folded into the average lazily,
+// at most once a second, when either add() or rate() observes that a full
+// sample period has elapsed. This keeps the per-event cost to an addition
+// and a clock comparison, cheap enough to run on every rpc frame.
+class ewma_rate {
+    std::chrono::duration<double> _tau;
+    double _rate = 0;
+    double _pending = 0;
+    rpc_clock_type::time_point _last = rpc_clock_type::now();
+public:
+    explicit ewma_rate(std::chrono::duration<double> tau) noexcept : _tau(tau) {}
+    void add(double n) noexcept {
+        _pending += n;
+        maybe_fold();
+    }
+    // per-second rate, smoothed over roughly one time constant
+    double rate() noexcept {
+        maybe_fold();
+        return _rate;
+    }
+private:
+    void maybe_fold() noexcept {
+        auto now = rpc_clock_type::now();
+        std::chrono::duration<double> elapsed = now - _last;
+        if (elapsed < std::chrono::seconds(1)) {
+            return;
+        }
+        auto alpha = 1. - std::exp(-elapsed / _tau);
+        _rate += alpha * (_pending / elapsed.count() - _rate);
+        _pending = 0;
+        _last = now;
+    }
+};
+
+// Incrementally maintained short- and long-window rates of the traffic
+// crossing a connection, in both directions. Unlike the monotonic counters
+// in \ref stats these can be aggregated over all of a server's connections
+// at scrape time, so dashboards do not need a time series per connection.
+class connection_rollup {
+public:
+    struct window {
+        ewma_rate messages;
+        ewma_rate wire_bytes; // bytes on the wire, after compression
+        ewma_rate raw_bytes;  // payload bytes, before compression
+        explicit window(std::chrono::duration<double> tau) noexcept
+                : messages(tau), wire_bytes(tau), raw_bytes(tau) {}
+    };
+private:
+    window _short{std::chrono::seconds(1)};
+    window _long{std::chrono::seconds(10)};
+public:
+    void add_message(uint64_t wire_bytes, uint64_t raw_bytes) noexcept {
+        for (auto* w : {&_short, &_long}) {
+            w->messages.add(1);
+            w->wire_bytes.add(wire_bytes);
+            w->raw_bytes.add(raw_bytes);
+        }
+    }
+    window& short_window() noexcept { return _short; }
+    window& long_window() noexcept { return _long; }
+};
+
 
 struct client_info {
     socket_address addr;
@@ -141,6 +205,20 @@ struct no_wait_type {};
 // return this from a callback if client does not want to waiting for a reply
 extern no_wait_type no_wait;
 
+/// Opt-in marker for the compile-time marshalling fast path.
+///
+/// A serializer may specialize this to derive from \c std::true_type to
+/// declare that, for every trivially-copyable type, its \c write() emits
+/// exactly the \c sizeof(T) bytes of the object representation and its
+/// \c read() consumes them. When a verb's arguments are all trivially
+/// copyable, the frame layout is then known at compile time and
+/// marshalling collapses into fixed-offset \c memcpy()s of the argument
+/// bytes, skipping the generic measuring pass and the per-field
+/// recursion. The wire format is unchanged — the fast path produces the
+/// same bytes the serializer would.
+template <typename Serializer>
+struct raw_serializer : std::false_type {};
+
 /// \addtogroup rpc
 /// @{
 
@@ -226,6 +304,51 @@ struct snd_buf {
     temporary_buffer<char>& front();
 };
 
+/// A blob argument which is deserialized by borrowing the connection's
+/// receive buffers instead of being copied out of them.
+///
+/// Use it in verb signatures for large values (hundreds of kilobytes and
+/// up). The marshalling layer handles it directly, bypassing the
+/// user-supplied serializer: on the wire the payload is a 32-bit length
+/// followed by the raw bytes. On the receiving side the argument is
+/// built out of views sharing the connection's receive buffers -- and
+/// keeping them alive -- so the payload is never memcpy()ed during
+/// unmarshalling. Since a large frame arrives from the network in
+/// several chunks, the payload is exposed as a sequence of fragments;
+/// linearize() coalesces them when contiguous access is required.
+template <typename CharType>
+struct basic_borrowed_buf {
+    static_assert(sizeof(CharType) == 1, "borrowed_buf is a byte blob");
+    uint32_t size = 0;
+    std::vector<temporary_buffer<CharType>> bufs;
+
+    basic_borrowed_buf() = default;
+    explicit basic_borrowed_buf(temporary_buffer<CharType> b) : size(b.size()) {
+        bufs.push_back(std::move(b));
+    }
+    explicit basic_borrowed_buf(std::vector<temporary_buffer<CharType>> bufs_, size_t size_)
+        : size(size_), bufs(std::move(bufs_)) {};
+
+    bool empty() const { return size == 0; }
+
+    /// Returns the payload as one contiguous buffer: a single fragment
+    /// is shared, multiple fragments are copied into a freshly
+    /// allocated buffer.
+    temporary_buffer<CharType> linearize() {
+        if (bufs.size() == 1) {
+            return bufs.front().share();
+        }
+        temporary_buffer<CharType> ret(size);
+        auto p = ret.get_write();
+        for (auto& b : bufs) {
+            p = std::copy_n(b.get(), b.size(), p);
+        }
+        return ret;
+    }
+};
+
+using borrowed_buf = basic_borrowed_buf<char>;
+
 static inline memory_input_stream<rcv_buf::iterator> make_deserializer_stream(rcv_buf& input) {
     auto* b = std::get_if<temporary_buffer<char>>(&input.bufs);
     if (b) {
@@ -0,0 +1,66 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 Scylladb, Ltd.
+ */
+
+#pragma once
+
+#include <seastar/core/shared_ptr.hh>
+#include <seastar/core/sstring.hh>
+#include <seastar/rpc/rpc_types.hh>
+
+namespace seastar {
+namespace rpc {
+
+/// Zstd compressor which retains compression history across the messages
+/// of a connection. The stream is flushed at every rpc frame edge, so a
+/// frame is decodable as soon as it arrives, while back-references into
+/// earlier messages keep the ratio of a large window. The compression
+/// level only affects the sending side and needs no negotiation.
+///
+/// An optional dictionary primes the window for the first messages of a
+/// connection; its id becomes part of the negotiation string, so the
+/// peers fall back to plain negotiation unless both are configured with
+/// the same dictionary.
+class zstd_streaming_compressor final : public compressor {
+    class impl;
+    std::unique_ptr<impl> _impl;
+public:
+    class factory final : public rpc::compressor::factory {
+        int _level;
+        lw_shared_ptr<sstring> _dictionary;
+        sstring _feature;
+    public:
+        /// \param level zstd compression level for the sending side
+        /// \param dictionary optional shared dictionary; both peers must
+        ///        be configured with identical bytes for it to be used
+        explicit factory(int level = 3, sstring dictionary = {});
+        virtual const sstring& supported() const override;
+        virtual std::unique_ptr<rpc::compressor> negotiate(sstring feature, bool is_server) const override;
+    };
+public:
+    zstd_streaming_compressor(int level, lw_shared_ptr<sstring> dictionary);
+    ~zstd_streaming_compressor();
+    virtual snd_buf compress(size_t head_space, snd_buf data) override;
+    virtual rcv_buf decompress(rcv_buf data) override;
+    sstring name() const override;
+};
+
+}
+}
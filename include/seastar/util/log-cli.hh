@@ -85,6 +85,12 @@ struct options : public program_options::option_group {
     ///
     /// Default: \p true.
     program_options::value<bool> log_with_color;
+    /// Write log lines from a dedicated background thread.
+    ///
+    /// Lines are dropped (and the drops accounted) if the writer cannot
+    /// keep up, so logging never blocks a reactor.
+    /// Default: \p false.
+    program_options::value<bool> log_async;
     /// \cond internal
     options(program_options::option_group* parent_group);
     /// \endcond
@@ -87,6 +87,7 @@ class logger {
     static std::ostream* _out;
     static std::atomic<bool> _ostream;
     static std::atomic<bool> _syslog;
+    static std::atomic<bool> _async;
     static unsigned _shard_field_width;
 #ifdef SEASTAR_BUILD_SHARED_LIBS
     static thread_local bool silent;
@@ -420,6 +421,20 @@ public:
     ///       before syslogd can clear it) but can happen.
     static void set_syslog_enabled(bool enabled) noexcept;
 
+    /// Write formatted lines from a dedicated background thread
+    /// instead of the calling shard. default is false
+    ///
+    /// In asynchronous mode each shard appends formatted lines to a
+    /// bounded per-shard buffer that is drained by a single low-priority
+    /// writer thread, so a slow or contended output stream never stalls
+    /// a reactor. Lines that do not fit in the buffer are dropped; drops
+    /// are counted in \ref logging_dropped on the dropping shard and
+    /// noted in the log itself once the writer catches up.
+    ///
+    /// Only affects output stream logging; syslog() is still called on
+    /// the logging shard.
+    static void set_async_enabled(bool enabled) noexcept;
+
     /// Set the width of shard id field in log messages
     ///
     /// \c this_shard_id() is printed as a part of the prefix in logging
@@ -510,6 +525,7 @@ struct logging_settings final {
     bool with_color;
     logger_timestamp_style stdout_timestamp_style = logger_timestamp_style::real;
     logger_ostream_type logger_ostream = logger_ostream_type::stderr;
+    bool async_enabled = false;
 };
 
 /// Shortcut for configuring the logging system all at once.
@@ -520,6 +536,10 @@ void apply_logging_settings(const logging_settings&);
 
 extern thread_local uint64_t logging_failures;
 
+// Number of log lines this shard dropped because the asynchronous
+// writer's buffer was full, see \ref logger::set_async_enabled().
+extern thread_local uint64_t logging_dropped;
+
 sstring pretty_type_name(const std::type_info&);
 
 sstring level_name(log_level level);
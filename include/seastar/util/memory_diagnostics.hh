@@ -21,6 +21,10 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
 #include <seastar/core/sstring.hh>
 #include <seastar/util/noncopyable_function.hh>
 
@@ -85,6 +89,32 @@ void set_additional_diagnostics_producer(noncopyable_function<void(memory_diagno
 /// low-memory conditions.
 sstring generate_memory_diagnostics_report();
 
+/// One size class of the live-objects histogram.
+///
+/// \see live_objects_histogram()
+struct live_objects_entry {
+    /// Size, in bytes, of the objects in this size class.
+    size_t object_size;
+    /// Number of objects of this size class currently allocated.
+    uint64_t live_objects;
+};
+
+/// \brief Live small-object counts by size class for this lcore.
+///
+/// The counts are maintained by the allocation and free fast paths, so
+/// unlike \ref pool_diagnostics() sampling them does not walk the heap
+/// and is cheap enough for continuous collection; they are also exported
+/// through the `memory` metrics group. Entries are sorted by ascending
+/// object size. Supported only when the seastar allocator is enabled;
+/// returns an empty vector otherwise.
+std::vector<live_objects_entry> live_objects_histogram();
+
+/// \brief Number of live objects in the size class serving \p object_size.
+///
+/// \param object_size the exact object size of a size class, as reported
+///     by \ref live_objects_histogram(); other sizes return 0.
+uint64_t live_objects_in_pool(size_t object_size) noexcept;
+
 namespace internal {
 /// Log the memory diagnostics to the internal logger in the same way as
 /// during an allocation failure, at the given log level. These reports
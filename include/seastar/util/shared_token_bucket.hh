@@ -162,11 +162,14 @@ public:
         _rovers.release(tokens);
     }
 
-    void replenish(typename Clock::time_point now) noexcept {
+    // Returns the number of tokens that could not be put into the bucket
+    // because it (or the release cap) is full, i.e. the budget the bucket
+    // users left unclaimed for the replenish period.
+    T replenish(typename Clock::time_point now) noexcept {
         auto ts = _replenished.load(std::memory_order_relaxed);
 
         if (now <= ts) {
-            return;
+            return 0;
         }
 
         auto delta = now - ts;
@@ -174,11 +177,24 @@ public:
 
         if (extra >= _replenish_threshold) {
             if (!_replenished.compare_exchange_weak(ts, ts + delta)) {
-                return; // next time or another shard
+                return 0; // next time or another shard
             }
 
-            fetch_add(_rovers.head, std::min(extra, _rovers.max_extra(_replenish_limit)));
+            auto added = std::min(extra, _rovers.max_extra(_replenish_limit));
+            fetch_add(_rovers.head, added);
+            return extra - added;
         }
+
+        return 0;
+    }
+
+    // Adds tokens into the bucket out of the regular replenish schedule,
+    // still respecting the release cap. Returns the number of tokens that
+    // actually made it into the bucket.
+    T refill(T tokens) noexcept {
+        auto added = std::min(tokens, _rovers.max_extra(_replenish_limit));
+        fetch_add(_rovers.head, added);
+        return added;
     }
 
     T deficiency(T from) const noexcept {
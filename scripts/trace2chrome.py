@@ -0,0 +1,74 @@
+#!/bin/env python3
+#
+# Merge per-shard seastar binary trace dumps (see seastar/core/trace.hh)
+# and convert them to Chrome trace format, viewable in chrome://tracing
+# or https://ui.perfetto.dev
+#
+# Usage: trace2chrome.py trace.0.bin trace.1.bin ... > trace.json
+#
+
+import json
+import struct
+import sys
+
+HEADER = struct.Struct('<8sII')
+RECORD = struct.Struct('<QHHIQ')
+
+TASK_START = 1
+TASK_END = 2
+IO_DISPATCH = 3
+IO_COMPLETE = 4
+SLEEP_ENTER = 5
+SLEEP_EXIT = 6
+
+
+def read_dump(path):
+    with open(path, 'rb') as f:
+        data = f.read()
+    magic, shard, record_size = HEADER.unpack_from(data, 0)
+    if magic != b'SSTRACE1':
+        raise SystemExit(f'{path}: not a seastar trace dump')
+    if record_size != RECORD.size:
+        raise SystemExit(f'{path}: unsupported record size {record_size}')
+    for off in range(HEADER.size, len(data) - RECORD.size + 1, RECORD.size):
+        ts_ns, ev_type, a, b, arg = RECORD.unpack_from(data, off)
+        yield shard, ts_ns, ev_type, a, b, arg
+
+
+def to_chrome(records):
+    events = []
+    for shard, ts_ns, ev_type, a, b, arg in records:
+        common = {'pid': 0, 'tid': shard, 'ts': ts_ns / 1000.0}
+        if ev_type == TASK_START:
+            events.append(dict(common, ph='B', cat='task', name=f'sg {a}',
+                               args={'task': hex(arg)}))
+        elif ev_type == TASK_END:
+            events.append(dict(common, ph='E', cat='task', name=f'sg {a}'))
+        elif ev_type == IO_DISPATCH:
+            events.append(dict(common, ph='b', cat='io', id=hex(arg),
+                               name='write' if a else 'read',
+                               args={'bytes': b}))
+        elif ev_type == IO_COMPLETE:
+            events.append(dict(common, ph='e', cat='io', id=hex(arg),
+                               name='write' if a else 'read'))
+        elif ev_type == SLEEP_ENTER:
+            events.append(dict(common, ph='B', cat='reactor', name='sleep'))
+        elif ev_type == SLEEP_EXIT:
+            events.append(dict(common, ph='E', cat='reactor', name='sleep'))
+    events.sort(key=lambda e: e['ts'])
+    return events
+
+
+def main():
+    if len(sys.argv) < 2:
+        raise SystemExit(f'usage: {sys.argv[0]} dump...')
+    records = []
+    for path in sys.argv[1:]:
+        records.extend(read_dump(path))
+    records.sort(key=lambda r: r[1])
+    json.dump({'traceEvents': to_chrome(records),
+               'displayTimeUnit': 'ns'}, sys.stdout)
+
+
+if __name__ == '__main__':
+    main()
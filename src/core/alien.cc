@@ -25,6 +25,7 @@
 #include <seastar/core/metrics.hh>
 #include <seastar/core/prefetch.hh>
 #include <atomic>
+#include <cassert>
 #include <iterator>
 #include <memory>
 #include <vector>
@@ -145,5 +146,87 @@ bool instance::pure_poll_queues() {
 
 instance* internal::default_instance;
 
+adaptive_lock::adaptive_lock(instance& inst)
+    : _instance(inst)
+    // semaphore mode: each write wakes exactly one parked thread
+    , _efd(file_desc::eventfd(0, EFD_SEMAPHORE | EFD_CLOEXEC)) {
+}
+
+adaptive_lock::~adaptive_lock() {
+    assert(!_locked);
+    assert(!_parked);
+    assert(_reactor_waiters.empty());
+}
+
+bool adaptive_lock::try_lock() noexcept {
+    std::lock_guard guard(_mutex);
+    if (_locked) {
+        return false;
+    }
+    _locked = true;
+    return true;
+}
+
+void adaptive_lock::lock() {
+    for (unsigned i = 0; i < spin_iterations; ++i) {
+        if (try_lock()) {
+            return;
+        }
+        seastar::internal::cpu_relax();
+    }
+    {
+        std::lock_guard guard(_mutex);
+        if (!_locked) {
+            _locked = true;
+            return;
+        }
+        ++_parked;
+    }
+    // blocks until unlock() hands the lock over to us
+    uint64_t count;
+    _efd.read(&count, sizeof(count));
+}
+
+void adaptive_lock::unlock() {
+    std::unique_ptr<reactor_waiter> w;
+    {
+        std::lock_guard guard(_mutex);
+        assert(_locked);
+        if (_parked) {
+            // hand over to a parked alien thread; the lock stays held
+            --_parked;
+        } else if (!_reactor_waiters.empty()) {
+            w = std::move(_reactor_waiters.front());
+            _reactor_waiters.pop_front();
+        } else {
+            _locked = false;
+            return;
+        }
+    }
+    if (w) {
+        // make the future ready on its owning shard
+        run_on(_instance, w->shard, [w = w.release()]() noexcept {
+            w->pr.set_value();
+            delete w;
+        });
+        return;
+    }
+    uint64_t one = 1;
+    _efd.write(&one, sizeof(one));
+}
+
+future<> adaptive_lock::lock_async() {
+    std::lock_guard guard(_mutex);
+    if (!_locked) {
+        _locked = true;
+        return make_ready_future<>();
+    }
+    auto w = std::make_unique<reactor_waiter>();
+    w->shard = this_shard_id();
+    auto fut = w->pr.get_future();
+    _reactor_waiters.push_back(std::move(w));
+    return fut;
+}
+
 }
 }
@@ -0,0 +1,81 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB
+ */
+
+#include <seastar/core/internal/dma_buffer_pool.hh>
+#include <seastar/core/aligned_buffer.hh>
+#include <utility>
+
+namespace seastar {
+namespace internal {
+
+thread_local dma_buffer_pool g_dma_buffer_pool;
+
+#ifdef SEASTAR_BUILD_SHARED_LIBS
+dma_buffer_pool& local_dma_buffer_pool() noexcept {
+    return g_dma_buffer_pool;
+}
+#endif
+
+dma_buffer_pool::~dma_buffer_pool() {
+    for (unsigned cls = 0; cls < nr_classes; cls++) {
+        while (_free[cls]) {
+            auto ptr = std::exchange(_free[cls], _free[cls]->next);
+            if (_on_destroy) {
+                _on_destroy(ptr, class_size(cls));
+            }
+            std::free(ptr);
+        }
+    }
+}
+
+void dma_buffer_pool::set_registration_hooks(buffer_hook on_create, buffer_hook on_destroy) {
+    _on_create = std::move(on_create);
+    _on_destroy = std::move(on_destroy);
+}
+
+void* dma_buffer_pool::take(size_t bytes) {
+    auto cls = size_class(bytes);
+    if (_free[cls]) {
+        _pooled_bytes -= bytes;
+        return std::exchange(_free[cls], _free[cls]->next);
+    }
+    auto ptr = allocate_aligned_buffer_impl(bytes, buffer_alignment);
+    if (_on_create) {
+        _on_create(ptr, bytes);
+    }
+    return ptr;
+}
+
+void dma_buffer_pool::put_back(void* ptr, unsigned cls, size_t bytes) noexcept {
+    if (_pooled_bytes + bytes <= max_pooled_bytes) {
+        auto b = reinterpret_cast<free_buffer*>(ptr);
+        b->next = std::exchange(_free[cls], b);
+        _pooled_bytes += bytes;
+        return;
+    }
+    if (_on_destroy) {
+        _on_destroy(ptr, bytes);
+    }
+    std::free(ptr);
+}
+
+} // namespace internal
+} // namespace seastar
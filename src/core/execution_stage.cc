@@ -24,6 +24,11 @@
 #include <seastar/core/make_task.hh>
 #include <seastar/util/defer.hh>
 
+#include <linux/perf_event.h>
+#include <asm/unistd.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
 namespace seastar {
 
 namespace internal {
@@ -82,6 +87,78 @@ execution_stage_manager& execution_stage_manager::get() noexcept {
     return instance;
 }
 
+stage_batch_tuner::stage_batch_tuner(size_t min_batch, size_t max_batch) noexcept
+    : _batch_size(max_batch)
+    , _min_batch(min_batch)
+    , _max_batch(max_batch)
+{
+    ::perf_event_attr pea = {
+        .type = PERF_TYPE_HW_CACHE,
+        .size = sizeof(pea),
+        .config = PERF_COUNT_HW_CACHE_L1I
+                | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+        .exclude_kernel = 1,
+        .exclude_hv = 1,
+    };
+    // Failure (-1) is fine and simply leaves the tuner disabled; it can
+    // happen in constrained environments such as containers.
+    _fd = ::syscall(__NR_perf_event_open, &pea, 0, -1, -1, 0);
+}
+
+stage_batch_tuner::~stage_batch_tuner() {
+    if (_fd != -1) {
+        ::close(_fd);
+    }
+}
+
+uint64_t stage_batch_tuner::read_counter() noexcept {
+    uint64_t ret = 0;
+    if (::read(_fd, &ret, sizeof(ret)) != sizeof(ret)) {
+        return 0;
+    }
+    return ret;
+}
+
+void stage_batch_tuner::batch_begin() noexcept {
+    if (_fd == -1) {
+        return;
+    }
+    _batch_start = read_counter();
+}
+
+void stage_batch_tuner::batch_end(size_t calls) noexcept {
+    if (_fd == -1 || !calls) {
+        return;
+    }
+    _misses += read_counter() - _batch_start;
+    _calls += calls;
+    // Adapt only once enough calls have been sampled at the current batch
+    // size, so a single noisy batch does not flip the direction.
+    static constexpr uint64_t epoch_calls = 4096;
+    if (_calls >= epoch_calls) {
+        adapt();
+    }
+}
+
+void stage_batch_tuner::adapt() noexcept {
+    // Multiplicative hill climbing: compare this epoch's misses per call
+    // with the previous epoch's and keep moving the batch size in the same
+    // direction while the cost improves, reversing when it does not.
+    auto cost = double(_misses) / double(_calls);
+    if (cost > _prev_cost) {
+        _direction = -_direction;
+    }
+    _prev_cost = cost;
+    if (_direction > 0) {
+        _batch_size = std::min(_batch_size * 2, _max_batch);
+    } else {
+        _batch_size = std::max(_batch_size / 2, _min_batch);
+    }
+    _misses = 0;
+    _calls = 0;
+}
+
 }
 
 execution_stage::~execution_stage()
@@ -94,6 +171,7 @@ execution_stage::execution_stage(execution_stage&& other)
     , _stats(other._stats)
     , _name(std::move(other._name))
     , _metric_group(std::move(other._metric_group))
+    , _batch_tuner(std::move(other._batch_tuner))
 {
     internal::execution_stage_manager::get().update_execution_stage_registration(other, *this);
 }
@@ -133,6 +211,10 @@ execution_stage::execution_stage(const sstring& name, scheduling_group sg)
     undo.cancel();
 }
 
+void execution_stage::enable_adaptive_batch(size_t min_batch, size_t max_batch) {
+    _batch_tuner = std::make_unique<internal::stage_batch_tuner>(min_batch, max_batch);
+}
+
 bool execution_stage::flush() noexcept {
     if (_empty || _flush_scheduled) {
         return false;
@@ -112,9 +112,46 @@ fair_group::fair_group(config cfg)
     }
 }
 
+void fair_group::capacity_pool::deposit(capacity_t cap) noexcept {
+    auto cur = _spare.load(std::memory_order_relaxed);
+    while (cur < _limit) {
+        if (_spare.compare_exchange_weak(cur, std::min(cur + cap, _limit), std::memory_order_relaxed)) {
+            break;
+        }
+    }
+}
+
+auto fair_group::capacity_pool::claim(capacity_t upto) noexcept -> capacity_t {
+    auto cur = _spare.load(std::memory_order_relaxed);
+    while (cur > 0) {
+        auto lease = std::min(cur, upto);
+        if (_spare.compare_exchange_weak(cur, cur - lease, std::memory_order_relaxed)) {
+            return lease;
+        }
+    }
+    return 0;
+}
+
 auto fair_group::grab_capacity(capacity_t cap) noexcept -> capacity_t {
     assert(cap <= _token_bucket.limit());
-    return _token_bucket.grab(cap);
+    capacity_t want_head = _token_bucket.grab(cap);
+    if (_spare_pool != nullptr) {
+        auto short_by = _token_bucket.deficiency(want_head);
+        if (short_by > 0) {
+            // The group's own budget is exhausted -- lease the shortfall
+            // from capacity peer groups left unused. The lease is bounded
+            // by the shortfall and by what refill() accepts; the remainder
+            // goes back to the pool.
+            auto lease = _spare_pool->claim(short_by);
+            if (lease > 0) {
+                auto used = _token_bucket.refill(lease);
+                if (used < lease) {
+                    _spare_pool->deposit(lease - used);
+                }
+            }
+        }
+    }
+    return want_head;
 }
 
 void fair_group::release_capacity(capacity_t cap) noexcept {
@@ -122,7 +159,10 @@ void fair_group::release_capacity(capacity_t cap) noexcept {
 }
 
 void fair_group::replenish_capacity(clock_type::time_point now) noexcept {
-    _token_bucket.replenish(now);
+    auto surplus = _token_bucket.replenish(now);
+    if (_spare_pool != nullptr && surplus > 0) {
+        _spare_pool->deposit(surplus);
+    }
 }
 
 void fair_group::maybe_replenish_capacity(clock_type::time_point& local_ts) noexcept {
@@ -144,26 +184,96 @@ auto fair_group::ticket_capacity(fair_queue_ticket t) const noexcept -> capacity
 }
 
 // Priority class, to be used with a given fair_queue
-class fair_queue::priority_class_data {
+class fair_queue::priority_class_data : public fair_queue::dispatch_node {
     friend class fair_queue;
-    uint32_t _shares = 0;
-    capacity_t _accumulated = 0;
+    class_group_data* _parent;
     capacity_t _pure_accumulated = 0;
     fair_queue_entry::container_list_t _queue;
-    bool _queued = false;
+    // The deadline lane -- entries carrying a target completion time,
+    // kept sorted by deadline. It's served ahead of _queue, but from
+    // the same share budget, so it shortens the class's internal
+    // latency without affecting inter-class fairness.
+    fair_queue_entry::container_list_t _edf_queue;
     bool _plugged = true;
 
 public:
-    explicit priority_class_data(uint32_t shares) noexcept : _shares(std::max(shares, 1u)) {}
+    explicit priority_class_data(uint32_t shares, class_group_data* parent = nullptr) noexcept
+        : dispatch_node(shares, false)
+        , _parent(parent) {}
     priority_class_data(const priority_class_data&) = delete;
     priority_class_data(priority_class_data&&) = delete;
 
-    void update_shares(uint32_t shares) noexcept {
-        _shares = (std::max(shares, 1u));
+    bool queues_empty() const noexcept {
+        return _queue.empty() && _edf_queue.empty();
+    }
+
+    fair_queue_entry& front() noexcept {
+        return _edf_queue.empty() ? _queue.front() : _edf_queue.front();
+    }
+
+    void pop_front() noexcept {
+        if (_edf_queue.empty()) {
+            _queue.pop_front();
+        } else {
+            _edf_queue.pop_front();
+        }
+    }
+};
+
+// A group of priority classes (a "service") -- the middle level of the
+// class tree. Dispatching first picks the least-accumulated top-level
+// node (a group or an ungrouped class), then the least-accumulated
+// member class within the group, and the dispatched capacity is charged
+// on both levels -- to the class scaled by the class shares and to the
+// group scaled by the group shares. This keeps the tenants of one
+// service fair against each other regardless of how the service itself
+// is weighted or capped.
+class fair_queue::class_group_data : public fair_queue::dispatch_node {
+    friend class fair_queue;
+    // Cap on the dispatch rate of the whole group, as a fraction of the
+    // fair_group rate (zero means uncapped), enforced with a local token
+    // bucket running on the fair_group's replenish timeline. A full
+    // bucket admits at least one request, so a group whose burst
+    // allowance is smaller than a single request still makes progress.
+    const float _cap;
+    const capacity_t _cap_burst;
+    capacity_t _cap_tokens;
+    clock_type::time_point _cap_replenish;
+    capacity_t _last_accumulated = 0;
+    priority_queue _handles;
+    size_t _nr_classes = 0;
+
+public:
+    class_group_data(uint32_t shares, float cap, const fair_group& fg) noexcept
+        : dispatch_node(shares, true)
+        , _cap(cap)
+        , _cap_burst(cap > 0.0f ? std::max<capacity_t>(fg.maximum_capacity() * cap, 1) : 0)
+        , _cap_tokens(_cap_burst)
+        , _cap_replenish(fg.replenished_ts()) {}
+    class_group_data(const class_group_data&) = delete;
+    class_group_data(class_group_data&&) = delete;
+
+    bool cap_allows(capacity_t cap, const fair_group& fg) noexcept {
+        if (_cap == 0.0f) {
+            return true;
+        }
+        auto now = fg.replenished_ts();
+        auto extra = capacity_t(fg.accumulated_in(now - _cap_replenish) * _cap);
+        if (extra > 0) {
+            _cap_tokens = std::min(_cap_burst, _cap_tokens + extra);
+            _cap_replenish = now;
+        }
+        return _cap_tokens >= std::min(cap, _cap_burst);
+    }
+
+    void consume_cap(capacity_t cap) noexcept {
+        if (_cap > 0.0f) {
+            _cap_tokens -= std::min(cap, _cap_tokens);
+        }
     }
 };
 
-bool fair_queue::class_compare::operator() (const priority_class_ptr& lhs, const priority_class_ptr & rhs) const noexcept {
+bool fair_queue::class_compare::operator() (const dispatch_node_ptr& lhs, const dispatch_node_ptr& rhs) const noexcept {
     return lhs->_accumulated > rhs->_accumulated;
 }
 
@@ -184,6 +294,7 @@ fair_queue::fair_queue(fair_queue&& other)
     , _requests_queued(std::exchange(other._requests_queued, 0))
     , _handles(std::move(other._handles))
     , _priority_classes(std::move(other._priority_classes))
+    , _class_groups(std::move(other._class_groups))
     , _last_accumulated(other._last_accumulated)
 {
 }
@@ -192,12 +303,16 @@ fair_queue::~fair_queue() {
     for (const auto& fq : _priority_classes) {
         assert(!fq);
     }
+    for (const auto& cg : _class_groups) {
+        assert(!cg);
+    }
 }
 
 void fair_queue::push_priority_class(priority_class_data& pc) noexcept {
     assert(pc._plugged && !pc._queued);
-    _handles.assert_enough_capacity();
-    _handles.push(&pc);
+    auto& handles = pc._parent != nullptr ? pc._parent->_handles : _handles;
+    handles.assert_enough_capacity();
+    handles.push(&pc);
     pc._queued = true;
 }
 
@@ -212,23 +327,68 @@ void fair_queue::push_priority_class_from_idle(priority_class_data& pc) noexcept
         // introduce extra if's for that short corner case, use signed
         // arithmetics and make sure the _accumulated value doesn't grow
         // over signed maximum (see overflow check below)
-        pc._accumulated = std::max<signed_capacity_t>(_last_accumulated - max_deviation, pc._accumulated);
-        _handles.assert_enough_capacity();
-        _handles.push(&pc);
+        auto& handles = pc._parent != nullptr ? pc._parent->_handles : _handles;
+        capacity_t last_accumulated = pc._parent != nullptr ? pc._parent->_last_accumulated : _last_accumulated;
+        pc._accumulated = std::max<signed_capacity_t>(last_accumulated - max_deviation, pc._accumulated);
+        handles.assert_enough_capacity();
+        handles.push(&pc);
         pc._queued = true;
     }
+    if (pc._parent != nullptr) {
+        push_group_from_idle(*pc._parent);
+    }
+}
+
+void fair_queue::push_group_from_idle(class_group_data& g) noexcept {
+    if (!g._queued) {
+        // same tau-bounded deviation as for classes, with the group shares
+        capacity_t max_deviation = fair_group::fixed_point_factor / g._shares * fair_group::token_bucket_t::rate_cast(_config.tau).count();
+        g._accumulated = std::max<signed_capacity_t>(_last_accumulated - max_deviation, g._accumulated);
+        _handles.assert_enough_capacity();
+        _handles.push(&g);
+        g._queued = true;
+    }
 }
 
 void fair_queue::pop_priority_class(priority_class_data& pc) noexcept {
     assert(pc._plugged && pc._queued);
     pc._queued = false;
-    _handles.pop();
+    (pc._parent != nullptr ? pc._parent->_handles : _handles).pop();
+}
+
+void fair_queue::charge(dispatch_node& n, capacity_t req_cost, class_group_data* domain) noexcept {
+    // signed overflow check to make push_priority_class_from_idle math work
+    if (n._accumulated >= std::numeric_limits<signed_capacity_t>::max() - req_cost) {
+        auto rebase = [&n] (dispatch_node& peer) {
+            if (peer._queued) {
+                peer._accumulated -= n._accumulated;
+            } else { // this includes n
+                peer._accumulated = 0;
+            }
+        };
+        for (auto& pc : _priority_classes) {
+            if (pc && pc->_parent == domain) {
+                rebase(*pc);
+            }
+        }
+        if (domain == nullptr) {
+            for (auto& cg : _class_groups) {
+                if (cg) {
+                    rebase(*cg);
+                }
+            }
+            _last_accumulated = 0;
+        } else {
+            domain->_last_accumulated = 0;
+        }
+    }
+    n._accumulated += req_cost;
 }
 
 void fair_queue::plug_priority_class(priority_class_data& pc) noexcept {
     assert(!pc._plugged && !pc._queued);
     pc._plugged = true;
-    if (!pc._queue.empty()) {
+    if (!pc.queues_empty()) {
         push_priority_class_from_idle(pc);
     }
 }
@@ -291,18 +451,63 @@ void fair_queue::register_priority_class(class_id id, uint32_t shares) {
         assert(!_priority_classes[id]);
     }
 
-    _handles.reserve(_nr_classes + 1);
+    _handles.reserve(_nr_classes + _nr_groups + 1);
     _priority_classes[id] = std::make_unique<priority_class_data>(shares);
     _nr_classes++;
 }
 
+void fair_queue::register_priority_class(class_id id, uint32_t shares, group_id parent) {
+    assert(parent < _class_groups.size() && _class_groups[parent]);
+    if (id >= _priority_classes.size()) {
+        _priority_classes.resize(id + 1);
+    } else {
+        assert(!_priority_classes[id]);
+    }
+
+    auto& g = *_class_groups[parent];
+    g._handles.reserve(g._nr_classes + 1);
+    _priority_classes[id] = std::make_unique<priority_class_data>(shares, &g);
+    g._nr_classes++;
+    _nr_classes++;
+}
+
 void fair_queue::unregister_priority_class(class_id id) {
     auto& pclass = _priority_classes[id];
-    assert(pclass && pclass->_queue.empty());
+    assert(pclass && pclass->queues_empty());
+    if (pclass->_parent != nullptr) {
+        pclass->_parent->_nr_classes--;
+    }
     pclass.reset();
     _nr_classes--;
 }
 
+void fair_queue::register_class_group(group_id id, uint32_t shares, float cap) {
+    assert(cap >= 0.0f && cap <= 1.0f);
+    if (id >= _class_groups.size()) {
+        _class_groups.resize(id + 1);
+    } else {
+        assert(!_class_groups[id]);
+    }
+
+    _handles.reserve(_nr_classes + _nr_groups + 1);
+    _class_groups[id] = std::make_unique<class_group_data>(shares, cap, _group);
+    _nr_groups++;
+}
+
+void fair_queue::unregister_class_group(group_id id) {
+    auto& grp = _class_groups[id];
+    assert(grp && grp->_nr_classes == 0);
+    grp.reset();
+    _nr_groups--;
+}
+
+void fair_queue::update_shares_for_class_group(group_id id, uint32_t shares) {
+    assert(id < _class_groups.size());
+    auto& grp = _class_groups[id];
+    assert(grp);
+    grp->update_shares(shares);
+}
+
 void fair_queue::update_shares_for_class(class_id id, uint32_t shares) {
     assert(id < _priority_classes.size());
     auto& pc = _priority_classes[id];
@@ -334,7 +539,19 @@ void fair_queue::queue(class_id id, fair_queue_entry& ent) noexcept {
     if (pc._plugged) {
         push_priority_class_from_idle(pc);
     }
-    pc._queue.push_back(ent);
+    if (ent._deadline != fair_queue_entry::no_deadline) {
+        // Keep the deadline lane sorted; commit-log style classes queue
+        // shallowly, so the linear scan is short in practice
+        auto prev = pc._edf_queue.before_begin();
+        auto cur = pc._edf_queue.begin();
+        while (cur != pc._edf_queue.end() && cur->_deadline <= ent._deadline) {
+            prev = cur;
+            ++cur;
+        }
+        pc._edf_queue.insert_after(prev, ent);
+    } else {
+        pc._queue.push_back(ent);
+    }
     _resources_queued += ent._ticket;
     _requests_queued++;
 }
@@ -372,30 +589,80 @@ fair_queue::clock_type::time_point fair_queue::next_pending_aio() const noexcept
 
 void fair_queue::dispatch_requests(std::function<void(fair_queue_entry&)> cb) {
     capacity_t dispatched = 0;
-    boost::container::small_vector<priority_class_ptr, 2> preempt;
+    boost::container::small_vector<dispatch_node_ptr, 2> preempt;
+    boost::container::small_vector<dispatch_node_ptr, 2> capped;
+
+    // pushes a stashed top-level node (an ungrouped class or a group)
+    // back into the dispatch heap
+    auto repush = [this] (dispatch_node_ptr n) noexcept {
+        _handles.assert_enough_capacity();
+        _handles.push(n);
+        n->_queued = true;
+    };
 
     while (!_handles.empty() && (dispatched < _group.maximum_capacity() / smp::count)) {
-        priority_class_data& h = *_handles.top();
-        if (h._queue.empty()) {
-            pop_priority_class(h);
+        dispatch_node& top = *_handles.top();
+        class_group_data* grp = nullptr;
+        priority_class_ptr hp = nullptr;
+        if (top._is_group) {
+            grp = static_cast<class_group_data*>(&top);
+            // drained member classes fall off the group heap lazily, the
+            // same way empty classes fall off the top-level heap below
+            while (!grp->_handles.empty()) {
+                auto& member = *static_cast<priority_class_data*>(grp->_handles.top());
+                if (member.queues_empty()) {
+                    pop_priority_class(member);
+                } else {
+                    hp = &member;
+                    break;
+                }
+            }
+            if (hp == nullptr) {
+                grp->_queued = false;
+                _handles.pop();
+                continue;
+            }
+        } else {
+            hp = static_cast<priority_class_data*>(&top);
+            if (hp->queues_empty()) {
+                pop_priority_class(*hp);
+                continue;
+            }
+        }
+
+        priority_class_data& h = *hp;
+        auto& req = h.front();
+        auto req_cap = _group.ticket_capacity(req._ticket);
+
+        if (grp != nullptr && !grp->cap_allows(req_cap, _group)) {
+            // set the capped group aside until its bucket refills so that
+            // other top-level nodes can be served meanwhile
+            grp->_queued = false;
+            _handles.pop();
+            capped.emplace_back(grp);
             continue;
         }
 
-        auto& req = h._queue.front();
         auto gr = grab_capacity(req);
         if (gr == grab_result::pending) {
             break;
         }
 
         if (gr == grab_result::cant_preempt) {
-            pop_priority_class(h);
-            preempt.emplace_back(&h);
+            top._queued = false;
+            _handles.pop();
+            preempt.emplace_back(&top);
             continue;
         }
 
-        _last_accumulated = std::max(h._accumulated, _last_accumulated);
-        pop_priority_class(h);
-        h._queue.pop_front();
+        _last_accumulated = std::max(top._accumulated, _last_accumulated);
+        top._queued = false;
+        _handles.pop();
+        if (grp != nullptr) {
+            grp->_last_accumulated = std::max(h._accumulated, grp->_last_accumulated);
+            pop_priority_class(h);
+        }
+        h.pop_front();
 
         _resources_executing += req._ticket;
         _resources_queued -= req._ticket;
@@ -406,34 +673,31 @@ void fair_queue::dispatch_requests(std::function<void(fair_queue_entry&)> cb) {
         // unrestricted queue it can be as low as 2k. With large enough shares this
         // has chances to be translated into zero cost which, in turn, will make the
         // class show no progress and monopolize the queue.
-        auto req_cap = _group.ticket_capacity(req._ticket);
-        auto req_cost  = std::max(req_cap / h._shares, (capacity_t)1);
-        // signed overflow check to make push_priority_class_from_idle math work
-        if (h._accumulated >= std::numeric_limits<signed_capacity_t>::max() - req_cost) {
-            for (auto& pc : _priority_classes) {
-                if (pc) {
-                    if (pc->_queued) {
-                        pc->_accumulated -= h._accumulated;
-                    } else { // this includes h
-                        pc->_accumulated = 0;
-                    }
-                }
-            }
-            _last_accumulated = 0;
-        }
-        h._accumulated += req_cost;
+        charge(h, std::max(req_cap / h._shares, (capacity_t)1), h._parent);
         h._pure_accumulated += req_cap;
+        if (grp != nullptr) {
+            // the group pays for its member's dispatch at the top level,
+            // scaled by the group shares
+            charge(*grp, std::max(req_cap / grp->_shares, (capacity_t)1), nullptr);
+            grp->consume_cap(req_cap);
+        }
 
-        dispatched += _group.ticket_capacity(req._ticket);
+        dispatched += req_cap;
         cb(req);
 
-        if (h._plugged && !h._queue.empty()) {
+        if (h._plugged && !h.queues_empty()) {
             push_priority_class(h);
         }
+        if (grp != nullptr && !grp->_handles.empty()) {
+            repush(grp);
+        }
     }
 
-    for (auto&& h : preempt) {
-        push_priority_class(*h);
+    for (auto&& n : preempt) {
+        repush(n);
+    }
+    for (auto&& n : capped) {
+        repush(n);
     }
 }
 
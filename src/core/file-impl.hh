@@ -98,7 +98,12 @@ public:
     future<int> fcntl(int op, uintptr_t arg) noexcept override;
     future<int> fcntl_short(int op, uintptr_t arg) noexcept override;
     virtual future<> allocate(uint64_t position, uint64_t length) noexcept override;
+    future<std::vector<file_extent>> query_extents(uint64_t offset, uint64_t length) noexcept override;
+    future<> discard_ranges(std::vector<file_range> ranges) noexcept override;
     future<uint64_t> size() noexcept override;
+    virtual std::optional<int> native_fd() const noexcept override {
+        return _fd;
+    }
     // close() never fails. It just reports errors and swallows them.
     // The user must call flush() first if they care aout stable storage semantics.
     virtual future<> close() noexcept override;
@@ -131,6 +136,13 @@ public:
         return _open_flags;
     }
 private:
+    // FIEMAP result for the whole file, cached until the next mutating
+    // operation through this impl (see invalidate_extent_map()).
+    std::optional<std::vector<file_extent>> _extent_map;
+
+    void invalidate_extent_map() noexcept {
+        _extent_map = std::nullopt;
+    }
     void configure_dma_alignment(const internal::fs_info& fsi);
     void configure_io_lengths() noexcept;
 
@@ -295,4 +307,10 @@ public:
     virtual future<temporary_buffer<uint8_t>> dma_read_bulk(uint64_t offset, size_t range_size, const io_priority_class& pc, io_intent* intent) noexcept override;
 };
 
+// NVMe generic character devices (/dev/ngXnY) are driven by the
+// passthrough backend in nvme-passthrough.cc, which submits NVMe
+// commands directly over io_uring, bypassing the kernel block layer.
+bool is_nvme_generic_device(dev_t device_id) noexcept;
+future<shared_ptr<file_impl>> make_nvme_passthrough_file_impl(int fd, open_flags flags, file_open_options options, dev_t device_id) noexcept;
+
 }
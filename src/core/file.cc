@@ -24,7 +24,8 @@
 #include <sys/syscall.h>
 #include <dirent.h>
 #include <linux/types.h> // for xfs, below
-#include <linux/fs.h> // BLKBSZGET
+#include <linux/fiemap.h>
+#include <linux/fs.h> // BLKBSZGET, FS_IOC_FIEMAP
 #include <linux/major.h>
 #include <sys/ioctl.h>
 #include <unistd.h>
@@ -192,6 +193,7 @@ posix_file_impl::stat() noexcept {
 
 future<>
 posix_file_impl::truncate(uint64_t length) noexcept {
+    invalidate_extent_map();
     return engine()._thread_pool->submit<syscall_result<int>>([this, length] {
         return wrap_syscall<int>(::ftruncate(_fd, length));
     }).then([] (syscall_result<int> sr) {
@@ -244,6 +246,7 @@ posix_file_impl::fcntl_short(int op, uintptr_t arg) noexcept {
 
 future<>
 posix_file_impl::discard(uint64_t offset, uint64_t length) noexcept {
+    invalidate_extent_map();
     return engine()._thread_pool->submit<syscall_result<int>>([this, offset, length] () mutable {
         return wrap_syscall<int>(::fallocate(_fd, FALLOC_FL_PUNCH_HOLE|FALLOC_FL_KEEP_SIZE,
             offset, length));
@@ -253,8 +256,91 @@ posix_file_impl::discard(uint64_t offset, uint64_t length) noexcept {
     });
 }
 
+future<>
+posix_file_impl::discard_ranges(std::vector<file_range> ranges) noexcept {
+    invalidate_extent_map();
+    auto merged = internal::merge_file_ranges(std::move(ranges));
+    if (merged.empty()) {
+        return make_ready_future<>();
+    }
+    return engine()._thread_pool->submit<syscall_result<int>>([this, merged = std::move(merged)] () mutable {
+        int ret = 0;
+        for (auto& r : merged) {
+            ret = ::fallocate(_fd, FALLOC_FL_PUNCH_HOLE|FALLOC_FL_KEEP_SIZE, r.offset, r.length);
+            if (ret == -1) {
+                break;
+            }
+        }
+        return wrap_syscall<int>(ret);
+    }).then([] (syscall_result<int> sr) {
+        sr.throw_if_error();
+        return make_ready_future<>();
+    });
+}
+
+// Runs on the syscall thread. Returns -1 with errno set on failure.
+static int read_extent_map(int fd, std::vector<file_extent>& out) {
+    static constexpr unsigned extents_per_call = 64;
+    alignas(struct fiemap) char buf[sizeof(struct fiemap) + extents_per_call * sizeof(struct fiemap_extent)];
+    auto* fm = reinterpret_cast<struct fiemap*>(buf);
+    uint64_t start = 0;
+    bool last = false;
+    while (!last) {
+        memset(buf, 0, sizeof(buf));
+        fm->fm_start = start;
+        fm->fm_length = FIEMAP_MAX_OFFSET - start;
+        fm->fm_flags = FIEMAP_FLAG_SYNC;
+        fm->fm_extent_count = extents_per_call;
+        if (::ioctl(fd, FS_IOC_FIEMAP, fm) == -1) {
+            return -1;
+        }
+        if (fm->fm_mapped_extents == 0) {
+            break;
+        }
+        for (unsigned i = 0; i < fm->fm_mapped_extents; i++) {
+            auto& fe = fm->fm_extents[i];
+            out.push_back(file_extent{fe.fe_logical, fe.fe_length, bool(fe.fe_flags & FIEMAP_EXTENT_UNWRITTEN)});
+            last |= bool(fe.fe_flags & FIEMAP_EXTENT_LAST);
+            start = fe.fe_logical + fe.fe_length;
+        }
+    }
+    return 0;
+}
+
+static std::vector<file_extent> filter_extents(const std::vector<file_extent>& map, uint64_t offset, uint64_t length) {
+    auto end = length > std::numeric_limits<uint64_t>::max() - offset ? std::numeric_limits<uint64_t>::max() : offset + length;
+    std::vector<file_extent> res;
+    for (auto& e : map) {
+        if (e.offset < end && offset < e.offset + e.length) {
+            res.push_back(e);
+        }
+    }
+    return res;
+}
+
+future<std::vector<file_extent>>
+posix_file_impl::query_extents(uint64_t offset, uint64_t length) noexcept {
+  try {
+    if (_extent_map) {
+        return make_ready_future<std::vector<file_extent>>(filter_extents(*_extent_map, offset, length));
+    }
+    auto map = std::make_unique<std::vector<file_extent>>();
+    auto& m = *map;
+    return engine()._thread_pool->submit<syscall_result<int>>([this, &m] {
+        return wrap_syscall<int>(read_extent_map(_fd, m));
+    }).then([this, map = std::move(map), offset, length] (syscall_result<int> sr) {
+        sr.throw_if_error();
+        _extent_map = std::move(*map);
+        return make_ready_future<std::vector<file_extent>>(filter_extents(*_extent_map, offset, length));
+    });
+  } catch (...) {
+    return current_exception_as_future<std::vector<file_extent>>();
+  }
+}
+
 future<>
 posix_file_impl::allocate(uint64_t position, uint64_t length) noexcept {
+    invalidate_extent_map();
 #ifdef FALLOC_FL_ZERO_RANGE
     // FALLOC_FL_ZERO_RANGE is fairly new, so don't fail if it's not supported.
     static bool supported = true;
@@ -422,12 +508,14 @@ posix_file_impl::list_directory(std::function<future<> (directory_entry de)> nex
 
 future<size_t>
 posix_file_impl::do_write_dma(uint64_t pos, const void* buffer, size_t len, const io_priority_class& io_priority_class, io_intent* intent) noexcept {
+    invalidate_extent_map();
     auto req = internal::io_request::make_write(_fd, pos, buffer, len, _nowait_works);
     return _io_queue.submit_io_write(io_priority_class, len, std::move(req), intent);
 }
 
 future<size_t>
 posix_file_impl::do_write_dma(uint64_t pos, std::vector<iovec> iov, const io_priority_class& io_priority_class, io_intent* intent) noexcept {
+    invalidate_extent_map();
     auto len = internal::sanitize_iovecs(iov, _disk_write_dma_alignment);
     auto req = internal::io_request::make_writev(_fd, pos, iov, _nowait_works);
     return _io_queue.submit_io_write(io_priority_class, len, std::move(req), intent, std::move(iov));
@@ -541,7 +629,7 @@ posix_file_impl::read_maybe_eof(uint64_t pos, size_t len, const io_priority_clas
     // We have to allocate a new aligned buffer to make sure we don't get
     // an EINVAL error due to unaligned destination buffer.
     //
-    temporary_buffer<uint8_t> buf = temporary_buffer<uint8_t>::aligned(
+    temporary_buffer<uint8_t> buf = internal::local_dma_buffer_pool().allocate<uint8_t>(
                _memory_dma_alignment, align_up(len, size_t(_disk_read_dma_alignment)));
 
     // try to read a single bulk from the given position
@@ -1012,6 +1100,8 @@ make_file_impl(int fd, file_open_options options, int flags) noexcept {
                         std::system_error(errno, std::system_category(), "ioctl(BLKBSZGET) failed"));
             }
             return make_ready_future<shared_ptr<file_impl>>(make_shared<blockdev_file_impl>(fd, open_flags(flags), options, st.st_rdev, block_size));
+        } else if (S_ISCHR(st.st_mode) && is_nvme_generic_device(st.st_rdev)) {
+            return make_nvme_passthrough_file_impl(fd, open_flags(flags), std::move(options), st.st_rdev);
         } else {
             if (S_ISDIR(st.st_mode)) {
                 // Directories don't care about block size, so we need not
@@ -1095,6 +1185,10 @@ future<uint64_t> file::size() const noexcept {
   }
 }
 
+std::optional<int> file::native_fd() const noexcept {
+    return _file_impl->native_fd();
+}
+
 future<> file::close() noexcept {
     auto f = std::move(_file_impl);
     return f->close().handle_exception([f = std::move(f)] (std::exception_ptr ex) {
@@ -1188,6 +1282,22 @@ future<> file::discard(uint64_t offset, uint64_t length) noexcept {
   }
 }
 
+future<> file::discard_ranges(std::vector<file_range> ranges) noexcept {
+  try {
+    return _file_impl->discard_ranges(std::move(ranges));
+  } catch (...) {
+    return current_exception_as_future();
+  }
+}
+
+future<std::vector<file_extent>> file::query_extents(uint64_t offset, uint64_t length) noexcept {
+  try {
+    return _file_impl->query_extents(offset, length);
+  } catch (...) {
+    return current_exception_as_future<std::vector<file_extent>>();
+  }
+}
+
 future<> file::allocate(uint64_t position, uint64_t length) noexcept {
   try {
     return _file_impl->allocate(position, length);
@@ -1276,6 +1386,44 @@ file::dma_read_impl(uint64_t aligned_pos, uint8_t* aligned_buffer, size_t aligne
   }
 }
 
+future<size_t>
+file::dma_read_scattered_impl(std::vector<std::pair<uint64_t, size_t>> extents, uint8_t* buffer, const io_priority_class& pc, io_intent* intent) noexcept {
+  try {
+    // The buffer is packed in extent order, so extents that are contiguous
+    // on disk are also contiguous in memory and collapse into a single run,
+    // each of which is submitted as one I/O.
+    struct run {
+        uint64_t pos;
+        uint8_t* ptr;
+        size_t len;
+    };
+    std::vector<run> runs;
+    auto p = buffer;
+    for (auto&& [pos, len] : extents) {
+        if (len == 0) {
+            continue;
+        }
+        if (!runs.empty() && runs.back().pos + runs.back().len == pos) {
+            runs.back().len += len;
+        } else {
+            runs.push_back(run{pos, p, len});
+        }
+        p += len;
+    }
+    return do_with(std::move(runs), size_t(0), [this, &pc, intent] (std::vector<run>& runs, size_t& total) {
+        return parallel_for_each(runs, [this, &pc, intent, &total] (run& r) {
+            return _file_impl->read_dma(r.pos, r.ptr, r.len, pc, intent).then([&total] (size_t n) {
+                total += n;
+            });
+        }).then([&total] {
+            return total;
+        });
+    });
+  } catch (...) {
+    return current_exception_as_future<size_t>();
+  }
+}
+
 seastar::file_handle
 file::dup() {
     return seastar::file_handle(_file_impl->dup());
@@ -1306,6 +1454,42 @@ future<int> file_impl::fcntl_short(int op, uintptr_t arg) noexcept {
     return make_exception_future<int>(std::runtime_error("this file type does not support fcntl_short"));
 }
 
+future<std::vector<file_extent>> file_impl::query_extents(uint64_t offset, uint64_t length) {
+    return make_exception_future<std::vector<file_extent>>(std::runtime_error("this file type does not support extent queries"));
+}
+
+future<> file_impl::discard_ranges(std::vector<file_range> ranges) {
+    // Merging still saves discard calls even without a batched path.
+    return do_with(internal::merge_file_ranges(std::move(ranges)), [this] (std::vector<file_range>& merged) {
+        return do_for_each(merged, [this] (file_range& r) {
+            return discard(r.offset, r.length);
+        });
+    });
+}
+
+namespace internal {
+
+std::vector<file_range> merge_file_ranges(std::vector<file_range> ranges) {
+    std::sort(ranges.begin(), ranges.end(), [] (const file_range& a, const file_range& b) {
+        return a.offset < b.offset;
+    });
+    std::vector<file_range> merged;
+    for (auto& r : ranges) {
+        if (!r.length) {
+            continue;
+        }
+        if (!merged.empty() && r.offset <= merged.back().offset + merged.back().length) {
+            auto end = std::max(merged.back().offset + merged.back().length, r.offset + r.length);
+            merged.back().length = end - merged.back().offset;
+        } else {
+            merged.push_back(r);
+        }
+    }
+    return merged;
+}
+
+}
+
 future<file> open_file_dma(std::string_view name, open_flags flags) noexcept {
     return engine().open_file_dma(name, flags, file_open_options());
 }
@@ -21,8 +21,10 @@
 
 #include <seastar/core/fstream.hh>
 #include <seastar/core/align.hh>
+#include <seastar/core/internal/dma_buffer_pool.hh>
 #include <seastar/core/circular_buffer.hh>
 #include <seastar/core/semaphore.hh>
+#include <seastar/core/shared_future.hh>
 #include <seastar/core/reactor.hh>
 #include <seastar/core/when_all.hh>
 #include <seastar/core/io_intent.hh>
@@ -81,8 +83,12 @@ class file_data_source_impl : public data_source_impl {
     std::optional<promise<>> _done;
     size_t _current_buffer_size;
     bool _in_slow_start = false;
+    unsigned _unblocked_gets = 0;
     io_intent _intent;
     using unused_ratio_target = std::ratio<25, 100>;
+    // Number of consecutive get()s (per read-ahead slot) that have to find
+    // every outstanding read complete before the window is shrunk by one.
+    static constexpr unsigned read_ahead_decay_gets = 8;
 private:
     size_t minimal_buffer_size() const {
         return std::min(std::max(_options.buffer_size / 4, size_t(8192)), _options.buffer_size);
@@ -100,6 +106,27 @@ private:
             }
         }
     }
+    void try_decrease_read_ahead() {
+        // A consumer that drains slower than reads complete keeps the whole
+        // window ready at all times; the deepest read-ahead slots then only
+        // tie up memory and io_queue bandwidth. Shrink the window once the
+        // consumer has found every outstanding read complete for long enough
+        // that it cannot be a burst. The next stall grows it back via
+        // try_increase_read_ahead().
+        if (_current_read_ahead <= 1 || _in_slow_start || _read_buffers.size() < _current_read_ahead) {
+            return;
+        }
+        for (const auto& r : _read_buffers) {
+            if (!r._ready.available()) {
+                _unblocked_gets = 0;
+                return;
+            }
+        }
+        if (++_unblocked_gets >= read_ahead_decay_gets * _current_read_ahead) {
+            _unblocked_gets = 0;
+            _current_read_ahead--;
+        }
+    }
     unsigned get_initial_read_ahead() const {
         return _options.dynamic_adjustments
                ? std::min(_options.dynamic_adjustments->read_ahead, _options.read_ahead)
@@ -207,6 +234,9 @@ public:
     virtual future<temporary_buffer<char>> get() override {
         if (!_read_buffers.empty() && !_read_buffers.front()._ready.available()) {
             try_increase_read_ahead();
+            _unblocked_gets = 0;
+        } else {
+            try_decrease_read_ahead();
         }
         issue_read_aheads(1);
         auto ret = std::move(_read_buffers.front());
@@ -355,6 +385,12 @@ class file_data_sink_impl : public data_sink_impl {
     semaphore _write_behind_sem = { _options.write_behind };
     future<> _background_writes_done = make_ready_future<>();
     bool _failed = false;
+    // Group commit state: a single device flush covers every write issued
+    // before it, so concurrent flush() calls can share one.
+    uint64_t _put_epoch = 0;
+    uint64_t _flushed_epoch = 0;
+    uint64_t _pending_flush_epoch = 0;
+    std::optional<shared_future<>> _pending_flush;
 public:
     file_data_sink_impl(file f, file_output_stream_options options)
             : _file(std::move(f)), _options(options) {
@@ -363,10 +399,11 @@ public:
     }
     future<> put(net::packet data) override { abort(); }
     virtual temporary_buffer<char> allocate_buffer(size_t size) override {
-        return temporary_buffer<char>::aligned(_file.memory_dma_alignment(), size);
+        return internal::local_dma_buffer_pool().allocate<char>(_file.memory_dma_alignment(), size);
     }
     using data_sink_impl::put;
     virtual future<> put(temporary_buffer<char> buf) override {
+        ++_put_epoch;
         uint64_t pos = _pos;
         _pos += buf.size();
         if (!_options.write_behind) {
@@ -413,20 +450,31 @@ private:
         // called again with an unaligned pos, we have a bug in the caller.
         assert(!(pos & (_file.disk_write_dma_alignment() - 1)));
         bool truncate = false;
-        auto p = static_cast<const char*>(buf.get());
-        size_t buf_size = buf.size();
 
         if ((buf.size() & (_file.disk_write_dma_alignment() - 1)) != 0) {
-            // If buf size isn't aligned, copy its content into a new aligned buf.
-            // This should only happen when the user calls output_stream::flush().
-            auto tmp = allocate_buffer(align_up(buf.size(), _file.disk_write_dma_alignment()));
-            ::memcpy(tmp.get_write(), buf.get(), buf.size());
-            ::memset(tmp.get_write() + buf.size(), 0, tmp.size() - buf.size());
-            buf = std::move(tmp);
-            p = buf.get();
-            buf_size = buf.size();
+            // Buf size isn't aligned; this should only happen when the user
+            // calls output_stream::flush(). Copy only the sub-alignment tail
+            // into a padded buffer of its own - the aligned prefix, which can
+            // be almost a whole buffer, is written as-is, with no copy.
+            auto align = _file.disk_write_dma_alignment();
+            auto aligned_size = align_down(buf.size(), align);
+            auto tail = allocate_buffer(align);
+            auto tail_len = buf.size() - aligned_size;
+            ::memcpy(tail.get_write(), buf.get() + aligned_size, tail_len);
+            ::memset(tail.get_write() + tail_len, 0, align - tail_len);
+            if (aligned_size != 0) {
+                buf.trim(aligned_size);
+                return do_put(pos, std::move(buf)).then([this, tail_pos = pos + aligned_size, tail = std::move(tail)] () mutable {
+                    return do_put(tail_pos, std::move(tail));
+                }).then([this] {
+                    return _file.truncate(_pos);
+                });
+            }
+            buf = std::move(tail);
             truncate = true;
         }
+        auto p = static_cast<const char*>(buf.get());
+        size_t buf_size = buf.size();
 
         return _file.dma_write(pos, p, buf_size, _options.io_priority_class).then(
                 [this, pos, buf = std::move(buf), truncate, buf_size] (size_t size) mutable {
@@ -460,12 +508,41 @@ private:
     }
 public:
     virtual future<> flush() override {
-        return wait().then([this] {
+        auto epoch = _put_epoch;
+        if (epoch <= _flushed_epoch) {
+            // Everything written so far is already durable.
+            return make_ready_future<>();
+        }
+        if (_pending_flush && _pending_flush_epoch >= epoch) {
+            // A flush covering all our writes is already in flight (or has
+            // completed); piggyback on it instead of issuing another one.
+            return _pending_flush->get_future();
+        }
+        // Start a new flush epoch, queued behind a flush already in flight.
+        auto prev = _pending_flush ? _pending_flush->get_future() : make_ready_future<>();
+        _pending_flush_epoch = epoch;
+        _pending_flush.emplace(prev.then_wrapped([this] (future<> f) {
+            // A failure of the previous epoch was reported to its waiters.
+            f.ignore_ready_future();
+            return wait();
+        }).then([this] {
             return _file.flush();
-        });
+        }).then([this, epoch] {
+            _flushed_epoch = std::max(_flushed_epoch, epoch);
+        }));
+        return _pending_flush->get_future();
     }
     virtual future<> close() noexcept override {
-        return wait().finally([this] {
+        return wait().then([this] {
+            // Do not close the file under a group flush still in flight; its
+            // outcome is reported to the flush() callers.
+            if (!_pending_flush) {
+                return make_ready_future<>();
+            }
+            return _pending_flush->get_future().then_wrapped([] (future<> f) {
+                f.ignore_ready_future();
+            });
+        }).finally([this] {
             return _file.close();
         });
     }
@@ -502,6 +579,71 @@ future<output_stream<char>> make_file_output_stream(file f, file_output_stream_o
     });
 }
 
+namespace internal {
+
+// Chunk size for the copying fallback of sendfile_to_sink(). Large enough
+// to amortize per-request overhead, small enough not to monopolize memory.
+static constexpr size_t sendfile_chunk_size = 128 << 10;
+
+static future<> sendfile_copy(data_sink& out, file f, uint64_t pos, size_t len) {
+    return do_with(std::move(f), pos, len, [&out] (file& f, uint64_t& pos, size_t& len) {
+        return repeat([&out, &f, &pos, &len] {
+            if (len == 0) {
+                return make_ready_future<stop_iteration>(stop_iteration::yes);
+            }
+            return f.dma_read_bulk<char>(pos, std::min(len, sendfile_chunk_size)).then([&out, &pos, &len] (temporary_buffer<char> buf) {
+                if (buf.empty()) {
+                    throw std::runtime_error("sendfile: unexpected end of file");
+                }
+                buf.trim(std::min(buf.size(), len));
+                pos += buf.size();
+                len -= buf.size();
+                return out.put(std::move(buf)).then([] {
+                    return stop_iteration::no;
+                });
+            });
+        });
+    });
+}
+
+future<> sendfile_to_sink(data_sink& out, file f, uint64_t pos, size_t len) {
+    auto fd = f.native_fd();
+    if (!out.can_sendfile() || !fd) {
+        return sendfile_copy(out, std::move(f), pos, len).then([&out] {
+            return out.flush();
+        });
+    }
+    // f is kept alive for the whole transfer -- the kernel reads from its
+    // descriptor.
+    return do_with(std::move(f), pos, len, [&out, fd = *fd] (file& f, uint64_t& pos, size_t& len) {
+        return repeat([&out, fd, &pos, &len] {
+            if (len == 0) {
+                return make_ready_future<stop_iteration>(stop_iteration::yes);
+            }
+            return out.sendfile(fd, pos, len).then([&pos, &len] (size_t sent) {
+                if (sent == 0) {
+                    throw std::runtime_error("sendfile: unexpected end of file");
+                }
+                pos += sent;
+                len -= sent;
+                return stop_iteration::no;
+            });
+        }).handle_exception_type([&out, &f, &pos, &len] (const std::system_error& e) {
+            // Filesystems that cannot splice out of the file (e.g. some
+            // O_DIRECT configurations) report EINVAL; fall back to the
+            // copying path for the remainder of the range.
+            if (e.code().value() != EINVAL && e.code().value() != ENOSYS) {
+                throw;
+            }
+            return sendfile_copy(out, f, pos, len);
+        });
+    }).then([&out] {
+        return out.flush();
+    });
+}
+
+} // internal namespace
+
 /*
  * template initialization, definition in iostream-impl.hh
  */
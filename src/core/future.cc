@@ -63,6 +63,7 @@ void promise_base::move_it(promise_base&& x) noexcept {
     }
 }
 
+[[gnu::cold]]
 static void set_to_broken_promise(future_state_base& state) noexcept {
     try {
         // Constructing broken_promise may throw (std::logic_error ctor is not noexcept).
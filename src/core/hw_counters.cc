@@ -0,0 +1,118 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB
+ */
+
+#include <seastar/core/internal/hw_counters.hh>
+
+#include <atomic>
+#include <linux/perf_event.h>
+#include <asm/unistd.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace seastar {
+
+namespace internal {
+
+hw_perf_counter::hw_perf_counter(uint32_t type, uint64_t config) noexcept {
+#if !defined(__x86_64__) && !defined(__i386__)
+    // read() has no unprivileged counter access on this architecture
+    return;
+#endif
+    ::perf_event_attr attr = {};
+    attr.type = type;
+    attr.size = sizeof(attr);
+    attr.config = config;
+    // restricting to user space keeps us usable with the default
+    // perf_event_paranoid setting
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    int fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+    if (fd == -1) {
+        return;
+    }
+    auto mmap = ::mmap(nullptr, ::getpagesize(), PROT_READ, MAP_SHARED, fd, 0);
+    if (mmap == MAP_FAILED) {
+        ::close(fd);
+        return;
+    }
+    auto pc = static_cast<struct ::perf_event_mmap_page*>(mmap);
+    // without userspace reads every sample would cost three syscalls,
+    // which is too expensive for the task execution loop
+    if (!pc->cap_user_rdpmc) {
+        ::munmap(mmap, ::getpagesize());
+        ::close(fd);
+        return;
+    }
+    _fd = fd;
+    _mmap = pc;
+}
+
+hw_perf_counter::~hw_perf_counter() {
+    if (_mmap) {
+        ::munmap(_mmap, ::getpagesize());
+    }
+    if (_fd != -1) {
+        ::close(_fd);
+    }
+}
+
+uint64_t
+hw_perf_counter::read() const noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+    if (!_mmap) {
+        return 0;
+    }
+    auto pc = _mmap;
+    uint32_t seq;
+    uint64_t count;
+    do {
+        seq = pc->lock;
+        std::atomic_signal_fence(std::memory_order_acq_rel);
+        auto idx = pc->index;
+        count = pc->offset;
+        if (idx) {
+            uint64_t pmc = __builtin_ia32_rdpmc(idx - 1);
+            // the counter register is pmc_width bits wide; sign-extend
+            // so the negative part of offset cancels out
+            pmc <<= 64 - pc->pmc_width;
+            pmc = uint64_t(int64_t(pmc) >> (64 - pc->pmc_width));
+            count += pmc;
+        }
+        std::atomic_signal_fence(std::memory_order_acq_rel);
+    } while (pc->lock != seq);
+    return count;
+#else
+    // no unprivileged counter read on this architecture; the counter is
+    // never marked available (see the constructor), so just keep the
+    // deltas at zero
+    return 0;
+#endif
+}
+
+hw_counters::hw_counters() noexcept
+    : _instructions(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS)
+    , _cycles(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES)
+    , _llc_misses(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES) {
+}
+
+}
+
+}
@@ -31,6 +31,7 @@
 #include <seastar/core/linux-aio.hh>
 #include <seastar/core/internal/io_desc.hh>
 #include <seastar/core/internal/io_sink.hh>
+#include <seastar/core/internal/trace.hh>
 #include <seastar/core/io_priority_class.hh>
 #include <seastar/util/log.hh>
 #include <chrono>
@@ -57,6 +58,21 @@ struct default_io_exception_factory {
     }
 };
 
+// One phase of a request's life. Records microseconds into exponential
+// buckets (sub-bucket bits = 0) up to ~262ms; slower events land in the
+// +Inf bucket. Scaled back to seconds at scrape time.
+struct latency_histogram {
+    metrics::log_linear_histogram<0, 18> hist;
+
+    void sample(std::chrono::duration<double> lat) noexcept {
+        hist.record(std::chrono::duration_cast<std::chrono::microseconds>(lat).count());
+    }
+
+    metrics::histogram to_metrics_histogram() const {
+        return hist.to_metrics_histogram(1e-6);
+    }
+};
+
 struct io_group::priority_class_data {
     using token_bucket_t = internal::shared_token_bucket<uint64_t, std::ratio<1>, internal::capped_release::no>;
 
@@ -103,6 +119,13 @@ class io_queue::priority_class_data {
     std::chrono::duration<double> _total_execution_time;
     std::chrono::duration<double> _starvation_time;
     io_queue::clock_type::time_point _activated;
+    // Latency decomposition: time waiting in the fair queue, time in the
+    // io_sink waiting for the kernel, and device time proper. Together
+    // they tell whether latency comes from seastar-side queueing, token
+    // starvation, or the disk itself.
+    latency_histogram _queue_time_hist;
+    latency_histogram _sink_time_hist;
+    latency_histogram _device_time_hist;
 
     io_group::priority_class_data& _group;
     size_t _replenish_head;
@@ -156,6 +179,7 @@ public:
         _rwstat[dnl.rw_idx()].add(dnl.length());
         _queue_time = lat;
         _total_queue_time += lat;
+        _queue_time_hist.sample(lat);
         _nr_queued--;
         _nr_executing++;
         if (_nr_executing == 1) {
@@ -176,8 +200,13 @@ public:
         _nr_queued--;
     }
 
-    void on_complete(std::chrono::duration<double> lat) noexcept {
+    void on_submit(std::chrono::duration<double> lat) noexcept {
+        _sink_time_hist.sample(lat);
+    }
+
+    void on_complete(std::chrono::duration<double> lat, std::chrono::duration<double> device_lat) noexcept {
         _total_execution_time += lat;
+        _device_time_hist.sample(device_lat);
         _nr_executing--;
         if (_nr_executing == 0 && _nr_queued != 0) {
             _activated = io_queue::clock_type::now();
@@ -205,11 +234,15 @@ class io_desc_read_write final : public io_completion {
     io_queue& _ioq;
     io_queue::priority_class_data& _pclass;
     io_queue::clock_type::time_point _ts;
+    io_queue::clock_type::time_point _submit_ts;
     const stream_id _stream;
     const io_direction_and_length _dnl;
     const fair_queue_ticket _fq_ticket;
     promise<size_t> _pr;
     iovec_keeper _iovs;
+    // Keeps the io_intent's hand on the request after it left the fair
+    // queue; auto-unlinks when the descriptor dies with the completion
+    internal::cancellable_queue::inflight_link _inflight;
 
 public:
     io_desc_read_write(io_queue& ioq, io_queue::priority_class_data& pc, stream_id stream, io_direction_and_length dnl, fair_queue_ticket ticket, iovec_keeper iovs)
@@ -234,8 +267,10 @@ public:
 
     virtual void complete(size_t res) noexcept override {
         io_log.trace("dev {} : req {} complete", _ioq.dev_id(), fmt::ptr(this));
+        internal::local_trace_ring().trace(internal::trace_event_type::io_complete, uint16_t(_dnl.rw_idx()), _dnl.length(), reinterpret_cast<uintptr_t>(this));
         auto now = io_queue::clock_type::now();
-        _pclass.on_complete(std::chrono::duration_cast<std::chrono::duration<double>>(now - _ts));
+        _pclass.on_complete(std::chrono::duration_cast<std::chrono::duration<double>>(now - _ts),
+                std::chrono::duration_cast<std::chrono::duration<double>>(now - _submit_ts));
         _ioq.complete_request(*this);
         _pr.set_value(res);
         delete this;
@@ -247,11 +282,28 @@ public:
         delete this;
     }
 
+    // Invoked by the io_intent for a request that had already been
+    // dispatched towards the kernel
+    void cancel_in_flight() noexcept {
+        io_log.trace("dev {} : req {} cancel in flight", _ioq.dev_id(), fmt::ptr(this));
+        _ioq.cancel_dispatched_request(*this);
+    }
+
     void dispatch() noexcept {
         io_log.trace("dev {} : req {} submit", _ioq.dev_id(), fmt::ptr(this));
+        internal::local_trace_ring().trace(internal::trace_event_type::io_dispatch, uint16_t(_dnl.rw_idx()), _dnl.length(), reinterpret_cast<uintptr_t>(this));
         auto now = io_queue::clock_type::now();
         _pclass.on_dispatch(_dnl, std::chrono::duration_cast<std::chrono::duration<double>>(now - _ts));
         _ts = now;
+        // In case the backend bypasses the sink notification the device
+        // time degrades to the execution time
+        _submit_ts = now;
+    }
+
+    virtual void submitted() noexcept override {
+        auto now = io_queue::clock_type::now();
+        _pclass.on_submit(std::chrono::duration_cast<std::chrono::duration<double>>(now - _ts));
+        _submit_ts = now;
     }
 
     future<size_t> get_future() {
@@ -260,6 +312,53 @@ public:
 
     fair_queue_ticket ticket() const noexcept { return _fq_ticket; }
     stream_id stream() const noexcept { return _stream; }
+    io_queue::priority_class_data& pclass() const noexcept { return _pclass; }
+    size_t length() const noexcept { return _dnl.length(); }
+
+    internal::cancellable_queue::inflight_link& inflight_link() noexcept { return _inflight; }
+
+    static io_desc_read_write& from_inflight_link(internal::cancellable_queue::inflight_link& link) noexcept {
+        return *boost::intrusive::get_parent_from_member(&link, &io_desc_read_write::_inflight);
+    }
+};
+
+// Completion for a request built by merging several adjacent requests.
+// Distributes the merged result (or error) over the original descriptors
+// in submission order.
+class io_desc_merged final : public io_completion {
+    boost::container::small_vector<std::pair<io_desc_read_write*, size_t>, 4> _parts;
+    iovec_keeper _iovs;
+
+public:
+    io_desc_merged(boost::container::small_vector<std::pair<io_desc_read_write*, size_t>, 4> parts, iovec_keeper iovs) noexcept
+        : _parts(std::move(parts))
+        , _iovs(std::move(iovs))
+    {
+    }
+
+    virtual void complete(size_t res) noexcept override {
+        for (auto&& [desc, len] : _parts) {
+            size_t got = std::min(res, len);
+            res -= got;
+            desc->complete(got);
+        }
+        delete this;
+    }
+
+    virtual void set_exception(std::exception_ptr eptr) noexcept override {
+        for (auto&& [desc, len] : _parts) {
+            desc->set_exception(eptr);
+        }
+        delete this;
+    }
+
+    virtual void submitted() noexcept override {
+        for (auto&& [desc, len] : _parts) {
+            desc->submitted();
+        }
+    }
+
+    iovec_keeper& iovs() noexcept { return _iovs; }
 };
 
 class queued_io_request : private internal::io_request {
@@ -268,10 +367,11 @@ class queued_io_request : private internal::io_request {
     fair_queue_entry _fq_entry;
     internal::cancellable_queue::link _intent;
     std::unique_ptr<io_desc_read_write> _desc;
+    bool _parked = false;
 
+public:
     bool is_cancelled() const noexcept { return !_desc; }
 
-public:
     queued_io_request(internal::io_request req, io_queue& q, io_queue::priority_class_data& pc, io_direction_and_length dnl, iovec_keeper iovs)
         : io_request(std::move(req))
         , _ioq(q)
@@ -290,9 +390,16 @@ public:
             return;
         }
 
-        _intent.maybe_dequeue();
+        internal::cancellable_queue* cq = _intent.maybe_dequeue();
         _desc->dispatch();
-        _ioq.submit_request(_desc.release(), std::move(*this));
+        io_desc_read_write* desc = _desc.release();
+        if (cq != nullptr) {
+            // The intent keeps a hand on the request past dispatch, so
+            // cancelling it can chase the request into the sink and the
+            // kernel
+            cq->track_inflight(desc->inflight_link());
+        }
+        _ioq.submit_request(desc, std::move(*this));
         delete this;
     }
 
@@ -308,6 +415,12 @@ public:
     future<size_t> get_future() noexcept { return _desc->get_future(); }
     fair_queue_entry& queue_entry() noexcept { return _fq_entry; }
     stream_id stream() const noexcept { return _stream; }
+    fair_queue::class_id fq_class() const noexcept { return _desc->pclass().fq_class(); }
+    size_t length() const noexcept { return _desc->length(); }
+
+    void park() noexcept { _parked = true; }
+    void unpark() noexcept { _parked = false; }
+    bool parked() const noexcept { return _parked; }
 
     static queued_io_request& from_fq_entry(fair_queue_entry& ent) noexcept {
         return *boost::intrusive::get_parent_from_member(&ent, &queued_io_request::_fq_entry);
@@ -318,11 +431,108 @@ public:
     }
 };
 
+// Requests of one io_tenant parked on one io_queue. Only the front
+// request has its tokens grabbed from the tenant's bucket; the rest
+// grab theirs as they reach the front, so the tenant's own requests
+// queue behind each other and never clog the fair queue.
+struct io_queue::tenant_queue {
+    io_queue& ioq;
+    io_tenant& tenant;
+    fair_queue_entry::container_list_t parked;
+    uint64_t replenish_head = 0;
+    timer<lowres_clock> replenish;
+
+    tenant_queue(io_queue& q, io_tenant& t)
+        : ioq(q)
+        , tenant(t)
+        , replenish([this] { try_to_replenish(); })
+    {
+    }
+
+    void try_to_replenish() noexcept {
+        auto& tb = tenant.bucket();
+        tb.replenish(io_queue::clock_type::now());
+        auto delta = tb.deficiency(replenish_head);
+        if (delta > 0) {
+            replenish.arm(std::chrono::duration_cast<std::chrono::microseconds>(tb.duration_for(delta)));
+        } else {
+            ioq.unpark_tenant(*this);
+        }
+    }
+};
+
+io_queue::tenant_queue& io_queue::find_or_create_tenant_queue(io_tenant& tenant) {
+    auto& tq = _tenant_queues[&tenant];
+    if (!tq) {
+        tq = std::make_unique<tenant_queue>(*this, tenant);
+    }
+    return *tq;
+}
+
+bool io_queue::park_throttled_tenant(tenant_queue& tq, queued_io_request& req) noexcept {
+    auto& tb = tq.tenant.bucket();
+    if (!tq.parked.empty()) {
+        // Keep the tenant's requests ordered -- the tokens for this one
+        // will be grabbed when it reaches the front
+        req.park();
+        tq.parked.push_back(req.queue_entry());
+        return true;
+    }
+
+    tb.replenish(clock_type::now());
+    auto ph = tb.grab(req.length());
+    auto delta = tb.deficiency(ph);
+    if (delta == 0) {
+        return false;
+    }
+
+    req.park();
+    tq.parked.push_back(req.queue_entry());
+    tq.replenish_head = ph;
+    tq.replenish.arm(std::chrono::duration_cast<std::chrono::microseconds>(tb.duration_for(delta)));
+    return true;
+}
+
+void io_queue::unpark_tenant(tenant_queue& tq) noexcept {
+    auto& tb = tq.tenant.bucket();
+    // The tokens for the front request were grabbed when the timer was
+    // armed, subsequent requests grab their own
+    bool head_grabbed = true;
+
+    while (!tq.parked.empty()) {
+        queued_io_request& req = queued_io_request::from_fq_entry(tq.parked.front());
+        if (req.is_cancelled()) {
+            // Was cancelled while parked, so it never made it to the
+            // fair queue and there's nothing to notify
+            tq.parked.pop_front();
+            delete &req;
+            head_grabbed = false;
+            continue;
+        }
+
+        if (!head_grabbed) {
+            auto ph = tb.grab(req.length());
+            auto delta = tb.deficiency(ph);
+            if (delta > 0) {
+                tq.replenish_head = ph;
+                tq.replenish.arm(std::chrono::duration_cast<std::chrono::microseconds>(tb.duration_for(delta)));
+                return;
+            }
+        }
+
+        tq.parked.pop_front();
+        req.unpark();
+        _streams[req.stream()].queue(req.fq_class(), req.queue_entry());
+        head_grabbed = false;
+    }
+}
+
 namespace internal {
 
 cancellable_queue::cancellable_queue(cancellable_queue&& o) noexcept
         : _first(std::exchange(o._first, nullptr))
-        , _rest(std::move(o._rest)) {
+        , _rest(std::move(o._rest))
+        , _inflight(std::move(o._inflight)) {
     if (_first != nullptr) {
         _first->_ref = this;
     }
@@ -332,6 +542,7 @@ cancellable_queue& cancellable_queue::operator=(cancellable_queue&& o) noexcept
     if (this != &o) {
         _first = std::exchange(o._first, nullptr);
         _rest = std::move(o._rest);
+        _inflight = std::move(o._inflight);
         if (_first != nullptr) {
             _first->_ref = this;
         }
@@ -344,6 +555,12 @@ cancellable_queue::~cancellable_queue() {
         queued_io_request::from_cq_link(*_first).cancel();
         pop_front();
     }
+    while (!_inflight.empty()) {
+        auto& link = _inflight.front();
+        link.unlink();
+        // may delete the descriptor synchronously, hence the unlink above
+        io_desc_read_write::from_inflight_link(link).cancel_in_flight();
+    }
 }
 
 void cancellable_queue::push_back(link& il) noexcept {
@@ -384,12 +601,39 @@ io_intent* intent_reference::retrieve() const {
 
 void io_sink::submit(io_completion* desc, io_request req) noexcept {
     try {
+        if (_combine_batch != 0) {
+            if (_pending_io.empty()) {
+                _oldest_pending = std::chrono::steady_clock::now();
+            }
+            auto op = req.opcode();
+            if (op != io_request::operation::write && op != io_request::operation::writev) {
+                // Latency-critical operation -- release the batch so it
+                // is submitted together with this request.
+                _release = true;
+            }
+        }
         _pending_io.emplace_back(std::move(req), desc);
     } catch (...) {
         desc->set_exception(std::current_exception());
     }
 }
 
+bool io_sink::cancel(io_completion* desc) noexcept {
+    for (auto it = _pending_io.begin(); it != _pending_io.end(); ++it) {
+        if (it->_completion == desc) {
+            _pending_io.erase(it, it + 1);
+            if (_pending_io.empty()) {
+                _release = false;
+            }
+            return true;
+        }
+    }
+    if (_kernel_cancel) {
+        _kernel_cancel(desc);
+    }
+    return false;
+}
+
 std::vector<io_request::part> io_request::split(size_t max_length) {
     if (_op == operation::read || _op == operation::write) {
         return split_buffer(max_length);
@@ -569,7 +813,7 @@ static void maybe_warn_latency_goal_auto_adjust(const fair_group& fg, const io_q
     seastar_logger.log(lvl, "IO queue uses {:.2f}ms latency goal for device {}", goal.count() * 1000, cfg.devid);
 }
 
-io_group::io_group(io_queue::config io_cfg)
+io_group::io_group(io_queue::config io_cfg, const io_group* peer)
     : _config(std::move(io_cfg))
     , _allocated_on(this_shard_id())
 {
@@ -581,6 +825,24 @@ io_group::io_group(io_queue::config io_cfg)
         maybe_warn_latency_goal_auto_adjust(*_fgs.back(), io_cfg);
     }
 
+    // Groups of one device get static 1/Nth fractions of its rate. The
+    // spare pools (one per stream) let a throttled group claim the budget
+    // its peers didn't use, so skewed workloads don't leave the device
+    // idle. A group alone on its device keeps plain token bucket behavior.
+    if (_config.nr_groups > 1) {
+        if (peer != nullptr) {
+            assert(peer->_spare_pools.size() == _fgs.size());
+            _spare_pools = peer->_spare_pools;
+        } else {
+            for (auto& fg : _fgs) {
+                _spare_pools.push_back(std::make_shared<fair_group::capacity_pool>(fg->maximum_capacity()));
+            }
+        }
+        for (unsigned i = 0; i < _fgs.size(); i++) {
+            _fgs[i]->set_spare_pool(_spare_pools[i].get());
+        }
+    }
+
     /*
      * The maximum request size shouldn't result in the capacity that would
      * be larger than the group's replenisher limit.
@@ -744,6 +1006,15 @@ std::vector<seastar::metrics::impl::metric_definition_impl> io_queue::priority_c
             sm::make_counter("total_exec_sec", [this] {
                     return _total_execution_time.count();
                 }, sm::description("Total time spent in disk")),
+            sm::make_histogram("queue_time", [this] {
+                    return _queue_time_hist.to_metrics_histogram();
+                }, sm::description("Distribution of time, in seconds, requests spent queued in the fair queue before dispatch")),
+            sm::make_histogram("sink_time", [this] {
+                    return _sink_time_hist.to_metrics_histogram();
+                }, sm::description("Distribution of time, in seconds, dispatched requests spent in the submission sink before reaching the kernel")),
+            sm::make_histogram("device_time", [this] {
+                    return _device_time_hist.to_metrics_histogram();
+                }, sm::description("Distribution of time, in seconds, between submitting a request to the kernel and its completion")),
             sm::make_counter("starvation_time_sec", [this] {
                 auto st = _starvation_time;
                 if (_nr_queued != 0 && _nr_executing == 0) {
@@ -883,12 +1154,18 @@ future<size_t> io_queue::queue_one_request(const io_priority_class& pc, io_direc
         auto& pclass = find_or_create_class(pc);
         auto queued_req = std::make_unique<queued_io_request>(std::move(req), *this, pclass, std::move(dnl), std::move(iovs));
         auto fut = queued_req->get_future();
+        tenant_queue* tq = nullptr;
         if (intent != nullptr) {
+            if (io_tenant* tenant = intent->tenant()) {
+                tq = &find_or_create_tenant_queue(*tenant);
+            }
             auto& cq = intent->find_or_create_cancellable_queue(dev_id(), pc.id());
             queued_req->set_intent(cq);
         }
 
-        _streams[queued_req->stream()].queue(pclass.fq_class(), queued_req->queue_entry());
+        if (tq == nullptr || !park_throttled_tenant(*tq, *queued_req)) {
+            _streams[queued_req->stream()].queue(pclass.fq_class(), queued_req->queue_entry());
+        }
         queued_req.release();
         pclass.on_queue();
         _queued_requests++;
@@ -975,16 +1252,120 @@ void io_queue::poll_io_queue() {
             queued_io_request::from_fq_entry(fqe).dispatch();
         });
     }
+    flush_pending_merge();
 }
 
 void io_queue::submit_request(io_desc_read_write* desc, internal::io_request req) noexcept {
     _queued_requests--;
     _requests_executing++;
+    if (get_config().max_merge_length != 0 && try_merge_request(desc, req)) {
+        return;
+    }
     _sink.submit(desc, std::move(req));
 }
 
+// Upper bound on the number of requests glued into one vectored request.
+// Keeps the iovec count well below what linux-aio and io_uring accept.
+static constexpr size_t max_merge_parts = 128;
+
+bool io_queue::try_merge_request(io_desc_read_write* desc, const internal::io_request& req) noexcept {
+    using operation = internal::io_request::operation;
+    auto opc = req.opcode();
+    if (opc != operation::read && opc != operation::write) {
+        flush_pending_merge();
+        return false;
+    }
+
+    // the layout of read and write ops is identical (see io_request)
+    const auto& rw = req.as<operation::read>();
+    auto idx = opc == operation::write ? io_direction_write : io_direction_read;
+    size_t limit = std::min(get_config().max_merge_length, _group->_max_request_length[idx]);
+
+    if (_pending_merge) {
+        auto& m = *_pending_merge;
+        if (m.op == opc && m.fd == rw.fd && m.nowait_works == rw.nowait_works
+                && m.pos + m.length == rw.pos
+                && m.length + rw.size <= limit
+                && m.parts.size() < max_merge_parts) {
+            try {
+                m.iovs.push_back(::iovec{rw.addr, rw.size});
+                m.parts.emplace_back(desc, rw.size);
+                m.length += rw.size;
+                return true;
+            } catch (...) {
+                // couldn't grow the merge state -- submit unmerged below
+            }
+        }
+        flush_pending_merge();
+    }
+
+    if (rw.size >= limit) {
+        return false; // cannot grow, not worth staging
+    }
+
+    try {
+        pending_merge m;
+        m.op = opc;
+        m.fd = rw.fd;
+        m.pos = rw.pos;
+        m.length = rw.size;
+        m.nowait_works = rw.nowait_works;
+        m.iovs.push_back(::iovec{rw.addr, rw.size});
+        m.parts.emplace_back(desc, rw.size);
+        _pending_merge.emplace(std::move(m));
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+void io_queue::flush_pending_merge() noexcept {
+    using operation = internal::io_request::operation;
+    if (!_pending_merge) {
+        return;
+    }
+    auto m = std::move(*_pending_merge);
+    _pending_merge.reset();
+
+    if (m.parts.size() == 1) {
+        auto [desc, len] = m.parts[0];
+        auto req = m.op == operation::write
+                ? internal::io_request::make_write(m.fd, m.pos, m.iovs[0].iov_base, len, m.nowait_works)
+                : internal::io_request::make_read(m.fd, m.pos, m.iovs[0].iov_base, len, m.nowait_works);
+        _sink.submit(desc, std::move(req));
+        return;
+    }
+
+    auto merged = new (std::nothrow) io_desc_merged(std::move(m.parts), std::move(m.iovs));
+    if (__builtin_expect(merged != nullptr, true)) {
+        io_log.trace("dev {} : merged {} requests into req {} len {}", dev_id(), merged->iovs().size(), fmt::ptr(merged), m.length);
+        auto req = m.op == operation::write
+                ? internal::io_request::make_writev(m.fd, m.pos, merged->iovs(), m.nowait_works)
+                : internal::io_request::make_readv(m.fd, m.pos, merged->iovs(), m.nowait_works);
+        _sink.submit(merged, std::move(req));
+        return;
+    }
+
+    // Couldn't allocate the merged descriptor -- submit the staged requests
+    // individually (m still owns the parts on this path).
+    uint64_t pos = m.pos;
+    for (size_t i = 0; i < m.parts.size(); i++) {
+        auto [desc, len] = m.parts[i];
+        auto req = m.op == operation::write
+                ? internal::io_request::make_write(m.fd, pos, m.iovs[i].iov_base, len, m.nowait_works)
+                : internal::io_request::make_read(m.fd, pos, m.iovs[i].iov_base, len, m.nowait_works);
+        pos += len;
+        _sink.submit(desc, std::move(req));
+    }
+}
+
 void io_queue::cancel_request(queued_io_request& req) noexcept {
     _queued_requests--;
+    if (req.parked()) {
+        // Not in the fair queue yet, the tenant queue reaps it when it
+        // reaches the front
+        return;
+    }
     _streams[req.stream()].notify_request_cancelled(req.queue_entry());
 }
 
@@ -992,6 +1373,19 @@ void io_queue::complete_cancelled_request(queued_io_request& req) noexcept {
     _streams[req.stream()].notify_request_finished(req.queue_entry().ticket());
 }
 
+void io_queue::cancel_dispatched_request(io_desc_read_write& desc) noexcept {
+    if (_sink.cancel(&desc)) {
+        // Never reached the kernel -- resolve it right away
+        desc.set_exception(std::make_exception_ptr(default_io_exception_factory::cancelled()));
+    }
+    // Otherwise the backend was asked to cancel it in the kernel (if it
+    // knows how to) and the completion arrives the usual way, possibly
+    // with ECANCELED. If the request got merged with its neighbors on
+    // the way out neither side recognizes the descriptor and the merged
+    // request just runs to completion -- the cancellation is best-effort
+    // by nature.
+}
+
 io_queue::clock_type::time_point io_queue::next_pending_aio() const noexcept {
     clock_type::time_point next = clock_type::time_point::max();
 
@@ -0,0 +1,168 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB
+ */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <seastar/core/mapped_file.hh>
+#include <seastar/core/reactor.hh>
+#include <seastar/core/align.hh>
+#include <seastar/core/print.hh>
+#include "core/thread_pool.hh"
+#include "core/syscall_result.hh"
+
+namespace seastar {
+
+static uint64_t mapped_file_page_size() {
+    static const uint64_t page_size = ::getpagesize();
+    return page_size;
+}
+
+// Clamps [offset, offset + length) to size and expands it to page
+// boundaries, as required by madvise()/mlock().
+static std::pair<uint64_t, uint64_t>
+page_aligned_range(uint64_t offset, uint64_t length, uint64_t size) {
+    auto page_size = mapped_file_page_size();
+    auto start = align_down(std::min(offset, size), page_size);
+    auto end = std::min(align_up(std::min(offset + length, size), page_size), size);
+    return {start, end - start};
+}
+
+future<mapped_file> mapped_file::map(sstring name) noexcept {
+    struct mapping {
+        char* addr = nullptr;
+        uint64_t size = 0;
+    };
+    return engine()._thread_pool->submit<syscall_result_extra<mapping>>([name] {
+        mapping m;
+        int fd = ::open(name.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd == -1) {
+            return wrap_syscall(-1, m);
+        }
+        struct stat st{};
+        auto r = ::fstat(fd, &st);
+        if (r == -1) {
+            auto save = errno;
+            ::close(fd);
+            errno = save;
+            return wrap_syscall(-1, m);
+        }
+        m.size = st.st_size;
+        if (m.size != 0) {
+            // The mapping outlives the descriptor, which is only needed
+            // to establish it.
+            auto addr = ::mmap(nullptr, m.size, PROT_READ, MAP_SHARED, fd, 0);
+            if (addr == MAP_FAILED) {
+                auto save = errno;
+                ::close(fd);
+                errno = save;
+                return wrap_syscall(-1, m);
+            }
+            m.addr = static_cast<char*>(addr);
+        }
+        ::close(fd);
+        return wrap_syscall(0, m);
+    }).then([] (syscall_result_extra<mapping> sr) {
+        sr.throw_if_error();
+        mapped_file mf;
+        mf._size = sr.extra.size;
+        if (sr.extra.addr) {
+            mf._area = mmap_area(sr.extra.addr, mmap_deleter{sr.extra.size});
+        }
+        return mf;
+    });
+}
+
+void mapped_file::add_resident(uint64_t offset, uint64_t length) {
+    _resident.push_back(file_range{offset, length});
+    _resident = internal::merge_file_ranges(std::move(_resident));
+}
+
+const char* mapped_file::get(uint64_t offset, uint64_t length) const {
+    if (offset + length > _size || offset + length < offset) {
+        throw std::out_of_range(format("mapped_file::get: range [{}, {}) is outside the {} byte mapping", offset, offset + length, _size));
+    }
+    // _resident is merged and sorted; find the only candidate range.
+    auto it = std::partition_point(_resident.begin(), _resident.end(), [offset] (const file_range& r) {
+        return r.offset + r.length <= offset;
+    });
+    if (it == _resident.end() || it->offset > offset || offset + length > it->offset + it->length) {
+        throw std::runtime_error("mapped_file::get: range was not faulted in with touch() or lock()");
+    }
+    return _area.get() + offset;
+}
+
+future<> mapped_file::touch(uint64_t offset, uint64_t length) noexcept {
+    auto [start, len] = page_aligned_range(offset, length, _size);
+    if (len == 0) {
+        return make_ready_future<>();
+    }
+    auto addr = _area.get() + start;
+    return engine()._thread_pool->submit<syscall_result<int>>([addr, len] {
+        auto r = ::madvise(addr, len, MADV_WILLNEED);
+        if (r == -1) {
+            return wrap_syscall(r);
+        }
+        // madvise() only starts the read-in; dereference each page so the
+        // major faults are taken here and not on the reactor.
+        auto page_size = mapped_file_page_size();
+        for (uint64_t off = 0; off < len; off += page_size) {
+            [[maybe_unused]] volatile char c = addr[off];
+        }
+        return wrap_syscall(0);
+    }).then([this, start, len] (syscall_result<int> sr) {
+        sr.throw_if_error();
+        add_resident(start, len);
+    });
+}
+
+future<> mapped_file::lock(uint64_t offset, uint64_t length) noexcept {
+    auto [start, len] = page_aligned_range(offset, length, _size);
+    if (len == 0) {
+        return make_ready_future<>();
+    }
+    auto addr = _area.get() + start;
+    return engine()._thread_pool->submit<syscall_result<int>>([addr, len] {
+        // mlock() faults the pages in before pinning them, so it doubles
+        // as an off-reactor touch.
+        return wrap_syscall(::mlock(addr, len));
+    }).then([this, start, len] (syscall_result<int> sr) {
+        sr.throw_if_error();
+        add_resident(start, len);
+    });
+}
+
+future<> mapped_file::unlock(uint64_t offset, uint64_t length) noexcept {
+    auto [start, len] = page_aligned_range(offset, length, _size);
+    if (len == 0) {
+        return make_ready_future<>();
+    }
+    auto addr = _area.get() + start;
+    return engine()._thread_pool->submit<syscall_result<int>>([addr, len] {
+        return wrap_syscall(::munlock(addr, len));
+    }).then([] (syscall_result<int> sr) {
+        sr.throw_if_error();
+    });
+}
+
+}
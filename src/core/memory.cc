@@ -55,11 +55,13 @@
 #include <seastar/core/cacheline.hh>
 #include <seastar/core/memory.hh>
 #include <seastar/core/print.hh>
+#include <seastar/core/scheduling.hh>
 #include <seastar/util/alloc_failure_injector.hh>
 #include <seastar/util/memory_diagnostics.hh>
 #include <seastar/util/std-compat.hh>
 #include <seastar/util/log.hh>
 #include <seastar/core/aligned_buffer.hh>
+#include <seastar/core/bitops.hh>
 #include <unordered_set>
 #include <iostream>
 #include <thread>
@@ -107,6 +109,89 @@ void enable_abort_on_allocation_failure() {
 static std::pmr::polymorphic_allocator<char> static_malloc_allocator{std::pmr::get_default_resource()};;
 std::pmr::polymorphic_allocator<char>* malloc_allocator{&static_malloc_allocator};
 
+}
+
+namespace internal {
+
+// Coroutine frames are allocated and freed at very high rates and with a
+// small set of recurring sizes, so they get a dedicated per-shard arena in
+// front of the general allocator: freed frames are cached on power-of-two
+// size-class freelists and handed back to the next frame of the same class,
+// making the common case a single list pop with no size-class dispatch in
+// the allocator proper.
+struct coroutine_frame_arena {
+    static constexpr size_t min_frame_size = 64;
+    static constexpr unsigned nr_classes = 8; // 64 bytes .. 8K
+    // Bounds cached memory per size class; anything above this (or larger
+    // than the largest class) goes back to the general allocator.
+    static constexpr unsigned max_cached_per_class = 256;
+
+    struct free_frame {
+        free_frame* next;
+    };
+
+    free_frame* free_frames[nr_classes] = {};
+    unsigned nr_free[nr_classes] = {};
+
+    struct {
+        uint64_t allocs = 0;
+        uint64_t frees = 0;
+        uint64_t reuses = 0;
+        size_t cached_bytes = 0;
+    } stats;
+
+    ~coroutine_frame_arena() {
+        for (unsigned i = 0; i != nr_classes; ++i) {
+            while (auto f = free_frames[i]) {
+                free_frames[i] = f->next;
+                ::operator delete(f);
+            }
+        }
+    }
+};
+
+static thread_local coroutine_frame_arena coro_frame_arena;
+
+static unsigned frame_size_class(size_t size) noexcept {
+    return log2ceil(std::max(size, coroutine_frame_arena::min_frame_size)) - log2ceil(coroutine_frame_arena::min_frame_size);
+}
+
+void* allocate_coroutine_frame(size_t size) {
+    auto& arena = coro_frame_arena;
+    ++arena.stats.allocs;
+    auto cls = frame_size_class(size);
+    if (cls < coroutine_frame_arena::nr_classes) {
+        if (auto f = arena.free_frames[cls]) {
+            arena.free_frames[cls] = f->next;
+            --arena.nr_free[cls];
+            arena.stats.cached_bytes -= coroutine_frame_arena::min_frame_size << cls;
+            ++arena.stats.reuses;
+            return f;
+        }
+        size = coroutine_frame_arena::min_frame_size << cls;
+    }
+    return ::operator new(size);
+}
+
+void free_coroutine_frame(void* ptr, size_t size) noexcept {
+    auto& arena = coro_frame_arena;
+    ++arena.stats.frees;
+    auto cls = frame_size_class(size);
+    if (cls < coroutine_frame_arena::nr_classes && arena.nr_free[cls] < coroutine_frame_arena::max_cached_per_class) {
+        auto f = reinterpret_cast<coroutine_frame_arena::free_frame*>(ptr);
+        f->next = arena.free_frames[cls];
+        arena.free_frames[cls] = f;
+        ++arena.nr_free[cls];
+        arena.stats.cached_bytes += coroutine_frame_arena::min_frame_size << cls;
+        return;
+    }
+    ::operator delete(ptr);
+}
+
+} // namespace internal
+
+namespace memory {
+
 namespace internal {
 
 #ifdef __cpp_constinit
@@ -406,6 +491,7 @@ class small_pool {
     size_t _free_count = 0;
     unsigned _min_free;
     unsigned _max_free;
+    uint64_t _live_objects = 0;
     unsigned _pages_in_use = 0;
     page_list _span_list;
     static constexpr unsigned idx_frac_bits = 2;
@@ -415,14 +501,17 @@ public:
     void* allocate();
     void deallocate(void* object);
     unsigned object_size() const { return _object_size; }
+    uint64_t live_objects() const { return _live_objects; }
     bool objects_page_aligned() const { return is_page_aligned(_object_size); }
+    void drain_free_list();
     static constexpr unsigned size_to_idx(unsigned size);
     static constexpr unsigned idx_to_size(unsigned idx);
     allocation_site_ptr& alloc_site_holder(void* ptr);
 private:
     void add_more_objects();
-    void trim_free_list();
+    void trim_free_list(size_t goal);
     friend seastar::internal::log_buf::inserter_iterator do_dump_memory_diagnostics(seastar::internal::log_buf::inserter_iterator);
+    friend std::vector<pool_diagnostics_entry> pool_diagnostics();
 };
 
 // index 0b0001'1100 -> size (1 << 4) + 0b11 << (4 - 2)
@@ -502,6 +591,19 @@ struct cross_cpu_free_item {
     cross_cpu_free_item* next;
 };
 
+// Foreign frees staged on this thread for one destination cpu. The
+// objects are linked into a local chain and pushed onto the owner's
+// xcpu_freelist wholesale, one atomic exchange per batch instead of
+// per object (see cpu_pages::free_cross_cpu()).
+struct cross_cpu_free_bucket {
+    cross_cpu_free_item* head = nullptr;
+    cross_cpu_free_item* tail = nullptr;
+    unsigned count = 0;
+};
+
+static constexpr unsigned cross_cpu_free_batch = 32;
+static constexpr unsigned cross_cpu_drain_batch = 256;
+
 struct cpu_pages {
     uint32_t min_free_pages = 20000000 / page_size;
     char* memory;
@@ -517,6 +619,9 @@ struct cpu_pages {
     page_list free_spans[nr_span_lists];  // contains aligned spans with span_size == 2^idx
     small_pool_array small_pools;
     alignas(seastar::cache_line_size) std::atomic<cross_cpu_free_item*> xcpu_freelist;
+    // the part of the xcpu_freelist grabbed but not yet freed by
+    // drain_cross_cpu_freelist(), local to the owner
+    cross_cpu_free_item* xcpu_pending = nullptr;
     static std::atomic<unsigned> cpu_id_gen;
     static cpu_pages* all_cpus[max_cpus];
     union asu {
@@ -528,6 +633,18 @@ struct cpu_pages {
     } asu;
     allocation_site_ptr alloc_site_list_head = nullptr; // For easy traversal of asu.alloc_sites from scylla-gdb.py
     bool collect_backtrace = false;
+    // Sampled profiling: when > 1, only every ~alloc_sample_rate-th
+    // allocation records its site, see set_heap_profiling_sampling_rate()
+    unsigned alloc_sample_rate = 0;
+    unsigned alloc_sample_countdown = 0;
+    uint32_t alloc_sample_seed = 1;
+    // Live bytes attributed to each scheduling group. Charged to the
+    // current group on allocation and released by the group performing
+    // the free, see scheduling_group_live_memory().
+    int64_t sg_live_bytes[max_scheduling_groups()] = {};
+    // Per-group soft limits in bytes, 0 = no limit
+    size_t sg_soft_limits[max_scheduling_groups()] = {};
+    bool sg_reclaim_scheduled[max_scheduling_groups()] = {};
     char* mem() { return memory; }
 
     void link(page_list& list, page* span);
@@ -553,6 +670,8 @@ struct cpu_pages {
     static bool try_foreign_free(void* ptr);
     void shrink(void* ptr, size_t new_size);
     static void free_cross_cpu(unsigned cpu_id, void* ptr);
+    static void push_cross_cpu_chain(unsigned cpu_id, cross_cpu_free_item* head, cross_cpu_free_item* tail);
+    static void flush_cross_cpu_free_buckets();
     bool drain_cross_cpu_freelist();
     size_t object_size(void* ptr);
     page* to_page(void* p) {
@@ -561,8 +680,12 @@ struct cpu_pages {
 
     bool is_initialized() const;
     bool initialize();
+    void account_allocated(size_t size);
+    void account_freed(size_t size);
     reclaiming_result run_reclaimers(reclaimer_scope, size_t pages_to_reclaim);
+    reclaiming_result run_group_reclaimers(unsigned sg_idx);
     void schedule_reclaim();
+    void schedule_group_reclaim(unsigned sg_idx);
     void set_reclaim_hook(std::function<void (std::function<void ()>)> hook);
     void set_min_free_pages(size_t pages);
     void resize(size_t new_size, allocate_system_memory_fn alloc_sys_mem);
@@ -578,22 +701,60 @@ static thread_local cpu_pages cpu_mem;
 std::atomic<unsigned> cpu_pages::cpu_id_gen;
 cpu_pages* cpu_pages::all_cpus[max_cpus];
 
+static thread_local cross_cpu_free_bucket xcpu_free_buckets[max_cpus];
+
 static cpu_pages& get_cpu_mem();
 
 #ifdef SEASTAR_HEAPPROF
 
-void set_heap_profiling_enabled(bool enable) {
-    bool is_enabled = get_cpu_mem().collect_backtrace;
-    if (enable) {
-        if (!is_enabled) {
-            seastar_logger.info("Enabling heap profiler");
+void set_heap_profiling_sampling_rate(unsigned rate) {
+    auto& mem = get_cpu_mem();
+    bool is_enabled = mem.collect_backtrace;
+    if (rate) {
+        if (!is_enabled || mem.alloc_sample_rate != rate) {
+            if (rate == 1) {
+                seastar_logger.info("Enabling heap profiler");
+            } else {
+                seastar_logger.info("Enabling heap profiler, sampling every {}th allocation", rate);
+            }
         }
-    } else {
-        if (is_enabled) {
-            seastar_logger.info("Disabling heap profiler");
+    } else if (is_enabled) {
+        seastar_logger.info("Disabling heap profiler");
+    }
+    mem.collect_backtrace = rate;
+    mem.alloc_sample_rate = rate;
+    mem.alloc_sample_countdown = 1; // the next allocation starts the sample
+}
+
+unsigned get_heap_profiling_sampling_rate() {
+    return get_cpu_mem().alloc_sample_rate;
+}
+
+std::vector<allocation_site_info> sampled_memory_profile(size_t max_sites) {
+    disable_backtrace_temporarily dbt;
+    std::vector<allocation_site_ptr> sites;
+    for (auto site = cpu_mem.alloc_site_list_head; site; site = site->next) {
+        if (site->count) {
+            sites.push_back(site);
         }
     }
-    get_cpu_mem().collect_backtrace = enable;
+    auto top = std::min(max_sites, sites.size());
+    std::partial_sort(sites.begin(), sites.begin() + top, sites.end(), [] (allocation_site_ptr a, allocation_site_ptr b) {
+        return a->size > b->size;
+    });
+    sites.resize(top);
+    // scale the sampled counters back to an estimate of the real ones
+    auto scale = std::max(cpu_mem.alloc_sample_rate, 1u);
+    std::vector<allocation_site_info> ret;
+    ret.reserve(top);
+    for (auto site : sites) {
+        ret.push_back(allocation_site_info{site->count * scale, site->size * scale, fmt::format("{}", site->backtrace)});
+    }
+    return ret;
+}
+
+void set_heap_profiling_enabled(bool enable) {
+    set_heap_profiling_sampling_rate(enable ? 1 : 0);
 }
 
 static thread_local int64_t scoped_heap_profiling_embed_count = 0;
@@ -616,6 +777,20 @@ void set_heap_profiling_enabled(bool enable) {
             " compile with the Seastar_HEAP_PROFILING=ON CMake option to add heap profiling support");
 }
 
+void set_heap_profiling_sampling_rate(unsigned rate) {
+    if (rate) {
+        set_heap_profiling_enabled(true); // let it print the warning
+    }
+}
+
+unsigned get_heap_profiling_sampling_rate() {
+    return 0;
+}
+
+std::vector<allocation_site_info> sampled_memory_profile(size_t max_sites) {
+    return {};
+}
+
 scoped_heap_profiling::scoped_heap_profiling() noexcept {
     set_heap_profiling_enabled(true); // let it print the warning
 }
@@ -729,7 +904,8 @@ cpu_pages::find_and_unlink_span_reclaiming(unsigned n_pages) {
 
 void cpu_pages::maybe_reclaim() {
     if (nr_free_pages < current_min_free_pages) {
-        drain_cross_cpu_freelist();
+        // under pressure take the whole freelist, not just one batch
+        while (drain_cross_cpu_freelist()) {}
         if (nr_free_pages < current_min_free_pages) {
             run_reclaimers(reclaimer_scope::sync, current_min_free_pages - nr_free_pages);
         }
@@ -822,6 +998,22 @@ allocation_site_ptr get_allocation_site() {
     if (!cpu_mem.is_initialized() || !cpu_mem.collect_backtrace) {
         return nullptr;
     }
+#ifdef SEASTAR_ENABLE_ALLOC_FAILURE_INJECTION
+    if (internal::critical_alloc_section) {
+        // capturing and interning a backtrace allocates; stay out of
+        // critical allocation sections
+        return nullptr;
+    }
+#endif
+    if (cpu_mem.alloc_sample_rate > 1) {
+        if (--cpu_mem.alloc_sample_countdown) {
+            return nullptr;
+        }
+        // Re-arm with an interval randomized around the configured rate
+        // so the sample does not alias with periodic allocation patterns.
+        cpu_mem.alloc_sample_seed = cpu_mem.alloc_sample_seed * 1664525 + 1013904223;
+        cpu_mem.alloc_sample_countdown = cpu_mem.alloc_sample_rate / 2 + cpu_mem.alloc_sample_seed % cpu_mem.alloc_sample_rate + 1;
+    }
     disable_backtrace_temporarily dbt;
     allocation_site new_alloc_site;
     new_alloc_site.backtrace = get_backtrace();
@@ -864,6 +1056,9 @@ cpu_pages::allocate_small(unsigned size) {
     }
     new (&pool.alloc_site_holder(ptr)) allocation_site_ptr{alloc_site};
 #endif
+    if (ptr) {
+        account_allocated(pool.object_size());
+    }
     return ptr;
 }
 
@@ -877,6 +1072,7 @@ void cpu_pages::free_large(void* ptr) {
         alloc_site->size -= span->span_size * page_size;
     }
 #endif
+    account_freed(size_t(span->span_size) * page_size);
     free_span(idx, span->span_size);
 }
 
@@ -896,32 +1092,74 @@ size_t cpu_pages::object_size(void* ptr) {
     }
 }
 
-void cpu_pages::free_cross_cpu(unsigned cpu_id, void* ptr) {
+void cpu_pages::push_cross_cpu_chain(unsigned cpu_id, cross_cpu_free_item* head, cross_cpu_free_item* tail) {
     if (!live_cpus[cpu_id].load(std::memory_order_relaxed)) {
-        // Thread was destroyed; leak object
+        // Thread was destroyed; leak objects
         // should only happen for boost unit-tests.
         return;
     }
-    auto p = reinterpret_cast<cross_cpu_free_item*>(ptr);
     auto& list = all_cpus[cpu_id]->xcpu_freelist;
     auto old = list.load(std::memory_order_relaxed);
     do {
-        p->next = old;
-    } while (!list.compare_exchange_weak(old, p, std::memory_order_release, std::memory_order_relaxed));
+        tail->next = old;
+    } while (!list.compare_exchange_weak(old, head, std::memory_order_release, std::memory_order_relaxed));
+}
+
+void cpu_pages::free_cross_cpu(unsigned cpu_id, void* ptr) {
+    auto p = reinterpret_cast<cross_cpu_free_item*>(ptr);
     alloc_stats::increment(alloc_stats::types::cross_cpu_frees);
+    if (!is_reactor_thread) {
+        // Non-reactor threads have no poll loop to flush a stale
+        // bucket behind them, so they push each object at once
+        push_cross_cpu_chain(cpu_id, p, p);
+        return;
+    }
+    auto& b = xcpu_free_buckets[cpu_id];
+    p->next = b.head;
+    b.head = p;
+    if (b.tail == nullptr) {
+        b.tail = p;
+    }
+    if (++b.count == cross_cpu_free_batch) {
+        push_cross_cpu_chain(cpu_id, b.head, b.tail);
+        b = {};
+    }
 }
 
-bool cpu_pages::drain_cross_cpu_freelist() {
-    if (!xcpu_freelist.load(std::memory_order_relaxed)) {
-        return false;
+void cpu_pages::flush_cross_cpu_free_buckets() {
+    auto nr_cpus = std::min<unsigned>(cpu_id_gen.load(std::memory_order_relaxed), max_cpus);
+    for (unsigned i = 0; i < nr_cpus; i++) {
+        auto& b = xcpu_free_buckets[i];
+        if (b.head != nullptr) {
+            push_cross_cpu_chain(i, b.head, b.tail);
+            b = {};
+        }
     }
-    auto p = xcpu_freelist.exchange(nullptr, std::memory_order_acquire);
-    while (p) {
-        auto n = p->next;
+}
+
+bool cpu_pages::drain_cross_cpu_freelist() {
+    // Push out what this cpu owes to the others, so that sub-batch
+    // tails don't linger in the local buckets
+    flush_cross_cpu_free_buckets();
+    if (xcpu_pending == nullptr) {
+        if (!xcpu_freelist.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        xcpu_pending = xcpu_freelist.exchange(nullptr, std::memory_order_acquire);
+    }
+    // Free in bounded batches -- millions of objects can pile up here
+    // (e.g. when lots of connections shut down at once) and freeing
+    // them all in one go would stall the reactor
+    auto p = xcpu_pending;
+    unsigned n = 0;
+    while (p && n < cross_cpu_drain_batch) {
+        auto next = p->next;
         alloc_stats::increment_local(alloc_stats::types::frees);
         free(p);
-        p = n;
+        p = next;
+        n++;
     }
+    xcpu_pending = p;
     return true;
 }
 
@@ -936,6 +1174,7 @@ void cpu_pages::free(void* ptr) {
             alloc_site->size -= pool.object_size();
         }
 #endif
+        account_freed(pool.object_size());
         pool.deallocate(ptr);
     } else {
         free_large(ptr);
@@ -957,6 +1196,7 @@ void cpu_pages::free(void* ptr, size_t size) {
             alloc_site->size -= pool->object_size();
         }
 #endif
+        account_freed(pool->object_size());
         pool->deallocate(ptr);
     } else {
         free_large(ptr);
@@ -1007,11 +1247,13 @@ void cpu_pages::shrink(void* ptr, size_t new_size) {
     span[new_size_pages - 1].free = false;
     span[new_size_pages - 1].span_size = new_size_pages;
     pageidx idx = span - pages;
+    account_freed(size_t(old_size_pages - new_size_pages) * page_size);
     free_span_unaligned(idx + new_size_pages, old_size_pages - new_size_pages);
 }
 
 cpu_pages::~cpu_pages() {
     if (is_initialized()) {
+        flush_cross_cpu_free_buckets();
         live_cpus[cpu_id].store(false, std::memory_order_relaxed);
     }
 }
@@ -1063,6 +1305,23 @@ static allocate_anonymous_memory(void* where, size_t how_much) {
             MAP_PRIVATE | MAP_FIXED);
 }
 
+mmap_area
+static allocate_hugepage_memory(void* where, size_t how_much) {
+    // Prefer 2MB pages from the hugetlb pool: unlike transparent huge pages,
+    // which the kernel may decline to assemble once memory is fragmented,
+    // these are guaranteed to stay huge for the lifetime of the mapping.
+    // The sizes we are called with are always multiples of huge_page_size
+    // (cpu_pages::resize() aligns to it). Fall back to anonymous memory,
+    // which the callers mark with MADV_HUGEPAGE, if the pool is empty or
+    // hugetlb is not configured.
+    auto r = ::mmap(where, how_much, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_HUGETLB, -1, 0);
+    if (r != MAP_FAILED) {
+        return mmap_area(static_cast<char*>(r), mmap_deleter{how_much});
+    }
+    return allocate_anonymous_memory(where, how_much);
+}
+
 mmap_area
 allocate_hugetlbfs_memory(file_desc& fd, void* where, size_t how_much) {
     auto pos = fd.size();
@@ -1142,22 +1401,109 @@ void cpu_pages::resize(size_t new_size, allocate_system_memory_fn alloc_memory)
 reclaiming_result cpu_pages::run_reclaimers(reclaimer_scope scope, size_t n_pages) {
     auto target = std::max<size_t>(nr_free_pages + n_pages, min_free_pages);
     reclaiming_result result = reclaiming_result::reclaimed_nothing;
-    while (nr_free_pages < target) {
-        bool made_progress = false;
-        alloc_stats::increment_local(alloc_stats::types::reclaims);
-        for (auto&& r : reclaimers) {
-            if (r->scope() >= scope) {
-                made_progress |= r->do_reclaim((target - nr_free_pages) * page_size) == reclaiming_result::reclaimed_something;
+    // Work through the eviction tiers from the coldest down, exhausting
+    // each tier before asking a hotter one to release anything. Note: no
+    // allocations here, we may be running under an allocating fiber.
+    std::optional<reclaimer_tier> tier;
+    for (auto&& r : reclaimers) {
+        if (r->scope() >= scope && (!tier || r->tier() > *tier)) {
+            tier = r->tier();
+        }
+    }
+    while (tier) {
+        while (nr_free_pages < target) {
+            bool made_progress = false;
+            alloc_stats::increment_local(alloc_stats::types::reclaims);
+            for (auto&& r : reclaimers) {
+                if (r->scope() >= scope && r->tier() == *tier) {
+                    made_progress |= r->do_reclaim((target - nr_free_pages) * page_size) == reclaiming_result::reclaimed_something;
+                }
+            }
+            if (!made_progress) {
+                break;
             }
+            result = reclaiming_result::reclaimed_something;
         }
-        if (!made_progress) {
+        if (nr_free_pages >= target) {
             return result;
         }
-        result = reclaiming_result::reclaimed_something;
+        // This tier is exhausted, move on to the hottest tier below it.
+        std::optional<reclaimer_tier> next;
+        for (auto&& r : reclaimers) {
+            if (r->scope() >= scope && r->tier() < *tier && (!next || r->tier() > *next)) {
+                next = r->tier();
+            }
+        }
+        tier = next;
     }
     return result;
 }
 
+void cpu_pages::account_allocated(size_t size) {
+    auto idx = seastar::internal::scheduling_group_index(current_scheduling_group());
+    auto live = sg_live_bytes[idx] += int64_t(size);
+    auto limit = sg_soft_limits[idx];
+    if (limit && live > int64_t(limit) && !sg_reclaim_scheduled[idx] && reclaim_hook) {
+        schedule_group_reclaim(idx);
+    }
+}
+
+void cpu_pages::account_freed(size_t size) {
+    sg_live_bytes[seastar::internal::scheduling_group_index(current_scheduling_group())] -= int64_t(size);
+}
+
+// Runs the reclaimers serving a scheduling group that exceeded its memory
+// soft limit: the group's own reclaimers are drained first and ownerless
+// ones are only asked if those cannot release enough; reclaimers owned by
+// other groups are never invoked here. The group is made current for the
+// duration so the memory its reclaimers release is credited back to it.
+reclaiming_result cpu_pages::run_group_reclaimers(unsigned sg_idx) {
+    auto limit = sg_soft_limits[sg_idx];
+    if (!limit) {
+        // The limit was removed between scheduling and running
+        return reclaiming_result::reclaimed_nothing;
+    }
+    auto sg = seastar::internal::scheduling_group_from_index(sg_idx);
+    auto& current = *seastar::internal::current_scheduling_group_ptr();
+    auto prev = current;
+    current = sg;
+    auto result = reclaiming_result::reclaimed_nothing;
+    try {
+        for (bool owned : {true, false}) {
+            while (sg_live_bytes[sg_idx] > int64_t(limit)) {
+                bool made_progress = false;
+                alloc_stats::increment_local(alloc_stats::types::reclaims);
+                for (auto&& r : reclaimers) {
+                    if (owned ? (r->owner() && *r->owner() == sg) : !r->owner()) {
+                        auto deficit = size_t(sg_live_bytes[sg_idx] - int64_t(limit));
+                        made_progress |= r->do_reclaim(deficit) == reclaiming_result::reclaimed_something;
+                    }
+                }
+                if (!made_progress) {
+                    break;
+                }
+                result = reclaiming_result::reclaimed_something;
+            }
+            if (sg_live_bytes[sg_idx] <= int64_t(limit)) {
+                break;
+            }
+        }
+    } catch (...) {
+        current = prev;
+        throw;
+    }
+    current = prev;
+    return result;
+}
+
+void cpu_pages::schedule_group_reclaim(unsigned sg_idx) {
+    sg_reclaim_scheduled[sg_idx] = true;
+    reclaim_hook([this, sg_idx] {
+        sg_reclaim_scheduled[sg_idx] = false;
+        run_group_reclaimers(sg_idx);
+    });
+}
+
 void cpu_pages::schedule_reclaim() {
     current_min_free_pages = 0;
     reclaim_hook([this] {
@@ -1229,7 +1575,7 @@ small_pool::small_pool(unsigned object_size) noexcept
 
 small_pool::~small_pool() {
     _min_free = _max_free = 0;
-    trim_free_list();
+    trim_free_list(0);
 }
 
 // Should not throw in case of running out of memory to avoid infinite recursion,
@@ -1246,6 +1592,7 @@ small_pool::allocate() {
     auto* obj = _free;
     _free = _free->next;
     --_free_count;
+    ++_live_objects;
     return obj;
 }
 
@@ -1255,8 +1602,9 @@ small_pool::deallocate(void* object) {
     o->next = _free;
     _free = o;
     ++_free_count;
+    --_live_objects;
     if (_free_count >= _max_free) {
-        trim_free_list();
+        trim_free_list((_min_free + _max_free) / 2);
     }
 }
 
@@ -1306,8 +1654,7 @@ small_pool::add_more_objects() {
 }
 
 void
-small_pool::trim_free_list() {
-    auto goal = (_min_free + _max_free) / 2;
+small_pool::trim_free_list(size_t goal) {
     while (_free && _free_count > goal) {
         auto obj = _free;
         _free = _free->next;
@@ -1328,6 +1675,11 @@ small_pool::trim_free_list() {
     }
 }
 
+void
+small_pool::drain_free_list() {
+    trim_free_list(0);
+}
+
 void
 abort_on_underflow(size_t size) {
     if (std::make_signed_t<size_t>(size) < 0) {
@@ -1342,15 +1694,26 @@ void* allocate_large(size_t size) {
     if ((size_t(size_in_pages) << page_bits) < size) {
         return nullptr; // (size + page_size - 1) caused an overflow
     }
-    return get_cpu_mem().allocate_large(size_in_pages);
-
+    auto& cm = get_cpu_mem();
+    auto ptr = cm.allocate_large(size_in_pages);
+    if (ptr) {
+        // The span can be larger than requested, charge what free_large()
+        // will release
+        cm.account_allocated(size_t(cm.to_page(ptr)->span_size) * page_size);
+    }
+    return ptr;
 }
 
 void* allocate_large_aligned(size_t align, size_t size) {
     abort_on_underflow(size);
     unsigned size_in_pages = (size + page_size - 1) >> page_bits;
     unsigned align_in_pages = std::max(align, page_size) >> page_bits;
-    return get_cpu_mem().allocate_large_aligned(align_in_pages, size_in_pages);
+    auto& cm = get_cpu_mem();
+    auto ptr = cm.allocate_large_aligned(align_in_pages, size_in_pages);
+    if (ptr) {
+        cm.account_allocated(size_t(cm.to_page(ptr)->span_size) * page_size);
+    }
+    return ptr;
 }
 
 void free_large(void* ptr) {
@@ -1486,15 +1849,17 @@ void set_reclaim_hook(std::function<void (std::function<void ()>)> hook) {
     get_cpu_mem().set_reclaim_hook(hook);
 }
 
-reclaimer::reclaimer(std::function<reclaiming_result ()> reclaim, reclaimer_scope scope)
+reclaimer::reclaimer(std::function<reclaiming_result ()> reclaim, reclaimer_scope scope, reclaimer_tier tier, std::optional<scheduling_group> owner)
     : reclaimer([reclaim = std::move(reclaim)] (request) {
         return reclaim();
-    }, scope) {
+    }, scope, tier, owner) {
 }
 
-reclaimer::reclaimer(std::function<reclaiming_result (request)> reclaim, reclaimer_scope scope)
+reclaimer::reclaimer(std::function<reclaiming_result (request)> reclaim, reclaimer_scope scope, reclaimer_tier tier, std::optional<scheduling_group> owner)
     : _reclaim(std::move(reclaim))
-    , _scope(scope) {
+    , _scope(scope)
+    , _tier(tier)
+    , _owner(owner) {
     get_cpu_mem().reclaimers.push_back(this);
 }
 
@@ -1529,7 +1894,7 @@ void configure(std::vector<resource::memory> m, bool mbind,
     for (auto&& x : m) {
         total += x.bytes;
     }
-    allocate_system_memory_fn sys_alloc = allocate_anonymous_memory;
+    allocate_system_memory_fn sys_alloc = allocate_hugepage_memory;
     if (hugetlbfs_path) {
         // std::function is copyable, but file_desc is not, so we must use
         // a shared_ptr to allow sys_alloc to be copied around
@@ -1589,6 +1954,14 @@ void set_min_free_pages(size_t pages) {
     get_cpu_mem().set_min_free_pages(pages);
 }
 
+int64_t scheduling_group_live_memory(scheduling_group sg) {
+    return get_cpu_mem().sg_live_bytes[seastar::internal::scheduling_group_index(sg)];
+}
+
+void set_scheduling_group_memory_soft_limit(scheduling_group sg, size_t limit) {
+    get_cpu_mem().sg_soft_limits[seastar::internal::scheduling_group_index(sg)] = limit;
+}
+
 static thread_local int report_on_alloc_failure_suppressed = 0;
 
 class disable_report_on_alloc_failure_temporarily {
@@ -1686,7 +2059,31 @@ seastar::internal::log_buf::inserter_iterator do_dump_memory_diagnostics(seastar
     it = fmt::format_to(it, "Used memory:   {}\n", to_hr_size(total_mem - free_mem));
     it = fmt::format_to(it, "Free memory:   {}\n", to_hr_size(free_mem));
     it = fmt::format_to(it, "Total memory:  {}\n", to_hr_size(total_mem));
-    it = fmt::format_to(it, "Hard failures: {}\n\n", alloc_stats::get(alloc_stats::types::failed_allocs));
+    it = fmt::format_to(it, "Hard failures: {}\n", alloc_stats::get(alloc_stats::types::failed_allocs));
+
+    const auto& coro_stats = seastar::internal::coro_frame_arena.stats;
+    it = fmt::format_to(it, "Coroutine frames: {} allocated, {} freed, {} reused, {} cached\n\n",
+            coro_stats.allocs, coro_stats.frees, coro_stats.reuses, to_hr_size(coro_stats.cached_bytes));
+
+    bool any_group_memory = false;
+    for (unsigned i = 0; i < max_scheduling_groups(); i++) {
+        any_group_memory |= get_cpu_mem().sg_live_bytes[i] || get_cpu_mem().sg_soft_limits[i];
+    }
+    if (any_group_memory) {
+        // Attributed to the group current at allocation/free time, so
+        // memory that changes hands between groups can skew the split
+        // (see scheduling_group_live_memory()); 0 limit = none
+        it = fmt::format_to(it, "Scheduling group memory (bytes live / soft limit):\n");
+        for (unsigned i = 0; i < max_scheduling_groups(); i++) {
+            const auto live = get_cpu_mem().sg_live_bytes[i];
+            const auto limit = get_cpu_mem().sg_soft_limits[i];
+            if (!live && !limit) {
+                continue;
+            }
+            it = fmt::format_to(it, "  group {:>2}: {} / {}\n", i, live, limit);
+        }
+        it = fmt::format_to(it, "\n");
+    }
 
     if (additional_diagnostics_producer) {
         additional_diagnostics_producer([&it] (std::string_view v) mutable {
@@ -1781,6 +2178,98 @@ void dump_memory_diagnostics(log_level lvl, logger::rate_limit& rate_limit) {
     seastar_memory_logger.log(lvl, rate_limit, writer);
 }
 
+std::vector<pool_diagnostics_entry> pool_diagnostics() {
+    auto& mem = get_cpu_mem();
+    std::array<pool_diagnostics_entry, small_pool_array::nr_small_pools> entries = {};
+    std::array<uint64_t, small_pool_array::nr_small_pools> span_freelist_objs = {};
+    // Spans fully handed over to their pool's freelist are not linked on the
+    // pool's span list, so enumerate spans by walking the page array instead,
+    // as do_dump_memory_diagnostics() does for the page span histogram.
+    for (unsigned i = 0; i < mem.nr_pages;) {
+        const auto& span = mem.pages[i];
+        if (!span.span_size) {
+            ++i;
+            continue;
+        }
+        if (!span.free && span.pool) {
+            auto idx = unsigned(span.pool - &mem.small_pools[0]);
+            auto& e = entries[idx];
+            auto capacity_in_objects = span.span_size * page_size / span.pool->object_size();
+            span_freelist_objs[idx] += capacity_in_objects - span.nr_small_alloc;
+            // Objects sitting on the pool freelist are still charged to their
+            // span's nr_small_alloc, so the histogram counts them as allocated.
+            auto bucket = std::min<size_t>(span.nr_small_alloc * e.span_occupancy.size() / capacity_in_objects,
+                    e.span_occupancy.size() - 1);
+            ++e.span_occupancy[bucket];
+        }
+        i += span.span_size;
+    }
+    std::vector<pool_diagnostics_entry> ret;
+    ret.reserve(small_pool_array::nr_small_pools);
+    for (unsigned i = 0; i < small_pool_array::nr_small_pools; ++i) {
+        auto& sp = mem.small_pools[i];
+        // We don't use pools too small to fit a free_object, so skip these, they
+        // are always empty.
+        if (sp.object_size() < sizeof(free_object)) {
+            continue;
+        }
+        auto& e = entries[i];
+        e.object_size = sp.object_size();
+        e.free_objects = sp._free_count + span_freelist_objs[i];
+        e.live_objects = sp._pages_in_use * page_size / sp.object_size() - e.free_objects;
+        e.memory = sp._pages_in_use * page_size;
+        ret.push_back(e);
+    }
+    return ret;
+}
+
+std::vector<live_objects_entry> live_objects_histogram() {
+    auto& mem = get_cpu_mem();
+    std::vector<live_objects_entry> ret;
+    ret.reserve(small_pool_array::nr_small_pools);
+    for (unsigned i = 0; i < small_pool_array::nr_small_pools; ++i) {
+        auto& sp = mem.small_pools[i];
+        // We don't use pools too small to fit a free_object, so skip these, they
+        // are always empty.
+        if (sp.object_size() < sizeof(free_object)) {
+            continue;
+        }
+        // Several adjacent pools can share an object size, as sizes are
+        // rounded up to a multiple of max_align_t; merge them into one
+        // size class.
+        if (!ret.empty() && ret.back().object_size == sp.object_size()) {
+            ret.back().live_objects += sp.live_objects();
+        } else {
+            ret.push_back({sp.object_size(), sp.live_objects()});
+        }
+    }
+    return ret;
+}
+
+uint64_t live_objects_in_pool(size_t object_size) noexcept {
+    if (object_size < sizeof(free_object) || object_size > max_small_allocation) {
+        return 0;
+    }
+    auto& mem = get_cpu_mem();
+    uint64_t count = 0;
+    for (unsigned i = 0; i < small_pool_array::nr_small_pools; ++i) {
+        auto& sp = mem.small_pools[i];
+        if (sp.object_size() == object_size) {
+            count += sp.live_objects();
+        }
+    }
+    return count;
+}
+
+size_t trim() {
+    auto& mem = get_cpu_mem();
+    auto free_pages_before = mem.nr_free_pages;
+    for (unsigned i = 0; i < small_pool_array::nr_small_pools; ++i) {
+        mem.small_pools[i].drain_free_list();
+    }
+    return size_t(mem.nr_free_pages - free_pages_before) * page_size;
+}
+
 void internal::log_memory_diagnostics_report(log_level lvl) {
     logger::rate_limit rl{std::chrono::seconds(0)}; // never limit for explicit dump requests
     dump_memory_diagnostics(lvl, rl);
@@ -2284,10 +2773,10 @@ bool is_abort_on_allocation_failure() {
     return false;
 }
 
-reclaimer::reclaimer(std::function<reclaiming_result ()> reclaim, reclaimer_scope) {
+reclaimer::reclaimer(std::function<reclaiming_result ()> reclaim, reclaimer_scope, reclaimer_tier, std::optional<scheduling_group>) {
 }
 
-reclaimer::reclaimer(std::function<reclaiming_result (request)> reclaim, reclaimer_scope) {
+reclaimer::reclaimer(std::function<reclaiming_result (request)> reclaim, reclaimer_scope, reclaimer_tier, std::optional<scheduling_group>) {
 }
 
 reclaimer::~reclaimer() {
@@ -2303,6 +2792,26 @@ statistics stats() {
     return statistics{0, 0, 0, 1 << 30, 1 << 30, 0, 0, 0, 0, 0, 0};
 }
 
+std::vector<pool_diagnostics_entry> pool_diagnostics() {
+    // Not supported for default allocator.
+    return {};
+}
+
+std::vector<live_objects_entry> live_objects_histogram() {
+    // Not supported for default allocator.
+    return {};
+}
+
+uint64_t live_objects_in_pool(size_t) noexcept {
+    // Not supported for default allocator.
+    return 0;
+}
+
+size_t trim() {
+    // Not supported for default allocator.
+    return 0;
+}
+
 size_t free_memory() {
     return stats().free_memory();
 }
@@ -2323,6 +2832,15 @@ void set_min_free_pages(size_t pages) {
     // Ignore, reclaiming not supported for default allocator.
 }
 
+int64_t scheduling_group_live_memory(scheduling_group) {
+    // Not supported for default allocator.
+    return 0;
+}
+
+void set_scheduling_group_memory_soft_limit(scheduling_group, size_t) {
+    // Ignore, not supported for default allocator.
+}
+
 void set_large_allocation_warning_threshold(size_t) {
     // Ignore, not supported for default allocator.
 }
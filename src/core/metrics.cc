@@ -139,7 +139,7 @@ static bool apply_relabeling(const relabel_config& rc, impl::metric_info& info)
         } else {
             s << rc.separator;
         }
-        s << ((l == "__name__") ? info.id.full_name() : val->second);
+        s << ((l == "__name__") ? info.id.full_name() : val->second.str());
     }
     std::smatch match;
     // regex_search forbid temporary strings
@@ -205,6 +205,27 @@ static std::string get_unique_id() {
 label shard_label("shard");
 namespace impl {
 
+lw_shared_ptr<const sstring> interned_string::intern(sstring s) {
+    // Per-shard hash-consing pool. Entries whose only remaining
+    // reference is the pool itself are swept when the pool grows, so
+    // label strings of unregistered metrics are released eventually.
+    static thread_local std::unordered_map<std::string_view, lw_shared_ptr<const sstring>> pool;
+    static thread_local size_t sweep_threshold = 1024;
+    auto it = pool.find(std::string_view(s));
+    if (it != pool.end()) {
+        return it->second;
+    }
+    auto e = lw_shared_ptr<const sstring>(make_lw_shared<sstring>(std::move(s)));
+    pool.emplace(std::string_view(*e), e);
+    if (pool.size() >= sweep_threshold) {
+        for (auto i = pool.begin(); i != pool.end();) {
+            i = i->second.use_count() == 1 ? pool.erase(i) : std::next(i);
+        }
+        sweep_threshold = std::max<size_t>(1024, pool.size() * 2);
+    }
+    return e;
+}
+
 registered_metric::registered_metric(metric_id id, metric_function f, bool enabled, skip_when_empty skip, int handle) :
         _f(f), _impl(get_local_impl(handle)) {
     _info.enabled = enabled;
@@ -268,10 +289,11 @@ metric_definition_impl& metric_definition_impl::set_type(const sstring& type_nam
     return *this;
 }
 
-metric_definition_impl& metric_definition_impl::aggregate(const std::vector<label>& _labels) noexcept {
+metric_definition_impl& metric_definition_impl::aggregate(const std::vector<label>& _labels, aggregate_mode mode) noexcept {
     aggregate_labels.reserve(_labels.size());
     std::transform(_labels.begin(), _labels.end(),std::back_inserter(aggregate_labels),
             [](const label& l) { return l.name(); });
+    _aggregate_mode = mode;
     return *this;
 }
 
@@ -294,10 +316,10 @@ metric_groups_impl::~metric_groups_impl() {
 
 metric_groups_impl& metric_groups_impl::add_metric(group_name_type name, const metric_definition& md)  {
 
-    metric_id id(name, md._impl->name, md._impl->labels);
+    metric_id id(name, md._impl->name, labels_type(md._impl->labels.begin(), md._impl->labels.end()));
 
     get_local_impl(_handle)->add_registration(
-            id, md._impl->type, md._impl->f, md._impl->d, md._impl->enabled, md._impl->_skip_when_empty, md._impl->aggregate_labels, _handle);
+            id, md._impl->type, md._impl->f, md._impl->d, md._impl->enabled, md._impl->_skip_when_empty, md._impl->aggregate_labels, md._impl->_aggregate_mode, _handle);
 
     _registration.push_back(id);
     return *this;
@@ -408,6 +430,10 @@ const value_map& get_value_map(int handle) {
 }
 
 foreign_ptr<values_reference> get_values(int handle) {
+    return get_values([](const sstring&) { return true; }, handle);
+}
+
+foreign_ptr<values_reference> get_values(const std::function<bool(const sstring&)>& filter, int handle) {
     shared_ptr<values_copy> res_ref = ::seastar::make_shared<values_copy>();
     auto& res = *(res_ref.get());
     auto& mv = res.values;
@@ -417,11 +443,15 @@ foreign_ptr<values_reference> get_values(int handle) {
     auto & functions = impl->functions();
 
     mv.reserve(functions.size());
-    for (auto&& i : functions) {
+    for (size_t i = 0; i < functions.size(); i++) {
         value_vector values;
-        values.reserve(i.size());
-        for (auto&& v : i) {
-            values.emplace_back(v());
+        // Filtered-out families keep an empty slot, so the values stay
+        // index-aligned with the metadata.
+        if (filter((*res.metadata)[i].mf.name)) {
+            values.reserve(functions[i].size());
+            for (auto&& v : functions[i]) {
+                values.emplace_back(v());
+            }
         }
         mv.emplace_back(std::move(values));
     }
@@ -496,6 +526,7 @@ void impl::replicate_metric(const shared_ptr<registered_metric>& metric,
                                   metric->is_enabled(),
                                   metric->get_skip_when_empty(),
                                   family_info.aggregate_labels,
+                                  family_info.aggregate_mode,
                                   destination_handle);
 }
 
@@ -543,7 +574,7 @@ std::vector<std::vector<metric_function>>& impl::functions() {
     return _current_metrics;
 }
 
-void impl::add_registration(const metric_id& id, const metric_type& type, metric_function f, const description& d, bool enabled, skip_when_empty skip, const std::vector<std::string>& aggregate_labels, int handle) {
+void impl::add_registration(const metric_id& id, const metric_type& type, metric_function f, const description& d, bool enabled, skip_when_empty skip, const std::vector<std::string>& aggregate_labels, aggregate_mode mode, int handle) {
     auto rm = ::seastar::make_shared<registered_metric>(id, f, enabled, skip, handle);
     for (auto&& rl : _relabel_configs) {
         apply_relabeling(rl, rm->info());
@@ -568,6 +599,7 @@ void impl::add_registration(const metric_id& id, const metric_type& type, metric
         _value_map[name].info().inherit_type = type.type_name;
         _value_map[name].info().name = id.full_name();
         _value_map[name].info().aggregate_labels = aggregate_labels;
+        _value_map[name].info().aggregate_mode = mode;
         _value_map[name][rm->info().id.labels()] = rm;
     }
     dirty();
@@ -0,0 +1,416 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB
+ */
+
+// NVMe passthrough file backend.
+//
+// I/O on an NVMe generic character device (/dev/ngXnY) travels as raw
+// NVMe commands through the driver's passthrough path, skipping the
+// kernel block layer - no request queue, no elevator, no plugging -
+// which is where most of the per-I/O kernel overhead lives at high
+// 4K random-read rates. Each open file owns an io_uring submission/
+// completion queue pair dedicated to its shard; commands accumulate
+// in the ring during a task batch and a reactor poller submits them
+// in one io_uring_enter() and reaps completions without interrupts.
+//
+// The backend is selected by opening the generic character device
+// instead of the block device, mirroring how the blockdev backend is
+// selected by opening /dev/nvmeXnY. Commands bypass the seastar I/O
+// scheduler as well as the kernel's - the NVMe controller arbitrates -
+// so the priority class is ignored; this backend is for dedicated
+// devices where the application wants the queue pair to itself.
+
+#include <seastar/core/align.hh>
+#include <seastar/core/chunked_fifo.hh>
+#include <seastar/core/file.hh>
+#include <seastar/core/posix.hh>
+#include <seastar/core/reactor.hh>
+#include <seastar/core/report_exception.hh>
+#include <seastar/core/when_all.hh>
+#include <seastar/util/later.hh>
+#include <seastar/util/log.hh>
+#include "core/file-impl.hh"
+
+#include <linux/nvme_ioctl.h>
+#include <sys/ioctl.h>
+#include <sys/sysmacros.h>
+#include <unistd.h>
+#include <cstring>
+#include <numeric>
+#include <optional>
+
+#if defined(SEASTAR_HAVE_URING) && defined(NVME_URING_CMD_IO)
+#include <liburing.h>
+#endif
+
+namespace seastar {
+
+extern logger seastar_logger;
+
+bool is_nvme_generic_device(dev_t device_id) noexcept {
+#if defined(SEASTAR_HAVE_URING) && defined(NVME_URING_CMD_IO)
+    char link[64];
+    char target[512];
+    std::snprintf(link, sizeof(link), "/sys/dev/char/%u:%u/subsystem", major(device_id), minor(device_id));
+    auto n = ::readlink(link, target, sizeof(target) - 1);
+    if (n <= 0) {
+        return false;
+    }
+    auto sv = std::string_view(target, n);
+    return sv.size() >= 13 && sv.substr(sv.size() - 13) == "/nvme-generic";
+#else
+    return false;
+#endif
+}
+
+#if defined(SEASTAR_HAVE_URING) && defined(NVME_URING_CMD_IO)
+
+// NVM command set opcodes (NVMe base specification)
+static constexpr uint8_t nvme_cmd_flush = 0x00;
+static constexpr uint8_t nvme_cmd_write = 0x01;
+static constexpr uint8_t nvme_cmd_read = 0x02;
+static constexpr uint8_t nvme_cmd_dsm = 0x09;
+
+class nvme_passthrough_file_impl final : public file_impl {
+    static constexpr unsigned queue_length = 128;
+
+    // One passthrough command. Owned by the ring while in flight;
+    // completed and deleted by poll().
+    struct command {
+        promise<size_t> pr;
+        uint8_t opcode;
+        uint64_t addr = 0;
+        uint32_t data_len = 0;
+        uint32_t cdw10 = 0;
+        uint32_t cdw11 = 0;
+        uint32_t cdw12 = 0;
+        size_t result = 0;
+        // keeps buffers the device DMAs from/to (e.g. DSM ranges) alive
+        std::unique_ptr<char[]> payload;
+    };
+
+    int _fd;
+    uint32_t _nsid;
+    unsigned _lba_shift;
+    uint64_t _size;
+    ::io_uring _ring;
+    std::optional<internal::poller> _poller;
+    chunked_fifo<command*> _overflow; // commands which did not get an sqe yet
+    bool _unsubmitted = false;
+    size_t _in_flight = 0;
+
+public:
+    nvme_passthrough_file_impl(int fd, uint32_t nsid, unsigned lba_shift, uint64_t size, unsigned max_transfer, ::io_uring ring)
+            : _fd(fd), _nsid(nsid), _lba_shift(lba_shift), _size(size), _ring(ring) {
+        _disk_read_dma_alignment = 1u << _lba_shift;
+        _disk_write_dma_alignment = 1u << _lba_shift;
+        _disk_overwrite_dma_alignment = 1u << _lba_shift;
+        _read_max_length = std::min(_read_max_length, max_transfer);
+        _write_max_length = std::min(_write_max_length, max_transfer);
+        _poller.emplace(internal::poller::simple([this] { return poll(); }));
+    }
+
+    nvme_passthrough_file_impl(const nvme_passthrough_file_impl&) = delete;
+
+    ~nvme_passthrough_file_impl() override {
+        assert(_in_flight == 0);
+    }
+
+    future<size_t> read_dma(uint64_t pos, void* buffer, size_t len, const io_priority_class&) override {
+        return io_dma(nvme_cmd_read, pos, reinterpret_cast<uintptr_t>(buffer), len);
+    }
+
+    future<size_t> read_dma(uint64_t pos, std::vector<iovec> iov, const io_priority_class& pc) override {
+        return iov_dma(nvme_cmd_read, pos, std::move(iov));
+    }
+
+    future<size_t> write_dma(uint64_t pos, const void* buffer, size_t len, const io_priority_class&) override {
+        return io_dma(nvme_cmd_write, pos, reinterpret_cast<uintptr_t>(buffer), len);
+    }
+
+    future<size_t> write_dma(uint64_t pos, std::vector<iovec> iov, const io_priority_class& pc) override {
+        return iov_dma(nvme_cmd_write, pos, std::move(iov));
+    }
+
+    future<temporary_buffer<uint8_t>> dma_read_bulk(uint64_t offset, size_t range_size, const io_priority_class& pc) override {
+        const uint64_t lba_size = uint64_t(1) << _lba_shift;
+        auto front = offset & (lba_size - 1);
+        offset -= front;
+        range_size = align_up(range_size + front, size_t(lba_size));
+        auto buf = temporary_buffer<uint8_t>::aligned(_memory_dma_alignment, range_size);
+        auto p = buf.get_write();
+        return read_dma(offset, p, range_size, pc).then([buf = std::move(buf), front] (size_t n) mutable {
+            buf.trim(n);
+            buf.trim_front(std::min<size_t>(front, buf.size()));
+            return std::move(buf);
+        });
+    }
+
+    future<> flush() override {
+        auto cmd = std::make_unique<command>();
+        cmd->opcode = nvme_cmd_flush;
+        return submit_command(std::move(cmd)).discard_result();
+    }
+
+    future<struct stat> stat() override {
+        struct stat st;
+        auto r = ::fstat(_fd, &st);
+        if (r == -1) {
+            return make_exception_future<struct stat>(std::make_exception_ptr(
+                    std::system_error(errno, std::system_category(), "fstat")));
+        }
+        return make_ready_future<struct stat>(st);
+    }
+
+    future<> truncate(uint64_t) override {
+        // nothing to do for a device, as with blockdev_file_impl
+        return make_ready_future<>();
+    }
+
+    future<> discard(uint64_t offset, uint64_t length) override {
+        const uint64_t lba_size = uint64_t(1) << _lba_shift;
+        if ((offset | length) & (lba_size - 1)) {
+            return make_exception_future<>(std::make_exception_ptr(
+                    std::system_error(EINVAL, std::system_category(), "nvme discard must be logical-block aligned")));
+        }
+        // Dataset Management with the deallocate attribute; one range
+        auto cmd = std::make_unique<command>();
+        cmd->opcode = nvme_cmd_dsm;
+        cmd->payload = std::make_unique<char[]>(16);
+        uint32_t nlb = (length >> _lba_shift) - 1;
+        uint64_t slba = offset >> _lba_shift;
+        std::memcpy(cmd->payload.get() + 4, &nlb, 4);
+        std::memcpy(cmd->payload.get() + 8, &slba, 8);
+        cmd->addr = reinterpret_cast<uintptr_t>(cmd->payload.get());
+        cmd->data_len = 16;
+        cmd->cdw10 = 0;     // number of ranges, 0's based
+        cmd->cdw11 = 1u << 2; // deallocate
+        return submit_command(std::move(cmd)).discard_result();
+    }
+
+    future<> allocate(uint64_t, uint64_t) override {
+        // nothing to do for a device
+        return make_ready_future<>();
+    }
+
+    future<uint64_t> size() override {
+        return make_ready_future<uint64_t>(_size);
+    }
+
+    future<> close() override {
+        if (_fd == -1) {
+            seastar_logger.warn("double close() detected, contact support");
+            return make_ready_future<>();
+        }
+        auto fd = std::exchange(_fd, -1);
+        // let in-flight commands drain before tearing down the queue pair
+        return do_until([this] { return _in_flight == 0; }, [] { return yield(); }).then([this, fd] {
+            _poller = std::nullopt;
+            ::io_uring_queue_exit(&_ring);
+            auto r = ::close(fd);
+            try {
+                throw_system_error_on(r == -1, "close");
+            } catch (...) {
+                report_exception("close() syscall failed", std::current_exception());
+            }
+        });
+    }
+
+    subscription<directory_entry> list_directory(std::function<future<> (directory_entry)>) override {
+        throw std::system_error(ENOTDIR, std::system_category(), "not a directory");
+    }
+
+private:
+    future<size_t> io_dma(uint8_t opcode, uint64_t pos, uint64_t addr, size_t len) {
+        const uint64_t lba_size = uint64_t(1) << _lba_shift;
+        if ((pos | len) & (lba_size - 1)) {
+            return make_exception_future<size_t>(std::make_exception_ptr(
+                    std::system_error(EINVAL, std::system_category(), "nvme passthrough I/O must be logical-block aligned")));
+        }
+        const size_t max = opcode == nvme_cmd_write ? _write_max_length : _read_max_length;
+        if (len <= max) {
+            return submit_io(opcode, pos, addr, len);
+        }
+        // larger than the controller's per-command limit; split
+        std::vector<future<size_t>> futs;
+        futs.reserve(len / max + 1);
+        while (len) {
+            auto now = std::min(len, max);
+            futs.push_back(submit_io(opcode, pos, addr, now));
+            pos += now;
+            addr += now;
+            len -= now;
+        }
+        return sum_sizes(std::move(futs));
+    }
+
+    future<size_t> iov_dma(uint8_t opcode, uint64_t pos, std::vector<iovec> iov) {
+        // one command per fragment; the vectored passthrough command
+        // needs newer kernels and per-fragment commands keep the queue
+        // pair just as busy
+        std::vector<future<size_t>> futs;
+        futs.reserve(iov.size());
+        for (auto& v : iov) {
+            futs.push_back(io_dma(opcode, pos, reinterpret_cast<uintptr_t>(v.iov_base), v.iov_len));
+            pos += v.iov_len;
+        }
+        return sum_sizes(std::move(futs));
+    }
+
+    static future<size_t> sum_sizes(std::vector<future<size_t>> futs) {
+        return when_all_succeed(futs.begin(), futs.end()).then([] (std::vector<size_t> sizes) {
+            return std::accumulate(sizes.begin(), sizes.end(), size_t(0));
+        });
+    }
+
+    future<size_t> submit_io(uint8_t opcode, uint64_t pos, uint64_t addr, size_t len) {
+        auto cmd = std::make_unique<command>();
+        cmd->opcode = opcode;
+        cmd->addr = addr;
+        cmd->data_len = len;
+        cmd->result = len;
+        uint64_t slba = pos >> _lba_shift;
+        cmd->cdw10 = slba & 0xffffffff;
+        cmd->cdw11 = slba >> 32;
+        cmd->cdw12 = (len >> _lba_shift) - 1; // 0's based block count
+        return submit_command(std::move(cmd));
+    }
+
+    future<size_t> submit_command(std::unique_ptr<command> cmd) {
+        auto f = cmd->pr.get_future();
+        if (auto sqe = ::io_uring_get_sqe(&_ring)) {
+            fill_sqe(sqe, cmd.get());
+            _unsubmitted = true;
+        } else {
+            _overflow.push_back(cmd.get());
+        }
+        cmd.release(); // owned by the ring / overflow queue now
+        ++_in_flight;
+        return f;
+    }
+
+    void fill_sqe(::io_uring_sqe* sqe, command* cmd) noexcept {
+        // with IORING_SETUP_SQE128 each slot is two plain sqes wide;
+        // the NVMe command occupies the second half
+        std::memset(sqe, 0, 2 * sizeof(*sqe));
+        sqe->opcode = IORING_OP_URING_CMD;
+        sqe->fd = _fd;
+        sqe->cmd_op = NVME_URING_CMD_IO;
+        sqe->user_data = reinterpret_cast<uintptr_t>(cmd);
+        auto ncmd = reinterpret_cast<struct nvme_uring_cmd*>(sqe->cmd);
+        ncmd->opcode = cmd->opcode;
+        ncmd->nsid = _nsid;
+        ncmd->addr = cmd->addr;
+        ncmd->data_len = cmd->data_len;
+        ncmd->cdw10 = cmd->cdw10;
+        ncmd->cdw11 = cmd->cdw11;
+        ncmd->cdw12 = cmd->cdw12;
+    }
+
+    bool poll() {
+        bool work = false;
+        while (!_overflow.empty()) {
+            auto sqe = ::io_uring_get_sqe(&_ring);
+            if (!sqe) {
+                break;
+            }
+            fill_sqe(sqe, _overflow.front());
+            _overflow.pop_front();
+            _unsubmitted = true;
+        }
+        if (_unsubmitted) {
+            auto r = ::io_uring_submit(&_ring);
+            if (r >= 0) {
+                _unsubmitted = false;
+                work = true;
+            }
+            // on error, leave the sqes queued and retry next poll
+        }
+        ::io_uring_cqe* cqe;
+        while (::io_uring_peek_cqe(&_ring, &cqe) == 0) {
+            auto cmd = reinterpret_cast<command*>(::io_uring_cqe_get_data(cqe));
+            auto res = cqe->res;
+            ::io_uring_cqe_seen(&_ring, cqe);
+            --_in_flight;
+            if (res < 0) {
+                cmd->pr.set_exception(std::make_exception_ptr(
+                        std::system_error(-res, std::system_category(), "nvme passthrough command failed")));
+            } else {
+                cmd->pr.set_value(cmd->result);
+            }
+            delete cmd;
+            work = true;
+        }
+        return work;
+    }
+};
+
+future<shared_ptr<file_impl>>
+make_nvme_passthrough_file_impl(int fd, open_flags, file_open_options, dev_t) noexcept {
+    return futurize_invoke([fd] () -> shared_ptr<file_impl> {
+        int nsid = ::ioctl(fd, NVME_IOCTL_ID);
+        throw_system_error_on(nsid < 0, "ioctl(NVME_IOCTL_ID)");
+
+        auto identify = [fd] (uint32_t nsid, uint32_t cns, char* buf) {
+            struct nvme_admin_cmd cmd = {};
+            cmd.opcode = 0x06; // identify
+            cmd.nsid = nsid;
+            cmd.addr = reinterpret_cast<uintptr_t>(buf);
+            cmd.data_len = 4096;
+            cmd.cdw10 = cns;
+            auto r = ::ioctl(fd, NVME_IOCTL_ADMIN_CMD, &cmd);
+            throw_system_error_on(r < 0, "ioctl(NVME_IOCTL_ADMIN_CMD)");
+        };
+        auto buf = std::make_unique<char[]>(4096);
+
+        // identify namespace: capacity and logical block size
+        identify(nsid, 0x00, buf.get());
+        uint64_t nsze;
+        std::memcpy(&nsze, buf.get(), 8);
+        uint8_t flbas = buf[26];
+        unsigned lba_shift = uint8_t(buf[128 + 4 * (flbas & 0xf) + 2]);
+
+        // identify controller: maximum transfer size (MDTS, in units of
+        // the minimum page size, which we conservatively take as 4k)
+        identify(0, 0x01, buf.get());
+        uint8_t mdts = buf[77];
+        unsigned max_transfer = mdts ? (4096u << mdts) : (1u << 30);
+
+        ::io_uring ring;
+        auto params = ::io_uring_params{};
+        params.flags = IORING_SETUP_SQE128 | IORING_SETUP_CQE32;
+        auto err = ::io_uring_queue_init_params(128, &ring, &params);
+        throw_system_error_on(err < 0, "io_uring_queue_init_params");
+
+        return make_shared<nvme_passthrough_file_impl>(fd, nsid, lba_shift, nsze << lba_shift, max_transfer, ring);
+    });
+}
+
+#else
+
+future<shared_ptr<file_impl>>
+make_nvme_passthrough_file_impl(int, open_flags, file_open_options, dev_t) noexcept {
+    return make_exception_future<shared_ptr<file_impl>>(std::make_exception_ptr(
+            std::system_error(ENOTSUP, std::system_category(), "NVMe passthrough requires liburing and NVME_URING_CMD kernel support")));
+}
+
+#endif
+
+}
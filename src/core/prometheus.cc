@@ -31,6 +31,8 @@
 #include <boost/range/combine.hpp>
 #include <seastar/core/thread.hh>
 #include <seastar/core/loop.hh>
+#include <cstring>
+#include <limits>
 #include <regex>
 
 namespace seastar {
@@ -70,7 +72,11 @@ static std::string to_str(const seastar::metrics::impl::metric_value& v) {
     return ""; // we should never get here but it makes the compiler happy
 }
 
-static void add_name(std::ostream& s, const sstring& name, const std::map<sstring, sstring>& labels, const config& ctx) {
+// Works on interned label sets (mi::labels_type, possibly owned by
+// another shard, hence iterated by reference without copying) as well
+// as on plain string maps built locally.
+template <typename LabelMap>
+static void add_name(std::ostream& s, const sstring& name, const LabelMap& labels, const config& ctx) {
     s << name << "{";
     const char* delimiter = "";
     if (ctx.label) {
@@ -79,8 +85,8 @@ static void add_name(std::ostream& s, const sstring& name, const std::map<sstrin
     }
 
     if (!labels.empty()) {
-        for (auto l : labels) {
-            if (!boost::algorithm::starts_with(l.first, "__")) {
+        for (const auto& l : labels) {
+            if (!boost::algorithm::starts_with(std::string_view(l.first), "__")) {
                 s << delimiter;
                 s << l.first  << "=\"" << l.second << '"';
                 delimiter = ",";
@@ -217,11 +223,18 @@ public:
     /** @} */
 };
 
-static future<> get_map_value(metrics_families_per_shard& vec, int handle) {
+static future<> get_map_value(metrics_families_per_shard& vec, int handle, const sstring& family_name, bool prefix) {
     vec.resize(smp::count);
-    return parallel_for_each(boost::irange(0u, smp::count), [handle, &vec] (auto cpu) {
-        return smp::submit_to(cpu, [handle] {
-            return mi::get_values(handle);
+    return parallel_for_each(boost::irange(0u, smp::count), [handle, &vec, &family_name, prefix] (auto cpu) {
+        return smp::submit_to(cpu, [handle, &family_name, prefix] {
+            if (family_name == "") {
+                return mi::get_values(handle);
+            }
+            // Push the __name__ filter down to the sampling, so the value
+            // callbacks of excluded families are never invoked.
+            return mi::get_values([&family_name, prefix] (const sstring& name) {
+                return prefix ? boost::algorithm::starts_with(name, family_name) : name == family_name;
+            }, handle);
         }).then([&vec, cpu] (auto res) {
             vec[cpu] = std::move(res);
         });
@@ -482,6 +495,18 @@ metric_family_range get_range(const metrics_families_per_shard& mf, const sstrin
 
 }
 
+// Deep-copies a (possibly foreign) interned label set into plain
+// strings. Needed wherever the labels are mutated or stored on this
+// shard -- copying interned strings would touch the owning shard's
+// non-atomic refcounts.
+static std::map<sstring, sstring> to_label_map(const mi::labels_type& labels) {
+    std::map<sstring, sstring> ret;
+    for (auto& [name, value] : labels) {
+        ret.emplace(name.str(), value.str());
+    }
+    return ret;
+}
+
 void write_histogram(std::stringstream& s, const config& ctx, const sstring& name, const seastar::metrics::histogram& h, std::map<sstring, sstring> labels) noexcept {
     add_name(s, name + "_sum", labels, ctx);
     s << h.sample_sum << '\n';
@@ -531,9 +556,10 @@ void write_summary(std::stringstream& s, const config& ctx, const sstring& name,
  */
 class metric_aggregate_by_labels {
     std::vector<std::string> _labels_to_aggregate_by;
+    seastar::metrics::aggregate_mode _mode;
     std::unordered_map<std::map<sstring, sstring>, seastar::metrics::impl::metric_value> _values;
 public:
-    metric_aggregate_by_labels(std::vector<std::string> labels) : _labels_to_aggregate_by(std::move(labels)) {
+    metric_aggregate_by_labels(std::vector<std::string> labels, seastar::metrics::aggregate_mode mode) : _labels_to_aggregate_by(std::move(labels)), _mode(mode) {
     }
     /*!
      * \brief add a metric
@@ -551,8 +577,27 @@ public:
         std::unordered_map<std::map<sstring, sstring>, seastar::metrics::impl::metric_value>::iterator i = _values.find(labels);
         if ( i == _values.end()) {
             _values.emplace(std::move(labels), m);
-        } else {
+            return;
+        }
+        if (m.type() == mi::data_type::HISTOGRAM || m.type() == mi::data_type::SUMMARY) {
+            // histograms are always merged bucket-wise; min/max make no sense
             i->second += m;
+            return;
+        }
+        switch (_mode) {
+        case seastar::metrics::aggregate_mode::sum:
+            i->second += m;
+            break;
+        case seastar::metrics::aggregate_mode::min:
+            if (m.d() < i->second.d()) {
+                i->second = m;
+            }
+            break;
+        case seastar::metrics::aggregate_mode::max:
+            if (m.d() > i->second.d()) {
+                i->second = m;
+            }
+            break;
         }
     }
     const std::unordered_map<std::map<sstring, sstring>, seastar::metrics::impl::metric_value>& get_values() const noexcept {
@@ -586,7 +631,7 @@ future<> write_text_representation(output_stream<char>& out, const config& ctx,
         for (metric_family& metric_family : m) {
             auto name = ctx.prefix + "_" + metric_family.name();
             found = false;
-            metric_aggregate_by_labels aggregated_values(metric_family.metadata().aggregate_labels);
+            metric_aggregate_by_labels aggregated_values(metric_family.metadata().aggregate_labels, metric_family.metadata().aggregate_mode);
             bool should_aggregate = !metric_family.metadata().aggregate_labels.empty();
             metric_family.foreach_metric([&s, &out, &ctx, &found, &name, &metric_family, &aggregated_values, should_aggregate, show_help, &filter](auto value, auto value_info) mutable {
                 s.clear();
@@ -602,11 +647,11 @@ future<> write_text_representation(output_stream<char>& out, const config& ctx,
                     found = true;
                 }
                 if (should_aggregate) {
-                    aggregated_values.add(value, value_info.id.labels());
+                    aggregated_values.add(value, to_label_map(value_info.id.labels()));
                 } else if (value.type() == mi::data_type::SUMMARY) {
-                    write_summary(s, ctx, name, value.get_histogram(), value_info.id.labels());
+                    write_summary(s, ctx, name, value.get_histogram(), to_label_map(value_info.id.labels()));
                 } else if (value.type() == mi::data_type::HISTOGRAM) {
-                    write_histogram(s, ctx, name, value.get_histogram(), value_info.id.labels());
+                    write_histogram(s, ctx, name, value.get_histogram(), to_label_map(value_info.id.labels()));
                 } else {
                     add_name(s, name, value_info.id.labels(), ctx);
                     s << get_value_as_string(s, value) << '\n';
@@ -632,6 +677,212 @@ future<> write_text_representation(output_stream<char>& out, const config& ctx,
     });
 }
 
+/*!
+ * \brief Hand-rolled encoder for the Prometheus protobuf exposition format
+ *
+ * The classic protobuf exposition (negotiated with
+ * "Accept: application/vnd.google.protobuf") is a stream of varint-delimited
+ * io.prometheus.client.MetricFamily messages. The schema is small and stable,
+ * so we encode it by hand rather than take a dependency on a protobuf library.
+ * Field numbers below follow prometheus/client_model metrics.proto.
+ */
+namespace pb {
+
+enum class wire_type : uint8_t {
+    varint = 0,
+    fixed64 = 1,
+    len = 2,
+};
+
+// MetricType enum from metrics.proto
+enum class metric_type : unsigned {
+    counter = 0,
+    gauge = 1,
+    summary = 2,
+    untyped = 3,
+    histogram = 4,
+};
+
+static metric_type pb_type(mi::data_type dt) {
+    switch (dt) {
+    case mi::data_type::GAUGE:
+        return metric_type::gauge;
+    case mi::data_type::COUNTER:
+    case mi::data_type::REAL_COUNTER:
+        return metric_type::counter;
+    case mi::data_type::HISTOGRAM:
+        return metric_type::histogram;
+    case mi::data_type::SUMMARY:
+        return metric_type::summary;
+    }
+    return metric_type::untyped;
+}
+
+static void add_varint(std::string& s, uint64_t v) {
+    while (v >= 0x80) {
+        s.push_back(char(v | 0x80));
+        v >>= 7;
+    }
+    s.push_back(char(v));
+}
+
+static void add_tag(std::string& s, unsigned field, wire_type wt) {
+    add_varint(s, (field << 3) | unsigned(wt));
+}
+
+static void add_double(std::string& s, unsigned field, double d) {
+    add_tag(s, field, wire_type::fixed64);
+    uint64_t bits;
+    std::memcpy(&bits, &d, sizeof(bits));
+    for (unsigned i = 0; i < sizeof(bits); ++i) {
+        s.push_back(char(bits & 0xff));
+        bits >>= 8;
+    }
+}
+
+static void add_uint(std::string& s, unsigned field, uint64_t v) {
+    add_tag(s, field, wire_type::varint);
+    add_varint(s, v);
+}
+
+static void add_string(std::string& s, unsigned field, std::string_view v) {
+    add_tag(s, field, wire_type::len);
+    add_varint(s, v.size());
+    s.append(v.data(), v.size());
+}
+
+static void add_message(std::string& s, unsigned field, const std::string& msg) {
+    add_tag(s, field, wire_type::len);
+    add_varint(s, msg.size());
+    s.append(msg);
+}
+
+template <typename LabelMap>
+static void add_label_pairs(std::string& metric, const LabelMap& labels, const config& ctx) {
+    // Mirrors add_name(): the configured global label comes first and
+    // internal "__"-prefixed labels are not exposed.
+    std::string pair;
+    if (ctx.label) {
+        add_string(pair, 1, std::string_view(ctx.label->key()));
+        add_string(pair, 2, std::string_view(ctx.label->value()));
+        add_message(metric, 1, pair);
+    }
+    for (auto&& l : labels) {
+        if (boost::algorithm::starts_with(std::string_view(l.first), "__")) {
+            continue;
+        }
+        pair.clear();
+        add_string(pair, 1, std::string_view(l.first));
+        add_string(pair, 2, std::string_view(l.second));
+        add_message(metric, 1, pair);
+    }
+}
+
+// Serialize one io.prometheus.client.Metric message.
+template <typename LabelMap>
+static std::string make_metric(const mi::metric_value& value, const LabelMap& labels, const config& ctx) {
+    std::string metric;
+    add_label_pairs(metric, labels, ctx);
+    std::string sub;
+    switch (value.type()) {
+    case mi::data_type::GAUGE:
+        add_double(sub, 1, value.d());
+        add_message(metric, 2, sub); // Metric.gauge
+        break;
+    case mi::data_type::COUNTER:
+        add_double(sub, 1, value.i());
+        add_message(metric, 3, sub); // Metric.counter
+        break;
+    case mi::data_type::REAL_COUNTER:
+        add_double(sub, 1, value.d());
+        add_message(metric, 3, sub); // Metric.counter
+        break;
+    case mi::data_type::HISTOGRAM: {
+        auto&& h = value.get_histogram();
+        add_uint(sub, 1, h.sample_count);
+        add_double(sub, 2, h.sample_sum);
+        std::string bucket;
+        for (auto&& b : h.buckets) {
+            bucket.clear();
+            add_uint(bucket, 1, b.count);
+            add_double(bucket, 2, b.upper_bound);
+            add_message(sub, 3, bucket); // Histogram.bucket
+        }
+        bucket.clear();
+        add_uint(bucket, 1, h.sample_count);
+        add_double(bucket, 2, std::numeric_limits<double>::infinity());
+        add_message(sub, 3, bucket); // the implicit +Inf bucket
+        add_message(metric, 7, sub); // Metric.histogram
+        break;
+    }
+    case mi::data_type::SUMMARY: {
+        auto&& h = value.get_histogram();
+        if (h.sample_count) {
+            add_uint(sub, 1, h.sample_count);
+        }
+        if (h.sample_sum) {
+            add_double(sub, 2, h.sample_sum);
+        }
+        std::string quantile;
+        for (auto&& b : h.buckets) {
+            quantile.clear();
+            add_double(quantile, 1, b.upper_bound);
+            add_double(quantile, 2, b.count);
+            add_message(sub, 3, quantile); // Summary.quantile
+        }
+        add_message(metric, 4, sub); // Metric.summary
+        break;
+    }
+    }
+    return metric;
+}
+
+} // namespace pb
+
+future<> write_protobuf_representation(output_stream<char>& out, const config& ctx, const metric_family_range& m, std::function<bool(const mi::labels_type&)> filter) {
+    return seastar::async([&ctx, &out, &m, filter] () mutable {
+        // Each metric family must appear exactly once per exposition, and
+        // the varint length prefix needs the full message size up front, so
+        // a family is accumulated in whole before it is written; writing at
+        // family granularity still lets the output_stream backpressure pace
+        // us between families.
+        for (metric_family& metric_family : m) {
+            auto name = ctx.prefix + "_" + metric_family.name();
+            std::string buf;
+            pb::add_string(buf, 1, std::string_view(name));
+            if (metric_family.metadata().d.str() != "") {
+                pb::add_string(buf, 2, std::string_view(metric_family.metadata().d.str()));
+            }
+            pb::add_uint(buf, 3, unsigned(pb::pb_type(metric_family.metadata().type)));
+            auto header_size = buf.size();
+            metric_aggregate_by_labels aggregated_values(metric_family.metadata().aggregate_labels, metric_family.metadata().aggregate_mode);
+            bool should_aggregate = !metric_family.metadata().aggregate_labels.empty();
+            metric_family.foreach_metric([&](auto value, auto value_info) {
+                if ((value_info.should_skip_when_empty && value.is_empty()) || !filter(value_info.id.labels())) {
+                    return;
+                }
+                if (should_aggregate) {
+                    aggregated_values.add(value, to_label_map(value_info.id.labels()));
+                    return;
+                }
+                pb::add_message(buf, 4, pb::make_metric(value, value_info.id.labels(), ctx));
+                thread::maybe_yield();
+            });
+            for (auto&& h : aggregated_values.get_values()) {
+                pb::add_message(buf, 4, pb::make_metric(h.second, h.first, ctx));
+                thread::maybe_yield();
+            }
+            if (buf.size() == header_size) {
+                continue; // no metrics made it past the filter
+            }
+            std::string delimiter;
+            pb::add_varint(delimiter, buf.size());
+            out.write(delimiter).get();
+            out.write(buf).get();
+        }
+    });
+}
+
 class metrics_handler : public httpd::handler_base  {
     sstring _prefix;
     config _ctx;
@@ -691,14 +942,18 @@ public:
         sstring metric_family_name = req->get_query_param("__name__");
         bool prefix = trim_asterisk(metric_family_name);
         bool show_help = req->get_query_param("__help__") != "false";
+        bool is_protobuf = req->get_header("Accept").find("application/vnd.google.protobuf") != sstring::npos;
         std::function<bool(const mi::labels_type&)> filter = make_filter(*req);
 
-        rep->write_body("txt", [this, metric_family_name, prefix, show_help, filter] (output_stream<char>&& s) {
+        rep->write_body("txt", [this, metric_family_name, prefix, show_help, filter, is_protobuf] (output_stream<char>&& s) {
             return do_with(metrics_families_per_shard(), output_stream<char>(std::move(s)),
-                    [this, prefix, &metric_family_name, show_help, filter] (metrics_families_per_shard& families, output_stream<char>& s) mutable {
-                return get_map_value(families, _ctx.handle).then([&s, &families, this, prefix, &metric_family_name, show_help, filter]() mutable {
+                    [this, prefix, &metric_family_name, show_help, filter, is_protobuf] (metrics_families_per_shard& families, output_stream<char>& s) mutable {
+                return get_map_value(families, _ctx.handle, metric_family_name, prefix).then([&s, &families, this, prefix, &metric_family_name, show_help, filter, is_protobuf]() mutable {
                     return do_with(get_range(families, metric_family_name, prefix),
-                            [&s, this, show_help, filter](metric_family_range& m) {
+                            [&s, this, show_help, filter, is_protobuf](metric_family_range& m) {
+                        if (is_protobuf) {
+                            return write_protobuf_representation(s, _ctx, m, filter);
+                        }
                         return write_text_representation(s, _ctx, m, show_help, filter);
                     });
                 }).finally([&s] () mutable {
@@ -706,6 +961,9 @@ public:
                 });
             });
         });
+        if (is_protobuf) {
+            rep->set_mime_type("application/vnd.google.protobuf; proto=io.prometheus.client.MetricFamily; encoding=delimited");
+        }
         return make_ready_future<std::unique_ptr<http::reply>>(std::move(rep));
     }
 };
@@ -58,6 +58,8 @@
 #include <seastar/core/io_queue.hh>
 #include <seastar/core/internal/buffer_allocator.hh>
 #include <seastar/core/internal/io_desc.hh>
+#include <seastar/core/internal/shard_heartbeat.hh>
+#include <seastar/core/internal/trace.hh>
 #include <seastar/core/internal/uname.hh>
 #include <seastar/core/scheduling_specific.hh>
 #include <seastar/core/smp_options.hh>
@@ -68,6 +70,7 @@
 #include "core/thread_pool.hh"
 #include "syscall_work_queue.hh"
 #include "cgroup.hh"
+#include <bit>
 #include <cassert>
 #include <cmath>
 #include <unistd.h>
@@ -91,6 +94,7 @@
 #include <dirent.h>
 #include <linux/types.h> // for xfs, below
 #include <sys/ioctl.h>
+#include <linux/filter.h>
 #include <linux/perf_event.h>
 #include <xfs/linux.h>
 #define min min    /* prevent xfs.h from defining min() as a macro */
@@ -129,6 +133,7 @@
 
 #if defined(__x86_64__) || defined(__i386__)
 #include <xmmintrin.h>
+#include <cpuid.h>
 #endif
 
 #include <seastar/util/defer.hh>
@@ -163,6 +168,7 @@ struct mountpoint_params {
     uint64_t write_saturation_length = std::numeric_limits<uint64_t>::max();
     bool duplex = false;
     float rate_factor = 1.0;
+    uint64_t max_merge_length = 0;
 };
 
 }
@@ -189,6 +195,9 @@ struct convert<seastar::mountpoint_params> {
         if (node["rate_factor"]) {
             mp.rate_factor = node["rate_factor"].as<float>();
         }
+        if (node["max_merge_length"]) {
+            mp.max_merge_length = parse_memory_size(node["max_merge_length"].as<std::string>());
+        }
         return true;
     }
 };
@@ -482,6 +491,22 @@ future<size_t> pollable_fd_state::recvmsg(struct msghdr *msg) {
     });
 }
 
+future<size_t> pollable_fd_state::recvmmsg(struct mmsghdr* msg, unsigned vlen) {
+    maybe_no_more_recv();
+    return engine().readable(*this).then([this, msg, vlen] {
+        auto r = fd.recvmmsg(msg, vlen, 0);
+        if (!r) {
+            return recvmmsg(msg, vlen);
+        }
+        // A full batch suggests more datagrams are waiting in the socket
+        // queue, so speculate to reap them without an epoll round trip.
+        if (*r == vlen) {
+            speculate_epoll(EPOLLIN);
+        }
+        return make_ready_future<size_t>(*r);
+    });
+}
+
 future<size_t> pollable_fd_state::sendmsg(struct msghdr* msg) {
     maybe_no_more_send();
     return engine().writeable(*this).then([this, msg] () mutable {
@@ -609,11 +634,162 @@ timespec to_timespec(steady_clock_type::time_point t) {
     return { n / 1'000'000'000, n % 1'000'000'000 };
 }
 
+namespace {
+
+// Extrapolating the low-resolution clocks from the cycle counter saves
+// two vdso clock reads per update (one update per task batch). The bases
+// are re-read from the real clocks about once a second, which bounds
+// both the frequency-estimate error and drift against NTP slewing of
+// the system clock to well under the clocks' effective granularity.
+struct lowres_clock_calibration {
+    uint64_t base_tsc = 0;
+    uint64_t recalibrate_tsc = 0; // extrapolate while tsc is below this
+    int64_t base_steady_ns = 0;
+    int64_t base_system_ns = 0;
+    double ns_per_cycle = 0;
+};
+
+thread_local lowres_clock_calibration lowres_calibration;
+
+#if defined(__x86_64__) || defined(__i386__)
+bool detect_invariant_tsc() {
+    unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+    // CPUID.80000007H:EDX.InvariantTSC[bit 8]: the TSC ticks at a constant
+    // rate across P/C/T-states, so it can serve as a time reference
+    return __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) && (edx & (1u << 8));
+}
+
+const bool have_invariant_tsc = detect_invariant_tsc();
+#endif
+
+}
+
 void lowres_clock::update() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+    if (have_invariant_tsc) {
+        auto& cal = lowres_calibration;
+        auto tsc = __builtin_ia32_rdtsc();
+        if (tsc >= cal.base_tsc && tsc < cal.recalibrate_tsc) {
+            auto delta = std::chrono::nanoseconds(int64_t(double(tsc - cal.base_tsc) * cal.ns_per_cycle));
+            auto steady = lowres_clock::time_point(std::chrono::nanoseconds(cal.base_steady_ns) + delta);
+            // extrapolation error must never make the steady clock step back
+            lowres_clock::_now = std::max(lowres_clock::_now, steady);
+            lowres_system_clock::_now = lowres_system_clock::time_point(
+                    std::chrono::duration_cast<lowres_system_clock::duration>(std::chrono::nanoseconds(cal.base_system_ns) + delta));
+            return;
+        }
+        auto steady_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        auto system_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        constexpr int64_t min_calibration_interval_ns = 10'000'000;
+        if (cal.base_tsc && tsc > cal.base_tsc && steady_ns - cal.base_steady_ns >= min_calibration_interval_ns) {
+            // A window this long gives a frequency estimate good enough to
+            // extrapolate for a second; shift the base to this sample
+            cal.ns_per_cycle = double(steady_ns - cal.base_steady_ns) / double(tsc - cal.base_tsc);
+            cal.recalibrate_tsc = tsc + uint64_t(1e9 / cal.ns_per_cycle);
+            cal.base_tsc = tsc;
+            cal.base_steady_ns = steady_ns;
+            cal.base_system_ns = system_ns;
+        } else if (!cal.base_tsc) {
+            // remember the first sample; keep reading the real clocks
+            // until the calibration window is long enough
+            cal.base_tsc = tsc;
+            cal.base_steady_ns = steady_ns;
+            cal.base_system_ns = system_ns;
+        }
+        lowres_clock::_now = std::max(lowres_clock::_now, lowres_clock::time_point(std::chrono::nanoseconds(steady_ns)));
+        lowres_system_clock::_now = lowres_system_clock::time_point(
+                std::chrono::duration_cast<lowres_system_clock::duration>(std::chrono::nanoseconds(system_ns)));
+        return;
+    }
+#endif
     lowres_clock::_now = lowres_clock::time_point(std::chrono::steady_clock::now().time_since_epoch());
     lowres_system_clock::_now = lowres_system_clock::time_point(std::chrono::system_clock::now().time_since_epoch());
 }
 
+namespace internal {
+
+// See shard_heartbeat.hh for the layout and the external-watchdog
+// protocol. The slots are written from the reactor main loop and read
+// from any shard (and from outside the process), so they are set up once
+// before the reactor threads start and stay mapped until process exit.
+static shard_heartbeat_header* heartbeat_header = nullptr;
+static shard_heartbeat_slot* heartbeat_slots = nullptr;
+// Cycle-counter/steady-clock sample pair taken at setup; shard 0's load
+// timer derives ns_per_cycle from it, over an ever-growing window.
+static uint64_t heartbeat_base_tsc;
+static int64_t heartbeat_base_steady_ns;
+
+static void setup_shard_heartbeats(unsigned nshards) {
+    auto size = align_up(sizeof(shard_heartbeat_header) + nshards * sizeof(shard_heartbeat_slot), size_t(getpagesize()));
+    int fd = ::memfd_create("seastar-heartbeat", MFD_CLOEXEC);
+    if (fd != -1 && ::ftruncate(fd, size) == -1) {
+        ::close(fd);
+        fd = -1;
+    }
+    // Without a memfd the page is invisible to sidecar processes, but the
+    // intra-process API still works on an anonymous shared mapping.
+    auto flags = fd == -1 ? MAP_SHARED | MAP_ANONYMOUS : MAP_SHARED;
+    auto p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, fd, 0);
+    if (p == MAP_FAILED) {
+        if (fd != -1) {
+            ::close(fd);
+        }
+        seastar_logger.warn("failed to map shard heartbeat page: {}; stall queries disabled", std::error_code(errno, std::system_category()).message());
+        return;
+    }
+    // the fd is deliberately left open so watchdogs can map the region
+    // through /proc/<pid>/fd for as long as the process lives
+    heartbeat_header = new (p) shard_heartbeat_header{};
+    heartbeat_slots = new (static_cast<void*>(heartbeat_header + 1)) shard_heartbeat_slot[nshards]{};
+    heartbeat_header->nshards = nshards;
+    heartbeat_header->version = shard_heartbeat_header::layout_version;
+    heartbeat_base_tsc = read_cycle_counter();
+    heartbeat_base_steady_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    // the magic is written last, so a watchdog that sees it can trust the
+    // rest of the header
+    heartbeat_header->magic = shard_heartbeat_header::magic_value;
+}
+
+// Refresh the published cycle-counter frequency estimate. Called about
+// once a second from shard 0; the calibration window only grows, so the
+// estimate keeps improving.
+static void calibrate_shard_heartbeats() {
+    auto tsc = read_cycle_counter();
+    auto steady_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    if (tsc > heartbeat_base_tsc && steady_ns > heartbeat_base_steady_ns) {
+        auto ns_per_cycle = double(steady_ns - heartbeat_base_steady_ns) / double(tsc - heartbeat_base_tsc);
+        heartbeat_header->ns_per_cycle_bits.store(std::bit_cast<uint64_t>(ns_per_cycle), std::memory_order_relaxed);
+    }
+}
+
+}
+
+uint64_t smp::shard_heartbeat(shard_id id) noexcept {
+    if (!internal::heartbeat_slots || id >= count) {
+        return 0;
+    }
+    return internal::heartbeat_slots[id].last_poll_tsc.load(std::memory_order_relaxed);
+}
+
+bool smp::shard_is_stalled(shard_id id, std::chrono::nanoseconds threshold) noexcept {
+    auto hb = shard_heartbeat(id);
+    if (!hb) {
+        // not started yet (or heartbeats unavailable)
+        return false;
+    }
+    auto ns_per_cycle_bits = internal::heartbeat_header->ns_per_cycle_bits.load(std::memory_order_relaxed);
+    if (!ns_per_cycle_bits) {
+        // frequency not calibrated yet
+        return false;
+    }
+    auto now = internal::read_cycle_counter();
+    if (now <= hb) {
+        // unsynchronized counters; don't report a stall on noise
+        return false;
+    }
+    return double(now - hb) * std::bit_cast<double>(ns_per_cycle_bits) >= double(threshold.count());
+}
+
 template <typename Clock>
 inline
 timer<Clock>::~timer() {
@@ -855,9 +1031,60 @@ reactor::task_queue::task_queue(unsigned id, sstring name, float shares)
         , _id(id)
         , _ts(now())
         , _name(std::move(name)) {
+    // Exponential buckets, 1us to ~33ms; queueing delays beyond that land
+    // in the implicit +Inf bucket.
+    auto bound = 1e-6;
+    _sojourn_hist.buckets.resize(16);
+    for (auto& b : _sojourn_hist.buckets) {
+        b.upper_bound = bound;
+        bound *= 2;
+    }
     register_stats();
 }
 
+void
+reactor::task_queue::sample_enqueue(task* t) noexcept {
+    if (_sample_countdown-- == 0) {
+        _sample_countdown = sojourn_sample_interval - 1;
+        if (!_sampled_task) {
+            _sampled_task = t;
+            _sampled_enqueued_at = now();
+        }
+    }
+}
+
+void
+reactor::task_queue::account_sojourn() noexcept {
+    auto delay = now() - _sampled_enqueued_at;
+    _sampled_task = nullptr;
+    auto d = std::chrono::duration_cast<std::chrono::duration<double>>(delay).count();
+    _sojourn_hist.sample_count++;
+    _sojourn_hist.sample_sum += d;
+    // prometheus histogram buckets are cumulative
+    for (auto& b : _sojourn_hist.buckets) {
+        if (d <= b.upper_bound) {
+            b.count++;
+        }
+    }
+    if (_shed_hook) {
+        if (delay >= _shed_threshold) {
+            if (!_shed_triggered) {
+                _shed_triggered = true;
+                _shed_hook(delay);
+            }
+        } else {
+            _shed_triggered = false;
+        }
+    }
+}
+
+void
+reactor::task_queue::set_shed_hook(sched_clock::duration threshold, noncopyable_function<void(sched_clock::duration)> hook) noexcept {
+    _shed_threshold = threshold;
+    _shed_hook = std::move(hook);
+    _shed_triggered = false;
+}
+
 void
 reactor::task_queue::register_stats() {
     seastar::metrics::metric_groups new_metrics;
@@ -890,6 +1117,18 @@ reactor::task_queue::register_stats() {
                 return _time_spent_on_task_quota_violations / 1ms;
         }, sm::description("Total amount in milliseconds we were in violation of the task quota"),
            {group_label}),
+        sm::make_histogram("task_sojourn_time", [this] { return _sojourn_hist; },
+                sm::description("Sampled distribution of time, in seconds, tasks spent queued before running; long sojourn times predict scheduler-induced tail latency"),
+                {group_label}),
+        sm::make_counter("instructions", _instructions,
+                sm::description("Instructions retired while tasks of this queue ran; stays zero when hardware counters are unavailable"),
+                {group_label}),
+        sm::make_counter("cpu_cycles", _cycles,
+                sm::description("CPU cycles consumed while tasks of this queue ran; together with instructions indicates IPC per scheduling group"),
+                {group_label}),
+        sm::make_counter("llc_misses", _llc_misses,
+                sm::description("Last-level-cache misses while tasks of this queue ran; attributes cache-miss budgets to request classes"),
+                {group_label}),
     });
     _metrics = std::exchange(new_metrics, sm::metric_groups{});
 }
@@ -930,11 +1169,40 @@ reactor::account_runtime(task_queue& tq, sched_clock::duration runtime) {
     tq._runtime += runtime;
 }
 
+void
+reactor::account_hw_counters(task_queue& tq, const internal::hw_counter_sample& begin, const internal::hw_counter_sample& end) {
+    tq._instructions += end.instructions - begin.instructions;
+    tq._cycles += end.cycles - begin.cycles;
+    tq._llc_misses += end.llc_misses - begin.llc_misses;
+}
+
 void
 reactor::account_idle(sched_clock::duration runtime) {
     // anything to do here?
 }
 
+void
+reactor::adjust_task_quota() {
+    // Crude AIMD feedback controller. Quota violations mean tasks are running
+    // past the point where need_preempt() should have stopped them, so the
+    // effective scheduling latency is above the configured goal; halve the
+    // quota to make the preemption signal fire earlier. Quiet periods grow it
+    // back additively towards the configured value to recover throughput.
+    sched_clock::duration violations = {};
+    for (auto&& tq : _task_queues) {
+        if (tq) {
+            violations += tq->_time_spent_on_task_quota_violations;
+        }
+    }
+    auto delta = violations - _last_task_quota_violation_time;
+    _last_task_quota_violation_time = violations;
+    if (delta > sched_clock::duration{}) {
+        _task_quota = std::max(_task_quota / 2, _configured_task_quota / 8);
+    } else {
+        _task_quota = std::min(_task_quota + _configured_task_quota / 8, _configured_task_quota);
+    }
+}
+
 struct reactor::task_queue::indirect_compare {
     bool operator()(const task_queue* tq1, const task_queue* tq2) const {
         return tq1->_vruntime < tq2->_vruntime;
@@ -963,10 +1231,15 @@ reactor::reactor(std::shared_ptr<smp> smp, alien::instance& alien, unsigned id,
      * needs the _signals._signal_handlers map to be initialized.
      */
     _backend = rbs.create(*this);
+    _io_sink.set_kernel_cancel([this] (io_completion* desc) {
+        return _backend->cancel_io(desc);
+    });
     *internal::get_scheduling_group_specific_thread_local_data_ptr() = &_scheduling_group_specific_data;
     _task_queues.push_back(std::make_unique<task_queue>(0, "main", 1000));
     _task_queues.push_back(std::make_unique<task_queue>(1, "atexit", 1000));
     _at_destroy_tasks = _task_queues.back().get();
+    _throttled_task_queues.reserve(max_scheduling_groups());
+    _cpu_cap_release_timer.set_callback([this] { release_throttled_queues(); });
     set_need_preempt_var(&_preemption_monitor);
     seastar::thread_impl::init();
     _backend->start_tick();
@@ -1007,18 +1280,17 @@ reactor::~reactor() {
     auto& sg_data = _scheduling_group_specific_data;
     for (auto&& tq : _task_queues) {
         if (tq) {
-            auto& this_sg = sg_data.per_scheduling_group_data[tq->_id];
             // The following line will preserve the convention that constructor and destructor functions
             // for the per sg values are called in the context of the containing scheduling group.
             *internal::current_scheduling_group_ptr() = scheduling_group(tq->_id);
             for (size_t key : boost::irange<size_t>(0, sg_data.scheduling_group_key_configs.size())) {
-                void* val = this_sg.specific_vals[key];
+                void*& val = sg_data.get_specific_val(tq->_id, key);
                 if (val) {
                     if (sg_data.scheduling_group_key_configs[key].destructor) {
                         sg_data.scheduling_group_key_configs[key].destructor(val);
                     }
                     free(val);
-                    this_sg.specific_vals[key] = nullptr;
+                    val = nullptr;
                 }
             }
         }
@@ -1387,6 +1659,40 @@ void cpu_stall_detector::generate_trace() {
     maybe_report_kernel_trace();
 }
 
+void cpu_profiler::update_config(config cfg) {
+    if (cfg.capacity != _cfg.capacity) {
+        _traces = circular_buffer<cpu_profiler_trace>();
+        _traces.reserve(cfg.capacity);
+        _dropped_samples = 0;
+    }
+    _cfg = std::move(cfg);
+    if (_cfg.enabled) {
+        _next_sample_at = read_cycle_counter() + _cfg.period;
+    } else {
+        // maybe_sample() has no enabled check on its fast path; an
+        // unreachable deadline disables it instead
+        _next_sample_at = std::numeric_limits<uint64_t>::max();
+    }
+}
+
+void cpu_profiler::take_sample(const task& t) noexcept {
+    _next_sample_at = read_cycle_counter() + _cfg.period;
+    if (_traces.size() >= _cfg.capacity) {
+        _traces.pop_front();
+        ++_dropped_samples;
+    }
+    _traces.push_back(cpu_profiler_trace{std::chrono::steady_clock::now(), current_scheduling_group(), &typeid(t)});
+}
+
+uint64_t cpu_profiler::drain(std::vector<cpu_profiler_trace>& out) {
+    out.reserve(out.size() + _traces.size());
+    while (!_traces.empty()) {
+        out.push_back(_traces.front());
+        _traces.pop_front();
+    }
+    return std::exchange(_dropped_samples, 0);
+}
+
 } // internal namespace
 
 void
@@ -1405,6 +1711,27 @@ reactor::get_blocked_reactor_notify_ms() const {
     return std::chrono::duration_cast<std::chrono::milliseconds>(d);
 }
 
+void
+reactor::apply_runtime_tunables(const runtime_tunables& cfg) {
+    _task_quota = std::chrono::duration_cast<sched_clock::duration>(cfg.task_quota_ms);
+    _configured_task_quota = _task_quota;
+    _task_quota_adaptive = cfg.task_quota_adaptive;
+    update_blocked_reactor_notify_ms(cfg.blocked_reactor_notify_ms);
+    _max_task_backlog = cfg.max_task_backlog;
+}
+
+future<>
+update_runtime_tunables(runtime_tunables cfg) {
+    auto& r = engine();
+    auto pending_version = r._pending_runtime_tunables ? r._pending_runtime_tunables->version : 0;
+    cfg.version = std::max(r._runtime_tunables->version, pending_version) + 1;
+    seastar_logger.info("applying runtime tunables version {}: task-quota-ms={} task-quota-adaptive={} blocked-reactor-notify-ms={} max-task-backlog={}",
+            cfg.version, cfg.task_quota_ms.count(), cfg.task_quota_adaptive, cfg.blocked_reactor_notify_ms.count(), cfg.max_task_backlog);
+    return smp::invoke_on_all([cfg] {
+        engine()._pending_runtime_tunables = make_lw_shared<const runtime_tunables>(cfg);
+    });
+}
+
 void
 reactor::set_stall_detector_report_function(std::function<void ()> report) {
     auto cfg = _cpu_stall_detector->get_config();
@@ -1418,6 +1745,21 @@ reactor::get_stall_detector_report_function() const {
     return _cpu_stall_detector->get_config().report;
 }
 
+void
+reactor::set_cpu_profiler_config(internal::cpu_profiler::config cfg) {
+    _cpu_profiler.update_config(std::move(cfg));
+}
+
+internal::cpu_profiler::config
+reactor::get_cpu_profiler_config() const {
+    return _cpu_profiler.get_config();
+}
+
+uint64_t
+reactor::drain_cpu_profiler_traces(std::vector<internal::cpu_profiler_trace>& out) {
+    return _cpu_profiler.drain(out);
+}
+
 void
 reactor::block_notifier(int) {
     engine()._cpu_stall_detector->on_signal();
@@ -1425,7 +1767,8 @@ reactor::block_notifier(int) {
 
 template <typename T, typename E, typename EnableFunc>
 void reactor::complete_timers(T& timers, E& expired_timers, EnableFunc&& enable_fn) noexcept(noexcept(enable_fn())) {
-    expired_timers = timers.expire(timers.now());
+    auto now = timers.now();
+    expired_timers = timers.expire(now);
     for (auto& t : expired_timers) {
         t._expired = true;
     }
@@ -1435,6 +1778,15 @@ void reactor::complete_timers(T& timers, E& expired_timers, EnableFunc&& enable_
         expired_timers.pop_front();
         t->_queued = false;
         if (t->_armed) {
+            if (t->_deferred_expiry > t->_expiry && t->_deferred_expiry > now) {
+                // The timer was postpone()d past its wheel position; move
+                // it to the new position now that the old one was reached.
+                t->_expiry = t->_deferred_expiry;
+                t->_expired = false;
+                t->_queued = true;
+                timers.insert(*t);
+                continue;
+            }
             t->_armed = false;
             if (t->_period) {
                 t->readd_periodic();
@@ -1503,6 +1855,8 @@ void reactor::configure(const reactor_options& opts) {
     _handle_sigint = !opts.no_handle_interrupt;
     auto task_quota = opts.task_quota_ms.get_value() * 1ms;
     _task_quota = std::chrono::duration_cast<sched_clock::duration>(task_quota);
+    _task_quota_adaptive = opts.task_quota_adaptive.get_value();
+    _configured_task_quota = _task_quota;
 
     auto blocked_time = opts.blocked_reactor_notify_ms.get_value() * 1ms;
     internal::cpu_stall_detector_config csdc;
@@ -1512,6 +1866,18 @@ void reactor::configure(const reactor_options& opts) {
     _cpu_stall_detector->update_config(csdc);
 
     _max_task_backlog = opts.max_task_backlog.get_value();
+
+    runtime_tunables initial;
+    initial.task_quota_ms = task_quota;
+    initial.task_quota_adaptive = _task_quota_adaptive;
+    initial.blocked_reactor_notify_ms = std::chrono::duration_cast<std::chrono::milliseconds>(blocked_time);
+    initial.max_task_backlog = _max_task_backlog;
+    _runtime_tunables = make_lw_shared<const runtime_tunables>(std::move(initial));
+
+    _timers.set_coalescing_window(std::chrono::duration_cast<steady_clock_type::duration>(opts.timer_coalescing_us.get_value() * 1us));
+    // The batch cap stays well below the backends' iocb/sqe pools so a
+    // released batch always fits in one submission call.
+    _io_sink.enable_write_combining(std::chrono::microseconds(opts.io_combine_deadline_us.get_value()), 32);
     _max_poll_time = opts.idle_poll_time_us.get_value() * 1us;
     if (opts.poll_mode) {
         _max_poll_time = std::chrono::nanoseconds::max();
@@ -1568,16 +1934,52 @@ reactor::posix_listen(socket_address sa, listen_options opts) {
         throw std::system_error(s.code(), fmt::format("posix_listen failed for address {}", sa));
     }
 
+    if (_reuseport && !sa.is_af_unix()) {
+        try {
+            attach_reuseport_steering_bpf(fd, smp::count);
+        } catch (const std::system_error&) {
+            // The kernel falls back to hash-based selection, connections
+            // are still delivered, just without CPU affinity.
+        }
+    }
+
     return pollable_fd(std::move(fd));
 }
 
+// Steer each connection of a reuseport group to the listening socket picked
+// by the CPU that handled the SYN, so that (with RSS aligned with shard
+// placement) the shard that does the network I/O for a connection is also
+// the one that accepts and owns it. The kernel falls back to hash-based
+// selection while the program returns an index not yet present in the group,
+// e.g. before all shards have started listening.
+void
+reactor::attach_reuseport_steering_bpf(file_desc& fd, unsigned nr_sockets) {
+#if defined(SO_ATTACH_REUSEPORT_CBPF)
+    sock_filter code[] = {
+        { BPF_LD | BPF_W | BPF_ABS, 0, 0, uint32_t(SKF_AD_OFF + SKF_AD_CPU) },
+        { BPF_ALU | BPF_MOD | BPF_K, 0, 0, nr_sockets },
+        { BPF_RET | BPF_A, 0, 0, 0 },
+    };
+    sock_fprog prog = { sizeof(code) / sizeof(code[0]), code };
+    fd.setsockopt(SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, prog);
+#else
+    throw std::system_error(std::make_error_code(std::errc::not_supported));
+#endif
+}
+
 bool
 reactor::posix_reuseport_detect() {
-    return false; // FIXME: reuseport currently leads to heavy load imbalance. Until we fix that, just
-                  // disable it unconditionally.
+    // Reuseport without connection steering leads to heavy load imbalance,
+    // so only use it when the kernel also accepts a socket-selection BPF
+    // program (SO_ATTACH_REUSEPORT_CBPF, linux 4.5+).
     try {
         file_desc fd = file_desc::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
         fd.setsockopt(SOL_SOCKET, SO_REUSEPORT, 1);
+        ::sockaddr_in sin = {};
+        sin.sin_family = AF_INET;
+        sin.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        fd.bind(reinterpret_cast<sockaddr&>(sin), sizeof(sin));
+        attach_reuseport_steering_bpf(fd, 1);
         return true;
     } catch(std::system_error& e) {
         return false;
@@ -1788,6 +2190,22 @@ reactor::open_file_dma(std::string_view nameref, open_flags flags, file_open_opt
                     ::ioctl(fd, XFS_IOC_FSSETXATTR, &attr);
                 }
             }
+#ifdef F_SET_RW_HINT
+            if (fd != -1 && options.lifetime_hint != write_lifetime_hint::not_set) {
+                uint64_t hint = [&] {
+                    switch (options.lifetime_hint) {
+                    case write_lifetime_hint::none: return RWH_WRITE_LIFE_NONE;
+                    case write_lifetime_hint::short_lived: return RWH_WRITE_LIFE_SHORT;
+                    case write_lifetime_hint::medium: return RWH_WRITE_LIFE_MEDIUM;
+                    case write_lifetime_hint::long_lived: return RWH_WRITE_LIFE_LONG;
+                    case write_lifetime_hint::extreme: return RWH_WRITE_LIFE_EXTREME;
+                    default: return RWH_WRITE_LIFE_NOT_SET;
+                    }
+                }();
+                // Ignore error; just a hint, and older kernels lack it
+                ::fcntl(fd, F_SET_RW_HINT, &hint);
+            }
+#endif
             return wrap_syscall<int>(fd);
         }).then([&options, name = std::move(name), &open_flags] (syscall_result<int> sr) {
             sr.throw_fs_exception_if_error("open failed", name);
@@ -1811,6 +2229,32 @@ reactor::remove_file(std::string_view pathname) noexcept {
     });
 }
 
+future<>
+reactor::remove_files_at(std::string_view dir, std::vector<sstring> names) noexcept {
+    // Allocating memory for a sstring can throw, hence the futurize_invoke
+    return futurize_invoke([dir, names = std::move(names)] () mutable {
+        return engine()._thread_pool->submit<syscall_result<int>>([dir = sstring(dir), names = std::move(names)] {
+            int dirfd = ::open(dir.c_str(), O_DIRECTORY | O_RDONLY | O_CLOEXEC);
+            if (dirfd == -1) {
+                return wrap_syscall<int>(dirfd);
+            }
+            int r = 0;
+            for (const auto& name : names) {
+                r = ::unlinkat(dirfd, name.c_str(), 0);
+                if (r == -1) {
+                    break;
+                }
+            }
+            auto sr = wrap_syscall<int>(r);
+            ::close(dirfd);
+            return sr;
+        }).then([dir = sstring(dir)] (syscall_result<int> sr) {
+            sr.throw_fs_exception_if_error("remove failed", dir);
+            return make_ready_future<>();
+        });
+    });
+}
+
 future<>
 reactor::rename_file(std::string_view old_pathname, std::string_view new_pathname) noexcept {
     // Allocating memory for a sstring can throw, hence the futurize_invoke
@@ -2122,6 +2566,10 @@ void reactor::kill(pid_t pid, int sig) {
     ret.throw_if_error();
 }
 
+future<int> reactor::run_on_syscall_thread(noncopyable_function<int ()> func) noexcept {
+    return _thread_pool->submit<int>(std::move(func));
+}
+
 future<stat_data>
 reactor::file_stat(std::string_view pathname, follow_symlink follow) noexcept {
     // Allocating memory for a sstring can throw, hence the futurize_invoke
@@ -2508,6 +2956,20 @@ void reactor::register_metrics() {
             sm::make_counter("malloc_failed", [] { return memory::stats().failed_allocations(); }, sm::description("Total count of failed memory allocations"))
     });
 
+    // One gauge per small-pool size class; empty (and thus skipped) with the
+    // default allocator.
+    auto pool_size_label = sm::label("size");
+    std::vector<sm::metric_definition> pool_metrics;
+    for (auto& e : memory::live_objects_histogram()) {
+        pool_metrics.emplace_back(
+                sm::make_gauge("pool_live_objects", [size = e.object_size] { return memory::live_objects_in_pool(size); },
+                        sm::description("Number of live objects in the small pool of this object size"),
+                        {pool_size_label(e.object_size)}));
+    }
+    if (!pool_metrics.empty()) {
+        _metric_groups.add_group("memory", std::move(pool_metrics));
+    }
+
     _metric_groups.add_group("reactor", {
             sm::make_counter("logging_failures", [] { return logging_failures; }, sm::description("Total number of logging failures")),
             // total_operations value:DERIVE:0:U
@@ -2545,16 +3007,25 @@ void reactor::register_metrics() {
 }
 
 void reactor::run_tasks(task_queue& tq) {
-    // Make sure new tasks will inherit our scheduling group
-    *internal::current_scheduling_group_ptr() = scheduling_group(tq._id);
     auto& tasks = tq._q;
     while (!tasks.empty()) {
+        // Make sure new tasks will inherit our scheduling group. Reloaded
+        // per task (a cheap thread-local store) because a task may change
+        // the thread-local group - migrate_to_scheduling_group() - and
+        // that must not leak into the rest of the batch.
+        *internal::current_scheduling_group_ptr() = scheduling_group(tq._id);
         auto tsk = tasks.front();
         tasks.pop_front();
+        if (__builtin_expect(tsk == tq._sampled_task, false)) {
+            tq.account_sojourn();
+        }
         STAP_PROBE(seastar, reactor_run_tasks_single_start);
         internal::task_histogram_add_task(*tsk);
+        _cpu_profiler.maybe_sample(*tsk);
         _current_task = tsk;
+        internal::local_trace_ring().trace(internal::trace_event_type::task_start, uint16_t(tq._id), 0, reinterpret_cast<uintptr_t>(tsk));
         tsk->run_and_dispose();
+        internal::local_trace_ring().trace(internal::trace_event_type::task_end, uint16_t(tq._id), 0, 0);
         _current_task = nullptr;
         STAP_PROBE(seastar, reactor_run_tasks_single_end);
         ++tq._tasks_processed;
@@ -2653,6 +3124,7 @@ class reactor::kernel_submit_work_pollfn final : public simple_pollfn<true> {
     reactor& _r;
 public:
     kernel_submit_work_pollfn(reactor& r) : _r(r) {}
+    virtual const char* name() const override { return "kernel_submit_work"; }
     virtual bool poll() override final {
         return _r._backend->kernel_submit_work();
     }
@@ -2664,6 +3136,7 @@ class reactor::signal_pollfn final : public reactor::pollfn {
     reactor& _r;
 public:
     signal_pollfn(reactor& r) : _r(r) {}
+    virtual const char* name() const override { return "signal"; }
     virtual bool poll() final override {
         return _r._signals.poll_signal();
     }
@@ -2693,6 +3166,7 @@ class reactor::batch_flush_pollfn final : public simple_pollfn<true> {
     reactor& _r;
 public:
     batch_flush_pollfn(reactor& r) : _r(r) {}
+    virtual const char* name() const override { return "batch_flush"; }
     virtual bool poll() final override {
         return _r.flush_tcp_batches();
     }
@@ -2702,6 +3176,7 @@ class reactor::reap_kernel_completions_pollfn final : public reactor::pollfn {
     reactor& _r;
 public:
     reap_kernel_completions_pollfn(reactor& r) : _r(r) {}
+    virtual const char* name() const override { return "reap_kernel_completions"; }
     virtual bool poll() final override {
         return _r.reap_kernel_completions();
     }
@@ -2724,6 +3199,7 @@ class reactor::io_queue_submission_pollfn final : public reactor::pollfn {
     bool _armed = false;
 public:
     io_queue_submission_pollfn(reactor& r) : _r(r) {}
+    virtual const char* name() const override { return "io_queue_submission"; }
     virtual bool poll() final override {
         return _r.flush_pending_aio();
     }
@@ -2755,6 +3231,7 @@ public:
 // We'll take care of those items when we wake up for another reason.
 class reactor::drain_cross_cpu_freelist_pollfn final : public simple_pollfn<true> {
 public:
+    virtual const char* name() const override { return "drain_cross_cpu_freelist"; }
     virtual bool poll() final override {
         return memory::drain_cross_cpu_freelist();
     }
@@ -2769,6 +3246,7 @@ class reactor::lowres_timer_pollfn final : public reactor::pollfn {
     bool _armed = false;
 public:
     lowres_timer_pollfn(reactor& r) : _r(r) {}
+    virtual const char* name() const override { return "lowres_timer"; }
     virtual bool poll() final override {
         return _r.do_expire_lowres_timers();
     }
@@ -2803,6 +3281,7 @@ class reactor::smp_pollfn final : public reactor::pollfn {
     reactor& _r;
 public:
     smp_pollfn(reactor& r) : _r(r) {}
+    virtual const char* name() const override { return "smp"; }
     virtual bool poll() final override {
         // Avoid short-circuiting with `||` since there are side effects
         // we want to take place (instantiating tasks from the alien queue).
@@ -2823,6 +3302,9 @@ public:
             _r._sleeping.store(false, std::memory_order_relaxed);
             return false;
         }
+        // requests deferred by the adaptive flush policy must not wait
+        // out a sleep; push them out before committing to one
+        smp::flush_request_batches();
         if (poll()) {
             // raced
             _r._sleeping.store(false, std::memory_order_relaxed);
@@ -2840,6 +3322,7 @@ class reactor::execution_stage_pollfn final : public reactor::pollfn {
 public:
     execution_stage_pollfn() : _esm(internal::execution_stage_manager::get()) { }
 
+    virtual const char* name() const override { return "execution_stage"; }
     virtual bool poll() override {
         return _esm.flush();
     }
@@ -2858,6 +3341,7 @@ class reactor::syscall_pollfn final : public reactor::pollfn {
     reactor& _r;
 public:
     syscall_pollfn(reactor& r) : _r(r) {}
+    virtual const char* name() const override { return "syscall"; }
     virtual bool poll() final override {
         return _r._thread_pool->complete();
     }
@@ -2956,6 +3440,7 @@ void reactor::add_task(task* t) noexcept {
     auto* q = _task_queues[sg._id].get();
     bool was_empty = q->_q.empty();
     q->_q.push_back(std::move(t));
+    q->sample_enqueue(t);
     shuffle(q->_q.back(), q->_q);
     if (was_empty) {
         activate(*q);
@@ -3008,10 +3493,12 @@ reactor::run_some_tasks() {
     lowres_clock::update();
 
     sched_clock::time_point t_run_completed = now();
+    internal::hw_counter_sample c_run_completed = _hw_counters.sample();
     STAP_PROBE(seastar, reactor_run_tasks_start);
     _cpu_stall_detector->start_task_run(t_run_completed);
     do {
         auto t_run_started = t_run_completed;
+        auto c_run_started = c_run_completed;
         insert_activating_task_queues();
         task_queue* tq = pop_active_task_queue(t_run_started);
         sched_print("running tq {} {}", (void*)tq, tq->_name);
@@ -3020,11 +3507,24 @@ reactor::run_some_tasks() {
         run_tasks(*tq);
         tq->_current = false;
         t_run_completed = now();
+        c_run_completed = _hw_counters.sample();
         auto delta = t_run_completed - t_run_started;
         account_runtime(*tq, delta);
+        account_hw_counters(*tq, c_run_started, c_run_completed);
         sched_print("run complete ({} {}); time consumed {} usec; final vruntime {} empty {}",
                 (void*)tq, tq->_name, delta / 1us, tq->_vruntime, tq->_q.empty());
         tq->_ts = t_run_completed;
+        if (tq->_cap_quota != sched_clock::duration{}) {
+            if (t_run_completed - tq->_cap_window_start >= task_queue::cap_window) {
+                tq->_cap_window_start = t_run_completed;
+                tq->_cap_consumed = {};
+            }
+            tq->_cap_consumed += delta;
+            if (tq->_cap_consumed >= tq->_cap_quota) {
+                throttle(*tq);
+                continue;
+            }
+        }
         if (!tq->_q.empty()) {
             insert_active_task_queue(tq);
         } else {
@@ -3039,7 +3539,7 @@ reactor::run_some_tasks() {
 
 void
 reactor::activate(task_queue& tq) {
-    if (tq._active) {
+    if (tq._active || tq._throttled) {
         return;
     }
     sched_print("activating {} {}", (void*)&tq, tq._name);
@@ -3059,6 +3559,62 @@ reactor::activate(task_queue& tq) {
     _activating_task_queues.push_back(&tq);
 }
 
+void
+reactor::throttle(task_queue& tq) noexcept {
+    sched_print("throttling {} {}: consumed {} usec of {} usec cap quota", (void*)&tq, tq._name,
+            tq._cap_consumed / 1us, tq._cap_quota / 1us);
+    tq._active = false;
+    tq._throttled = true;
+    _throttled_task_queues.push_back(&tq);
+    if (!_cpu_cap_release_timer.armed()) {
+        auto release = tq._cap_window_start + task_queue::cap_window;
+        _cpu_cap_release_timer.arm(std::chrono::duration_cast<lowres_clock::duration>(release - now()));
+    }
+}
+
+void
+reactor::release_throttled_queues() noexcept {
+    auto now = reactor::now();
+    auto next = sched_clock::duration::max();
+    auto it = _throttled_task_queues.begin();
+    while (it != _throttled_task_queues.end()) {
+        auto* tq = *it;
+        auto release = tq->_cap_window_start + task_queue::cap_window;
+        if (release <= now) {
+            it = _throttled_task_queues.erase(it);
+            tq->_cap_window_start = now;
+            tq->_cap_consumed = {};
+            tq->_throttled = false;
+            sched_print("unthrottling {} {}", (void*)tq, tq->_name);
+            if (!tq->_q.empty()) {
+                activate(*tq);
+            }
+        } else {
+            next = std::min(next, release - now);
+            ++it;
+        }
+    }
+    if (next != sched_clock::duration::max()) {
+        _cpu_cap_release_timer.arm(std::chrono::duration_cast<lowres_clock::duration>(next));
+    }
+}
+
+void
+reactor::update_cpu_cap(task_queue& tq, float utilization) noexcept {
+    if (utilization > 0) {
+        tq._cap_quota = std::chrono::duration_cast<sched_clock::duration>(std::min(utilization, 1.0f) * task_queue::cap_window);
+    } else {
+        tq._cap_quota = {};
+        if (tq._throttled) {
+            std::erase(_throttled_task_queues, &tq);
+            tq._throttled = false;
+            if (!tq._q.empty()) {
+                activate(tq);
+            }
+        }
+    }
+}
+
 void reactor::service_highres_timer() noexcept {
     complete_timers(_timers, _expired_timers, [this] () noexcept {
         if (!_timers.empty()) {
@@ -3067,6 +3623,42 @@ void reactor::service_highres_timer() noexcept {
     });
 }
 
+#if defined(__x86_64__) || defined(__i386__)
+
+static bool detect_waitpkg() {
+    unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+    // CPUID.(EAX=7,ECX=0):ECX.WAITPKG[bit 5], Tremont / Ice Lake and later
+    return __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ecx & (1 << 5));
+}
+
+static const bool have_tpause = detect_waitpkg();
+
+// Pause until the TSC reaches the deadline or an interrupt arrives,
+// with the core in the light C0.2 sleep state. Encoded by hand since
+// the intrinsic needs -mwaitpkg, which we can't assume for the whole
+// translation unit.
+static inline void tpause(uint64_t tsc_deadline) {
+    uint32_t lo = tsc_deadline;
+    uint32_t hi = tsc_deadline >> 32;
+    uint32_t power_state = 0; // C0.2: deeper savings, sub-microsecond wakeup
+    asm volatile(".byte 0x66, 0x0f, 0xae, 0xf1" :: "c"(power_state), "d"(hi), "a"(lo));
+}
+
+#endif
+
+// One step of the reactor's pre-sleep spin loop: a timed hardware pause
+// when the CPU has one, a plain pause otherwise.
+static inline void idle_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    if (have_tpause) {
+        constexpr uint64_t spin_step_cycles = 2000; // ~1us at contemporary clocks
+        tpause(__builtin_ia32_rdtsc() + spin_step_cycles);
+        return;
+    }
+#endif
+    internal::cpu_relax();
+}
+
 int reactor::run() noexcept {
     try {
         return do_run();
@@ -3148,10 +3740,14 @@ int reactor::do_run() {
     poller sig_poller(std::make_unique<signal_pollfn>(*this));
 
     using namespace std::chrono_literals;
+
+    itimerspec task_quote_itimerspec = seastar::posix::to_relative_itimerspec(_task_quota, _task_quota);
+    _task_quota_timer.timerfd_settime(0, task_quote_itimerspec);
+
     timer<lowres_clock> load_timer;
     auto last_idle = _total_idle;
     auto idle_start = now(), idle_end = idle_start;
-    load_timer.set_callback([this, &last_idle, &idle_start, &idle_end] () mutable {
+    load_timer.set_callback([this, &last_idle, &idle_start, &idle_end, &task_quote_itimerspec] () mutable {
         _total_idle += idle_end - idle_start;
         auto load = double((_total_idle - last_idle).count()) / double(std::chrono::duration_cast<sched_clock::duration>(1s).count());
         last_idle = _total_idle;
@@ -3164,13 +3760,25 @@ int reactor::do_run() {
             _load -= (drop/5);
         }
         _load += (load/5);
+        auto old_quota = _task_quota;
+        if (_pending_runtime_tunables) {
+            auto snap = std::exchange(_pending_runtime_tunables, nullptr);
+            apply_runtime_tunables(*snap);
+            _runtime_tunables = std::move(snap);
+        }
+        if (_task_quota_adaptive) {
+            adjust_task_quota();
+        }
+        if (_task_quota != old_quota) {
+            task_quote_itimerspec = seastar::posix::to_relative_itimerspec(_task_quota, _task_quota);
+            _task_quota_timer.timerfd_settime(0, task_quote_itimerspec);
+        }
+        if (_id == 0 && internal::heartbeat_header) {
+            internal::calibrate_shard_heartbeats();
+        }
     });
     load_timer.arm_periodic(1s);
 
-    itimerspec its = seastar::posix::to_relative_itimerspec(_task_quota, _task_quota);
-    _task_quota_timer.timerfd_settime(0, its);
-    auto& task_quote_itimerspec = its;
-
     struct sigaction sa_block_notifier = {};
     sa_block_notifier.sa_handler = &reactor::block_notifier;
     sa_block_notifier.sa_flags = SA_RESTART;
@@ -3205,12 +3813,19 @@ int reactor::do_run() {
         }
 
         _polls++;
+        if (internal::heartbeat_slots) {
+            internal::heartbeat_slots[_id].last_poll_tsc.store(internal::read_cycle_counter(), std::memory_order_relaxed);
+        }
 
         lowres_clock::update(); // Don't delay expiring lowres timers
         if (check_for_work()) {
             if (idle) {
-                _total_idle += idle_end - idle_start;
-                account_idle(idle_end - idle_start);
+                auto gap = idle_end - idle_start;
+                _total_idle += gap;
+                account_idle(gap);
+                // Teach the spin/sleep governor how long this idle period
+                // lasted (including any sleep).
+                _smoothed_idle_gap = (7 * _smoothed_idle_gap + gap) / 8;
                 idle_start = idle_end;
                 idle = false;
             }
@@ -3231,14 +3846,16 @@ int reactor::do_run() {
                 report_exception("Exception while running idle cpu handler", std::current_exception());
             }
             if (go_to_sleep) {
-                internal::cpu_relax();
-                if (idle_end - idle_start > _max_poll_time) {
+                idle_relax();
+                if (idle_end - idle_start > effective_max_poll_time()) {
                     // Turn off the task quota timer to avoid spurious wakeups
                     struct itimerspec zero_itimerspec = {};
                     _task_quota_timer.timerfd_settime(0, zero_itimerspec);
                     auto start_sleep = now();
                     _cpu_stall_detector->start_sleep();
+                    internal::local_trace_ring().trace(internal::trace_event_type::sleep_enter, 0, 0, 0);
                     sleep();
+                    internal::local_trace_ring().trace(internal::trace_event_type::sleep_exit, 0, 0, 0);
                     _cpu_stall_detector->end_sleep();
                     // We may have slept for a while, so freshen idle_end
                     idle_end = now();
@@ -3262,11 +3879,16 @@ int reactor::do_run() {
 
 void
 reactor::sleep() {
+    // Never park with combined writes staged in the sink; release them
+    // and let the submission poller pick them up before we try again.
+    if (_io_sink.flush_held()) {
+        return;
+    }
     for (auto i = _pollers.begin(); i != _pollers.end(); ++i) {
-        auto ok = (*i)->try_enter_interrupt_mode();
+        auto ok = i->fn->try_enter_interrupt_mode();
         if (!ok) {
             while (i != _pollers.begin()) {
-                (*--i)->exit_interrupt_mode();
+                (--i)->fn->exit_interrupt_mode();
             }
             return;
         }
@@ -3275,15 +3897,35 @@ reactor::sleep() {
     _backend->wait_and_process_events(&_active_sigmask);
 
     for (auto i = _pollers.rbegin(); i != _pollers.rend(); ++i) {
-        (*i)->exit_interrupt_mode();
+        i->fn->exit_interrupt_mode();
+        // Something woke us up, so re-check every poller promptly; event
+        // sources may have become active while we were away.
+        i->backoff = 1;
+        i->countdown = 0;
     }
 }
 
 bool
 reactor::poll_once() {
     bool work = false;
-    for (auto c : _pollers) {
-        work |= c->poll();
+    for (auto& c : _pollers) {
+        if (c.countdown) {
+            --c.countdown;
+            continue;
+        }
+        ++c.polls;
+        if (c.fn->poll()) {
+            ++c.work;
+            c.backoff = 1;
+            work = true;
+        } else if (c.backoff < c.max_backoff) {
+            // Demote pollers that keep finding nothing; going to sleep
+            // still checks all of them via pure_poll_once(), so no event
+            // is lost, only delayed by up to max_backoff - 1 iterations
+            // while the reactor is busy.
+            c.backoff *= 2;
+        }
+        c.countdown = c.backoff - 1;
     }
 
     return work;
@@ -3291,8 +3933,8 @@ reactor::poll_once() {
 
 bool
 reactor::pure_poll_once() {
-    for (auto c : _pollers) {
-        if (c->pure_poll()) {
+    for (auto& c : _pollers) {
+        if (c.fn->pure_poll()) {
             return true;
         }
     }
@@ -3336,16 +3978,66 @@ public:
 
 }
 
+uint64_t reactor::poller_stat(pollfn* p, uint64_t poller_entry::*stat) const {
+    auto i = std::find_if(_pollers.begin(), _pollers.end(), [p] (const poller_entry& e) { return e.fn == p; });
+    return i == _pollers.end() ? 0 : (*i).*stat;
+}
+
+// The backoff limit a poller gets on this shard. On a profiled shard
+// the pollers serving the shard's role stay at the highest polling
+// frequency while the opposite role's pollers may defer further; the
+// classification covers the reactor's built-in pollers by name, and
+// unnamed (application) pollers stay at the default.
+unsigned reactor::poller_backoff_limit(const pollfn* p) const {
+    auto name = p->name();
+    if (!name || _cfg.profile == poller_profile::balanced) {
+        return max_poller_backoff;
+    }
+    static constexpr std::string_view network_pollers[] = { "smp", "batch_flush" };
+    static constexpr std::string_view storage_pollers[] = { "kernel_submit_work", "reap_kernel_completions", "io_queue_submission" };
+    auto matches = [name] (const auto& set) {
+        return std::find(std::begin(set), std::end(set), std::string_view(name)) != std::end(set);
+    };
+    auto network = _cfg.profile == poller_profile::network;
+    if (network ? matches(network_pollers) : matches(storage_pollers)) {
+        return 1; // polled on every loop iteration
+    }
+    if (network ? matches(storage_pollers) : matches(network_pollers)) {
+        return max_deferred_poller_backoff;
+    }
+    return max_poller_backoff;
+}
+
 void reactor::register_poller(pollfn* p) {
-    _pollers.push_back(p);
+    // Two instances of the same poller class (e.g. reap_kernel_completions)
+    // may coexist; only the first one exports metrics under its name.
+    auto duplicate_name = p->name() && std::any_of(_pollers.begin(), _pollers.end(), [p] (const poller_entry& e) {
+        return e.fn->name() && std::string_view(e.fn->name()) == p->name();
+    });
+    _pollers.emplace_back(p);
+    _pollers.back().max_backoff = poller_backoff_limit(p);
+    if (auto name = duplicate_name ? nullptr : p->name()) {
+        namespace sm = seastar::metrics;
+        auto poller_label = sm::label("poller");
+        _pollers.back().metric_groups.add_group("reactor", {
+                sm::make_counter("poller_polls", [this, p] { return poller_stat(p, &poller_entry::polls); },
+                        sm::description("Number of times the poller was checked for work"), {poller_label(name)}),
+                sm::make_counter("poller_work", [this, p] { return poller_stat(p, &poller_entry::work); },
+                        sm::description("Number of times the poller was checked and found work to do"), {poller_label(name)}),
+        });
+    }
 }
 
 void reactor::unregister_poller(pollfn* p) {
-    _pollers.erase(std::find(_pollers.begin(), _pollers.end(), p));
+    _pollers.erase(std::find_if(_pollers.begin(), _pollers.end(), [p] (const poller_entry& e) { return e.fn == p; }));
 }
 
 void reactor::replace_poller(pollfn* old, pollfn* neww) {
-    std::replace(_pollers.begin(), _pollers.end(), old, neww);
+    for (auto& e : _pollers) {
+        if (e.fn == old) {
+            e.fn = neww;
+        }
+    }
 }
 
 namespace internal {
@@ -3440,10 +4132,12 @@ unsigned syscall_work_queue::complete() {
 }
 
 
-smp_message_queue::smp_message_queue(reactor* from, reactor* to)
+smp_message_queue::smp_message_queue(reactor* from, reactor* to, bool cross_numa_node)
     : _pending(to)
     , _completed(from)
+    , _batch_size(cross_numa_node ? cross_node_batch_size : batch_size)
 {
+    _flush_batch = _batch_size;
 }
 
 smp_message_queue::~smp_message_queue()
@@ -3470,6 +4164,20 @@ void smp_message_queue::move_pending() {
     _current_queue_length += nr;
     _last_snt_batch = nr;
     _sent += nr;
+    // Tune the batch target from what this flush achieved: grow while
+    // batches fill up (a fast producer amortizes better with larger
+    // ones), fall back once deadline-driven flushes no longer do.
+    if (size_t(nr) >= _flush_batch) {
+        _flush_batch = std::min({_flush_batch * 2, _batch_size * 4, queue_length});
+    } else {
+        _flush_batch = std::max(_flush_batch / 2, min_flush_batch);
+    }
+    if (!_rtt_sample_start_tsc) {
+        // time this batch's round trip; the sample completes in
+        // process_completions()
+        _rtt_sample_start_tsc = internal::read_cycle_counter();
+        _rtt_sample_target = _sent;
+    }
 }
 
 bool smp_message_queue::pure_poll_tx() const {
@@ -3478,6 +4186,49 @@ bool smp_message_queue::pure_poll_tx() const {
     return !const_cast<lf_queue&>(_completed).empty();
 }
 
+smp_message_queue::work_item_slot_list::~work_item_slot_list() {
+    while (head) {
+        auto* next = head->next;
+        ::operator delete(head);
+        head = next;
+    }
+}
+
+smp_message_queue::work_item_slot_list&
+smp_message_queue::free_work_item_slots() noexcept {
+    static thread_local work_item_slot_list list;
+    return list;
+}
+
+void* smp_message_queue::alloc_work_item(size_t size) {
+    if (size > work_item_slot_size) {
+        return ::operator new(size);
+    }
+    auto& free_list = free_work_item_slots();
+    if (auto* slot = free_list.head) {
+        free_list.head = slot->next;
+        --free_list.count;
+        return slot;
+    }
+    return ::operator new(sizeof(work_item_slot));
+}
+
+void smp_message_queue::free_work_item(void* p, size_t size) noexcept {
+    if (size > work_item_slot_size) {
+        ::operator delete(p);
+        return;
+    }
+    auto& free_list = free_work_item_slots();
+    if (free_list.count >= max_free_work_item_slots) {
+        ::operator delete(p);
+        return;
+    }
+    auto* slot = static_cast<work_item_slot*>(p);
+    slot->next = free_list.head;
+    free_list.head = slot;
+    ++free_list.count;
+}
+
 void smp_message_queue::submit_item(shard_id t, smp_timeout_clock::time_point timeout, std::unique_ptr<smp_message_queue::work_item> item) {
   // matching signal() in process_completions()
   auto ssg_id = internal::smp_service_group_id(item->ssg);
@@ -3494,7 +4245,10 @@ void smp_message_queue::submit_item(shard_id t, smp_timeout_clock::time_point ti
     // no exceptions from this point
     item.release();
     units_fut.get0().release();
-    if (_tx.a.pending_fifo.size() >= batch_size) {
+    if (_tx.a.pending_fifo.size() == 1) {
+        _first_pending_tsc = internal::read_cycle_counter();
+    }
+    if (_tx.a.pending_fifo.size() >= _flush_batch) {
         move_pending();
     }
   });
@@ -3502,7 +4256,7 @@ void smp_message_queue::submit_item(shard_id t, smp_timeout_clock::time_point ti
 
 void smp_message_queue::respond(work_item* item) {
     _completed_fifo.push_back(item);
-    if (_completed_fifo.size() >= batch_size || engine()._stopped) {
+    if (_completed_fifo.size() >= _batch_size || engine()._stopped) {
         flush_response_batch();
     }
 }
@@ -3587,11 +4341,31 @@ size_t smp_message_queue::process_completions(shard_id t) {
     _current_queue_length -= nr;
     _compl += nr;
     _last_cmpl_batch = nr;
+    if (_rtt_sample_start_tsc && _compl >= _rtt_sample_target) {
+        auto rtt = internal::read_cycle_counter() - _rtt_sample_start_tsc;
+        _rtt_sample_start_tsc = 0;
+        _round_trip_cycles = _round_trip_cycles ? (7 * _round_trip_cycles + rtt) / 8 : rtt;
+        // Waiting longer than a fraction of the round trip would cost
+        // more latency than the batching saves.
+        _flush_deadline = _round_trip_cycles / 4;
+    }
 
     return nr;
 }
 
 void smp_message_queue::flush_request_batch() {
+    if (_tx.a.pending_fifo.empty()) {
+        return;
+    }
+    if (_tx.a.pending_fifo.size() < _flush_batch
+            && internal::read_cycle_counter() - _first_pending_tsc < _flush_deadline) {
+        // not enough accumulated yet; the deadline bounds the wait
+        return;
+    }
+    move_pending();
+}
+
+void smp_message_queue::force_flush_request_batch() {
     if (!_tx.a.pending_fifo.empty()) {
         move_pending();
     }
@@ -3723,8 +4497,18 @@ reactor_options::reactor_options(program_options::option_group* parent_group)
     , poll_aio(*this, "poll-aio", true,
                 "busy-poll for disk I/O (reduces latency and increases throughput)")
     , task_quota_ms(*this, "task-quota-ms", 0.5, "Max time (ms) between polls")
+    , task_quota_adaptive(*this, "task-quota-adaptive", false,
+                "Shrink the task quota automatically while tasks overrun it, and grow it back"
+                " towards --task-quota-ms when they stop; improves scheduling latency under"
+                " mixed batch/interactive load")
     , io_latency_goal_ms(*this, "io-latency-goal-ms", {}, "Max time (ms) io operations must take (1.5 * task-quota-ms if not set)")
     , max_task_backlog(*this, "max-task-backlog", 1000, "Maximum number of task backlog to allow; above this we ignore I/O")
+    , timer_coalescing_us(*this, "timer-coalescing-us", 0,
+                "deliver high-resolution timers expiring within this many microseconds of each other"
+                " in one batch, trading that much timer precision for fewer wakeups")
+    , io_combine_deadline_us(*this, "io-combine-deadline-us", 0,
+                "hold small all-write batches in the I/O submission sink for up to this many microseconds"
+                " to build larger kernel submissions; reads are never delayed (default: submit immediately)")
     , blocked_reactor_notify_ms(*this, "blocked-reactor-notify-ms", 25, "threshold in miliseconds over which the reactor is considered blocked if no progress is made")
     , blocked_reactor_reports_per_minute(*this, "blocked-reactor-reports-per-minute", 5, "Maximum number of backtraces reported by stall detector per minute")
     , blocked_reactor_report_format_oneline(*this, "blocked-reactor-report-format-oneline", true, "Print a simplified backtrace on a single line")
@@ -3749,13 +4533,22 @@ reactor_options::reactor_options(program_options::option_group* parent_group)
                 format("Internal reactor implementation ({})", reactor_backend_selector::available()))
     , aio_fsync(*this, "aio-fsync", kernel_supports_aio_fsync(),
                 "Use Linux aio for fsync() calls. This reduces latency; requires Linux 4.18 or later.")
+    , io_uring_sqpoll(*this, "io-uring-sqpoll", false,
+                "Use a kernel thread to poll the io_uring submission queue (SQPOLL), eliminating the system call"
+                " on the I/O submission path at the cost of a busy-polling kernel thread per shard."
+                " Only valid for the io_uring reactor backend (see --reactor-backend).")
     , max_networking_io_control_blocks(*this, "max-networking-io-control-blocks", 10000,
                 "Maximum number of I/O control blocks (IOCBs) to allocate per shard. This translates to the number of sockets supported per shard."
                 " Requires tuning /proc/sys/fs/aio-max-nr. Only valid for the linux-aio reactor backend (see --reactor-backend).")
 #ifdef SEASTAR_HEAPPROF
     , heapprof(*this, "heapprof", "enable seastar heap profiling")
+    , heapprof_sample_rate(*this, "heapprof-sample-rate", 0,
+                "Enable sampled seastar heap profiling, recording the allocation site of every Nth allocation."
+                " Rates of a few thousand keep the overhead low enough for always-on production use."
+                " 0 disables sampling; --heapprof records every allocation regardless of this option.")
 #else
     , heapprof(*this, "heapprof", program_options::unused{})
+    , heapprof_sample_rate(*this, "heapprof-sample-rate", program_options::unused{})
 #endif
     , no_handle_interrupt(*this, "no-handle-interrupt", "ignore SIGINT (for gdb)")
 {
@@ -3788,6 +4581,7 @@ smp_options::smp_options(program_options::option_group* parent_group)
 #else
     , allow_cpus_in_remote_numa_nodes(*this, "allow-cpus-in-remote-numa-nodes", program_options::unused{})
 #endif
+    , poller_profiles(*this, "poller-profiles", {}, "per-shard poller priority profiles, as comma-separated <shard-range>:<profile> entries with profile being network or storage, e.g. 0-3:network,4-7:storage (default: balanced polling on all shards)")
 {
 }
 
@@ -3814,6 +4608,7 @@ thread_local std::unique_ptr<reactor, reactor_deleter> reactor_holder;
 
 thread_local smp_message_queue** smp::_qs;
 thread_local std::thread::id smp::_tmain;
+std::vector<unsigned> smp::_numa_node_ids;
 unsigned smp::count = 0;
 
 void smp::start_all_queues()
@@ -4045,6 +4840,7 @@ public:
         struct io_queue::config cfg;
 
         cfg.devid = devid;
+        cfg.nr_groups = nr_groups;
 
         if (p.read_bytes_rate != std::numeric_limits<uint64_t>::max()) {
             cfg.blocks_count_rate = (io_queue::read_request_base_count * (unsigned long)per_io_group(p.read_bytes_rate, nr_groups)) >> io_queue::block_size_shift;
@@ -4063,6 +4859,7 @@ public:
         cfg.mountpoint = p.mountpoint;
         cfg.duplex = p.duplex;
         cfg.rate_factor = p.rate_factor;
+        cfg.max_merge_length = p.max_merge_length;
         cfg.rate_limit_duration = latency_goal();
         // Block count limit should not be less than the minimal IO size on the device
         // On the other hand, even this is not good enough -- in the worst case the
@@ -4104,6 +4901,47 @@ unsigned smp::adjust_max_networking_aio_io_control_blocks(unsigned network_iocbs
     return network_iocbs;
 }
 
+// Parses the smp_options::poller_profiles format: comma-separated
+// "<shard-range>:<profile>" entries, e.g. "0-3:network,4:storage".
+// Unlisted shards stay balanced; shards beyond count are ignored.
+static std::vector<poller_profile>
+parse_poller_profiles(const std::string& spec, unsigned count) {
+    std::vector<poller_profile> profiles(count, poller_profile::balanced);
+    std::istringstream entries(spec);
+    std::string entry;
+    while (std::getline(entries, entry, ',')) {
+        auto colon = entry.find(':');
+        if (colon == std::string::npos) {
+            throw std::runtime_error(format("Invalid poller profile entry \"{}\": expected <shard-range>:<profile>", entry));
+        }
+        auto range = entry.substr(0, colon);
+        auto name = entry.substr(colon + 1);
+        poller_profile profile;
+        if (name == "network") {
+            profile = poller_profile::network;
+        } else if (name == "storage") {
+            profile = poller_profile::storage;
+        } else {
+            throw std::runtime_error(format("Invalid poller profile \"{}\": expected network or storage", name));
+        }
+        unsigned first, last;
+        auto dash = range.find('-');
+        try {
+            first = std::stoul(range.substr(0, dash));
+            last = dash == std::string::npos ? first : std::stoul(range.substr(dash + 1));
+        } catch (...) {
+            throw std::runtime_error(format("Invalid poller profile shard range \"{}\"", range));
+        }
+        if (first > last) {
+            throw std::runtime_error(format("Invalid poller profile shard range \"{}\"", range));
+        }
+        for (auto shard = first; shard <= last && shard < count; shard++) {
+            profiles[shard] = profile;
+        }
+    }
+    return profiles;
+}
+
 void smp::configure(const smp_options& smp_opts, const reactor_options& reactor_opts)
 {
 #ifndef SEASTAR_NO_EXCEPTION_HACK
@@ -4275,14 +5113,16 @@ void smp::configure(const smp_options& smp_opts, const reactor_options& reactor_
     reactor_config reactor_cfg;
     reactor_cfg.auto_handle_sigint_sigterm = reactor_opts._auto_handle_sigint_sigterm;
     reactor_cfg.max_networking_aio_io_control_blocks = adjust_max_networking_aio_io_control_blocks(reactor_opts.max_networking_io_control_blocks.get_value());
+    reactor_cfg.force_io_uring_sqpoll = reactor_opts.io_uring_sqpoll.get_value();
+    auto shard_profiles = parse_poller_profiles(smp_opts.poller_profiles ? smp_opts.poller_profiles.get_value() : std::string(), smp::count);
 
 #ifdef SEASTAR_HEAPPROF
-    bool heapprof_enabled = reactor_opts.heapprof;
-    if (heapprof_enabled) {
-        memory::set_heap_profiling_enabled(heapprof_enabled);
+    unsigned heapprof_sampling = reactor_opts.heapprof ? 1 : reactor_opts.heapprof_sample_rate.get_value();
+    if (heapprof_sampling) {
+        memory::set_heap_profiling_sampling_rate(heapprof_sampling);
     }
 #else
-    bool heapprof_enabled = false;
+    unsigned heapprof_sampling = 0;
 #endif
 
 #ifdef SEASTAR_HAVE_DPDK
@@ -4298,6 +5138,7 @@ void smp::configure(const smp_options& smp_opts, const reactor_options& reactor_
     // Better to put it into the smp class, but at smp construction time
     // correct smp::count is not known.
     boost::barrier reactors_registered(smp::count);
+    boost::barrier smp_queues_allocated(smp::count);
     boost::barrier smp_queues_constructed(smp::count);
     // We use shared_ptr since this thread can exit while other threads are still unlocking
     auto inited = std::make_shared<boost::barrier>(smp::count);
@@ -4326,7 +5167,16 @@ void smp::configure(const smp_options& smp_opts, const reactor_options& reactor_
                 auto& iog = io_info.groups[group_idx];
                 if (!iog) {
                     struct io_queue::config qcfg = disk_config.generate_config(topo.first, io_info.groups.size());
-                    iog = std::make_shared<io_group>(std::move(qcfg));
+                    // the first group of the device owns the spare capacity
+                    // pools, the rest share them to borrow unused budget
+                    const io_group* peer = nullptr;
+                    for (auto& g : io_info.groups) {
+                        if (g) {
+                            peer = g.get();
+                            break;
+                        }
+                    }
+                    iog = std::make_shared<io_group>(std::move(qcfg), peer);
                     seastar_logger.debug("allocate {} IO group", group_idx);
                 }
                 group = iog;
@@ -4354,6 +5204,8 @@ void smp::configure(const smp_options& smp_opts, const reactor_options& reactor_
 
     _all_event_loops_done.emplace(smp::count);
 
+    internal::setup_shard_heartbeats(smp::count);
+
     auto backend_selector = reactor_opts.reactor_backend.get_selected_candidate();
     seastar_logger.info("Reactor backend: {}", backend_selector);
 
@@ -4361,7 +5213,7 @@ void smp::configure(const smp_options& smp_opts, const reactor_options& reactor_
     auto smp_tmain = smp::_tmain;
     for (i = 1; i < smp::count; i++) {
         auto allocation = allocations[i];
-        create_thread([this, smp_tmain, inited, &reactors_registered, &smp_queues_constructed, &smp_opts, &reactor_opts, &reactors, hugepages_path, i, allocation, assign_io_queues, alloc_io_queues, thread_affinity, heapprof_enabled, mbind, backend_selector, reactor_cfg] {
+        create_thread([this, smp_tmain, inited, &reactors_registered, &smp_queues_allocated, &smp_queues_constructed, &smp_opts, &reactor_opts, &reactors, hugepages_path, i, allocation, assign_io_queues, alloc_io_queues, thread_affinity, heapprof_sampling, mbind, backend_selector, reactor_cfg, shard_profiles] {
           try {
             // initialize thread_locals that are equal across all reacto threads of this smp instance
             smp::_tmain = smp_tmain;
@@ -4373,8 +5225,8 @@ void smp::configure(const smp_options& smp_opts, const reactor_options& reactor_
             if (smp_opts.memory_allocator == memory_allocator::seastar) {
                 memory::configure(allocation.mem, mbind, hugepages_path);
             }
-            if (heapprof_enabled) {
-                memory::set_heap_profiling_enabled(heapprof_enabled);
+            if (heapprof_sampling) {
+                memory::set_heap_profiling_sampling_rate(heapprof_sampling);
             }
             sigset_t mask;
             sigfillset(&mask);
@@ -4385,13 +5237,22 @@ void smp::configure(const smp_options& smp_opts, const reactor_options& reactor_
             throw_pthread_error(r);
             init_default_smp_service_group(i);
             lowres_clock::update();
-            allocate_reactor(i, backend_selector, reactor_cfg);
+            auto cfg = reactor_cfg;
+            cfg.profile = shard_profiles[i];
+            allocate_reactor(i, backend_selector, cfg);
             reactors[i] = &engine();
             alloc_io_queues(i);
             reactors_registered.wait();
-            smp_queues_constructed.wait();
+            smp_queues_allocated.wait();
             // _qs_owner is only initialized here
             _qs = _qs_owner.get();
+            // Each shard constructs its own row of queues, so the
+            // construction is parallel and the receive side of every
+            // queue lands in the receiving shard's memory
+            for (unsigned j = 0; j < smp::count; ++j) {
+                new (&_qs[i][j]) smp_message_queue(reactors[j], reactors[i], _numa_node_ids[j] != _numa_node_ids[i]);
+            }
+            smp_queues_constructed.wait();
             start_all_queues();
             assign_io_queues(i);
             inited->wait();
@@ -4407,6 +5268,7 @@ void smp::configure(const smp_options& smp_opts, const reactor_options& reactor_
     init_default_smp_service_group(0);
     lowres_clock::update();
     try {
+        reactor_cfg.profile = shard_profiles[0];
         allocate_reactor(0, backend_selector, reactor_cfg);
     } catch (const std::exception& e) {
         seastar_logger.error(e.what());
@@ -4428,11 +5290,19 @@ void smp::configure(const smp_options& smp_opts, const reactor_options& reactor_
     reactors_registered.wait();
     _qs_owner = decltype(smp::_qs_owner){new smp_message_queue* [smp::count], qs_deleter{}};
     _qs = _qs_owner.get();
+    auto node_of = [&allocations] (unsigned shard) -> unsigned {
+        return allocations[shard].mem.empty() ? 0 : allocations[shard].mem.front().nodeid;
+    };
+    smp::_numa_node_ids.resize(smp::count);
+    for (unsigned i = 0; i < smp::count; i++) {
+        smp::_numa_node_ids[i] = node_of(i);
+    }
     for(unsigned i = 0; i < smp::count; i++) {
         smp::_qs_owner[i] = reinterpret_cast<smp_message_queue*>(operator new[] (sizeof(smp_message_queue) * smp::count));
-        for (unsigned j = 0; j < smp::count; ++j) {
-            new (&smp::_qs_owner[i][j]) smp_message_queue(reactors[j], reactors[i]);
-        }
+    }
+    smp_queues_allocated.wait();
+    for (unsigned j = 0; j < smp::count; ++j) {
+        new (&smp::_qs_owner[0][j]) smp_message_queue(reactors[j], reactors[0], node_of(j) != node_of(0));
     }
     _alien._qs = alien::instance::create_qs(reactors);
     smp_queues_constructed.wait();
@@ -4465,7 +5335,9 @@ bool smp::pure_poll_queues() {
             auto& rxq = _qs[this_shard_id()][i];
             rxq.flush_response_batch();
             auto& txq = _qs[i][this_shard_id()];
-            txq.flush_request_batch();
+            // about to go idle, so nobody will poll the deadline;
+            // push out whatever accumulated
+            txq.force_flush_request_batch();
             if (rxq.pure_poll_rx() || txq.pure_poll_tx() || rxq.has_unflushed_responses()) {
                 return true;
             }
@@ -4474,6 +5346,14 @@ bool smp::pure_poll_queues() {
     return false;
 }
 
+void smp::flush_request_batches() {
+    for (unsigned i = 0; i < count; i++) {
+        if (this_shard_id() != i) {
+            _qs[i][this_shard_id()].force_flush_request_batch();
+        }
+    }
+}
+
 __thread reactor* local_engine;
 
 void report_exception(std::string_view message, std::exception_ptr eptr) noexcept {
@@ -4594,6 +5474,20 @@ reactor::calculate_poll_time() {
     return virtualized() ? 2000us : 200us;
 }
 
+std::chrono::nanoseconds
+reactor::effective_max_poll_time() const noexcept {
+    // Spinning before sleeping only pays off if work is likely to arrive
+    // while we spin. When recent idle periods have been much longer than
+    // the full spin budget, spin just long enough to amortize the cost of
+    // a sleep/wakeup round trip through the kernel; a burst of short gaps
+    // quickly pulls the average back down and restores the full budget.
+    constexpr std::chrono::nanoseconds sleep_wakeup_cost = 5us;
+    if (_smoothed_idle_gap / 4 > _max_poll_time) {
+        return std::min(_max_poll_time, sleep_wakeup_cost);
+    }
+    return _max_poll_time;
+}
+
 future<>
 yield() noexcept {
     memory::scoped_critical_alloc_section _;
@@ -4679,16 +5573,15 @@ deallocate_scheduling_group_id(unsigned id) noexcept {
 void
 reactor::allocate_scheduling_group_specific_data(scheduling_group sg, scheduling_group_key key) {
     auto& sg_data = _scheduling_group_specific_data;
-    auto& this_sg = sg_data.per_scheduling_group_data[sg._id];
-    this_sg.specific_vals.resize(std::max<size_t>(this_sg.specific_vals.size(), key.id()+1));
-    this_sg.specific_vals[key.id()] =
-        aligned_alloc(sg_data.scheduling_group_key_configs[key.id()].alignment,
+    sg_data.ensure_stride(key.id() + 1);
+    void*& val = sg_data.get_specific_val(sg._id, key.id());
+    val = aligned_alloc(sg_data.scheduling_group_key_configs[key.id()].alignment,
                 sg_data.scheduling_group_key_configs[key.id()].allocation_size);
-    if (!this_sg.specific_vals[key.id()]) {
+    if (!val) {
         std::abort();
     }
     if (sg_data.scheduling_group_key_configs[key.id()].constructor) {
-        sg_data.scheduling_group_key_configs[key.id()].constructor(this_sg.specific_vals[key.id()]);
+        sg_data.scheduling_group_key_configs[key.id()].constructor(val);
     }
 }
 
@@ -4696,11 +5589,10 @@ future<>
 reactor::rename_scheduling_group_specific_data(scheduling_group sg) {
     return with_scheduling_group(sg, [this, sg] {
         auto& sg_data = _scheduling_group_specific_data;
-        auto& this_sg = sg_data.per_scheduling_group_data[sg._id];
         for (size_t i = 0; i < sg_data.scheduling_group_key_configs.size(); ++i) {
             auto &c = sg_data.scheduling_group_key_configs[i];
             if (c.rename) {
-                (c.rename)(this_sg.specific_vals[i]);
+                (c.rename)(sg_data.get_specific_val(sg._id, i));
             }
         }
     });
@@ -4745,15 +5637,14 @@ reactor::destroy_scheduling_group(scheduling_group sg) noexcept {
     }
     return with_scheduling_group(sg, [this, sg] () {
         auto& sg_data = _scheduling_group_specific_data;
-        auto& this_sg = sg_data.per_scheduling_group_data[sg._id];
         for (unsigned long key_id = 0; key_id < sg_data.scheduling_group_key_configs.size(); key_id++) {
-            void* val = this_sg.specific_vals[key_id];
+            void*& val = sg_data.get_specific_val(sg._id, key_id);
             if (val) {
                 if (sg_data.scheduling_group_key_configs[key_id].destructor) {
                     sg_data.scheduling_group_key_configs[key_id].destructor(val);
                 }
                 free(val);
-                this_sg.specific_vals[key_id] = nullptr;
+                val = nullptr;
             }
         }
     }).then( [this, sg] () {
@@ -4795,11 +5686,50 @@ scheduling_group::name() const noexcept {
     return engine()._task_queues[_id]->_name;
 }
 
+bool
+scheduling_group::may_run_immediately() const noexcept {
+    if (active()) {
+        return true;
+    }
+    auto& r = engine();
+    auto* tq = _id < r._task_queues.size() ? r._task_queues[_id].get() : nullptr;
+    if (!tq || !tq->_q.empty() || tq->_throttled) {
+        // Running inline would jump ahead of the group's queued tasks,
+        // or sidestep its cpu cap
+        return false;
+    }
+    return !need_preempt();
+}
+
+void
+internal::account_inline_group_run(scheduling_group prev, scheduling_group sg, sched_clock::duration runtime) noexcept {
+    auto& r = engine();
+    auto& to = *r._task_queues[scheduling_group_index(sg)];
+    to._vruntime += to.to_vruntime(runtime);
+    to._runtime += runtime;
+    // run_some_tasks() charges the whole batch, including this inline
+    // run, to the queue that was executing; move the charge to the group
+    // that actually ran
+    auto& from = *r._task_queues[scheduling_group_index(prev)];
+    from._vruntime -= from.to_vruntime(runtime);
+    from._runtime -= runtime;
+}
+
 void
 scheduling_group::set_shares(float shares) noexcept {
     engine()._task_queues[_id]->set_shares(shares);
 }
 
+void
+scheduling_group::set_cpu_cap(float utilization) noexcept {
+    engine().update_cpu_cap(*engine()._task_queues[_id], utilization);
+}
+
+void
+scheduling_group::set_shed_hook(sched_clock::duration threshold, noncopyable_function<void(sched_clock::duration)> hook) noexcept {
+    engine()._task_queues[_id]->set_shed_hook(threshold, std::move(hook));
+}
+
 scheduling_group::stats
 scheduling_group::get_stats() const noexcept {
     const auto * const tq = engine()._task_queues[_id].get();
@@ -4867,6 +5797,28 @@ rename_scheduling_group(scheduling_group sg, sstring new_name) noexcept {
     });
 }
 
+future<>
+migrate_to_scheduling_group(scheduling_group sg) noexcept {
+    if (sg == current_scheduling_group()) {
+        return make_ready_future<>();
+    }
+    if (auto* tctx = thread_impl::get()) {
+        // A seastar::thread is itself the task that gets requeued on
+        // every wakeup, so re-tag the thread and yield through the new
+        // group's task queue; the migration is done when we resume.
+        tctx->migrate_to(sg);
+        return make_ready_future<>();
+    }
+    // Continuations capture the scheduling group current at their
+    // creation, so switching the thread-local group here tags everything
+    // the caller chains after this call with sg. Resolving the returned
+    // future from within sg's queue additionally makes the chain yield,
+    // so the remaining work is dispatched under the new group's shares
+    // rather than riding out the old group's time slice.
+    *internal::current_scheduling_group_ptr() = sg;
+    return internal::schedule_in_group(sg, [] {});
+}
+
 namespace internal {
 
 inline
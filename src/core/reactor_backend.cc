@@ -99,6 +99,8 @@ void prepare_iocb(const io_request& req, io_completion* desc, iocb& iocb) {
 
 aio_storage_context::iocb_pool::iocb_pool() {
     for (unsigned i = 0; i != max_aio; ++i) {
+        // user_data doubles as the allocation mark for find_outstanding()
+        set_user_data(_iocb_pool[i], nullptr);
         _free_iocbs.push(&_iocb_pool[i]);
     }
 }
@@ -136,9 +138,20 @@ aio_storage_context::iocb_pool::get_one() {
 inline
 void
 aio_storage_context::iocb_pool::put_one(internal::linux_abi::iocb* io) {
+    set_user_data(*io, nullptr);
     _free_iocbs.push(io);
 }
 
+internal::linux_abi::iocb*
+aio_storage_context::iocb_pool::find_outstanding(const kernel_completion* desc) noexcept {
+    for (auto& io : _iocb_pool) {
+        if (get_user_data<kernel_completion>(io) == desc) {
+            return &io;
+        }
+    }
+    return nullptr;
+}
+
 inline
 unsigned
 aio_storage_context::iocb_pool::outstanding() const {
@@ -292,6 +305,25 @@ bool aio_storage_context::reap_completions(bool allow_retry)
     return n;
 }
 
+bool aio_storage_context::cancel(kernel_completion* desc) noexcept {
+    auto* io = _iocb_pool.find_outstanding(desc);
+    if (io == nullptr) {
+        return false;
+    }
+    linux_abi::io_event ev{};
+    auto r = io_cancel(_io_context, io, &ev);
+    if (r == 0) {
+        // The kernel dropped the request and won't deliver its event
+        _iocb_pool.put_one(io);
+        desc->complete_with(-ECANCELED);
+        return true;
+    }
+    // EINPROGRESS and friends -- the request cannot be stopped (the
+    // common case for disk I/O, or an iocb still waiting for a retry),
+    // its completion arrives as usual
+    return false;
+}
+
 bool aio_storage_context::can_sleep() const {
     // Because aio depends on polling, it cannot generate events to wake us up, Therefore, sleep
     // is only possible if there are no in-flight aios. If there are, we need to keep polling.
@@ -524,6 +556,10 @@ bool reactor_backend_aio::kernel_submit_work() {
     return did_work;
 }
 
+bool reactor_backend_aio::cancel_io(io_completion* desc) {
+    return _storage_context.cancel(desc);
+}
+
 bool reactor_backend_aio::kernel_events_can_sleep() const {
     return _storage_context.can_sleep();
 }
@@ -912,6 +948,10 @@ bool reactor_backend_epoll::reap_kernel_completions() {
     return _storage_context.reap_completions();
 }
 
+bool reactor_backend_epoll::cancel_io(io_completion* desc) {
+    return _storage_context.cancel(desc);
+}
+
 bool reactor_backend_epoll::kernel_submit_work() {
     bool result = false;
     _storage_context.submit_work();
@@ -1177,10 +1217,16 @@ reactor_backend_osv::make_pollable_fd_state(file_desc fd, pollable_fd::speculati
 
 static
 std::optional<::io_uring>
-try_create_uring(unsigned queue_len, bool throw_on_error) {
+try_create_uring(unsigned queue_len, bool sqpoll, bool throw_on_error) {
     auto required_features =
             IORING_FEAT_SUBMIT_STABLE
             | IORING_FEAT_NODROP;
+    if (sqpoll) {
+        // We submit regular (non-registered) file descriptors, which SQPOLL
+        // only accepts on kernels that advertise IORING_FEAT_SQPOLL_NONFIXED
+        // (linux 5.11).
+        required_features |= IORING_FEAT_SQPOLL_NONFIXED;
+    }
     auto required_ops = {
             IORING_OP_POLL_ADD, // linux 5.1
             IORING_OP_READV,
@@ -1204,6 +1250,14 @@ try_create_uring(unsigned queue_len, bool throw_on_error) {
     auto params = ::io_uring_params{
         .flags = 0,
     };
+    if (sqpoll) {
+        params.flags |= IORING_SETUP_SQPOLL;
+        // How long the kernel polling thread spins without finding new
+        // submissions before it goes to sleep (and needs an io_uring_enter()
+        // to be woken up again, which liburing issues for us). Long enough
+        // to keep the submission path syscall-free under steady load.
+        params.sq_thread_idle = 100; // milliseconds
+    }
     ::io_uring ring;
     auto err = ::io_uring_queue_init_params(queue_len, &ring, &params);
     if (err != 0) {
@@ -1268,7 +1322,7 @@ detect_io_uring() {
         // locked memory to be safe (8MB is what newer kernels and newer systemd provide)
         return false;
     }
-    auto ring_opt = try_create_uring(1, false);
+    auto ring_opt = try_create_uring(1, false, false);
     if (ring_opt) {
         ::io_uring_queue_exit(&ring_opt.value());
     }
@@ -1503,6 +1557,15 @@ private:
         return did_work | std::exchange(_did_work_while_getting_sqe, false);
     }
 
+    // Absorbs the completion of an IORING_OP_ASYNC_CANCEL. The result
+    // is irrelevant -- if the cancel lost the race the target request
+    // completes normally -- so it's simply dropped.
+    class cancel_completion final : public kernel_completion {
+        virtual void complete_with(ssize_t) override {
+            delete this;
+        }
+    };
+
     template<typename Completion>
     auto submit_request(std::unique_ptr<Completion> desc, io_request&& req) noexcept {
         auto fut = desc->get_future();
@@ -1512,7 +1575,7 @@ private:
 public:
     explicit reactor_backend_uring(reactor& r)
             : _r(r)
-            , _uring(try_create_uring(s_queue_len, true).value())
+            , _uring(try_create_uring(s_queue_len, r._cfg.force_io_uring_sqpoll, true).value())
             , _hrtimer_timerfd(make_timerfd())
             , _preempt_io_context(_r, _r._task_quota_timer, _hrtimer_timerfd)
             , _hrtimer_completion(_r, _hrtimer_timerfd)
@@ -1535,6 +1598,17 @@ public:
         did_work |= ::io_uring_submit(&_uring);
         return did_work;
     }
+    virtual bool cancel_io(io_completion* desc) override {
+        // The sqe carrying the request to cancel had its user_data set
+        // to the completion pointer, which makes the latter the natural
+        // cancellation key. The target request completes with ECANCELED
+        // if the cancel wins, or with its real result if it doesn't.
+        auto sqe = get_sqe();
+        ::io_uring_prep_cancel(sqe, desc, 0);
+        ::io_uring_sqe_set_data(sqe, static_cast<kernel_completion*>(new cancel_completion()));
+        _has_pending_submissions = true;
+        return true;
+    }
     virtual bool kernel_events_can_sleep() const override {
         // We never need to spin while I/O is in flight.
         return true;
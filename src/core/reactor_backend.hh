@@ -70,6 +70,7 @@ class aio_storage_context {
         void put_one(internal::linux_abi::iocb* io);
         unsigned outstanding() const;
         bool has_capacity() const;
+        internal::linux_abi::iocb* find_outstanding(const kernel_completion* desc) noexcept;
     };
 
     reactor& _r;
@@ -99,6 +100,7 @@ public:
     void schedule_retry();
     bool submit_work();
     bool can_sleep() const;
+    bool cancel(kernel_completion* desc) noexcept;
     future<> stop() noexcept;
 };
 
@@ -209,6 +211,17 @@ public:
     virtual bool do_blocking_io() const {
         return false;
     }
+
+    // Best-effort cancellation of an in-flight storage I/O request
+    // previously drained from the io_sink. Returns true if a
+    // kernel-level cancel was issued or succeeded; the request's
+    // completion is still delivered the usual way (typically with
+    // ECANCELED) unless the backend completed it right here. Backends
+    // that cannot cancel return false and the request runs to
+    // completion.
+    virtual bool cancel_io(io_completion* desc) {
+        return false;
+    }
     virtual void signal_received(int signo, siginfo_t* siginfo, void* ignore) = 0;
     virtual void start_tick() = 0;
     virtual void stop_tick() = 0;
@@ -273,6 +286,7 @@ public:
     virtual future<size_t> send(pollable_fd_state& fd, const void* buffer, size_t len) override;
     virtual future<temporary_buffer<char>> recv_some(pollable_fd_state& fd, internal::buffer_allocator* ba) override;
 
+    virtual bool cancel_io(io_completion* desc) override;
     virtual void signal_received(int signo, siginfo_t* siginfo, void* ignore) override;
     virtual void start_tick() override;
     virtual void stop_tick() override;
@@ -323,6 +337,7 @@ public:
     virtual future<size_t> send(pollable_fd_state& fd, const void* buffer, size_t len) override;
     virtual future<temporary_buffer<char>> recv_some(pollable_fd_state& fd, internal::buffer_allocator* ba) override;
 
+    virtual bool cancel_io(io_completion* desc) override;
     virtual void signal_received(int signo, siginfo_t* siginfo, void* ignore) override;
     virtual void start_tick() override;
     virtual void stop_tick() override;
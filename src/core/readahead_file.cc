@@ -0,0 +1,222 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright 2026 ScyllaDB
+ */
+
+#include <seastar/core/readahead_file.hh>
+#include <seastar/core/layered_file.hh>
+#include <seastar/core/gate.hh>
+#include <seastar/core/shared_future.hh>
+#include <seastar/core/shared_ptr.hh>
+
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace seastar {
+
+class readahead_file_impl : public layered_file_impl {
+    using chunk_future = shared_future<lw_shared_ptr<temporary_buffer<uint8_t>>>;
+
+    file_readahead_options _options;
+    // Sequential-run detector: where the next read of the current run
+    // is expected to start, and how many reads matched so far (clamped
+    // at the trigger).
+    uint64_t _next_expected = 0;
+    unsigned _run = 0;
+    // Prefetched chunks, keyed by offset / buffer_size. An entry may
+    // still be in flight; a reader landing on it waits for the same
+    // underlying request instead of issuing its own.
+    std::unordered_map<uint64_t, chunk_future> _chunks;
+    // Holds close() back until in-flight prefetches complete.
+    gate _prefetch_gate;
+public:
+    explicit readahead_file_impl(file f, file_readahead_options options) noexcept
+            : layered_file_impl(std::move(f))
+            , _options(options) {
+    }
+
+    virtual future<size_t> write_dma(uint64_t pos, const void* buffer, size_t len, const io_priority_class& pc) override {
+        invalidate();
+        return underlying_file().dma_write(pos, reinterpret_cast<const uint8_t*>(buffer), len, pc);
+    }
+    virtual future<size_t> write_dma(uint64_t pos, const void* buffer, size_t len, const io_priority_class& pc, io_intent* intent) override {
+        invalidate();
+        return underlying_file().dma_write(pos, reinterpret_cast<const uint8_t*>(buffer), len, pc, intent);
+    }
+    virtual future<size_t> write_dma(uint64_t pos, std::vector<iovec> iov, const io_priority_class& pc) override {
+        invalidate();
+        return underlying_file().dma_write(pos, std::move(iov), pc);
+    }
+    virtual future<size_t> write_dma(uint64_t pos, std::vector<iovec> iov, const io_priority_class& pc, io_intent* intent) override {
+        invalidate();
+        return underlying_file().dma_write(pos, std::move(iov), pc, intent);
+    }
+
+    virtual future<size_t> read_dma(uint64_t pos, void* buffer, size_t len, const io_priority_class& pc) override {
+        return read_dma(pos, buffer, len, pc, nullptr);
+    }
+    virtual future<size_t> read_dma(uint64_t pos, void* buffer, size_t len, const io_priority_class& pc, io_intent* intent) override {
+        if (auto hit = lookup(pos, len, pc)) {
+            return hit->then([buffer, pos, len, chunk_base = chunk_of(pos) * _options.buffer_size] (lw_shared_ptr<temporary_buffer<uint8_t>> buf) {
+                auto off = pos - chunk_base;
+                auto n = off < buf->size() ? std::min<size_t>(len, buf->size() - off) : 0;
+                std::memcpy(buffer, buf->get() + off, n);
+                return n;
+            });
+        }
+        return underlying_file().dma_read(pos, reinterpret_cast<uint8_t*>(buffer), len, pc, intent);
+    }
+    virtual future<size_t> read_dma(uint64_t pos, std::vector<iovec> iov, const io_priority_class& pc) override {
+        return underlying_file().dma_read(pos, std::move(iov), pc);
+    }
+    virtual future<size_t> read_dma(uint64_t pos, std::vector<iovec> iov, const io_priority_class& pc, io_intent* intent) override {
+        return underlying_file().dma_read(pos, std::move(iov), pc, intent);
+    }
+
+    virtual future<temporary_buffer<uint8_t>> dma_read_bulk(uint64_t offset, size_t range_size, const io_priority_class& pc) override {
+        return dma_read_bulk(offset, range_size, pc, nullptr);
+    }
+    virtual future<temporary_buffer<uint8_t>> dma_read_bulk(uint64_t offset, size_t range_size, const io_priority_class& pc, io_intent* intent) override {
+        if (auto hit = lookup(offset, range_size, pc)) {
+            return hit->then([offset, range_size, chunk_base = chunk_of(offset) * _options.buffer_size] (lw_shared_ptr<temporary_buffer<uint8_t>> buf) {
+                auto off = offset - chunk_base;
+                if (off >= buf->size()) {
+                    return temporary_buffer<uint8_t>();
+                }
+                return buf->share(off, std::min<size_t>(range_size, buf->size() - off));
+            });
+        }
+        return underlying_file().dma_read_bulk<uint8_t>(offset, range_size, pc, intent);
+    }
+
+    virtual future<> flush() override {
+        return underlying_file().flush();
+    }
+    virtual future<struct stat> stat() override {
+        return underlying_file().stat();
+    }
+    virtual future<> truncate(uint64_t length) override {
+        invalidate();
+        return underlying_file().truncate(length);
+    }
+    virtual future<> discard(uint64_t offset, uint64_t length) override {
+        invalidate();
+        return underlying_file().discard(offset, length);
+    }
+    virtual future<> allocate(uint64_t position, uint64_t length) override {
+        return underlying_file().allocate(position, length);
+    }
+    virtual future<uint64_t> size() override {
+        return underlying_file().size();
+    }
+    virtual future<> close() override {
+        _chunks.clear();
+        return _prefetch_gate.close().then([this] {
+            return get_file_impl(underlying_file())->close();
+        });
+    }
+    virtual std::unique_ptr<file_handle_impl> dup() override {
+        // The dupped handle gets its own advisor; readahead state is
+        // per-handle by design.
+        return get_file_impl(_underlying_file)->dup();
+    }
+    virtual subscription<directory_entry> list_directory(std::function<future<> (directory_entry de)> next) override {
+        return get_file_impl(underlying_file())->list_directory(std::move(next));
+    }
+private:
+    uint64_t chunk_of(uint64_t offset) const noexcept {
+        return offset / _options.buffer_size;
+    }
+
+    void invalidate() noexcept {
+        // In-flight prefetches keep running under the gate; dropping
+        // the entries just makes their results unreachable.
+        _chunks.clear();
+        _run = 0;
+    }
+
+    // Feeds the run detector, triggers prefetch when warranted, and
+    // returns the chunk's future if the read can be served from the
+    // cache.
+    std::optional<future<lw_shared_ptr<temporary_buffer<uint8_t>>>> lookup(uint64_t offset, size_t len, const io_priority_class& pc) {
+        note_read(offset, len, pc);
+        if (!len || chunk_of(offset) != chunk_of(offset + len - 1)) {
+            // Spans a chunk boundary; let the underlying file serve it
+            // in one request.
+            return std::nullopt;
+        }
+        auto it = _chunks.find(chunk_of(offset));
+        if (it == _chunks.end()) {
+            return std::nullopt;
+        }
+        if (it->second.available() && it->second.failed()) {
+            // Drop the failed prefetch and retry via the underlying
+            // file; the demand read will report its own error.
+            _chunks.erase(it);
+            return std::nullopt;
+        }
+        return it->second.get_future();
+    }
+
+    void note_read(uint64_t offset, size_t len, const io_priority_class& pc) {
+        if (offset >= _next_expected && offset - _next_expected < _options.buffer_size) {
+            // Sequential enough: resuming at (or slightly past, e.g.
+            // after alignment-induced overlap) the previous read's end.
+            if (_run < _options.sequential_trigger) {
+                _run++;
+            }
+        } else {
+            _run = 0;
+        }
+        _next_expected = offset + len;
+        if (_run >= _options.sequential_trigger) {
+            prefetch(pc);
+        }
+    }
+
+    void prefetch(const io_priority_class& pc) {
+        // Evict chunks the run has moved past; anything still in
+        // flight completes under the gate and is simply dropped.
+        auto current = chunk_of(_next_expected);
+        for (auto it = _chunks.begin(); it != _chunks.end();) {
+            it = it->first < current ? _chunks.erase(it) : std::next(it);
+        }
+        for (auto chunk = current; chunk < current + _options.max_buffers; chunk++) {
+            if (_chunks.contains(chunk)) {
+                continue;
+            }
+            auto f = underlying_file().dma_read_bulk<uint8_t>(chunk * _options.buffer_size, _options.buffer_size, pc).then(
+                    [] (temporary_buffer<uint8_t> buf) {
+                return make_lw_shared<temporary_buffer<uint8_t>>(std::move(buf));
+            }).finally([h = _prefetch_gate.hold()] {});
+            _chunks.emplace(chunk, chunk_future(std::move(f)));
+        }
+    }
+};
+
+file make_readahead_file(file f, file_readahead_options options) {
+    if (!options.buffer_size || options.buffer_size % f.disk_read_dma_alignment()) {
+        throw std::invalid_argument("make_readahead_file: buffer size must be a non-zero multiple of the file's disk read DMA alignment");
+    }
+    return file(::seastar::make_shared<readahead_file_impl>(std::move(f), options));
+}
+
+}
@@ -0,0 +1,90 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB
+ */
+
+#include <seastar/core/startup_graph.hh>
+#include <seastar/core/when_all.hh>
+#include <seastar/util/log.hh>
+#include <cassert>
+
+namespace seastar {
+
+static logger sglogger("startup_graph");
+
+startup_graph::step_id startup_graph::add_step(sstring name, std::vector<step_id> dependencies, noncopyable_function<future<> ()> action) {
+    assert(!_ran);
+    for (auto d : dependencies) {
+        assert(d < _steps.size());
+    }
+    _steps.push_back(step{std::move(name), std::move(dependencies), std::move(action), {}, {}});
+    return _steps.size() - 1;
+}
+
+future<> startup_graph::run() {
+    assert(!std::exchange(_ran, true));
+    // _steps no longer changes, so references into it stay valid
+    std::vector<future<>> all;
+    all.reserve(_steps.size());
+    for (auto& s : _steps) {
+        std::vector<future<>> deps;
+        deps.reserve(s.dependencies.size());
+        for (auto d : s.dependencies) {
+            deps.push_back(_steps[d].done.get_shared_future());
+        }
+        auto f = when_all_succeed(deps.begin(), deps.end()).then([&s] {
+            sglogger.debug("starting {}", s.name);
+            auto start = std::chrono::steady_clock::now();
+            return futurize_invoke(s.action).finally([&s, start] {
+                s.duration = std::chrono::steady_clock::now() - start;
+                sglogger.debug("{} completed in {}us", s.name,
+                        std::chrono::duration_cast<std::chrono::microseconds>(s.duration).count());
+            });
+        });
+        all.push_back(f.then_wrapped([&s] (future<> f) {
+            if (f.failed()) {
+                auto ex = f.get_exception();
+                s.done.set_exception(ex);
+                return make_exception_future<>(std::move(ex));
+            }
+            s.done.set_value();
+            return make_ready_future<>();
+        }));
+    }
+    return when_all(all.begin(), all.end()).then([] (std::vector<future<>> results) {
+        std::exception_ptr ex;
+        for (auto& r : results) {
+            if (r.failed()) {
+                if (ex) {
+                    // report the first failure; dependents fail with
+                    // their dependency's exception anyway
+                    r.ignore_ready_future();
+                } else {
+                    ex = r.get_exception();
+                }
+            }
+        }
+        if (ex) {
+            return make_exception_future<>(std::move(ex));
+        }
+        return make_ready_future<>();
+    });
+}
+
+}
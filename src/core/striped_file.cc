@@ -0,0 +1,244 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright 2026 ScyllaDB
+ */
+
+#include <seastar/core/striped_file.hh>
+#include <seastar/core/layered_file.hh>
+#include <seastar/core/align.hh>
+#include <seastar/core/do_with.hh>
+#include <seastar/core/loop.hh>
+#include <seastar/core/sharded.hh>
+#include <seastar/core/smp.hh>
+
+#include <boost/range/irange.hpp>
+
+namespace seastar {
+
+class striped_file_impl : public layered_file_impl {
+    uint64_t _stripe_size;
+    // Per-shard duplicates of the underlying file, each bound to its
+    // shard's io_queue. Entries are owned by their shards; this shard's
+    // entry aliases the underlying file.
+    std::vector<foreign_ptr<std::unique_ptr<file>>> _shard_files;
+public:
+    striped_file_impl(file f, uint64_t stripe_size, std::vector<foreign_ptr<std::unique_ptr<file>>> shard_files) noexcept
+            : layered_file_impl(std::move(f))
+            , _stripe_size(stripe_size)
+            , _shard_files(std::move(shard_files)) {
+    }
+
+    virtual future<size_t> write_dma(uint64_t pos, const void* buffer, size_t len, const io_priority_class& pc) override {
+        return write_dma(pos, buffer, len, pc, nullptr);
+    }
+    virtual future<size_t> write_dma(uint64_t pos, const void* buffer, size_t len, const io_priority_class& pc, io_intent* intent) override {
+        auto io_pc = pc;
+        return for_each_stripe(pos, const_cast<void*>(buffer), len, intent,
+                [io_pc] (file_impl& fi, uint64_t pos, char* buf, size_t len, io_intent* intent) {
+            return fi.write_dma(pos, buf, len, io_pc, intent);
+        });
+    }
+    virtual future<size_t> write_dma(uint64_t pos, std::vector<iovec> iov, const io_priority_class& pc) override {
+        return write_dma(pos, std::move(iov), pc, nullptr);
+    }
+    virtual future<size_t> write_dma(uint64_t pos, std::vector<iovec> iov, const io_priority_class& pc, io_intent* intent) override {
+        // Vectored requests are not split; the stripe owning the first
+        // byte serves the whole request.
+        return submit_whole(pos, intent, [pos, iov = std::move(iov), io_pc = pc] (file_impl& fi, io_intent* intent) mutable {
+            return fi.write_dma(pos, std::move(iov), io_pc, intent);
+        });
+    }
+    virtual future<size_t> read_dma(uint64_t pos, void* buffer, size_t len, const io_priority_class& pc) override {
+        return read_dma(pos, buffer, len, pc, nullptr);
+    }
+    virtual future<size_t> read_dma(uint64_t pos, void* buffer, size_t len, const io_priority_class& pc, io_intent* intent) override {
+        auto io_pc = pc;
+        return for_each_stripe(pos, buffer, len, intent,
+                [io_pc] (file_impl& fi, uint64_t pos, char* buf, size_t len, io_intent* intent) {
+            return fi.read_dma(pos, buf, len, io_pc, intent);
+        });
+    }
+    virtual future<size_t> read_dma(uint64_t pos, std::vector<iovec> iov, const io_priority_class& pc) override {
+        return read_dma(pos, std::move(iov), pc, nullptr);
+    }
+    virtual future<size_t> read_dma(uint64_t pos, std::vector<iovec> iov, const io_priority_class& pc, io_intent* intent) override {
+        return submit_whole(pos, intent, [pos, iov = std::move(iov), io_pc = pc] (file_impl& fi, io_intent* intent) mutable {
+            return fi.read_dma(pos, std::move(iov), io_pc, intent);
+        });
+    }
+    virtual future<temporary_buffer<uint8_t>> dma_read_bulk(uint64_t offset, size_t range_size, const io_priority_class& pc) override {
+        return dma_read_bulk(offset, range_size, pc, nullptr);
+    }
+    virtual future<temporary_buffer<uint8_t>> dma_read_bulk(uint64_t offset, size_t range_size, const io_priority_class& pc, io_intent* intent) override {
+        // Allocate one buffer on the calling shard and let the stripe
+        // owners DMA straight into their slices of it.
+        auto front = offset & (_disk_read_dma_alignment - 1);
+        auto start = offset - front;
+        auto len = align_up(front + range_size, uint64_t(_disk_read_dma_alignment));
+        auto buf = temporary_buffer<uint8_t>::aligned(_memory_dma_alignment, len);
+        auto io_pc = pc;
+        auto dst = reinterpret_cast<void*>(buf.get_write());
+        return for_each_stripe(start, dst, len, intent,
+                [io_pc] (file_impl& fi, uint64_t pos, char* b, size_t l, io_intent* intent) {
+            return fi.read_dma(pos, b, l, io_pc, intent);
+        }).then([buf = std::move(buf), front, range_size] (size_t size) mutable {
+            buf.trim(size);
+            buf.trim_front(std::min<size_t>(front, size));
+            if (buf.size() > range_size) {
+                buf.trim(range_size);
+            }
+            return std::move(buf);
+        });
+    }
+
+    virtual future<> flush() override {
+        return underlying_file().flush();
+    }
+    virtual future<struct stat> stat() override {
+        return underlying_file().stat();
+    }
+    virtual future<> truncate(uint64_t length) override {
+        return underlying_file().truncate(length);
+    }
+    virtual future<> discard(uint64_t offset, uint64_t length) override {
+        return underlying_file().discard(offset, length);
+    }
+    virtual future<> allocate(uint64_t position, uint64_t length) override {
+        return underlying_file().allocate(position, length);
+    }
+    virtual future<uint64_t> size() override {
+        return underlying_file().size();
+    }
+    virtual future<> close() override {
+        // Close and destroy the remote duplicates on their owning
+        // shards, then the underlying file here.
+        return parallel_for_each(boost::irange(0u, smp::count), [this] (shard_id shard) {
+            if (shard == this_shard_id()) {
+                _shard_files[shard].reset();
+                return make_ready_future<>();
+            }
+            return smp::submit_to(shard, [f = std::move(_shard_files[shard])] () mutable {
+                auto& ref = *f;
+                return ref.close().finally([f = std::move(f)] {});
+            });
+        }).then([this] {
+            return get_file_impl(underlying_file())->close();
+        });
+    }
+    virtual std::unique_ptr<file_handle_impl> dup() override {
+        // The handle rebuilds a plain (unstriped) file on the receiving
+        // shard; re-stripe with make_striped_file() there if needed.
+        return get_file_impl(underlying_file())->dup();
+    }
+    virtual subscription<directory_entry> list_directory(std::function<future<> (directory_entry de)> next) override {
+        return get_file_impl(underlying_file())->list_directory(std::move(next));
+    }
+private:
+    shard_id stripe_owner(uint64_t pos) const noexcept {
+        return (pos / _stripe_size) % smp::count;
+    }
+
+    file_impl& shard_file(shard_id shard) noexcept {
+        return *get_file_impl(*_shard_files[shard]);
+    }
+
+    // Runs op for each stripe-bounded chunk of [pos, pos + len) on the
+    // chunk's owning shard, in parallel. The result counts the bytes
+    // transferred contiguously from pos, mirroring a short read/write.
+    template <typename Op>
+    future<size_t> for_each_stripe(uint64_t pos, void* buffer, size_t len, io_intent* intent, Op op) {
+        struct chunk {
+            uint64_t pos;
+            char* buf;
+            size_t len;
+            size_t done;
+        };
+        std::vector<chunk> chunks;
+        auto p = pos;
+        auto buf = reinterpret_cast<char*>(buffer);
+        while (len) {
+            auto chunk_len = std::min<uint64_t>(len, align_up(p + 1, _stripe_size) - p);
+            chunks.push_back(chunk{p, buf, chunk_len, 0});
+            p += chunk_len;
+            buf += chunk_len;
+            len -= chunk_len;
+        }
+        return do_with(std::move(chunks), [this, intent, op = std::move(op)] (std::vector<chunk>& chunks) {
+            return parallel_for_each(boost::irange<size_t>(0, chunks.size()), [this, intent, &op, &chunks] (size_t i) {
+                auto& c = chunks[i];
+                auto owner = stripe_owner(c.pos);
+                if (owner == this_shard_id()) {
+                    return op(shard_file(owner), c.pos, c.buf, c.len, intent).then([&c] (size_t done) {
+                        c.done = done;
+                    });
+                }
+                // io_intent is shard-local, so remote chunks run without it
+                return smp::submit_to(owner, [this, owner, &c, &op] {
+                    return op(shard_file(owner), c.pos, c.buf, c.len, nullptr);
+                }).then([&c] (size_t done) {
+                    c.done = done;
+                });
+            }).then([&chunks] {
+                size_t total = 0;
+                for (auto& c : chunks) {
+                    total += c.done;
+                    if (c.done < c.len) {
+                        break;
+                    }
+                }
+                return total;
+            });
+        });
+    }
+
+    // Runs op on the shard owning the stripe containing pos.
+    template <typename Op>
+    future<size_t> submit_whole(uint64_t pos, io_intent* intent, Op op) {
+        auto owner = stripe_owner(pos);
+        if (owner == this_shard_id()) {
+            return op(shard_file(owner), intent);
+        }
+        return smp::submit_to(owner, [this, owner, op = std::move(op)] () mutable {
+            return op(shard_file(owner), nullptr);
+        });
+    }
+};
+
+future<file> make_striped_file(file f, uint64_t stripe_size) {
+    if (!stripe_size || stripe_size % f.disk_read_dma_alignment() || stripe_size % f.disk_write_dma_alignment()) {
+        throw std::invalid_argument("make_striped_file: stripe size must be a non-zero multiple of the file's DMA alignments");
+    }
+    return do_with(std::move(f), std::vector<foreign_ptr<std::unique_ptr<file>>>(smp::count), [stripe_size] (file& f, std::vector<foreign_ptr<std::unique_ptr<file>>>& shard_files) {
+        return parallel_for_each(boost::irange(0u, smp::count), [&f, &shard_files] (shard_id shard) {
+            if (shard == this_shard_id()) {
+                shard_files[shard] = make_foreign(std::make_unique<file>(f));
+                return make_ready_future<>();
+            }
+            return smp::submit_to(shard, [h = f.dup()] () mutable {
+                return make_foreign(std::make_unique<file>(std::move(h)));
+            }).then([&shard_files, shard] (foreign_ptr<std::unique_ptr<file>> sf) {
+                shard_files[shard] = std::move(sf);
+            });
+        }).then([&f, &shard_files, stripe_size] {
+            return file(::seastar::make_shared<striped_file_impl>(std::move(f), stripe_size, std::move(shard_files)));
+        });
+    });
+}
+
+}
@@ -170,7 +170,8 @@ static size_t get_stack_size(thread_attributes attr) {
 thread_context::thread_context(thread_attributes attr, noncopyable_function<void ()> func)
         : task(attr.sched_group.value_or(current_scheduling_group()))
         , _stack(make_stack(get_stack_size(attr)))
-        , _func(std::move(func)) {
+        , _func(std::move(func))
+        , _arena(attr.arena_size ? std::make_unique<internal::thread_arena>(attr.arena_size) : nullptr) {
     setup(get_stack_size(attr));
     _all_threads.push_front(*this);
 }
@@ -269,6 +270,17 @@ thread_context::reschedule() {
     schedule(this);
 }
 
+void
+thread_context::migrate_to(scheduling_group sg) {
+    if (sg == group()) {
+        return;
+    }
+    set_scheduling_group(sg);
+    // Requeue through the new group's task queue; when we resume, the
+    // reactor has set the current scheduling group accordingly.
+    yield();
+}
+
 void
 thread_context::s_main(int lo, int hi) {
     uintptr_t q = uint64_t(uint32_t(lo)) | uint64_t(hi) << 32;
@@ -347,6 +359,21 @@ void thread::maybe_yield() {
     }
 }
 
+void thread::reset_arena() noexcept {
+    if (auto* arena = internal::current_thread_arena()) {
+        arena->reset();
+    }
+}
+
+namespace internal {
+
+thread_arena* current_thread_arena() noexcept {
+    auto* tctx = thread_impl::get();
+    return tctx ? tctx->arena() : nullptr;
+}
+
+}
+
 }
 
 /// \endcond
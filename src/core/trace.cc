@@ -0,0 +1,90 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB
+ */
+
+#include <seastar/core/trace.hh>
+#include <seastar/core/internal/trace.hh>
+#include <seastar/core/fstream.hh>
+#include <seastar/core/seastar.hh>
+#include <seastar/core/smp.hh>
+#include <cstring>
+
+namespace seastar {
+
+namespace internal {
+
+thread_local trace_ring g_trace_ring;
+
+void trace_ring::enable() {
+    if (!_buf) {
+        _buf = std::make_unique<trace_record[]>(default_capacity);
+        _mask = default_capacity - 1;
+    }
+    _enabled = true;
+}
+
+std::vector<trace_record> trace_ring::snapshot() const {
+    std::vector<trace_record> out;
+    if (!_buf) {
+        return out;
+    }
+    auto nr = std::min<uint64_t>(_head, _mask + 1);
+    out.reserve(nr);
+    for (auto i = _head - nr; i != _head; ++i) {
+        out.push_back(_buf[i & _mask]);
+    }
+    return out;
+}
+
+}
+
+void set_tracing_enabled(bool enabled) {
+    if (enabled) {
+        internal::g_trace_ring.enable();
+    } else {
+        internal::g_trace_ring.disable();
+    }
+}
+
+bool tracing_enabled() noexcept {
+    return internal::g_trace_ring.enabled();
+}
+
+future<> dump_trace(sstring path) {
+    return do_with(internal::g_trace_ring.snapshot(), [path = std::move(path)] (std::vector<internal::trace_record>& records) {
+        return open_file_dma(path, open_flags::wo | open_flags::create | open_flags::truncate).then([&records] (file f) {
+            return make_file_output_stream(std::move(f)).then([&records] (output_stream<char> out) {
+                return do_with(std::move(out), [&records] (output_stream<char>& out) {
+                    internal::trace_file_header hdr = {};
+                    std::memcpy(hdr.magic, "SSTRACE1", sizeof(hdr.magic));
+                    hdr.shard = this_shard_id();
+                    hdr.record_size = sizeof(internal::trace_record);
+                    return out.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr)).then([&out, &records] {
+                        return out.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(internal::trace_record));
+                    }).then([&out] {
+                        return out.close();
+                    });
+                });
+            });
+        });
+    });
+}
+
+}
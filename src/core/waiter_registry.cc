@@ -0,0 +1,79 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB
+ */
+
+#include <algorithm>
+#include <unordered_set>
+
+#include <seastar/core/waiter_registry.hh>
+
+namespace seastar {
+
+namespace internal {
+
+static thread_local std::unordered_set<waiter_tracker*> tracker_registry;
+
+waiter_tracker::waiter_tracker(const char* kind, sstring name)
+        : _kind(kind), _name(std::move(name)) {
+    tracker_registry.insert(this);
+}
+
+waiter_tracker::~waiter_tracker() {
+    tracker_registry.erase(this);
+}
+
+void waiter_tracker::on_wait() noexcept {
+    try {
+        _waits.push_back(std::chrono::steady_clock::now());
+    } catch (...) {
+        // Under allocation pressure the record is dropped and the
+        // reported count degrades to an approximation.
+    }
+}
+
+void waiter_tracker::on_wake() noexcept {
+    if (!_waits.empty()) {
+        _waits.pop_front();
+    }
+}
+
+std::chrono::steady_clock::duration waiter_tracker::oldest_waiter_age() const noexcept {
+    if (_waits.empty()) {
+        return {};
+    }
+    return std::chrono::steady_clock::now() - _waits.front();
+}
+
+}
+
+std::vector<waiter_registry_entry> dump_waiter_registry() {
+    std::vector<waiter_registry_entry> entries;
+    for (auto* t : internal::tracker_registry) {
+        if (t->waiters()) {
+            entries.push_back(waiter_registry_entry{t->kind(), t->name(), t->waiters(), t->oldest_waiter_age()});
+        }
+    }
+    std::sort(entries.begin(), entries.end(), [] (const waiter_registry_entry& a, const waiter_registry_entry& b) {
+        return a.oldest_waiter_age > b.oldest_waiter_age;
+    });
+    return entries;
+}
+
+}
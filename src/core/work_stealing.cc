@@ -0,0 +1,124 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB Ltd.
+ */
+
+#include <seastar/core/work_stealing.hh>
+#include <seastar/core/loop.hh>
+#include <seastar/core/smp.hh>
+#include <mutex>
+#include <vector>
+
+namespace seastar {
+
+work_stealing_pool::work_stealing_pool()
+    : _queues(std::make_unique<shard_queue[]>(smp::count)) {
+}
+
+work_stealing_pool::~work_stealing_pool() = default;
+
+void work_stealing_pool::submit(work_item wi) {
+    auto& q = _queues[this_shard_id()];
+    std::lock_guard guard(q.lock);
+    q.items.push_back(std::move(wi));
+    q.size.store(q.items.size(), std::memory_order_relaxed);
+}
+
+std::optional<work_stealing_pool::work_item> work_stealing_pool::try_get() {
+    auto& q = _queues[this_shard_id()];
+    // The owner pops newest-first to stay cache-warm; thieves take the
+    // oldest items, which the owner is furthest from reaching.
+    if (q.size.load(std::memory_order_relaxed)) {
+        std::lock_guard guard(q.lock);
+        if (!q.items.empty()) {
+            auto wi = std::move(q.items.back());
+            q.items.pop_back();
+            q.size.store(q.items.size(), std::memory_order_relaxed);
+            return wi;
+        }
+    }
+    return steal();
+}
+
+std::optional<work_stealing_pool::work_item> work_stealing_pool::steal() {
+    auto me = this_shard_id();
+    auto victim = me;
+    size_t best = 0;
+    for (unsigned i = 0; i < smp::count; ++i) {
+        auto sz = _queues[i].size.load(std::memory_order_relaxed);
+        if (i != me && sz > best) {
+            best = sz;
+            victim = i;
+        }
+    }
+    if (victim == me) {
+        return std::nullopt;
+    }
+    // Move the batch out under the victim's lock only, then requeue the
+    // remainder under our own; holding both at once could deadlock with a
+    // shard concurrently stealing in the opposite direction.
+    std::vector<work_item> batch;
+    {
+        auto& q = _queues[victim];
+        std::lock_guard guard(q.lock);
+        if (q.items.empty()) {
+            return std::nullopt;
+        }
+        auto n = std::min((q.items.size() + 1) / 2, steal_batch);
+        batch.reserve(n);
+        while (n--) {
+            batch.push_back(std::move(q.items.front()));
+            q.items.pop_front();
+        }
+        q.size.store(q.items.size(), std::memory_order_relaxed);
+    }
+    auto wi = std::move(batch.back());
+    batch.pop_back();
+    if (!batch.empty()) {
+        auto& mine = _queues[me];
+        std::lock_guard guard(mine.lock);
+        for (auto&& b : batch) {
+            mine.items.push_back(std::move(b));
+        }
+        mine.size.store(mine.items.size(), std::memory_order_relaxed);
+    }
+    return wi;
+}
+
+future<> work_stealing_pool::drain() {
+    return repeat([this] {
+        auto wi = try_get();
+        if (!wi) {
+            return make_ready_future<stop_iteration>(stop_iteration::yes);
+        }
+        return (*wi)().then([] {
+            return stop_iteration::no;
+        });
+    });
+}
+
+size_t work_stealing_pool::size() const noexcept {
+    size_t ret = 0;
+    for (unsigned i = 0; i < smp::count; ++i) {
+        ret += _queues[i].size.load(std::memory_order_relaxed);
+    }
+    return ret;
+}
+
+}
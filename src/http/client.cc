@@ -186,61 +186,155 @@ client::client(socket_address addr, shared_ptr<tls::certificate_credentials> cre
 {
 }
 
-client::client(std::unique_ptr<connection_factory> f)
+client::client(std::unique_ptr<connection_factory> f, unsigned max_idle_connections, unsigned max_pipelined_requests)
         : _new_connections(std::move(f))
+        , _max_idle(max_idle_connections)
+        , _max_pipeline(std::max(max_pipelined_requests, 1u))
 {
 }
 
-future<client::connection_ptr> client::get_connection() {
-    if (!_pool.empty()) {
-        connection_ptr con = _pool.front().shared_from_this();
-        _pool.pop_front();
+future<> client::make_request(request req, reply_handler handle, reply::status_type expected) {
+    if (_nr_idle > 0) {
+        // LIFO: the most recently used connection has the warmest caches
+        connection_ptr con = _pool.back().shared_from_this();
+        con->_hook.unlink();
+        _nr_idle--;
+        _busy.push_back(*con);
+        _stats.pool_hits++;
         http_log.trace("pop http connection {} from pool", con->_fd.local_address());
-        return make_ready_future<connection_ptr>(con);
+        return do_make_request(std::move(con), std::move(req), std::move(handle), expected);
+    }
+
+    if (_max_pipeline > 1 && req.get_header("Expect").empty()) {
+        // No idle connection; pipeline onto the least loaded busy one, if any
+        connection* best = nullptr;
+        for (auto& con : _busy) {
+            if (!con._exclusive && !con._retired && con._in_flight < _max_pipeline &&
+                    (best == nullptr || con._in_flight < best->_in_flight)) {
+                best = &con;
+            }
+        }
+        if (best != nullptr) {
+            _stats.pipelined_requests++;
+            http_log.trace("pipeline http request onto connection {}", best->_fd.local_address());
+            return do_make_request(best->shared_from_this(), std::move(req), std::move(handle), expected);
+        }
     }
 
-    return _new_connections->make().then([] (connected_socket cs) {
+    return _new_connections->make().then([this, req = std::move(req), handle = std::move(handle), expected] (connected_socket cs) mutable {
         http_log.trace("created new http connection {}", cs.local_address());
+        _stats.connections_created++;
         auto con = seastar::make_shared<connection>(std::move(cs));
-        return make_ready_future<connection_ptr>(std::move(con));
+        _busy.push_back(*con);
+        return do_make_request(std::move(con), std::move(req), std::move(handle), expected);
     });
 }
 
-future<> client::put_connection(connection_ptr con, bool can_cache) {
-    if (can_cache) {
-        http_log.trace("push http connection {} to pool", con->_fd.local_address());
-        _pool.push_back(*con);
-        return make_ready_future<>();
-    }
+future<> client::do_make_request(connection_ptr con, request req, reply_handler handle, reply::status_type expected) {
+    con->_in_flight++;
+    future<> f = make_ready_future<>();
+    if (!req.get_header("Expect").empty()) {
+        // The 100-continue dialog interleaves reads into the send phase, so
+        // it needs the connection for itself
+        con->_exclusive = true;
+        f = con->make_request(std::move(req)).then([con, expected, handle = std::move(handle)] (reply rep) mutable {
+            if (rep._status != expected) {
+                return make_exception_future<>(std::runtime_error(format("request finished with {}", rep._status)));
+            }
 
-    http_log.trace("dropping connection {}", con->_fd.local_address());
-    return con->close().finally([con] {});
-}
+            return do_with(std::move(rep), [con, handle = std::move(handle)] (auto& rep) mutable {
+                return handle(rep, con->in(rep));
+            });
+        });
+    } else {
+        // Split the request into a send phase and a receive phase and order
+        // each behind its predecessor's phase, so several requests can be in
+        // flight on one keep-alive connection. The barrier promises carry no
+        // errors -- followers check _retired instead -- so an abandoned
+        // barrier future never holds an ignored exception.
+        struct pipeline_slot {
+            promise<> sent;
+            promise<> received;
+        };
+        f = do_with(std::move(req), std::move(handle), pipeline_slot{}, [con, expected] (request& req, reply_handler& handle, pipeline_slot& slot) {
+            auto prev_send = std::exchange(con->_send_order, slot.sent.get_future());
+            auto prev_recv = std::exchange(con->_recv_order, slot.received.get_future());
+            return prev_send.then([con, &req] {
+                if (con->_retired) {
+                    return make_exception_future<>(std::runtime_error("an earlier pipelined request failed the connection"));
+                }
+                return con->send_request_head(req).then([con, &req] {
+                    return con->write_body(req);
+                }).then([con] {
+                    return con->_write_buf.flush();
+                });
+            }).then_wrapped([con, &slot] (future<> f) {
+                if (f.failed()) {
+                    con->_retired = true;
+                }
+                slot.sent.set_value();
+                return f;
+            }).then([prev_recv = std::move(prev_recv)] () mutable {
+                return std::move(prev_recv);
+            }).then([con] {
+                if (con->_retired) {
+                    return make_exception_future<reply>(std::runtime_error("an earlier pipelined request failed the connection"));
+                }
+                return con->recv_reply();
+            }).then([con, expected, &handle] (reply rep) {
+                if (rep._status != expected) {
+                    return make_exception_future<>(std::runtime_error(format("request finished with {}", rep._status)));
+                }
 
-template <typename Fn>
-SEASTAR_CONCEPT( requires std::invocable<Fn, connection&> )
-auto client::with_connection(Fn&& fn) {
-    return get_connection().then([this, fn = std::move(fn)] (connection_ptr con) mutable {
-        return fn(*con).then_wrapped([this, con = std::move(con)] (auto f) mutable {
-            return put_connection(std::move(con), !f.failed()).then([f = std::move(f)] () mutable {
-                return std::move(f);
+                return do_with(std::move(rep), [con, &handle] (auto& rep) {
+                    return handle(rep, con->in(rep));
+                });
+            }).then_wrapped([con, &slot] (future<> f) {
+                if (f.failed()) {
+                    con->_retired = true;
+                }
+                slot.received.set_value();
+                return f;
             });
         });
+    }
+
+    return f.then_wrapped([this, con = std::move(con)] (future<> f) mutable {
+        return release_connection(std::move(con), !f.failed()).then([f = std::move(f)] () mutable {
+            return std::move(f);
+        });
     });
 }
 
-future<> client::make_request(request req, reply_handler handle, reply::status_type expected) {
-    return with_connection([req = std::move(req), handle = std::move(handle), expected] (connection& con) mutable {
-        return con.make_request(std::move(req)).then([&con, expected, handle = std::move(handle)] (reply rep) mutable {
-            if (rep._status != expected) {
-                return make_exception_future<>(std::runtime_error(format("request finished with {}", rep._status)));
-            }
+future<> client::release_connection(connection_ptr con, bool can_cache) {
+    if (!can_cache) {
+        con->_retired = true;
+    }
+    if (--con->_in_flight > 0) {
+        return make_ready_future<>();
+    }
 
-            return do_with(std::move(rep), [&con, handle = std::move(handle)] (auto& rep) mutable {
-                return handle(rep, con.in(rep));
-            });
-        });
-    });
+    con->_hook.unlink();
+    con->_exclusive = false;
+
+    if (con->_retired) {
+        _stats.connections_dropped++;
+        http_log.trace("dropping connection {}", con->_fd.local_address());
+        return con->close().finally([con] {});
+    }
+
+    http_log.trace("push http connection {} to pool", con->_fd.local_address());
+    _pool.push_back(*con);
+    _nr_idle++;
+    if (_nr_idle > _max_idle) {
+        connection_ptr victim = _pool.front().shared_from_this();
+        victim->_hook.unlink();
+        _nr_idle--;
+        _stats.connections_evicted++;
+        http_log.trace("evicting idle connection {}", victim->_fd.local_address());
+        return victim->close().finally([victim] {});
+    }
+    return make_ready_future<>();
 }
 
 future<> client::close() {
@@ -249,13 +343,20 @@ future<> client::close() {
     }
 
     connection_ptr con = _pool.front().shared_from_this();
-    _pool.pop_front();
+    con->_hook.unlink();
+    _nr_idle--;
     http_log.trace("closing connection {}", con->_fd.local_address());
     return con->close().then([this, con] {
         return close();
     });
 }
 
+client::stats client::get_stats() const noexcept {
+    stats ret = _stats;
+    ret.idle_connections = _nr_idle;
+    return ret;
+}
+
 } // experimental namespace
 } // http namespace
 } // seastar namespace
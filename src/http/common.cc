@@ -21,6 +21,8 @@
 
 #include <seastar/http/common.hh>
 #include <seastar/core/iostream-impl.hh>
+#include <seastar/core/print.hh>
+#include <ctime>
 
 namespace seastar {
 
@@ -181,6 +183,34 @@ output_stream<char> make_http_content_length_output_stream(output_stream<char>&
     return output_stream<char>(http_content_length_data_sink(out, len), default_body_sink_buffer_size, opts);
 }
 
+const sstring& http_date() {
+    struct cached_date {
+        time_t when = 0;
+        sstring value;
+    };
+    static thread_local cached_date cache;
+    auto t = ::time(nullptr);
+    if (t != cache.when) {
+        struct tm tm;
+        gmtime_r(&t, &tm);
+        // Using strftime() would have been easier, but unfortunately relies
+        // on the current locale, and we need the month and day names in
+        // English.
+        static const char* days[] = {
+            "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"
+        };
+        static const char* months[] = {
+            "Jan", "Feb", "Mar", "Apr", "May", "Jun",
+            "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
+        };
+        cache.value = seastar::format("{}, {:02d} {} {} {:02d}:{:02d}:{:02d} GMT",
+            days[tm.tm_wday], tm.tm_mday, months[tm.tm_mon], 1900 + tm.tm_year,
+            tm.tm_hour, tm.tm_min, tm.tm_sec);
+        cache.when = t;
+    }
+    return cache.value;
+}
+
 }
 }
 
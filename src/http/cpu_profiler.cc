@@ -0,0 +1,140 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB
+ */
+
+#include <seastar/http/cpu_profiler.hh>
+#include <seastar/http/exception.hh>
+#include <seastar/http/function_handlers.hh>
+#include <seastar/core/loop.hh>
+#include <seastar/core/map_reduce.hh>
+#include <seastar/core/print.hh>
+#include <seastar/core/reactor.hh>
+#include <seastar/core/smp.hh>
+#include <seastar/json/formatter.hh>
+#include <seastar/util/log.hh>
+#include <boost/lexical_cast.hpp>
+#include <optional>
+#include <sstream>
+
+namespace seastar {
+
+namespace httpd {
+
+// Formats the local shard's collected samples as one JSON object. Run on
+// the owning shard, so the samples need not survive a cross-shard hop.
+static sstring format_local_traces() {
+    std::vector<seastar::internal::cpu_profiler_trace> traces;
+    auto dropped = engine().drain_cpu_profiler_traces(traces);
+    std::ostringstream os;
+    os << "{\"shard\":" << this_shard_id() << ",\"dropped\":" << dropped << ",\"samples\":[";
+    const char* delimiter = "";
+    for (auto& t : traces) {
+        auto ts = std::chrono::duration_cast<std::chrono::milliseconds>(t.timestamp.time_since_epoch()).count();
+        os << delimiter << "{\"timestamp_ms\":" << ts
+           << ",\"scheduling_group\":" << json::formatter::to_json(t.sg.name())
+           << ",\"task\":" << json::formatter::to_json(pretty_type_name(*t.task_type)) << "}";
+        delimiter = ",";
+    }
+    os << "]}";
+    return sstring(os.str());
+}
+
+static future<json::json_return_type> get_traces() {
+    return map_reduce(smp::all_cpus(), [] (shard_id shard) {
+        return smp::submit_to(shard, [] {
+            return format_local_traces();
+        });
+    }, sstring(), [] (sstring acc, sstring shard_object) {
+        return acc.empty() ? std::move(shard_object) : acc + "," + shard_object;
+    }).then([] (sstring body) {
+        // The shard objects are already serialized; write them verbatim
+        // instead of going through the formatter, which would escape them
+        std::function<future<>(output_stream<char>&&)> writer = [body = std::move(body)] (output_stream<char>&& s) mutable {
+            return do_with(output_stream<char>(std::move(s)), std::move(body), [] (output_stream<char>& s, const sstring& body) {
+                return s.write("[").then([&s, &body] {
+                    return s.write(body);
+                }).then([&s] {
+                    return s.write("]");
+                }).finally([&s] {
+                    return s.close();
+                });
+            });
+        };
+        return json::json_return_type(std::move(writer));
+    });
+}
+
+template <typename T>
+static std::optional<T> parse_param(const http::request& req, const sstring& name) {
+    auto val = req.get_query_param(name);
+    if (val.empty()) {
+        return std::nullopt;
+    }
+    try {
+        if constexpr (std::is_same_v<T, bool>) {
+            if (val == "true") {
+                return true;
+            }
+            if (val == "false") {
+                return false;
+            }
+            throw std::invalid_argument(val);
+        } else {
+            return boost::lexical_cast<T>(val);
+        }
+    } catch (...) {
+        throw bad_param_exception(format("invalid value for parameter {}: {}", name, val));
+    }
+}
+
+static future<json::json_return_type> set_config(std::unique_ptr<http::request> req) {
+    auto enabled = parse_param<bool>(*req, "enabled");
+    auto period = parse_param<uint64_t>(*req, "period");
+    auto capacity = parse_param<size_t>(*req, "capacity");
+    return smp::invoke_on_all([enabled, period, capacity] {
+        auto cfg = engine().get_cpu_profiler_config();
+        cfg.enabled = enabled.value_or(cfg.enabled);
+        cfg.period = period.value_or(cfg.period);
+        cfg.capacity = capacity.value_or(cfg.capacity);
+        engine().set_cpu_profiler_config(std::move(cfg));
+    }).then([] {
+        return json::json_return_type(json::json_void());
+    });
+}
+
+future<> add_cpu_profiler_routes(http_server& server, sstring route) {
+    server._routes.put(GET, route, new function_handler([] (std::unique_ptr<http::request> req) {
+        return get_traces();
+    }));
+    server._routes.put(POST, route, new function_handler([] (std::unique_ptr<http::request> req) {
+        return set_config(std::move(req));
+    }));
+    return make_ready_future<>();
+}
+
+future<> add_cpu_profiler_routes(distributed<http_server>& server, sstring route) {
+    return server.invoke_on_all([route] (http_server& s) {
+        return add_cpu_profiler_routes(s, route);
+    });
+}
+
+}
+
+}
@@ -38,6 +38,7 @@
 #include <seastar/http/httpd.hh>
 #include <seastar/http/internal/content_source.hh>
 #include <seastar/http/reply.hh>
+#include <seastar/http/transformers.hh>
 #include <seastar/util/short_streams.hh>
 #include <seastar/util/log.hh>
 
@@ -140,6 +141,7 @@ future<> connection::start_response() {
 connection::~connection() {
     --_server._current_connections;
     _server._connections.erase(_server._connections.iterator_to(*this));
+    _server.update_load();
 }
 
 void connection::on_new_connection() {
@@ -147,6 +149,7 @@ void connection::on_new_connection() {
     ++_server._current_connections;
     _fd.set_nodelay(true);
     _server._connections.push_back(*this);
+    _server.update_load();
 }
 
 future<> connection::read() {
@@ -254,8 +257,16 @@ future<> connection::read_one() {
         };
 
         return maybe_reply_continue().then([this] (std::unique_ptr<http::request> req) {
-            return do_with(make_content_stream(req.get(), _read_buf), sstring(req->_version), std::move(req), [this] (input_stream<char>& content_stream, sstring& version, std::unique_ptr<http::request>& req) {
-                return set_request_content(std::move(req), &content_stream, _server.get_content_streaming()).then([this, &content_stream] (std::unique_ptr<http::request> req) {
+            bool streaming = _server.get_content_streaming();
+            if (!streaming) {
+                // Let the matched handler opt in to content streaming for this
+                // request, so large-upload endpoints can avoid accumulating the
+                // body even when the server-wide streaming mode is off.
+                handler_base* handler = _server._routes.get_handler(*req);
+                streaming = handler != nullptr && handler->is_content_streamed(*req);
+            }
+            return do_with(make_content_stream(req.get(), _read_buf), sstring(req->_version), std::move(req), [this, streaming] (input_stream<char>& content_stream, sstring& version, std::unique_ptr<http::request>& req) {
+                return set_request_content(std::move(req), &content_stream, streaming).then([this, &content_stream] (std::unique_ptr<http::request> req) {
                     return _replies.not_full().then([this, req = std::move(req)] () mutable {
                         return generate_reply(std::move(req));
                     }).then([this, &content_stream](bool done) {
@@ -331,7 +342,35 @@ future<> connection::write_body() {
 
 void connection::set_headers(http::reply& resp) {
     resp._headers["Server"] = "Seastar httpd";
-    resp._headers["Date"] = _server._date;
+    resp._headers["Date"] = http::internal::http_date();
+}
+
+void connection::maybe_compress_reply(http::reply& rep, const sstring& accept_encoding) {
+    if (!rep.get_header("Content-Encoding").empty()) {
+        // The handler produced pre-encoded content
+        return;
+    }
+    if (!http::internal::accept_encoding_allows(accept_encoding, "zstd")) {
+        return;
+    }
+    if (rep._body_writer) {
+        rep._body_writer = [inner = std::move(rep._body_writer)] (output_stream<char>&& out) mutable {
+            return inner(http::internal::make_zstd_compressing_output_stream(std::move(out)));
+        };
+    } else {
+        // Below this size the frame overhead eats the savings
+        static constexpr size_t min_compress_size = 256;
+        if (rep._content.size() < min_compress_size) {
+            return;
+        }
+        auto compressed = http::internal::zstd_compress_oneshot(rep._content);
+        if (!compressed) {
+            return;
+        }
+        rep._content = std::move(*compressed);
+    }
+    rep.add_header("Content-Encoding", "zstd");
+    rep.add_header("Vary", "Accept-Encoding");
 }
 
 future<bool> connection::generate_reply(std::unique_ptr<http::request> req) {
@@ -345,9 +384,13 @@ future<bool> connection::generate_reply(std::unique_ptr<http::request> req) {
 
     sstring url = req->parse_query_param();
     sstring version = req->_version;
+    sstring accept_encoding = _server.get_content_compression() ? req->get_header("Accept-Encoding") : sstring();
     return _server._routes.handle(url, std::move(req), std::move(resp)).
     // Caller guarantees enough room
-    then([this, keep_alive , version = std::move(version)](std::unique_ptr<http::reply> rep) {
+    then([this, keep_alive , version = std::move(version), accept_encoding = std::move(accept_encoding)](std::unique_ptr<http::reply> rep) {
+        if (!accept_encoding.empty()) {
+            maybe_compress_reply(*rep, accept_encoding);
+        }
         rep->set_version(version).done();
         this->_replies.push(std::move(rep));
         return make_ready_future<bool>(!keep_alive);
@@ -374,6 +417,14 @@ void http_server::set_content_streaming(bool b) {
     _content_streaming = b;
 }
 
+bool http_server::get_content_compression() const {
+    return _content_compression;
+}
+
+void http_server::set_content_compression(bool b) {
+    _content_compression = b;
+}
+
 future<> http_server::listen(socket_address addr, listen_options lo,
             shared_ptr<seastar::tls::server_credentials> listener_credentials) {
     if (listener_credentials) {
@@ -400,7 +451,35 @@ future<> http_server::listen(socket_address addr) {
     lo.reuse_address = true;
     return listen(addr, lo);
 }
+void http_server::publish_load(std::atomic<unsigned>& slot) {
+    if (std::exchange(_load_slot, &slot) != nullptr) {
+        // already publishing, e.g. listening on a second address
+        return;
+    }
+    _requests_sampled = _requests_served;
+    _load_sample_timer.arm_periodic(1s);
+    update_load();
+}
+
+void http_server::update_load() noexcept {
+    if (_load_slot != nullptr) {
+        _load_slot->store(_current_connections + _smoothed_request_rate, std::memory_order_relaxed);
+    }
+}
+
+void http_server::sample_load() {
+    auto served = _requests_served;
+    auto rate = unsigned(served - _requests_sampled);
+    _requests_sampled = served;
+    // exponential moving average, so a momentarily idle shard does not
+    // immediately attract a whole burst of new connections
+    _smoothed_request_rate = (_smoothed_request_rate + rate) / 2;
+    update_load();
+}
+
 future<> http_server::stop() {
+    _load_sample_timer.cancel();
+    _load_slot = nullptr;
     future<> tasks_done = _task_gate.close();
     for (auto&& l : _listeners) {
         l.abort_accept();
@@ -459,25 +538,8 @@ uint64_t http_server::reply_errors() const {
     return _respond_errors;
 }
 
-// Write the current date in the specific "preferred format" defined in
-// RFC 7231, Section 7.1.1.1, a.k.a. IMF (Internet Message Format) fixdate.
-// For example: Sun, 06 Nov 1994 08:49:37 GMT
 sstring http_server::http_date() {
-    auto t = ::time(nullptr);
-    struct tm tm;
-    gmtime_r(&t, &tm);
-    // Using strftime() would have been easier, but unfortunately relies on
-    // the current locale, and we need the month and day names in English.
-    static const char* days[] = {
-        "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"
-    };
-    static const char* months[] = {
-        "Jan", "Feb", "Mar", "Apr", "May", "Jun",
-        "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
-    };
-    return seastar::format("{}, {:02d} {} {} {:02d}:{:02d}:{:02d} GMT",
-        days[tm.tm_wday], tm.tm_mday, months[tm.tm_mon], 1900 + tm.tm_year,
-        tm.tm_hour, tm.tm_min, tm.tm_sec);
+    return http::internal::http_date();
 }
 
 
@@ -495,20 +557,56 @@ future<> http_server_control::set_routes(std::function<void(routes& r)> fun) {
     });
 }
 
+// Have every server publish its load figure into a slot of the shared
+// per-shard table and install a hint reading the table into lo, so the
+// listening shard dispatches new connections to the shard that is
+// genuinely least loaded rather than the one with fewest connections.
+future<> http_server_control::publish_shard_load(listen_options& lo) {
+    if (lo.lba != server_socket::load_balancing_algorithm::connection_distribution || lo.shard_load_hint) {
+        return make_ready_future<>();
+    }
+    bool first = !_shard_load;
+    if (first) {
+        _shard_load = std::make_unique<std::atomic<unsigned>[]>(smp::count);
+    }
+    lo.shard_load_hint = [table = _shard_load.get()] (unsigned shard) {
+        return table[shard].load(std::memory_order_relaxed);
+    };
+    if (!first) {
+        // the servers are already publishing for an earlier listener
+        return make_ready_future<>();
+    }
+    return _server_dist->invoke_on_all([table = _shard_load.get()] (http_server& server) {
+        server.publish_load(table[this_shard_id()]);
+    });
+}
+
 future<> http_server_control::listen(socket_address addr) {
-    return _server_dist->invoke_on_all<future<> (http_server::*)(socket_address)>(&http_server::listen, addr);
+    listen_options lo;
+    lo.reuse_address = true;
+    return listen(addr, lo);
 }
 
 future<> http_server_control::listen(socket_address addr, shared_ptr<seastar::tls::server_credentials> credentials) {
-    return _server_dist->invoke_on_all<future<> (http_server::*)(socket_address, shared_ptr<seastar::tls::server_credentials>)>(&http_server::listen, addr, credentials);
+    listen_options lo;
+    lo.reuse_address = true;
+    return listen(addr, lo, credentials);
 }
 
 future<> http_server_control::listen(socket_address addr, listen_options lo) {
-    return _server_dist->invoke_on_all<future<> (http_server::*)(socket_address, listen_options)>(&http_server::listen, addr, lo);
+    return do_with(std::move(lo), [this, addr] (listen_options& lo) {
+        return publish_shard_load(lo).then([this, addr, &lo] {
+            return _server_dist->invoke_on_all<future<> (http_server::*)(socket_address, listen_options)>(&http_server::listen, addr, lo);
+        });
+    });
 }
 
 future<> http_server_control::listen(socket_address addr, listen_options lo, shared_ptr<seastar::tls::server_credentials> credentials) {
-    return _server_dist->invoke_on_all<future<> (http_server::*)(socket_address, listen_options, shared_ptr<seastar::tls::server_credentials>)>(&http_server::listen, addr, lo, credentials);
+    return do_with(std::move(lo), [this, addr, credentials] (listen_options& lo) {
+        return publish_shard_load(lo).then([this, addr, &lo, credentials] {
+            return _server_dist->invoke_on_all<future<> (http_server::*)(socket_address, listen_options, shared_ptr<seastar::tls::server_credentials>)>(&http_server::listen, addr, lo, credentials);
+        });
+    });
 }
 
 distributed<http_server>& http_server_control::server() {
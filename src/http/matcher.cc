@@ -62,7 +62,9 @@ size_t param_matcher::match(const sstring& url, size_t ind, parameters& param) {
 }
 
 size_t str_matcher::match(const sstring& url, size_t ind, parameters& param) {
-    if (url.length() >= _len + ind && (url.find(_cmp, ind) == ind)
+    // compare in place instead of find(), which would scan the rest of the
+    // url looking for a match further away only to reject it
+    if (url.length() >= _len + ind && url.compare(ind, _len, _cmp) == 0
             && (url.length() == _len + ind || url.at(_len + ind) == '/')) {
         return _len + ind;
     }
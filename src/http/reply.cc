@@ -34,6 +34,9 @@
 #include <seastar/http/common.hh>
 #include <seastar/http/response_parser.hh>
 #include <seastar/core/loop.hh>
+#include <algorithm>
+#include <string_view>
+#include <unordered_map>
 
 namespace seastar {
 
@@ -41,135 +44,65 @@ namespace http {
 
 namespace status_strings {
 
-const sstring continue_ = "100 Continue";
-const sstring switching_protocols = "101 Switching Protocols";
-const sstring ok = "200 OK";
-const sstring created = "201 Created";
-const sstring accepted = "202 Accepted";
-const sstring nonauthoritative_information = "203 Non-Authoritative Information";
-const sstring no_content = "204 No Content";
-const sstring reset_content = "205 Reset Content";
-const sstring partial_content = "206 Partial Content";
-const sstring multiple_choices = "300 Multiple Choices";
-const sstring moved_permanently = "301 Moved Permanently";
-const sstring moved_temporarily = "302 Moved Temporarily";
-const sstring see_other = "303 See Other";
-const sstring not_modified = "304 Not Modified";
-const sstring use_proxy = "305 Use Proxy";
-const sstring temporary_redirect = "307 Temporary Redirect";
-const sstring bad_request = "400 Bad Request";
-const sstring unauthorized = "401 Unauthorized";
-const sstring payment_required = "402 Payment Required";
-const sstring forbidden = "403 Forbidden";
-const sstring not_found = "404 Not Found";
-const sstring method_not_allowed = "405 Method Not Allowed";
-const sstring not_acceptable = "406 Not Acceptable";
-const sstring request_timeout = "408 Request Timeout";
-const sstring conflict = "409 Conflict";
-const sstring gone = "410 Gone";
-const sstring length_required = "411 Length Required";
-const sstring payload_too_large = "413 Payload Too Large";
-const sstring uri_too_long = "414 URI Too Long";
-const sstring unsupported_media_type = "415 Unsupported Media Type";
-const sstring expectation_failed = "417 Expectation Failed";
-const sstring unprocessable_entity = "422 Unprocessable Entity";
-const sstring upgrade_required = "426 Upgrade Required";
-const sstring too_many_requests = "429 Too Many Requests";
-const sstring internal_server_error = "500 Internal Server Error";
-const sstring not_implemented = "501 Not Implemented";
-const sstring bad_gateway = "502 Bad Gateway";
-const sstring service_unavailable = "503 Service Unavailable";
-const sstring gateway_timeout = "504 Gateway Timeout";
-const sstring http_version_not_supported = "505 HTTP Version Not Supported";
-const sstring insufficient_storage = "507 Insufficient Storage";
-
-static const sstring& to_string(reply::status_type status) {
-    switch (status) {
-    case reply::status_type::continue_:
-        return continue_;
-    case reply::status_type::switching_protocols:
-        return switching_protocols;
-    case reply::status_type::ok:
-        return ok;
-    case reply::status_type::created:
-        return created;
-    case reply::status_type::accepted:
-        return accepted;
-    case reply::status_type::nonauthoritative_information:
-        return nonauthoritative_information;
-    case reply::status_type::no_content:
-        return no_content;
-    case reply::status_type::reset_content:
-        return reset_content;
-    case reply::status_type::partial_content:
-        return partial_content;
-    case reply::status_type::multiple_choices:
-        return multiple_choices;
-    case reply::status_type::moved_permanently:
-        return moved_permanently;
-    case reply::status_type::moved_temporarily:
-        return moved_temporarily;
-    case reply::status_type::see_other:
-        return see_other;
-    case reply::status_type::not_modified:
-        return not_modified;
-    case reply::status_type::use_proxy:
-        return use_proxy;
-    case reply::status_type::temporary_redirect:
-        return temporary_redirect;
-    case reply::status_type::bad_request:
-        return bad_request;
-    case reply::status_type::unauthorized:
-        return unauthorized;
-    case reply::status_type::payment_required:
-        return payment_required;
-    case reply::status_type::forbidden:
-        return forbidden;
-    case reply::status_type::not_found:
-        return not_found;
-    case reply::status_type::method_not_allowed:
-        return method_not_allowed;
-    case reply::status_type::not_acceptable:
-        return not_acceptable;
-    case reply::status_type::request_timeout:
-        return request_timeout;
-    case reply::status_type::conflict:
-        return conflict;
-    case reply::status_type::gone:
-        return gone;
-    case reply::status_type::length_required:
-        return length_required;
-    case reply::status_type::payload_too_large:
-        return payload_too_large;
-    case reply::status_type::uri_too_long:
-        return uri_too_long;
-    case reply::status_type::unsupported_media_type:
-        return unsupported_media_type;
-    case reply::status_type::expectation_failed:
-        return expectation_failed;
-    case reply::status_type::unprocessable_entity:
-        return unprocessable_entity;
-    case reply::status_type::upgrade_required:
-        return upgrade_required;
-    case reply::status_type::too_many_requests:
-        return too_many_requests;
-    case reply::status_type::internal_server_error:
-        return internal_server_error;
-    case reply::status_type::not_implemented:
-        return not_implemented;
-    case reply::status_type::bad_gateway:
-        return bad_gateway;
-    case reply::status_type::service_unavailable:
-        return service_unavailable;
-    case reply::status_type::gateway_timeout:
-        return gateway_timeout;
-    case reply::status_type::http_version_not_supported:
-        return http_version_not_supported;
-    case reply::status_type::insufficient_storage:
-        return insufficient_storage;
-    default:
-        return internal_server_error;
+// Pre-rendered "<code> <reason>" text for every standard status: a
+// constexpr table of string_views needs no construction at startup and
+// no allocation or branching on the formatting path.
+struct entry {
+    int code;
+    std::string_view text;
+};
+
+static constexpr entry entries[] = {
+    {100, "100 Continue"},
+    {101, "101 Switching Protocols"},
+    {200, "200 OK"},
+    {201, "201 Created"},
+    {202, "202 Accepted"},
+    {203, "203 Non-Authoritative Information"},
+    {204, "204 No Content"},
+    {205, "205 Reset Content"},
+    {206, "206 Partial Content"},
+    {300, "300 Multiple Choices"},
+    {301, "301 Moved Permanently"},
+    {302, "302 Moved Temporarily"},
+    {303, "303 See Other"},
+    {304, "304 Not Modified"},
+    {305, "305 Use Proxy"},
+    {307, "307 Temporary Redirect"},
+    {400, "400 Bad Request"},
+    {401, "401 Unauthorized"},
+    {402, "402 Payment Required"},
+    {403, "403 Forbidden"},
+    {404, "404 Not Found"},
+    {405, "405 Method Not Allowed"},
+    {406, "406 Not Acceptable"},
+    {408, "408 Request Timeout"},
+    {409, "409 Conflict"},
+    {410, "410 Gone"},
+    {411, "411 Length Required"},
+    {413, "413 Payload Too Large"},
+    {414, "414 URI Too Long"},
+    {415, "415 Unsupported Media Type"},
+    {417, "417 Expectation Failed"},
+    {422, "422 Unprocessable Entity"},
+    {426, "426 Upgrade Required"},
+    {429, "429 Too Many Requests"},
+    {500, "500 Internal Server Error"},
+    {501, "501 Not Implemented"},
+    {502, "502 Bad Gateway"},
+    {503, "503 Service Unavailable"},
+    {504, "504 Gateway Timeout"},
+    {505, "505 HTTP Version Not Supported"},
+    {507, "507 Insufficient Storage"},
+};
+
+static constexpr std::string_view to_string(reply::status_type status) noexcept {
+    for (auto& e : entries) {
+        if (e.code == int(status)) {
+            return e.text;
+        }
     }
+    return "500 Internal Server Error";
 }
 } // namespace status_strings
 
@@ -187,7 +120,24 @@ reply::reply(http_response&& resp)
 }
 
 sstring reply::response_line() {
-    return "HTTP/" + _version + " " + status_strings::to_string(_status) + "\r\n";
+    // Responses use the same handful of status lines over and over, so keep
+    // the rendered form per (version, status) instead of re-concatenating it
+    // on every response.
+    static thread_local std::unordered_map<int, sstring> v10_lines;
+    static thread_local std::unordered_map<int, sstring> v11_lines;
+    std::unordered_map<int, sstring>* cache = nullptr;
+    if (_version == "1.1") {
+        cache = &v11_lines;
+    } else if (_version == "1.0") {
+        cache = &v10_lines;
+    } else {
+        return seastar::format("HTTP/{} {}\r\n", _version, status_strings::to_string(_status));
+    }
+    auto [it, inserted] = cache->try_emplace(int(_status));
+    if (inserted) {
+        it->second = seastar::format("HTTP/{} {}\r\n", _version, status_strings::to_string(_status));
+    }
+    return it->second;
 }
 
 void reply::write_body(const sstring& content_type, noncopyable_function<future<>(output_stream<char>&&)>&& body_writer) {
@@ -213,9 +163,23 @@ future<> reply::write_reply_to_connection(httpd::connection& con) {
 }
 
 future<> reply::write_reply_headers(httpd::connection& con) {
-    return do_for_each(_headers, [&con](auto& h) {
-        return con.out().write(h.first + ": " + h.second + "\r\n");
-    });
+    // Render the whole header block into a single buffer: writing each header
+    // on its own costs several small allocations and a stream call per header.
+    size_t size = 0;
+    for (auto& h : _headers) {
+        size += h.first.size() + h.second.size() + 4; // ": " and "\r\n"
+    }
+    sstring block = uninitialized_string(size);
+    char* p = block.data();
+    for (auto& h : _headers) {
+        p = std::copy_n(h.first.data(), h.first.size(), p);
+        *p++ = ':';
+        *p++ = ' ';
+        p = std::copy_n(h.second.data(), h.second.size(), p);
+        *p++ = '\r';
+        *p++ = '\n';
+    }
+    return con.out().write(std::move(block));
 }
 
 }
@@ -26,6 +26,86 @@
 namespace seastar {
 namespace http {
 
+void request::borrowed_header_table::rehash() {
+    auto old = std::exchange(_slots, std::vector<entry>(std::max<size_t>(_slots.size() * 2, 16)));
+    auto mask = _slots.size() - 1;
+    for (auto& e : old) {
+        if (!e.name.data()) {
+            continue;
+        }
+        auto i = case_insensitive_hash()(e.name) & mask;
+        while (_slots[i].name.data()) {
+            i = (i + 1) & mask;
+        }
+        _slots[i] = e;
+    }
+}
+
+bool request::borrowed_header_table::insert(std::string_view name, std::string_view value) {
+    if ((_size + 1) * 4 > _slots.size() * 3) {
+        rehash();
+    }
+    auto mask = _slots.size() - 1;
+    auto i = case_insensitive_hash()(name) & mask;
+    while (_slots[i].name.data()) {
+        if (case_insensitive_cmp()(_slots[i].name, name)) {
+            return false;
+        }
+        i = (i + 1) & mask;
+    }
+    _slots[i] = entry{name, value};
+    ++_size;
+    return true;
+}
+
+const std::string_view* request::borrowed_header_table::find(std::string_view name) const noexcept {
+    if (!_size) {
+        return nullptr;
+    }
+    auto mask = _slots.size() - 1;
+    auto i = case_insensitive_hash()(name) & mask;
+    while (_slots[i].name.data()) {
+        if (case_insensitive_cmp()(_slots[i].name, name)) {
+            return &_slots[i].value;
+        }
+        i = (i + 1) & mask;
+    }
+    return nullptr;
+}
+
+std::optional<std::string_view> request::borrowed_header_table::extract(std::string_view name) {
+    if (!_size) {
+        return std::nullopt;
+    }
+    auto mask = _slots.size() - 1;
+    auto i = case_insensitive_hash()(name) & mask;
+    while (_slots[i].name.data()) {
+        if (case_insensitive_cmp()(_slots[i].name, name)) {
+            auto value = _slots[i].value;
+            // Backward-shift deletion: pull up entries whose probe chain
+            // passes through the vacated slot, so lookups never need
+            // tombstones.
+            auto j = i;
+            while (true) {
+                j = (j + 1) & mask;
+                if (!_slots[j].name.data()) {
+                    break;
+                }
+                auto home = case_insensitive_hash()(_slots[j].name) & mask;
+                if ((j > i) ? (home <= i || home > j) : (home <= i && home > j)) {
+                    _slots[i] = _slots[j];
+                    i = j;
+                }
+            }
+            _slots[i] = entry{};
+            --_size;
+            return value;
+        }
+        i = (i + 1) & mask;
+    }
+    return std::nullopt;
+}
+
 sstring request::format_url() const {
     sstring query = "";
     sstring delim = "?";
@@ -51,7 +51,10 @@ action store_version {
 }
 
 action store_field_name {
-    _field_name = str();
+    if (!borrow(_field_name_view)) {
+        _field_name = str();
+        _field_name_view = {};
+    }
 }
 
 action store_value {
@@ -59,28 +62,24 @@ action store_value {
 }
 
 action trim_trailing_whitespace_and_store_value {
-    _value = str();
-    trim_trailing_spaces_and_tabs(_value);
+    if (borrow(_value_view)) {
+        while (!_value_view.empty() && (_value_view.back() == ' ' || _value_view.back() == '\t')) {
+            _value_view.remove_suffix(1);
+        }
+    } else {
+        _value = str();
+        trim_trailing_spaces_and_tabs(_value);
+        _value_view = {};
+    }
     g.mark_start(nullptr);
 }
 
 action assign_field {
-    auto [iter, inserted] = _req->_headers.try_emplace(_field_name, std::move(_value));
-    if (!inserted) {
-        // RFC 7230, section 3.2.2.  Field Parsing:
-        // A recipient MAY combine multiple header fields with the same field name into one
-        // "field-name: field-value" pair, without changing the semantics of the message,
-        // by appending each subsequent field value to the combined field value in order, separated by a comma.
-        iter->second += sstring(",") + std::move(_value);
-    }
+    do_assign_field();
 }
 
 action extend_field  {
-    // RFC 7230, section 3.2.4.  Field Order:
-    // A server that receives an obs-fold in a request message that is not
-    // within a message/http container MUST either reject the message [...]
-    // or replace each received obs-fold with one or more SP octets [...]
-    _req->_headers[_field_name] += sstring(" ") + std::move(_value);
+    do_extend_field();
 }
 
 action done {
@@ -132,17 +131,108 @@ public:
     std::unique_ptr<http::request> _req;
     sstring _field_name;
     sstring _value;
-    state _state;
+    std::string_view _field_name_view;
+    std::string_view _value_view;
+    bool _borrow_headers = false;
+private:
+    bool headers_contain(std::string_view name) const {
+#if __cplusplus >= 202002L
+        return _req->_headers.find(name) != _req->_headers.end();
+#else
+        // unordered containers have no heterogeneous lookup before C++20
+        return _req->_headers.find(sstring(name.data(), name.size())) != _req->_headers.end();
+#endif
+    }
+    void do_assign_field() {
+        if (_field_name_view.data() && _value_view.data()
+                && !headers_contain(_field_name_view)
+                && _req->borrowed_headers.insert(_field_name_view, _value_view)) {
+            // Both spans were borrowed from retained buffers and the name is
+            // new — nothing to copy. _field_name_view stays valid in case an
+            // obs-fold continuation line follows.
+            _value_view = {};
+            return;
+        }
+        // A span crossed a buffer boundary, or the field name repeats, so
+        // the header has to be materialized into _req->_headers.
+        auto value = _value_view.data() ? sstring(_value_view.data(), _value_view.size()) : std::move(_value);
+        _value_view = {};
+        if (_field_name_view.data()) {
+            _field_name = sstring(_field_name_view.data(), _field_name_view.size());
+            _field_name_view = {};
+        }
+        // RFC 7230, section 3.2.2.  Field Parsing:
+        // A recipient MAY combine multiple header fields with the same field name into one
+        // "field-name: field-value" pair, without changing the semantics of the message,
+        // by appending each subsequent field value to the combined field value in order, separated by a comma.
+        if (auto prev = _req->borrowed_headers.extract(_field_name)) {
+            _req->_headers.emplace(_field_name, sstring(prev->data(), prev->size()) + sstring(",") + std::move(value));
+            return;
+        }
+        auto [iter, inserted] = _req->_headers.try_emplace(_field_name, std::move(value));
+        if (!inserted) {
+            iter->second += sstring(",") + std::move(value);
+        }
+    }
+    void do_extend_field() {
+        // RFC 7230, section 3.2.4.  Field Order:
+        // A server that receives an obs-fold in a request message that is not
+        // within a message/http container MUST either reject the message [...]
+        // or replace each received obs-fold with one or more SP octets [...]
+        auto value = _value_view.data() ? sstring(_value_view.data(), _value_view.size()) : std::move(_value);
+        _value_view = {};
+        if (_field_name_view.data()) {
+            _field_name = sstring(_field_name_view.data(), _field_name_view.size());
+            _field_name_view = {};
+        }
+        if (auto prev = _req->borrowed_headers.extract(_field_name)) {
+            _req->_headers.emplace(_field_name, sstring(prev->data(), prev->size()) + sstring(" ") + std::move(value));
+        } else {
+            _req->_headers[_field_name] += sstring(" ") + std::move(value);
+        }
+    }
 public:
+    state _state;
+
     void init() {
         init_base();
         _req.reset(new http::request());
+        _field_name_view = {};
+        _value_view = {};
         _state = state::eof;
         %% write init;
     }
+    // When enabled, header names and values that are fully contained in one
+    // input buffer are recorded as views into that buffer (which is retained
+    // in request::_header_buffers) and stored in request::borrowed_headers
+    // instead of being copied into request::_headers, making header parsing
+    // allocation-free in the common case. Headers spanning two buffers and
+    // repeated header names are still materialized into request::_headers;
+    // use request::get_header() to search both tables.
+    void set_borrow_headers(bool borrow) {
+        _borrow_headers = borrow;
+    }
+    future<unconsumed_remainder> operator()(temporary_buffer<char> buf) {
+        if (_borrow_headers && _req && !buf.empty()) {
+            // keep the buffer alive for the header views recorded into it;
+            // it travels with the parsed request
+            _req->_header_buffers.emplace_back(buf.share());
+        }
+        return ragel_parser_base::operator()(std::move(buf));
+    }
     char* parse(char* p, char* pe, char* eof) {
         sstring_builder::guard g(_builder, p, pe);
         [[maybe_unused]] auto str = [this, &g, &p] { g.mark_end(p); return get_str(); };
+        // Record the span as a view into the current buffer instead of
+        // copying it; fails when borrowing is off or the span started in an
+        // earlier buffer, in which case the caller falls back to str().
+        [[maybe_unused]] auto borrow = [this, &g, &p] (std::string_view& view) {
+            if (!_borrow_headers || !_builder.contiguous()) {
+                return false;
+            }
+            view = g.borrow(p);
+            return true;
+        };
         bool done = false;
         if (p != pe) {
             _state = state::error;
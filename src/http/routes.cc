@@ -31,6 +31,250 @@ namespace httpd {
 
 using namespace std;
 
+namespace internal {
+
+struct route_trie::node {
+    // Literal url segments (without the leading slash) to child nodes.
+    // The edges are indexed by a perfect-hash table computed at
+    // registration time: a seed is searched for which every segment lands
+    // in a distinct slot, so a lookup is one hash and at most one string
+    // compare, with no per-request allocation.
+    struct child_edge {
+        sstring segment;
+        std::unique_ptr<node> child;
+    };
+    std::vector<child_edge> edges;
+    // power-of-two slots holding edge index + 1; 0 marks an empty slot
+    std::vector<uint32_t> slots;
+    uint64_t seed = 0;
+    // a parameter matching a single url segment
+    std::unique_ptr<node> param_child;
+    sstring param_name;
+    // a parameter matching the remainder of the url
+    sstring remainder_name;
+    handler_base* remainder_handler = nullptr;
+    rule_cookie remainder_cookie = 0;
+    // a rule ending at this node
+    handler_base* handler = nullptr;
+    rule_cookie cookie = 0;
+
+    static uint64_t hash_segment(std::string_view segment, uint64_t seed) noexcept {
+        // seeded FNV-1a
+        uint64_t h = 0xcbf29ce484222325ull ^ seed;
+        for (char c : segment) {
+            h = (h ^ uint8_t(c)) * 0x100000001b3ull;
+        }
+        return h;
+    }
+
+    node* find_child(std::string_view segment) const noexcept {
+        if (edges.empty()) {
+            return nullptr;
+        }
+        auto& slot = slots[hash_segment(segment, seed) & (slots.size() - 1)];
+        if (slot && edges[slot - 1].segment == segment) {
+            return edges[slot - 1].child.get();
+        }
+        return nullptr;
+    }
+
+    node* get_or_add_child(std::string_view segment) {
+        if (auto* child = find_child(segment)) {
+            return child;
+        }
+        edges.push_back(child_edge{sstring(segment.data(), segment.size()), std::make_unique<node>()});
+        rehash();
+        return edges.back().child.get();
+    }
+
+    // Searches for a (size, seed) pair placing every segment in its own
+    // slot. Collisions under the mask are resolved by trying more seeds
+    // and, failing that, a larger table, so the search always terminates
+    // for distinct segments.
+    void rehash() {
+        size_t size = 4;
+        while (size < edges.size() * 2) {
+            size *= 2;
+        }
+        while (true) {
+            for (uint64_t s = 0; s < 64; s++) {
+                slots.assign(size, 0);
+                bool collision = false;
+                for (uint32_t i = 0; i < edges.size() && !collision; i++) {
+                    auto& slot = slots[hash_segment(edges[i].segment, s) & (size - 1)];
+                    collision = slot != 0;
+                    slot = i + 1;
+                }
+                if (!collision) {
+                    seed = s;
+                    return;
+                }
+            }
+            size *= 2;
+        }
+    }
+};
+
+struct route_trie::walk_state {
+    struct capture {
+        const sstring* name;
+        std::string_view value;
+    };
+    capture captures[max_captures];
+    unsigned n_captures = 0;
+    found result;
+};
+
+route_trie::route_trie() = default;
+
+route_trie::~route_trie() = default;
+
+void route_trie::clear() {
+    _root.reset();
+}
+
+bool route_trie::add(rule_cookie cookie, const match_rule& rule) {
+    const auto& matchers = rule.matchers();
+    if (matchers.empty()) {
+        // matches any url, keep it on the generic search path
+        return false;
+    }
+    // flatten the rule into url components, bailing out on anything
+    // the trie cannot represent
+    struct component {
+        std::string_view literal;
+        const param_matcher* param = nullptr;
+    };
+    std::vector<component> components;
+    unsigned n_params = 0;
+    for (size_t i = 0; i < matchers.size(); i++) {
+        if (auto* str = dynamic_cast<const str_matcher*>(matchers[i])) {
+            std::string_view text = str->str();
+            if (text.empty() || text.front() != '/') {
+                return false;
+            }
+            while (!text.empty()) {
+                size_t end = text.find('/', 1);
+                std::string_view seg = text.substr(1, end == std::string_view::npos ? end : end - 1);
+                if (seg.empty()) {
+                    return false;
+                }
+                components.push_back(component{seg, nullptr});
+                text = (end == std::string_view::npos) ? std::string_view() : text.substr(end);
+            }
+        } else if (auto* param = dynamic_cast<const param_matcher*>(matchers[i])) {
+            if (param->entire_path() && i + 1 != matchers.size()) {
+                return false;
+            }
+            if (++n_params > max_captures) {
+                return false;
+            }
+            components.push_back(component{{}, param});
+        } else {
+            return false;
+        }
+    }
+
+    if (!_root) {
+        _root = std::make_unique<node>();
+    }
+    node* n = _root.get();
+    for (const auto& c : components) {
+        if (c.param != nullptr && c.param->entire_path()) {
+            if (n->remainder_handler != nullptr) {
+                // a rule with the same pattern shadows this one, matching
+                // the registration order semantics of the rule list; a
+                // conflicting parameter name cannot share the edge, so
+                // such a rule falls back to the generic search path
+                return n->remainder_name == c.param->name();
+            }
+            n->remainder_name = c.param->name();
+            n->remainder_handler = rule.get_handler();
+            n->remainder_cookie = cookie;
+            return true;
+        }
+        if (c.param != nullptr) {
+            if (!n->param_child) {
+                n->param_name = c.param->name();
+                n->param_child = std::make_unique<node>();
+            } else if (n->param_name != c.param->name()) {
+                // the parameter edge is taken under a different name
+                return false;
+            }
+            n = n->param_child.get();
+        } else {
+            n = n->get_or_add_child(c.literal);
+        }
+    }
+    if (n->handler != nullptr) {
+        // shadowed by a rule with the same pattern, as with the rule list
+        return true;
+    }
+    n->handler = rule.get_handler();
+    n->cookie = cookie;
+    return true;
+}
+
+bool route_trie::descend(const node& n, std::string_view url, size_t pos, walk_state& state) {
+    // a trailing slash is tolerated, as in match_rule::get()
+    if (pos >= url.size() || (pos + 1 == url.size() && url[pos] == '/')) {
+        if (n.handler != nullptr) {
+            state.result = found{n.handler, n.cookie};
+            return true;
+        }
+        if (n.remainder_handler != nullptr && state.n_captures < max_captures) {
+            state.captures[state.n_captures++] = {&n.remainder_name, url.substr(pos)};
+            state.result = found{n.remainder_handler, n.remainder_cookie};
+            return true;
+        }
+        return false;
+    }
+    if (url[pos] != '/') {
+        return false;
+    }
+    size_t end = url.find('/', pos + 1);
+    if (end == std::string_view::npos) {
+        end = url.size();
+    }
+    // a literal segment is preferred over a parameter, a parameter over
+    // a remainder; a failed branch is backtracked
+    if (auto* child = n.find_child(url.substr(pos + 1, end - pos - 1))) {
+        if (descend(*child, url, end, state)) {
+            return true;
+        }
+    }
+    if (n.param_child && state.n_captures < max_captures) {
+        state.captures[state.n_captures++] = {&n.param_name, url.substr(pos, end - pos)};
+        if (descend(*n.param_child, url, end, state)) {
+            return true;
+        }
+        state.n_captures--;
+    }
+    if (n.remainder_handler != nullptr && state.n_captures < max_captures) {
+        state.captures[state.n_captures++] = {&n.remainder_name, url.substr(pos)};
+        state.result = found{n.remainder_handler, n.remainder_cookie};
+        return true;
+    }
+    return false;
+}
+
+route_trie::found route_trie::find(std::string_view url, parameters& params) const {
+    if (!_root) {
+        return found();
+    }
+    walk_state state;
+    if (!descend(*_root, url, 0, state)) {
+        return found();
+    }
+    for (unsigned i = 0; i < state.n_captures; i++) {
+        const auto& c = state.captures[i];
+        params.set(*c.name, sstring(c.value.data(), c.value.size()));
+    }
+    return state.result;
+}
+
+}
+
 void verify_param(const http::request& req, const sstring& param) {
     if (req.get_query_param(param) == "") {
         throw missing_param_exception(param);
@@ -123,6 +367,11 @@ future<std::unique_ptr<http::reply> > routes::handle(const sstring& path, std::u
     return make_ready_future<std::unique_ptr<http::reply>>(std::move(rep));
 }
 
+handler_base* routes::get_handler(http::request& req) {
+    auto url = req._url.substr(0, req._url.find('?'));
+    return get_handler(str2type(req._method), normalize_url(url), req.param);
+}
+
 sstring routes::normalize_url(const sstring& url) {
     if (url.length() < 2 || url.at(url.length() - 1) != '/') {
         return url;
@@ -137,11 +386,29 @@ handler_base* routes::get_handler(operation_type type, const sstring& url,
         return handler;
     }
 
-    for (auto&& rule : _rules[type]) {
+    auto compiled = _trie[type].find(url, params);
+    // rules that did not compile into the trie and were registered before
+    // the compiled match keep their original priority
+    bool dirty = false;
+    for (auto&& rule : _fallback_rules[type]) {
+        if (compiled.handler != nullptr && rule.first > compiled.cookie) {
+            break;
+        }
+        params.clear();
+        dirty = true;
         handler = rule.second->get(url, params);
         if (handler != nullptr) {
             return handler;
         }
+    }
+    if (compiled.handler != nullptr) {
+        if (dirty) {
+            params.clear();
+            _trie[type].find(url, params);
+        }
+        return compiled.handler;
+    }
+    if (dirty) {
         params.clear();
     }
     return _default_handler;
@@ -187,8 +454,35 @@ routes& routes::put(operation_type type, const sstring& url, handler_base* handl
     return *this;
 }
 
+routes::rule_cookie routes::add_cookie(match_rule* rule, operation_type type) {
+    auto pos = _rover++;
+    _rules[type][pos] = rule;
+    if (!_trie[type].add(pos, *rule)) {
+        _fallback_rules[type][pos] = rule;
+    }
+    return pos;
+}
+
+void routes::rebuild_trie(operation_type type) {
+    _trie[type].clear();
+    _fallback_rules[type].clear();
+    for (auto& r : _rules[type]) {
+        if (!_trie[type].add(r.first, *r.second)) {
+            _fallback_rules[type][r.first] = r.second;
+        }
+    }
+}
+
 match_rule* routes::del_cookie(rule_cookie cookie, operation_type type) {
-    return delete_rule_from(type, cookie, _rules);
+    auto rule = delete_rule_from(type, cookie, _rules);
+    if (rule != nullptr) {
+        if (delete_rule_from(type, cookie, _fallback_rules) == nullptr) {
+            // the rule was compiled; rebuild so a pattern it shadowed
+            // becomes reachable again
+            rebuild_trie(type);
+        }
+    }
+    return rule;
 }
 
 void routes::add_alias(const path_description& old_path, const path_description& new_path) {
@@ -24,9 +24,179 @@
 #include <boost/algorithm/string/replace.hpp>
 #include <seastar/http/transformers.hh>
 #include <list>
+#include <zstd.h>
 
 namespace seastar {
 
+namespace http {
+namespace internal {
+
+static constexpr int zstd_compression_level = 3;
+// 128k window: bounds the compressor's per-response memory while still
+// covering typical API reply sizes
+static constexpr int zstd_window_log = 17;
+static constexpr size_t compress_out_chunk_size = 16 * 1024;
+
+namespace {
+
+// Per-shard pool of compression contexts. Context setup costs tens of
+// microseconds; reuse amortizes it to a reset call per response.
+class zstd_cctx_pool {
+    static constexpr size_t max_pooled = 8;
+    std::vector<ZSTD_CCtx*> _pool;
+public:
+    ~zstd_cctx_pool() {
+        for (auto ctx : _pool) {
+            ZSTD_freeCCtx(ctx);
+        }
+    }
+    ZSTD_CCtx* get() {
+        ZSTD_CCtx* ctx;
+        if (!_pool.empty()) {
+            ctx = _pool.back();
+            _pool.pop_back();
+        } else {
+            ctx = ZSTD_createCCtx();
+            if (!ctx) {
+                throw std::bad_alloc();
+            }
+        }
+        ZSTD_CCtx_setParameter(ctx, ZSTD_c_compressionLevel, zstd_compression_level);
+        ZSTD_CCtx_setParameter(ctx, ZSTD_c_windowLog, zstd_window_log);
+        return ctx;
+    }
+    void put(ZSTD_CCtx* ctx) noexcept {
+        ZSTD_CCtx_reset(ctx, ZSTD_reset_session_and_parameters);
+        if (_pool.size() < max_pooled) {
+            _pool.push_back(ctx);
+        } else {
+            ZSTD_freeCCtx(ctx);
+        }
+    }
+};
+
+thread_local zstd_cctx_pool cctx_pool;
+
+struct cctx_returner {
+    void operator()(ZSTD_CCtx* ctx) const noexcept {
+        cctx_pool.put(ctx);
+    }
+};
+
+using pooled_cctx = std::unique_ptr<ZSTD_CCtx, cctx_returner>;
+
+static void check_zstd(size_t res, const char* what) {
+    if (ZSTD_isError(res)) {
+        throw std::runtime_error(format("{}: {}", what, ZSTD_getErrorName(res)));
+    }
+}
+
+class zstd_compress_sink_impl : public data_sink_impl {
+    output_stream<char> _out;
+    pooled_cctx _ctx;
+
+    future<> run(ZSTD_inBuffer in, ZSTD_EndDirective mode) {
+        return repeat([this, in, mode] () mutable {
+            temporary_buffer<char> out(compress_out_chunk_size);
+            ZSTD_outBuffer ob = { out.get_write(), out.size(), 0 };
+            auto res = ZSTD_compressStream2(_ctx.get(), &ob, &in, mode);
+            check_zstd(res, "ZSTD_compressStream2");
+            bool done = mode == ZSTD_e_continue ? in.pos == in.size : res == 0;
+            if (!ob.pos) {
+                return make_ready_future<stop_iteration>(stop_iteration(done));
+            }
+            out.trim(ob.pos);
+            return _out.write(out.get(), out.size()).then([done] {
+                return stop_iteration(done);
+            }).finally([out = std::move(out)] {});
+        });
+    }
+public:
+    explicit zstd_compress_sink_impl(output_stream<char>&& out)
+            : _out(std::move(out))
+            , _ctx(cctx_pool.get()) {
+    }
+    virtual future<> put(net::packet data) override { abort(); }
+    using data_sink_impl::put;
+    virtual future<> put(temporary_buffer<char> buf) override {
+        if (buf.empty()) {
+            return make_ready_future<>();
+        }
+        ZSTD_inBuffer in = { buf.get(), buf.size(), 0 };
+        return run(in, ZSTD_e_continue).finally([buf = std::move(buf)] {});
+    }
+    virtual future<> flush() override {
+        // Flush the compressor too, so that everything written so far can
+        // be decoded by the peer, e.g. for long-polling responses
+        return run({nullptr, 0, 0}, ZSTD_e_flush).then([this] {
+            return _out.flush();
+        });
+    }
+    virtual future<> close() override {
+        return run({nullptr, 0, 0}, ZSTD_e_end).finally([this] {
+            return _out.close();
+        });
+    }
+};
+
+} // anonymous namespace
+
+bool accept_encoding_allows(const sstring& accept_encoding, std::string_view coding) {
+    // A simplified parse of RFC 7231 section 5.3.4: a comma-separated
+    // list of "coding[;q=value]" entries. Order is ignored; an entry for
+    // the coding (or "*") allows it unless its qvalue is 0.
+    std::string_view s(accept_encoding);
+    while (!s.empty()) {
+        auto comma = s.find(',');
+        auto entry = s.substr(0, comma);
+        s = comma == std::string_view::npos ? std::string_view() : s.substr(comma + 1);
+        auto semi = entry.find(';');
+        auto params = semi == std::string_view::npos ? std::string_view() : entry.substr(semi + 1);
+        entry = entry.substr(0, semi);
+        while (!entry.empty() && (entry.front() == ' ' || entry.front() == '\t')) {
+            entry.remove_prefix(1);
+        }
+        while (!entry.empty() && (entry.back() == ' ' || entry.back() == '\t')) {
+            entry.remove_suffix(1);
+        }
+        if (entry != coding && entry != "*") {
+            continue;
+        }
+        auto q = params.find("q=");
+        if (q != std::string_view::npos) {
+            auto value = params.substr(q + 2);
+            if (!value.empty() && value.front() == '0' && value.find_first_of("123456789") == std::string_view::npos) {
+                continue; // q=0 (or 0.0, 0.00...) explicitly refuses this coding
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+output_stream<char> make_zstd_compressing_output_stream(output_stream<char>&& out) {
+    output_stream_options opts;
+    opts.trim_to_size = true;
+    return output_stream<char>(data_sink(std::make_unique<zstd_compress_sink_impl>(std::move(out))), compress_out_chunk_size, opts);
+}
+
+std::optional<sstring> zstd_compress_oneshot(const sstring& content) {
+    auto ctx = pooled_cctx(cctx_pool.get());
+    // No point in a compressed frame that is not smaller than its input;
+    // cap the destination buffer accordingly and let zstd fail the
+    // attempt instead of comparing sizes afterwards
+    sstring dst = uninitialized_string(content.size());
+    auto res = ZSTD_compress2(ctx.get(), dst.data(), dst.size(), content.data(), content.size());
+    if (ZSTD_isError(res)) {
+        return std::nullopt;
+    }
+    dst.resize(res);
+    return dst;
+}
+
+} // internal namespace
+} // http namespace
+
 namespace httpd {
 
 using namespace std;
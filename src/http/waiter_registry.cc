@@ -0,0 +1,93 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB
+ */
+
+#include <seastar/http/waiter_registry.hh>
+#include <seastar/http/function_handlers.hh>
+#include <seastar/core/map_reduce.hh>
+#include <seastar/core/smp.hh>
+#include <seastar/core/waiter_registry.hh>
+#include <seastar/json/formatter.hh>
+#include <sstream>
+
+namespace seastar {
+
+namespace httpd {
+
+// Formats the local shard's waiter registry as one JSON object. Run on
+// the owning shard, since the registry is thread-local.
+static sstring format_local_waiters() {
+    auto entries = dump_waiter_registry();
+    std::ostringstream os;
+    os << "{\"shard\":" << this_shard_id() << ",\"waiters\":[";
+    const char* delimiter = "";
+    for (auto& e : entries) {
+        auto age_ms = std::chrono::duration_cast<std::chrono::milliseconds>(e.oldest_waiter_age).count();
+        os << delimiter << "{\"kind\":" << json::formatter::to_json(e.kind)
+           << ",\"name\":" << json::formatter::to_json(e.name)
+           << ",\"waiters\":" << e.waiters
+           << ",\"oldest_waiter_age_ms\":" << age_ms << "}";
+        delimiter = ",";
+    }
+    os << "]}";
+    return sstring(os.str());
+}
+
+static future<json::json_return_type> get_waiters() {
+    return map_reduce(smp::all_cpus(), [] (shard_id shard) {
+        return smp::submit_to(shard, [] {
+            return format_local_waiters();
+        });
+    }, sstring(), [] (sstring acc, sstring shard_object) {
+        return acc.empty() ? std::move(shard_object) : acc + "," + shard_object;
+    }).then([] (sstring body) {
+        // The shard objects are already serialized; write them verbatim
+        // instead of going through the formatter, which would escape them
+        std::function<future<>(output_stream<char>&&)> writer = [body = std::move(body)] (output_stream<char>&& s) mutable {
+            return do_with(output_stream<char>(std::move(s)), std::move(body), [] (output_stream<char>& s, const sstring& body) {
+                return s.write("[").then([&s, &body] {
+                    return s.write(body);
+                }).then([&s] {
+                    return s.write("]");
+                }).finally([&s] {
+                    return s.close();
+                });
+            });
+        };
+        return json::json_return_type(std::move(writer));
+    });
+}
+
+future<> add_waiter_registry_routes(http_server& server, sstring route) {
+    server._routes.put(GET, route, new function_handler([] (std::unique_ptr<http::request> req) {
+        return get_waiters();
+    }));
+    return make_ready_future<>();
+}
+
+future<> add_waiter_registry_routes(distributed<http_server>& server, sstring route) {
+    return server.invoke_on_all([route] (http_server& s) {
+        return add_waiter_registry_routes(s, route);
+    });
+}
+
+}
+
+}
@@ -110,14 +110,17 @@ public:
      * @param name the name of the element
      * @param str the value already formated
      */
-    future<> add(const string& name, const json_base_element& element) {
+    future<> add(const json_base_element& element) {
         if (!open) {
             open = true;
-            return _s.write(json_builder::OPEN).then([this, &name, &element] {
-                return add(name, element);
+            return _s.write(json_builder::OPEN).then([this, &element] {
+                return add(element);
             });
         }
-        return _s.write(((first)? '"' + name : ",\"" + name) + "\":").then([this, &element] {
+        // The key fragment is precomputed with a leading comma, which the
+        // first field skips, so nothing is formatted per field
+        auto skip = size_t(first);
+        return _s.write(element._key.data() + skip, element._key.size() - skip).then([this, &element] {
             first = false;
             return element.write(_s);
         });
@@ -131,7 +134,7 @@ public:
         if (element == nullptr || element->_set == false) {
             return make_ready_future<>();
         }
-        return add(element->_name, *element);
+        return add(*element);
     }
 
     /**
@@ -154,7 +157,8 @@ const string json_builder::CLOSE("}");
 
 void json_base::add(json_base_element* element, string name, bool mandatory) {
     element->_mandatory = mandatory;
-    element->_name = name;
+    element->_key = ",\"" + name + "\":";
+    element->_name = std::move(name);
     _elements.push_back(element);
 }
 
@@ -0,0 +1,376 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB
+ */
+
+/*
+ * AF_XDP device for the native stack.
+ *
+ * Each shard that owns a hardware queue binds one XSK socket to it. All
+ * packet buffers live in a per-queue UMEM area registered with the
+ * kernel; receive and transmit are ring operations on memory shared with
+ * the driver, so the datapath is syscall-free except for need-wakeup
+ * kicks. Received frames are handed to the stack as zero-copy fragments
+ * pointing into the UMEM, returned to the fill ring when the packet is
+ * destroyed. This is implemented directly on <linux/if_xdp.h> (no libbpf
+ * dependency); attaching an XDP program that redirects traffic to the
+ * sockets is the operator's responsibility (see xdp_options).
+ */
+
+#include <seastar/net/af_xdp.hh>
+#include <seastar/core/posix.hh>
+#include <seastar/core/reactor.hh>
+#include <seastar/core/metrics.hh>
+#include <seastar/net/net.hh>
+#include <seastar/net/packet.hh>
+
+#include <atomic>
+#include <cstring>
+#include <optional>
+#include <vector>
+
+#include <linux/ethtool.h>
+#include <linux/if_xdp.h>
+#include <linux/sockios.h>
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+
+namespace seastar {
+
+namespace net {
+
+namespace {
+
+// A single-producer/single-consumer ring shared with the kernel, in the
+// layout described by xdp_ring_offset. Each instance is used from one
+// side only: fill and tx as producer, rx and completion as consumer.
+template <typename Desc>
+struct xsk_ring {
+    uint32_t* _producer = nullptr;
+    uint32_t* _consumer = nullptr;
+    uint32_t* _flags = nullptr;
+    Desc* _descs = nullptr;
+    uint32_t _size = 0;
+    uint32_t _cached_prod = 0;
+    uint32_t _cached_cons = 0;
+
+    void init(char* map, const xdp_ring_offset& off, uint32_t size) {
+        _producer = reinterpret_cast<uint32_t*>(map + off.producer);
+        _consumer = reinterpret_cast<uint32_t*>(map + off.consumer);
+        _flags = reinterpret_cast<uint32_t*>(map + off.flags);
+        _descs = reinterpret_cast<Desc*>(map + off.desc);
+        _size = size;
+        _cached_prod = __atomic_load_n(_producer, __ATOMIC_RELAXED);
+        _cached_cons = __atomic_load_n(_consumer, __ATOMIC_RELAXED);
+    }
+    Desc& operator[](uint32_t idx) { return _descs[idx & (_size - 1)]; }
+    // producer side
+    uint32_t free_entries() {
+        _cached_cons = __atomic_load_n(_consumer, __ATOMIC_ACQUIRE);
+        return _size - (_cached_prod - _cached_cons);
+    }
+    uint32_t produce_index() const { return _cached_prod; }
+    void advance_producer(uint32_t n) {
+        _cached_prod += n;
+        __atomic_store_n(_producer, _cached_prod, __ATOMIC_RELEASE);
+    }
+    // consumer side
+    uint32_t available() {
+        _cached_prod = __atomic_load_n(_producer, __ATOMIC_ACQUIRE);
+        return _cached_prod - _cached_cons;
+    }
+    uint32_t consume_index() const { return _cached_cons; }
+    void advance_consumer(uint32_t n) {
+        _cached_cons += n;
+        __atomic_store_n(_consumer, _cached_cons, __ATOMIC_RELEASE);
+    }
+    bool needs_wakeup() const {
+        return __atomic_load_n(_flags, __ATOMIC_RELAXED) & XDP_RING_NEED_WAKEUP;
+    }
+};
+
+} // anonymous namespace
+
+class xdp_device;
+
+class xdp_qp : public net::qp {
+    static constexpr size_t frame_size = 2048;
+    static constexpr uint32_t num_frames = 4096;
+    static constexpr uint32_t rx_ring_size = 512;
+    static constexpr uint32_t tx_ring_size = 512;
+    static constexpr uint32_t fill_ring_size = 1024;
+    static constexpr uint32_t comp_ring_size = 512;
+    static constexpr uint32_t rx_budget = 256;
+
+    struct mapping {
+        char* addr = nullptr;
+        size_t len = 0;
+    };
+
+    xdp_device* _dev;
+    file_desc _fd;
+    char* _umem = nullptr;
+    mapping _rx_map, _tx_map, _fill_map, _comp_map;
+    xsk_ring<xdp_desc> _rx, _tx;
+    xsk_ring<uint64_t> _fill, _comp;
+    // Frames neither owned by the kernel (fill/tx rings) nor by a live
+    // packet. rx refill and tx draw from the same pool; under rx pressure
+    // tx may find it empty and drop, which is the right bias for us.
+    std::vector<uint64_t> _free_frames;
+    bool _rx_started = false;
+    std::optional<reactor::poller> _poller;
+
+public:
+    xdp_qp(xdp_device* dev, const sstring& ifname, unsigned ifindex, uint16_t qid, bool force_copy);
+    ~xdp_qp();
+    virtual future<> send(packet p) override;
+    virtual void rx_start() override {
+        _rx_started = true;
+    }
+private:
+    bool poll();
+    void refill_fill_ring();
+    void kick_tx() {
+        if (_tx.needs_wakeup()) {
+            ::sendto(_fd.get(), nullptr, 0, MSG_DONTWAIT, nullptr, 0);
+        }
+    }
+};
+
+class xdp_device : public device {
+    sstring _ifname;
+    unsigned _ifindex;
+    bool _force_copy;
+    uint16_t _hw_queues;
+    ethernet_address _hw_address;
+    net::hw_features _hw_features;
+public:
+    xdp_device(sstring ifname, unsigned requested_queues, bool force_copy)
+        : _ifname(std::move(ifname))
+        , _force_copy(force_copy) {
+        _ifindex = ::if_nametoindex(_ifname.c_str());
+        if (!_ifindex) {
+            throw std::runtime_error(format("AF_XDP: no such interface: {}", _ifname));
+        }
+        auto ctl = file_desc::socket(AF_INET, SOCK_DGRAM);
+        ifreq ifr = {};
+        std::strncpy(ifr.ifr_name, _ifname.c_str(), IFNAMSIZ - 1);
+        throw_system_error_on(::ioctl(ctl.get(), SIOCGIFHWADDR, &ifr) == -1, "SIOCGIFHWADDR");
+        _hw_address = ethernet_address(reinterpret_cast<const uint8_t*>(ifr.ifr_hwaddr.sa_data));
+        // One socket per hardware queue; queues beyond the NIC's channel
+        // count cannot receive anything
+        unsigned channels = 1;
+        ethtool_channels ec = {};
+        ec.cmd = ETHTOOL_GCHANNELS;
+        ifr.ifr_data = reinterpret_cast<char*>(&ec);
+        if (::ioctl(ctl.get(), SIOCETHTOOL, &ifr) == 0) {
+            channels = std::max(ec.combined_count + ec.rx_count, 1u);
+        }
+        _hw_queues = std::min<unsigned>({requested_queues ? requested_queues : channels, channels, smp::count});
+        // No checksum or segmentation offloads on the XDP path; the
+        // interface layer falls back to software gso
+    }
+    virtual ethernet_address hw_address() override {
+        return _hw_address;
+    }
+    virtual net::hw_features hw_features() override {
+        return _hw_features;
+    }
+    virtual uint16_t hw_queues_count() override {
+        return _hw_queues;
+    }
+    virtual std::unique_ptr<net::qp> init_local_queue(const program_options::option_group& opts, uint16_t qid) override {
+        return std::make_unique<xdp_qp>(this, _ifname, _ifindex, qid, _force_copy);
+    }
+};
+
+xdp_qp::xdp_qp(xdp_device* dev, const sstring& ifname, unsigned ifindex, uint16_t qid, bool force_copy)
+    : net::qp(true, "xdp-" + std::string(ifname), qid)
+    , _dev(dev)
+    , _fd(file_desc::socket(AF_XDP, SOCK_RAW)) {
+    constexpr size_t umem_len = size_t(num_frames) * frame_size;
+    auto mem = ::mmap(nullptr, umem_len, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    throw_system_error_on(mem == MAP_FAILED, "mmap(umem)");
+    _umem = static_cast<char*>(mem);
+
+    xdp_umem_reg mr = {};
+    mr.addr = reinterpret_cast<uint64_t>(_umem);
+    mr.len = umem_len;
+    mr.chunk_size = frame_size;
+    _fd.setsockopt(SOL_XDP, XDP_UMEM_REG, mr);
+    _fd.setsockopt(SOL_XDP, XDP_UMEM_FILL_RING, fill_ring_size);
+    _fd.setsockopt(SOL_XDP, XDP_UMEM_COMPLETION_RING, comp_ring_size);
+    _fd.setsockopt(SOL_XDP, XDP_RX_RING, rx_ring_size);
+    _fd.setsockopt(SOL_XDP, XDP_TX_RING, tx_ring_size);
+
+    auto off = _fd.getsockopt<xdp_mmap_offsets>(SOL_XDP, XDP_MMAP_OFFSETS);
+    auto map_ring = [this] (off_t pgoff, const xdp_ring_offset& roff, uint32_t size, size_t desc_size, mapping& m) {
+        m.len = roff.desc + size_t(size) * desc_size;
+        auto p = ::mmap(nullptr, m.len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd.get(), pgoff);
+        throw_system_error_on(p == MAP_FAILED, "mmap(xsk ring)");
+        m.addr = static_cast<char*>(p);
+        return m.addr;
+    };
+    _rx.init(map_ring(XDP_PGOFF_RX_RING, off.rx, rx_ring_size, sizeof(xdp_desc), _rx_map), off.rx, rx_ring_size);
+    _tx.init(map_ring(XDP_PGOFF_TX_RING, off.tx, tx_ring_size, sizeof(xdp_desc), _tx_map), off.tx, tx_ring_size);
+    _fill.init(map_ring(XDP_UMEM_PGOFF_FILL_RING, off.fr, fill_ring_size, sizeof(uint64_t), _fill_map), off.fr, fill_ring_size);
+    _comp.init(map_ring(XDP_UMEM_PGOFF_COMPLETION_RING, off.cr, comp_ring_size, sizeof(uint64_t), _comp_map), off.cr, comp_ring_size);
+
+    sockaddr_xdp sa = {};
+    sa.sxdp_family = AF_XDP;
+    sa.sxdp_ifindex = ifindex;
+    sa.sxdp_queue_id = qid;
+    auto try_bind = [&] (uint16_t flags) {
+        sa.sxdp_flags = flags;
+        return ::bind(_fd.get(), reinterpret_cast<sockaddr*>(&sa), sizeof(sa));
+    };
+    int r = -1;
+    if (!force_copy) {
+        r = try_bind(XDP_USE_NEED_WAKEUP | XDP_ZEROCOPY);
+    }
+    if (r == -1) {
+        // Driver without zero-copy support; the rings still work, the
+        // kernel just copies frames in and out of the UMEM
+        r = try_bind(XDP_USE_NEED_WAKEUP | XDP_COPY);
+    }
+    throw_system_error_on(r == -1, "bind(AF_XDP)");
+
+    _free_frames.reserve(num_frames);
+    for (uint32_t i = 0; i < num_frames; ++i) {
+        _free_frames.push_back(uint64_t(i) * frame_size);
+    }
+    refill_fill_ring();
+
+    _poller = reactor::poller::simple([this] { return poll(); });
+}
+
+xdp_qp::~xdp_qp() {
+    _poller.reset();
+    for (auto* m : {&_rx_map, &_tx_map, &_fill_map, &_comp_map}) {
+        if (m->addr) {
+            ::munmap(m->addr, m->len);
+        }
+    }
+    if (_umem) {
+        ::munmap(_umem, size_t(num_frames) * frame_size);
+    }
+}
+
+void
+xdp_qp::refill_fill_ring() {
+    auto n = std::min<uint32_t>(_fill.free_entries(), _free_frames.size());
+    if (n) {
+        auto idx = _fill.produce_index();
+        for (uint32_t i = 0; i < n; ++i) {
+            _fill[idx + i] = _free_frames.back();
+            _free_frames.pop_back();
+        }
+        _fill.advance_producer(n);
+    }
+    if (_fill.needs_wakeup()) {
+        // In need-wakeup mode the kernel stops its napi loop when the
+        // fill ring runs dry; an empty recv restarts it
+        ::recvfrom(_fd.get(), nullptr, 0, MSG_DONTWAIT, nullptr, nullptr);
+    }
+}
+
+bool
+xdp_qp::poll() {
+    bool progress = false;
+    // Reap tx completions
+    if (auto n = _comp.available()) {
+        auto idx = _comp.consume_index();
+        for (uint32_t i = 0; i < n; ++i) {
+            _free_frames.push_back(_comp[idx + i]);
+        }
+        _comp.advance_consumer(n);
+        progress = true;
+    }
+    if (_rx_started) {
+        auto n = std::min(_rx.available(), rx_budget);
+        if (n) {
+            auto idx = _rx.consume_index();
+            for (uint32_t i = 0; i < n; ++i) {
+                auto& d = _rx[idx + i];
+                auto frame = d.addr & ~uint64_t(frame_size - 1);
+                fragment f{_umem + d.addr, d.len};
+                packet p(f, make_deleter([this, frame] {
+                    _free_frames.push_back(frame);
+                }));
+                _stats.rx.good.update_frags_stats(1, d.len);
+                _dev->l2receive(std::move(p));
+            }
+            _rx.advance_consumer(n);
+            _stats.rx.good.update_pkts_bunch(n);
+            progress = true;
+        }
+    }
+    refill_fill_ring();
+    return progress;
+}
+
+future<>
+xdp_qp::send(packet p) {
+    if (p.len() > frame_size || _free_frames.empty() || _tx.free_entries() == 0) {
+        // No segmentation offload on this path, and a full ring means
+        // the device is backlogged; drop and let the stack retransmit
+        return make_ready_future<>();
+    }
+    auto frame = _free_frames.back();
+    _free_frames.pop_back();
+    char* dst = _umem + frame;
+    for (auto& f : p.fragments()) {
+        std::memcpy(dst, f.base, f.size);
+        dst += f.size;
+    }
+    auto idx = _tx.produce_index();
+    _tx[idx] = xdp_desc{frame, uint32_t(p.len()), 0};
+    _tx.advance_producer(1);
+    _stats.tx.good.update_frags_stats(p.nr_frags(), p.len());
+    _stats.tx.good.update_pkts_bunch(1);
+    kick_tx();
+    return make_ready_future<>();
+}
+
+xdp_options::xdp_options(program_options::option_group* parent_group)
+    : program_options::option_group(parent_group, "AF_XDP net options")
+    , xdp_device(*this, "xdp-device", {},
+            "Network interface to bind AF_XDP sockets to (selects the AF_XDP datapath)")
+    , xdp_queues(*this, "xdp-queues",
+            0u,
+            "Number of hardware queues to use (0 = as many as the NIC has channels, capped at the number of shards)")
+    , xdp_force_copy(*this, "xdp-force-copy",
+            false,
+            "Force copy mode instead of attempting zero-copy first")
+{
+}
+
+std::unique_ptr<device> create_xdp_net_device(const xdp_options& opts) {
+    return std::make_unique<xdp_device>(
+            opts.xdp_device.get_value(),
+            opts.xdp_queues.get_value(),
+            opts.xdp_force_copy.get_value());
+}
+
+}
+
+}
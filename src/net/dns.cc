@@ -34,6 +34,7 @@
 #include <seastar/net/dns.hh>
 #include <seastar/core/sstring.hh>
 #include <seastar/core/timer.hh>
+#include <seastar/core/shared_future.hh>
 #include <seastar/core/reactor.hh>
 #include <seastar/core/gate.hh>
 #include <seastar/core/print.hh>
@@ -141,6 +142,9 @@ public:
         : _stack(stack)
         , _timeout(opts.timeout ? *opts.timeout : std::chrono::milliseconds(5000) /* from ares private */)
         , _timer(std::bind(&impl::poll_sockets, this))
+        , _cache_enabled(opts.cache && *opts.cache)
+        , _cache_max_ttl(opts.cache_max_ttl ? *opts.cache_max_ttl : std::chrono::seconds(3600))
+        , _cache_negative_ttl(opts.cache_negative_ttl ? *opts.cache_negative_ttl : std::chrono::seconds(5))
     {
         static const ares_initializer a_init;
 
@@ -169,6 +173,18 @@ public:
             a_opts.flags = ARES_FLAG_USEVC | ARES_FLAG_PRIMARY;
             flags |= ARES_OPT_FLAGS;
         }
+        if (opts.keep_connections && *opts.keep_connections) {
+            // c-ares already pipelines outstanding queries on a shared
+            // connection and matches replies by message id; STAYOPEN just
+            // stops it from closing the connection between query bursts.
+            a_opts.flags |= ARES_FLAG_STAYOPEN;
+            flags |= ARES_OPT_FLAGS;
+        }
+        if (opts.edns_udp_payload_size) {
+            a_opts.flags |= ARES_FLAG_EDNS;
+            a_opts.ednspsz = *opts.edns_udp_payload_size;
+            flags |= ARES_OPT_FLAGS | ARES_OPT_EDNSPSZ;
+        }
         std::vector<in_addr> addr_tmp;
         if (opts.servers) {
             std::transform(opts.servers->begin(), opts.servers->end(), std::back_inserter(addr_tmp), [](const inet_address& a) {
@@ -251,6 +267,10 @@ public:
             }
         }
 
+        if (_cache_enabled) {
+            return get_host_by_name_cached(std::move(name), family ? int(*family) : AF_UNSPEC);
+        }
+
         auto p = new promise_wrap(std::move(name));
         auto f = p->get_future();
 
@@ -286,6 +306,140 @@ public:
         });
     }
 
+    future<hostent> get_host_by_name_cached(sstring name, int af) {
+        auto key = format("{}:{}", af, name);
+        auto now = std::chrono::steady_clock::now();
+
+        if (auto i = _cache.find(key); i != _cache.end()) {
+            if (now < i->second.expires) {
+                dns_log.trace("Cache hit: {}", key);
+                if (i->second.ex) {
+                    return make_exception_future<hostent>(i->second.ex);
+                }
+                return make_ready_future<hostent>(i->second.h);
+            }
+            _cache.erase(i);
+        }
+
+        // Collapse concurrent queries for the same name into one round trip.
+        if (auto i = _inflight.find(key); i != _inflight.end()) {
+            dns_log.trace("Joining in-flight query: {}", key);
+            return i->second.get_shared_future();
+        }
+
+        auto i = _inflight.emplace(key, shared_promise<hostent>()).first;
+        auto f = i->second.get_shared_future();
+
+        // The query callback can run synchronously from inside
+        // query_host_ttl (e.g. on immediate failure), so the in-flight
+        // entry must be registered before the query is issued.
+        (void)query_host_ttl(std::move(name), af).then_wrapped([me = shared_from_this(), key](future<host_ttl> f) {
+            auto node = me->_inflight.extract(key);
+            auto now = std::chrono::steady_clock::now();
+            cache_entry e;
+            try {
+                auto [h, ttl] = f.get();
+                e.h = h;
+                e.expires = now + std::min(ttl, me->_cache_max_ttl);
+                me->_cache[key] = std::move(e);
+                if (!node.empty()) {
+                    node.mapped().set_value(std::move(h));
+                }
+            } catch (...) {
+                e.ex = std::current_exception();
+                e.expires = now + me->_cache_negative_ttl;
+                auto ex = e.ex;
+                me->_cache[key] = std::move(e);
+                if (!node.empty()) {
+                    node.mapped().set_exception(std::move(ex));
+                }
+            }
+        });
+
+        return f;
+    }
+
+    using host_ttl = std::pair<hostent, std::chrono::seconds>;
+
+    // Like get_host_by_name, but also reports the shortest TTL in the
+    // answer, which bounds how long the whole answer may be cached.
+    // Goes to the DNS servers directly (no hosts file), since the
+    // gethostbyname path does not expose record TTLs.
+    future<host_ttl> query_host_ttl(sstring name, int af) {
+        if (af == AF_UNSPEC) {
+            // Match ares_gethostbyname's A-then-AAAA fallback.
+            return query_host_ttl(name, AF_INET).then_wrapped([me = shared_from_this(), name](future<host_ttl> f) mutable {
+                if (!f.failed()) {
+                    return f;
+                }
+                f.ignore_ready_future();
+                return me->query_host_ttl(std::move(name), AF_INET6);
+            });
+        }
+
+        class promise_wrap : public promise<host_ttl> {
+        public:
+            promise_wrap(sstring s, int af)
+                : name(std::move(s))
+                , af(af)
+            {}
+            sstring name;
+            int af;
+        };
+
+        auto p = new promise_wrap(std::move(name), af);
+        auto f = p->get_future();
+
+        dns_log.debug("Query name w/ttl {} ({})", p->name, af);
+
+        dns_call call(*this);
+
+        ares_search(_channel, p->name.c_str(), ns_c_in, af == AF_INET6 ? ns_t_aaaa : ns_t_a,
+                    [](void* arg, int status, int timeouts, unsigned char* buf, int len) {
+            std::unique_ptr<promise_wrap> p(reinterpret_cast<promise_wrap *>(arg));
+
+            if (status != ARES_SUCCESS) {
+                dns_log.debug("Query failed: {}", status);
+                p->set_exception(std::system_error(status, ares_errorc, p->name));
+                return;
+            }
+
+            ::hostent* host = nullptr;
+            long ttl = -1;
+            int nttl = 16;
+            if (p->af == AF_INET6) {
+                ares_addr6ttl ttls[16];
+                status = ares_parse_aaaa_reply(buf, len, &host, ttls, &nttl);
+                for (int i = 0; status == ARES_SUCCESS && i < nttl; ++i) {
+                    ttl = ttl < 0 ? ttls[i].ttl : std::min(ttl, long(ttls[i].ttl));
+                }
+            } else {
+                ares_addrttl ttls[16];
+                status = ares_parse_a_reply(buf, len, &host, ttls, &nttl);
+                for (int i = 0; status == ARES_SUCCESS && i < nttl; ++i) {
+                    ttl = ttl < 0 ? ttls[i].ttl : std::min(ttl, long(ttls[i].ttl));
+                }
+            }
+            if (status != ARES_SUCCESS || host == nullptr) {
+                dns_log.debug("Parse failed: {}", status);
+                p->set_exception(std::system_error(status != ARES_SUCCESS ? status : ARES_ENODATA, ares_errorc, p->name));
+                return;
+            }
+            try {
+                p->set_value(host_ttl{make_hostent(*host), std::chrono::seconds(std::max(ttl, 0l))});
+            } catch (...) {
+                p->set_exception(std::current_exception());
+            }
+            ares_free_hostent(host);
+        }, reinterpret_cast<void *>(p));
+
+        poll_sockets();
+
+        return f.finally([this] {
+            end_call();
+        });
+    }
+
     future<hostent> get_host_by_addr(inet_address addr) {
         class promise_wrap : public promise<hostent> {
         public:
@@ -1008,6 +1162,19 @@ private:
     timer<> _timer;
     gate _gate;
     bool _closed = false;
+
+    struct cache_entry {
+        hostent h;
+        std::exception_ptr ex; // set for negative entries
+        std::chrono::steady_clock::time_point expires;
+    };
+
+    bool _cache_enabled;
+    std::chrono::seconds _cache_max_ttl;
+    std::chrono::seconds _cache_negative_ttl;
+    // both keyed by "<af>:<name>"
+    std::unordered_map<sstring, cache_entry> _cache;
+    std::unordered_map<sstring, shared_promise<hostent>> _inflight;
 };
 
 net::dns_resolver::dns_resolver()
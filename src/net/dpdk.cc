@@ -31,6 +31,7 @@
 #include <seastar/core/sstring.hh>
 #include <seastar/core/memory.hh>
 #include <seastar/core/metrics.hh>
+#include <seastar/core/print.hh>
 #include <seastar/util/function_input_iterator.hh>
 #include <seastar/util/transform_iterator.hh>
 #include <atomic>
@@ -393,6 +394,13 @@ private:
      */
     void set_hw_flow_control();
 
+    /**
+     * Program the HW indirection table from the given queue mapping.
+     *
+     * @return 0 in case of success and an appropriate error code otherwise.
+     */
+    int program_rss_table(const std::vector<uint8_t>& redir_table);
+
 public:
     dpdk_device(uint16_t port_idx, uint16_t num_queues, bool use_lro,
                 bool enable_fc)
@@ -493,6 +501,8 @@ public:
      */
     void set_rss_table();
 
+    virtual future<> update_rss_table(std::vector<uint8_t> redir_table) override;
+
     virtual uint16_t hw_queues_count() override { return _num_queues; }
     virtual future<> link_ready() override { return _link_ready_promise.get_future(); }
     virtual std::unique_ptr<qp> init_local_queue(const program_options::option_group& opts, uint16_t qid) override;
@@ -719,115 +729,6 @@ build_mbuf_cluster:
             return me(head);
         }
 
-        /**
-         * Copy the contents of the "packet" into the given cluster of
-         * rte_mbuf's.
-         *
-         * @note Size of the cluster has to be big enough to accommodate all the
-         *       contents of the given packet.
-         *
-         * @param p packet to copy
-         * @param head head of the rte_mbuf's cluster
-         */
-        static void copy_packet_to_cluster(const packet& p, rte_mbuf* head) {
-            rte_mbuf* cur_seg = head;
-            size_t cur_seg_offset = 0;
-            unsigned cur_frag_idx = 0;
-            size_t cur_frag_offset = 0;
-
-            while (true) {
-                size_t to_copy = std::min(p.frag(cur_frag_idx).size - cur_frag_offset,
-                                          inline_mbuf_data_size - cur_seg_offset);
-
-                memcpy(rte_pktmbuf_mtod_offset(cur_seg, void*, cur_seg_offset),
-                       p.frag(cur_frag_idx).base + cur_frag_offset, to_copy);
-
-                cur_frag_offset += to_copy;
-                cur_seg_offset += to_copy;
-
-                if (cur_frag_offset >= p.frag(cur_frag_idx).size) {
-                    ++cur_frag_idx;
-                    if (cur_frag_idx >= p.nr_frags()) {
-                        //
-                        // We are done - set the data size of the last segment
-                        // of the cluster.
-                        //
-                        cur_seg->data_len = cur_seg_offset;
-                        break;
-                    }
-
-                    cur_frag_offset = 0;
-                }
-
-                if (cur_seg_offset >= inline_mbuf_data_size) {
-                    cur_seg->data_len = inline_mbuf_data_size;
-                    cur_seg = cur_seg->next;
-                    cur_seg_offset = 0;
-
-                    // FIXME: assert in a fast-path - remove!!!
-                    assert(cur_seg);
-                }
-            }
-        }
-
-        /**
-         * Creates a tx_buf cluster representing a given packet in a "copy" way.
-         *
-         * @param p packet to translate
-         * @param qp dpdk_qp handle
-         *
-         * @return the HEAD tx_buf of the cluster or nullptr in case of a
-         *         failure
-         */
-        static tx_buf* from_packet_copy(packet&& p, dpdk_qp& qp) {
-            // sanity
-            if (!p.len()) {
-                return nullptr;
-            }
-
-            /*
-             * Here we are going to use the fact that the inline data size is a
-             * power of two.
-             *
-             * We will first try to allocate the cluster and only if we are
-             * successful - we will go and copy the data.
-             */
-            auto aligned_len = align_up((size_t)p.len(), inline_mbuf_data_size);
-            unsigned nsegs = aligned_len / inline_mbuf_data_size;
-            rte_mbuf *head = nullptr, *last_seg = nullptr;
-
-            tx_buf* buf = qp.get_tx_buf();
-            if (!buf) {
-                return nullptr;
-            }
-
-            head = buf->rte_mbuf_p();
-            last_seg = head;
-            for (unsigned i = 1; i < nsegs; i++) {
-                buf = qp.get_tx_buf();
-                if (!buf) {
-                    me(head)->recycle();
-                    return nullptr;
-                }
-
-                last_seg->next = buf->rte_mbuf_p();
-                last_seg = last_seg->next;
-            }
-
-            //
-            // If we've got here means that we have succeeded already!
-            // We only need to copy the data and set the head buffer with the
-            // relevant info.
-            //
-            head->pkt_len = p.len();
-            head->nb_segs = nsegs;
-
-            copy_packet_to_cluster(p, head);
-            set_cluster_offload_info(p, qp, head);
-
-            return me(head);
-        }
-
         /**
          * Zero-copy handling of a single net::fragment.
          *
@@ -1248,17 +1149,18 @@ public:
     virtual ~dpdk_qp() {}
 
     virtual uint32_t send(circular_buffer<packet>& pb) override {
-        if (HugetlbfsMemBackend) {
-            // Zero-copy send
-            return _send(pb, [&] (packet&& p) {
-                return tx_buf::from_packet_zc(std::move(p), *this);
-            });
-        } else {
-            // "Copy"-send
-            return _send(pb, [&](packet&& p) {
-                return tx_buf::from_packet_copy(std::move(p), *this);
-            });
-        }
+        //
+        // Zero-copy send for both memory backends: set_one_data_buf()
+        // resolves each fragment's IOVA with rte_mem_virt2iova() and
+        // falls back to copying the individual fragment when the
+        // fragment's memory is not visible to the device (e.g. the
+        // non-hugetlbfs backend running in IOVA-PA mode), so fragments
+        // whose memory the NIC can reach are always transmitted in
+        // place.
+        //
+        return _send(pb, [&] (packet&& p) {
+            return tx_buf::from_packet_zc(std::move(p), *this);
+        });
     }
 
     dpdk_device& port() const { return *_dev; }
@@ -1404,6 +1306,15 @@ private:
      */
     std::optional<packet> from_mbuf_lro(rte_mbuf* m);
 
+    /**
+     * Copying counterparts of from_mbuf()/from_mbuf_lro(): the data is
+     * copied out and the mbuf is returned to the mempool immediately.
+     * Used as a fallback when too many mbufs are already adopted by the
+     * application.
+     */
+    std::optional<packet> from_mbuf_copy(rte_mbuf* m);
+    std::optional<packet> from_mbuf_lro_copy(rte_mbuf* m);
+
 private:
     dpdk_device* _dev;
     uint16_t _qid;
@@ -1420,6 +1331,15 @@ private:
     reactor::poller _tx_gc_poller;
     std::vector<rte_mbuf*> _tx_burst;
     uint16_t _tx_burst_idx = 0;
+    //
+    // Number of Rx mbuf segments currently adopted into "packet" objects
+    // (and thus held by the application instead of the mempool). Adopted
+    // mbufs are freed on this shard, so a plain counter suffices. When
+    // the application sits on more than half the pool we revert to the
+    // copying path so reception doesn't starve for mbufs.
+    //
+    uint32_t _num_adopted_rx_segs = 0;
+    static constexpr uint32_t max_adopted_rx_segs = mbufs_per_queue_rx / 2;
     static constexpr phys_addr_t page_mask = ~(memory::page_size - 1);
 };
 
@@ -1983,7 +1903,7 @@ void dpdk_qp<HugetlbfsMemBackend>::rx_start() {
 
 template<>
 inline std::optional<packet>
-dpdk_qp<false>::from_mbuf_lro(rte_mbuf* m)
+dpdk_qp<false>::from_mbuf_lro_copy(rte_mbuf* m)
 {
     //
     // Try to allocate a buffer for the whole packet's data.
@@ -2017,32 +1937,84 @@ dpdk_qp<false>::from_mbuf_lro(rte_mbuf* m)
 
 template<>
 inline std::optional<packet>
-dpdk_qp<false>::from_mbuf(rte_mbuf* m)
+dpdk_qp<false>::from_mbuf_copy(rte_mbuf* m)
 {
-    if (!_dev->hw_features_ref().rx_lro || rte_pktmbuf_is_contiguous(m)) {
-        //
-        // Try to allocate a buffer for packet's data. If we fail - give the
-        // application an mbuf itself. If we succeed - copy the data into this
-        // buffer, create a packet based on this buffer and return the mbuf to
-        // its pool.
-        //
-        auto len = rte_pktmbuf_data_len(m);
-        char* buf = (char*)malloc(len);
+    //
+    // Try to allocate a buffer for packet's data. If we fail - drop the
+    // packet. If we succeed - copy the data into this buffer, create a
+    // packet based on this buffer and return the mbuf to its pool.
+    //
+    auto len = rte_pktmbuf_data_len(m);
+    char* buf = (char*)malloc(len);
 
-        if (!buf) {
-            // Drop if allocation failed
-            rte_pktmbuf_free(m);
+    if (!buf) {
+        // Drop if allocation failed
+        rte_pktmbuf_free(m);
 
-            return std::nullopt;
-        } else {
-            rte_memcpy(buf, rte_pktmbuf_mtod(m, char*), len);
-            rte_pktmbuf_free(m);
+        return std::nullopt;
+    } else {
+        rte_memcpy(buf, rte_pktmbuf_mtod(m, char*), len);
+        rte_pktmbuf_free(m);
+
+        return packet(fragment{buf, len}, make_free_deleter(buf));
+    }
+}
+
+template<>
+inline std::optional<packet>
+dpdk_qp<false>::from_mbuf_lro(rte_mbuf* m)
+{
+    //
+    // Represent each segment of the cluster as a fragment of a single
+    // packet; freeing the HEAD returns the whole chain to the mempool.
+    //
+    _frags.clear();
+
+    for (rte_mbuf* m1 = m; m1 != nullptr; m1 = m1->next) {
+        _frags.emplace_back(fragment{rte_pktmbuf_mtod(m1, char*),
+                                     rte_pktmbuf_data_len(m1)});
+    }
+
+    _num_adopted_rx_segs += m->nb_segs;
+
+    return packet(_frags.begin(), _frags.end(),
+                  make_deleter([this, m] {
+                      _num_adopted_rx_segs -= m->nb_segs;
+                      rte_pktmbuf_free(m);
+                  }));
+}
 
-            return packet(fragment{buf, len}, make_free_deleter(buf));
+template<>
+inline std::optional<packet>
+dpdk_qp<false>::from_mbuf(rte_mbuf* m)
+{
+    //
+    // Adopt the mbuf into the packet zero-copy: the packet's fragments
+    // point straight into the mbuf's data and the deleter returns the
+    // mbuf to its mempool once the application releases the data. While
+    // the application is sitting on more than half of the pool, revert
+    // to the copying path so that reception never starves for mbufs.
+    //
+    if (_num_adopted_rx_segs < max_adopted_rx_segs) {
+        if (rte_pktmbuf_is_contiguous(m)) {
+            _num_adopted_rx_segs++;
+
+            return packet(fragment{rte_pktmbuf_mtod(m, char*),
+                                   rte_pktmbuf_data_len(m)},
+                          make_deleter([this, m] {
+                              _num_adopted_rx_segs--;
+                              rte_pktmbuf_free(m);
+                          }));
         }
-    } else {
+
         return from_mbuf_lro(m);
     }
+
+    if (!_dev->hw_features_ref().rx_lro || rte_pktmbuf_is_contiguous(m)) {
+        return from_mbuf_copy(m);
+    } else {
+        return from_mbuf_lro_copy(m);
+    }
 }
 
 template<>
@@ -2214,11 +2186,8 @@ bool dpdk_qp<HugetlbfsMemBackend>::poll_rx_once()
     return rx_count;
 }
 
-void dpdk_device::set_rss_table()
+int dpdk_device::program_rss_table(const std::vector<uint8_t>& redir_table)
 {
-    if (_dev_info.reta_size == 0)
-        return;
-
     int reta_conf_size =
         std::max(1, _dev_info.reta_size / RTE_RETA_GROUP_SIZE);
     std::vector<rte_eth_rss_reta_entry64> reta_conf(reta_conf_size);
@@ -2228,19 +2197,63 @@ void dpdk_device::set_rss_table()
     for (auto& x : reta_conf) {
         x.mask = ~0ULL;
         for (auto& r: x.reta) {
-            r = i++ % _num_queues;
+            r = redir_table[i++];
         }
     }
 
-    if (rte_eth_dev_rss_reta_update(_port_idx, reta_conf.data(), _dev_info.reta_size)) {
-        rte_exit(EXIT_FAILURE, "Port %d: Failed to update an RSS indirection table", _port_idx);
-    }
+    return rte_eth_dev_rss_reta_update(_port_idx, reta_conf.data(), _dev_info.reta_size);
+}
+
+void dpdk_device::set_rss_table()
+{
+    if (_dev_info.reta_size == 0)
+        return;
 
-    // Fill our local indirection table. Make it in a separate loop to keep things simple.
-    i = 0;
+    // Fill our local indirection table with an even distribution
+    unsigned i = 0;
     for (auto& r : _redir_table) {
         r = i++ % _num_queues;
     }
+
+    if (program_rss_table(_redir_table)) {
+        rte_exit(EXIT_FAILURE, "Port %d: Failed to update an RSS indirection table", _port_idx);
+    }
+}
+
+future<> dpdk_device::update_rss_table(std::vector<uint8_t> redir_table)
+{
+    if (_dev_info.reta_size == 0) {
+        return make_exception_future<>(std::runtime_error(
+            format("Port {}: HW does not support RSS redirection", _port_idx)));
+    }
+    if (redir_table.size() != _dev_info.reta_size) {
+        return make_exception_future<>(std::invalid_argument(
+            format("Port {}: RSS table must have {} entries, got {}",
+                   _port_idx, _dev_info.reta_size, redir_table.size())));
+    }
+    for (auto q : redir_table) {
+        if (q >= _num_queues) {
+            return make_exception_future<>(std::invalid_argument(
+                format("Port {}: RSS table entry {} exceeds queue count {}",
+                       _port_idx, q, _num_queues)));
+        }
+    }
+
+    if (program_rss_table(redir_table)) {
+        return make_exception_future<>(std::runtime_error(
+            format("Port {}: Failed to update an RSS indirection table", _port_idx)));
+    }
+
+    // The HW delivers under the new mapping from here on, but packets
+    // received under the old one may still sit in an rx poll on their old
+    // shard. Rx polling and tasks are serialized on each reactor, so once
+    // a no-op task has run everywhere those packets have been forwarded to
+    // their owners, and the cross-shard forwarding queues are FIFO. Only
+    // then may hash2qid()/hash2cpu() observe the new mapping, keeping any
+    // single flow in order across the switch.
+    return smp::invoke_on_all([] {}).then([this, redir_table = std::move(redir_table)] () mutable {
+        _redir_table = std::move(redir_table);
+    });
 }
 
 std::unique_ptr<qp> dpdk_device::init_local_queue(const program_options::option_group& opts, uint16_t qid) {
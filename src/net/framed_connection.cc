@@ -0,0 +1,156 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB
+ */
+
+#include <seastar/net/framed_connection.hh>
+
+#include <seastar/core/do_with.hh>
+#include <seastar/core/loop.hh>
+#include <seastar/core/print.hh>
+
+namespace seastar {
+
+namespace net {
+
+framed_connection::framed_connection(connected_socket fd, config cfg)
+    : _cfg(std::move(cfg))
+    , _fd(std::move(fd))
+    , _in(_fd.input())
+    , _out(_fd.output())
+    , _send_sem(_cfg.send_queue_bytes) {
+}
+
+future<temporary_buffer<char>> framed_connection::negotiate(temporary_buffer<char> ours, size_t size_of_theirs) {
+    return _out.write(std::move(ours)).then([this] {
+        return _out.flush();
+    }).then([this, size_of_theirs] {
+        return _in.read_exactly(size_of_theirs);
+    });
+}
+
+future<std::vector<temporary_buffer<char>>> framed_connection::read_payload(uint64_t size) {
+    // assemble the payload out of whatever chunks the input stream
+    // produces instead of linearizing into one allocation (cf. rpc's
+    // read_rcv_buf())
+    return do_with(std::vector<temporary_buffer<char>>(), size, [this] (std::vector<temporary_buffer<char>>& frags, uint64_t& left) {
+        return repeat([this, &frags, &left] {
+            if (!left) {
+                return make_ready_future<stop_iteration>(stop_iteration::yes);
+            }
+            return _in.read_up_to(left).then([&frags, &left] (temporary_buffer<char> data) {
+                if (data.empty()) {
+                    throw framing_error("connection closed mid-frame");
+                }
+                left -= data.size();
+                frags.push_back(std::move(data));
+                return stop_iteration::no;
+            });
+        }).then([&frags] {
+            return std::move(frags);
+        });
+    });
+}
+
+future<std::optional<incoming_frame>> framed_connection::read_frame() {
+    return _in.read_exactly(_cfg.header_size).then([this] (temporary_buffer<char> header) {
+        if (header.empty()) {
+            return make_ready_future<std::optional<incoming_frame>>(std::nullopt);
+        }
+        if (header.size() < _cfg.header_size) {
+            throw framing_error("connection closed mid-frame");
+        }
+        auto size = _cfg.parse_header(std::string_view(header.get(), header.size()));
+        if (!size) {
+            throw framing_error("invalid frame header");
+        }
+        if (*size > _cfg.max_payload_size) {
+            throw framing_error(format("frame payload of {} bytes exceeds limit of {}", *size, _cfg.max_payload_size));
+        }
+        return read_payload(*size).then([header = std::move(header), size = *size] (std::vector<temporary_buffer<char>> payload) mutable {
+            return std::optional<incoming_frame>(incoming_frame{std::move(header), std::move(payload), size});
+        });
+    });
+}
+
+void framed_connection::start_send_loop() {
+    _send_loop_active = true;
+    _send_done = repeat([this] {
+        if (_send_queue.empty()) {
+            // everything handed to the stream; one flush covers the
+            // whole batch
+            return _out.flush().then([this] {
+                if (_send_queue.empty()) {
+                    _send_loop_active = false;
+                    return stop_iteration::yes;
+                }
+                // more frames arrived while flushing
+                return stop_iteration::no;
+            });
+        }
+        auto p = std::move(_send_queue.front());
+        _send_queue.pop_front();
+        return _out.write(std::move(p)).then([] {
+            return stop_iteration::no;
+        });
+    }).handle_exception([this] (std::exception_ptr ex) {
+        // drop what cannot be written any more; send() and close()
+        // report the breakage
+        _error = true;
+        _send_loop_active = false;
+        _send_queue.clear();
+        return make_exception_future<>(std::move(ex));
+    });
+}
+
+future<> framed_connection::send(scattered_message<char> frame) {
+    if (_error) {
+        return make_exception_future<>(std::make_exception_ptr(framing_error("connection is broken")));
+    }
+    // cap so a frame larger than the whole queue allowance still goes
+    // through (alone) instead of deadlocking
+    auto bytes = std::min(frame.size(), _cfg.send_queue_bytes);
+    return get_units(_send_sem, bytes).then([this, frame = std::move(frame)] (semaphore_units<> units) mutable {
+        if (_error) {
+            return make_exception_future<>(std::make_exception_ptr(framing_error("connection is broken")));
+        }
+        auto p = std::move(frame).release();
+        // queue space is occupied until the packet, written or
+        // dropped, releases its fragments
+        p = packet(std::move(p), make_deleter([units = std::move(units)] {}));
+        _send_queue.push_back(std::move(p));
+        if (!_send_loop_active) {
+            start_send_loop();
+        }
+        return make_ready_future<>();
+    });
+}
+
+future<> framed_connection::close() {
+    return std::exchange(_send_done, make_ready_future<>()).then_wrapped([this] (future<> f) {
+        f.ignore_ready_future();
+        return _out.close();
+    }).then([this] {
+        return _in.close();
+    });
+}
+
+}
+
+}
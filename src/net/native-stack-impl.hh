@@ -92,6 +92,7 @@ public:
         : _conn(std::move(conn)) {}
     using connected_socket_impl::source;
     virtual data_source source() override;
+    virtual future<std::vector<temporary_buffer<char>>> recv_batch() override;
     virtual data_sink sink() override;
     virtual void shutdown_input() override;
     virtual void shutdown_output() override;
@@ -111,6 +112,7 @@ template <typename Protocol>
 class native_socket_impl final : public socket_impl {
     Protocol& _proto;
     lw_shared_ptr<typename Protocol::connection> _conn;
+    tcp_congestion_algorithm _cca = tcp_congestion_algorithm::new_reno;
 public:
     explicit native_socket_impl(Protocol& proto)
         : _proto(proto), _conn(nullptr) { }
@@ -123,6 +125,9 @@ public:
         assert(sa.as_posix_sockaddr().sa_family == AF_INET);
 
         _conn = make_lw_shared<typename Protocol::connection>(_proto.connect(sa));
+        if (_cca != tcp_congestion_algorithm::new_reno) {
+            _conn->set_congestion_control(_cca);
+        }
         return _conn->connected().then([conn = _conn]() mutable {
             auto csi = std::make_unique<native_connected_socket_impl<Protocol>>(std::move(conn));
             return make_ready_future<connected_socket>(connected_socket(std::move(csi)));
@@ -139,6 +144,10 @@ public:
         return false;
     }
 
+    virtual void set_congestion_control(tcp_congestion_algorithm algo) override {
+        _cca = algo;
+    }
+
     virtual void shutdown() override {
         if (_conn) {
             _conn->shutdown_connect();
@@ -203,6 +212,24 @@ data_source native_connected_socket_impl<Protocol>::source() {
     return data_source(std::make_unique<native_data_source_impl>(_conn));
 }
 
+template <typename Protocol>
+future<std::vector<temporary_buffer<char>>>
+native_connected_socket_impl<Protocol>::recv_batch() {
+    // The connection already accumulates everything that has arrived into
+    // one packet, so hand over all its fragments in a single resolution
+    // instead of one fragment per get()
+    return _conn->wait_for_data().then([this] {
+        auto p = _conn->read();
+        std::vector<temporary_buffer<char>> chain;
+        chain.reserve(p.nr_frags());
+        for (auto& f : p.fragments()) {
+            chain.emplace_back(f.base, f.size,
+                    make_deleter(deleter(), [p = p.share()] () mutable {}));
+        }
+        return chain;
+    });
+}
+
 template <typename Protocol>
 data_sink native_connected_socket_impl<Protocol>::sink() {
     return data_sink(std::make_unique<native_data_sink_impl>(_conn));
@@ -28,6 +28,7 @@
 #include <seastar/net/udp.hh>
 #include <seastar/net/virtio.hh>
 #include <seastar/net/dpdk.hh>
+#include <seastar/net/af_xdp.hh>
 #include <seastar/net/proxy.hh>
 #include <seastar/net/dhcp.hh>
 #include <seastar/net/config.hh>
@@ -68,6 +69,9 @@ void create_native_net_device(const native_stack_options& opts) {
     std::unique_ptr<device> dev;
 
     if ( deprecated_config_used) {
+        if ( opts.xdp_opts.xdp_device) {
+            dev = create_xdp_net_device(opts.xdp_opts);
+        } else
 #ifdef SEASTAR_HAVE_DPDK
         if ( opts.dpdk_pmd) {
              dev = create_dpdk_net_device(opts.dpdk_opts.dpdk_port_index.get_value(), smp::count,
@@ -193,6 +197,8 @@ native_network_stack::native_network_stack(const native_stack_options& opts, std
     : _netif(std::move(dev))
     , _inet(&_netif) {
     _inet.get_udp().set_queue_size(opts.udpv4_queue_size.get_value());
+    _inet.get_tcp().set_delayed_ack(std::chrono::milliseconds(opts.tcp_delayed_ack_ms.get_value()),
+            opts.tcp_delayed_ack_segments.get_value());
     _dhcp = opts.host_ipv4_addr.defaulted()
             && opts.gw_ipv4_addr.defaulted()
             && opts.netmask_ipv4_addr.defaulted() && opts.dhcp.get_value();
@@ -201,6 +207,19 @@ native_network_stack::native_network_stack(const native_stack_options& opts, std
         _inet.set_gw_address(ipv4_address(opts.gw_ipv4_addr.get_value()));
         _inet.set_netmask_address(ipv4_address(opts.netmask_ipv4_addr.get_value()));
     }
+    if (this_shard_id() != 0) {
+        // Resolve ARP cache misses on shard 0 only, so a fabric with
+        // thousands of peers is not queried once per shard. Resolved
+        // entries are replicated to every shard by arp_learn(), so the
+        // send path stays a local hash probe and this hop is taken only
+        // on a genuine miss.
+        _inet.set_arp_remote_resolver([] (const ipv4_address& addr) {
+            return smp::submit_to(0, [addr] {
+                auto& ns = static_cast<native_network_stack&>(engine().net());
+                return ns._inet.arp_lookup(addr);
+            });
+        });
+    }
 }
 
 server_socket
@@ -333,8 +352,15 @@ native_stack_options::native_stack_options()
     , lro(*this, "lro",
                 "on",
                 "Enable LRO")
+    , tcp_delayed_ack_ms(*this, "tcp-delayed-ack-ms",
+                200,
+                "Delayed-ACK timeout in milliseconds for native TCP (0 acks every segment immediately)")
+    , tcp_delayed_ack_segments(*this, "tcp-delayed-ack-segments",
+                2,
+                "Number of received full-sized segments that force an immediate ACK")
     , virtio_opts(this)
     , dpdk_opts(this)
+    , xdp_opts(this)
 {
 }
 
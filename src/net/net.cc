@@ -29,6 +29,9 @@
 #include <seastar/core/metrics.hh>
 #include <seastar/core/print.hh>
 #include <seastar/net/inet_address.hh>
+#include <seastar/net/ip_checksum.hh>
+#include <seastar/core/byteorder.hh>
+#include <deque>
 
 namespace seastar {
 
@@ -225,6 +228,28 @@ void qp::build_sw_reta(const std::map<unsigned, float>& cpu_weights) {
     _sw_reta = reta;
 }
 
+future<> device::update_rss_table(std::vector<uint8_t>) {
+    return make_exception_future<>(std::runtime_error("RSS reconfiguration not supported by this device"));
+}
+
+future<> device::drain_rx_queues(const std::set<unsigned>& drained_queues) {
+    std::vector<uint8_t> allowed;
+    for (unsigned q = 0; q < hw_queues_count(); q++) {
+        if (!drained_queues.count(q)) {
+            allowed.push_back(q);
+        }
+    }
+    if (allowed.empty()) {
+        return make_exception_future<>(std::invalid_argument("cannot drain all rx queues"));
+    }
+    std::vector<uint8_t> redir_table(size_t(1) << _rss_table_bits);
+    unsigned i = 0;
+    for (auto& r : redir_table) {
+        r = allowed[i++ % allowed.size()];
+    }
+    return update_rss_table(std::move(redir_table));
+}
+
 future<>
 device::receive(std::function<future<> (packet)> next_packet) {
     auto sub = _queues[this_shard_id()]->_rx_stream.listen(std::move(next_packet));
@@ -250,16 +275,91 @@ future<> l3_protocol::receive(
     return _netif->register_l3(_proto_num, std::move(rx_fn), std::move(forward));
 };
 
+// Software fallback for TCP segmentation offload: split an oversized
+// TCP/IPv4 frame built under hw_features::tx_gso into mss-sized frames.
+// The payload is shared, not copied; only the headers are duplicated and
+// patched, and the checksums the hardware offload would otherwise cover
+// are computed here.
+static void software_gso(packet p, std::deque<packet>& out) {
+    auto oi = p.get_offload_info();
+    unsigned hdr_len = sizeof(eth_hdr) + oi.ip_hdr_len + oi.tcp_hdr_len;
+    char* orig = p.get_header(0, hdr_len);
+    if (!orig || oi.protocol != ip_protocol_num::tcp || p.len() <= hdr_len + oi.tso_seg_size) {
+        // not something we know how to segment, or nothing to split
+        out.push_back(std::move(p));
+        return;
+    }
+    size_t payload_len = p.len() - hdr_len;
+    size_t seg_size = oi.tso_seg_size;
+    char* ip = orig + sizeof(eth_hdr);
+    char* th = ip + oi.ip_hdr_len;
+    uint32_t seq = read_be<uint32_t>(th + 4);
+    uint16_t ip_id = read_be<uint16_t>(ip + 4);
+    uint8_t tcp_flags = uint8_t(th[13]);
+    for (size_t off = 0; off != payload_len; ) {
+        size_t seg = std::min(seg_size, payload_len - off);
+        bool last = off + seg == payload_len;
+        packet q = p.share(hdr_len + off, seg);
+        char* h = q.prepend_uninitialized_header(hdr_len);
+        std::copy_n(orig, hdr_len, h);
+        char* qip = h + sizeof(eth_hdr);
+        char* qth = qip + oi.ip_hdr_len;
+        // IPv4: segment length, advancing identification, fresh checksum
+        write_be<uint16_t>(qip + 2, uint16_t(oi.ip_hdr_len + oi.tcp_hdr_len + seg));
+        write_be<uint16_t>(qip + 4, ip_id++);
+        qip[10] = qip[11] = 0;
+        uint16_t ip_csum = ip_checksum(qip, oi.ip_hdr_len); // network order
+        std::copy_n(reinterpret_cast<const char*>(&ip_csum), 2, qip + 10);
+        // TCP: advance the sequence number; FIN and PSH describe the end of
+        // the data stream, so only the last segment may carry them
+        write_be<uint32_t>(qth + 4, uint32_t(seq + off));
+        qth[13] = char(last ? tcp_flags : tcp_flags & ~0x09);
+        qth[16] = qth[17] = 0;
+        checksummer csum;
+        csum.sum(qip + 12, 8); // source and destination addresses
+        csum.sum_many(uint8_t(0), uint8_t(ip_protocol_num::tcp), uint16_t(oi.tcp_hdr_len + seg));
+        size_t skip = sizeof(eth_hdr) + oi.ip_hdr_len;
+        for (auto&& f : q.fragments()) {
+            if (skip >= f.size) {
+                skip -= f.size;
+                continue;
+            }
+            csum.sum(f.base + skip, f.size - skip);
+            skip = 0;
+        }
+        uint16_t tcp_csum = csum.get(); // network order
+        std::copy_n(reinterpret_cast<const char*>(&tcp_csum), 2, qth + 16);
+        auto qoi = oi;
+        qoi.tso_seg_size = 0;
+        qoi.needs_csum = false;
+        qoi.needs_ip_csum = false;
+        q.set_offload_info(qoi);
+        out.push_back(std::move(q));
+        off += seg;
+    }
+}
+
 interface::interface(std::shared_ptr<device> dev)
     : _dev(dev)
     , _hw_address(_dev->hw_address())
     , _hw_features(_dev->hw_features()) {
+    if (!_hw_features.tx_tso) {
+        // The TCP stack may still hand us oversized packets: segmenting them
+        // here, once per up-to-64KB packet, is cheaper than having TCP emit
+        // mss-sized packets one by one.
+        _hw_features.tx_gso = true;
+    }
     // FIXME: ignored future
     (void)_dev->receive([this] (packet p) {
         return dispatch_packet(std::move(p));
     });
-    dev->local_queue().register_packet_provider([this, idx = 0u] () mutable {
+    dev->local_queue().register_packet_provider([this, idx = 0u, backlog = make_lw_shared<std::deque<packet>>()] () mutable {
             std::optional<packet> p;
+            if (!backlog->empty()) {
+                p = std::move(backlog->front());
+                backlog->pop_front();
+                return p;
+            }
             for (size_t i = 0; i < _pkt_providers.size(); i++) {
                 auto l3p = _pkt_providers[idx++]();
                 if (idx == _pkt_providers.size())
@@ -271,6 +371,13 @@ interface::interface(std::shared_ptr<device> dev)
                     eh->src_mac = _hw_address;
                     eh->eth_proto = uint16_t(l3pv.proto_num);
                     *eh = hton(*eh);
+                    if (l3pv.p.offload_info_ref().tso_seg_size && !_dev->hw_features().tx_tso) {
+                        // device can't segment this oversized packet itself
+                        software_gso(std::move(l3pv.p), *backlog);
+                        p = std::move(backlog->front());
+                        backlog->pop_front();
+                        return p;
+                    }
                     p = std::move(l3pv.p);
                     return p;
                 }
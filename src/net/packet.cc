@@ -25,12 +25,78 @@
 #include <iostream>
 #include <algorithm>
 #include <cctype>
+#include <utility>
 
 namespace seastar {
 
 static_assert(std::is_nothrow_constructible_v<deleter>);
 static_assert(std::is_nothrow_move_constructible_v<deleter>);
 
+namespace internal {
+
+// Every chunk carries a one-word tag ahead of the object so
+// packet_impl_free() can tell pooled chunks from heap fallbacks; the
+// prefix is 16 bytes to preserve the allocator's alignment guarantee.
+static constexpr size_t chunk_prefix = 16;
+// Covers impl with its internal data buffer plus the default fragment
+// array; larger (rare) fragment arrays go to the heap.
+static constexpr size_t pooled_chunk_size = 512;
+static constexpr uintptr_t chunk_tag_pooled = 1;
+static constexpr uintptr_t chunk_tag_heap = 0;
+
+namespace {
+
+struct packet_impl_pool {
+    struct free_chunk {
+        free_chunk* next;
+    };
+    static constexpr size_t max_free = 1024; // ~512k per shard
+    free_chunk* _free = nullptr;
+    size_t _nr_free = 0;
+    ~packet_impl_pool() {
+        while (_free) {
+            ::operator delete(std::exchange(_free, _free->next));
+        }
+    }
+};
+
+thread_local packet_impl_pool impl_pool;
+
+}
+
+void* packet_impl_alloc(size_t size) {
+    void* chunk;
+    if (size + chunk_prefix <= pooled_chunk_size) {
+        if (impl_pool._free) {
+            chunk = std::exchange(impl_pool._free, impl_pool._free->next);
+            --impl_pool._nr_free;
+        } else {
+            chunk = ::operator new(pooled_chunk_size);
+        }
+        *static_cast<uintptr_t*>(chunk) = chunk_tag_pooled;
+    } else {
+        chunk = ::operator new(size + chunk_prefix);
+        *static_cast<uintptr_t*>(chunk) = chunk_tag_heap;
+    }
+    return static_cast<char*>(chunk) + chunk_prefix;
+}
+
+void packet_impl_free(void* ptr) noexcept {
+    if (!ptr) {
+        return;
+    }
+    void* chunk = static_cast<char*>(ptr) - chunk_prefix;
+    if (*static_cast<uintptr_t*>(chunk) == chunk_tag_pooled && impl_pool._nr_free < packet_impl_pool::max_free) {
+        auto c = static_cast<packet_impl_pool::free_chunk*>(chunk);
+        c->next = std::exchange(impl_pool._free, c);
+        ++impl_pool._nr_free;
+        return;
+    }
+    ::operator delete(chunk);
+}
+
+}
+
 namespace net {
 
 static_assert(std::is_nothrow_move_constructible_v<packet>);
@@ -22,6 +22,8 @@
 #include <random>
 
 #include <sys/socket.h>
+#include <sys/sendfile.h>
+#include <linux/errqueue.h>
 #include <linux/if.h>
 #include <linux/netlink.h>
 #include <linux/rtnetlink.h>
@@ -29,6 +31,7 @@
 
 #include <seastar/core/loop.hh>
 #include <seastar/core/reactor.hh>
+#include <seastar/core/bitops.hh>
 #include <seastar/net/posix-stack.hh>
 #include <seastar/net/net.hh>
 #include <seastar/net/packet.hh>
@@ -37,6 +40,11 @@
 #include <seastar/util/std-compat.hh>
 #include <netinet/tcp.h>
 #include <netinet/sctp.h>
+#include <unordered_map>
+
+#ifndef TCP_FASTOPEN_CONNECT
+#define TCP_FASTOPEN_CONNECT 30
+#endif
 
 namespace std {
 
@@ -212,11 +220,66 @@ static void shutdown_socket_fd(pollable_fd& fd, int how) noexcept {
     }
 }
 
+// Per-shard cache of transport characteristics observed on closing TCP
+// connections, keyed by peer address. Fan-out clients reconnect to the
+// same peers constantly; starting the next connection from the previous
+// one's operating point skips part of the ramp-up. The kernel keeps
+// similar per-destination state in tcp_metrics, but it is route-scoped,
+// often disabled (net.ipv4.tcp_no_metrics_save) and never consulted for
+// send-buffer sizing.
+struct peer_transport_hints {
+    uint32_t rtt_us;
+    uint32_t snd_cwnd_bytes;
+};
+
+static constexpr size_t max_peer_transport_hints = 1024;
+static thread_local std::unordered_map<inet_address, peer_transport_hints> peer_transport_hint_cache;
+
+static std::optional<inet_address> peer_inet_address(const file_desc& fd) noexcept {
+    ::sockaddr_storage ss;
+    ::socklen_t len = sizeof(ss);
+    if (::getpeername(fd.get(), reinterpret_cast<::sockaddr*>(&ss), &len) < 0) {
+        return std::nullopt;
+    }
+    switch (ss.ss_family) {
+    case AF_INET:
+        return inet_address(reinterpret_cast<::sockaddr_in&>(ss).sin_addr);
+    case AF_INET6:
+        return inet_address(reinterpret_cast<::sockaddr_in6&>(ss).sin6_addr);
+    default:
+        return std::nullopt;
+    }
+}
+
+static void record_peer_transport_hints(const file_desc& fd) noexcept {
+    ::tcp_info ti;
+    ::socklen_t len = sizeof(ti);
+    if (::getsockopt(fd.get(), IPPROTO_TCP, TCP_INFO, &ti, &len) < 0 || ti.tcpi_rtt == 0) {
+        // not a TCP socket, or no round trip ever completed; nothing
+        // worth remembering
+        return;
+    }
+    auto addr = peer_inet_address(fd);
+    if (!addr) {
+        return;
+    }
+    if (peer_transport_hint_cache.size() >= max_peer_transport_hints && !peer_transport_hint_cache.count(*addr)) {
+        // Cap the footprint. Evicting an arbitrary entry is fine for a
+        // cache whose misses only cost ramp-up time.
+        peer_transport_hint_cache.erase(peer_transport_hint_cache.begin());
+    }
+    peer_transport_hint_cache[*addr] = peer_transport_hints{ti.tcpi_rtt, ti.tcpi_snd_cwnd * ti.tcpi_snd_mss};
+}
+
 class posix_connected_socket_impl final : public connected_socket_impl {
     pollable_fd _fd;
     const posix_connected_socket_operations* _ops;
     conntrack::handle _handle;
     std::pmr::polymorphic_allocator<char>* _allocator;
+    std::unique_ptr<posix_data_source_impl> _batch_source;
+    // Bytes carried over from a previous shard by a connection handoff,
+    // handed to the first source created (see attach_connected_socket())
+    temporary_buffer<char> _input_residue;
 private:
     explicit posix_connected_socket_impl(sa_family_t family, int protocol, pollable_fd fd, std::pmr::polymorphic_allocator<char>* allocator=memory::malloc_allocator) :
         _fd(std::move(fd)), _ops(get_posix_connected_socket_ops(family, protocol)), _allocator(allocator) {}
@@ -224,11 +287,26 @@ private:
         std::pmr::polymorphic_allocator<char>* allocator=memory::malloc_allocator) : _fd(std::move(fd))
                 , _ops(get_posix_connected_socket_ops(family, protocol)), _handle(std::move(handle)), _allocator(allocator) {}
 public:
+    ~posix_connected_socket_impl() override {
+        // _fd is empty when the connection was detached by a handoff;
+        // its hints will be recorded by the shard that closes it.
+        if (_fd) {
+            record_peer_transport_hints(_fd.get_file_desc());
+        }
+    }
     virtual data_source source() override {
         return source(connected_socket_input_stream_config());
     }
     virtual data_source source(connected_socket_input_stream_config csisc) override {
-        return data_source(std::make_unique<posix_data_source_impl>(_fd, csisc, _allocator));
+        return data_source(std::make_unique<posix_data_source_impl>(_fd, csisc, _allocator, std::move(_input_residue)));
+    }
+    virtual future<std::vector<temporary_buffer<char>>> recv_batch() override {
+        // The source is kept across calls so its buffer sizes keep
+        // adapting to the observed read sizes
+        if (!_batch_source) {
+            _batch_source = std::make_unique<posix_data_source_impl>(_fd, connected_socket_input_stream_config(), _allocator);
+        }
+        return _batch_source->get_chain();
     }
     virtual data_sink sink() override {
         return data_sink(std::make_unique< posix_data_sink_impl>(_fd));
@@ -276,8 +354,50 @@ public:
     friend class posix_network_stack;
     friend class posix_ap_network_stack;
     friend class posix_socket_impl;
+    friend connected_socket_handoff detach_connected_socket(connected_socket s, input_stream<char> in);
+    friend connected_socket attach_connected_socket(connected_socket_handoff handoff, std::pmr::polymorphic_allocator<char>* allocator);
 };
 
+connected_socket_handoff
+detach_connected_socket(connected_socket s, input_stream<char> in) {
+    auto residue = in.release_buffer();
+    // Destroys the stream's posix_data_source_impl, dropping its
+    // pollable_fd reference
+    std::move(in).detach();
+    auto impl = get_impl::get(std::move(s));
+    auto pimpl = dynamic_cast<posix_connected_socket_impl*>(impl.get());
+    if (!pimpl) {
+        throw std::invalid_argument("detach_connected_socket() requires a posix stack socket");
+    }
+    if (!residue.empty() && !pimpl->_input_residue.empty()) {
+        // Can't happen through the public API: _input_residue is consumed
+        // by the first source() call, before the stream can buffer data
+        on_internal_error(seastar_logger, "detach_connected_socket(): conflicting input residues");
+    }
+    if (residue.empty()) {
+        residue = std::move(pimpl->_input_residue);
+    }
+    // The kernel socket survives the dup() while dropping the impl below
+    // unregisters the original fd from this shard's reactor and closes it.
+    // The caller is responsible for quiescing the connection first, so no
+    // I/O is outstanding on the fd at this point.
+    auto fd = pimpl->_fd.get_file_desc().dup();
+    impl.reset();
+    return connected_socket_handoff(std::move(fd), std::move(residue));
+}
+
+connected_socket
+attach_connected_socket(connected_socket_handoff handoff, std::pmr::polymorphic_allocator<char>* allocator) {
+    // The handoff deliberately doesn't carry family/protocol across
+    // shards; the kernel remembers them for us
+    auto family = sa_family_t(handoff._fd.getsockopt<int>(SOL_SOCKET, SO_DOMAIN));
+    auto protocol = family == AF_UNIX ? 0 : handoff._fd.getsockopt<int>(SOL_SOCKET, SO_PROTOCOL);
+    auto fd = pollable_fd(std::move(handoff._fd));
+    auto impl = std::unique_ptr<posix_connected_socket_impl>(new posix_connected_socket_impl(family, protocol, std::move(fd), allocator));
+    impl->_input_residue = std::move(handoff._input_residue);
+    return connected_socket(std::move(impl));
+}
+
 static void resolve_outgoing_address(socket_address& a) {
     if (a.family() != AF_INET6
         || a.as_posix_sockaddr_in6().sin6_scope_id != inet_address::invalid_scope
@@ -390,6 +510,10 @@ class posix_socket_impl final : public socket_impl {
     pollable_fd _fd;
     std::pmr::polymorphic_allocator<char>* _allocator;
     bool _reuseaddr = false;
+    // Only set on the socket when explicitly requested, so the kernel's
+    // configured default algorithm stays in effect otherwise
+    std::optional<tcp_congestion_algorithm> _cca;
+    bool _fast_open = false;
 
     future<> find_port_and_connect(socket_address sa, socket_address local, transport proto = transport::TCP) {
         static thread_local std::default_random_engine random_engine{std::random_device{}()};
@@ -402,6 +526,31 @@ class posix_socket_impl final : public socket_impl {
         return repeat([this, sa, local, proto, attempts = 0, requested_port = ntoh(local.as_posix_sockaddr_in().sin_port)] () mutable {
             _fd = engine().make_pollable_fd(sa, int(proto));
             _fd.get_file_desc().setsockopt(SOL_SOCKET, SO_REUSEADDR, int(_reuseaddr));
+            if (_cca && proto == transport::TCP) {
+                _fd.get_file_desc().setsockopt(IPPROTO_TCP, TCP_CONGESTION,
+                        *_cca == tcp_congestion_algorithm::bbr ? "bbr" : "reno");
+            }
+            if (proto == transport::TCP) {
+                if (_fast_open) {
+                    // Defer the SYN until the first write, which then
+                    // carries payload; with a fast-open cookie cached from
+                    // an earlier connection the peer delivers it without
+                    // waiting for the handshake, saving one RTT. Ignored
+                    // on kernels without TCP_FASTOPEN_CONNECT.
+                    try {
+                        _fd.get_file_desc().setsockopt(IPPROTO_TCP, TCP_FASTOPEN_CONNECT, int(1));
+                    } catch (std::system_error&) {
+                    }
+                }
+                auto hint = peer_transport_hint_cache.find(sa.addr());
+                if (hint != peer_transport_hint_cache.end() && hint->second.rtt_us >= 100) {
+                    // Start send-buffer autotuning from the window the
+                    // previous connection to this peer reached instead of
+                    // the system default. For sub-100us peers the default
+                    // catches up within a round trip anyway.
+                    _fd.get_file_desc().setsockopt(SOL_SOCKET, SO_SNDBUF, int(hint->second.snd_cwnd_bytes));
+                }
+            }
             uint16_t port = attempts++ < 5 && requested_port == 0 && proto == transport::TCP ? u(random_engine) * smp::count + this_shard_id() : requested_port;
             local.as_posix_sockaddr_in().sin_port = hton(port);
             return futurize_invoke([this, sa, local] { return engine().posix_connect(_fd, sa, local); }).then_wrapped([port, requested_port] (future<> f) {
@@ -465,6 +614,14 @@ public:
         }
     }
 
+    void set_congestion_control(tcp_congestion_algorithm algo) override {
+        _cca = algo;
+    }
+
+    void set_fast_open(bool enabled) override {
+        _fast_open = enabled;
+    }
+
     virtual void shutdown() override {
         if (_fd) {
             try {
@@ -478,40 +635,84 @@ public:
     }
 };
 
+std::optional<accept_result>
+posix_server_socket_impl::try_dispatch(pollable_fd fd, socket_address sa) {
+    auto cth = [this, &sa] {
+        switch(_lba) {
+        case server_socket::load_balancing_algorithm::connection_distribution:
+            return _conntrack.get_handle(_shard_load_hint);
+        case server_socket::load_balancing_algorithm::port:
+            return _conntrack.get_handle(ntoh(sa.as_posix_sockaddr_in().sin_port) % smp::count);
+        case server_socket::load_balancing_algorithm::fixed:
+            return _conntrack.get_handle(_fixed_cpu);
+        default: abort();
+        }
+    } ();
+    auto cpu = cth.cpu();
+    if (cpu == this_shard_id()) {
+        std::unique_ptr<connected_socket_impl> csi(
+                new posix_connected_socket_impl(sa.family(), _protocol, std::move(fd), std::move(cth), _allocator));
+        return accept_result{connected_socket(std::move(csi)), sa};
+    }
+    // FIXME: future is discarded
+    (void)smp::submit_to(cpu, [protocol = _protocol, ssa = _sa, fd = std::move(fd.get_file_desc()), sa, cth = std::move(cth), allocator = _allocator] () mutable {
+        posix_ap_server_socket_impl::move_connected_socket(protocol, ssa, pollable_fd(std::move(fd)), sa, std::move(cth), allocator);
+    });
+    return std::nullopt;
+}
+
+void
+posix_server_socket_impl::drain_accept_backlog() {
+    // Only safe when the listening socket is non-blocking; backends doing
+    // blocking io (see reactor::posix_listen()) keep it in blocking mode
+    // and get no batching.
+    if (!(::fcntl(_lfd.get_file_desc().get(), F_GETFL) & O_NONBLOCK)) {
+        return;
+    }
+    static constexpr size_t max_accept_batch = 256;
+    while (_pending.size() + 1 < max_accept_batch) {
+        socket_address sa;
+        std::optional<file_desc> fd;
+        try {
+            fd = _lfd.get_file_desc().try_accept(sa, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        } catch (...) {
+            // let the error resurface on the next regular accept()
+            break;
+        }
+        if (!fd) {
+            break;
+        }
+        _pending.push_back(pending_accept{pollable_fd(std::move(*fd), pollable_fd::speculation(EPOLLOUT)), sa});
+    }
+}
+
 future<accept_result>
 posix_server_socket_impl::accept() {
+    while (!_pending.empty()) {
+        auto pa = std::move(_pending.front());
+        _pending.pop_front();
+        if (auto ar = try_dispatch(std::move(pa.fd), pa.sa)) {
+            return make_ready_future<accept_result>(std::move(*ar));
+        }
+        // dispatched to another shard; keep looking for one of ours
+    }
     return _lfd.accept().then([this] (std::tuple<pollable_fd, socket_address> fd_sa) {
-        auto& fd = std::get<0>(fd_sa);
-        auto& sa = std::get<1>(fd_sa);
-        auto cth = [this, &sa] {
-            switch(_lba) {
-            case server_socket::load_balancing_algorithm::connection_distribution:
-                return _conntrack.get_handle();
-            case server_socket::load_balancing_algorithm::port:
-                return _conntrack.get_handle(ntoh(sa.as_posix_sockaddr_in().sin_port) % smp::count);
-            case server_socket::load_balancing_algorithm::fixed:
-                return _conntrack.get_handle(_fixed_cpu);
-            default: abort();
-            }
-        } ();
-        auto cpu = cth.cpu();
-        if (cpu == this_shard_id()) {
-            std::unique_ptr<connected_socket_impl> csi(
-                    new posix_connected_socket_impl(sa.family(), _protocol, std::move(fd), std::move(cth), _allocator));
-            return make_ready_future<accept_result>(
-                    accept_result{connected_socket(std::move(csi)), sa});
-        } else {
-            // FIXME: future is discarded
-            (void)smp::submit_to(cpu, [protocol = _protocol, ssa = _sa, fd = std::move(fd.get_file_desc()), sa, cth = std::move(cth), allocator = _allocator] () mutable {
-                posix_ap_server_socket_impl::move_connected_socket(protocol, ssa, pollable_fd(std::move(fd)), sa, std::move(cth), allocator);
-            });
-            return accept();
+        // By the time we wake up, a connection storm has typically queued
+        // more connections in the listen backlog; drain a bounded batch of
+        // them with direct accept4() calls so we do not pay one future
+        // resolution per connection, and distribute the whole batch across
+        // the shards in one go.
+        drain_accept_backlog();
+        if (auto ar = try_dispatch(std::move(std::get<0>(fd_sa)), std::get<1>(fd_sa))) {
+            return make_ready_future<accept_result>(std::move(*ar));
         }
+        return accept();
     });
 }
 
 void
 posix_server_socket_impl::abort_accept() {
+    _pending.clear();
     _lfd.shutdown(SHUT_RD, pollable_fd::shutdown_kernel_only::no);
 }
 
@@ -592,8 +793,75 @@ posix_ap_server_socket_impl::move_connected_socket(int protocol, socket_address
     }
 }
 
+namespace {
+
+// Recycling pool for connection read buffers. A steady-state socket read
+// allocates a buffer and frees it shortly after, so keep returned buffers
+// around in power-of-two size classes and hand them back to subsequent
+// reads instead of round-tripping the allocator. Shard-local, and capped
+// so that a burst of large reads does not pin memory forever.
+class read_buffer_pool {
+    // mirror the connected_socket_input_stream_config bounds
+    static constexpr size_t min_buffer_size = 512;
+    static constexpr size_t max_buffer_size = 128 * 1024;
+    static constexpr size_t max_pooled_bytes = 2 << 20;
+    static constexpr unsigned nr_classes = log2ceil(max_buffer_size / min_buffer_size) + 1;
+    struct free_buffer {
+        free_buffer* next;
+    };
+    std::array<free_buffer*, nr_classes> _free = {};
+    size_t _pooled_bytes = 0;
+private:
+    static unsigned size_class(size_t size) {
+        return log2ceil(std::max(size, min_buffer_size)) - log2ceil(min_buffer_size);
+    }
+    static size_t class_size(unsigned cls) {
+        return min_buffer_size << cls;
+    }
+public:
+    ~read_buffer_pool() {
+        for (auto& head : _free) {
+            while (head) {
+                ::operator delete(std::exchange(head, head->next));
+            }
+        }
+    }
+    temporary_buffer<char> allocate(size_t size) {
+        if (size > max_buffer_size) {
+            return temporary_buffer<char>(size);
+        }
+        auto cls = size_class(size);
+        auto bytes = class_size(cls);
+        char* ptr;
+        if (_free[cls]) {
+            ptr = reinterpret_cast<char*>(std::exchange(_free[cls], _free[cls]->next));
+            _pooled_bytes -= bytes;
+        } else {
+            ptr = static_cast<char*>(::operator new(bytes));
+        }
+        // buffers can end up deleted on another shard (e.g. via
+        // foreign_ptr); only recycle on the owner
+        return temporary_buffer<char>(ptr, size, make_deleter([this, owner = this_shard_id(), ptr, cls, bytes] {
+            if (this_shard_id() == owner && _pooled_bytes + bytes <= max_pooled_bytes) {
+                auto b = reinterpret_cast<free_buffer*>(ptr);
+                b->next = std::exchange(_free[cls], b);
+                _pooled_bytes += bytes;
+            } else {
+                ::operator delete(ptr);
+            }
+        }));
+    }
+};
+
+thread_local read_buffer_pool the_read_buffer_pool;
+
+}
+
 future<temporary_buffer<char>>
 posix_data_source_impl::get() {
+    if (!_residue.empty()) {
+        return make_ready_future<temporary_buffer<char>>(std::move(_residue));
+    }
     return _fd.recv_some(static_cast<internal::buffer_allocator*>(this)).then([this] (temporary_buffer<char> b) {
         if (b.size() >= _config.buffer_size) {
             _config.buffer_size *= 2;
@@ -606,8 +874,54 @@ posix_data_source_impl::get() {
     });
 }
 
+future<std::vector<temporary_buffer<char>>>
+posix_data_source_impl::get_chain() {
+    if (!_residue.empty()) {
+        std::vector<temporary_buffer<char>> res;
+        res.push_back(std::move(_residue));
+        return make_ready_future<std::vector<temporary_buffer<char>>>(std::move(res));
+    }
+    // Fill several buffers with a single readv(), so however much data
+    // has accumulated in the socket is delivered in one future
+    // resolution instead of one per buffer
+    constexpr unsigned max_chain_length = 4;
+    std::vector<temporary_buffer<char>> chain;
+    chain.reserve(max_chain_length);
+    for (unsigned i = 0; i < max_chain_length; i++) {
+        chain.push_back(allocate_buffer());
+    }
+    std::vector<iovec> iov;
+    iov.reserve(chain.size());
+    for (auto& b : chain) {
+        iov.push_back({.iov_base = b.get_write(), .iov_len = b.size()});
+    }
+    auto capacity = size_t(max_chain_length) * _config.buffer_size;
+    return _fd.read_some(iov).then([this, capacity, chain = std::move(chain)] (size_t size) mutable {
+        // Same buffer size adaptation as get()
+        if (size >= capacity) {
+            _config.buffer_size = std::min(_config.buffer_size * 2, _config.max_buffer_size);
+        } else if (size <= _config.buffer_size / 4) {
+            _config.buffer_size = std::max(_config.buffer_size / 2, _config.min_buffer_size);
+        }
+        std::vector<temporary_buffer<char>> res;
+        for (auto& b : chain) {
+            if (size == 0) {
+                break;
+            }
+            auto n = std::min(size, b.size());
+            b.trim(n);
+            size -= n;
+            res.push_back(std::move(b));
+        }
+        return res;
+    });
+}
+
 temporary_buffer<char>
 posix_data_source_impl::allocate_buffer() {
+    if (_buffer_allocator == memory::malloc_allocator) {
+        return the_read_buffer_pool.allocate(_config.buffer_size);
+    }
     return make_temporary_buffer<char>(_buffer_allocator, _config.buffer_size);
 }
 
@@ -634,13 +948,138 @@ std::vector<iovec> to_iovec(std::vector<temporary_buffer<char>>& buf_vec) {
     return v;
 }
 
+posix_data_sink_impl::~posix_data_sink_impl() {
+    if (_zc_pending.empty()) {
+        return;
+    }
+    // Destroyed without close() while zerocopy sends are still in flight
+    // (e.g. an aborted connection). The kernel still references the payload
+    // pages, so freeing them now would let the allocator reuse memory that
+    // may yet go out on the wire. Deliberately leak the deleters instead;
+    // this is a rare teardown path and the leak is bounded by the amount
+    // that was in flight.
+    for (auto& e : _zc_pending) {
+        new packet(std::move(e.second));
+    }
+}
+
+bool
+posix_data_sink_impl::try_enable_zerocopy() noexcept {
+    if (_zc_state == zerocopy_state::unknown) {
+        int one = 1;
+        auto r = ::setsockopt(_fd.get_file_desc().get(), SOL_SOCKET, SO_ZEROCOPY, &one, sizeof(one));
+        // fails on kernels before 4.14 and on non-TCP/UDP sockets
+        _zc_state = r == 0 ? zerocopy_state::enabled : zerocopy_state::unavailable;
+    }
+    return _zc_state == zerocopy_state::enabled;
+}
+
+void
+posix_data_sink_impl::process_zerocopy_completions() noexcept {
+    auto fd = _fd.get_file_desc().get();
+    while (!_zc_pending.empty()) {
+        char control[128];
+        struct msghdr msg = {};
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        auto r = ::recvmsg(fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT);
+        if (r < 0) {
+            // EAGAIN: no notification queued yet
+            break;
+        }
+        for (auto* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if (!((cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR)
+                    || (cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR))) {
+                continue;
+            }
+            auto* serr = reinterpret_cast<const struct sock_extended_err*>(CMSG_DATA(cmsg));
+            if (serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY || serr->ee_errno != 0) {
+                continue;
+            }
+            if (serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) {
+                // the kernel fell back to copying (e.g. the device cannot
+                // handle page-backed skbs), so the flag only adds overhead;
+                // stop using it for future writes
+                _zc_state = zerocopy_state::unavailable;
+            }
+            // completions for sequence numbers [ee_info, ee_data] (inclusive)
+            if (int32_t(serr->ee_data - _zc_acked_seq) > 0) {
+                _zc_acked_seq = serr->ee_data;
+            }
+        }
+        while (!_zc_pending.empty() && int32_t(_zc_acked_seq - _zc_pending.front().first) >= 0) {
+            _zc_pending.pop_front();
+        }
+    }
+}
+
+future<>
+posix_data_sink_impl::put_zerocopy(packet p) {
+    auto fd = _fd.get_file_desc().get();
+    return do_with(std::move(p), uint32_t(0), [this, fd] (packet& p, uint32_t& zc_sends) {
+        return repeat([this, fd, &p, &zc_sends] {
+            if (!_zc_pending.empty()) {
+                process_zerocopy_completions();
+            }
+            struct msghdr msg = {};
+            // fragment is layout-compatible with iovec
+            msg.msg_iov = reinterpret_cast<iovec*>(p.fragments().begin());
+            msg.msg_iovlen = std::min<size_t>(p.nr_frags(), IOV_MAX);
+            bool zc = true;
+            auto r = ::sendmsg(fd, &msg, MSG_DONTWAIT | MSG_NOSIGNAL | MSG_ZEROCOPY);
+            if (r < 0 && errno == ENOBUFS) {
+                // the per-user pinned-page budget (net.core.optmem_max) is
+                // exhausted; send this chunk with a plain copy instead
+                zc = false;
+                r = ::sendmsg(fd, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+            }
+            if (r < 0) {
+                if (errno == EAGAIN) {
+                    return _fd.writeable().then([] {
+                        return stop_iteration::no;
+                    });
+                }
+                throw std::system_error(errno, std::system_category(), "sendmsg");
+            }
+            if (zc) {
+                _zc_next_seq++;
+                zc_sends++;
+            }
+            if (size_t(r) < p.len()) {
+                p.trim_front(r);
+                return make_ready_future<stop_iteration>(stop_iteration::no);
+            }
+            return make_ready_future<stop_iteration>(stop_iteration::yes);
+        }).then([this, &p, &zc_sends] {
+            if (zc_sends) {
+                // park the packet until the completion for its last send
+                // arrives; its deleter keeps the payload pages alive
+                _zc_pending.emplace_back(_zc_next_seq - 1, std::move(p));
+            }
+        });
+    });
+}
+
 future<>
 posix_data_sink_impl::put(temporary_buffer<char> buf) {
-    return _fd.write_all(buf.get(), buf.size()).then([d = buf.release()] {});
+    if (buf.size() >= zerocopy_threshold && try_enable_zerocopy()) {
+        // release() first, for the same reason as below - don't rely on the
+        // threshold exceeding the buffer's internal storage size
+        auto d = buf.release();
+        auto f = fragment{buf.get_write(), buf.size()};
+        return put_zerocopy(packet(f, std::move(d)));
+    }
+    // release() first, so the pointer we hand to write_all() is the stable
+    // one owned by the deleter rather than the buffer's internal storage
+    auto d = buf.release();
+    return _fd.write_all(buf.get(), buf.size()).then([d = std::move(d)] {});
 }
 
 future<>
 posix_data_sink_impl::put(packet p) {
+    if (p.len() >= zerocopy_threshold && try_enable_zerocopy()) {
+        return put_zerocopy(std::move(p));
+    }
     _p = std::move(p);
     return _fd.write_all(_p).then([this] { _p.reset(); });
 }
@@ -648,7 +1087,38 @@ posix_data_sink_impl::put(packet p) {
 future<>
 posix_data_sink_impl::close() {
     _fd.shutdown(SHUT_WR);
-    return make_ready_future<>();
+    if (_zc_pending.empty()) {
+        return make_ready_future<>();
+    }
+    // Wait for the kernel to release all zerocopy payloads before letting
+    // the deleters run. Error-queue activity raises EPOLLERR, which wakes
+    // readable() waiters.
+    return do_until([this] {
+        process_zerocopy_completions();
+        return _zc_pending.empty();
+    }, [this] {
+        return _fd.readable();
+    });
+}
+
+bool
+posix_data_sink_impl::can_sendfile() const noexcept {
+    return true;
+}
+
+future<size_t>
+posix_data_sink_impl::sendfile(int fd, uint64_t pos, size_t len) {
+    off_t off = pos;
+    auto r = ::sendfile(_fd.get_file_desc().get(), fd, &off, len);
+    if (r == -1) {
+        if (errno == EAGAIN) {
+            return _fd.writeable().then([this, fd, pos, len] {
+                return sendfile(fd, pos, len);
+            });
+        }
+        return make_exception_future<size_t>(std::system_error(errno, std::system_category(), "sendfile"));
+    }
+    return make_ready_future<size_t>(r);
 }
 
 posix_network_stack::posix_network_stack(const program_options::option_group& opts, std::pmr::polymorphic_allocator<char>* allocator)
@@ -663,13 +1133,13 @@ posix_network_stack::listen(socket_address sa, listen_options opt) {
         sa = inet_address(inet_address::family::INET);
     }
     if (sa.is_af_unix()) {
-        return server_socket(std::make_unique<posix_server_socket_impl>(0, sa, engine().posix_listen(sa, opt), opt.lba, opt.fixed_cpu, _allocator));
+        return server_socket(std::make_unique<posix_server_socket_impl>(0, sa, engine().posix_listen(sa, opt), opt.lba, opt.fixed_cpu, std::move(opt.shard_load_hint), _allocator));
     }
     auto protocol = static_cast<int>(opt.proto);
     return _reuseport ?
         server_socket(std::make_unique<posix_reuseport_server_socket_impl>(protocol, sa, engine().posix_listen(sa, opt), _allocator))
         :
-        server_socket(std::make_unique<posix_server_socket_impl>(protocol, sa, engine().posix_listen(sa, opt), opt.lba, opt.fixed_cpu, _allocator));
+        server_socket(std::make_unique<posix_server_socket_impl>(protocol, sa, engine().posix_listen(sa, opt), opt.lba, opt.fixed_cpu, std::move(opt.shard_load_hint), _allocator));
 }
 
 ::seastar::socket posix_network_stack::socket() {
@@ -732,6 +1202,42 @@ private:
             _iov.iov_len = MAX_DATAGRAM_SIZE;
         }
     };
+    // Pre-registered arrays for recvmmsg(); the buffers are allocated
+    // once and reused -- received datagrams are copied out into
+    // right-sized packets, which for telemetry-sized datagrams is far
+    // cheaper than a syscall apiece.
+    struct recv_batch_ctx {
+        static constexpr unsigned max_batch = 32;
+        struct mmsghdr _hdrs[max_batch];
+        struct iovec _iovs[max_batch];
+        socket_address _src_addrs[max_batch];
+        cmsg_with_pktinfo _cmsgs[max_batch];
+        std::unique_ptr<char[]> _buffers[max_batch];
+
+        recv_batch_ctx() {
+            memset(_hdrs, 0, sizeof(_hdrs));
+            for (unsigned i = 0; i < max_batch; i++) {
+                _buffers[i] = std::make_unique<char[]>(MAX_DATAGRAM_SIZE);
+                _iovs[i] = { _buffers[i].get(), MAX_DATAGRAM_SIZE };
+                auto& hdr = _hdrs[i].msg_hdr;
+                hdr.msg_iov = &_iovs[i];
+                hdr.msg_iovlen = 1;
+                hdr.msg_name = &_src_addrs[i].u.sa;
+                hdr.msg_control = &_cmsgs[i];
+            }
+        }
+
+        void prepare() {
+            // The kernel overwrites the name and control lengths on each
+            // call, so they are re-armed here
+            for (unsigned i = 0; i < max_batch; i++) {
+                auto& hdr = _hdrs[i].msg_hdr;
+                hdr.msg_namelen = sizeof(_src_addrs[i].u.sas);
+                memset(&_cmsgs[i], 0, sizeof(_cmsgs[i]));
+                hdr.msg_controllen = sizeof(_cmsgs[i]);
+            }
+        }
+    };
     struct send_ctx {
         struct msghdr _hdr;
         std::vector<struct iovec> _iovecs;
@@ -757,8 +1263,13 @@ private:
     pollable_fd _fd;
     socket_address _address;
     recv_ctx _recv;
+    // Created on the first receive_batch() call so plain receive() users
+    // don't pay for the buffer array
+    std::unique_ptr<recv_batch_ctx> _recv_batch;
     send_ctx _send;
     bool _closed;
+
+    socket_address destination_address(struct msghdr& hdr) const;
 public:
     posix_udp_channel(const socket_address& bind_address)
             : _closed(false) {
@@ -774,6 +1285,7 @@ public:
     }
     virtual ~posix_udp_channel() { if (!_closed) close(); };
     virtual future<udp_datagram> receive() override;
+    virtual future<std::vector<udp_datagram>> receive_batch(size_t max_datagrams) override;
     virtual future<> send(const socket_address& dst, const char *msg) override;
     virtual future<> send(const socket_address& dst, packet p) override;
     virtual void shutdown_input() override {
@@ -840,20 +1352,26 @@ public:
     virtual packet& get_data() override { return _p; }
 };
 
+socket_address
+posix_udp_channel::destination_address(struct msghdr& hdr) const {
+    socket_address dst;
+    for (auto* cmsg = CMSG_FIRSTHDR(&hdr); cmsg != nullptr; cmsg = CMSG_NXTHDR(&hdr, cmsg)) {
+        if (cmsg->cmsg_level == IPPROTO_IP && cmsg->cmsg_type == IP_PKTINFO) {
+            dst = ipv4_addr(copy_reinterpret_cast<in_pktinfo>(CMSG_DATA(cmsg)).ipi_addr, _address.port());
+            break;
+        } else if (cmsg->cmsg_level == IPPROTO_IPV6 && cmsg->cmsg_type == IPV6_PKTINFO) {
+            dst = ipv6_addr(copy_reinterpret_cast<in6_pktinfo>(CMSG_DATA(cmsg)).ipi6_addr, _address.port());
+            break;
+        }
+    }
+    return dst;
+}
+
 future<udp_datagram>
 posix_udp_channel::receive() {
     _recv.prepare();
     return _fd.recvmsg(&_recv._hdr).then([this] (size_t size) {
-        socket_address dst;
-        for (auto* cmsg = CMSG_FIRSTHDR(&_recv._hdr); cmsg != nullptr; cmsg = CMSG_NXTHDR(&_recv._hdr, cmsg)) {
-            if (cmsg->cmsg_level == IPPROTO_IP && cmsg->cmsg_type == IP_PKTINFO) {
-                dst = ipv4_addr(copy_reinterpret_cast<in_pktinfo>(CMSG_DATA(cmsg)).ipi_addr, _address.port());
-                break;
-            } else if (cmsg->cmsg_level == IPPROTO_IPV6 && cmsg->cmsg_type == IPV6_PKTINFO) {
-                dst = ipv6_addr(copy_reinterpret_cast<in6_pktinfo>(CMSG_DATA(cmsg)).ipi6_addr, _address.port());
-                break;
-            }
-        }
+        auto dst = destination_address(_recv._hdr);
         return make_ready_future<udp_datagram>(udp_datagram(std::make_unique<posix_datagram>(
             _recv._src_addr, dst, packet(fragment{_recv._buffer, size}, make_deleter([buf = _recv._buffer] { delete[] buf; })))));
     }).handle_exception([p = _recv._buffer](auto ep) {
@@ -862,6 +1380,29 @@ posix_udp_channel::receive() {
     });
 }
 
+future<std::vector<udp_datagram>>
+posix_udp_channel::receive_batch(size_t max_datagrams) {
+    if (!_recv_batch) {
+        _recv_batch = std::make_unique<recv_batch_ctx>();
+    }
+    auto& ctx = *_recv_batch;
+    ctx.prepare();
+    auto vlen = std::min<size_t>(std::max<size_t>(max_datagrams, 1), recv_batch_ctx::max_batch);
+    return _fd.recvmmsg(ctx._hdrs, vlen).then([this] (size_t nr) {
+        auto& ctx = *_recv_batch;
+        std::vector<udp_datagram> batch;
+        batch.reserve(nr);
+        for (size_t i = 0; i < nr; i++) {
+            auto& hdr = ctx._hdrs[i].msg_hdr;
+            // The datagram is copied out of the pre-registered buffer, so
+            // the slot is ready for the next batch
+            batch.emplace_back(std::make_unique<posix_datagram>(ctx._src_addrs[i], destination_address(hdr),
+                    packet(fragment{ctx._buffers[i].get(), ctx._hdrs[i].msg_len})));
+        }
+        return batch;
+    });
+}
+
 network_stack_entry register_posix_stack() {
     return network_stack_entry{
         "posix", std::make_unique<program_options::option_group>(nullptr, "Posix"),
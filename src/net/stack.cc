@@ -21,6 +21,7 @@
 
 #include <seastar/net/stack.hh>
 #include <seastar/net/inet_address.hh>
+#include <seastar/core/loop.hh>
 
 namespace seastar {
 
@@ -57,6 +58,18 @@ future<net::udp_datagram> net::udp_channel::receive() {
     return _impl->receive();
 }
 
+future<std::vector<net::udp_datagram>> net::udp_channel::receive_batch(size_t max_datagrams) {
+    return _impl->receive_batch(max_datagrams);
+}
+
+future<std::vector<net::udp_datagram>> net::udp_channel_impl::receive_batch(size_t) {
+    return receive().then([] (udp_datagram datagram) {
+        std::vector<udp_datagram> batch;
+        batch.push_back(std::move(datagram));
+        return batch;
+    });
+}
+
 future<> net::udp_channel::send(const socket_address& dst, const char* msg) {
     return _impl->send(dst, msg);
 }
@@ -65,6 +78,32 @@ future<> net::udp_channel::send(const socket_address& dst, packet p) {
     return _impl->send(dst, std::move(p));
 }
 
+future<> net::udp_channel::send_segmented(const socket_address& dst, packet p, size_t segment_size) {
+    return _impl->send_segmented(dst, std::move(p), segment_size);
+}
+
+future<> net::udp_channel_impl::send_segmented(const socket_address& dst, packet p, size_t segment_size) {
+    if (segment_size == 0) {
+        return make_exception_future<>(std::invalid_argument("send_segmented: segment_size must be positive"));
+    }
+    if (p.len() <= segment_size) {
+        return send(dst, std::move(p));
+    }
+    return do_with(std::move(p), socket_address(dst), size_t(0), [this, segment_size] (packet& p, socket_address& dst, size_t& off) {
+        return repeat([this, &p, &dst, &off, segment_size] {
+            if (off == p.len()) {
+                return make_ready_future<stop_iteration>(stop_iteration::yes);
+            }
+            auto len = std::min(segment_size, p.len() - off);
+            auto seg = p.share(off, len);
+            off += len;
+            return send(dst, std::move(seg)).then([] {
+                return stop_iteration::no;
+            });
+        });
+    });
+}
+
 bool net::udp_channel::is_closed() const {
     return _impl->is_closed();
 }
@@ -100,6 +139,10 @@ input_stream<char> connected_socket::input(connected_socket_input_stream_config
     return input_stream<char>(_csi->source(csisc));
 }
 
+future<std::vector<temporary_buffer<char>>> connected_socket::recv_batch() {
+    return _csi->recv_batch();
+}
+
 output_stream<char> connected_socket::output(size_t buffer_size) {
     output_stream_options opts;
     opts.batch_flushes = true;
@@ -155,6 +198,21 @@ net::connected_socket_impl::source(connected_socket_input_stream_config csisc) {
     return source();
 }
 
+future<std::vector<temporary_buffer<char>>>
+net::connected_socket_impl::recv_batch() {
+    // Fallback for implementations without a batched read: one buffer
+    // per future resolution, as if read through a data_source
+    return do_with(source(), [] (data_source& ds) {
+        return ds.get().then([] (temporary_buffer<char> b) {
+            std::vector<temporary_buffer<char>> chain;
+            if (!b.empty()) {
+                chain.push_back(std::move(b));
+            }
+            return chain;
+        });
+    });
+}
+
 socket::~socket()
 {}
 
@@ -178,6 +236,14 @@ bool socket::get_reuseaddr() const {
     return _si->get_reuseaddr();
 }
 
+void socket::set_congestion_control(tcp_congestion_algorithm algo) {
+    _si->set_congestion_control(algo);
+}
+
+void socket::set_fast_open(bool enabled) {
+    _si->set_fast_open(enabled);
+}
+
 void socket::shutdown() {
     _si->shutdown();
 }
@@ -51,8 +51,11 @@ void tcp_option::parse(uint8_t* beg1, uint8_t* end1) {
         case option_kind::win_scale:
             _win_scale_received = true;
             _remote_win_scale = win_scale::read(beg).shift;
-            // We can turn on win_scale option, 7 is Linux's default win scale size
-            _local_win_scale = 7;
+            // We can turn on win_scale option. A scale of 10 allows the
+            // receive window to grow up to 64MB, enough headroom for
+            // tcb::update_rcv_buf_size() to fill long fat networks; the
+            // initial window stays at the (scale 7) Linux default.
+            _local_win_scale = 10;
             beg += option_len::win_scale;
             break;
         case option_kind::sack:
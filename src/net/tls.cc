@@ -21,9 +21,20 @@
 
 #include <gnutls/gnutls.h>
 #include <gnutls/x509.h>
+#include <gnutls/ocsp.h>
+#include <mutex>
 #include <stdexcept>
 #include <system_error>
 
+#if __has_include(<linux/tls.h>)
+#include <linux/tls.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#if defined(SOL_TLS) && defined(TCP_ULP) && GNUTLS_VERSION_NUMBER >= 0x030400
+#define SEASTAR_HAVE_KTLS 1
+#endif
+#endif
+
 #include <seastar/core/loop.hh>
 #include <seastar/core/reactor.hh>
 #include <seastar/core/seastar.hh>
@@ -36,8 +47,14 @@
 #include <seastar/core/with_timeout.hh>
 #include <seastar/net/tls.hh>
 #include <seastar/net/stack.hh>
+#include <seastar/net/dns.hh>
+#include <seastar/http/client.hh>
+#include <seastar/http/request.hh>
+#include <seastar/http/reply.hh>
 #include <seastar/util/std-compat.hh>
 #include <seastar/util/variant_utils.hh>
+#include <seastar/util/short_streams.hh>
+#include <seastar/util/log.hh>
 #include <seastar/core/fsnotify.hh>
 
 #include <boost/range/iterator_range.hpp>
@@ -46,20 +63,6 @@
 
 namespace seastar {
 
-class net::get_impl {
-public:
-    static std::unique_ptr<connected_socket_impl> get(connected_socket s) {
-        return std::move(s._csi);
-    }
-
-    static connected_socket_impl* maybe_get_ptr(connected_socket& s) {
-        if (s._csi) {
-            return s._csi.get();
-        }
-        return nullptr;
-    }
-};
-
 class blob_wrapper: public gnutls_datum_t {
 public:
     blob_wrapper(const tls::blob& in)
@@ -325,6 +328,9 @@ public:
             }()), _priority(nullptr, &gnutls_priority_deinit)
     {}
     ~impl() {
+        if (_ocsp_refresher) {
+            _ocsp_refresher->detach();
+        }
         if (_creds != nullptr) {
             gnutls_certificate_free_credentials (_creds);
         }
@@ -401,7 +407,75 @@ public:
     void set_dn_verification_callback(dn_callback cb) {
         _dn_callback = std::move(cb);
     }
+    void set_handshake_offload(bool offload) {
+        _offload_handshake = offload;
+    }
+    bool is_handshake_offloaded() const {
+        return _offload_handshake;
+    }
+    void set_kernel_tls(bool ktls) {
+        _kernel_tls = ktls;
+    }
+    bool is_kernel_tls_enabled() const {
+        return _kernel_tls;
+    }
+    void set_session_ticket_key(session_ticket_key key) {
+        _session_ticket_key = std::move(key);
+    }
+    const session_ticket_key& get_session_ticket_key() const {
+        return _session_ticket_key;
+    }
+    void set_ocsp_staple(const blob& b) {
+        std::lock_guard<std::mutex> lock(_ocsp_lock);
+        if (!_ocsp_cb_set) {
+            // Hand the current response out per handshake through the
+            // callback API; unlike the _mem variant it replaces rather
+            // than accumulates, so the staple can be refreshed while
+            // sessions are being served.
+            gnutls_certificate_set_ocsp_status_request_function(_creds, &impl::deliver_ocsp_staple, this);
+            _ocsp_cb_set = true;
+        }
+        _ocsp_response.assign(b.data(), b.size());
+    }
+    void enable_ocsp_stapling(std::chrono::milliseconds period, sstring responder_override) {
+        if (_ocsp_refresher) {
+            _ocsp_refresher->detach();
+        }
+        _ocsp_refresher = seastar::make_shared<ocsp_refresher>(this, period, std::move(responder_override));
+        _ocsp_refresher->start();
+    }
 private:
+    // Keeps the stapled OCSP response fresh. The refresher is held both
+    // by the credentials and by any in-flight fetch, so a fetch can
+    // outlive its owner; detach() cuts the back-pointer and stops the
+    // timer when the owner goes away.
+    class ocsp_refresher : public enable_shared_from_this<ocsp_refresher> {
+        impl* _creds;
+        std::chrono::milliseconds _period;
+        sstring _responder_override;
+        timer<> _timer;
+    public:
+        ocsp_refresher(impl* creds, std::chrono::milliseconds period, sstring responder_override)
+            : _creds(creds)
+            , _period(period)
+            , _responder_override(std::move(responder_override))
+        {}
+        void start() {
+            _timer.set_callback([this] { refresh(); });
+            // fire the first fetch right away, off the caller's path
+            _timer.arm(timer<>::clock::now(), _period);
+        }
+        void detach() {
+            _creds = nullptr;
+            _timer.cancel();
+        }
+    private:
+        void refresh();
+        future<temporary_buffer<char>> fetch_ocsp_response();
+    };
+
+    static int deliver_ocsp_staple(gnutls_session_t, void* ptr, gnutls_datum_t* response);
+
     friend class credentials_builder;
     friend class session;
 
@@ -421,11 +495,168 @@ private:
     std::unique_ptr<tls::dh_params::impl> _dh_params;
     std::unique_ptr<std::remove_pointer_t<gnutls_priority_t>, void(*)(gnutls_priority_t)> _priority;
     client_auth _client_auth = client_auth::NONE;
+    bool _offload_handshake = false;
+    bool _kernel_tls = false;
+    session_ticket_key _session_ticket_key;
     bool _load_system_trust = false;
     semaphore _system_trust_sem {1};
     dn_callback _dn_callback;
+    // Guards _ocsp_response: the delivery callback can run on a helper
+    // thread when the handshake is offloaded, concurrently with a
+    // refresh on the owning shard.
+    std::mutex _ocsp_lock;
+    std::string _ocsp_response;
+    bool _ocsp_cb_set = false;
+    shared_ptr<ocsp_refresher> _ocsp_refresher;
 };
 
+static logger tls_log("tls");
+
+int tls::certificate_credentials::impl::deliver_ocsp_staple(gnutls_session_t, void* ptr, gnutls_datum_t* response) {
+    auto* i = static_cast<impl*>(ptr);
+    std::lock_guard<std::mutex> lock(i->_ocsp_lock);
+    if (i->_ocsp_response.empty()) {
+        return GNUTLS_E_NO_CERTIFICATE_STATUS;
+    }
+    // gnutls takes ownership of the datum and frees it after sending
+    response->data = static_cast<unsigned char*>(gnutls_malloc(i->_ocsp_response.size()));
+    if (response->data == nullptr) {
+        return GNUTLS_E_MEMORY_ERROR;
+    }
+    std::memcpy(response->data, i->_ocsp_response.data(), i->_ocsp_response.size());
+    response->size = i->_ocsp_response.size();
+    return 0;
+}
+
+// Splits an http:// URL into host, port and path for the OCSP POST.
+static std::tuple<sstring, uint16_t, sstring> parse_http_url(const sstring& url) {
+    std::string_view v(url);
+    static constexpr std::string_view scheme = "http://";
+    if (v.substr(0, scheme.size()) != scheme) {
+        throw std::runtime_error(fmt::format("unsupported OCSP responder URL: {}", url));
+    }
+    v.remove_prefix(scheme.size());
+    auto slash = v.find('/');
+    auto hostport = v.substr(0, slash);
+    sstring path = slash == std::string_view::npos ? sstring("/") : sstring(v.substr(slash));
+    uint16_t port = 80;
+    auto colon = hostport.rfind(':');
+    if (colon != std::string_view::npos) {
+        port = std::stoul(std::string(hostport.substr(colon + 1)));
+        hostport = hostport.substr(0, colon);
+    }
+    return {sstring(hostport), port, std::move(path)};
+}
+
+void tls::certificate_credentials::impl::ocsp_refresher::refresh() {
+    (void)fetch_ocsp_response().then([me = shared_from_this()] (temporary_buffer<char> der) {
+        // re-check: the owner may have gone away while we were fetching
+        if (me->_creds != nullptr && der.size() != 0) {
+            me->_creds->set_ocsp_staple(blob(der.get(), der.size()));
+            tls_log.debug("refreshed stapled OCSP response ({} bytes)", der.size());
+        }
+    }).handle_exception([] (std::exception_ptr ep) {
+        tls_log.warn("failed to refresh stapled OCSP response: {}; keeping the previous one", ep);
+    });
+}
+
+future<temporary_buffer<char>> tls::certificate_credentials::impl::ocsp_refresher::fetch_ocsp_response() {
+    return async([me = shared_from_this()] {
+        // The certificate work below does not yield, so holding the raw
+        // owner pointer across it is safe; it is not touched again after
+        // the first suspension point.
+        auto* creds = me->_creds;
+        if (creds == nullptr) {
+            return temporary_buffer<char>();
+        }
+
+        using crt_ptr = std::unique_ptr<std::remove_pointer_t<gnutls_x509_crt_t>, void(*)(gnutls_x509_crt_t)>;
+        auto import_crt = [](const gnutls_datum_t& der) {
+            gnutls_x509_crt_t crt;
+            gtls_chk(gnutls_x509_crt_init(&crt));
+            auto p = crt_ptr(crt, &gnutls_x509_crt_deinit);
+            gtls_chk(gnutls_x509_crt_import(crt, &der, GNUTLS_X509_FMT_DER));
+            return p;
+        };
+
+        // The OCSP request names the certificate by a hash over issuer
+        // data, so both the leaf and its issuer must be in the chain.
+        gnutls_datum_t leaf_der, issuer_der;
+        if (gnutls_certificate_get_crt_raw(*creds, 0, 0, &leaf_der) < 0
+                || gnutls_certificate_get_crt_raw(*creds, 0, 1, &issuer_der) < 0) {
+            throw std::runtime_error("OCSP stapling requires the issuer certificate in the loaded chain");
+        }
+        auto leaf = import_crt(leaf_der);
+        auto issuer = import_crt(issuer_der);
+
+        sstring url = me->_responder_override;
+        if (url.empty()) {
+            gnutls_datum_t uri;
+            int res;
+            for (unsigned seq = 0; ; ++seq) {
+                res = gnutls_x509_crt_get_authority_info_access(leaf.get(), seq, GNUTLS_IA_OCSP_URI, &uri, nullptr);
+                if (res != GNUTLS_E_UNKNOWN_ALGORITHM) {
+                    // found it, ran out of entries, or failed
+                    break;
+                }
+                // a different access method; try the next entry
+            }
+            if (res < 0) {
+                throw std::runtime_error("certificate carries no OCSP responder URI; pass one explicitly");
+            }
+            url = sstring(reinterpret_cast<const char*>(uri.data), uri.size);
+            gnutls_free(uri.data);
+        }
+
+        gnutls_ocsp_req_t ocsp_req;
+        gtls_chk(gnutls_ocsp_req_init(&ocsp_req));
+        auto req_ptr = std::unique_ptr<std::remove_pointer_t<gnutls_ocsp_req_t>, void(*)(gnutls_ocsp_req_t)>(ocsp_req, &gnutls_ocsp_req_deinit);
+        gtls_chk(gnutls_ocsp_req_add_cert(ocsp_req, GNUTLS_DIG_SHA1, issuer.get(), leaf.get()));
+        gnutls_datum_t req_der;
+        gtls_chk(gnutls_ocsp_req_export(ocsp_req, &req_der));
+        sstring body(reinterpret_cast<const char*>(req_der.data), req_der.size);
+        gnutls_free(req_der.data);
+
+        auto [host, port, path] = parse_http_url(url);
+        auto addr = net::dns::resolve_name(host).get0();
+        http::experimental::client cln(socket_address(addr, port));
+        sstring resp_body;
+        std::exception_ptr ex;
+        try {
+            auto rq = http::request::make("POST", host, path);
+            rq.write_body("bin", std::move(body));
+            // exact mime type; the extension table has no OCSP entry
+            rq.set_mime_type("application/ocsp-request");
+            cln.make_request(std::move(rq), [&] (const http::reply&, input_stream<char>&& in) {
+                return do_with(std::move(in), [&] (input_stream<char>& in) {
+                    return util::read_entire_stream_contiguous(in).then([&] (sstring b) {
+                        resp_body = std::move(b);
+                    });
+                });
+            }).get();
+        } catch (...) {
+            ex = std::current_exception();
+        }
+        cln.close().get();
+        if (ex) {
+            std::rethrow_exception(ex);
+        }
+
+        // Sanity-check before installing: a responder error page must
+        // not end up stapled into handshakes.
+        gnutls_ocsp_resp_t ocsp_resp;
+        gtls_chk(gnutls_ocsp_resp_init(&ocsp_resp));
+        auto resp_ptr = std::unique_ptr<std::remove_pointer_t<gnutls_ocsp_resp_t>, void(*)(gnutls_ocsp_resp_t)>(ocsp_resp, &gnutls_ocsp_resp_deinit);
+        gnutls_datum_t resp_der{reinterpret_cast<unsigned char*>(resp_body.data()), unsigned(resp_body.size())};
+        gtls_chk(gnutls_ocsp_resp_import(ocsp_resp, &resp_der));
+        if (gnutls_ocsp_resp_get_status(ocsp_resp) != GNUTLS_OCSP_RESP_SUCCESSFUL) {
+            throw std::runtime_error("OCSP responder returned an unsuccessful status");
+        }
+
+        return temporary_buffer<char>(resp_body.data(), resp_body.size());
+    });
+}
+
 tls::certificate_credentials::certificate_credentials()
         : _impl(make_shared<impl>()) {
 }
@@ -501,6 +732,14 @@ void tls::certificate_credentials::set_dn_verification_callback(dn_callback cb)
     _impl->set_dn_verification_callback(std::move(cb));
 }
 
+void tls::certificate_credentials::enable_handshake_offload(bool enable) {
+    _impl->set_handshake_offload(enable);
+}
+
+void tls::certificate_credentials::enable_kernel_tls(bool enable) {
+    _impl->set_kernel_tls(enable);
+}
+
 tls::server_credentials::server_credentials()
 #if GNUTLS_VERSION_NUMBER < 0x030600
     : server_credentials(dh_params{})
@@ -519,16 +758,37 @@ tls::server_credentials::server_credentials(server_credentials&&) noexcept = def
 tls::server_credentials& tls::server_credentials::operator=(
         server_credentials&&) noexcept = default;
 
+tls::session_ticket_key tls::server_credentials::generate_session_ticket_key() {
+    gnutls_datum_t key;
+    gtls_chk(gnutls_session_ticket_key_generate(&key));
+    session_ticket_key k(key.data, key.data + key.size);
+    gnutls_free(key.data);
+    return k;
+}
+
+void tls::server_credentials::enable_session_tickets(const session_ticket_key& key) {
+    _impl->set_session_ticket_key(key);
+}
+
 void tls::server_credentials::set_client_auth(client_auth ca) {
     _impl->set_client_auth(ca);
 }
 
+void tls::server_credentials::set_ocsp_staple(const blob& der) {
+    _impl->set_ocsp_staple(der);
+}
+
+void tls::server_credentials::enable_ocsp_stapling(std::chrono::milliseconds refresh_period, sstring responder_override) {
+    _impl->enable_ocsp_stapling(refresh_period, std::move(responder_override));
+}
+
 static const sstring dh_level_key = "dh_level";
 static const sstring x509_trust_key = "x509_trust";
 static const sstring x509_crl_key = "x509_crl";
 static const sstring x509_key_key = "x509_key";
 static const sstring pkcs12_key = "pkcs12";
 static const sstring system_trust = "system_trust";
+static const sstring ocsp_staple_key = "ocsp_staple";
 
 using buffer_type = std::basic_string<tls::blob::value_type, tls::blob::traits_type, std::allocator<tls::blob::value_type>>;
 
@@ -573,6 +833,10 @@ void tls::credentials_builder::set_simple_pkcs12(const blob& b, x509_crt_format
     _blobs.emplace(pkcs12_key, pkcs12_simple{std::string(b), fmt, password });
 }
 
+void tls::credentials_builder::set_ocsp_staple(const blob& der) {
+    _blobs.emplace(ocsp_staple_key, x509_simple{ std::string(der), x509_crt_format::DER });
+}
+
 static buffer_type to_buffer(const temporary_buffer<char>& buf) {
     return buffer_type(buf.get(), buf.get() + buf.size());
 }
@@ -603,6 +867,12 @@ future<> tls::credentials_builder::set_simple_pkcs12_file(const sstring& pkcs12f
     });
 }
 
+future<> tls::credentials_builder::set_ocsp_staple_file(const sstring& file) {
+    return read_fully(file, "ocsp staple file").then([this](file_result f) {
+        _blobs.emplace(ocsp_staple_key, x509_simple{ to_buffer(f.buf), x509_crt_format::DER, std::move(f.file) });
+    });
+}
+
 future<> tls::credentials_builder::set_system_trust() {
     // TODO / Caveat:
     // We cannot actually issue a loading of system trust here,
@@ -625,6 +895,29 @@ void tls::credentials_builder::set_priority_string(const sstring& prio) {
     _priority = prio;
 }
 
+void tls::credentials_builder::enable_handshake_offload(bool offload) {
+    _offload_handshake = offload;
+}
+
+void tls::credentials_builder::enable_kernel_tls(bool ktls) {
+    _kernel_tls = ktls;
+}
+
+void tls::credentials_builder::enable_session_tickets(session_ticket_key key) {
+    if (key.empty()) {
+        key = server_credentials::generate_session_ticket_key();
+    }
+    _session_ticket_key = std::move(key);
+}
+
+void tls::credentials_builder::rotate_session_ticket_key() {
+    enable_session_tickets(server_credentials::generate_session_ticket_key());
+}
+
+const tls::session_ticket_key& tls::credentials_builder::get_session_ticket_key() const {
+    return _session_ticket_key;
+}
+
 template<typename Blobs, typename Visitor>
 static void visit_blobs(Blobs& blobs, Visitor&& visitor) {
     auto visit = [&](const sstring& key, auto* vt) {
@@ -638,6 +931,7 @@ static void visit_blobs(Blobs& blobs, Visitor&& visitor) {
     visit(x509_crl_key, static_cast<x509_simple*>(nullptr));
     visit(x509_key_key, static_cast<x509_key*>(nullptr));
     visit(pkcs12_key, static_cast<pkcs12_simple*>(nullptr));
+    visit(ocsp_staple_key, static_cast<x509_simple*>(nullptr));
 }
 
 void tls::credentials_builder::apply_to(certificate_credentials& creds) const {
@@ -648,6 +942,8 @@ void tls::credentials_builder::apply_to(certificate_credentials& creds) const {
                 creds.set_x509_trust(info.data, info.format);
             } else if (key == x509_crl_key) {
                 creds.set_x509_crl(info.data, info.format);
+            } else if (key == ocsp_staple_key) {
+                creds._impl->set_ocsp_staple(info.data);
             }
         },
         [&](const sstring&, const x509_key& info) {
@@ -672,6 +968,11 @@ void tls::credentials_builder::apply_to(certificate_credentials& creds) const {
     }
 
     creds._impl->set_client_auth(_client_auth);
+    creds._impl->set_handshake_offload(_offload_handshake);
+    creds._impl->set_kernel_tls(_kernel_tls);
+    if (!_session_ticket_key.empty()) {
+        creds._impl->set_session_ticket_key(_session_ticket_key);
+    }
 }
 
 shared_ptr<tls::certificate_credentials> tls::credentials_builder::build_certificate_credentials() const {
@@ -1008,6 +1309,13 @@ public:
                     gnutls_certificate_server_set_request(*this, GNUTLS_CERT_REQUIRE);
                     break;
             }
+            auto& stek = _creds->get_session_ticket_key();
+            if (!stek.empty()) {
+                // the key is copied into the session, so rotating it in
+                // the credentials only affects sessions created later
+                gnutls_datum_t key { const_cast<unsigned char*>(stek.data()), unsigned(stek.size()) };
+                gtls_chk(gnutls_session_ticket_enable_server(*this, &key));
+            }
         }
 
         auto prio = _creds->get_priority();
@@ -1077,8 +1385,28 @@ public:
         if (_type == type::CLIENT && !_hostname.empty()) {
             gnutls_server_name_set(*this, GNUTLS_NAME_DNS, _hostname.data(), _hostname.size());
         }
+        if (_creds->is_handshake_offloaded()) {
+            // gnutls_handshake() runs the asymmetric crypto inline, which
+            // can stall the reactor for milliseconds during a connection
+            // storm. As the session is non-blocking, the call is pure
+            // computation over the buffered input, so it can run on a
+            // syscall thread wholesale; socket IO stays on the reactor, in
+            // wait_for_input()/wait_for_output(). The push callback only
+            // collects output in memory while offloaded (see vec_push()).
+            _offload_active = true;
+            return engine().run_on_syscall_thread([this] {
+                return gnutls_handshake(*this);
+            }).then([this](int res) {
+                _offload_active = false;
+                return flush_handshake_output().then([this, res] {
+                    return process_handshake_result(res);
+                });
+            });
+        }
+        return process_handshake_result(gnutls_handshake(*this));
+    }
+    future<> process_handshake_result(int res) {
         try {
-            auto res = gnutls_handshake(*this);
             if (res < 0) {
                 switch (res) {
                 case GNUTLS_E_AGAIN:
@@ -1123,8 +1451,13 @@ public:
                 verify();
             }
             _connected = true;
-            // make sure we reset output_pending
-            return wait_for_output();
+            // make sure we reset output_pending, and only then hand the
+            // socket to the kernel: enabling TLS_TX with the final
+            // handshake record still in flight would have the kernel
+            // re-encrypt those bytes as application data.
+            return wait_for_output().then([this] {
+                maybe_enable_ktls();
+            });
         } catch (...) {
             return make_exception_future<>(std::current_exception());
         }
@@ -1174,6 +1507,22 @@ public:
            return make_exception_future(ep);
         });
     }
+    future<> flush_handshake_output() {
+        if (_handshake_output.empty()) {
+            return make_ready_future<>();
+        }
+        // do_handshake() waits for pending output between steps, so
+        // _output_pending is necessarily available here.
+        try {
+            scattered_message<char> msg;
+            msg.append(std::string_view(_handshake_output.data(), _handshake_output.size()));
+            _handshake_output.clear();
+            _output_pending = _out.put(std::move(msg).release());
+        } catch (...) {
+            _output_pending = make_exception_future<>(std::current_exception());
+        }
+        return make_ready_future<>();
+    }
 
     static session * from_transport_ptr(gnutls_transport_ptr_t ptr) {
         return static_cast<session *>(ptr);
@@ -1268,7 +1617,111 @@ public:
         });
     }
 
+#ifdef SEASTAR_HAVE_KTLS
+    // Writes one direction's traffic state into the kernel. The layout of
+    // all tls12_crypto_info_* structs is the same modulo field sizes, so
+    // the conversion from gnutls state is shared.
+    template <typename CryptoInfo>
+    bool ktls_set_crypto_info(unsigned read, uint16_t tls_version, uint16_t cipher_type,
+            const gnutls_datum_t& cipher_key, const gnutls_datum_t& iv, const unsigned char* seq) {
+        CryptoInfo info = {};
+        info.info.version = tls_version;
+        info.info.cipher_type = cipher_type;
+        if (cipher_key.size != sizeof(info.key)) {
+            return false;
+        }
+        memcpy(info.key, cipher_key.data, sizeof(info.key));
+        if (tls_version == TLS_1_2_VERSION) {
+            // TLS1.2 AEAD: gnutls hands us the 4-byte implicit part; the
+            // explicit nonce continues from the record sequence.
+            if (iv.size != sizeof(info.salt)) {
+                return false;
+            }
+            memcpy(info.salt, iv.data, sizeof(info.salt));
+            memcpy(info.iv, seq, sizeof(info.iv));
+        } else {
+            // TLS1.3: the full 12-byte iv, split into salt + iv parts.
+            if (iv.size != sizeof(info.salt) + sizeof(info.iv)) {
+                return false;
+            }
+            memcpy(info.salt, iv.data, sizeof(info.salt));
+            memcpy(info.iv, iv.data + sizeof(info.salt), sizeof(info.iv));
+        }
+        memcpy(info.rec_seq, seq, sizeof(info.rec_seq));
+        _sock->set_sockopt(SOL_TLS, read ? TLS_RX : TLS_TX, &info, sizeof(info));
+        return true;
+    }
+    bool enable_ktls_direction(unsigned read) {
+        gnutls_datum_t mac_key, iv, cipher_key;
+        unsigned char seq[8];
+        if (gnutls_record_get_state(*this, read, &mac_key, &iv, &cipher_key, seq) != 0) {
+            return false;
+        }
+        uint16_t tls_version;
+        switch (gnutls_protocol_get_version(*this)) {
+        case GNUTLS_TLS1_2:
+            tls_version = TLS_1_2_VERSION;
+            break;
+#if defined(TLS_1_3_VERSION) && GNUTLS_VERSION_NUMBER >= 0x030603
+        case GNUTLS_TLS1_3:
+            tls_version = TLS_1_3_VERSION;
+            break;
+#endif
+        default:
+            return false;
+        }
+        switch (gnutls_cipher_get(*this)) {
+        case GNUTLS_CIPHER_AES_128_GCM:
+            return ktls_set_crypto_info<tls12_crypto_info_aes_gcm_128>(read, tls_version, TLS_CIPHER_AES_GCM_128, cipher_key, iv, seq);
+#ifdef TLS_CIPHER_AES_GCM_256
+        case GNUTLS_CIPHER_AES_256_GCM:
+            return ktls_set_crypto_info<tls12_crypto_info_aes_gcm_256>(read, tls_version, TLS_CIPHER_AES_GCM_256, cipher_key, iv, seq);
+#endif
+        default:
+            return false;
+        }
+    }
+    void maybe_enable_ktls() {
+        if (!_creds->is_kernel_tls_enabled() || _ktls_tx || _ktls_rx) {
+            return;
+        }
+        try {
+            _sock->set_sockopt(SOL_TCP, TCP_ULP, "tls", 4);
+        } catch (...) {
+            // no kernel support, or not a kernel TCP socket;
+            // keep the userspace record path
+            return;
+        }
+        try {
+            _ktls_tx = enable_ktls_direction(0);
+            // receive offload is only safe if no full or partial record has
+            // been pulled into userspace buffers already
+            if (gnutls_record_check_pending(*this) == 0 && _input.empty()) {
+                _ktls_rx = enable_ktls_direction(1);
+            }
+        } catch (...) {
+            // whatever direction was enabled stays enabled; the rest keeps
+            // going through gnutls
+        }
+    }
+#else
+    void maybe_enable_ktls() {}
+#endif
+
     future<temporary_buffer<char>> do_get() {
+        if (_ktls_rx) {
+            // the kernel decrypts records for us; hand out the plaintext
+            // as-is.
+            if (!_input.empty()) {
+                return make_ready_future<temporary_buffer<char>>(std::move(_input));
+            }
+            if (eof()) {
+                return make_ready_future<temporary_buffer<char>>();
+            }
+            return wait_for_input().then([this] {
+                return do_get();
+            });
+        }
         // gnutls might have stuff in its buffers.
         auto avail = gnutls_record_check_pending(*this);
         if (avail == 0) {
@@ -1288,6 +1741,12 @@ public:
                     // Our input buffer should be empty now, so just go again
                     return do_get();
                 case GNUTLS_E_REHANDSHAKE:
+                    if (_ktls_tx) {
+                        // cannot renegotiate through a kernel-TLS socket;
+                        // the handshake records would be sent as data.
+                        _error = std::make_exception_ptr(std::system_error(GNUTLS_E_UNEXPECTED_PACKET, glts_errorc));
+                        return make_exception_future<temporary_buffer<char>>(_error);
+                    }
                     // server requests new HS. must release semaphore, so set new state
                     // and return nada.
                     _connected = false;
@@ -1316,6 +1775,17 @@ public:
 
     future<> do_put(frag_iter i, frag_iter e) {
         assert(_output_pending.available());
+        if (_ktls_tx) {
+            // the kernel encrypts the records; pass the plaintext to the
+            // socket as-is, without copying (the packet is kept alive by
+            // our caller until we resolve).
+            scattered_message<char> msg;
+            for (; i != e; ++i) {
+                msg.append_static(i->base, i->size);
+            }
+            _output_pending = _out.put(std::move(msg).release());
+            return wait_for_output();
+        }
         return do_for_each(i, e, [this](net::fragment& f) {
             auto ptr = f.base;
             auto size = f.size;
@@ -1369,6 +1839,19 @@ public:
         return n;
     }
     ssize_t vec_push(const giovec_t * iov, int iovcnt) {
+        if (_offload_active) {
+            // We are on a syscall thread, in the middle of an offloaded
+            // handshake step, so we cannot touch the output sink; collect
+            // the output in plain memory instead. It is flushed from the
+            // reactor thread when the step completes (flush_handshake_output()).
+            ssize_t n = 0;
+            for (int i = 0; i < iovcnt; ++i) {
+                auto p = reinterpret_cast<const char*>(iov[i].iov_base);
+                _handshake_output.insert(_handshake_output.end(), p, p + iov[i].iov_len);
+                n += iov[i].iov_len;
+            }
+            return n;
+        }
         if (!_output_pending.available()) {
             gnutls_transport_set_errno(*this, EAGAIN);
             return -1;
@@ -1430,6 +1913,13 @@ public:
         if (_error || !_connected) {
             return make_ready_future();
         }
+        if (_ktls_tx) {
+            // the close_notify alert would have to go out as a TLS control
+            // record, which cannot be expressed through the data sink; shut
+            // down the transport instead and let the peer see EOF.
+            _sock->shutdown_output();
+            return make_ready_future();
+        }
         auto res = gnutls_bye(*this, GNUTLS_SHUT_WR);
         if (res < 0) {
             switch (res) {
@@ -1568,10 +2058,18 @@ private:
     bool _eof = false;
     bool _shutdown = false;
     bool _connected = false;
+    // true while gnutls_handshake() runs on a syscall thread; makes
+    // vec_push() buffer output in _handshake_output instead of writing
+    // to the sink.
+    bool _offload_active = false;
+    // record crypto moved into the kernel for the respective direction
+    bool _ktls_tx = false;
+    bool _ktls_rx = false;
     std::exception_ptr _error;
 
     future<> _output_pending;
     buf_type _input;
+    std::vector<char> _handshake_output;
 
     // modify this to a unique_ptr to handle exceptions in our constructor.
     std::unique_ptr<std::remove_pointer_t<gnutls_session_t>, void(*)(gnutls_session_t)> _session;
@@ -1734,6 +2232,9 @@ public:
     bool get_reuseaddr() const override {
       return _socket.get_reuseaddr();
     }
+    void set_congestion_control(tcp_congestion_algorithm algo) override {
+      _socket.set_congestion_control(algo);
+    }
     virtual void shutdown() override {
         _socket.shutdown();
     }
@@ -98,6 +98,20 @@ public:
         return _state->_queue.pop_eventually();
     }
 
+    virtual future<std::vector<udp_datagram>> receive_batch(size_t max_datagrams) override {
+        // GRO-style delivery: drain whatever accumulated in the channel
+        // queue since the last poll in one go.
+        return _state->_queue.pop_eventually().then([this, max_datagrams] (udp_datagram datagram) {
+            std::vector<udp_datagram> batch;
+            batch.reserve(std::min(max_datagrams, _state->_queue.size() + 1));
+            batch.push_back(std::move(datagram));
+            while (batch.size() < max_datagrams && !_state->_queue.empty()) {
+                batch.push_back(_state->_queue.pop());
+            }
+            return batch;
+        });
+    }
+
     virtual future<> send(const socket_address& dst, const char* msg) override {
         return send(dst, packet::from_static_data(msg, strlen(msg)));
     }
@@ -110,6 +124,22 @@ public:
         });
     }
 
+    virtual future<> send_segmented(const socket_address& dst, packet p, size_t segment_size) override {
+        if (segment_size == 0) {
+            return make_exception_future<>(std::invalid_argument("send_segmented: segment_size must be positive"));
+        }
+        if (p.len() <= segment_size) {
+            return send(dst, std::move(p));
+        }
+        // GSO-style send: reserve send buffer space for the whole train
+        // once and let the protocol segment the payload.
+        auto len = p.len();
+        return _state->wait_for_send_buffer(len).then([this, dst, p = std::move(p), len, segment_size] () mutable {
+            p = packet(std::move(p), make_deleter([s = _state, len] { s->complete_send(len); }));
+            _proto.send_segments(_reg.port(), dst, std::move(p), segment_size);
+        });
+    }
+
     virtual bool is_closed() const override {
         return _closed;
     }
@@ -199,6 +229,48 @@ void ipv4_udp::send(uint16_t src_port, ipv4_addr dst, packet &&p)
     });
 }
 
+void ipv4_udp::send_segments(uint16_t src_port, ipv4_addr dst, packet &&p, size_t segment_size)
+{
+    auto src = _inet.host_address();
+
+    // Segment the payload up front; the segments share the original
+    // buffer, only the prepended headers are built per segment.
+    std::vector<packet> segments;
+    segments.reserve((p.len() + segment_size - 1) / segment_size);
+    for (size_t off = 0; off < p.len(); off += segment_size) {
+        auto seg = p.share(off, std::min(segment_size, p.len() - off));
+        auto hdr = seg.prepend_header<udp_hdr>();
+        hdr->src_port = src_port;
+        hdr->dst_port = dst.port;
+        hdr->len = seg.len();
+        *hdr = hton(*hdr);
+
+        offload_info oi;
+        checksummer csum;
+        ipv4_traits::udp_pseudo_header_checksum(csum, src, dst, seg.len());
+        bool needs_frag = ipv4::needs_frag(seg, ip_protocol_num::udp, _inet.hw_features());
+        if (_inet.hw_features().tx_csum_l4_offload && !needs_frag) {
+            hdr->cksum = ~csum.get();
+            oi.needs_csum = true;
+        } else {
+            csum.sum(seg);
+            hdr->cksum = csum.get();
+            oi.needs_csum = false;
+        }
+        oi.protocol = ip_protocol_num::udp;
+        seg.set_offload_info(oi);
+        segments.push_back(std::move(seg));
+    }
+
+    // Resolve the destination once for the whole train.
+    // FIXME: future is discarded
+    (void)_inet.get_l2_dst_address(dst).then([this, dst, segments = std::move(segments)] (ethernet_address e_dst) mutable {
+        for (auto&& seg : segments) {
+            _packetq.emplace_back(ipv4_traits::l4packet{dst, std::move(seg), e_dst, ip_protocol_num::udp});
+        }
+    });
+}
+
 uint16_t ipv4_udp::next_port(uint16_t port) {
     return (port + 1) == 0 ? min_anonymous_port : port + 1;
 }
@@ -0,0 +1,366 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 Scylladb, Ltd.
+ */
+
+#include <seastar/rpc/lz4_streaming_compressor.hh>
+#include <seastar/core/byteorder.hh>
+
+#include <lz4.h>
+// LZ4_DECODER_RING_BUFFER_SIZE macro is introduced since v1.8.2
+// To work with previous lz4 release, copied the definition in lz4 here
+#ifndef LZ4_DECODER_RING_BUFFER_SIZE
+#define LZ4_DECODER_RING_BUFFER_SIZE(maxBlockSize) (65536 + 14 + (maxBlockSize))
+#endif
+
+namespace seastar {
+namespace rpc {
+
+// Wire format is the same as LZ4_FRAGMENTED:
+// The message consists of one or more data chunks each preceeded by a 4 byte header.
+// The value of the header detrmines the size of the chunk:
+// - most significant bit is cleared: intermediate chunk, 31 least significant bits
+//   contain the compressed size of the chunk (i.e. how it appears on wire), the
+//   decompressed size is 32 kB.
+// - most significant bit is set: last chunk, 31 least significant bits contain the
+//   decompressed size of the chunk, the compressed size is the remaining part of
+//   the message.
+// All metadata is little-endian.
+//
+// Unlike LZ4_FRAGMENTED the streams are not reset between messages: each chunk
+// may back-reference up to 64 kB of data from earlier chunks, including chunks of
+// previous messages of the same connection. This means messages have to be
+// decompressed exactly once and in the order they were compressed, which the RPC
+// protocol guarantees.
+//
+// Both sides keep the recent history in a ring buffer (the standard LZ4
+// synchronised ring buffer scheme): the compressor copies plaintext chunks into
+// its ring and compresses from there, the decompressor decompresses into its
+// ring and copies the result out. Both rings are the same size and wrap at the
+// same points, so the dictionary regions stay identical.
+
+static constexpr uint32_t last_chunk_flag = uint32_t(1) << 31;
+static constexpr size_t chunk_header_size = sizeof(uint32_t);
+static constexpr size_t chunk_size = 32 * 1024;
+static constexpr size_t ring_size = LZ4_DECODER_RING_BUFFER_SIZE(chunk_size);
+
+namespace {
+
+struct compression_stream_deleter {
+    void operator()(LZ4_stream_t* stream) const noexcept {
+        LZ4_freeStream(stream);
+    }
+};
+
+struct decompression_stream_deleter {
+    void operator()(LZ4_streamDecode_t* stream) const noexcept {
+        LZ4_freeStreamDecode(stream);
+    }
+};
+
+}
+
+class lz4_streaming_compressor::impl {
+    // Per-direction state, allocated on first use so that one-directional
+    // connections pay only for the direction they compress.
+    std::unique_ptr<LZ4_stream_t, compression_stream_deleter> _compress_stream;
+    std::unique_ptr<LZ4_streamDecode_t, decompression_stream_deleter> _decompress_stream;
+    std::unique_ptr<char[]> _tx_ring;
+    std::unique_ptr<char[]> _rx_ring;
+    size_t _tx_offset = 0;
+    size_t _rx_offset = 0;
+public:
+    snd_buf compress(size_t head_space, snd_buf data);
+    rcv_buf decompress(rcv_buf data);
+};
+
+snd_buf lz4_streaming_compressor::impl::compress(size_t head_space, snd_buf data) {
+    static_assert(chunk_size <= snd_buf::chunk_size, "chunk_size <= snd_buf::chunk_size");
+
+    if (!_compress_stream) {
+        _compress_stream.reset(LZ4_createStream());
+        _tx_ring = std::make_unique<char[]>(ring_size);
+    }
+
+    auto src = std::get_if<temporary_buffer<char>>(&data.bufs);
+    if (!src) {
+        src = std::get<std::vector<temporary_buffer<char>>>(data.bufs).data();
+    }
+    size_t src_offset = 0;
+
+    // Copies the next n bytes of source data into the history ring and returns
+    // a pointer to them. The copy doubles as linearisation of fragmented
+    // sources. The wrap rule has to match ring_dest() in decompress().
+    auto fill_ring = [&] (size_t n) {
+        if (_tx_offset + n > ring_size) {
+            _tx_offset = 0;
+        }
+        auto ptr = _tx_ring.get() + _tx_offset;
+        _tx_offset += n;
+        auto dst = ptr;
+        auto left = n;
+        while (left) {
+            if (src_offset == src->size()) {
+                ++src;
+                src_offset = 0;
+            }
+            auto this_size = std::min(left, src->size() - src_offset);
+            dst = std::copy_n(src->get() + src_offset, this_size, dst);
+            src_offset += this_size;
+            left -= this_size;
+        }
+        return ptr;
+    };
+
+    auto src_left = data.size;
+
+    auto single_chunk_size = LZ4_COMPRESSBOUND(src_left) + head_space + chunk_header_size;
+    if (single_chunk_size <= chunk_size && src_left <= chunk_size) {
+        // faster path for small messages
+        auto dst = temporary_buffer<char>(single_chunk_size);
+        auto header = dst.get_write() + head_space;
+        auto compressed_data = header + chunk_header_size;
+        auto src_ptr = fill_ring(src_left);
+        auto compressed_size = LZ4_compress_fast_continue(_compress_stream.get(), src_ptr, compressed_data, src_left, LZ4_COMPRESSBOUND(src_left), 0);
+        write_le<uint32_t>(header, last_chunk_flag | src_left);
+        dst.trim(head_space + chunk_header_size + compressed_size);
+        return snd_buf(std::move(dst));
+    }
+
+    static constexpr size_t chunk_compress_bound = LZ4_COMPRESSBOUND(chunk_size);
+    static constexpr size_t chunk_maximum_compressed_size = chunk_compress_bound + chunk_header_size;
+    static_assert(chunk_maximum_compressed_size < snd_buf::chunk_size, "chunk_maximum_compressed_size is too large");
+
+    std::vector<temporary_buffer<char>> dst_buffers;
+    size_t dst_offset = head_space;
+    size_t total_compressed_size = 0;
+
+    dst_buffers.emplace_back(std::max<size_t>(head_space, snd_buf::chunk_size));
+
+    // Intermediate chunks
+    while (src_left > chunk_size) {
+        // Check if we can fit another chunk in the current destination fragment.
+        // If not allocate a new one.
+        if (dst_offset + chunk_maximum_compressed_size > dst_buffers.back().size()) {
+            dst_buffers.back().trim(dst_offset);
+            dst_buffers.emplace_back(snd_buf::chunk_size);
+            dst_offset = 0;
+        }
+
+        auto src_ptr = fill_ring(chunk_size);
+        auto header = dst_buffers.back().get_write() + dst_offset;
+        auto dst = header + chunk_header_size;
+
+        auto compressed_size = LZ4_compress_fast_continue(_compress_stream.get(), src_ptr, dst, chunk_size, chunk_compress_bound, 0);
+        write_le<uint32_t>(header, compressed_size);
+
+        dst_offset += compressed_size + chunk_header_size;
+        total_compressed_size += compressed_size + chunk_header_size;
+        src_left -= chunk_size;
+    }
+
+    // Last chunk
+    auto last_chunk_compress_bound = LZ4_COMPRESSBOUND(src_left);
+    auto last_chunk_maximum_compressed_size = last_chunk_compress_bound + chunk_header_size;
+
+    // Check if we can fit the last chunk in the current destination fragment. Allocate a new one if not.
+    if (dst_offset + last_chunk_maximum_compressed_size > dst_buffers.back().size()) {
+        dst_buffers.back().trim(dst_offset);
+        dst_buffers.emplace_back(snd_buf::chunk_size);
+        dst_offset = 0;
+    }
+    auto header = dst_buffers.back().get_write() + dst_offset;
+    auto dst = header + chunk_header_size;
+
+    auto src_ptr = fill_ring(src_left);
+    auto compressed_size = LZ4_compress_fast_continue(_compress_stream.get(), src_ptr, dst, src_left, last_chunk_compress_bound, 0);
+    write_le<uint32_t>(header, last_chunk_flag | src_left);
+    dst_offset += compressed_size + chunk_header_size;
+    total_compressed_size += compressed_size + chunk_header_size + head_space;
+
+    dst_buffers.back().trim(dst_offset);
+
+    if (dst_buffers.size() == 1) {
+        return snd_buf(std::move(dst_buffers.front()));
+    }
+    return snd_buf(std::move(dst_buffers), total_compressed_size);
+}
+
+rcv_buf lz4_streaming_compressor::impl::decompress(rcv_buf data) {
+    if (data.size < chunk_header_size) {
+        return rcv_buf();
+    }
+
+    if (!_decompress_stream) {
+        _decompress_stream.reset(LZ4_createStreamDecode());
+        if (!LZ4_setStreamDecode(_decompress_stream.get(), nullptr, 0)) {
+            throw std::runtime_error("RPC frame LZ4_STREAM decompression failed to initialise state");
+        }
+        _rx_ring = std::make_unique<char[]>(ring_size);
+    }
+
+    auto src = std::get_if<temporary_buffer<char>>(&data.bufs);
+    if (!src) {
+        src = std::get<std::vector<temporary_buffer<char>>>(data.bufs).data();
+    }
+    size_t src_left = data.size;
+    size_t src_offset = 0;
+
+    // Prepare source data. Returns pointer to n contiguous bytes of source data.
+    // Avoids copy if possible, otherwise uses dst as a temporary storage.
+    auto copy_src = [&] (char* dst, size_t n) -> const char* {
+        // Fast path, no need to copy anything.
+        if (src->size() - src_offset >= n) {
+            auto ptr = src->get() + src_offset;
+            src_left -= n;
+            src_offset += n;
+            return ptr;
+        }
+
+        // Need to linearise source chunk into dst.
+        auto ptr = dst;
+        src_left -= n;
+        while (n) {
+            if (src_offset == src->size()) {
+                ++src;
+                src_offset = 0;
+            }
+            auto this_size = std::min(n, src->size() - src_offset);
+            std::copy_n(src->get() + src_offset, this_size, dst);
+            n -= this_size;
+            dst += this_size;
+            src_offset += this_size;
+        }
+        return ptr;
+    };
+
+    // Read, possibly fragmented, header.
+    auto read_header = [&] {
+        uint32_t header_value;
+        auto ptr = copy_src(reinterpret_cast<char*>(&header_value), chunk_header_size);
+        if (ptr != reinterpret_cast<char*>(&header_value)) {
+            std::copy_n(ptr, sizeof(uint32_t), reinterpret_cast<char*>(&header_value));
+        }
+        return le_to_cpu(header_value);
+    };
+
+    // Returns the ring region the next n decompressed bytes go to. The wrap
+    // rule has to match fill_ring() on the compressing side, otherwise the
+    // dictionaries diverge.
+    auto ring_dest = [&] (size_t n) {
+        if (_rx_offset + n > ring_size) {
+            _rx_offset = 0;
+        }
+        auto ptr = _rx_ring.get() + _rx_offset;
+        _rx_offset += n;
+        return ptr;
+    };
+
+    // Let's be a bit paranoid and not assume that the remote has the same
+    // LZ4_COMPRESSBOUND as we do and allow any compressed chunk size.
+    static thread_local auto chunk_buffer = temporary_buffer<char>(LZ4_COMPRESSBOUND(chunk_size));
+
+    std::vector<temporary_buffer<char>> dst_buffers;
+    size_t total_size = 0;
+    size_t dst_offset = 0;
+
+    constexpr auto buf_size = 64 * 1024;
+
+    auto get_dest = [&] (size_t size) {
+        if (dst_buffers.empty()) {
+            dst_buffers.emplace_back(buf_size);
+        }
+        if (dst_buffers.back().size() - dst_offset < size) {
+            dst_buffers.back().trim(dst_offset);
+            dst_buffers.emplace_back(buf_size);
+            dst_offset = 0;
+        }
+        return dst_buffers.back().get_write() + std::exchange(dst_offset, dst_offset + size);
+    };
+
+    // Intermediate chunks
+    uint32_t header_value = read_header();
+    while (!(header_value & last_chunk_flag)) {
+        if (chunk_buffer.size() < header_value) {
+            chunk_buffer = temporary_buffer<char>(header_value);
+        }
+        auto src_ptr = copy_src(chunk_buffer.get_write(), header_value);
+        auto ring_ptr = ring_dest(chunk_size);
+        if (LZ4_decompress_safe_continue(_decompress_stream.get(), src_ptr, ring_ptr, header_value, chunk_size) != int(chunk_size)) {
+            throw std::runtime_error(format("RPC frame LZ4_STREAM decompression failure (at {} bytes)", total_size));
+        }
+        std::copy_n(ring_ptr, chunk_size, get_dest(chunk_size));
+        total_size += chunk_size;
+        header_value = read_header();
+    }
+
+    // Last chunk
+    header_value &= ~last_chunk_flag;
+    if (header_value > chunk_size) {
+        // A chunk larger than the ring would overflow it, a well-formed
+        // message never contains one.
+        throw std::runtime_error(format("RPC frame LZ4_STREAM invalid last chunk size {}", header_value));
+    }
+    if (chunk_buffer.size() < src_left) {
+        chunk_buffer = temporary_buffer<char>(src_left);
+    }
+    auto last_chunk_compressed_size = src_left;
+    auto src_ptr = copy_src(chunk_buffer.get_write(), src_left);
+    auto ring_ptr = ring_dest(header_value);
+    if (LZ4_decompress_safe_continue(_decompress_stream.get(), src_ptr, ring_ptr, last_chunk_compressed_size, header_value) != int(header_value)) {
+        throw std::runtime_error(format("RPC frame LZ4_STREAM decompression failure (last chunk, at {} bytes)", total_size));
+    }
+    std::copy_n(ring_ptr, header_value, get_dest(header_value));
+    total_size += header_value;
+
+    dst_buffers.back().trim(dst_offset);
+
+    if (dst_buffers.size() == 1) {
+        return rcv_buf(std::move(dst_buffers.front()));
+    }
+    return rcv_buf(std::move(dst_buffers), total_size);
+}
+
+lz4_streaming_compressor::lz4_streaming_compressor() : _impl(std::make_unique<impl>()) { }
+
+lz4_streaming_compressor::~lz4_streaming_compressor() = default;
+
+sstring lz4_streaming_compressor::name() const {
+    return factory{}.supported();
+}
+
+const sstring& lz4_streaming_compressor::factory::supported() const {
+    const static sstring name = "LZ4_STREAM";
+    return name;
+}
+
+std::unique_ptr<rpc::compressor> lz4_streaming_compressor::factory::negotiate(sstring feature, bool is_server) const {
+    return feature == supported() ? std::make_unique<lz4_streaming_compressor>() : nullptr;
+}
+
+snd_buf lz4_streaming_compressor::compress(size_t head_space, snd_buf data) {
+    return _impl->compress(head_space, std::move(data));
+}
+
+rcv_buf lz4_streaming_compressor::decompress(rcv_buf data) {
+    return _impl->decompress(std::move(data));
+}
+
+}
+}
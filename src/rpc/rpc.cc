@@ -3,6 +3,7 @@
 #include <seastar/core/seastar.hh>
 #include <seastar/core/print.hh>
 #include <seastar/core/future-util.hh>
+#include <seastar/core/metrics.hh>
 #include <boost/range/adaptor/map.hpp>
 
 #if FMT_VERSION >= 90000
@@ -148,9 +149,19 @@ namespace rpc {
               d.buf.size -= 8;
           }
       }
+      auto raw_size = d.buf.size;
       auto buf = compress(std::move(d.buf));
-      return send_buffer(std::move(buf)).then([this] {
+      auto wire_size = buf.size;
+      return send_buffer(std::move(buf)).then([this, &d, wire_size, raw_size] {
           _stats.sent_messages++;
+          _rollup.add_message(wire_size, raw_size);
+          if (d.coalesce && _outgoing_queue_size > 0) {
+              // More frames will be written right behind this one; let the
+              // last frame of the burst issue a single flush for all of them.
+              _needs_flush = true;
+              return make_ready_future<>();
+          }
+          _needs_flush = false;
           return _write_buf.flush();
       });
   }
@@ -258,15 +269,44 @@ namespace rpc {
       }
   }
 
-  future<> connection::send(snd_buf buf, std::optional<rpc_clock_type::time_point> timeout, cancellable* cancel) {
+  future<> connection::send(snd_buf buf, std::optional<rpc_clock_type::time_point> timeout, cancellable* cancel, bool coalesce) {
       if (!_error) {
           if (timeout && *timeout <= rpc_clock_type::now()) {
               return make_ready_future<>();
           }
 
-          auto p = std::make_unique<outgoing_entry>(std::move(buf));
+          auto p = std::make_unique<outgoing_entry>(std::move(buf), coalesce);
           auto& d = *p;
-          _outgoing_queue.push_back(d);
+          future<> wait_for = make_ready_future<>();
+          auto pos = _outgoing_queue.end();
+          if (_large_msg_threshold != 0 && !_is_stream && d.buf.size < _large_msg_threshold && !_outgoing_queue.empty()) {
+              // A small message may overtake queued large ones: messages are
+              // matched by id, not by arrival order, so jumping the queue
+              // saves the small message from waiting out a multi-megabyte
+              // write without affecting correctness. The front entry is
+              // already inside send_entry() and cannot be overtaken.
+              pos = std::find_if(std::next(_outgoing_queue.begin()), _outgoing_queue.end(), [this] (const outgoing_entry& e) {
+                  return e.buf.size >= _large_msg_threshold;
+              });
+          }
+          if (pos == _outgoing_queue.end()) {
+              _outgoing_queue.push_back(d);
+              // New entry should continue (do its .then() lambda) after _outgoing_queue_ready
+              // resolves. Next entry will need to do the same after this entry's done resolves.
+              // Thus -- replace _outgoing_queue_ready with d's future and chain its continuation
+              // on ..._ready's old value.
+              wait_for = std::exchange(_outgoing_queue_ready, d.done.get_future());
+          } else {
+              // Splice d into the promise chain in front of pos: the previous
+              // entry's done promise must now fire d's continuation, while
+              // d's done must fire pos's continuation, which is achieved by
+              // exchanging the promises (compare withdraw()).
+              _outgoing_queue.insert(pos, d);
+              auto pit = std::prev(_outgoing_queue.iterator_to(d));
+              promise<> pr;
+              wait_for = pr.get_future();
+              d.done = std::exchange(pit->done, std::move(pr));
+          }
           _outgoing_queue_size++;
           auto deleter = [this, it = _outgoing_queue.iterator_to(d)] {
               // Front entry is most likely (unless _negotiated is unresolved, check enqueue_zero_frame()) sitting
@@ -287,14 +327,16 @@ namespace rpc {
               d.pcancel = cancel;
           }
 
-          // New entry should continue (do its .then() lambda) after _outgoing_queue_ready
-          // resolves. Next entry will need to do the same after this entry's done resolves.
-          // Thus -- replace _outgoing_queue_ready with d's future and chain its continuation
-          // on ..._ready's old value.
-          return std::exchange(_outgoing_queue_ready, d.done.get_future()).then([this, p = std::move(p)] () mutable {
+          return wait_for.then([this, p = std::move(p)] () mutable {
               _outgoing_queue_size--;
               if (__builtin_expect(!p->is_linked(), false)) {
-                  // If withdrawn the entry is unlinked and this lambda is fired right at once
+                  // If withdrawn the entry is unlinked and this lambda is fired right at once.
+                  // An earlier frame may have deferred its flush expecting this entry to write;
+                  // if nothing else is queued, flush on its behalf.
+                  if (_needs_flush && _outgoing_queue_size == 0) {
+                      _needs_flush = false;
+                      return _write_buf.flush();
+                  }
                   return make_ready_future<>();
               }
 
@@ -421,9 +463,9 @@ namespace rpc {
 
   template<typename FrameType>
   typename FrameType::return_type
-  connection::read_frame(socket_address info, input_stream<char>& in) {
+  connection::read_frame(socket_address info, input_stream<char>& in, bool account) {
       auto header_size = FrameType::header_size();
-      return in.read_exactly(header_size).then([this, header_size, info, &in] (temporary_buffer<char> header) {
+      return in.read_exactly(header_size).then([this, header_size, info, &in, account] (temporary_buffer<char> header) {
           if (header.size() != header_size) {
               if (header.size() != 0) {
                   _logger(info, format("unexpected eof on a {} while reading header: expected {:d} got {:d}", FrameType::role(), header_size, header.size()));
@@ -433,13 +475,19 @@ namespace rpc {
           auto h = FrameType::decode_header(header.get());
           auto size = FrameType::get_size(h);
           if (!size) {
+              if (account) {
+                  _rollup.add_message(header_size, header_size);
+              }
               return FrameType::make_value(h, rcv_buf());
           } else {
-              return read_rcv_buf(in, size).then([this, info, h = std::move(h), size] (rcv_buf rb) {
+              return read_rcv_buf(in, size).then([this, info, h = std::move(h), size, header_size, account] (rcv_buf rb) {
                   if (rb.size != size) {
                       _logger(info, format("unexpected eof on a {} while reading data: expected {:d} got {:d}", FrameType::role(), size, rb.size));
                       return FrameType::empty_value();
                   } else {
+                      if (account) {
+                          _rollup.add_message(header_size + size, header_size + size);
+                      }
                       return FrameType::make_value(h, std::move(rb));
                   }
               });
@@ -466,6 +514,7 @@ namespace rpc {
                       return FrameType::empty_value();
                   }
                   auto eb = compressor->decompress(std::move(compressed_data));
+                  _rollup.add_message(4 + size, eb.size);
                   net::packet p;
                   auto* one = std::get_if<temporary_buffer<char>>(&eb.bufs);
                   if (one) {
@@ -478,7 +527,8 @@ namespace rpc {
                       }
                   }
                   return do_with(as_input_stream(std::move(p)), [this, info] (input_stream<char>& in) {
-                      return read_frame<FrameType>(info, in);
+                      // already accounted above, against the wire size
+                      return read_frame<FrameType>(info, in, false);
                   });
               });
           });
@@ -662,6 +712,78 @@ namespace rpc {
       return read_frame_compressed<response_frame>(_server_addr, _compressor, in);
   }
 
+  void client::dispatch_response(int64_t msg_id, std::optional<rcv_buf> data) {
+      auto it = _outstanding.find(std::abs(msg_id));
+      if (!data) {
+          _error = true;
+      } else if (it != _outstanding.end()) {
+          auto handler = std::move(it->second);
+          _outstanding.erase(it);
+          (*handler)(*this, msg_id, std::move(data.value()));
+      } else if (msg_id < 0) {
+          try {
+              std::rethrow_exception(unmarshal_exception(data.value()));
+          } catch(const unknown_verb_error& ex) {
+              // if this is unknown verb exception with unknown id ignore it
+              // can happen if unknown verb was used by no_wait client
+              get_logger()(peer_address(), format("unknown verb exception {:d} ignored", ex.type));
+          } catch(...) {
+              // We've got error response but handler is no longer waiting, could be timed out.
+              log_exception(*this, log_level::info, "ignoring error response", std::current_exception());
+          }
+      } else {
+          // we get a reply for a message id not in _outstanding
+          // this can happened if the message id is timed out already
+          get_logger()(peer_address(), log_level::debug, "got a reply for an expired message id");
+      }
+  }
+
+  future<> client::handle_response_frames() {
+      // Completion moderation: at high response rates a single network read
+      // fills the input buffer with many complete response frames. Decode
+      // and dispatch all of them from this one task, straight out of the
+      // stream buffer, instead of re-entering the generic frame reader -
+      // and its continuation chain - once per response. Compressed
+      // connections wrap every frame in a compression header, so they take
+      // the generic path below.
+      while (!_compressor && !_error && !need_preempt()) {
+          auto header_size = response_frame::header_size();
+          if (_read_buf.available() < header_size) {
+              break;
+          }
+          auto header = _read_buf.read_exactly(header_size).get0();
+          auto h = response_frame::decode_header(header.get());
+          auto msg_id = std::get<0>(h);
+          auto size = response_frame::get_size(h);
+          if (!size) {
+              _rollup.add_message(header_size, header_size);
+              dispatch_response(msg_id, rcv_buf());
+          } else if (_read_buf.available() >= size) {
+              auto data = _read_buf.read_exactly(size).get0();
+              _rollup.add_message(header_size + size, header_size + size);
+              dispatch_response(msg_id, rcv_buf(std::move(data)));
+          } else {
+              // The header is consumed but the body is not buffered yet;
+              // finish this frame through the async path.
+              return read_rcv_buf(_read_buf, size).then([this, msg_id, size, header_size] (rcv_buf rb) {
+                  if (rb.size != size) {
+                      _logger(_server_addr, format("unexpected eof on a {} while reading data: expected {:d} got {:d}", response_frame::role(), size, rb.size));
+                      dispatch_response(msg_id, std::nullopt);
+                  } else {
+                      _rollup.add_message(header_size + size, header_size + size);
+                      dispatch_response(msg_id, std::move(rb));
+                  }
+              });
+          }
+      }
+      if (_error) {
+          return make_ready_future<>();
+      }
+      return read_response_frame_compressed(_read_buf).then([this] (std::tuple<int64_t, std::optional<rcv_buf>> msg_id_and_data) {
+          dispatch_response(std::get<0>(msg_id_and_data), std::move(std::get<1>(msg_id_and_data)));
+      });
+  }
+
   stats client::get_stats() const {
       stats res = _stats;
       res.wait_reply = _outstanding.size();
@@ -740,6 +862,7 @@ namespace rpc {
 
   client::client(const logger& l, void* s, client_options ops, socket socket, const socket_address& addr, const socket_address& local)
   : rpc::connection(l, s), _socket(std::move(socket)), _server_addr(addr), _local_addr(local), _options(ops) {
+       _large_msg_threshold = ops.large_message_threshold;
        _socket.set_reuseaddr(ops.reuseaddr);
       // Run client in the background.
       // Communicate result via _stopped.
@@ -775,33 +898,7 @@ namespace rpc {
                   if (is_stream()) {
                       return handle_stream_frame();
                   }
-                  return read_response_frame_compressed(_read_buf).then([this] (std::tuple<int64_t, std::optional<rcv_buf>> msg_id_and_data) {
-                      auto& msg_id = std::get<0>(msg_id_and_data);
-                      auto& data = std::get<1>(msg_id_and_data);
-                      auto it = _outstanding.find(std::abs(msg_id));
-                      if (!data) {
-                          _error = true;
-                      } else if (it != _outstanding.end()) {
-                          auto handler = std::move(it->second);
-                          _outstanding.erase(it);
-                          (*handler)(*this, msg_id, std::move(data.value()));
-                      } else if (msg_id < 0) {
-                          try {
-                              std::rethrow_exception(unmarshal_exception(data.value()));
-                          } catch(const unknown_verb_error& ex) {
-                              // if this is unknown verb exception with unknown id ignore it
-                              // can happen if unknown verb was used by no_wait client
-                              get_logger()(peer_address(), format("unknown verb exception {:d} ignored", ex.type));
-                          } catch(...) {
-                              // We've got error response but handler is no longer waiting, could be timed out.
-                              log_exception(*this, log_level::info, "ignoring error response", std::current_exception());
-                          }
-                      } else {
-                          // we get a reply for a message id not in _outstanding
-                          // this can happened if the message id is timed out already
-                          get_logger()(peer_address(), log_level::debug, "got a reply for an expired message id");
-                      }
-                  });
+                  return handle_response_frames();
               });
           });
       }).then_wrapped([this] (future<> f) {
@@ -1094,6 +1191,7 @@ future<> server::connection::send_unknown_verb_reply(std::optional<rpc_clock_typ
 
   server::connection::connection(server& s, connected_socket&& fd, socket_address&& addr, const logger& l, void* serializer, connection_id id)
       : rpc::connection(std::move(fd), l, serializer, id), _server(s) {
+      _large_msg_threshold = s._options.large_message_threshold;
       _info.addr = std::move(addr);
   }
 
@@ -1132,9 +1230,50 @@ future<> server::connection::send_unknown_verb_reply(std::optional<rpc_clock_typ
           }
           _servers[*_options.streaming_domain] = this;
       }
+      if (!_options.metrics_domain.empty()) {
+          setup_metrics();
+      }
       accept();
   }
 
+  void server::setup_metrics() {
+      namespace sm = seastar::metrics;
+      auto domain = sm::label_instance("domain", _options.metrics_domain);
+      std::vector<sm::metric_definition> defs;
+      using window_of_t = connection_rollup::window& (connection_rollup::*)() noexcept;
+      for (auto [label, window_of] : {std::pair<const char*, window_of_t>{"1s", &connection_rollup::short_window},
+                                      std::pair<const char*, window_of_t>{"10s", &connection_rollup::long_window}}) {
+          auto window = sm::label_instance("window", label);
+          auto sum = [this, window_of] (ewma_rate connection_rollup::window::* rate) {
+              double total = 0;
+              for (auto&& c : _conns) {
+                  total += ((c.second->rollup().*window_of)().*rate).rate();
+              }
+              return total;
+          };
+          defs.emplace_back(sm::make_gauge("messages_per_second",
+                  sm::description("Messages sent and received over all of the server's connections"),
+                  { domain, window },
+                  [sum] { return sum(&connection_rollup::window::messages); }));
+          defs.emplace_back(sm::make_gauge("wire_bytes_per_second",
+                  sm::description("Bytes sent and received on the wire, after compression"),
+                  { domain, window },
+                  [sum] { return sum(&connection_rollup::window::wire_bytes); }));
+          defs.emplace_back(sm::make_gauge("raw_bytes_per_second",
+                  sm::description("Payload bytes sent and received, before compression"),
+                  { domain, window },
+                  [sum] { return sum(&connection_rollup::window::raw_bytes); }));
+          defs.emplace_back(sm::make_gauge("compression_ratio",
+                  sm::description("Ratio of payload bytes to wire bytes over the window"),
+                  { domain, window },
+                  [sum] {
+                      auto wire = sum(&connection_rollup::window::wire_bytes);
+                      return wire ? sum(&connection_rollup::window::raw_bytes) / wire : 1.;
+                  }));
+      }
+      _metrics.add_group("rpc", std::move(defs));
+  }
+
   server::server(protocol_base* proto, server_options opts, server_socket ss, resource_limits limits)
           : server(proto, std::move(ss), limits, opts)
   {}
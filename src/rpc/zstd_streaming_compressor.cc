@@ -0,0 +1,239 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 Scylladb, Ltd.
+ */
+
+#include <seastar/rpc/zstd_streaming_compressor.hh>
+#include <seastar/core/print.hh>
+
+#include <zstd.h>
+
+namespace seastar {
+namespace rpc {
+
+// Wire format: a message carries the next bytes of one continuous zstd
+// frame per direction. The frame is never ended; instead the compressor
+// issues a zstd flush at every message boundary, which makes the bytes
+// of a message fully decodable on their own while letting later
+// messages back-reference earlier ones. Messages therefore have to be
+// decompressed exactly once and in the order they were compressed,
+// which the rpc protocol guarantees.
+
+namespace {
+
+struct cctx_deleter {
+    void operator()(ZSTD_CCtx* ctx) const noexcept {
+        ZSTD_freeCCtx(ctx);
+    }
+};
+
+struct dctx_deleter {
+    void operator()(ZSTD_DCtx* ctx) const noexcept {
+        ZSTD_freeDCtx(ctx);
+    }
+};
+
+void check_zstd(size_t ret, const char* what) {
+    if (ZSTD_isError(ret)) {
+        throw std::runtime_error(format("RPC frame ZSTD_STREAM {}: {}", what, ZSTD_getErrorName(ret)));
+    }
+}
+
+}
+
+class zstd_streaming_compressor::impl {
+    int _level;
+    lw_shared_ptr<sstring> _dictionary;
+    // Per-direction state, allocated on first use so that one-directional
+    // connections pay only for the direction they compress.
+    std::unique_ptr<ZSTD_CCtx, cctx_deleter> _cctx;
+    std::unique_ptr<ZSTD_DCtx, dctx_deleter> _dctx;
+public:
+    impl(int level, lw_shared_ptr<sstring> dictionary)
+        : _level(level), _dictionary(std::move(dictionary)) {}
+    snd_buf compress(size_t head_space, snd_buf data);
+    rcv_buf decompress(rcv_buf data);
+};
+
+snd_buf zstd_streaming_compressor::impl::compress(size_t head_space, snd_buf data) {
+    if (!_cctx) {
+        _cctx.reset(ZSTD_createCCtx());
+        if (!_cctx) {
+            throw std::bad_alloc();
+        }
+        check_zstd(ZSTD_CCtx_setParameter(_cctx.get(), ZSTD_c_compressionLevel, _level), "failed to set compression level");
+        if (_dictionary) {
+            check_zstd(ZSTD_CCtx_loadDictionary(_cctx.get(), _dictionary->data(), _dictionary->size()), "failed to load dictionary");
+        }
+    }
+
+    auto src = std::get_if<temporary_buffer<char>>(&data.bufs);
+    size_t nr_src = 1;
+    if (!src) {
+        auto& bufs = std::get<std::vector<temporary_buffer<char>>>(data.bufs);
+        src = bufs.data();
+        nr_src = bufs.size();
+    }
+
+    std::vector<temporary_buffer<char>> dst_buffers;
+    dst_buffers.emplace_back(std::max<size_t>(head_space, snd_buf::chunk_size));
+    ZSTD_outBuffer out = { dst_buffers.back().get_write(), dst_buffers.back().size(), head_space };
+
+    auto more_out = [&] {
+        dst_buffers.back().trim(out.pos);
+        dst_buffers.emplace_back(snd_buf::chunk_size);
+        out = { dst_buffers.back().get_write(), dst_buffers.back().size(), 0 };
+    };
+
+    auto src_left = data.size;
+    for (size_t i = 0; i < nr_src && src_left; ++i) {
+        auto this_size = std::min<size_t>(src_left, src[i].size());
+        ZSTD_inBuffer in = { src[i].get(), this_size, 0 };
+        while (in.pos < in.size) {
+            if (out.pos == out.size) {
+                more_out();
+            }
+            check_zstd(ZSTD_compressStream2(_cctx.get(), &out, &in, ZSTD_e_continue), "compression failure");
+        }
+        src_left -= this_size;
+    }
+
+    // Align the stream with the frame edge, so the peer can decode the
+    // whole message without waiting for more data.
+    ZSTD_inBuffer in = { nullptr, 0, 0 };
+    while (true) {
+        if (out.pos == out.size) {
+            more_out();
+        }
+        auto left = ZSTD_compressStream2(_cctx.get(), &out, &in, ZSTD_e_flush);
+        check_zstd(left, "flush failure");
+        if (!left) {
+            break;
+        }
+    }
+
+    dst_buffers.back().trim(out.pos);
+    size_t total_size = 0;
+    for (auto&& b : dst_buffers) {
+        total_size += b.size();
+    }
+
+    if (dst_buffers.size() == 1) {
+        return snd_buf(std::move(dst_buffers.front()));
+    }
+    return snd_buf(std::move(dst_buffers), total_size);
+}
+
+rcv_buf zstd_streaming_compressor::impl::decompress(rcv_buf data) {
+    if (!data.size) {
+        return rcv_buf();
+    }
+
+    if (!_dctx) {
+        _dctx.reset(ZSTD_createDCtx());
+        if (!_dctx) {
+            throw std::bad_alloc();
+        }
+        if (_dictionary) {
+            check_zstd(ZSTD_DCtx_loadDictionary(_dctx.get(), _dictionary->data(), _dictionary->size()), "failed to load dictionary");
+        }
+    }
+
+    auto src = std::get_if<temporary_buffer<char>>(&data.bufs);
+    size_t nr_src = 1;
+    if (!src) {
+        auto& bufs = std::get<std::vector<temporary_buffer<char>>>(data.bufs);
+        src = bufs.data();
+        nr_src = bufs.size();
+    }
+
+    constexpr size_t buf_size = 64 * 1024;
+    std::vector<temporary_buffer<char>> dst_buffers;
+    dst_buffers.emplace_back(buf_size);
+    ZSTD_outBuffer out = { dst_buffers.back().get_write(), dst_buffers.back().size(), 0 };
+
+    auto src_left = data.size;
+    for (size_t i = 0; i < nr_src && src_left; ++i) {
+        auto this_size = std::min<size_t>(src_left, src[i].size());
+        ZSTD_inBuffer in = { src[i].get(), this_size, 0 };
+        while (in.pos < in.size) {
+            if (out.pos == out.size) {
+                dst_buffers.back().trim(out.pos);
+                dst_buffers.emplace_back(buf_size);
+                out = { dst_buffers.back().get_write(), dst_buffers.back().size(), 0 };
+            }
+            check_zstd(ZSTD_decompressStream(_dctx.get(), &out, &in), "decompression failure");
+        }
+        src_left -= this_size;
+    }
+
+    dst_buffers.back().trim(out.pos);
+    size_t total_size = 0;
+    for (auto&& b : dst_buffers) {
+        total_size += b.size();
+    }
+
+    if (dst_buffers.size() == 1) {
+        return rcv_buf(std::move(dst_buffers.front()));
+    }
+    return rcv_buf(std::move(dst_buffers), total_size);
+}
+
+zstd_streaming_compressor::zstd_streaming_compressor(int level, lw_shared_ptr<sstring> dictionary)
+    : _impl(std::make_unique<impl>(level, std::move(dictionary))) { }
+
+zstd_streaming_compressor::~zstd_streaming_compressor() = default;
+
+snd_buf zstd_streaming_compressor::compress(size_t head_space, snd_buf data) {
+    return _impl->compress(head_space, std::move(data));
+}
+
+rcv_buf zstd_streaming_compressor::decompress(rcv_buf data) {
+    return _impl->decompress(std::move(data));
+}
+
+sstring zstd_streaming_compressor::name() const {
+    return "ZSTD_STREAM";
+}
+
+zstd_streaming_compressor::factory::factory(int level, sstring dictionary)
+    : _level(level) {
+    if (dictionary.empty()) {
+        _feature = "ZSTD_STREAM";
+    } else {
+        _dictionary = make_lw_shared<sstring>(std::move(dictionary));
+        // The id makes peers with different dictionaries fail negotiation
+        // instead of producing garbage. Raw (non-ZDICT) dictionaries all
+        // report id 0; peers using those have to ensure consistency
+        // themselves.
+        auto dict_id = ZSTD_getDictID_fromDict(_dictionary->data(), _dictionary->size());
+        _feature = format("ZSTD_STREAM:dict={}", dict_id);
+    }
+}
+
+const sstring& zstd_streaming_compressor::factory::supported() const {
+    return _feature;
+}
+
+std::unique_ptr<rpc::compressor> zstd_streaming_compressor::factory::negotiate(sstring feature, bool is_server) const {
+    return feature == _feature ? std::make_unique<zstd_streaming_compressor>(_level, _dictionary) : nullptr;
+}
+
+}
+}
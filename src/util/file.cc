@@ -140,6 +140,31 @@ future<> chmod(std::string_view name, file_permissions permissions) noexcept {
     return engine().chmod(name, permissions);
 }
 
+// Entries unlinked per syscall-thread round trip; large enough to
+// amortize the wakeup and the directory fd open, small enough to keep
+// individual work items short.
+static constexpr size_t remove_entries_batch_size = 256;
+
+// Unlinks the named non-directory entries of dir, in dirfd-relative
+// batches of remove_entries_batch_size. The batches are submitted in
+// parallel, pipelining the syscall thread instead of paying a full
+// round trip per file.
+static future<> remove_directory_entries(const fs::path& dir, std::vector<sstring> names) {
+    if (names.empty()) {
+        return make_ready_future<>();
+    }
+    std::vector<std::vector<sstring>> batches;
+    for (size_t i = 0; i < names.size(); i += remove_entries_batch_size) {
+        auto end = std::min(i + remove_entries_batch_size, names.size());
+        batches.emplace_back(std::make_move_iterator(names.begin() + i), std::make_move_iterator(names.begin() + end));
+    }
+    return do_with(std::move(batches), sstring(dir.native()), [] (std::vector<std::vector<sstring>>& batches, sstring& dir) {
+        return parallel_for_each(batches, [&dir] (std::vector<sstring>& batch) {
+            return engine().remove_files_at(dir, std::move(batch));
+        });
+    });
+}
+
 static future<> do_recursive_remove_directory(const fs::path path) noexcept {
     struct work_entry {
         const fs::path path;
@@ -161,21 +186,22 @@ static future<> do_recursive_remove_directory(const fs::path path) noexcept {
                 return remove_file(ent.path.native());
             } else {
                 work_queue.emplace_back(ent.path, true);
-                return do_with(std::move(ent.path), [&work_queue] (const fs::path& path) {
-                    return open_directory(path.native()).then([&path, &work_queue] (file dir) mutable {
-                        return do_with(std::move(dir), [&path, &work_queue] (file& dir) mutable {
-                            return dir.list_directory([&path, &work_queue] (directory_entry de) mutable {
-                                const fs::path sub_path = path / de.name.c_str();
+                return do_with(std::move(ent.path), std::vector<sstring>(), [&work_queue] (const fs::path& path, std::vector<sstring>& files) {
+                    return open_directory(path.native()).then([&path, &work_queue, &files] (file dir) mutable {
+                        return do_with(std::move(dir), [&path, &work_queue, &files] (file& dir) mutable {
+                            return dir.list_directory([&path, &work_queue, &files] (directory_entry de) mutable {
                                 if (de.type && *de.type == directory_entry_type::directory) {
-                                    work_queue.emplace_back(std::move(sub_path), false);
+                                    work_queue.emplace_back(path / de.name.c_str(), false);
                                 } else {
-                                    work_queue.emplace_back(std::move(sub_path), true);
+                                    files.emplace_back(std::move(de.name));
                                 }
                                 return make_ready_future<>();
                             }).done().then([&dir] () mutable {
                                 return dir.close();
                             });
                         });
+                    }).then([&path, &files] {
+                        return remove_directory_entries(path, std::move(files));
                     });
                 });
             }
@@ -201,6 +227,103 @@ future<> recursive_remove_directory(fs::path path) noexcept {
     });
 }
 
+static constexpr size_t directory_scan_batch_size = 128;
+static constexpr size_t directory_scan_stat_concurrency = 16;
+
+struct directory_scan_state {
+    std::deque<fs::path> dirs;
+    std::vector<fs::path> pending_stat;
+    std::vector<directory_scan_entry> batch;
+    directory_scan_consumer consumer;
+};
+
+static future<> directory_scan_flush(directory_scan_state& s, bool force) {
+    if (s.batch.empty() || (!force && s.batch.size() < directory_scan_batch_size)) {
+        return make_ready_future<>();
+    }
+    return s.consumer(std::exchange(s.batch, {}));
+}
+
+static future<> directory_scan_stat_pending(directory_scan_state& s) {
+    return max_concurrent_for_each(s.pending_stat, directory_scan_stat_concurrency, [&s] (const fs::path& p) {
+        return file_stat(p.native(), follow_symlink::no).then([&s, &p] (stat_data sd) {
+            s.batch.push_back(directory_scan_entry{p, std::move(sd)});
+        });
+    }).then([&s] {
+        s.pending_stat.clear();
+        return directory_scan_flush(s, false);
+    });
+}
+
+static future<> do_recursive_scan_directory(directory_scan_state& s) {
+    return directory_scan_stat_pending(s).then([&s] {
+        return do_until([&s] { return s.dirs.empty(); }, [&s] {
+            auto dir = std::move(s.dirs.front());
+            s.dirs.pop_front();
+            return do_with(std::move(dir), [&s] (const fs::path& dir) {
+                return open_directory(dir.native()).then([&s, &dir] (file d) {
+                    return do_with(std::move(d), [&s, &dir] (file& d) {
+                        return d.list_directory([&s, &dir] (directory_entry de) {
+                            auto sub = dir / de.name.c_str();
+                            if (de.type && *de.type == directory_entry_type::directory) {
+                                s.dirs.push_back(sub);
+                            }
+                            s.pending_stat.push_back(std::move(sub));
+                            return make_ready_future<>();
+                        }).done().then([&d] {
+                            return d.close();
+                        });
+                    });
+                });
+            }).then([&s] {
+                return directory_scan_stat_pending(s);
+            });
+        });
+    }).then([&s] {
+        return directory_scan_flush(s, true);
+    });
+}
+
+future<> recursive_scan_directory(fs::path path, std::function<directory_scan_consumer ()> consumer_factory) {
+    // The subtrees rooted at path's immediate children are handed out
+    // round-robin; entries are stat-ed by the shard that owns their subtree.
+    struct partitions {
+        std::vector<std::vector<fs::path>> dirs;
+        std::vector<std::vector<fs::path>> files;
+        partitions() : dirs(smp::count), files(smp::count) {}
+    };
+    return do_with(partitions(), std::move(path), [consumer_factory = std::move(consumer_factory)] (partitions& parts, const fs::path& path) {
+        return open_directory(path.native()).then([&parts, &path] (file d) {
+            return do_with(std::move(d), unsigned(0), [&parts, &path] (file& d, unsigned& next_shard) {
+                return d.list_directory([&parts, &path, &next_shard] (directory_entry de) {
+                    auto sub = path / de.name.c_str();
+                    auto shard = next_shard++ % smp::count;
+                    if (de.type && *de.type == directory_entry_type::directory) {
+                        parts.dirs[shard].push_back(sub);
+                    }
+                    parts.files[shard].push_back(std::move(sub));
+                    return make_ready_future<>();
+                }).done().then([&d] {
+                    return d.close();
+                });
+            });
+        }).then([&parts, consumer_factory = std::move(consumer_factory)] {
+            return parallel_for_each(smp::all_cpus(), [&parts, consumer_factory] (shard_id shard) {
+                if (parts.files[shard].empty()) {
+                    return make_ready_future<>();
+                }
+                return smp::submit_to(shard, [dirs = std::move(parts.dirs[shard]), files = std::move(parts.files[shard]), consumer_factory] () mutable {
+                    auto state = directory_scan_state{std::deque<fs::path>(std::make_move_iterator(dirs.begin()), std::make_move_iterator(dirs.end())),
+                            std::move(files), {}, consumer_factory()};
+                    return do_with(std::move(state), [] (directory_scan_state& s) {
+                        return do_recursive_scan_directory(s);
+                    });
+                });
+            });
+        });
+    });
+}
+
 namespace util {
 
 future<std::vector<temporary_buffer<char>>> read_entire_file(std::filesystem::path path) {
@@ -39,17 +39,22 @@
 
 #include <boost/any.hpp>
 #include <boost/lexical_cast.hpp>
+#include <boost/lockfree/spsc_queue.hpp>
 #include <boost/range/adaptor/map.hpp>
 #include <cxxabi.h>
+#include <sys/resource.h>
 #include <syslog.h>
 
 #include <iostream>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <regex>
 #include <string>
 #include <string_view>
 #include <system_error>
 #include <chrono>
+#include <thread>
 #include <algorithm>
 
 #include "core/program_options.hh"
@@ -160,6 +165,114 @@ log_buf::~log_buf() {
 } // namespace internal
 
 thread_local uint64_t logging_failures = 0;
+thread_local uint64_t logging_dropped = 0;
+
+namespace {
+
+// Background writer for asynchronous logging mode. Each shard owns a
+// bounded single-producer ring of pre-formatted lines drained by one
+// writer thread, patterned after thread_pool.cc's syscall worker, so
+// that writing and flushing the output stream never happen on a
+// reactor. Lines that do not fit in a ring are dropped; the producer
+// accounts them in \ref logging_dropped and the writer emits a note
+// once it catches up.
+class async_log_writer {
+    static constexpr size_t queue_length = 1024;
+    struct shard_queue {
+        boost::lockfree::spsc_queue<sstring*, boost::lockfree::capacity<queue_length>> lines;
+        std::atomic<uint64_t> dropped = { 0 };
+        uint64_t reported = 0; // writer-side, trails dropped
+    };
+    std::ostream** _out;
+    unsigned _nr_queues;
+    std::unique_ptr<shard_queue[]> _queues;
+    writeable_eventfd _start_eventfd;
+    std::atomic<bool> _stopped = { false };
+    std::thread _worker;
+public:
+    explicit async_log_writer(std::ostream** out)
+        : _out(out)
+        , _nr_queues(smp::count)
+        , _queues(std::make_unique<shard_queue[]>(_nr_queues))
+        , _worker([this] { work(); })
+    { }
+    ~async_log_writer() {
+        _stopped.store(true, std::memory_order_relaxed);
+        _start_eventfd.signal(1);
+        _worker.join();
+    }
+    void submit(std::string_view line) noexcept {
+        auto& q = _queues[this_shard_id()];
+        sstring* msg = nullptr;
+        try {
+            msg = new sstring(line.data(), line.size());
+        } catch (...) {
+            // drop below
+        }
+        if (msg == nullptr || !q.lines.push(msg)) {
+            delete msg;
+            q.dropped.fetch_add(1, std::memory_order_relaxed);
+            ++logging_dropped;
+            return;
+        }
+        // eventfd writes coalesce into a counter, so this never blocks
+        _start_eventfd.signal(1);
+    }
+private:
+    void work() {
+        pthread_setname_np(pthread_self(), "log-writer");
+        sigset_t mask;
+        sigfillset(&mask);
+        auto r = ::pthread_sigmask(SIG_BLOCK, &mask, NULL);
+        throw_pthread_error(r);
+        // Writing the log is the least important job in the process;
+        // let the reactors win any contest for cpu time. Best effort.
+        ::setpriority(PRIO_PROCESS, 0, 19);
+        while (true) {
+            uint64_t count;
+            auto r = ::read(_start_eventfd.get_read_fd(), &count, sizeof(count));
+            assert(r == sizeof(count));
+            auto stopped = _stopped.load(std::memory_order_relaxed);
+            auto out = *_out;
+            for (unsigned i = 0; i < _nr_queues; i++) {
+                auto& q = _queues[i];
+                q.lines.consume_all([out] (sstring* line) {
+                    *out << *line;
+                    delete line;
+                });
+                auto dropped = q.dropped.load(std::memory_order_relaxed);
+                if (dropped != q.reported) {
+                    *out << fmt::format("(log writer: shard {} dropped {} log messages)\n", i, dropped - q.reported);
+                    q.reported = dropped;
+                }
+            }
+            out->flush();
+            if (stopped) {
+                break;
+            }
+        }
+    }
+};
+
+// Created on first use from a reactor thread, after smp::count is
+// final, and deliberately never destroyed so that lines logged during
+// shutdown still have somewhere to go.
+async_log_writer* get_async_writer(std::ostream** out) {
+    static std::atomic<async_log_writer*> writer{nullptr};
+    auto w = writer.load(std::memory_order_acquire);
+    if (w == nullptr) {
+        static std::mutex mtx;
+        std::lock_guard<std::mutex> g(mtx);
+        w = writer.load(std::memory_order_relaxed);
+        if (w == nullptr) {
+            w = new async_log_writer(out);
+            writer.store(w, std::memory_order_release);
+        }
+    }
+    return w;
+}
+
+} // anonymous namespace
 
 void validate(boost::any& v,
               const std::vector<std::string>& values,
@@ -280,6 +393,7 @@ std::istream& operator>>(std::istream& in, log_level& level) {
 std::ostream* logger::_out = &std::cerr;
 std::atomic<bool> logger::_ostream = { true };
 std::atomic<bool> logger::_syslog = { false };
+std::atomic<bool> logger::_async = { false };
 unsigned logger::_shard_field_width = 1;
 #ifdef SEASTAR_BUILD_SHARED_LIBS
 thread_local bool logger::silent = false;
@@ -339,8 +453,14 @@ logger::do_log(log_level level, log_writer& writer) {
         it = print_timestamp(it);
         it = print_once(it);
         *it++ = '\n';
-        *_out << buf.view();
-        _out->flush();
+        // Threads without a reactor have nothing to stall, so they
+        // keep writing synchronously even in asynchronous mode
+        if (_async.load(std::memory_order_relaxed) && local_engine) {
+            get_async_writer(&_out)->submit(buf.view());
+        } else {
+            *_out << buf.view();
+            _out->flush();
+        }
     }
     if (is_syslog_enabled) {
         internal::log_buf buf(static_log_buf.data(), static_log_buf.size());
@@ -400,6 +520,11 @@ logger::set_syslog_enabled(bool enabled) noexcept {
     _syslog.store(enabled, std::memory_order_relaxed);
 }
 
+void
+logger::set_async_enabled(bool enabled) noexcept {
+    _async.store(enabled, std::memory_order_relaxed);
+}
+
 void
 logger::set_shard_field_width(unsigned width) noexcept {
     _shard_field_width = width;
@@ -490,6 +615,7 @@ void apply_logging_settings(const logging_settings& s) {
         break;
     }
     logger::set_syslog_enabled(s.syslog_enabled);
+    logger::set_async_enabled(s.async_enabled);
     logger::set_with_color(s.with_color);
 
     switch (s.stdout_timestamp_style) {
@@ -580,6 +706,9 @@ options::options(program_options::option_group* parent_group)
             "Send log output to: none|stdout|stderr")
     , log_to_syslog(*this, "log-to-syslog", false, "Send log output to syslog.")
     , log_with_color(*this, "log-with-color", isatty(STDOUT_FILENO), "Print colored tag prefix in log message written to ostream")
+    , log_async(*this, "log-async", false,
+            "Write log lines from a dedicated background thread, dropping lines if it cannot keep up, "
+            "so that logging never blocks a reactor")
 {
 }
 
@@ -611,6 +740,7 @@ logging_settings extract_settings(const options& opts) {
         opts.log_with_color.get_value(),
         opts.logger_stdout_timestamps.get_value(),
         opts.logger_ostream_type.get_value(),
+        opts.log_async.get_value(),
     };
 }
 
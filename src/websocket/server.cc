@@ -20,10 +20,12 @@
  */
 
 #include <cryptopp/sha.h>
-#include <cryptopp/filters.h>
-#include <cryptopp/base64.h>
+
+#define ZLIB_CONST
+#include <zlib.h>
 
 #include <seastar/websocket/server.hh>
+#include <seastar/core/execution_stage.hh>
 #include <seastar/core/gate.hh>
 #include <seastar/core/loop.hh>
 #include <seastar/util/log.hh>
@@ -49,6 +51,237 @@ static sstring http_upgrade_reply_template =
 
 static logger wlogger("websocket");
 
+// Raw deflate with the full 15-bit window; we never offer
+// server_max_window_bits in the reply, and a 15-bit inflate window
+// accepts a stream compressed with any smaller one.
+static constexpr int deflate_window_bits = 15;
+
+// A zlib stream allocates sizeable state (a quarter megabyte for the
+// deflate side), so idle streams are kept in a per-shard free list
+// instead of being torn down with their connection. The cap bounds the
+// memory kept around after a burst of compressed connections.
+class zlib_stream_pool {
+    static constexpr size_t max_idle_streams = 16;
+    std::vector<z_stream*> _deflaters;
+    std::vector<z_stream*> _inflaters;
+
+    static z_stream* make_stream() {
+        auto zs = std::make_unique<z_stream>();
+        std::memset(zs.get(), 0, sizeof(z_stream));
+        return zs.release();
+    }
+public:
+    z_stream* get_deflater() {
+        if (!_deflaters.empty()) {
+            z_stream* zs = _deflaters.back();
+            _deflaters.pop_back();
+            return zs;
+        }
+        z_stream* zs = make_stream();
+        if (deflateInit2(zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -deflate_window_bits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            delete zs;
+            throw websocket::exception("Failed to initialize deflate stream");
+        }
+        return zs;
+    }
+    z_stream* get_inflater() {
+        if (!_inflaters.empty()) {
+            z_stream* zs = _inflaters.back();
+            _inflaters.pop_back();
+            return zs;
+        }
+        z_stream* zs = make_stream();
+        if (inflateInit2(zs, -deflate_window_bits) != Z_OK) {
+            delete zs;
+            throw websocket::exception("Failed to initialize inflate stream");
+        }
+        return zs;
+    }
+    void put_deflater(z_stream* zs) noexcept {
+        if (_deflaters.size() < max_idle_streams && deflateReset(zs) == Z_OK) {
+            _deflaters.push_back(zs);
+        } else {
+            deflateEnd(zs);
+            delete zs;
+        }
+    }
+    void put_inflater(z_stream* zs) noexcept {
+        if (_inflaters.size() < max_idle_streams && inflateReset(zs) == Z_OK) {
+            _inflaters.push_back(zs);
+        } else {
+            inflateEnd(zs);
+            delete zs;
+        }
+    }
+};
+
+static thread_local zlib_stream_pool stream_pool;
+
+permessage_deflate::~permessage_deflate() {
+    if (_deflater) {
+        stream_pool.put_deflater(_deflater);
+    }
+    if (_inflater) {
+        stream_pool.put_inflater(_inflater);
+    }
+}
+
+static std::string_view trim_spaces(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) {
+        s.remove_prefix(1);
+    }
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) {
+        s.remove_suffix(1);
+    }
+    return s;
+}
+
+sstring permessage_deflate::negotiate(const sstring& offer) {
+    // The header carries a comma-separated list of offers, each a
+    // semicolon-separated parameter list (RFC 7692 section 5). Accept
+    // the first one we can fully honor and ignore the rest.
+    std::string_view remaining(offer);
+    while (!remaining.empty()) {
+        auto offer_end = remaining.find(',');
+        std::string_view params = remaining.substr(0, offer_end);
+        remaining = offer_end == std::string_view::npos ? std::string_view() : remaining.substr(offer_end + 1);
+
+        bool acceptable = true;
+        bool server_no_context_takeover = false;
+        bool client_no_context_takeover = false;
+        bool first = true;
+        while (!params.empty()) {
+            auto param_end = params.find(';');
+            std::string_view param = trim_spaces(params.substr(0, param_end));
+            params = param_end == std::string_view::npos ? std::string_view() : params.substr(param_end + 1);
+            if (first) {
+                first = false;
+                acceptable = param == "permessage-deflate";
+                if (!acceptable) {
+                    break;
+                }
+            } else if (param == "server_no_context_takeover") {
+                server_no_context_takeover = true;
+            } else if (param == "client_no_context_takeover") {
+                client_no_context_takeover = true;
+            } else if (param == "client_max_window_bits" || param.starts_with("client_max_window_bits=")) {
+                // A hint that the client may use a smaller window; our
+                // full-window inflater accepts that regardless.
+            } else {
+                // server_max_window_bits or anything unknown: declining
+                // a parameter means declining the whole offer.
+                acceptable = false;
+                break;
+            }
+        }
+        if (!acceptable || first) {
+            continue;
+        }
+
+        _server_no_context_takeover = server_no_context_takeover;
+        _client_no_context_takeover = client_no_context_takeover;
+        _deflater = stream_pool.get_deflater();
+        _inflater = stream_pool.get_inflater();
+        sstring reply = "permessage-deflate";
+        if (server_no_context_takeover) {
+            reply += "; server_no_context_takeover";
+        }
+        if (client_no_context_takeover) {
+            reply += "; client_no_context_takeover";
+        }
+        return reply;
+    }
+    return "";
+}
+
+bool permessage_deflate::compress(temporary_buffer<char>& buff) {
+    if (!_deflater || buff.size() < compression_threshold) {
+        return false;
+    }
+    z_stream& zs = *_deflater;
+    zs.next_in = reinterpret_cast<const Bytef*>(buff.get());
+    zs.avail_in = buff.size();
+    // deflateBound() assumes a single Z_FINISH pass; leave headroom for
+    // the empty stored block a sync flush appends.
+    size_t bound = deflateBound(&zs, buff.size()) + 5;
+    temporary_buffer<char> out(bound);
+    zs.next_out = reinterpret_cast<Bytef*>(out.get_write());
+    zs.avail_out = bound;
+    if (deflate(&zs, Z_SYNC_FLUSH) != Z_OK || zs.avail_in != 0) {
+        throw websocket::exception("Failed to compress message");
+    }
+    size_t produced = bound - zs.avail_out;
+    if (_server_no_context_takeover) {
+        deflateReset(&zs);
+    }
+    // A sync flush always ends with an empty stored block, 0x00 0x00
+    // 0xff 0xff, which RFC 7692 section 7.2.1 requires us to strip.
+    if (produced < 4) {
+        throw websocket::exception("Failed to compress message");
+    }
+    out.trim(produced - 4);
+    buff = std::move(out);
+    return true;
+}
+
+temporary_buffer<char> permessage_deflate::decompress(temporary_buffer<char> chunk, bool last) {
+    z_stream& zs = *_inflater;
+    std::vector<temporary_buffer<char>> pieces;
+    size_t total = 0;
+    auto feed = [&] (const char* data, size_t size) {
+        static constexpr size_t inflate_chunk_size = 16384;
+        zs.next_in = reinterpret_cast<const Bytef*>(data);
+        zs.avail_in = size;
+        do {
+            temporary_buffer<char> piece(inflate_chunk_size);
+            zs.next_out = reinterpret_cast<Bytef*>(piece.get_write());
+            zs.avail_out = piece.size();
+            int err = inflate(&zs, Z_SYNC_FLUSH);
+            if (err == Z_STREAM_END) {
+                // RFC 7692 also permits ending a message with a BFINAL
+                // block; start a fresh deflate stream for what follows.
+                inflateReset(&zs);
+                err = Z_OK;
+            }
+            // Z_BUF_ERROR just means no forward progress was possible,
+            // which is expected when the previous piece was filled
+            // exactly and nothing is pending.
+            if ((err != Z_OK && err != Z_BUF_ERROR) || (err == Z_BUF_ERROR && zs.avail_in != 0)) {
+                throw websocket::exception("Failed to decompress message");
+            }
+            piece.trim(piece.size() - zs.avail_out);
+            total += piece.size();
+            if (!piece.empty()) {
+                pieces.push_back(std::move(piece));
+            }
+            if (err == Z_BUF_ERROR) {
+                break;
+            }
+        } while (zs.avail_in != 0 || zs.avail_out == 0);
+    };
+    feed(chunk.get(), chunk.size());
+    if (last) {
+        // The sender stripped the trailing empty stored block from the
+        // message (RFC 7692 section 7.2.2); re-append it so inflate
+        // sees a complete deflate block sequence.
+        static constexpr char deflate_tail[4] = {'\x00', '\x00', '\xff', '\xff'};
+        feed(deflate_tail, sizeof(deflate_tail));
+        if (_client_no_context_takeover) {
+            inflateReset(&zs);
+        }
+    }
+    if (pieces.size() == 1) {
+        return std::move(pieces.front());
+    }
+    temporary_buffer<char> out(total);
+    char* pos = out.get_write();
+    for (auto& piece : pieces) {
+        std::memcpy(pos, piece.get(), piece.size());
+        pos += piece.size();
+    }
+    return out;
+}
+
 opcodes websocket_parser::opcode() const {
     if (_header) {
         return opcodes(_header->opcode);
@@ -131,17 +364,44 @@ future<> connection::process() {
     });
 }
 
-static std::string sha1_base64(std::string_view source) {
-    // CryptoPP insists on freeing the pointers by itself...
-    // It's leaky, but `read_http_upgrade_request` is a one-shot operation
-    // per handshake, so the real risk is not particularly great.
-    CryptoPP::SHA1 sha1;
-    std::string hash;
-    CryptoPP::StringSource(reinterpret_cast<const CryptoPP::byte*>(source.data()), source.size(),
-            true, new CryptoPP::HashFilter(sha1, new CryptoPP::Base64Encoder(new CryptoPP::StringSink(hash), false)));
-    return hash;
+// base64 of the 20-byte SHA-1 digest, always 28 characters (including padding)
+static constexpr size_t accept_key_length = 28;
+
+static sstring compute_accept_key(sstring sec_key) {
+    // Reuse one hash context per shard instead of rebuilding CryptoPP's
+    // filter chain (and its heap allocations) for every handshake.
+    static thread_local CryptoPP::SHA1 sha1;
+    sha1.Restart();
+    sha1.Update(reinterpret_cast<const CryptoPP::byte*>(sec_key.data()), sec_key.size());
+    sha1.Update(reinterpret_cast<const CryptoPP::byte*>(magic_key_suffix.data()), magic_key_suffix.size());
+    CryptoPP::byte digest[CryptoPP::SHA1::DIGESTSIZE];
+    sha1.Final(digest);
+
+    static constexpr char base64_chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    char encoded[accept_key_length];
+    char* out = encoded;
+    size_t i = 0;
+    for (; i + 3 <= sizeof(digest); i += 3) {
+        uint32_t triple = (digest[i] << 16) | (digest[i + 1] << 8) | digest[i + 2];
+        *out++ = base64_chars[(triple >> 18) & 0x3f];
+        *out++ = base64_chars[(triple >> 12) & 0x3f];
+        *out++ = base64_chars[(triple >> 6) & 0x3f];
+        *out++ = base64_chars[triple & 0x3f];
+    }
+    // 20 % 3 == 2, so exactly one padding character
+    uint32_t triple = (digest[i] << 16) | (digest[i + 1] << 8);
+    *out++ = base64_chars[(triple >> 18) & 0x3f];
+    *out++ = base64_chars[(triple >> 12) & 0x3f];
+    *out++ = base64_chars[(triple >> 6) & 0x3f];
+    *out++ = '=';
+    return sstring(encoded, accept_key_length);
 }
 
+// Handshakes arriving in a burst (e.g. mass reconnects after a load
+// balancer flip) are batched through an execution stage, so the hashing
+// code stays hot in the instruction cache across the whole burst.
+static thread_local auto handshake_stage = make_execution_stage("websocket_handshake", compute_accept_key);
+
 future<> connection::read_http_upgrade_request() {
     _http_parser.init();
     return _read_buf.consume(_http_parser).then([this] () mutable {
@@ -174,23 +434,32 @@ future<> connection::read_http_upgrade_request() {
         sstring sec_key = req->get_header("Sec-Websocket-Key");
         sstring sec_version = req->get_header("Sec-Websocket-Version");
 
-        sstring sha1_input = sec_key + magic_key_suffix;
-
         wlogger.debug("Sec-Websocket-Key: {}, Sec-Websocket-Version: {}", sec_key, sec_version);
 
-        std::string sha1_output = sha1_base64(sha1_input);
-        wlogger.debug("SHA1 output: {} of size {}", sha1_output, sha1_output.size());
-
-        return _write_buf.write(http_upgrade_reply_template).then([this, sha1_output = std::move(sha1_output)] {
-            return _write_buf.write(sha1_output);
-        }).then([this] {
-            return _write_buf.write("\r\nSec-WebSocket-Protocol: ", 26);
-        }).then([this] {
-            return _write_buf.write(_subprotocol);
-        }).then([this] {
-            return _write_buf.write("\r\n\r\n", 4);
-        }).then([this] {
-            return _write_buf.flush();
+        sstring extension_reply = _compression.negotiate(req->get_header("Sec-WebSocket-Extensions"));
+        if (_compression.enabled()) {
+            _websocket_parser.set_rsv1_allowed(true);
+            wlogger.debug("Sec-WebSocket-Extensions: {}", extension_reply);
+        }
+
+        return handshake_stage(std::move(sec_key)).then([this, extension_reply = std::move(extension_reply)] (sstring accept_key) mutable {
+            wlogger.debug("SHA1 output: {} of size {}", accept_key, accept_key.size());
+            // Assemble the whole 101 response into one scattered message;
+            // the static parts are referenced, not copied, and the socket
+            // sees a single write and flush per handshake.
+            scattered_message<char> msg;
+            msg.append_static(http_upgrade_reply_template);
+            msg.append(std::move(accept_key));
+            msg.append_static("\r\nSec-WebSocket-Protocol: ");
+            msg.append(sstring(_subprotocol));
+            if (!extension_reply.empty()) {
+                msg.append_static("\r\nSec-WebSocket-Extensions: ");
+                msg.append(std::move(extension_reply));
+            }
+            msg.append_static("\r\n\r\n");
+            return _write_buf.write(std::move(msg)).then([this] {
+                return _write_buf.flush();
+            });
         });
     });
 }
@@ -211,16 +480,26 @@ future<websocket_parser::consumption_result_t> websocket_parser::operator()(
                 _header = std::make_unique<frame_header>(_buffer.data());
                 _buffer = {};
 
+                // RSV1 marks the first frame of a compressed message
+                // when permessage-deflate was negotiated (RFC 7692),
+                // and must be 0 in every other case.
+                bool rsv1_valid = _rsv1_allowed &&
+                        (_header->opcode == opcodes::TEXT || _header->opcode == opcodes::BINARY);
+
                 // https://datatracker.ietf.org/doc/html/rfc6455#section-5.1
                 // We must close the connection if data isn't masked.
                 if ((!_header->masked) ||
-                        // RSVX must be 0
-                        (_header->rsv1 | _header->rsv2 | _header->rsv3) ||
+                        (_header->rsv1 && !rsv1_valid) ||
+                        // RSV2 and RSV3 must be 0
+                        (_header->rsv2 | _header->rsv3) ||
                         // Opcode must be known.
                         (!_header->is_opcode_known())) {
                     _cstate = connection_state::error;
                     return websocket_parser::stop(std::move(data));
                 }
+                if (_header->opcode == opcodes::TEXT || _header->opcode == opcodes::BINARY) {
+                    _compressed = _header->rsv1;
+                }
             }
             _state = parsing_state::payload_length_and_mask;
         } else {
@@ -260,6 +539,7 @@ future<websocket_parser::consumption_result_t> websocket_parser::operator()(
             _payload_length -= data.size();
             remove_mask(data, data.size());
             _result = std::move(data);
+            _message_complete = false;
             return websocket_parser::stop(buff_t(0));
         } else {
             _result = data.clone();
@@ -267,6 +547,7 @@ future<websocket_parser::consumption_result_t> websocket_parser::operator()(
             data.trim_front(_payload_length);
             _payload_length = 0;
             _state = parsing_state::flags_and_payload_data;
+            _message_complete = _header->fin;
             return websocket_parser::stop(std::move(data));
         }
     }
@@ -294,6 +575,10 @@ future<> connection::read_one() {
                 case opcodes::CONTINUATION:
                 case opcodes::TEXT:
                 case opcodes::BINARY:
+                    if (_websocket_parser.is_compressed()) {
+                        return _input_buffer.push_eventually(_compression.decompress(
+                                _websocket_parser.result(), _websocket_parser.message_complete()));
+                    }
                     return _input_buffer.push_eventually(_websocket_parser.result());
                 case opcodes::CLOSE:
                     wlogger.debug("Received close frame.");
@@ -353,11 +638,14 @@ future<> connection::close(bool send_close) {
     });
 }
 
-future<> connection::send_data(opcodes opcode, temporary_buffer<char>&& buff) {
+void connection::pack_frame(scattered_message<char>& msg, opcodes opcode, temporary_buffer<char>&& buff, bool compressed) {
     char header[10] = {'\x80', 0};
     size_t header_size = 2;
 
     header[0] += opcode;
+    if (compressed) {
+        header[0] |= 1 << frame_header::RSV1;
+    }
 
     if ((126 <= buff.size()) && (buff.size() <= std::numeric_limits<uint16_t>::max())) {
         header[1] = 0x7E;
@@ -371,9 +659,13 @@ future<> connection::send_data(opcodes opcode, temporary_buffer<char>&& buff) {
         header[1] = uint8_t(buff.size());
     }
 
-    scattered_message<char> msg;
     msg.append(sstring(header, header_size));
     msg.append(std::move(buff));
+}
+
+future<> connection::send_data(opcodes opcode, temporary_buffer<char>&& buff) {
+    scattered_message<char> msg;
+    pack_frame(msg, opcode, std::move(buff));
     return _write_buf.write(std::move(msg)).then([this] {
         return _write_buf.flush();
     });
@@ -384,7 +676,21 @@ future<> connection::response_loop() {
         // FIXME: implement error handling
         return _output_buffer.pop_eventually().then([this] (
                 temporary_buffer<char> buf) {
-            return send_data(opcodes::BINARY, std::move(buf));
+            // Pack whatever else the handler has already queued into the
+            // same scattered message, so a burst of small frames shares
+            // one write and one flush instead of paying them per frame.
+            static constexpr size_t max_frames_per_batch = 64;
+            scattered_message<char> msg;
+            bool compressed = _compression.compress(buf);
+            pack_frame(msg, opcodes::BINARY, std::move(buf), compressed);
+            for (size_t frames = 1; frames < max_frames_per_batch && !_output_buffer.empty(); frames++) {
+                auto next = _output_buffer.pop();
+                compressed = _compression.compress(next);
+                pack_frame(msg, opcodes::BINARY, std::move(next), compressed);
+            }
+            return _write_buf.write(std::move(msg)).then([this] {
+                return _write_buf.flush();
+            });
         });
     }).finally([this]() {
         return _write_buf.close();
@@ -354,3 +354,35 @@ PERF_TEST_CN(parallel_for_each, cor_pfe_suspend_100)
 }
 
 #endif // SEASTAR_COROUTINES_ENABLED
+
+struct ready_future_chain {
+    int value = 0;
+
+    static constexpr int chain_length = 16;
+};
+
+// Chaining then() on a ready future should complete inline, with no task
+// or continuation allocation; watch the allocs and tasks columns.
+PERF_TEST_F(ready_future_chain, then_ready_16)
+{
+    auto f = make_ready_future<int>(value);
+    for (int i = 0; i < chain_length; ++i) {
+        f = f.then([] (int v) { return make_ready_future<int>(v + 1); });
+    }
+    return f.then([this] (int v) {
+        perf_tests::do_not_optimize(v);
+        return chain_length;
+    });
+}
+
+PERF_TEST_F(ready_future_chain, then_suspend_16)
+{
+    auto f = yield().then([this] { return value; });
+    for (int i = 0; i < chain_length; ++i) {
+        f = f.then([] (int v) { return make_ready_future<int>(v + 1); });
+    }
+    return f.then([this] (int v) {
+        perf_tests::do_not_optimize(v);
+        return chain_length;
+    });
+}
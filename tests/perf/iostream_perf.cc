@@ -0,0 +1,99 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB
+ */
+
+#include <seastar/core/app-template.hh>
+#include <seastar/core/do_with.hh>
+#include <seastar/core/loop.hh>
+#include <seastar/core/seastar.hh>
+#include <seastar/core/when_all.hh>
+#include <seastar/net/api.hh>
+#include <fmt/printf.h>
+
+using namespace seastar;
+
+// Measures the buffered output_stream write path over a loopback TCP
+// connection; small writes are batched into the stream buffer, so this
+// exercises the batch-buffer recycling rather than the disk or the wire.
+int main(int ac, char** av) {
+    app_template at;
+    namespace bpo = boost::program_options;
+    at.add_options()
+            ("write-size", bpo::value<size_t>()->default_value(128), "Size of each write")
+            ("total-ops", bpo::value<unsigned>()->default_value(1000000), "Total write operations to issue")
+            ("flush-every", bpo::value<unsigned>()->default_value(0), "Flush the stream every this many writes (0 = only at the end)")
+            ;
+    return at.run(ac, av, [&at] {
+        auto write_size = at.configuration()["write-size"].as<size_t>();
+        auto total_ops = at.configuration()["total-ops"].as<unsigned>();
+        auto flush_every = at.configuration()["flush-every"].as<unsigned>();
+        listen_options lo;
+        lo.reuse_address = true;
+        auto sa = make_ipv4_address({"127.0.0.1", 11234});
+        return do_with(seastar::listen(sa, lo), [=] (server_socket& listener) {
+            auto reader = listener.accept().then([] (accept_result ar) {
+                return do_with(std::move(ar.connection), [] (connected_socket& s) {
+                    return do_with(s.input(), [] (input_stream<char>& in) {
+                        return repeat([&in] {
+                            return in.read().then([] (temporary_buffer<char> buf) {
+                                return buf.empty() ? stop_iteration::yes : stop_iteration::no;
+                            });
+                        }).then([&in] {
+                            return in.close();
+                        });
+                    });
+                });
+            });
+            auto writer = seastar::connect(sa).then([=] (connected_socket s) {
+                return do_with(std::move(s), [=] (connected_socket& s) {
+                    return do_with(s.output(), unsigned(0), [=] (output_stream<char>& os, unsigned& completed) {
+                        auto start = std::chrono::steady_clock::now();
+                        return repeat([=, &os, &completed] {
+                            if (completed == total_ops) {
+                                return make_ready_future<stop_iteration>(stop_iteration::yes);
+                            }
+                            char buf[write_size];
+                            memset(buf, 'x', write_size);
+                            return os.write(buf, write_size).then([=, &os, &completed] {
+                                ++completed;
+                                if (flush_every && completed % flush_every == 0) {
+                                    return os.flush().then([] {
+                                        return stop_iteration::no;
+                                    });
+                                }
+                                return make_ready_future<stop_iteration>(stop_iteration::no);
+                            });
+                        }).then([=, &os] {
+                            auto end = std::chrono::steady_clock::now();
+                            using fseconds = std::chrono::duration<float, std::ratio<1, 1>>;
+                            auto ops = total_ops / std::chrono::duration_cast<fseconds>(end - start).count();
+                            fmt::print("{:10} {:10} {:12} {:12}\n", "wsize", "ops", "flush-every", "writes/s");
+                            fmt::print("{:10d} {:10d} {:12d} {:12.0f}\n", write_size, total_ops, flush_every, ops);
+                            return os.flush();
+                        }).then([&os] {
+                            return os.close();
+                        });
+                    });
+                });
+            });
+            return when_all_succeed(std::move(reader), std::move(writer)).discard_result();
+        });
+    });
+}
@@ -0,0 +1,114 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB
+ */
+
+#include <seastar/testing/perf_tests.hh>
+
+#include <seastar/net/ip_checksum.hh>
+#include <seastar/net/packet.hh>
+
+#include <random>
+
+using namespace seastar;
+
+static constexpr size_t iterations = 1000;
+
+struct checksum_fixture {
+    std::vector<char> data;
+    checksum_fixture() : data(64 * 1024) {
+        std::default_random_engine eng(42);
+        std::uniform_int_distribution<int> dist(0, 255);
+        for (auto& b : data) {
+            b = dist(eng);
+        }
+    }
+
+    size_t sum_flat(size_t len) {
+        for (size_t i = 0; i < iterations; ++i) {
+            net::checksummer csum;
+            csum.sum(data.data(), len);
+            perf_tests::do_not_optimize(csum.get());
+        }
+        return iterations;
+    }
+
+    size_t sum_fragmented(size_t frag_size, size_t nr_frags) {
+        net::packet p(net::fragment{data.data(), frag_size});
+        for (size_t f = 1; f < nr_frags; ++f) {
+            p.append(net::packet(net::fragment{data.data() + f * frag_size, frag_size}));
+        }
+        for (size_t i = 0; i < iterations; ++i) {
+            net::checksummer csum;
+            csum.sum(p);
+            perf_tests::do_not_optimize(csum.get());
+        }
+        return iterations;
+    }
+};
+
+PERF_TEST_F(checksum_fixture, header_40b)
+{
+    return sum_flat(40);
+}
+
+PERF_TEST_F(checksum_fixture, mss_1448b)
+{
+    return sum_flat(1448);
+}
+
+PERF_TEST_F(checksum_fixture, unaligned_1449b)
+{
+    for (size_t i = 0; i < iterations; ++i) {
+        net::checksummer csum;
+        csum.sum(data.data() + 1, 1449);
+        perf_tests::do_not_optimize(csum.get());
+    }
+    return iterations;
+}
+
+PERF_TEST_F(checksum_fixture, jumbo_9000b)
+{
+    return sum_flat(9000);
+}
+
+PERF_TEST_F(checksum_fixture, tso_64k)
+{
+    return sum_flat(64 * 1024);
+}
+
+PERF_TEST_F(checksum_fixture, fragments_8x1448b)
+{
+    return sum_fragmented(1448, 8);
+}
+
+PERF_TEST_F(checksum_fixture, fragments_16x4k)
+{
+    return sum_fragmented(4096, 16);
+}
+
+PERF_TEST_F(checksum_fixture, incremental_update)
+{
+    uint16_t csum = net::ip_checksum(data.data(), 1448);
+    for (size_t i = 0; i < iterations; ++i) {
+        csum = net::checksum_update(csum, uint16_t(i), uint16_t(i + 1));
+        perf_tests::do_not_optimize(csum);
+    }
+    return iterations;
+}
@@ -0,0 +1,163 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB
+ */
+
+#include <seastar/testing/perf_tests.hh>
+
+#include <seastar/core/memory.hh>
+#include <seastar/core/smp.hh>
+
+#include <random>
+#include <vector>
+
+using namespace seastar;
+
+struct memory_fixture {
+    static constexpr size_t iterations = 10000;
+    // Deep enough to overflow the small pool's free list and hit the
+    // span allocation path, not just the fast recycling path
+    static constexpr size_t ladder_depth = 1024;
+    std::vector<void*> ptrs;
+
+    memory_fixture() {
+        ptrs.reserve(ladder_depth);
+    }
+
+    size_t alloc_free_ladder(size_t size) {
+        for (size_t i = 0; i < ladder_depth; ++i) {
+            ptrs.push_back(operator new(size));
+        }
+        perf_tests::do_not_optimize(ptrs.back());
+        while (!ptrs.empty()) {
+            operator delete(ptrs.back());
+            ptrs.pop_back();
+        }
+        return ladder_depth;
+    }
+};
+
+// Same-size ladders exercise individual small pools across the size
+// classes we actually see: tiny metadata, medium buffers, and objects
+// near the small-pool limit.
+PERF_TEST_F(memory_fixture, small_alloc_free_ladder_32)
+{
+    return alloc_free_ladder(32);
+}
+
+PERF_TEST_F(memory_fixture, small_alloc_free_ladder_256)
+{
+    return alloc_free_ladder(256);
+}
+
+PERF_TEST_F(memory_fixture, small_alloc_free_ladder_4096)
+{
+    return alloc_free_ladder(4096);
+}
+
+// Immediate free never leaves the pool's fast path; this is the floor
+// for allocator overhead.
+PERF_TEST_F(memory_fixture, small_alloc_free_ping_128)
+{
+    for (size_t i = 0; i < iterations; ++i) {
+        auto p = operator new(128);
+        perf_tests::do_not_optimize(p);
+        operator delete(p);
+    }
+    return iterations;
+}
+
+// A realistic mix: mostly small objects with a tail of larger buffers,
+// freed in FIFO order so frees do not simply pop the most recently
+// refilled free list entry.
+PERF_TEST_F(memory_fixture, mixed_size_churn)
+{
+    static const std::vector<size_t> sizes = [] {
+        std::default_random_engine eng(42);
+        // ~70% tiny, ~25% medium, ~5% around the small pool limit
+        std::discrete_distribution<> bucket({70, 25, 5});
+        std::uniform_int_distribution<size_t> tiny(8, 64);
+        std::uniform_int_distribution<size_t> medium(65, 1024);
+        std::uniform_int_distribution<size_t> large(1025, 16384);
+        std::vector<size_t> v(ladder_depth);
+        for (auto& s : v) {
+            switch (bucket(eng)) {
+            case 0: s = tiny(eng); break;
+            case 1: s = medium(eng); break;
+            default: s = large(eng); break;
+            }
+        }
+        return v;
+    }();
+    for (auto size : sizes) {
+        ptrs.push_back(operator new(size));
+    }
+    perf_tests::do_not_optimize(ptrs.back());
+    for (auto p : ptrs) {
+        operator delete(p);
+    }
+    ptrs.clear();
+    return sizes.size();
+}
+
+// Page-span allocations that bypass the small pools
+PERF_TEST_F(memory_fixture, large_alloc_free_128k)
+{
+    constexpr size_t n = 128;
+    for (size_t i = 0; i < n; ++i) {
+        auto p = operator new(128 * 1024);
+        perf_tests::do_not_optimize(p);
+        operator delete(p);
+    }
+    return n;
+}
+
+// Multi-megabyte allocations fall back to whole-span carving and, when
+// the reserve is exhausted, to growing the arena
+PERF_TEST_F(memory_fixture, huge_alloc_free_4m)
+{
+    constexpr size_t n = 16;
+    for (size_t i = 0; i < n; ++i) {
+        auto p = operator new(4 * 1024 * 1024);
+        perf_tests::do_not_optimize(p);
+        operator delete(p);
+    }
+    return n;
+}
+
+// A storm of frees arriving from another shard: allocate a batch
+// locally, ship it to a neighbor and free it there, stressing the
+// cross-shard free queue on the way there and the owner-side drain on
+// the way back. On a single-shard run this degenerates to local frees.
+PERF_TEST_F(memory_fixture, cross_shard_free_storm)
+{
+    constexpr size_t batch = 1024;
+    auto ptrs = std::make_unique<void*[]>(batch);
+    for (size_t i = 0; i < batch; ++i) {
+        ptrs[i] = operator new(128);
+    }
+    auto target = (this_shard_id() + 1) % smp::count;
+    return smp::submit_to(target, [ptrs = std::move(ptrs)] {
+        for (size_t i = 0; i < batch; ++i) {
+            operator delete(ptrs[i]);
+        }
+    }).then([] {
+        return batch;
+    });
+}
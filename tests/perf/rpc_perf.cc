@@ -21,6 +21,7 @@
 
 #include <random>
 
+#include <seastar/core/scattered_message.hh>
 #include <seastar/rpc/lz4_compressor.hh>
 #include <seastar/rpc/lz4_fragmented_compressor.hh>
 
@@ -261,3 +262,25 @@ PERF_TEST_F(lz4_fragmented, large_zeroed_buffer_decompress) {
         compressor().decompress(large_compressed_buffer_zeroes())
     );
 }
+
+// Building a typical scattered RPC response: a handful of static fragments
+// appended one by one. Exercises the fragment-array growth policy of
+// net::packet.
+struct scattered_message_frags {
+    static constexpr size_t fragment_size = 64;
+    static constexpr unsigned nr_fragments = 6;
+protected:
+    seastar::temporary_buffer<char> _buffer;
+public:
+    scattered_message_frags() : _buffer(fragment_size * nr_fragments) {
+        std::fill_n(_buffer.get_write(), _buffer.size(), 'x');
+    }
+};
+
+PERF_TEST_F(scattered_message_frags, append_and_release) {
+    seastar::scattered_message<char> msg;
+    for (unsigned i = 0; i < nr_fragments; i++) {
+        msg.append_static(_buffer.get() + i * fragment_size, fragment_size);
+    }
+    perf_tests::do_not_optimize(std::move(msg).release());
+}
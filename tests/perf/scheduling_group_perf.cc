@@ -0,0 +1,68 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB
+ */
+
+#include <seastar/testing/perf_tests.hh>
+#include <seastar/core/scheduling.hh>
+#include <seastar/core/scheduling_specific.hh>
+#include <seastar/core/print.hh>
+
+using namespace seastar;
+
+struct sg_specific {
+    static constexpr unsigned nr_groups = 4;
+    static constexpr size_t accesses_per_run = 100;
+
+    std::vector<scheduling_group> _groups;
+    scheduling_group_key _key;
+
+    sg_specific()
+        : _key(scheduling_group_key_create(make_scheduling_group_key_config<uint64_t>()).get0()) {
+        for (unsigned i = 0; i < nr_groups; i++) {
+            _groups.push_back(create_scheduling_group(format("sg-perf-{}", i), 100).get0());
+        }
+    }
+
+    ~sg_specific() {
+        for (auto sg : _groups) {
+            destroy_scheduling_group(sg).get();
+        }
+    }
+};
+
+PERF_TEST_F(sg_specific, current_group)
+{
+    uint64_t sum = 0;
+    for (size_t i = 0; i < accesses_per_run; i++) {
+        sum += scheduling_group_get_specific<uint64_t>(_key);
+    }
+    perf_tests::do_not_optimize(sum);
+    return accesses_per_run;
+}
+
+PERF_TEST_F(sg_specific, mixed_groups)
+{
+    uint64_t sum = 0;
+    for (size_t i = 0; i < accesses_per_run; i++) {
+        sum += scheduling_group_get_specific<uint64_t>(_groups[i % nr_groups], _key);
+    }
+    perf_tests::do_not_optimize(sum);
+    return accesses_per_run;
+}
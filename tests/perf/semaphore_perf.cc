@@ -0,0 +1,85 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB
+ */
+
+#include <seastar/testing/perf_tests.hh>
+
+#include <seastar/core/do_with.hh>
+#include <seastar/core/loop.hh>
+#include <seastar/core/semaphore.hh>
+#include <seastar/core/when_all.hh>
+
+using namespace seastar;
+
+struct semaphore_fixture {
+    static constexpr size_t iterations = 1000;
+    static constexpr size_t nr_waiters = 100;
+    semaphore sem{1};
+};
+
+PERF_TEST_F(semaphore_fixture, uncontended_wait_signal)
+{
+    for (size_t i = 0; i < iterations; ++i) {
+        (void)sem.wait(1);
+        sem.signal(1);
+    }
+    perf_tests::do_not_optimize(sem.current());
+    return iterations;
+}
+
+PERF_TEST_F(semaphore_fixture, uncontended_get_units)
+{
+    return do_with(size_t(0), [this] (size_t& i) {
+        return do_until([&i] { return i == iterations; }, [this, &i] {
+            ++i;
+            return get_units(sem, 1).then([] (semaphore_units<> units) {
+                perf_tests::do_not_optimize(units.count());
+            });
+        }).then([] { return iterations; });
+    });
+}
+
+PERF_TEST_F(semaphore_fixture, signal_no_waiters)
+{
+    for (size_t i = 0; i < iterations; ++i) {
+        sem.signal(1);
+    }
+    sem.consume(iterations);
+    perf_tests::do_not_optimize(sem.current());
+    return iterations;
+}
+
+// A burst of signals releasing many parked waiters; the wakeups are
+// coalesced into a single drain of the wait list.
+PERF_TEST_F(semaphore_fixture, signal_burst_wakes_waiters)
+{
+    return do_with(semaphore(0), std::vector<future<>>(), [] (semaphore& s, std::vector<future<>>& waiters) {
+        waiters.reserve(nr_waiters);
+        for (size_t i = 0; i < nr_waiters; ++i) {
+            waiters.push_back(s.wait(1));
+        }
+        for (size_t i = 0; i < nr_waiters; ++i) {
+            s.signal(1);
+        }
+        return when_all_succeed(waiters.begin(), waiters.end()).then([] {
+            return nr_waiters;
+        });
+    });
+}
@@ -0,0 +1,56 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB
+ */
+
+#include <seastar/testing/perf_tests.hh>
+
+#include <seastar/core/sstring.hh>
+
+using namespace seastar;
+
+static constexpr size_t iterations = 1000;
+
+PERF_TEST(sstring, to_sstring_small_int)
+{
+    // Fits the internal storage, no allocation expected
+    for (size_t i = 0; i < iterations; ++i) {
+        auto s = to_sstring(int(i));
+        perf_tests::do_not_optimize(s);
+    }
+    return iterations;
+}
+
+PERF_TEST(sstring, to_sstring_uint64)
+{
+    for (size_t i = 0; i < iterations; ++i) {
+        auto s = to_sstring(std::numeric_limits<uint64_t>::max() - i);
+        perf_tests::do_not_optimize(s);
+    }
+    return iterations;
+}
+
+PERF_TEST(sstring, to_sstring_double)
+{
+    for (size_t i = 0; i < iterations; ++i) {
+        auto s = to_sstring(0.5 + i);
+        perf_tests::do_not_optimize(s);
+    }
+    return iterations;
+}
@@ -195,3 +195,48 @@ SEASTAR_THREAD_TEST_CASE(test_request_abort_twice) {
     as.request_abort();
     BOOST_REQUIRE_THROW(as.check(), std::runtime_error);
 }
+
+SEASTAR_TEST_CASE(test_composite_abort_source_propagates) {
+    abort_source parent1;
+    abort_source parent2;
+    composite_abort_source child(parent1, parent2);
+    int aborted = 0;
+    auto sub = child.subscribe([&] () noexcept { ++aborted; });
+    BOOST_REQUIRE(!child.abort_requested());
+    parent2.request_abort_ex(std::runtime_error("expected"));
+    BOOST_REQUIRE_EQUAL(aborted, 1);
+    BOOST_REQUIRE_THROW(child.check(), std::runtime_error);
+    // A second parent aborting is a no-op
+    parent1.request_abort();
+    BOOST_REQUIRE_EQUAL(aborted, 1);
+    BOOST_REQUIRE_THROW(child.check(), std::runtime_error);
+    return make_ready_future<>();
+}
+
+SEASTAR_TEST_CASE(test_composite_abort_source_parent_already_aborted) {
+    abort_source parent1;
+    abort_source parent2;
+    parent1.request_abort_ex(std::runtime_error("expected"));
+    composite_abort_source child(parent1, parent2);
+    BOOST_REQUIRE(child.abort_requested());
+    BOOST_REQUIRE_THROW(child.check(), std::runtime_error);
+    return make_ready_future<>();
+}
+
+SEASTAR_TEST_CASE(test_composite_abort_source_unsubscribes_on_destruction) {
+    abort_source parent;
+    {
+        composite_abort_source child(parent);
+        BOOST_REQUIRE(!child.abort_requested());
+    }
+    parent.request_abort();
+    return make_ready_future<>();
+}
+
+SEASTAR_TEST_CASE(test_abort_requested_exception_ptr) {
+    abort_source as;
+    BOOST_REQUIRE(!as.abort_requested_exception_ptr());
+    as.request_abort_ex(std::runtime_error("expected"));
+    BOOST_REQUIRE_THROW(std::rethrow_exception(as.abort_requested_exception_ptr()), std::runtime_error);
+    return make_ready_future<>();
+}
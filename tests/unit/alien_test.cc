@@ -21,9 +21,13 @@
  */
 
 #include <future>
+#include <mutex>
 #include <numeric>
 #include <iostream>
+#include <thread>
 #include <seastar/core/alien.hh>
+#include <seastar/core/do_with.hh>
+#include <seastar/core/loop.hh>
 #include <seastar/core/smp.hh>
 #include <seastar/core/app-template.hh>
 #include <seastar/core/posix.hh>
@@ -39,6 +43,84 @@ enum {
     ALIEN_DONE   = 42,
 };
 
+static constexpr int ring_items = 1000;
+
+// test for alien::mpsc_queue<>: a foreign thread pushes items into the ring
+// while shard 0 drains them in batches, driven by the doorbell.
+static long test_mpsc_queue(seastar::alien::instance& instance)
+{
+    alien::mpsc_queue<int> ring(instance, 0, 128);
+    struct consumer_state {
+        long total = 0;
+        int seen = 0;
+        std::promise<long> done;
+    };
+    auto state = std::make_shared<consumer_state>();
+    auto total = alien::submit_to(instance, 0, [&ring, state] {
+        auto drain = [&ring, state] {
+            ring.drain([state](int v) {
+                state->total += v;
+                if (++state->seen == ring_items) {
+                    state->done.set_value(state->total);
+                }
+            });
+        };
+        ring.set_notify_action(drain);
+        // catch anything pushed before the action was installed
+        drain();
+        return seastar::make_ready_future<>();
+    });
+    for (int i = 1; i <= ring_items; i++) {
+        while (!ring.push(int(i))) {
+            std::this_thread::yield();
+        }
+    }
+    total.wait();
+    long result = state->done.get_future().get();
+    // message processing is in-order, so any doorbell still in flight is
+    // handled before this no-op returns, making the ring safe to destroy
+    alien::submit_to(instance, 0, [] {
+        return seastar::make_ready_future<>();
+    }).wait();
+    return result;
+}
+
+// test for alien::adaptive_lock: alien threads and shard 0 bump a plain
+// counter under the lock, so parked threads must get woken and the
+// reactor side must make progress through lock_async().
+static long test_adaptive_lock(seastar::alien::instance& instance)
+{
+    constexpr int increments = 200;
+    constexpr int nr_threads = 2;
+    alien::adaptive_lock lock(instance);
+    long counter = 0;
+    auto reactor_side = alien::submit_to(instance, 0, [&lock, &counter] {
+        return seastar::do_with(int(0), [&lock, &counter] (int& i) {
+            return seastar::do_until([&i] { return i == increments; }, [&lock, &counter, &i] {
+                return lock.lock_async().then([&lock, &counter, &i] {
+                    ++counter;
+                    ++i;
+                    lock.unlock();
+                });
+            });
+        });
+    });
+    std::vector<std::thread> threads;
+    for (int t = 0; t < nr_threads; t++) {
+        threads.emplace_back([&lock, &counter] {
+            for (int i = 0; i < increments; i++) {
+                std::lock_guard guard(lock);
+                ++counter;
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    reactor_side.wait();
+    return counter;
+}
+
 int main(int argc, char** argv)
 {
     // we need a protocol that both seastar and alien understand.
@@ -78,13 +160,15 @@ int main(int argc, char** argv)
         alien::submit_to(app.alien(), 0, [] {
             return seastar::make_ready_future<>();
         }).wait();
+        auto ring_total = test_mpsc_queue(app.alien());
+        auto lock_total = test_adaptive_lock(app.alien());
         int total = 0;
         for (auto& count : counts) {
             total += count.get();
         }
         // i am done. dismiss the engine
         ::eventfd_write(alien_done, ALIEN_DONE);
-        return std::make_tuple(answer.get(), total);
+        return std::make_tuple(answer.get(), total, ring_total, lock_total);
     });
 
     eventfd_t result = 0;
@@ -115,7 +199,7 @@ int main(int argc, char** argv)
             seastar::engine().exit(0);
         });
     });
-    auto [everything, total] = zim.get();
+    auto [everything, total, ring_total, lock_total] = zim.get();
     if (char expected = '*'; everything != '*') {
         std::cerr << "Bad everything: " << everything << " != " << expected << std::endl;
         return 1;
@@ -126,4 +210,13 @@ int main(int argc, char** argv)
         std::cerr << "Bad total: " << total << " != " << expected << std::endl;
         return 1;
     }
+    if (long expected = long(ring_items) * (ring_items + 1) / 2; ring_total != expected) {
+        std::cerr << "Bad ring total: " << ring_total << " != " << expected << std::endl;
+        return 1;
+    }
+    // two alien threads plus shard 0, 200 increments each
+    if (long expected = 3 * 200; lock_total != expected) {
+        std::cerr << "Bad lock total: " << lock_total << " != " << expected << std::endl;
+        return 1;
+    }
 }
@@ -26,8 +26,10 @@
 #include <seastar/util/memory_diagnostics.hh>
 #include <seastar/util/log.hh>
 
+#include <algorithm>
 #include <memory>
 #include <new>
+#include <numeric>
 #include <vector>
 #include <future>
 #include <iostream>
@@ -330,3 +332,64 @@ SEASTAR_TEST_CASE(test_large_allocation_warning_off_by_one) {
 #endif
     return make_ready_future<>();
 }
+
+SEASTAR_TEST_CASE(test_pool_diagnostics_and_trim) {
+#ifndef SEASTAR_DEFAULT_ALLOCATOR
+    constexpr size_t object_size = 1000;
+    constexpr unsigned count = 10000;
+    std::vector<std::unique_ptr<char[]>> objs;
+    objs.reserve(count);
+    for (unsigned i = 0; i < count; ++i) {
+        objs.emplace_back(new char[object_size]);
+    }
+    auto find_pool = [] (size_t size) {
+        auto diag = memory::pool_diagnostics();
+        auto it = std::find_if(diag.begin(), diag.end(), [size] (const memory::pool_diagnostics_entry& e) {
+            return e.object_size >= size;
+        });
+        BOOST_REQUIRE(it != diag.end());
+        return *it;
+    };
+    auto loaded = find_pool(object_size);
+    BOOST_REQUIRE_GE(loaded.live_objects, count);
+    BOOST_REQUIRE_GE(loaded.memory, count * object_size);
+    auto spans = std::accumulate(loaded.span_occupancy.begin(), loaded.span_occupancy.end(), uint64_t(0));
+    BOOST_REQUIRE_GT(spans, 0u);
+
+    objs.clear();
+    memory::trim();
+    auto drained = find_pool(object_size);
+    BOOST_REQUIRE_LT(drained.live_objects, loaded.live_objects);
+    BOOST_REQUIRE_LT(drained.memory, loaded.memory);
+#endif
+    return make_ready_future<>();
+}
+
+SEASTAR_TEST_CASE(test_live_objects_histogram) {
+#ifndef SEASTAR_DEFAULT_ALLOCATOR
+    constexpr size_t object_size = 1000;
+    constexpr unsigned count = 10000;
+    auto find_class = [] (size_t size) {
+        auto hist = memory::live_objects_histogram();
+        auto it = std::find_if(hist.begin(), hist.end(), [size] (const memory::live_objects_entry& e) {
+            return e.object_size >= size;
+        });
+        BOOST_REQUIRE(it != hist.end());
+        return *it;
+    };
+    std::vector<std::unique_ptr<char[]>> objs;
+    objs.reserve(count);
+    for (unsigned i = 0; i < count; ++i) {
+        objs.emplace_back(new char[object_size]);
+    }
+    auto loaded = find_class(object_size);
+    BOOST_REQUIRE_GE(loaded.live_objects, count);
+    BOOST_REQUIRE_EQUAL(loaded.live_objects, memory::live_objects_in_pool(loaded.object_size));
+
+    objs.clear();
+    auto drained = find_class(object_size);
+    BOOST_REQUIRE_EQUAL(drained.object_size, loaded.object_size);
+    BOOST_REQUIRE_GE(loaded.live_objects, drained.live_objects + count);
+#endif
+    return make_ready_future<>();
+}
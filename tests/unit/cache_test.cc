@@ -0,0 +1,150 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (C) 2026 ScyllaDB
+ */
+
+#include <seastar/testing/test_case.hh>
+#include <seastar/testing/thread_test_case.hh>
+
+#include <seastar/core/cache.hh>
+#include <seastar/core/sleep.hh>
+#include <seastar/core/when_all.hh>
+
+using namespace seastar;
+using namespace std::chrono_literals;
+
+SEASTAR_THREAD_TEST_CASE(test_cache_read_through) {
+    int loads = 0;
+    cache<int, sstring> c({}, [&loads] (const int& key) {
+        ++loads;
+        return make_ready_future<std::optional<sstring>>(format("value-{}", key));
+    });
+
+    BOOST_REQUIRE_EQUAL(*c.get(1).get0(), "value-1");
+    BOOST_REQUIRE_EQUAL(*c.get(1).get0(), "value-1");
+    BOOST_REQUIRE_EQUAL(*c.get(2).get0(), "value-2");
+    BOOST_REQUIRE_EQUAL(loads, 2);
+    BOOST_REQUIRE_EQUAL(c.get_stats().hits, 1u);
+    BOOST_REQUIRE_EQUAL(c.get_stats().misses, 2u);
+
+    c.invalidate(1);
+    BOOST_REQUIRE_EQUAL(*c.get(1).get0(), "value-1");
+    BOOST_REQUIRE_EQUAL(loads, 3);
+
+    c.stop().get();
+}
+
+SEASTAR_THREAD_TEST_CASE(test_cache_coalesces_concurrent_misses) {
+    int loads = 0;
+    promise<> loader_unblocked;
+    shared_future<> barrier(loader_unblocked.get_future());
+    cache<int, int> c({}, [&] (const int& key) {
+        ++loads;
+        return barrier.get_future().then([key] {
+            return std::optional<int>(key * 2);
+        });
+    });
+
+    auto f1 = c.get(21);
+    auto f2 = c.get(21);
+    auto f3 = c.get(21);
+    BOOST_REQUIRE(!f1.available());
+    loader_unblocked.set_value();
+    auto [v1, v2, v3] = when_all_succeed(std::move(f1), std::move(f2), std::move(f3)).get0();
+    BOOST_REQUIRE_EQUAL(*v1, 42);
+    BOOST_REQUIRE_EQUAL(*v2, 42);
+    BOOST_REQUIRE_EQUAL(*v3, 42);
+    BOOST_REQUIRE_EQUAL(loads, 1);
+    BOOST_REQUIRE_EQUAL(c.get_stats().coalesced_misses, 2u);
+
+    c.stop().get();
+}
+
+SEASTAR_THREAD_TEST_CASE(test_cache_negative_entries) {
+    int loads = 0;
+    cache<int, int>::config cfg;
+    cfg.negative_ttl = 10s;
+    cache<int, int> c(cfg, [&loads] (const int&) {
+        ++loads;
+        return make_ready_future<std::optional<int>>(std::nullopt);
+    });
+
+    BOOST_REQUIRE(!c.get(1).get0().has_value());
+    BOOST_REQUIRE(!c.get(1).get0().has_value());
+    BOOST_REQUIRE_EQUAL(loads, 1);
+
+    c.stop().get();
+}
+
+SEASTAR_THREAD_TEST_CASE(test_cache_ttl_expiry) {
+    int loads = 0;
+    cache<int, int>::config cfg;
+    cfg.ttl = 10ms;
+    cache<int, int> c(cfg, [&loads] (const int& key) {
+        ++loads;
+        return make_ready_future<std::optional<int>>(key);
+    });
+
+    BOOST_REQUIRE_EQUAL(*c.get(1).get0(), 1);
+    sleep(100ms).get();
+    BOOST_REQUIRE_EQUAL(*c.get(1).get0(), 1);
+    BOOST_REQUIRE_EQUAL(loads, 2);
+    BOOST_REQUIRE_EQUAL(c.get_stats().expirations, 1u);
+
+    c.stop().get();
+}
+
+SEASTAR_THREAD_TEST_CASE(test_cache_lru_eviction) {
+    cache<int, int>::config cfg;
+    cfg.max_entries = 2;
+    cache<int, int> c(cfg, [] (const int& key) {
+        return make_ready_future<std::optional<int>>(key);
+    });
+
+    c.get(1).get();
+    c.get(2).get();
+    c.get(1).get(); // make 2 the least recently used
+    c.get(3).get();
+    BOOST_REQUIRE_EQUAL(c.size(), 2u);
+    BOOST_REQUIRE_EQUAL(c.get_stats().evictions, 1u);
+    // 1 survived, 2 was evicted
+    c.get(1).get();
+    BOOST_REQUIRE_EQUAL(c.get_stats().loads, 3u);
+    c.get(2).get();
+    BOOST_REQUIRE_EQUAL(c.get_stats().loads, 4u);
+
+    c.stop().get();
+}
+
+SEASTAR_THREAD_TEST_CASE(test_cache_load_failure_not_cached) {
+    int loads = 0;
+    cache<int, int> c({}, [&loads] (const int& key) {
+        if (++loads == 1) {
+            return make_exception_future<std::optional<int>>(std::runtime_error("transient"));
+        }
+        return make_ready_future<std::optional<int>>(key);
+    });
+
+    BOOST_REQUIRE_THROW(c.get(1).get(), std::runtime_error);
+    BOOST_REQUIRE_EQUAL(*c.get(1).get0(), 1);
+    BOOST_REQUIRE_EQUAL(loads, 2);
+
+    c.stop().get();
+}
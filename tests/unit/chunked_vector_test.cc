@@ -0,0 +1,209 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB Ltd.
+ */
+
+
+#define BOOST_TEST_MODULE core
+
+#include <boost/test/unit_test.hpp>
+#include <seastar/core/chunked_vector.hh>
+#include <algorithm>
+#include <memory>
+#include <numeric>
+
+using namespace seastar;
+
+BOOST_AUTO_TEST_CASE(chunked_vector_small) {
+    // Check all the methods of chunked_vector with a trivial type (int) and
+    // only a few elements - in particular a single chunk is enough.
+    chunked_vector<int> v;
+    BOOST_REQUIRE_EQUAL(v.size(), 0u);
+    BOOST_REQUIRE_EQUAL(v.empty(), true);
+    v.push_back(3);
+    BOOST_REQUIRE_EQUAL(v.size(), 1u);
+    BOOST_REQUIRE_EQUAL(v.empty(), false);
+    BOOST_REQUIRE_EQUAL(v.front(), 3);
+    BOOST_REQUIRE_EQUAL(v.back(), 3);
+    BOOST_REQUIRE_EQUAL(v[0], 3);
+    v.push_back(17);
+    BOOST_REQUIRE_EQUAL(v.size(), 2u);
+    BOOST_REQUIRE_EQUAL(v.front(), 3);
+    BOOST_REQUIRE_EQUAL(v.back(), 17);
+    BOOST_REQUIRE_EQUAL(v[1], 17);
+    BOOST_REQUIRE_EQUAL(v.at(1), 17);
+    BOOST_REQUIRE_THROW(v.at(2), std::out_of_range);
+    v[1] = 18;
+    BOOST_REQUIRE_EQUAL(v[1], 18);
+    v.pop_back();
+    BOOST_REQUIRE_EQUAL(v.size(), 1u);
+    BOOST_REQUIRE_EQUAL(v.back(), 3);
+    v.pop_back();
+    BOOST_REQUIRE_EQUAL(v.size(), 0u);
+    BOOST_REQUIRE_EQUAL(v.empty(), true);
+}
+
+BOOST_AUTO_TEST_CASE(chunked_vector_fullchunks) {
+    // Grow a chunked_vector to hundreds of chunks and verify random access
+    // keeps working across chunk boundaries.
+    constexpr size_t N = 67'000;
+    chunked_vector<size_t> v;
+    for (size_t i = 0; i < N; ++i) {
+        v.push_back(i);
+    }
+    BOOST_REQUIRE_EQUAL(v.size(), N);
+    BOOST_REQUIRE_GE(v.capacity(), N);
+    for (size_t i = 0; i < N; i += 13) {
+        BOOST_REQUIRE_EQUAL(v[i], i);
+    }
+    BOOST_REQUIRE_EQUAL(v.front(), 0u);
+    BOOST_REQUIRE_EQUAL(v.back(), N - 1);
+    while (!v.empty()) {
+        BOOST_REQUIRE_EQUAL(v.back(), v.size() - 1);
+        v.pop_back();
+    }
+}
+
+BOOST_AUTO_TEST_CASE(chunked_vector_iterators) {
+    constexpr size_t N = 1000;
+    chunked_vector<size_t, 16> v;
+    for (size_t i = 0; i < N; ++i) {
+        v.push_back(i);
+    }
+    BOOST_REQUIRE_EQUAL(size_t(std::distance(v.begin(), v.end())), N);
+    size_t expected = 0;
+    for (auto& x : v) {
+        BOOST_REQUIRE_EQUAL(x, expected++);
+    }
+    // Random-access iterator operations.
+    auto it = v.begin();
+    BOOST_REQUIRE_EQUAL(*(it + 17), 17u);
+    BOOST_REQUIRE_EQUAL(it[42], 42u);
+    it += 100;
+    BOOST_REQUIRE_EQUAL(*it, 100u);
+    it -= 50;
+    BOOST_REQUIRE_EQUAL(*it, 50u);
+    BOOST_REQUIRE_EQUAL(it - v.begin(), 50);
+    BOOST_REQUIRE(it < v.end());
+    BOOST_REQUIRE(std::binary_search(v.cbegin(), v.cend(), size_t(731)));
+    BOOST_REQUIRE_EQUAL(std::accumulate(v.begin(), v.end(), size_t(0)), N * (N - 1) / 2);
+}
+
+BOOST_AUTO_TEST_CASE(chunked_vector_reserve_shrink) {
+    chunked_vector<int, 8> v;
+    BOOST_REQUIRE_EQUAL(v.capacity(), 0u);
+    v.reserve(100);
+    auto reserved = v.capacity();
+    BOOST_REQUIRE_GE(reserved, 100u);
+    // Reserved pushes must not allocate more chunks.
+    for (int i = 0; i < 100; ++i) {
+        v.push_back(i);
+    }
+    BOOST_REQUIRE_EQUAL(v.capacity(), reserved);
+    // shrink_to_fit() keeps the partially-filled tail chunk.
+    v.resize(20);
+    v.shrink_to_fit();
+    BOOST_REQUIRE_GE(v.capacity(), 20u);
+    BOOST_REQUIRE_LT(v.capacity(), reserved);
+    for (int i = 0; i < 20; ++i) {
+        BOOST_REQUIRE_EQUAL(v[i], i);
+    }
+    v.resize(30);
+    BOOST_REQUIRE_EQUAL(v.size(), 30u);
+    BOOST_REQUIRE_EQUAL(v[29], 0);
+    v.clear();
+    BOOST_REQUIRE(v.empty());
+    v.shrink_to_fit();
+    BOOST_REQUIRE_EQUAL(v.capacity(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(chunked_vector_move_only_items) {
+    // Growing must not copy or move the stored items, so move-only types
+    // work and addresses remain stable across growth.
+    constexpr size_t N = 1000;
+    chunked_vector<std::unique_ptr<size_t>> v;
+    std::vector<size_t*> addresses;
+    for (size_t i = 0; i < N; ++i) {
+        v.emplace_back(std::make_unique<size_t>(i));
+        addresses.push_back(v.back().get());
+    }
+    for (size_t i = 0; i < N; ++i) {
+        BOOST_REQUIRE_EQUAL(v[i].get(), addresses[i]);
+        BOOST_REQUIRE_EQUAL(*v[i], i);
+    }
+    // Moving the vector moves ownership of the chunks, not the items.
+    auto v2 = std::move(v);
+    BOOST_REQUIRE_EQUAL(v2.size(), N);
+    BOOST_REQUIRE_EQUAL(v2[0].get(), addresses[0]);
+    chunked_vector<std::unique_ptr<size_t>> v3;
+    v3 = std::move(v2);
+    BOOST_REQUIRE_EQUAL(v3.size(), N);
+    BOOST_REQUIRE_EQUAL(*v3.back(), N - 1);
+}
+
+BOOST_AUTO_TEST_CASE(chunked_vector_construction_counts) {
+    // Verify items are destroyed exactly once and growth does not copy.
+    static int constructed = 0;
+    static int destroyed = 0;
+    static int copied = 0;
+    struct counter {
+        counter() { ++constructed; }
+        counter(const counter&) { ++constructed; ++copied; }
+        ~counter() { ++destroyed; }
+    };
+    {
+        chunked_vector<counter, 4> v;
+        for (int i = 0; i < 100; ++i) {
+            v.emplace_back();
+        }
+        v.resize(50);
+        BOOST_REQUIRE_EQUAL(constructed, 100);
+        BOOST_REQUIRE_EQUAL(destroyed, 50);
+    }
+    BOOST_REQUIRE_EQUAL(constructed, 100);
+    BOOST_REQUIRE_EQUAL(destroyed, 100);
+    BOOST_REQUIRE_EQUAL(copied, 0);
+}
+
+BOOST_AUTO_TEST_CASE(chunked_vector_exception_safety) {
+    // A constructor throwing during emplace_back() must leave the vector
+    // unchanged (the speculatively added chunk stays as reserved capacity).
+    static int live = 0;
+    struct thrower {
+        explicit thrower(bool do_throw) {
+            if (do_throw) {
+                throw std::runtime_error("expected");
+            }
+            ++live;
+        }
+        thrower(thrower&&) = delete;
+        ~thrower() { --live; }
+    };
+    chunked_vector<thrower, 4> v;
+    for (int i = 0; i < 4; ++i) {
+        v.emplace_back(false);
+    }
+    BOOST_REQUIRE_THROW(v.emplace_back(true), std::runtime_error);
+    BOOST_REQUIRE_EQUAL(v.size(), 4u);
+    BOOST_REQUIRE_GE(v.capacity(), 8u);
+    v.emplace_back(false);
+    BOOST_REQUIRE_EQUAL(v.size(), 5u);
+    v.clear();
+    BOOST_REQUIRE_EQUAL(live, 0);
+}
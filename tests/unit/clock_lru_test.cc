@@ -0,0 +1,127 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB
+ */
+
+#define BOOST_TEST_MODULE core
+
+#include <boost/test/unit_test.hpp>
+#include <seastar/core/clock_lru.hh>
+#include <limits>
+#include <memory>
+#include <vector>
+
+using namespace seastar;
+
+struct item : public lru_hook {
+    int id;
+    size_t footprint;
+    explicit item(int id_, size_t footprint_ = 100) : id(id_), footprint(footprint_) {}
+};
+
+struct item_size {
+    size_t operator()(const item& i) const noexcept {
+        return i.footprint;
+    }
+};
+
+BOOST_AUTO_TEST_CASE(test_eviction_is_fifo_without_touches) {
+    clock_lru<item> lru;
+    std::vector<std::unique_ptr<item>> items;
+    for (int i = 0; i < 5; ++i) {
+        items.push_back(std::make_unique<item>(i));
+        lru.insert(*items.back());
+    }
+    BOOST_REQUIRE_EQUAL(lru.size(), 5u);
+    for (int i = 0; i < 5; ++i) {
+        auto* victim = lru.evict_one();
+        BOOST_REQUIRE(victim);
+        BOOST_REQUIRE_EQUAL(victim->id, i);
+    }
+    BOOST_REQUIRE(lru.empty());
+    BOOST_REQUIRE(!lru.evict_one());
+}
+
+BOOST_AUTO_TEST_CASE(test_touch_grants_second_chance) {
+    clock_lru<item> lru;
+    std::vector<std::unique_ptr<item>> items;
+    for (int i = 0; i < 3; ++i) {
+        items.push_back(std::make_unique<item>(i));
+        lru.insert(*items.back());
+    }
+    items[0]->touch();
+    // 0 is referenced, so 1 must go first and 0 is rotated to the back
+    BOOST_REQUIRE_EQUAL(lru.evict_one()->id, 1);
+    BOOST_REQUIRE_EQUAL(lru.evict_one()->id, 2);
+    // second chance is used up by now
+    BOOST_REQUIRE_EQUAL(lru.evict_one()->id, 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_evict_terminates_with_all_touched) {
+    clock_lru<item> lru;
+    std::vector<std::unique_ptr<item>> items;
+    for (int i = 0; i < 4; ++i) {
+        items.push_back(std::make_unique<item>(i));
+        lru.insert(*items.back());
+        items.back()->touch();
+    }
+    // one full rotation clears all bits, then the hand's element goes
+    BOOST_REQUIRE_EQUAL(lru.evict_one()->id, 0);
+    BOOST_REQUIRE_EQUAL(lru.size(), 3u);
+    lru.evict(std::numeric_limits<size_t>::max(), [] (item*) {});
+}
+
+BOOST_AUTO_TEST_CASE(test_remove_and_accounting) {
+    clock_lru<item, item_size> lru;
+    item a(0, 100), b(1, 200), c(2, 300);
+    lru.insert(a);
+    lru.insert(b);
+    lru.insert(c);
+    BOOST_REQUIRE_EQUAL(lru.bytes(), 600u);
+    lru.remove(b);
+    BOOST_REQUIRE_EQUAL(lru.bytes(), 400u);
+    BOOST_REQUIRE_EQUAL(lru.size(), 2u);
+    BOOST_REQUIRE_EQUAL(lru.evict_one()->id, 0);
+    BOOST_REQUIRE_EQUAL(lru.bytes(), 300u);
+    lru.remove(c);
+    BOOST_REQUIRE(lru.empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_batch_eviction_by_bytes) {
+    clock_lru<item, item_size> lru;
+    std::vector<std::unique_ptr<item>> items;
+    for (int i = 0; i < 10; ++i) {
+        items.push_back(std::make_unique<item>(i, 100));
+        lru.insert(*items.back());
+    }
+    std::vector<int> evicted;
+    auto released = lru.evict(250, [&] (item* victim) {
+        evicted.push_back(victim->id);
+    });
+    // three victims cover the 250 byte target
+    BOOST_REQUIRE_EQUAL(released, 300u);
+    BOOST_REQUIRE_EQUAL(evicted, (std::vector<int>{0, 1, 2}));
+    BOOST_REQUIRE_EQUAL(lru.size(), 7u);
+    BOOST_REQUIRE_EQUAL(lru.bytes(), 700u);
+
+    // asking for more than the container holds drains it
+    released = lru.evict(std::numeric_limits<size_t>::max(), [&] (item*) {});
+    BOOST_REQUIRE_EQUAL(released, 700u);
+    BOOST_REQUIRE(lru.empty());
+}
@@ -47,9 +47,11 @@ SEASTAR_TEST_CASE(test_coroutines_not_compiled_in) {
 #include <seastar/coroutine/maybe_yield.hh>
 #include <seastar/coroutine/switch_to.hh>
 #include <seastar/coroutine/parallel_for_each.hh>
+#include <seastar/coroutine/max_concurrent_for_each.hh>
 #include <seastar/coroutine/as_future.hh>
 #include <seastar/coroutine/exception.hh>
 #include <seastar/coroutine/generator.hh>
+#include <seastar/coroutine/stage.hh>
 
 namespace {
 
@@ -645,6 +647,90 @@ SEASTAR_TEST_CASE(test_parallel_for_each) {
 #endif
 }
 
+SEASTAR_TEST_CASE(test_max_concurrent_for_each_empty) {
+    std::vector<int> values;
+    int count = 0;
+
+    co_await coroutine::max_concurrent_for_each(values, 10, [&] (int x) {
+        ++count;
+    });
+    BOOST_REQUIRE_EQUAL(count, 0); // the test will hang if it doesn't work.
+}
+
+SEASTAR_TEST_CASE(test_max_concurrent_for_each) {
+    std::vector<int> values = { 3, 1, 4 };
+    int sum_of_squares = 0;
+
+    int expected = std::accumulate(values.begin(), values.end(), 0, [] (int sum, int x) {
+        return sum + x * x;
+    });
+
+    // Test all-ready futures
+    co_await coroutine::max_concurrent_for_each(values, 2, [&sum_of_squares] (int x) {
+        sum_of_squares += x * x;
+    });
+    BOOST_REQUIRE_EQUAL(sum_of_squares, expected);
+
+    // Test non-ready futures
+    sum_of_squares = 0;
+    co_await coroutine::max_concurrent_for_each(values, 2, [&sum_of_squares] (int x) -> future<> {
+        if (x > 1) {
+            co_await sleep(std::chrono::milliseconds(x));
+        }
+        sum_of_squares += x * x;
+    });
+    BOOST_REQUIRE_EQUAL(sum_of_squares, expected);
+
+    // Test legacy subrange
+    sum_of_squares = 0;
+    co_await coroutine::max_concurrent_for_each(values.begin(), values.end() - 1, 2, [&sum_of_squares] (int x) -> future<> {
+        if (x > 1) {
+            co_await sleep(std::chrono::milliseconds(x));
+        }
+        sum_of_squares += x * x;
+    });
+    BOOST_REQUIRE_EQUAL(sum_of_squares, 10);
+}
+
+SEASTAR_TEST_CASE(test_max_concurrent_for_each_window) {
+    std::vector<int> values(100);
+    std::iota(values.begin(), values.end(), 0);
+    constexpr size_t window = 7;
+    size_t in_flight = 0;
+    size_t max_observed = 0;
+    int count = 0;
+
+    co_await coroutine::max_concurrent_for_each(values, window, [&] (int x) -> future<> {
+        ++in_flight;
+        max_observed = std::max(max_observed, in_flight);
+        co_await yield();
+        ++count;
+        --in_flight;
+    });
+    // All elements must be visited, but never more than `window` at a time
+    BOOST_REQUIRE_EQUAL(count, 100);
+    BOOST_REQUIRE_LE(max_observed, window);
+    BOOST_REQUIRE_EQUAL(in_flight, 0u);
+}
+
+SEASTAR_TEST_CASE(test_max_concurrent_for_each_exception) {
+    std::array<int, 5> values = { 10, 2, 1, 4, 8 };
+    int count = 0;
+
+    auto f0 = coroutine::max_concurrent_for_each(values, 2, [&] (int x) -> future<> {
+        co_await sleep(std::chrono::milliseconds(x));
+        if (++count == 2) {
+            throw std::runtime_error("test");
+        }
+    });
+    // An exception thrown by the functor must be propagated
+    BOOST_REQUIRE_THROW(co_await std::move(f0), std::runtime_error);
+    // No new invocations are started after a failure, but the ones
+    // already started must have been waited for.
+    BOOST_REQUIRE_LE(count, values.size());
+    BOOST_REQUIRE_GE(count, 2);
+}
+
 SEASTAR_TEST_CASE(test_void_as_future) {
     auto f = co_await coroutine::as_future(make_ready_future<>());
     BOOST_REQUIRE(f.available());
@@ -922,4 +1008,24 @@ SEASTAR_TEST_CASE(test_lambda_coroutine_in_continuation) {
     BOOST_REQUIRE_EQUAL(sin1, sin2);
 }
 
+SEASTAR_TEST_CASE(test_resumption_stage) {
+    coroutine::resumption_stage stage("test-resumption-stage");
+    constexpr unsigned count = 20;
+    unsigned resumed = 0;
+    auto worker = [&] () -> future<> {
+        co_await stage();
+        ++resumed;
+    };
+    std::vector<future<>> futs;
+    for (unsigned i = 0; i < count; i++) {
+        futs.push_back(worker());
+    }
+    // resumptions are queued, not run inline
+    BOOST_REQUIRE_EQUAL(stage.get_stats().function_calls_enqueued, count);
+    BOOST_REQUIRE_EQUAL(resumed, 0u);
+    co_await when_all_succeed(futs.begin(), futs.end()).discard_result();
+    BOOST_REQUIRE_EQUAL(resumed, count);
+    BOOST_REQUIRE_EQUAL(stage.get_stats().function_calls_executed, count);
+}
+
 #endif
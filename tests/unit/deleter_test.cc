@@ -62,6 +62,34 @@ BOOST_AUTO_TEST_CASE(test_deleter_append_does_not_free_shared_object) {
     BOOST_REQUIRE(TestObject::deletions_called == 3);
 }
 
+BOOST_AUTO_TEST_CASE(test_expiring_deleter_share_hands_over_action) {
+    TestObject::deletions_called = 0;
+    {
+        deleter del1 = make_object_deleter(TestObject());
+        deleter del2 = std::move(del1).share();
+        BOOST_REQUIRE(!del1);
+        BOOST_REQUIRE(bool(del2));
+        BOOST_REQUIRE(TestObject::deletions_called == 0);
+    }
+    BOOST_REQUIRE(TestObject::deletions_called == 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_deleter_append_flattens_raw_frees) {
+    // A chain of plain frees collapses into one impl; mostly we check that
+    // every buffer is freed exactly once (under valgrind/ASAN) and that
+    // appending an object deleter afterwards still works
+    TestObject::deletions_called = 0;
+    {
+        deleter del = make_free_deleter(malloc(16));
+        for (int i = 0; i < 16; i++) {
+            del.append(make_free_deleter(malloc(16)));
+        }
+        del.append(make_object_deleter(TestObject()));
+        BOOST_REQUIRE(TestObject::deletions_called == 0);
+    }
+    BOOST_REQUIRE(TestObject::deletions_called == 1);
+}
+
 BOOST_AUTO_TEST_CASE(test_deleter_append_same_shared_object_twice) {
     TestObject::deletions_called = 0;
     {
@@ -132,6 +132,18 @@ SEASTAR_TEST_CASE(test_map_reduce) {
     });
 }
 
+SEASTAR_TEST_CASE(test_map_reduce_tree) {
+    return map_reduce_tree([] {
+        auto id = this_shard_id();
+        return id * id;
+    }, 0u, std::plus<unsigned>()).then([] (unsigned result) {
+        unsigned n = smp::count - 1;
+        if (result != (n * (n + 1) * (2*n + 1)) / 6) {
+            throw std::runtime_error("map_reduce_tree failed");
+        }
+    });
+}
+
 SEASTAR_TEST_CASE(test_map_reduce_lifetime) {
     struct map {
         bool destroyed = false;
@@ -71,6 +71,26 @@ SEASTAR_TEST_CASE(test_bad_name_udp) {
     return test_bad_name(dns_resolver::options());
 }
 
+SEASTAR_TEST_CASE(test_cached_resolve) {
+    dns_resolver::options opts;
+    opts.cache = true;
+    // Resolve twice; the second lookup is served from the cache.
+    auto d = ::make_lw_shared<dns_resolver>(std::move(opts));
+    return d->get_host_by_name(seastar_name, inet_address::family::INET).then([d](hostent e) {
+        return d->get_host_by_name(seastar_name, inet_address::family::INET).then([a = e.addr_list.front()](hostent e) {
+            BOOST_REQUIRE(std::count(e.addr_list.begin(), e.addr_list.end(), a));
+        });
+    }).finally([d]{
+        return d->close();
+    });
+}
+
+SEASTAR_TEST_CASE(test_cached_bad_name) {
+    dns_resolver::options opts;
+    opts.cache = true;
+    return test_bad_name(std::move(opts));
+}
+
 SEASTAR_TEST_CASE(test_timeout_udp) {
     dns_resolver::options opts;
     opts.servers = std::vector<inet_address>({ inet_address("1.2.3.4") }); // not a server
@@ -126,6 +146,25 @@ SEASTAR_TEST_CASE(test_bad_name_tcp) {
     return test_bad_name(opts);
 }
 
+SEASTAR_TEST_CASE(test_resolve_tcp_keep_connections) {
+    dns_resolver::options opts;
+    opts.use_tcp_query = true;
+    opts.keep_connections = true;
+    // Resolve twice; the second lookup reuses the nameserver connection.
+    auto d = ::make_lw_shared<dns_resolver>(std::move(opts));
+    return d->resolve_name(seastar_name, inet_address::family::INET).then([d](inet_address) {
+        return d->resolve_name(seastar_name, inet_address::family::INET).discard_result();
+    }).finally([d]{
+        return d->close();
+    });
+}
+
+SEASTAR_TEST_CASE(test_resolve_edns) {
+    dns_resolver::options opts;
+    opts.edns_udp_payload_size = 4096;
+    return test_resolve(opts);
+}
+
 static const sstring imaps_service = "imaps";
 static const sstring gmail_domain = "gmail.com";
 
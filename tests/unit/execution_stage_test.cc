@@ -100,6 +100,23 @@ SEASTAR_TEST_CASE(test_simple_stage_returning_int) {
     });
 }
 
+SEASTAR_TEST_CASE(test_adaptive_batch_stage) {
+    return seastar::async([] {
+        auto stage = seastar::make_execution_stage("test", [] (int x) { return x + 1; });
+        // The tuner may be disabled if perf counters are unavailable; the
+        // stage must work either way.
+        stage.enable_adaptive_batch(2, 64);
+
+        std::vector<future<int>> fs;
+        for (int i = 0; i < 1'000; i++) {
+            fs.emplace_back(stage(i));
+        }
+        for (auto i = 0u; i < fs.size(); i++) {
+            BOOST_REQUIRE_EQUAL(fs[i].get0(), int(i) + 1);
+        }
+    });
+}
+
 SEASTAR_TEST_CASE(test_simple_stage_returning_future_int) {
     return seastar::async([] {
         test_simple_execution_stage([] (int x) {
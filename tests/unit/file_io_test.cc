@@ -28,6 +28,7 @@
 #include <seastar/core/condition-variable.hh>
 #include <seastar/core/file.hh>
 #include <seastar/core/layered_file.hh>
+#include <seastar/core/striped_file.hh>
 #include <seastar/core/thread.hh>
 #include <seastar/core/stall_sampler.hh>
 #include <seastar/core/aligned_buffer.hh>
@@ -323,6 +324,99 @@ SEASTAR_THREAD_TEST_CASE(test_sanitize_iovecs) {
     }
 }
 
+SEASTAR_TEST_CASE(test_dma_read_scattered) {
+  return tmp_dir::do_with_thread([] (tmp_dir& t) {
+    static constexpr size_t block = 4096;
+    static constexpr size_t blocks = 16;
+
+    auto filename = (t.get_path() / "testfile.tmp").native();
+    auto f = open_file_dma(filename, open_flags::rw | open_flags::create).get0();
+    auto close_f = deferred_close(f);
+
+    auto wbuf = allocate_aligned_buffer<char>(block * blocks, block);
+    for (size_t i = 0; i < blocks; i++) {
+        std::fill_n(wbuf.get() + i * block, block, char('a' + i));
+    }
+    BOOST_REQUIRE_EQUAL(f.dma_write(0, wbuf.get(), block * blocks).get0(), block * blocks);
+
+    // Blocks 3 and 4 are contiguous on disk and collapse into one run.
+    std::vector<std::pair<uint64_t, size_t>> extents = {
+        { 8 * block, block },
+        { 3 * block, block },
+        { 4 * block, block },
+        { 0 * block, block },
+    };
+    auto rbuf = allocate_aligned_buffer<char>(4 * block, block);
+    auto read = f.dma_read_scattered(extents, rbuf.get()).get0();
+    BOOST_REQUIRE_EQUAL(read, 4 * block);
+
+    const char expected[] = { 'i', 'd', 'e', 'a' };
+    for (size_t i = 0; i < 4; i++) {
+        BOOST_REQUIRE(std::all_of(rbuf.get() + i * block, rbuf.get() + (i + 1) * block, [&] (char c) {
+            return c == expected[i];
+        }));
+    }
+  });
+}
+
+SEASTAR_THREAD_TEST_CASE(test_merge_file_ranges) {
+    auto merged = internal::merge_file_ranges({
+        { 8192, 4096 },
+        { 0, 4096 },
+        { 4096, 4096 },     // adjacent to both neighbours: one run of 0..12288
+        { 20480, 8192 },
+        { 24576, 8192 },    // overlaps the previous range
+        { 40960, 0 },       // empty, dropped
+    });
+    BOOST_REQUIRE_EQUAL(merged.size(), 2u);
+    BOOST_REQUIRE_EQUAL(merged[0].offset, 0u);
+    BOOST_REQUIRE_EQUAL(merged[0].length, 12288u);
+    BOOST_REQUIRE_EQUAL(merged[1].offset, 20480u);
+    BOOST_REQUIRE_EQUAL(merged[1].length, 12288u);
+}
+
+SEASTAR_TEST_CASE(test_discard_ranges_and_query_extents) {
+  return tmp_dir::do_with_thread([] (tmp_dir& t) {
+    static constexpr size_t block = 4096;
+    static constexpr size_t blocks = 8;
+
+    auto filename = (t.get_path() / "testfile.tmp").native();
+    auto f = open_file_dma(filename, open_flags::rw | open_flags::create).get0();
+    auto close_f = deferred_close(f);
+
+    auto wbuf = allocate_aligned_buffer<char>(block * blocks, block);
+    std::fill_n(wbuf.get(), block * blocks, 'x');
+    BOOST_REQUIRE_EQUAL(f.dma_write(0, wbuf.get(), block * blocks).get0(), block * blocks);
+    f.flush().get();
+
+    // punch blocks 1-3 as three ranges that merge into a single hole
+    f.discard_ranges({
+        { 2 * block, block },
+        { 1 * block, block },
+        { 3 * block, block },
+    }).get();
+
+    auto rbuf = allocate_aligned_buffer<char>(block, block);
+    BOOST_REQUIRE_EQUAL(f.dma_read(1 * block, rbuf.get(), block).get0(), block);
+    BOOST_REQUIRE(std::all_of(rbuf.get(), rbuf.get() + block, [] (char c) { return c == 0; }));
+    BOOST_REQUIRE_EQUAL(f.dma_read(4 * block, rbuf.get(), block).get0(), block);
+    BOOST_REQUIRE(std::all_of(rbuf.get(), rbuf.get() + block, [] (char c) { return c == 'x'; }));
+
+    try {
+        auto extents = f.query_extents(0, block * blocks).get0();
+        // the punched hole must not be covered by any extent
+        for (auto& e : extents) {
+            BOOST_REQUIRE(e.offset + e.length <= 1 * block || e.offset >= 4 * block);
+        }
+        // a repeated query is served from the handle's cache
+        auto again = f.query_extents(0, block * blocks).get0();
+        BOOST_REQUIRE_EQUAL(again.size(), extents.size());
+    } catch (std::system_error&) {
+        // the test filesystem does not support FIEMAP
+    }
+  });
+}
+
 SEASTAR_TEST_CASE(test_chmod) {
   return tmp_dir::do_with_thread([] (tmp_dir& t) {
     auto oflags = open_flags::rw | open_flags::create;
@@ -644,6 +738,44 @@ SEASTAR_TEST_CASE(test_underlying_file) {
     });
 }
 
+SEASTAR_TEST_CASE(test_striped_file) {
+    return tmp_dir::do_with_thread([] (tmp_dir& t) {
+        auto oflags = open_flags::rw | open_flags::create | open_flags::truncate;
+        sstring filename = (t.get_path() / "testfile.tmp").native();
+        auto f = open_file_dma(filename, oflags).get0();
+        // a small stripe so a few blocks cover several stripes
+        const uint64_t stripe_size = std::max<uint64_t>(f.disk_write_dma_alignment(), f.disk_read_dma_alignment());
+        auto sf = make_striped_file(f, stripe_size).get0();
+        auto close_sf = deferred_close(sf);
+
+        const size_t len = 8 * stripe_size;
+        auto wbuf = allocate_aligned_buffer<unsigned char>(len, sf.memory_dma_alignment());
+        for (size_t i = 0; i < len; i++) {
+            wbuf.get()[i] = i / stripe_size + 1;
+        }
+        BOOST_REQUIRE_EQUAL(sf.dma_write(0, wbuf.get(), len).get0(), len);
+        sf.flush().get();
+        BOOST_REQUIRE_EQUAL(sf.size().get0(), len);
+
+        // a read spanning all stripes sees what was written
+        auto rbuf = allocate_aligned_buffer<unsigned char>(len, sf.memory_dma_alignment());
+        BOOST_REQUIRE_EQUAL(sf.dma_read(0, rbuf.get(), len).get0(), len);
+        BOOST_REQUIRE(std::equal(rbuf.get(), rbuf.get() + len, wbuf.get()));
+
+        // so does the unstriped underlying file
+        BOOST_REQUIRE_EQUAL(f.dma_read(0, rbuf.get(), len).get0(), len);
+        BOOST_REQUIRE(std::equal(rbuf.get(), rbuf.get() + len, wbuf.get()));
+
+        // bulk reads handle unaligned ranges crossing stripe boundaries
+        auto bulk = sf.dma_read_bulk<unsigned char>(stripe_size / 2, 2 * stripe_size).get0();
+        BOOST_REQUIRE_GE(bulk.size(), 2 * stripe_size);
+        BOOST_REQUIRE(std::equal(bulk.get(), bulk.get() + 2 * stripe_size, wbuf.get() + stripe_size / 2));
+
+        // an unaligned stripe size is rejected
+        BOOST_REQUIRE_THROW(make_striped_file(f, stripe_size + 1).get(), std::invalid_argument);
+    });
+}
+
 SEASTAR_TEST_CASE(test_file_stat_method_with_file) {
     return tmp_dir::do_with_thread([] (tmp_dir& t) {
         auto oflags = open_flags::rw | open_flags::create | open_flags::truncate;
@@ -785,6 +917,22 @@ SEASTAR_TEST_CASE(test_destruct_just_constructed_append_challenged_file_with_slo
     });
 }
 
+SEASTAR_TEST_CASE(test_open_file_with_write_lifetime_hint) {
+    return tmp_dir::do_with_thread([] (tmp_dir& t) {
+        sstring filename = (t.get_path() / "testfile.tmp").native();
+        auto oflags = open_flags::rw | open_flags::create;
+        file_open_options opt;
+        opt.lifetime_hint = write_lifetime_hint::short_lived;
+        // The hint is advisory; opening and writing must work whether or
+        // not the kernel and filesystem honor it
+        auto f = open_file_dma(filename, oflags, opt).get0();
+        auto buf = allocate_aligned_buffer<unsigned char>(4096, 4096);
+        std::fill(buf.get(), buf.get() + 4096, 0);
+        f.dma_write(0, buf.get(), 4096).get();
+        f.close().get();
+    });
+}
+
 SEASTAR_TEST_CASE(test_destruct_append_challenged_file_after_write) {
     return tmp_dir::do_with_thread([] (tmp_dir& t) {
         sstring filename = (t.get_path() / "testfile.tmp").native();
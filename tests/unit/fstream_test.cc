@@ -20,10 +20,12 @@
  */
 
 #include <algorithm>
+#include <deque>
 #include <iostream>
 #include <numeric>
 #include <seastar/core/fstream.hh>
 #include <seastar/core/smp.hh>
+#include <seastar/core/vector-data-sink.hh>
 #include <seastar/core/shared_ptr.hh>
 #include <seastar/core/app-template.hh>
 #include <seastar/core/do_with.hh>
@@ -113,6 +115,45 @@ SEASTAR_TEST_CASE(test_fstream) {
     });
 }
 
+SEASTAR_TEST_CASE(test_output_stream_sendfile) {
+    return tmp_dir::do_with_thread([] (tmp_dir& t) {
+        auto filename = (t.get_path() / "testfile.tmp").native();
+        auto f = open_file_dma(filename,
+                               open_flags::rw | open_flags::create | open_flags::truncate).get0();
+        auto w = writer::make(std::move(f)).get0();
+        std::vector<char> content(16000);
+        std::iota(content.begin(), content.end(), 0);
+        w->out.write(content.data(), content.size()).get();
+        w->out.close().get();
+
+        f = open_file_dma(filename, open_flags::ro).get0();
+
+        // the vector sink has no sendfile() support, so this exercises the
+        // chunked fallback, with an unaligned starting position
+        auto pkts = std::vector<net::packet>{};
+        auto out = output_stream<char>(data_sink(std::make_unique<vector_data_sink>(pkts)), 8192);
+        out.sendfile(f, 100, 8000).get();
+        out.close().get();
+
+        size_t off = 0;
+        for (auto& p : pkts) {
+            for (auto& frag : p.fragments()) {
+                BOOST_REQUIRE(std::equal(frag.base, frag.base + frag.size, content.begin() + 100 + off));
+                off += frag.size;
+            }
+        }
+        BOOST_REQUIRE_EQUAL(off, 8000u);
+
+        // asking for a range past end-of-file is an error
+        auto pkts2 = std::vector<net::packet>{};
+        auto out2 = output_stream<char>(data_sink(std::make_unique<vector_data_sink>(pkts2)), 8192);
+        BOOST_REQUIRE_THROW(out2.sendfile(f, 0, content.size() + 1).get(), std::runtime_error);
+        out2.close().get();
+
+        f.close().get();
+    });
+}
+
 SEASTAR_TEST_CASE(test_consume_skip_bytes) {
     return tmp_dir::do_with_thread([] (tmp_dir& t) {
         auto filename = (t.get_path() / "testfile.tmp").native();
@@ -537,6 +578,231 @@ SEASTAR_TEST_CASE(test_fstream_slow_start) {
     });
 }
 
+SEASTAR_TEST_CASE(test_fstream_read_ahead_decay) {
+    return seastar::async([] {
+        // A file whose reads complete only when the test says so, allowing
+        // both a disk slower than the consumer and the other way around.
+        class manual_file final : public file_impl {
+            uint64_t _total_file_size;
+            bool _auto_complete = false;
+            std::deque<std::pair<size_t, promise<temporary_buffer<uint8_t>>>> _pending;
+            size_t _requests = 0;
+        public:
+            explicit manual_file(uint64_t file_size) noexcept : _total_file_size(file_size) { }
+
+            size_t requests() const {
+                return _requests;
+            }
+            void complete_one() {
+                auto& [length, pr] = _pending.front();
+                pr.set_value(temporary_buffer<uint8_t>(length));
+                _pending.pop_front();
+            }
+            void complete_all_and_switch_to_auto_complete() {
+                _auto_complete = true;
+                while (!_pending.empty()) {
+                    complete_one();
+                }
+            }
+
+            virtual future<size_t> write_dma(uint64_t, const void*, size_t, const io_priority_class&) noexcept override {
+                return make_exception_future<size_t>(std::bad_function_call());
+            }
+            virtual future<size_t> write_dma(uint64_t, std::vector<iovec>, const io_priority_class&) noexcept override {
+                return make_exception_future<size_t>(std::bad_function_call());
+            }
+            virtual future<size_t> read_dma(uint64_t, void*, size_t, const io_priority_class&) noexcept override {
+                return make_exception_future<size_t>(std::bad_function_call());
+            }
+            virtual future<size_t> read_dma(uint64_t, std::vector<iovec>, const io_priority_class&) noexcept override {
+                return make_exception_future<size_t>(std::bad_function_call());
+            }
+            virtual future<> flush() noexcept override {
+                return make_ready_future<>();
+            }
+            virtual future<struct stat> stat() noexcept override {
+                return make_exception_future<struct stat>(std::bad_function_call());
+            }
+            virtual future<> truncate(uint64_t) noexcept override {
+                return make_exception_future<>(std::bad_function_call());
+            }
+            virtual future<> discard(uint64_t, uint64_t) noexcept override {
+                return make_exception_future<>(std::bad_function_call());
+            }
+            virtual future<> allocate(uint64_t, uint64_t) noexcept override {
+                return make_exception_future<>(std::bad_function_call());
+            }
+            virtual future<uint64_t> size() noexcept override {
+                return make_ready_future<uint64_t>(_total_file_size);
+            }
+            virtual future<> close() noexcept override {
+                return make_ready_future<>();
+            }
+            virtual subscription<directory_entry> list_directory(std::function<future<> (directory_entry de)>) override {
+                throw std::bad_function_call();
+            }
+            virtual future<temporary_buffer<uint8_t>> dma_read_bulk(uint64_t, size_t range_size, const io_priority_class&) noexcept override {
+                _requests++;
+                if (_auto_complete) {
+                    return make_ready_future<temporary_buffer<uint8_t>>(temporary_buffer<uint8_t>(range_size));
+                }
+                _pending.emplace_back(range_size, promise<temporary_buffer<uint8_t>>());
+                return _pending.back().second.get_future();
+            }
+        };
+
+        static constexpr size_t file_size = 128 * 1024 * 1024;
+        static constexpr unsigned read_ahead = 4;
+
+        auto mock_file = make_shared<manual_file>(file_size);
+
+        file_input_stream_options options{};
+        options.buffer_size = 128 * 1024;
+        options.read_ahead = read_ahead;
+
+        auto fstr = make_file_input_stream(file(mock_file), 0, file_size, options);
+
+        // Slow disk, fast consumer: every read() blocks and the window grows
+        // up to options.read_ahead.
+        size_t consumed = 0;
+        for (unsigned i = 0; i < read_ahead; i++) {
+            auto f = fstr.read();
+            BOOST_CHECK(!f.available());
+            mock_file->complete_one();
+            auto buf = f.get0();
+            BOOST_CHECK_GT(buf.size(), 0u);
+            consumed++;
+        }
+
+        // Fast disk, slow consumer: every read() finds all issued reads
+        // complete, so the window should decay back to a single slot.
+        mock_file->complete_all_and_switch_to_auto_complete();
+        for (unsigned i = 0; i < 100; i++) {
+            auto buf = fstr.read().get0();
+            BOOST_CHECK_GT(buf.size(), 0u);
+            consumed++;
+        }
+
+        fstr.close().get();
+
+        // Every consumed buffer and every buffer left in the window at close
+        // time maps to exactly one disk request, so the difference below is
+        // the final window depth.
+        BOOST_CHECK_EQUAL(mock_file->requests() - consumed, 1u);
+    });
+}
+
+SEASTAR_TEST_CASE(test_file_data_sink_flush_epochs) {
+    return seastar::async([] {
+        // A writable file whose flushes complete only when the test says so,
+        // making the group-commit behaviour of the sink observable.
+        class manual_flush_file final : public file_impl {
+            std::deque<promise<>> _pending_flushes;
+            size_t _flushes_started = 0;
+        public:
+            size_t flushes_started() const {
+                return _flushes_started;
+            }
+            void complete_flush() {
+                _pending_flushes.front().set_value();
+                _pending_flushes.pop_front();
+            }
+
+            virtual future<size_t> write_dma(uint64_t, const void*, size_t len, const io_priority_class&) noexcept override {
+                return make_ready_future<size_t>(len);
+            }
+            virtual future<size_t> write_dma(uint64_t, std::vector<iovec>, const io_priority_class&) noexcept override {
+                return make_exception_future<size_t>(std::bad_function_call());
+            }
+            virtual future<size_t> read_dma(uint64_t, void*, size_t, const io_priority_class&) noexcept override {
+                return make_exception_future<size_t>(std::bad_function_call());
+            }
+            virtual future<size_t> read_dma(uint64_t, std::vector<iovec>, const io_priority_class&) noexcept override {
+                return make_exception_future<size_t>(std::bad_function_call());
+            }
+            virtual future<> flush() noexcept override {
+                _flushes_started++;
+                _pending_flushes.emplace_back();
+                return _pending_flushes.back().get_future();
+            }
+            virtual future<struct stat> stat() noexcept override {
+                return make_exception_future<struct stat>(std::bad_function_call());
+            }
+            virtual future<> truncate(uint64_t) noexcept override {
+                return make_exception_future<>(std::bad_function_call());
+            }
+            virtual future<> discard(uint64_t, uint64_t) noexcept override {
+                return make_exception_future<>(std::bad_function_call());
+            }
+            virtual future<> allocate(uint64_t, uint64_t) noexcept override {
+                return make_exception_future<>(std::bad_function_call());
+            }
+            virtual future<uint64_t> size() noexcept override {
+                return make_ready_future<uint64_t>(0);
+            }
+            virtual future<> close() noexcept override {
+                return make_ready_future<>();
+            }
+            virtual subscription<directory_entry> list_directory(std::function<future<> (directory_entry de)>) override {
+                throw std::bad_function_call();
+            }
+            virtual future<temporary_buffer<uint8_t>> dma_read_bulk(uint64_t, size_t, const io_priority_class&) noexcept override {
+                return make_exception_future<temporary_buffer<uint8_t>>(std::bad_function_call());
+            }
+        };
+
+        auto mock_file = make_shared<manual_flush_file>();
+
+        file_output_stream_options options;
+        auto sink = make_file_data_sink(file(mock_file), options).get0();
+
+        auto make_buf = [] {
+            auto buf = temporary_buffer<char>::aligned(4096, 4096);
+            std::fill_n(buf.get_write(), buf.size(), 'x');
+            return buf;
+        };
+
+        auto settle = [] {
+            for (int i = 0; i < 10; i++) {
+                thread::yield();
+            }
+        };
+
+        sink.put(make_buf()).get();
+        auto f1 = sink.flush();
+        while (mock_file->flushes_started() < 1) {
+            thread::yield();
+        }
+
+        // Writes of a new epoch arriving while a flush is in flight get a
+        // flush of their own, queued behind the pending one...
+        sink.put(make_buf()).get();
+        auto f2 = sink.flush();
+        // ...and further flushes of the same epoch piggyback on it.
+        auto f3 = sink.flush();
+        settle();
+        BOOST_CHECK_EQUAL(mock_file->flushes_started(), 1u);
+
+        mock_file->complete_flush();
+        f1.get();
+        while (mock_file->flushes_started() < 2) {
+            thread::yield();
+        }
+        mock_file->complete_flush();
+        f2.get();
+        f3.get();
+        BOOST_CHECK_EQUAL(mock_file->flushes_started(), 2u);
+
+        // Nothing was written since the last flush, so there is nothing new
+        // to make durable.
+        sink.flush().get();
+        settle();
+        BOOST_CHECK_EQUAL(mock_file->flushes_started(), 2u);
+
+        sink.close().get();
+    });
+}
+
 #ifdef SEASTAR_ENABLE_ALLOC_FAILURE_INJECTION
 
 SEASTAR_TEST_CASE(test_close_error) {
@@ -35,6 +35,7 @@
 #include <seastar/core/thread.hh>
 #include <seastar/core/print.hh>
 #include <seastar/core/when_any.hh>
+#include <seastar/core/when_quorum.hh>
 #include <seastar/core/when_all.hh>
 #include <seastar/core/gate.hh>
 #include <seastar/util/log.hh>
@@ -652,6 +653,71 @@ SEASTAR_TEST_CASE(test_when_any_variadic_ii)
         });
 }
 
+SEASTAR_THREAD_TEST_CASE(test_when_quorum) {
+    // Quorum of successes resolves without waiting for the rest.
+    {
+        std::vector<promise<int>> prs(3);
+        std::vector<future<int>> futures;
+        for (auto& pr : prs) {
+            futures.push_back(pr.get_future());
+        }
+        prs[2].set_value(20);
+        prs[0].set_value(0);
+        auto f = when_quorum(futures.begin(), futures.end(), 2);
+        auto r = f.get0();
+        BOOST_REQUIRE_EQUAL(r.values.size(), 2u);
+        BOOST_REQUIRE_EQUAL(r.values[0], 20);
+        BOOST_REQUIRE_EQUAL(r.values[1], 0);
+        BOOST_REQUIRE_EQUAL(r.indices[0], 2u);
+        BOOST_REQUIRE_EQUAL(r.indices[1], 0u);
+        // The loser resolves later and its value is dropped.
+        prs[1].set_value(10);
+    }
+
+    // Failures that make the quorum impossible fail the result.
+    {
+        std::vector<promise<int>> prs(3);
+        std::vector<future<int>> futures;
+        for (auto& pr : prs) {
+            futures.push_back(pr.get_future());
+        }
+        auto f = when_quorum(futures.begin(), futures.end(), 2);
+        prs[0].set_value(0);
+        prs[1].set_exception(std::runtime_error("first"));
+        BOOST_REQUIRE(!f.available());
+        prs[2].set_exception(std::runtime_error("second"));
+        BOOST_REQUIRE_THROW(f.get0(), std::runtime_error);
+    }
+
+    // The abort source fires as soon as the outcome is decided.
+    {
+        abort_source as;
+        std::vector<promise<>> prs(3);
+        std::vector<future<>> futures;
+        for (auto& pr : prs) {
+            futures.push_back(pr.get_future());
+        }
+        auto f = when_quorum(futures.begin(), futures.end(), 2, &as);
+        prs[0].set_value();
+        BOOST_REQUIRE(!as.abort_requested());
+        prs[1].set_value();
+        auto r = f.get0();
+        BOOST_REQUIRE_EQUAL(r.indices.size(), 2u);
+        BOOST_REQUIRE(as.abort_requested());
+        prs[2].set_value();
+    }
+
+    // Degenerate quorums.
+    {
+        std::vector<future<int>> futures;
+        futures.push_back(make_ready_future<int>(1));
+        BOOST_REQUIRE_THROW(when_quorum(futures.begin(), futures.end(), 2).get0(), std::invalid_argument);
+        std::vector<future<int>> none;
+        auto r = when_quorum(none.begin(), none.end(), 0).get0();
+        BOOST_REQUIRE(r.values.empty());
+    }
+}
+
 SEASTAR_TEST_CASE(test_map_reduce) {
     auto square = [] (long x) { return make_ready_future<long>(x*x); };
     long n = 1000;
@@ -1093,6 +1159,24 @@ SEASTAR_TEST_CASE(futurize_invoke_val_future_ok) {
         }
     });
 }
+SEASTAR_TEST_CASE(futurize_invoke_throwing_conversion) {
+    struct convert_throws {
+        convert_throws(int) {
+            throw expected_exception();
+        }
+        convert_throws(convert_throws&&) noexcept = default;
+    };
+    // The callable is noexcept, but futurizing its int result runs a
+    // converting constructor that throws; this must surface as an
+    // exceptional future, not escape a noexcept context.
+    return futurize<convert_throws>::invoke([] () noexcept { return 42; }).then_wrapped([] (future<convert_throws> f) {
+        try {
+            f.get();
+            BOOST_FAIL("should have thrown");
+        } catch (expected_exception& e) {}
+    });
+}
+
 SEASTAR_TEST_CASE(futurize_invoke_void_exception) {
     return futurize_invoke([] (auto arg) { throw expected_exception(); }, 0).then_wrapped([] (future<> f) {
         try {
@@ -1848,6 +1932,25 @@ SEASTAR_THREAD_TEST_CASE(test_with_gate) {
     BOOST_REQUIRE(!other_errors);
 }
 
+SEASTAR_THREAD_TEST_CASE(test_gate_hold_unchecked) {
+    gate g;
+    auto gh = g.hold();
+    // holding the gate proves it is open, so extra references may skip
+    // the closed check
+    auto gh2 = g.hold_unchecked();
+    BOOST_REQUIRE_EQUAL(g.get_count(), 2);
+    auto closed = g.close();
+    // like a holder copy, an unchecked hold is allowed after close()
+    // as long as the gate is still held
+    auto gh3 = g.hold_unchecked();
+    BOOST_REQUIRE_EQUAL(g.get_count(), 3);
+    BOOST_REQUIRE(!closed.available());
+    gh.release();
+    gh2.release();
+    gh3.release();
+    closed.get();
+}
+
 SEASTAR_THREAD_TEST_CASE(test_max_concurrent_for_each) {
     BOOST_TEST_MESSAGE("empty range");
     max_concurrent_for_each(std::vector<int>(), 3, [] (int) {
@@ -2036,3 +2139,29 @@ SEASTAR_THREAD_TEST_CASE(test_manual_clock_advance) {
     manual_clock::advance(1ms);
     BOOST_REQUIRE(expired);
 }
+
+SEASTAR_THREAD_TEST_CASE(test_then_inplace) {
+    // ready future: completes inline without touching the storage
+    continuation_storage<> unused;
+    BOOST_REQUIRE_EQUAL(make_ready_future<int>(1).then_inplace(unused, [] (int v) { return v + 1; }).get0(), 2);
+
+    // unavailable future: the continuation lives in the caller's storage
+    auto deferred = do_with(continuation_storage<>(), [] (continuation_storage<>& s) {
+        return yield().then([] { return 41; }).then_inplace(s, [] (int v) { return v + 1; });
+    });
+    BOOST_REQUIRE_EQUAL(deferred.get0(), 42);
+
+    // the storage can be reused once the previous continuation has run
+    auto chained = do_with(continuation_storage<>(), int(0), [] (continuation_storage<>& s, int& sum) {
+        return yield().then_inplace(s, [&sum] { sum += 1; }).then([&s, &sum] {
+            return yield().then_inplace(s, [&sum] { sum += 2; });
+        }).then([&sum] { return sum; });
+    });
+    BOOST_REQUIRE_EQUAL(chained.get0(), 3);
+
+    // exceptions propagate as with then()
+    auto failed = do_with(continuation_storage<>(), [] (continuation_storage<>& s) {
+        return yield().then([] { return make_exception_future<int>(std::runtime_error("test")); }).then_inplace(s, [] (int) { return 0; });
+    });
+    BOOST_REQUIRE_THROW(failed.get0(), std::runtime_error);
+}
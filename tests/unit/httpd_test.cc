@@ -20,7 +20,9 @@
 #include <seastar/core/thread.hh>
 #include <seastar/util/noncopyable_function.hh>
 #include <seastar/http/json_path.hh>
+#include <seastar/http/function_handlers.hh>
 #include <seastar/http/response_parser.hh>
+#include <zstd.h>
 #include <sstream>
 #include <seastar/core/shared_future.hh>
 #include <seastar/http/client.hh>
@@ -164,6 +166,98 @@ SEASTAR_TEST_CASE(test_add_del_cookie)
     return make_ready_future<>();
 }
 
+SEASTAR_TEST_CASE(test_route_trie_params)
+{
+    parameters params;
+    routes route;
+
+    handl* file = new handl();
+    route.add(operation_type::GET, url("/file").remainder("path"), file);
+
+    handl* version = new handl();
+    route.add(operation_type::GET, url("/version"), version);
+
+    handl* flags = new handl();
+    auto rule = new match_rule(flags);
+    rule->add_str("/flags").add_param("name").add_str("/value");
+    route.add(rule, operation_type::GET);
+
+    BOOST_REQUIRE_EQUAL(route.get_handler(GET, "/version", params), version);
+    BOOST_REQUIRE_EQUAL(route.get_handler(GET, "/file/etc/hosts", params), file);
+    BOOST_REQUIRE_EQUAL(params["path"], "etc/hosts");
+    params.clear();
+    BOOST_REQUIRE_EQUAL(route.get_handler(GET, "/flags/verbose/value", params), flags);
+    BOOST_REQUIRE_EQUAL(params["name"], "verbose");
+    params.clear();
+    httpd::handler_base* nl = nullptr;
+    BOOST_REQUIRE_EQUAL(route.get_handler(GET, "/flags/verbose", params), nl);
+
+    // a custom matcher cannot be compiled into the trie and is matched
+    // the generic way, after the compiled rules
+    class any_matcher : public matcher {
+        size_t match(const sstring& url, size_t ind, parameters& param) override {
+            return url.length();
+        }
+    };
+    handl* custom = new handl();
+    auto crule = new match_rule(custom);
+    crule->add_matcher(new any_matcher());
+    route.add(crule, operation_type::GET);
+    BOOST_REQUIRE_EQUAL(route.get_handler(GET, "/does/not/exist", params), custom);
+    BOOST_REQUIRE_EQUAL(route.get_handler(GET, "/version", params), version);
+    return make_ready_future<>();
+}
+
+SEASTAR_TEST_CASE(test_route_trie_many_siblings)
+{
+    // enough sibling segments to force the per-node segment hash table
+    // through several rebuilds
+    parameters params;
+    routes route;
+
+    std::vector<handl*> handlers;
+    for (int i = 0; i < 40; i++) {
+        handl* h = new handl();
+        handlers.push_back(h);
+        auto rule = new match_rule(h);
+        rule->add_str(format("/resource{}", i)).add_param("id").add_str("/child");
+        route.add(rule, operation_type::GET);
+    }
+
+    for (int i = 0; i < 40; i++) {
+        params.clear();
+        BOOST_REQUIRE_EQUAL(route.get_handler(GET, format("/resource{}/id{}/child", i, i), params), handlers[i]);
+        BOOST_REQUIRE_EQUAL(params["id"], format("id{}", i));
+    }
+    httpd::handler_base* nl = nullptr;
+    BOOST_REQUIRE_EQUAL(route.get_handler(GET, "/resource40/id/child", params), nl);
+    return make_ready_future<>();
+}
+
+SEASTAR_TEST_CASE(test_del_cookie_revives_shadowed_rule)
+{
+    routes rts;
+    parameters params;
+
+    handl* h1 = new handl();
+    auto rule1 = new match_rule(h1);
+    rule1->add_str("/hello").add_param("name");
+    auto cookie1 = rts.add_cookie(rule1, operation_type::GET);
+
+    handl* h2 = new handl();
+    auto rule2 = new match_rule(h2);
+    rule2->add_str("/hello").add_param("name");
+    rts.add_cookie(rule2, operation_type::GET);
+
+    BOOST_REQUIRE_EQUAL(rts.get_handler(operation_type::GET, "/hello/world", params), h1);
+
+    delete rts.del_cookie(cookie1, operation_type::GET);
+    params.clear();
+    BOOST_REQUIRE_EQUAL(rts.get_handler(operation_type::GET, "/hello/world", params), h2);
+    BOOST_REQUIRE_EQUAL(params["name"], "world");
+    return make_ready_future<>();
+}
+
 SEASTAR_TEST_CASE(test_formatter)
 {
     BOOST_REQUIRE_EQUAL(json::formatter::to_json(true), "true");
@@ -925,6 +1019,17 @@ struct echo_stream_handler : public echo_handler {
     }
 };
 
+/*
+ * Same handler as above, but opting in to content streaming per-handler
+ * instead of relying on the server-wide setting
+ *  */
+struct opt_in_stream_handler : public echo_stream_handler {
+    opt_in_stream_handler(bool chunked_reply = false) : echo_stream_handler(chunked_reply) {}
+    bool is_content_streamed(const http::request&) const override {
+        return true;
+    }
+};
+
 /*
  * Same handler as above, but without using streams
  *  */
@@ -1182,6 +1287,69 @@ SEASTAR_TEST_CASE(test_stream_content_chunked) {
     return test_basic_content(true, true);
 }
 
+SEASTAR_TEST_CASE(test_client_connection_pool) {
+    return seastar::async([] {
+        loopback_connection_factory lcf(1);
+        http_server server("test");
+        httpd::http_server_tester::listeners(server).emplace_back(lcf.get_server_socket());
+
+        future<> client = seastar::async([&lcf] {
+            class connection_factory : public http::experimental::connection_factory {
+                loopback_socket_impl lsi;
+            public:
+                explicit connection_factory(loopback_connection_factory& f) : lsi(f) {}
+                virtual future<connected_socket> make() override {
+                    return lsi.connect(socket_address(ipv4_addr()), socket_address(ipv4_addr()));
+                }
+            };
+            auto cln = http::experimental::client(std::make_unique<connection_factory>(lcf), http::experimental::client::no_idle_limit, 4);
+            auto make_req = [&cln] {
+                auto req = http::request::make("GET", "test", "/test");
+                return cln.make_request(std::move(req), [] (const http::reply& resp, input_stream<char>&& in) {
+                    BOOST_REQUIRE_EQUAL(resp._status, http::reply::status_type::ok);
+                    return seastar::async([in = std::move(in)] () mutable {
+                        util::skip_entire_stream(in).get();
+                    });
+                });
+            };
+
+            make_req().get();
+            auto stats = cln.get_stats();
+            BOOST_REQUIRE_EQUAL(stats.connections_created, 1);
+            BOOST_REQUIRE_EQUAL(stats.idle_connections, 1);
+
+            // The pooled connection is reused; the concurrent request
+            // pipelines onto it instead of opening a second socket
+            auto f1 = make_req();
+            auto f2 = make_req();
+            when_all_succeed(std::move(f1), std::move(f2)).get();
+            stats = cln.get_stats();
+            BOOST_REQUIRE_EQUAL(stats.connections_created, 1);
+            BOOST_REQUIRE_EQUAL(stats.pool_hits, 1);
+            BOOST_REQUIRE_EQUAL(stats.pipelined_requests, 1);
+            BOOST_REQUIRE_EQUAL(stats.idle_connections, 1);
+
+            cln.close().get();
+        });
+
+        server._routes.put(GET, "/test", new echo_string_handler(false));
+        server.do_accepts(0).get();
+
+        client.get();
+        server.stop().get();
+    });
+}
+
+SEASTAR_TEST_CASE(test_handler_content_streaming) {
+    // Server-wide streaming is off; the handler opts in on its own.
+    return check_http_reply({
+        "GET /test HTTP/1.1\r\nHost: test\r\nTransfer-Encoding: chunked\r\n\r\n",
+        "a\r\n1234567890\r\n",
+        "a\r\n1234521345\r\n",
+        "0\r\n\r\n"
+    }, {"12345678901234521345"}, false, new opt_in_stream_handler());
+}
+
 SEASTAR_TEST_CASE(test_not_implemented_encoding) {
     return check_http_reply({
         "GET /test HTTP/1.1\r\nHost: test\r\nTransfer-Encoding: gzip, chunked\r\n\r\n",
@@ -1236,6 +1404,139 @@ SEASTAR_TEST_CASE(test_bad_chunk_length) {
     }, {"400 Bad Request", "Can't parse chunk size and extensions"}, true, new echo_stream_handler());
 }
 
+SEASTAR_TEST_CASE(test_accept_encoding_allows) {
+    BOOST_REQUIRE(http::internal::accept_encoding_allows("zstd", "zstd"));
+    BOOST_REQUIRE(http::internal::accept_encoding_allows("gzip, zstd", "zstd"));
+    BOOST_REQUIRE(http::internal::accept_encoding_allows("gzip;q=1.0, zstd;q=0.5", "zstd"));
+    BOOST_REQUIRE(http::internal::accept_encoding_allows("*", "zstd"));
+    BOOST_REQUIRE(!http::internal::accept_encoding_allows("", "zstd"));
+    BOOST_REQUIRE(!http::internal::accept_encoding_allows("gzip, deflate", "zstd"));
+    BOOST_REQUIRE(!http::internal::accept_encoding_allows("zstd;q=0", "zstd"));
+    BOOST_REQUIRE(!http::internal::accept_encoding_allows("zstd;q=0.000", "zstd"));
+    return make_ready_future<>();
+}
+
+static std::string zstd_decompress_all(const std::string& in) {
+    auto dctx = ZSTD_createDCtx();
+    std::string out;
+    ZSTD_inBuffer ib = { in.data(), in.size(), 0 };
+    char buf[4096];
+    while (ib.pos < ib.size) {
+        ZSTD_outBuffer ob = { buf, sizeof(buf), 0 };
+        auto res = ZSTD_decompressStream(dctx, &ob, &ib);
+        BOOST_REQUIRE(!ZSTD_isError(res));
+        out.append(buf, ob.pos);
+    }
+    ZSTD_freeDCtx(dctx);
+    return out;
+}
+
+// Reads one non-chunked response; returns the header block and the body
+static std::pair<std::string, std::string> read_simple_response(input_stream<char>& in) {
+    std::string data;
+    auto read_more = [&] {
+        auto buf = in.read().get0();
+        BOOST_REQUIRE(!buf.empty());
+        data.append(buf.get(), buf.size());
+    };
+    while (data.find("\r\n\r\n") == std::string::npos) {
+        read_more();
+    }
+    auto header_end = data.find("\r\n\r\n") + 4;
+    auto headers = data.substr(0, header_end);
+    auto cl = headers.find("Content-Length: ");
+    BOOST_REQUIRE_NE(cl, std::string::npos);
+    auto len = std::stoul(headers.substr(cl + 16));
+    while (data.size() < header_end + len) {
+        read_more();
+    }
+    return {headers, data.substr(header_end, len)};
+}
+
+SEASTAR_TEST_CASE(test_reply_compression) {
+    return seastar::async([] {
+        loopback_connection_factory lcf(1);
+        http_server server("test");
+        server.set_content_compression(true);
+        loopback_socket_impl lsi(lcf);
+        httpd::http_server_tester::listeners(server).emplace_back(lcf.get_server_socket());
+
+        sstring content;
+        for (int i = 0; i < 64; i++) {
+            content += "all work and no play makes jack a dull boy. ";
+        }
+
+        future<> client = seastar::async([&lsi, &content] {
+            connected_socket c_socket = lsi.connect(socket_address(ipv4_addr()), socket_address(ipv4_addr())).get0();
+            input_stream<char> input(c_socket.input());
+            output_stream<char> output(c_socket.output());
+
+            // Without Accept-Encoding the body is sent verbatim
+            output.write(sstring("GET /test HTTP/1.1\r\nHost: test\r\n\r\n")).get();
+            output.flush().get();
+            auto [headers, body] = read_simple_response(input);
+            BOOST_REQUIRE_EQUAL(headers.find("Content-Encoding"), std::string::npos);
+            BOOST_REQUIRE_EQUAL(body, std::string(content));
+
+            // With it, the body is a zstd frame that decodes to the original
+            output.write(sstring("GET /test HTTP/1.1\r\nHost: test\r\nAccept-Encoding: gzip, zstd\r\n\r\n")).get();
+            output.flush().get();
+            std::tie(headers, body) = read_simple_response(input);
+            BOOST_REQUIRE_NE(headers.find("Content-Encoding: zstd"), std::string::npos);
+            BOOST_REQUIRE_LT(body.size(), content.size());
+            BOOST_REQUIRE_EQUAL(zstd_decompress_all(body), std::string(content));
+
+            // A chunked (streamed) reply is compressed incrementally
+            output.write(sstring("GET /stream HTTP/1.1\r\nHost: test\r\nAccept-Encoding: zstd\r\n\r\n")).get();
+            output.flush().get();
+            std::string data;
+            while (data.find("0\r\n\r\n") == std::string::npos) {
+                auto buf = input.read().get0();
+                BOOST_REQUIRE(!buf.empty());
+                data.append(buf.get(), buf.size());
+            }
+            BOOST_REQUIRE_NE(data.find("Content-Encoding: zstd"), std::string::npos);
+            // De-chunk, then decompress
+            auto pos = data.find("\r\n\r\n") + 4;
+            std::string compressed;
+            while (true) {
+                auto crlf = data.find("\r\n", pos);
+                auto len = std::stoul(data.substr(pos, crlf - pos), nullptr, 16);
+                if (!len) {
+                    break;
+                }
+                compressed.append(data.substr(crlf + 2, len));
+                pos = crlf + 2 + len + 2;
+            }
+            BOOST_REQUIRE_EQUAL(zstd_decompress_all(compressed), std::string(content));
+
+            input.close().get();
+            output.close().get();
+        });
+
+        server._routes.put(GET, "/test", new function_handler([content] (const_req req) {
+            return content;
+        }, "txt"));
+        server._routes.put(GET, "/stream", new function_handler([content] (std::unique_ptr<http::request> req, std::unique_ptr<http::reply> rep) {
+            rep->write_body("txt", [content] (output_stream<char>&& out) {
+                return do_with(std::move(out), [&content] (output_stream<char>& out) {
+                    return out.write(content).then([&out] {
+                        return out.flush();
+                    }).finally([&out] {
+                        return out.close();
+                    });
+                });
+            });
+            return make_ready_future<std::unique_ptr<http::reply>>(std::move(rep));
+        }, "txt"));
+        server.do_accepts(0).get();
+
+        client.get();
+        server.stop().get();
+        lcf.destroy_all_shards().get();
+    });
+}
+
 SEASTAR_TEST_CASE(case_insensitive_header) {
     std::unique_ptr<seastar::http::request> req = std::make_unique<seastar::http::request>();
     req->_headers["conTEnt-LengtH"] = "17";
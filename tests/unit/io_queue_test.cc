@@ -75,8 +75,8 @@ struct io_queue_for_tests {
     io_queue queue;
     timer<> kicker;
 
-    io_queue_for_tests()
-        : group(std::make_shared<io_group>(io_queue::config{0}))
+    explicit io_queue_for_tests(io_queue::config cfg = io_queue::config{0})
+        : group(std::make_shared<io_group>(std::move(cfg)))
         , sink()
         , queue(group, sink)
         , kicker([this] { kick(); })
@@ -111,6 +111,35 @@ SEASTAR_THREAD_TEST_CASE(test_basic_flow) {
     f.get();
 }
 
+SEASTAR_THREAD_TEST_CASE(test_adjacent_requests_merge) {
+    io_queue::config cfg{0};
+    cfg.max_merge_length = 4;
+    io_queue_for_tests tio(std::move(cfg));
+    fake_file file;
+
+    auto v0 = std::make_unique<int>(13);
+    auto v1 = std::make_unique<int>(42);
+    auto f0 = tio.queue.queue_request(default_priority_class(), internal::io_direction_and_length(internal::io_direction_and_length::write_idx, 0), file.make_write_req(0, v0.get()), nullptr, {});
+    auto f1 = tio.queue.queue_request(default_priority_class(), internal::io_direction_and_length(internal::io_direction_and_length::write_idx, 0), file.make_write_req(1, v1.get()), nullptr, {});
+
+    seastar::sleep(std::chrono::milliseconds(500)).get();
+    tio.queue.poll_io_queue();
+    unsigned submitted = 0;
+    tio.sink.drain([&file, &submitted] (const internal::io_request& rq, io_completion* desc) -> bool {
+        BOOST_REQUIRE(rq.opcode() == internal::io_request::operation::writev);
+        file.execute_writev_req(rq, desc);
+        submitted++;
+        return true;
+    });
+
+    // both requests were physically adjacent, so one vectored request hits the sink
+    BOOST_REQUIRE_EQUAL(submitted, 1);
+    BOOST_REQUIRE_EQUAL(f0.get0(), 1);
+    BOOST_REQUIRE_EQUAL(f1.get0(), 1);
+    BOOST_REQUIRE_EQUAL(file.data[0], 13);
+    BOOST_REQUIRE_EQUAL(file.data[1], 42);
+}
+
 enum class part_flaw { none, partial, error };
 
 static void do_test_large_request_flow(part_flaw flaw) {
@@ -316,6 +345,70 @@ SEASTAR_THREAD_TEST_CASE(test_io_cancellation) {
     when_all_succeed(finished.begin(), finished.end()).get();
 }
 
+SEASTAR_THREAD_TEST_CASE(test_in_flight_cancellation) {
+    io_queue_for_tests tio;
+    fake_file file;
+
+    io_intent intent;
+
+    auto buf = std::make_unique<int>(42);
+    auto f = tio.queue.queue_request(default_priority_class(), internal::io_direction_and_length(internal::io_direction_and_length::write_idx, 0), file.make_write_req(0, buf.get()), &intent, {});
+
+    // Dispatch the request into the sink, but not further
+    seastar::sleep(std::chrono::milliseconds(500)).get();
+    tio.queue.poll_io_queue();
+
+    // Cancelling now must chase it into the sink...
+    intent.cancel();
+    BOOST_REQUIRE_THROW(f.get(), cancelled_error);
+
+    // ...and the sink must have nothing left to submit
+    unsigned submitted = 0;
+    tio.sink.drain([&submitted] (const internal::io_request& rq, io_completion* desc) -> bool {
+        submitted++;
+        return true;
+    });
+    BOOST_REQUIRE_EQUAL(submitted, 0);
+    BOOST_REQUIRE_EQUAL(file.data[0], 0);
+}
+
+SEASTAR_THREAD_TEST_CASE(test_tenant_throttling) {
+    io_queue_for_tests tio;
+    fake_file file;
+
+    // 4k/s bandwidth with a 4k burst -- the first request dispatches at
+    // once, the second has to wait a second for its tokens
+    io_tenant tenant(4096, 4096);
+    io_intent intent(tenant);
+
+    auto v0 = std::make_unique<int>(13);
+    auto v1 = std::make_unique<int>(42);
+    auto f0 = tio.queue.queue_request(default_priority_class(), internal::io_direction_and_length(internal::io_direction_and_length::write_idx, 4096), file.make_write_req(0, v0.get()), &intent, {});
+    auto f1 = tio.queue.queue_request(default_priority_class(), internal::io_direction_and_length(internal::io_direction_and_length::write_idx, 4096), file.make_write_req(1, v1.get()), &intent, {});
+
+    auto drain = [&] {
+        tio.queue.poll_io_queue();
+        tio.sink.drain([&file] (const internal::io_request& rq, io_completion* desc) -> bool {
+            file.execute_write_req(rq, desc);
+            return true;
+        });
+    };
+
+    seastar::sleep(std::chrono::milliseconds(300)).get();
+    drain();
+
+    BOOST_REQUIRE_EQUAL(f0.get0(), 1);
+    BOOST_REQUIRE_EQUAL(file.data[0], 13);
+    // the tenant is out of tokens, the second request waits behind its bucket
+    BOOST_REQUIRE(!f1.available());
+
+    seastar::sleep(std::chrono::milliseconds(1200)).get();
+    drain();
+
+    BOOST_REQUIRE_EQUAL(f1.get0(), 1);
+    BOOST_REQUIRE_EQUAL(file.data[1], 42);
+}
+
 SEASTAR_TEST_CASE(test_request_buffer_split) {
     auto ensure = [] (const std::vector<internal::io_request::part>& parts, const internal::io_request& req, int idx, uint64_t pos, size_t size, uintptr_t mem) {
         BOOST_REQUIRE(parts[idx].req.opcode() == req.opcode());
@@ -501,3 +594,65 @@ SEASTAR_TEST_CASE(test_request_iovec_split) {
 
     return make_ready_future<>();
 }
+
+SEASTAR_THREAD_TEST_CASE(test_sink_write_combining) {
+    struct fake_completion : public io_completion {
+        int completed = 0;
+        virtual void complete(size_t res) noexcept override { completed++; }
+        virtual void set_exception(std::exception_ptr eptr) noexcept override {}
+    };
+
+    internal::io_sink sink;
+    // Deadline long enough not to expire while the test runs
+    sink.enable_write_combining(std::chrono::microseconds(10000000), 4);
+
+    fake_file file;
+    fake_completion desc;
+    size_t drained;
+    auto drain = [&] {
+        return sink.drain([&file] (const internal::io_request& rq, io_completion* d) -> bool {
+            file.execute_write_req(rq, d);
+            return true;
+        });
+    };
+
+    // A small all-write batch is held back...
+    auto v0 = std::make_unique<int>(17);
+    auto v1 = std::make_unique<int>(31);
+    sink.submit(&desc, fake_file::make_write_req(0, v0.get()));
+    sink.submit(&desc, fake_file::make_write_req(1, v1.get()));
+    BOOST_REQUIRE_EQUAL(drain(), 0);
+
+    // ...until it reaches the batch size...
+    auto v2 = std::make_unique<int>(13);
+    auto v3 = std::make_unique<int>(42);
+    sink.submit(&desc, fake_file::make_write_req(2, v2.get()));
+    sink.submit(&desc, fake_file::make_write_req(3, v3.get()));
+    drained = drain();
+    BOOST_REQUIRE_EQUAL(drained, 4);
+    BOOST_REQUIRE_EQUAL(file.data[1], 31);
+
+    // ...or a latency-critical request arrives behind it...
+    sink.submit(&desc, fake_file::make_write_req(4, v0.get()));
+    BOOST_REQUIRE_EQUAL(drain(), 0);
+    auto iov = std::vector<::iovec>({{v1.get(), 1}});
+    sink.submit(&desc, internal::io_request::make_readv(0, 0, iov, false));
+    drained = sink.drain([&file] (const internal::io_request& rq, io_completion* d) -> bool {
+        if (rq.opcode() == internal::io_request::operation::write) {
+            file.execute_write_req(rq, d);
+        } else {
+            d->complete_with(1);
+        }
+        return true;
+    });
+    BOOST_REQUIRE_EQUAL(drained, 2);
+    BOOST_REQUIRE_EQUAL(file.data[4], 17);
+
+    // ...or the reactor is about to go idle.
+    sink.submit(&desc, fake_file::make_write_req(5, v3.get()));
+    BOOST_REQUIRE_EQUAL(drain(), 0);
+    BOOST_REQUIRE(sink.flush_held());
+    BOOST_REQUIRE_EQUAL(drain(), 1);
+    BOOST_REQUIRE_EQUAL(file.data[5], 42);
+    BOOST_REQUIRE(!sink.flush_held());
+}
@@ -19,6 +19,7 @@
 /*
  * Copyright (C) 2016 ScyllaDB.
  */
+#include <sstream>
 #include <vector>
 
 #include <seastar/core/do_with.hh>
@@ -26,6 +27,7 @@
 #include <seastar/core/sstring.hh>
 #include <seastar/core/do_with.hh>
 #include <seastar/json/formatter.hh>
+#include <seastar/json/json_elements.hh>
 
 using namespace seastar;
 using namespace json;
@@ -59,3 +61,57 @@ SEASTAR_TEST_CASE(test_collections) {
 
     return make_ready_future();
 }
+
+/*!
+ * \brief a helper data sink that stores everything it gets in a stringstream
+ */
+class memory_data_sink_impl : public data_sink_impl {
+    std::stringstream& _ss;
+public:
+    memory_data_sink_impl(std::stringstream& ss) : _ss(ss) {
+    }
+    virtual future<> put(net::packet data) override {
+        abort();
+        return make_ready_future<>();
+    }
+    virtual future<> put(temporary_buffer<char> buf) override {
+        _ss.write(buf.get(), buf.size());
+        return make_ready_future<>();
+    }
+    virtual future<> flush() override {
+        return make_ready_future<>();
+    }
+    virtual future<> close() override {
+        return make_ready_future<>();
+    }
+};
+
+class memory_data_sink : public data_sink {
+public:
+    memory_data_sink(std::stringstream& ss)
+        : data_sink(std::make_unique<memory_data_sink_impl>(ss)) {}
+};
+
+struct layout_obj {
+    json_element<int> id;
+    sstring name;
+    json_element<sstring> optional;
+};
+
+SEASTAR_TEST_CASE(test_object_layout) {
+    static const json_object_layout<layout_obj, json_element<int>, sstring, json_element<sstring>> layout(
+            {&layout_obj::id, "id"}, {&layout_obj::name, "name"}, {&layout_obj::optional, "optional"});
+    layout_obj obj;
+    obj.id = 3;
+    obj.name = "apa";
+    // obj.optional deliberately left unset; it should be skipped
+    return do_with(std::stringstream(), std::move(obj), [] (std::stringstream& ss, layout_obj& obj) {
+        return do_with(output_stream<char>(memory_data_sink(ss), 32000), [&obj] (output_stream<char>& os) {
+            return layout.write(os, obj).then([&os] {
+                return os.flush();
+            });
+        }).then([&ss] {
+            BOOST_CHECK_EQUAL("{\"id\":3,\"name\":\"apa\"}", ss.str());
+        });
+    });
+}
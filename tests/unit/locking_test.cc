@@ -28,6 +28,7 @@
 #include <seastar/core/do_with.hh>
 #include <seastar/core/loop.hh>
 #include <seastar/core/sleep.hh>
+#include <seastar/core/read_mostly_lock.hh>
 #include <seastar/core/rwlock.hh>
 #include <seastar/core/shared_mutex.hh>
 #include <seastar/util/alloc_failure_injector.hh>
@@ -305,6 +306,83 @@ SEASTAR_THREAD_TEST_CASE(test_shared_mutex_failed_lock) {
 #endif // SEASTAR_ENABLE_ALLOC_FAILURE_INJECTION
 }
 
+SEASTAR_THREAD_TEST_CASE(test_read_mostly_lock) {
+    read_mostly_lock rml;
+
+    // fast path: guards acquired synchronously, reads share
+    auto g1 = rml.try_read_lock();
+    BOOST_REQUIRE(g1);
+    auto g2 = rml.try_read_lock();
+    BOOST_REQUIRE(g2);
+    BOOST_REQUIRE(!rml.try_write_lock());
+
+    // a waiting writer blocks new readers
+    future<> w = rml.write_lock();
+    BOOST_REQUIRE(!w.available());
+    BOOST_REQUIRE(!rml.try_read_lock());
+
+    // the last departing reader admits the writer
+    g1->release();
+    BOOST_REQUIRE(!w.available());
+    g2->release();
+    w.get();
+    BOOST_REQUIRE(!rml.try_read_lock());
+    rml.write_unlock();
+
+    BOOST_REQUIRE(rml.try_write_lock());
+    rml.write_unlock();
+}
+
+SEASTAR_TEST_CASE(test_read_mostly_lock_exclusive) {
+    return do_with(read_mostly_lock(), unsigned(0), [] (read_mostly_lock& rml, unsigned& counter) {
+        return parallel_for_each(boost::irange(0, 10), [&rml, &counter] (int idx) {
+            return with_write_lock(rml, [&counter] {
+                BOOST_REQUIRE_EQUAL(counter, 0u);
+                ++counter;
+                return sleep(1ms).then([&counter] {
+                    --counter;
+                    BOOST_REQUIRE_EQUAL(counter, 0u);
+                });
+            });
+        });
+    });
+}
+
+SEASTAR_TEST_CASE(test_read_mostly_lock_shared) {
+    return do_with(read_mostly_lock(), unsigned(0), unsigned(0), [] (read_mostly_lock& rml, unsigned& counter, unsigned& max) {
+        return parallel_for_each(boost::irange(0, 10), [&rml, &counter, &max] (int idx) {
+            return with_read_lock(rml, [&counter, &max] {
+                ++counter;
+                max = std::max(max, counter);
+                return sleep(1ms).then([&counter] {
+                    --counter;
+                });
+            });
+        }).finally([&counter, &max] {
+            BOOST_REQUIRE_EQUAL(counter, 0u);
+            BOOST_REQUIRE_NE(max, 0u);
+        });
+    });
+}
+
+SEASTAR_THREAD_TEST_CASE(test_read_mostly_lock_failed_func) {
+    read_mostly_lock rml;
+
+    // verify that the lock is released when func fails
+    future<> fut = with_read_lock(rml, [] {
+        throw std::runtime_error("injected");
+    });
+    BOOST_REQUIRE_THROW(fut.get(), std::runtime_error);
+
+    fut = with_write_lock(rml, [] {
+        throw std::runtime_error("injected");
+    });
+    BOOST_REQUIRE_THROW(fut.get(), std::runtime_error);
+
+    BOOST_REQUIRE(rml.try_write_lock());
+    rml.write_unlock();
+}
+
 struct expected_exception : public std::exception {
     int value;
     expected_exception(int v) noexcept : value(v) {}
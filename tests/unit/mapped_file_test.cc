@@ -0,0 +1,104 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (C) 2026 ScyllaDB
+ */
+
+#include <seastar/testing/test_case.hh>
+#include <seastar/testing/thread_test_case.hh>
+
+#include <seastar/core/aligned_buffer.hh>
+#include <seastar/core/file.hh>
+#include <seastar/core/mapped_file.hh>
+#include <seastar/core/seastar.hh>
+#include <seastar/util/tmp_file.hh>
+
+using namespace seastar;
+
+static sstring make_test_file(const sstring& dir, size_t size) {
+    auto name = dir + "/testfile.dat";
+    auto f = open_file_dma(name, open_flags::rw | open_flags::create | open_flags::truncate).get0();
+    auto buf = allocate_aligned_buffer<char>(size, f.memory_dma_alignment());
+    for (size_t i = 0; i < size; i++) {
+        buf.get()[i] = 'a' + i % 26;
+    }
+    BOOST_REQUIRE_EQUAL(f.dma_write(0, buf.get(), size).get0(), size);
+    f.flush().get();
+    f.close().get();
+    return name;
+}
+
+SEASTAR_TEST_CASE(test_mapped_file_touch_and_get) {
+    return tmp_dir::do_with_thread([] (tmp_dir& t) {
+        constexpr size_t file_size = 16384;
+        auto name = make_test_file(t.get_path().native(), file_size);
+
+        auto mf = mapped_file::map(name).get0();
+        BOOST_REQUIRE_EQUAL(mf.size(), file_size);
+
+        // Untouched ranges are not accessible.
+        BOOST_REQUIRE_THROW(mf.get(0, 100), std::runtime_error);
+        // Out-of-range access is rejected regardless.
+        BOOST_REQUIRE_THROW(mf.get(file_size - 1, 2), std::out_of_range);
+
+        mf.touch(4096, 4096).get();
+        auto p = mf.get(5000, 26);
+        for (size_t i = 0; i < 26; i++) {
+            BOOST_REQUIRE_EQUAL(p[i], char('a' + (5000 + i) % 26));
+        }
+        // The rest of the file is still guarded.
+        BOOST_REQUIRE_THROW(mf.get(0, 4096), std::runtime_error);
+
+        // touch() ranges merge, so spanning accesses work.
+        mf.touch(0, 4096).get();
+        mf.get(0, 8192);
+    });
+}
+
+SEASTAR_TEST_CASE(test_mapped_file_lock_unlock) {
+    return tmp_dir::do_with_thread([] (tmp_dir& t) {
+        constexpr size_t file_size = 8192;
+        auto name = make_test_file(t.get_path().native(), file_size);
+
+        auto mf = mapped_file::map(name).get0();
+        mf.lock(0, file_size).get();
+        auto p = mf.get(0, file_size);
+        BOOST_REQUIRE_EQUAL(p[0], 'a');
+        mf.unlock(0, file_size).get();
+        // Unlocked pages stay accessible.
+        mf.get(0, file_size);
+
+        // Ranges are clamped to the file, so whole-file operations do not
+        // need to know the exact size.
+        mf.touch(0, std::numeric_limits<uint64_t>::max()).get();
+    });
+}
+
+SEASTAR_TEST_CASE(test_mapped_file_empty) {
+    return tmp_dir::do_with_thread([] (tmp_dir& t) {
+        auto name = t.get_path().native() + "/empty.dat";
+        auto f = open_file_dma(name, open_flags::rw | open_flags::create).get0();
+        f.close().get();
+
+        auto mf = mapped_file::map(name).get0();
+        BOOST_REQUIRE_EQUAL(mf.size(), 0u);
+        mf.touch(0, 4096).get();
+        BOOST_REQUIRE_THROW(mf.get(0, 1), std::out_of_range);
+    });
+}
@@ -317,3 +317,63 @@ SEASTAR_THREAD_TEST_CASE(test_relabel_enable_disable_skip_when_empty) {
     }), 0);
     sm::set_relabel_configs({}).get();
 }
+
+SEASTAR_THREAD_TEST_CASE(test_log_linear_histogram) {
+    namespace sm = seastar::metrics;
+    // sub-bucket bits = 1: width-1 buckets for 0..1, then every
+    // power-of-two range split in two.
+    sm::log_linear_histogram<1, 4> h;
+    for (uint64_t v = 0; v < 16; v++) {
+        h.record(v);
+    }
+    h.record(16); // overflow, lands in +Inf
+    BOOST_CHECK_EQUAL(h.sample_count(), 17);
+    BOOST_CHECK_EQUAL(h.sample_sum(), 136);
+
+    auto mh = h.to_metrics_histogram();
+    // (4 - 1 + 1) * 2 regular buckets plus +Inf
+    BOOST_REQUIRE_EQUAL(mh.buckets.size(), 9);
+    // upper bounds: 0, 1, 2, 3, 5, 7, 11, 15, +Inf
+    const double bounds[] = {0, 1, 2, 3, 5, 7, 11, 15};
+    // cumulative counts: one value per width-1 bucket, then bucket
+    // width doubling per range
+    const uint64_t counts[] = {1, 2, 3, 4, 6, 8, 12, 16};
+    for (size_t i = 0; i < 8; i++) {
+        BOOST_CHECK_EQUAL(mh.buckets[i].upper_bound, bounds[i]);
+        BOOST_CHECK_EQUAL(mh.buckets[i].count, counts[i]);
+    }
+    BOOST_CHECK(std::isinf(mh.buckets[8].upper_bound));
+    BOOST_CHECK_EQUAL(mh.buckets[8].count, 17);
+
+    // merge is per-bucket addition
+    auto sum = h + h;
+    BOOST_CHECK_EQUAL(sum.sample_count(), 34);
+    BOOST_CHECK_EQUAL(sum.to_metrics_histogram().buckets[4].count, 12);
+
+    // scaling converts recorded units at scrape time
+    auto scaled = h.to_metrics_histogram(1e-6);
+    BOOST_CHECK_EQUAL(scaled.buckets[2].upper_bound, 2e-6);
+    BOOST_CHECK_EQUAL(scaled.sample_sum, 136e-6);
+}
+
+SEASTAR_THREAD_TEST_CASE(test_interned_labels) {
+    namespace smi = seastar::metrics::impl;
+    // equal contents intern to the same string, so equality is a
+    // pointer compare and maps with equal labels compare equal
+    smi::interned_string a("shard");
+    smi::interned_string b(seastar::sstring("shard"));
+    BOOST_CHECK(a == b);
+    BOOST_CHECK_EQUAL(a.hash(), b.hash());
+    BOOST_CHECK(a != smi::interned_string("other"));
+
+    smi::labels_type l1;
+    l1["shard"] = "0";
+    smi::labels_type l2;
+    l2["shard"] = "0";
+    BOOST_CHECK(l1 == l2);
+    BOOST_CHECK_EQUAL(std::hash<smi::labels_type>()(l1), std::hash<smi::labels_type>()(l2));
+
+    // transparent lookup by plain string, without interning the probe
+    BOOST_CHECK(l1.find(seastar::sstring("shard")) != l1.end());
+    BOOST_CHECK(l1.find(seastar::sstring("missing")) == l1.end());
+}
@@ -0,0 +1,112 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB
+ */
+
+#include <seastar/core/object_pool.hh>
+#include <seastar/testing/thread_test_case.hh>
+
+using namespace seastar;
+
+namespace {
+
+struct tracked {
+    static inline int live = 0;
+    int value;
+    explicit tracked(int v) : value(v) { ++live; }
+    ~tracked() { --live; }
+};
+
+}
+
+SEASTAR_THREAD_TEST_CASE(test_get_constructs_and_recycles_storage) {
+    object_pool<tracked> pool(4);
+    void* addr;
+    {
+        auto obj = pool.get(17);
+        BOOST_REQUIRE_EQUAL(obj->value, 17);
+        BOOST_REQUIRE_EQUAL(tracked::live, 1);
+        addr = obj.get();
+    }
+    BOOST_REQUIRE_EQUAL(tracked::live, 0);
+    BOOST_REQUIRE_EQUAL(pool.free_objects(), 1u);
+    // the next get() reuses the returned storage and re-runs the
+    // constructor with the new arguments
+    auto obj = pool.get(42);
+    BOOST_REQUIRE_EQUAL(obj.get(), addr);
+    BOOST_REQUIRE_EQUAL(obj->value, 42);
+    BOOST_REQUIRE_EQUAL(pool.free_objects(), 0u);
+}
+
+SEASTAR_THREAD_TEST_CASE(test_free_list_is_bounded) {
+    object_pool<tracked> pool(2);
+    std::vector<object_pool<tracked>::ptr> objs;
+    for (int i = 0; i < 5; i++) {
+        objs.push_back(pool.get(i));
+    }
+    objs.clear();
+    BOOST_REQUIRE_EQUAL(pool.free_objects(), 2u);
+}
+
+SEASTAR_THREAD_TEST_CASE(test_throwing_constructor_keeps_storage) {
+    struct thrower {
+        explicit thrower(bool do_throw) {
+            if (do_throw) {
+                throw std::runtime_error("nope");
+            }
+        }
+    };
+    object_pool<thrower> pool(4);
+    BOOST_REQUIRE_THROW(pool.get(true), std::runtime_error);
+    BOOST_REQUIRE_EQUAL(pool.free_objects(), 1u);
+    auto obj = pool.get(false);
+    BOOST_REQUIRE_EQUAL(pool.free_objects(), 0u);
+}
+
+SEASTAR_THREAD_TEST_CASE(test_warm_up) {
+    object_pool<tracked> pool(8);
+    pool.warm_up(16).get();
+    // capped by the pool's bound
+    BOOST_REQUIRE_EQUAL(pool.free_objects(), 8u);
+    BOOST_REQUIRE_EQUAL(tracked::live, 0);
+}
+
+SEASTAR_THREAD_TEST_CASE(test_warm_up_some_respects_poll) {
+    object_pool<tracked> pool(8);
+    auto r = pool.warm_up_some([] { return false; }, 5);
+    BOOST_REQUIRE(r == idle_cpu_handler_result::no_more_work);
+    BOOST_REQUIRE_EQUAL(pool.free_objects(), 5u);
+    // a poll reporting pending work interrupts the warm-up
+    r = pool.warm_up_some([] { return true; }, 8);
+    BOOST_REQUIRE(r == idle_cpu_handler_result::interrupted_by_higher_priority_task);
+    BOOST_REQUIRE_EQUAL(pool.free_objects(), 6u);
+}
+
+SEASTAR_THREAD_TEST_CASE(test_rebalance) {
+    object_pool<tracked> donor(8);
+    object_pool<tracked> receiver(3);
+    donor.warm_up(6).get();
+    // the receiver's bound caps what it adopts; the rest is freed
+    auto moved = donor.rebalance_to(receiver, 5).get0();
+    BOOST_REQUIRE_EQUAL(moved, 5u);
+    BOOST_REQUIRE_EQUAL(donor.free_objects(), 1u);
+    BOOST_REQUIRE_EQUAL(receiver.free_objects(), 3u);
+    BOOST_REQUIRE_EQUAL(donor.rebalance_to(receiver, 5).get0(), 1u);
+    BOOST_REQUIRE_EQUAL(donor.free_objects(), 0u);
+}
@@ -21,6 +21,7 @@
 
 #include <seastar/core/app-template.hh>
 #include <seastar/core/shared_ptr.hh>
+#include <seastar/core/sleep.hh>
 #include <seastar/core/vector-data-sink.hh>
 #include <seastar/core/loop.hh>
 #include <seastar/util/later.hh>
@@ -157,3 +158,127 @@ SEASTAR_THREAD_TEST_CASE(test_simple_write) {
     BOOST_REQUIRE_EQUAL(buf.size(), 1);
     BOOST_REQUIRE_EQUAL(sstring(buf.front().get(), buf.front().size()), value);
 }
+
+SEASTAR_THREAD_TEST_CASE(test_paced_flush) {
+    auto vec = std::vector<net::packet>{};
+    output_stream_options opts;
+    opts.flush_period = std::chrono::milliseconds(100);
+    auto out = output_stream<char>(data_sink(std::make_unique<vector_data_sink>(vec)), 8, opts);
+
+    auto start = steady_clock_type::now();
+    out.write(sstring("one")).get();
+    out.flush().get();
+    // the first flush of an idle stream is not delayed
+    while (vec.empty()) {
+        seastar::sleep(std::chrono::milliseconds(1)).get();
+    }
+
+    out.write(sstring("two")).get();
+    out.flush().get();
+    while (vec.size() < 2) {
+        seastar::sleep(std::chrono::milliseconds(1)).get();
+    }
+    // the second flush must have waited out the pacing period
+    BOOST_REQUIRE(steady_clock_type::now() - start >= std::chrono::milliseconds(100));
+    BOOST_REQUIRE_EQUAL(to_sstring(vec[0]), "one");
+    BOOST_REQUIRE_EQUAL(to_sstring(vec[1]), "two");
+    out.close().get();
+}
+
+SEASTAR_THREAD_TEST_CASE(test_corked_region) {
+    auto vec = std::vector<net::packet>{};
+    auto out = output_stream<char>(data_sink(std::make_unique<vector_data_sink>(vec)), 64);
+
+    {
+        auto cork = out.cork();
+        out.write(sstring("one")).get();
+        out.flush().get();
+        // corked: the flush is deferred and nothing reaches the sink
+        BOOST_REQUIRE(vec.empty());
+        out.write(sstring("two")).get();
+        out.flush().get();
+        BOOST_REQUIRE(vec.empty());
+        // releasing issues the deferred flush as one aggregated batch
+        cork.release().get();
+    }
+    BOOST_REQUIRE_EQUAL(vec.size(), 1);
+    BOOST_REQUIRE_EQUAL(to_sstring(vec[0]), "onetwo");
+
+    {
+        // a region destroyed without release() folds the deferred
+        // flush into the next one
+        auto cork = out.cork();
+        out.write(sstring("three")).get();
+        out.flush().get();
+    }
+    BOOST_REQUIRE_EQUAL(vec.size(), 1);
+    out.flush().get();
+    BOOST_REQUIRE_EQUAL(vec.size(), 2);
+    BOOST_REQUIRE_EQUAL(to_sstring(vec[1]), "three");
+    out.close().get();
+}
+
+namespace {
+
+// hands out a fixed number of fixed-size chunks, then eof
+class counting_source final : public data_source_impl {
+    size_t _chunks;
+    size_t _chunk_size;
+public:
+    counting_source(size_t chunks, size_t chunk_size) : _chunks(chunks), _chunk_size(chunk_size) {}
+    virtual future<temporary_buffer<char>> get() override {
+        if (!_chunks) {
+            return make_ready_future<temporary_buffer<char>>();
+        }
+        --_chunks;
+        return make_ready_future<temporary_buffer<char>>(temporary_buffer<char>(_chunk_size));
+    }
+};
+
+}
+
+SEASTAR_THREAD_TEST_CASE(test_pipeline_backpressure_credits) {
+    auto bp = make_lw_shared<pipeline_backpressure>(1024);
+    bp->acquire(512).get();
+    BOOST_REQUIRE_EQUAL(bp->available(), 512u);
+    auto f = bp->acquire(1024);
+    BOOST_REQUIRE(!f.available());
+    bp->release(512);
+    f.get();
+    BOOST_REQUIRE_EQUAL(bp->available(), 0u);
+    // a request larger than the whole budget is admitted once everything drains
+    auto oversized = bp->acquire(4096);
+    BOOST_REQUIRE(!oversized.available());
+    bp->release(1024);
+    oversized.get();
+    bp->release(4096);
+    BOOST_REQUIRE_EQUAL(bp->available(), 1024u);
+}
+
+SEASTAR_THREAD_TEST_CASE(test_pipeline_backpressure_stalls_reads) {
+    auto bp = make_lw_shared<pipeline_backpressure>(1024);
+    auto in = input_stream<char>(data_source(std::make_unique<counting_source>(3, 512)));
+    in.set_backpressure(bp);
+
+    auto b1 = in.read().get0();
+    BOOST_REQUIRE_EQUAL(b1.size(), 512u);
+    auto b2 = in.read().get0();
+    BOOST_REQUIRE_EQUAL(bp->available(), 0u);
+
+    // the budget is exhausted by the two live buffers, so the third read
+    // must wait until one of them is freed
+    auto f = in.read();
+    for (int i = 0; i < 10; i++) {
+        yield().get();
+    }
+    BOOST_REQUIRE(!f.available());
+    b1 = {};
+    auto b3 = f.get0();
+    BOOST_REQUIRE_EQUAL(b3.size(), 512u);
+
+    b2 = {};
+    b3 = {};
+    BOOST_REQUIRE_EQUAL(bp->available(), 1024u);
+    BOOST_REQUIRE(in.read().get0().empty());
+    in.close().get();
+}
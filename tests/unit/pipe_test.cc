@@ -49,3 +49,60 @@ SEASTAR_THREAD_TEST_CASE(simple_pipe_test) {
     BOOST_CHECK(f2.available());
     BOOST_REQUIRE_EQUAL(*f2.get0(), 42);
 }
+
+static_assert(std::is_nothrow_move_constructible_v<seastar::batch_pipe_reader<int>>);
+static_assert(std::is_nothrow_move_assignable_v<seastar::batch_pipe_reader<int>>);
+
+static_assert(std::is_nothrow_move_constructible_v<seastar::batch_pipe_writer<int>>);
+static_assert(std::is_nothrow_move_assignable_v<seastar::batch_pipe_writer<int>>);
+
+SEASTAR_THREAD_TEST_CASE(simple_batch_pipe_test) {
+    seastar::batch_pipe<int> p(4);
+
+    // a blocked read is woken by the first write and takes everything
+    // accumulated since
+    auto f0 = p.reader.read();
+    BOOST_CHECK(!f0.available());
+    p.writer.write(1).get();
+    p.writer.write(2).get();
+    p.writer.write(3).get();
+    auto batch = f0.get0();
+    BOOST_REQUIRE_EQUAL(batch.size(), 3u);
+    BOOST_REQUIRE_EQUAL(batch.front(), 1);
+
+    // a write filling the pipe blocks until the reader drains it
+    for (int i = 0; i < 3; i++) {
+        p.writer.write(int(i)).get();
+    }
+    auto f1 = p.writer.write(3);
+    BOOST_CHECK(!f1.available());
+    BOOST_REQUIRE_EQUAL(p.reader.read().get0().size(), 4u);
+    f1.get();
+}
+
+SEASTAR_THREAD_TEST_CASE(batch_pipe_eof_test) {
+    seastar::batch_pipe<int> p(4);
+    p.writer.write(17).get();
+    auto reader = std::move(p.reader);
+    {
+        auto writer = std::move(p.writer);
+    }
+    // items written before the writer was closed are still delivered...
+    auto batch = reader.read().get0();
+    BOOST_REQUIRE_EQUAL(batch.size(), 1u);
+    BOOST_REQUIRE_EQUAL(batch.front(), 17);
+    // ...and then an empty batch marks the end of file
+    BOOST_CHECK(reader.read().get0().empty());
+}
+
+SEASTAR_THREAD_TEST_CASE(batch_pipe_broken_test) {
+    seastar::batch_pipe<int> p(1);
+    auto writer = std::move(p.writer);
+    auto f0 = writer.write(17);
+    BOOST_CHECK(!f0.available());
+    {
+        auto reader = std::move(p.reader);
+    }
+    BOOST_REQUIRE_THROW(f0.get(), broken_pipe_exception);
+    BOOST_REQUIRE_THROW(writer.write(42).get(), broken_pipe_exception);
+}
@@ -72,3 +72,61 @@ SEASTAR_TEST_CASE(test_header_parsing) {
     }
     return make_ready_future<>();
 }
+
+SEASTAR_TEST_CASE(test_borrowed_header_parsing) {
+    auto buf = [] (const sstring& msg) {
+        return temporary_buffer<char>(msg.c_str(), msg.size());
+    };
+
+    http_request_parser parser;
+    parser.set_borrow_headers(true);
+
+    // headers contained in one buffer become views into the retained buffer
+    {
+        parser.init();
+        BOOST_REQUIRE(parser(buf("GET /test HTTP/1.1\r\nHost: test\r\nConnection: keep-alive\r\nPad:  padded value  \r\n\r\n")).get0().has_value());
+        BOOST_REQUIRE(!parser.failed());
+        auto req = parser.get_parsed_request();
+        BOOST_REQUIRE_EQUAL(req->borrowed_headers.size(), 3u);
+        BOOST_REQUIRE(req->_headers.empty());
+        BOOST_REQUIRE_EQUAL(req->get_header("host"), "test");
+        BOOST_REQUIRE_EQUAL(req->get_header("Pad"), "padded value");
+        BOOST_REQUIRE(req->should_keep_alive());
+    }
+
+    // repeated names must be comma-combined, which forces a copied header
+    {
+        parser.init();
+        BOOST_REQUIRE(parser(buf("GET /test HTTP/1.1\r\nHeader: Field\r\nHeader: Field2\r\n\r\n")).get0().has_value());
+        BOOST_REQUIRE(!parser.failed());
+        auto req = parser.get_parsed_request();
+        BOOST_REQUIRE(req->borrowed_headers.empty());
+        BOOST_REQUIRE_EQUAL(req->get_header("Header"), "Field,Field2");
+    }
+
+    // an obs-fold continuation line materializes the folded header
+    {
+        parser.init();
+        BOOST_REQUIRE(parser(buf("GET /test HTTP/1.1\r\nHeader: fiel\r\n    d\r\n\r\n")).get0().has_value());
+        BOOST_REQUIRE(!parser.failed());
+        auto req = parser.get_parsed_request();
+        BOOST_REQUIRE(req->borrowed_headers.empty());
+        BOOST_REQUIRE_EQUAL(req->get_header("Header"), "fiel d");
+    }
+
+    // a header split across two buffers falls back to a copied header,
+    // while intact ones are still borrowed
+    {
+        parser.init();
+        BOOST_REQUIRE(!parser(buf("GET /test HTTP/1.1\r\nHost: te")).get0().has_value());
+        BOOST_REQUIRE(parser(buf("st\r\nHeader: Field\r\n\r\n")).get0().has_value());
+        BOOST_REQUIRE(!parser.failed());
+        auto req = parser.get_parsed_request();
+        BOOST_REQUIRE_EQUAL(req->_headers.count("Host"), 1u);
+        BOOST_REQUIRE_EQUAL(req->get_header("Host"), "test");
+        BOOST_REQUIRE_EQUAL(req->borrowed_headers.size(), 1u);
+        BOOST_REQUIRE_EQUAL(req->get_header("Header"), "Field");
+    }
+
+    return make_ready_future<>();
+}
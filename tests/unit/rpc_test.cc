@@ -24,6 +24,7 @@
 #include <seastar/rpc/rpc_types.hh>
 #include <seastar/rpc/lz4_compressor.hh>
 #include <seastar/rpc/lz4_fragmented_compressor.hh>
+#include <seastar/rpc/lz4_streaming_compressor.hh>
 #include <seastar/rpc/multi_algo_compressor_factory.hh>
 #include <seastar/testing/test_case.hh>
 #include <seastar/testing/thread_test_case.hh>
@@ -93,6 +94,14 @@ inline sstring read(serializer, Input& in, rpc::type<sstring>) {
     return ret;
 }
 
+namespace seastar {
+namespace rpc {
+// the serializer above writes arithmetic types as their raw object
+// representation, so it qualifies for the compile-time marshalling path
+template <> struct raw_serializer<serializer> : std::true_type {};
+}
+}
+
 using test_rpc_proto = rpc::protocol<serializer>;
 using make_socket_fn = std::function<seastar::socket ()>;
 
@@ -450,6 +459,30 @@ SEASTAR_TEST_CASE(test_rpc_cancel) {
     });
 }
 
+SEASTAR_TEST_CASE(test_rpc_small_message_overtakes_large) {
+    rpc::client_options co;
+    co.large_message_threshold = 128 * 1024;
+    return rpc_test_env<>::do_with_thread(rpc_test_config(), co, [] (rpc_test_env<>& env, test_rpc_proto::client& c1) {
+        std::vector<int> order;
+        env.register_handler(1, [&order] (sstring) { order.push_back(1); }).get();
+        env.register_handler(2, [&order] (sstring) { order.push_back(2); }).get();
+        auto big = env.proto().make_client<void (sstring)>(1);
+        auto small = env.proto().make_client<void (sstring)>(2);
+        promise<> cont;
+        c1.suspend_for_testing(cont);
+        // While the queue is suspended enqueue a large message and then a
+        // small one; the small one should jump the queue and arrive first.
+        auto f1 = big(c1, uninitialized_string(512 * 1024));
+        auto f2 = small(c1, sstring("x"));
+        cont.set_value();
+        f1.get();
+        f2.get();
+        BOOST_REQUIRE_EQUAL(order.size(), 2u);
+        BOOST_REQUIRE_EQUAL(order[0], 2);
+        BOOST_REQUIRE_EQUAL(order[1], 1);
+    });
+}
+
 SEASTAR_TEST_CASE(test_message_to_big) {
     rpc_test_config cfg;
     cfg.resource_limits = {0, 1, 100};
@@ -470,6 +503,35 @@ SEASTAR_TEST_CASE(test_message_to_big) {
     });
 }
 
+SEASTAR_TEST_CASE(test_rpc_borrowed_buf) {
+    return rpc_test_env<>::do_with_thread(rpc_test_config(), [] (rpc_test_env<>& env, test_rpc_proto::client& c1) {
+        // larger than any single receive fragment, so the handler sees
+        // a multi-fragment payload borrowed from the connection buffers
+        constexpr size_t payload_size = 512 * 1024;
+        env.register_handler(1, [] (rpc::borrowed_buf data) {
+            uint64_t sum = 0;
+            for (auto& frag : data.bufs) {
+                for (auto ch : frag) {
+                    sum += uint8_t(ch);
+                }
+            }
+            auto linear = data.linearize();
+            BOOST_REQUIRE_EQUAL(linear.size(), data.size);
+            return make_ready_future<uint64_t>(sum);
+        }).get();
+        auto checksum = env.proto().make_client<uint64_t (rpc::borrowed_buf)>(1);
+        temporary_buffer<char> payload(payload_size);
+        uint64_t expected = 0;
+        for (size_t i = 0; i < payload_size; i++) {
+            payload.get_write()[i] = char(i);
+            expected += uint8_t(char(i));
+        }
+        BOOST_REQUIRE_EQUAL(checksum(c1, rpc::borrowed_buf(std::move(payload))).get0(), expected);
+        // empty payloads must round-trip too
+        BOOST_REQUIRE_EQUAL(checksum(c1, rpc::borrowed_buf()).get0() + 1, 1u);
+    });
+}
+
 SEASTAR_TEST_CASE(test_rpc_remote_verb_error) {
     rpc_test_config cfg;
     return rpc_test_env<>::do_with_thread(cfg, [] (rpc_test_env<>& env) {
@@ -1175,6 +1237,145 @@ SEASTAR_THREAD_TEST_CASE(test_lz4_fragmented_compressor) {
     test_compressor([] { return std::make_unique<rpc::lz4_fragmented_compressor>(); });
 }
 
+SEASTAR_THREAD_TEST_CASE(test_lz4_streaming_compressor) {
+    using namespace seastar::rpc;
+
+    // The streaming compressor carries compression history from one message to
+    // the next, so every message has to be decompressed exactly once and in the
+    // order it was compressed. test_compressor() decompresses each message
+    // several times and is therefore not applicable; instead pair a compressing
+    // and a decompressing instance the way the two ends of an RPC connection
+    // would and push a sequence of messages through them.
+    lz4_streaming_compressor tx;
+    lz4_streaming_compressor rx;
+
+    auto& eng = testing::local_random_engine;
+    auto dist = std::uniform_int_distribution<int>(0, std::numeric_limits<char>::max());
+
+    auto linearize = [] (const auto& buffer) {
+        return seastar::visit(buffer.bufs,
+            [] (const temporary_buffer<char>& buf) {
+                return buf.clone();
+            },
+            [&] (const std::vector<temporary_buffer<char>>& bufs) {
+                auto buf = temporary_buffer<char>(buffer.size);
+                auto dst = buf.get_write();
+                for (auto& b : bufs) {
+                    dst = std::copy_n(b.get(), b.size(), dst);
+                }
+                return buf;
+            }
+        );
+    };
+
+    auto split_buffer = [] (temporary_buffer<char> b, size_t chunk_size) {
+        std::vector<temporary_buffer<char>> bufs;
+        auto src = b.get();
+        auto n = b.size();
+        while (n) {
+            auto this_chunk = std::min(chunk_size, n);
+            bufs.emplace_back(this_chunk);
+            std::copy_n(src, this_chunk, bufs.back().get_write());
+            src += this_chunk;
+            n -= this_chunk;
+        }
+        return bufs;
+    };
+
+    auto roundtrip = [&] (snd_buf in, size_t headroom) {
+        auto in_l = linearize(in);
+        auto compressed = tx.compress(headroom, std::move(in));
+
+        // Remove headroom
+        BOOST_CHECK_GE(compressed.size, headroom);
+        compressed.size -= headroom;
+        seastar::visit(compressed.bufs,
+            [&] (temporary_buffer<char>& buf) {
+                BOOST_CHECK_GE(buf.size(), headroom);
+                buf.trim_front(headroom);
+            },
+            [&] (std::vector<temporary_buffer<char>>& bufs) {
+                while (headroom) {
+                    BOOST_CHECK(!bufs.empty());
+                    auto to_remove = std::min(bufs.front().size(), headroom);
+                    bufs.front().trim_front(to_remove);
+                    if (bufs.front().empty() && bufs.size() > 1) {
+                        bufs.erase(bufs.begin());
+                    }
+                    headroom -= to_remove;
+                }
+            }
+        );
+        auto on_wire = compressed.size;
+
+        rcv_buf received;
+        received.size = compressed.size;
+        received.bufs = std::move(compressed.bufs);
+
+        auto decompressed = rx.decompress(std::move(received));
+        BOOST_CHECK_EQUAL(decompressed.size, in_l.size());
+        auto out_l = linearize(decompressed);
+        BOOST_CHECK(in_l == out_l);
+        return on_wire;
+    };
+
+    static const std::string_view text = "The quick brown fox wants bananas for his long term health but sneaks bacon behind his wife's back. ";
+
+    auto gen_text = [&] (size_t s, std::optional<size_t> split = {}) {
+        auto buf = temporary_buffer<char>(s);
+        size_t n = 0;
+        while (n < s) {
+            auto rem = std::min(s - n, text.size());
+            std::copy(text.data(), text.data() + rem, buf.get_write() + n);
+            n += rem;
+        }
+        auto snd = snd_buf();
+        snd.size = s;
+        if (split) {
+            snd.bufs = split_buffer(std::move(buf), *split);
+        } else {
+            snd.bufs = std::move(buf);
+        }
+        return snd;
+    };
+
+    auto gen_rand = [&] (size_t s, std::optional<size_t> split = {}) {
+        auto buf = temporary_buffer<char>(s);
+        std::generate_n(buf.get_write(), s, [&] { return dist(eng); });
+        auto snd = snd_buf();
+        snd.size = s;
+        if (split) {
+            snd.bufs = split_buffer(std::move(buf), *split);
+        } else {
+            snd.bufs = std::move(buf);
+        }
+        return snd;
+    };
+
+    // Repeated small messages: history should make the repeats compress to
+    // almost nothing.
+    auto first = roundtrip(gen_text(300), 0);
+    size_t repeat = 0;
+    for (auto i = 0; i < 50; i++) {
+        repeat = roundtrip(gen_text(300), 0);
+    }
+    BOOST_CHECK_LT(repeat, first);
+
+    // Messages spanning multiple chunks, with fragmented input, enough of
+    // them to wrap the history ring several times.
+    for (auto i = 0; i < 8; i++) {
+        roundtrip(gen_text(200 * 1024, 1000), 0);
+        roundtrip(gen_rand(96 * 1024 + 13, 4096), 0);
+    }
+
+    // Chunk-boundary sizes and headroom.
+    roundtrip(gen_rand(32 * 1024), 0);
+    roundtrip(gen_rand(32 * 1024 + 1), 0);
+    roundtrip(gen_text(32 * 1024 - 1), 0);
+    roundtrip(gen_text(300), 128 * 1024);
+    roundtrip(gen_rand(1), 0);
+}
+
 // Test reproducing issue #671: If timeout is time_point::max(), translating
 // it to relative timeout in the sender and then back in the receiver, when
 // these calculations happen across a millisecond boundary, overflowed the
@@ -1498,3 +1699,24 @@ SEASTAR_TEST_CASE(test_rpc_send_timeout_on_connect) {
         send_messages_and_check_timeouts(env, cln);
     });
 }
+
+SEASTAR_THREAD_TEST_CASE(test_rpc_ewma_rate) {
+    using namespace std::chrono_literals;
+    rpc::ewma_rate r(1s);
+    BOOST_REQUIRE_EQUAL(r.rate(), 0);
+    for (int i = 0; i < 1000; i++) {
+        r.add(1);
+    }
+    // events are folded into the average once a full sample period elapsed
+    sleep(1100ms).get();
+    BOOST_REQUIRE_GT(r.rate(), 0);
+
+    rpc::connection_rollup rollup;
+    rollup.add_message(100, 400);
+    sleep(1100ms).get();
+    auto& w = rollup.short_window();
+    BOOST_REQUIRE_GT(w.messages.rate(), 0);
+    // raw bytes exceed wire bytes for a compressed message
+    BOOST_REQUIRE_GT(w.raw_bytes.rate(), w.wire_bytes.rate());
+    BOOST_REQUIRE_GT(rollup.long_window().messages.rate(), 0);
+}
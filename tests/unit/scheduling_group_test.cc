@@ -23,6 +23,7 @@
 #include <vector>
 #include <chrono>
 
+#include <seastar/core/loop.hh>
 #include <seastar/core/thread.hh>
 #include <seastar/testing/test_case.hh>
 #include <seastar/testing/thread_test_case.hh>
@@ -253,6 +254,94 @@ SEASTAR_THREAD_TEST_CASE(yield_preserves_sg) {
     }).get();
 }
 
+SEASTAR_THREAD_TEST_CASE(with_scheduling_group_runs_inline_when_idle) {
+    scheduling_group sg = create_scheduling_group("sg-inline", 100).get0();
+    auto cleanup = defer([&] () noexcept { destroy_scheduling_group(sg).get(); });
+    // Start with a fresh task quota so the inline path is taken
+    yield().get();
+    // The group has no queued tasks, so the function should run without
+    // a round trip through the task queue, under the target group
+    BOOST_REQUIRE(sg.may_run_immediately());
+    bool ran = false;
+    auto f = with_scheduling_group(sg, [&] {
+        BOOST_REQUIRE_EQUAL(
+                internal::scheduling_group_index(current_scheduling_group()),
+                internal::scheduling_group_index(sg));
+        ran = true;
+    });
+    BOOST_REQUIRE(ran);
+    BOOST_REQUIRE(f.available());
+    f.get();
+    // The caller's group is restored after the inline run
+    BOOST_REQUIRE(current_scheduling_group() != sg);
+}
+
+SEASTAR_THREAD_TEST_CASE(migrate_to_scheduling_group_retags_chain) {
+    scheduling_group sg = create_scheduling_group("sg-migrate", 100).get0();
+    auto cleanup = defer([&] () noexcept { destroy_scheduling_group(sg).get(); });
+    // Outside a seastar::thread: everything chained after the migration
+    // is created in, and resumes from, the new group
+    yield().then([&] {
+        return migrate_to_scheduling_group(sg).then([&] {
+            BOOST_REQUIRE_EQUAL(
+                    internal::scheduling_group_index(current_scheduling_group()),
+                    internal::scheduling_group_index(sg));
+        });
+    }).get();
+    // The test thread itself was not affected
+    BOOST_REQUIRE(current_scheduling_group() != sg);
+}
+
+SEASTAR_THREAD_TEST_CASE(migrate_to_scheduling_group_in_thread) {
+    scheduling_group sg = create_scheduling_group("sg-migrate-thread", 100).get0();
+    auto cleanup = defer([&] () noexcept { destroy_scheduling_group(sg).get(); });
+    auto prev = current_scheduling_group();
+    migrate_to_scheduling_group(sg).get();
+    BOOST_REQUIRE_EQUAL(
+            internal::scheduling_group_index(current_scheduling_group()),
+            internal::scheduling_group_index(sg));
+    // The migration is sticky across later wakeups of the thread
+    thread::yield();
+    BOOST_REQUIRE_EQUAL(
+            internal::scheduling_group_index(current_scheduling_group()),
+            internal::scheduling_group_index(sg));
+    // Move back so the group can be destroyed
+    migrate_to_scheduling_group(prev).get();
+    BOOST_REQUIRE(current_scheduling_group() == prev);
+}
+
+SEASTAR_THREAD_TEST_CASE(sg_shed_hook_fires_on_queue_delay) {
+    scheduling_group sg = create_scheduling_group("sg-shed", 100).get0();
+    auto cleanup = defer([&] () noexcept { destroy_scheduling_group(sg).get(); });
+    int fired = 0;
+    sched_clock::duration seen{};
+    // A zero threshold makes any sampled delay cross it
+    sg.set_shed_hook(sched_clock::duration{}, [&] (sched_clock::duration d) {
+        ++fired;
+        seen = d;
+    });
+    // Queue enough tasks through the group to guarantee several delay samples
+    with_scheduling_group(sg, [] {
+        return do_until([n = 0] () mutable { return n++ == 500; }, [] {
+            return yield();
+        });
+    }).get();
+    // The hook is edge-triggered: the delay never dropped back below the
+    // (zero) threshold, so it fired exactly once
+    BOOST_REQUIRE_EQUAL(fired, 1);
+    BOOST_REQUIRE(seen > sched_clock::duration{});
+    // An unreachable threshold re-arms the hook but never fires it
+    sg.set_shed_hook(std::chrono::hours(1), [&] (sched_clock::duration) { ++fired; });
+    with_scheduling_group(sg, [] {
+        return do_until([n = 0] () mutable { return n++ == 500; }, [] {
+            return yield();
+        });
+    }).get();
+    BOOST_REQUIRE_EQUAL(fired, 1);
+    // A disengaged function removes the hook
+    sg.set_shed_hook(sched_clock::duration{}, {});
+}
+
 SEASTAR_THREAD_TEST_CASE(sg_count) {
     class scheduling_group_destroyer {
         scheduling_group _sg;
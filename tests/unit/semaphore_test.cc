@@ -37,18 +37,22 @@ using namespace seastar;
 using namespace std::chrono_literals;
 
 SEASTAR_TEST_CASE(test_semaphore_consume) {
-    semaphore sem(0);
-    sem.consume(1);
-    BOOST_REQUIRE_EQUAL(sem.current(), 0u);
-    BOOST_REQUIRE_EQUAL(sem.waiters(), 0u);
-
-    BOOST_REQUIRE_EQUAL(sem.try_wait(0), false);
-    auto fut = sem.wait(1);
-    BOOST_REQUIRE_EQUAL(fut.available(), false);
-    BOOST_REQUIRE_EQUAL(sem.waiters(), 1u);
-    sem.signal(2);
-    BOOST_REQUIRE_EQUAL(sem.waiters(), 0u);
-    return make_ready_future<>();
+    return do_with(semaphore(0), [] (semaphore& sem) {
+        sem.consume(1);
+        BOOST_REQUIRE_EQUAL(sem.current(), 0u);
+        BOOST_REQUIRE_EQUAL(sem.waiters(), 0u);
+
+        BOOST_REQUIRE_EQUAL(sem.try_wait(0), false);
+        auto fut = sem.wait(1);
+        BOOST_REQUIRE_EQUAL(fut.available(), false);
+        BOOST_REQUIRE_EQUAL(sem.waiters(), 1u);
+        sem.signal(2);
+        // wakeups are batched into a deferred drain task
+        BOOST_REQUIRE_EQUAL(sem.waiters(), 1u);
+        return fut.then([&sem] {
+            BOOST_REQUIRE_EQUAL(sem.waiters(), 0u);
+        });
+    });
 }
 
 SEASTAR_TEST_CASE(test_semaphore_1) {
@@ -75,6 +79,23 @@ SEASTAR_THREAD_TEST_CASE(test_semaphore_2) {
     BOOST_CHECK_THROW(fut.get(), broken_promise);
 }
 
+#ifndef SEASTAR_SEMAPHORE_DEBUG
+SEASTAR_THREAD_TEST_CASE(test_semaphore_move_with_pending_wakeup) {
+    // Moving a semaphore while a deferred drain task is pending must
+    // re-home the task to the new address; the old address may be freed
+    // before the task runs.
+    auto sem = std::make_optional<semaphore>(0);
+    auto fut = sem->wait();
+    sem->signal();
+    auto moved = std::move(*sem);
+    sem = std::nullopt;
+    fut.get();
+    BOOST_REQUIRE_EQUAL(moved.current(), 0u);
+    moved.signal();
+    moved.wait().get();
+}
+#endif
+
 SEASTAR_TEST_CASE(test_semaphore_timeout_1) {
     return do_with(std::make_pair(semaphore(0), 0), [] (std::pair<semaphore, int>& x) {
         (void)x.first.wait(100ms).then([&x] {
@@ -431,3 +452,41 @@ SEASTAR_THREAD_TEST_CASE(test_semaphore_abort_before_wait) {
     BOOST_CHECK_THROW(fut1.get(), semaphore_aborted);
     BOOST_REQUIRE_EQUAL(x, 0);
 }
+
+SEASTAR_THREAD_TEST_CASE(test_waiter_registry) {
+    auto find_entry = [] (const char* kind, const sstring& name) -> std::optional<waiter_registry_entry> {
+        for (auto& e : dump_waiter_registry()) {
+            if (e.kind == std::string_view(kind) && e.name == name) {
+                return e;
+            }
+        }
+        return std::nullopt;
+    };
+
+    auto sem = semaphore(0);
+    sem.track_waiters("test_sem");
+    BOOST_REQUIRE(!find_entry("semaphore", "test_sem"));
+
+    auto fut1 = sem.wait();
+    auto fut2 = sem.wait();
+    auto e = find_entry("semaphore", "test_sem");
+    BOOST_REQUIRE(e);
+    BOOST_REQUIRE_EQUAL(e->waiters, 2u);
+    BOOST_REQUIRE(e->oldest_waiter_age >= std::chrono::steady_clock::duration::zero());
+
+    sem.signal(2);
+    fut1.get();
+    fut2.get();
+    BOOST_REQUIRE(!find_entry("semaphore", "test_sem"));
+
+    shared_mutex sm;
+    sm.track_waiters("test_mutex");
+    sm.lock().get();
+    auto wf = sm.lock_shared();
+    e = find_entry("shared_mutex", "test_mutex");
+    BOOST_REQUIRE(e);
+    BOOST_REQUIRE_EQUAL(e->waiters, 1u);
+    sm.unlock();
+    wf.get();
+    BOOST_REQUIRE(!find_entry("shared_mutex", "test_mutex"));
+}
@@ -107,6 +107,55 @@ SEASTAR_THREAD_TEST_CASE(test_member_map_reduces) {
     c.stop().get();
 }
 
+SEASTAR_THREAD_TEST_CASE(test_map_reduce0_staged) {
+    sharded<peering_counter> c;
+    c.start().get();
+
+    BOOST_REQUIRE_EQUAL(c.map_reduce0_staged([] (peering_counter&) { return 1; }, 0, std::plus<int>()).get0(), smp::count);
+
+    c.stop().get();
+}
+
+SEASTAR_THREAD_TEST_CASE(test_map_reduce0_incremental) {
+    sharded<peering_counter> c;
+    c.start().get();
+
+    // Never stopping degenerates to a full gather
+    auto all = c.map_reduce0_incremental([] (peering_counter&) { return 1; }, 0,
+            [] (int& acc, int v) { acc += v; return stop_iteration::no; }).get0();
+    BOOST_REQUIRE_EQUAL(all, smp::count);
+
+    // Short-circuit once a majority of shards have answered
+    auto quorum = int(smp::count / 2 + 1);
+    auto n = c.map_reduce0_incremental([] (peering_counter&) { return 1; }, 0,
+            [quorum] (int& acc, int v) {
+        acc += v;
+        return acc >= quorum ? stop_iteration::yes : stop_iteration::no;
+    }).get0();
+    BOOST_REQUIRE_EQUAL(n, quorum);
+
+    // A shard failure is tolerated as long as the reduction stops
+    if (smp::count > 1) {
+        auto survivors = c.map_reduce0_incremental([] (peering_counter&) -> int {
+            if (this_shard_id() == 0) {
+                throw std::runtime_error("injected");
+            }
+            return 1;
+        }, 0, [goal = int(smp::count - 1)] (int& acc, int v) {
+            acc += v;
+            return acc == goal ? stop_iteration::yes : stop_iteration::no;
+        }).get0();
+        BOOST_REQUIRE_EQUAL(survivors, int(smp::count - 1));
+    }
+
+    // ... and reported if it never does
+    BOOST_REQUIRE_THROW(c.map_reduce0_incremental([] (peering_counter&) -> int {
+        throw std::runtime_error("injected");
+    }, 0, [] (int& acc, int v) { acc += v; return stop_iteration::no; }).get(), std::runtime_error);
+
+    c.stop().get();
+}
+
 class mydata {
 public:
     int x = 1;
@@ -201,3 +250,33 @@ SEASTAR_THREAD_TEST_CASE(invoke_on_all_sharded_arg) {
     srv.stop().get();
     arg.stop().get();
 }
+
+class batched_counter {
+    int _calls = 0;
+public:
+    future<> stop() { return make_ready_future<>(); }
+    int add(int x) {
+        ++_calls;
+        return x + 1;
+    }
+    int calls() const { return _calls; }
+};
+
+SEASTAR_THREAD_TEST_CASE(batch_invoke_on_test) {
+    seastar::sharded<batched_counter> srv;
+    srv.start().get();
+
+    unsigned target = smp::count > 1 ? 1 : 0;
+    constexpr int n = 100;
+    std::vector<future<int>> results;
+    for (int i = 0; i < n; i++) {
+        results.push_back(srv.batch_invoke_on(target, &batched_counter::add, i));
+    }
+    for (int i = 0; i < n; i++) {
+        BOOST_REQUIRE_EQUAL(results[i].get0(), i + 1);
+    }
+    int calls = srv.invoke_on(target, &batched_counter::calls).get0();
+    BOOST_REQUIRE_EQUAL(calls, n);
+
+    srv.stop().get();
+}
@@ -97,3 +97,59 @@ BOOST_AUTO_TEST_CASE(fragmented_write_read_test) {
     }
     test();
 }
+
+template<typename Input>
+static void peek_read_array_test(Input in)
+{
+    // drain the stream through peek_contiguous()/skip(): the views must
+    // be non-empty, contiguous and cover the stream exactly
+    auto collected = std::vector<char>();
+    auto in2 = in;
+    while (in2.size()) {
+        auto flat = in2.peek_contiguous();
+        BOOST_CHECK(!flat.empty());
+        BOOST_CHECK(flat.size() <= in2.size());
+        collected.insert(collected.end(), flat.begin(), flat.end());
+        in2.skip(flat.size());
+    }
+    BOOST_CHECK(in2.peek_contiguous().empty());
+
+    auto expected = std::vector<char>(collected.size());
+    in.read(expected.data(), expected.size());
+    BOOST_CHECK_EQUAL(collected, expected);
+}
+
+template<typename Input, typename Output>
+static void make_peek_read_array_test(Input in, Output out)
+{
+    auto values = std::vector<uint16_t>{ 0x0101, 0x0202, 0x0303, 0x0404 };
+    out.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(uint16_t));
+    out.fill('x', 1);
+
+    peek_read_array_test(in);
+
+    auto actual = std::vector<uint16_t>(4);
+    in.read_array(actual.data(), actual.size());
+    BOOST_CHECK(values == actual);
+    BOOST_CHECK_EQUAL(in.size(), 1u);
+    BOOST_CHECK_THROW(in.read_array(actual.data(), 1), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(simple_peek_read_array_test) {
+    auto buf = temporary_buffer<char>(9);
+    make_peek_read_array_test(simple_memory_input_stream(buf.get(), buf.size()),
+                              simple_memory_output_stream(buf.get_write(), buf.size()));
+}
+
+BOOST_AUTO_TEST_CASE(fragmented_peek_read_array_test) {
+    static constexpr size_t total_size = 9;
+
+    auto bufs = std::vector<temporary_buffer<char>>();
+    using iterator_type = std::vector<temporary_buffer<char>>::iterator;
+
+    for (auto i = 0u; i < total_size; i++) {
+        bufs.emplace_back(1);
+    }
+    make_peek_read_array_test(fragmented_memory_input_stream<iterator_type>(bufs.begin(), total_size),
+                              fragmented_memory_output_stream<iterator_type>(bufs.begin(), total_size));
+}
@@ -21,10 +21,14 @@
 
 #include <seastar/core/reactor.hh>
 #include <seastar/core/smp.hh>
+#include <seastar/core/smp_channel.hh>
 #include <seastar/core/app-template.hh>
+#include <seastar/core/loop.hh>
 #include <seastar/core/print.hh>
+#include <seastar/core/sleep.hh>
 
 using namespace seastar;
+using namespace std::chrono_literals;
 
 future<bool> test_smp_call() {
     return smp::submit_to(1, [] {
@@ -58,6 +62,96 @@ future<bool> test_smp_exception() {
     });
 }
 
+future<bool> test_runtime_tunables() {
+    auto cfg = *engine().get_runtime_tunables();
+    cfg.max_task_backlog += 1;
+    auto target = cfg.max_task_backlog;
+    auto old_version = cfg.version;
+    return update_runtime_tunables(cfg).then([target, old_version] {
+        // the snapshot is applied by the periodic load timer, within ~1s
+        return do_with(unsigned(0), [target, old_version] (unsigned& tries) {
+            return repeat([&tries, target, old_version] {
+                auto snap = engine().get_runtime_tunables();
+                if (snap->version > old_version && snap->max_task_backlog == target) {
+                    return make_ready_future<stop_iteration>(stop_iteration::yes);
+                }
+                if (++tries > 50) {
+                    return make_exception_future<stop_iteration>(std::runtime_error("tunables not applied"));
+                }
+                return sleep(100ms).then([] { return stop_iteration::no; });
+            }).then_wrapped([] (future<> done) {
+                try {
+                    done.get();
+                    return true;
+                } catch (...) {
+                    return false;
+                }
+            });
+        });
+    });
+}
+
+future<bool> test_smp_channel() {
+    // Stream records to shard 1 through a channel much smaller than the
+    // stream, so the producer repeatedly blocks on flow control, and
+    // verify everything arrives in order.
+    constexpr unsigned n_records = 10000;
+    constexpr unsigned batch_size = 160; // > ring capacity, so write() spans several refills
+    auto chan = smp_channel<unsigned>(128);
+    auto consumer = smp::submit_to(1, [reader = std::move(chan.reader)] () mutable {
+        return do_with(std::move(reader), uint64_t(0), unsigned(0), [] (smp_channel_reader<unsigned>& reader, uint64_t& sum, unsigned& expected) {
+            return repeat([&reader, &sum, &expected] {
+                return reader.read().then([&sum, &expected] (chunked_fifo<unsigned> batch) {
+                    if (batch.empty()) {
+                        return stop_iteration::yes;
+                    }
+                    for (auto v : batch) {
+                        sum += v;
+                        expected += v == expected;
+                    }
+                    return stop_iteration::no;
+                });
+            }).then([&sum, &expected] {
+                return sum == uint64_t(n_records) * (n_records - 1) / 2 && expected == n_records;
+            });
+        });
+    });
+    auto producer = do_with(std::move(chan.writer), unsigned(0), [] (smp_channel_writer<unsigned>& writer, unsigned& next) {
+        return repeat([&writer, &next] {
+            if (next == n_records) {
+                return make_ready_future<stop_iteration>(stop_iteration::yes);
+            }
+            std::vector<unsigned> batch;
+            while (next != n_records && batch.size() != batch_size) {
+                batch.push_back(next++);
+            }
+            return writer.write(std::move(batch)).then([] {
+                return stop_iteration::no;
+            });
+        });
+    });
+    // the writer is destroyed when the producer finishes, which delivers
+    // eof to the reader
+    return producer.then([consumer = std::move(consumer)] () mutable {
+        return std::move(consumer);
+    });
+}
+
+future<bool> test_shard_heartbeat() {
+    // every running shard must have published a heartbeat by now, and
+    // none of them should look stalled against a generous threshold
+    for (auto cpu : smp::all_cpus()) {
+        if (smp::shard_heartbeat(cpu) == 0) {
+            return make_ready_future<bool>(false);
+        }
+        if (smp::shard_is_stalled(cpu, 1h)) {
+            return make_ready_future<bool>(false);
+        }
+    }
+    // out-of-range shards are never reported stalled
+    return make_ready_future<bool>(smp::shard_heartbeat(smp::count) == 0 && !smp::shard_is_stalled(smp::count, 0ns));
+}
+
 int tests, fails;
 
 future<>
@@ -73,6 +167,12 @@ int main(int ac, char** av) {
     return app_template().run_deprecated(ac, av, [] {
        return report("smp call", test_smp_call()).then([] {
            return report("smp exception", test_smp_exception());
+       }).then([] {
+           return report("runtime tunables", test_runtime_tunables());
+       }).then([] {
+           return report("shard heartbeat", test_shard_heartbeat());
+       }).then([] {
+           return report("smp channel", test_smp_channel());
        }).then([] {
            fmt::print("\n{:d} tests / {:d} failures\n", tests, fails);
            engine().exit(fails ? 1 : 0);
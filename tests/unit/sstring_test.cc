@@ -23,6 +23,7 @@
 
 #include <boost/test/unit_test.hpp>
 #include <seastar/core/sstring.hh>
+#include <limits>
 #include <list>
 
 using namespace seastar;
@@ -45,6 +46,11 @@ BOOST_AUTO_TEST_CASE(test_equality) {
 
 BOOST_AUTO_TEST_CASE(test_to_sstring) {
     BOOST_REQUIRE_EQUAL(to_sstring(1234567), sstring("1234567"));
+    BOOST_REQUIRE_EQUAL(to_sstring(-1234567), sstring("-1234567"));
+    BOOST_REQUIRE_EQUAL(to_sstring(std::numeric_limits<int64_t>::min()), sstring("-9223372036854775808"));
+    BOOST_REQUIRE_EQUAL(to_sstring(std::numeric_limits<uint64_t>::max()), sstring("18446744073709551615"));
+    BOOST_REQUIRE_EQUAL(to_sstring(0.5), sstring("0.5"));
+    BOOST_REQUIRE_EQUAL(to_sstring(true), sstring("true"));
 }
 
 BOOST_AUTO_TEST_CASE(test_add_literal_to_sstring) {
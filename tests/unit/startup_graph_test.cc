@@ -0,0 +1,93 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB
+ */
+
+#include <seastar/core/startup_graph.hh>
+#include <seastar/core/condition-variable.hh>
+#include <seastar/core/sleep.hh>
+#include <seastar/core/thread.hh>
+#include <seastar/testing/thread_test_case.hh>
+
+using namespace seastar;
+
+SEASTAR_THREAD_TEST_CASE(test_dependencies_order_steps) {
+    startup_graph g;
+    std::vector<int> order;
+    auto a = g.add_step("a", {}, [&] {
+        order.push_back(0);
+        return make_ready_future<>();
+    });
+    auto b = g.add_step("b", {a}, [&] {
+        order.push_back(1);
+        return make_ready_future<>();
+    });
+    g.add_step("c", {a, b}, [&] {
+        order.push_back(2);
+        return make_ready_future<>();
+    });
+    g.run().get();
+    BOOST_REQUIRE(order == (std::vector<int>{0, 1, 2}));
+}
+
+SEASTAR_THREAD_TEST_CASE(test_independent_steps_run_concurrently) {
+    startup_graph g;
+    condition_variable cv;
+    int running = 0;
+    // neither step can finish until both have started, so a serial
+    // execution would deadlock here
+    auto step = [&] {
+        ++running;
+        cv.broadcast();
+        return cv.wait([&] { return running == 2; });
+    };
+    g.add_step("left", {}, step);
+    g.add_step("right", {}, step);
+    g.run().get();
+    BOOST_REQUIRE_EQUAL(running, 2);
+}
+
+SEASTAR_THREAD_TEST_CASE(test_failure_skips_dependents_only) {
+    startup_graph g;
+    bool dependent_ran = false;
+    bool independent_ran = false;
+    auto bad = g.add_step("bad", {}, [] {
+        return make_exception_future<>(std::runtime_error("boom"));
+    });
+    g.add_step("dependent", {bad}, [&] {
+        dependent_ran = true;
+        return make_ready_future<>();
+    });
+    g.add_step("independent", {}, [&] {
+        independent_ran = true;
+        return make_ready_future<>();
+    });
+    BOOST_REQUIRE_THROW(g.run().get(), std::runtime_error);
+    BOOST_REQUIRE(!dependent_ran);
+    BOOST_REQUIRE(independent_ran);
+}
+
+SEASTAR_THREAD_TEST_CASE(test_step_duration_is_recorded) {
+    startup_graph g;
+    auto id = g.add_step("slow", {}, [] {
+        return sleep(std::chrono::milliseconds(10));
+    });
+    g.run().get();
+    BOOST_REQUIRE(g.step_duration(id) >= std::chrono::milliseconds(10));
+}
@@ -0,0 +1,119 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB
+ */
+
+#define BOOST_TEST_MODULE net
+
+#include <boost/test/unit_test.hpp>
+#include <seastar/net/tcp-cc.hh>
+
+using namespace seastar;
+using namespace seastar::net;
+
+static constexpr uint32_t smss = 1460;
+
+BOOST_AUTO_TEST_CASE(test_new_reno_window_growth) {
+    tcp_new_reno cc;
+    // RFC3390: 1095 < mss <= 2190 starts with three segments
+    cc.on_established(smss, 8192);
+    BOOST_REQUIRE_EQUAL(cc.window(), 3 * smss);
+
+    // Slow start: the window grows by one smss per smss acknowledged
+    cc.on_ack(smss, smss);
+    BOOST_REQUIRE_EQUAL(cc.window(), 4 * smss);
+
+    // Push past ssthresh (8192) into congestion avoidance
+    cc.on_ack(smss, smss);
+    cc.on_ack(smss, smss);
+    BOOST_REQUIRE_EQUAL(cc.window(), 6 * smss);
+    auto before = cc.window();
+    cc.on_ack(smss, smss);
+    // Congestion avoidance: roughly smss^2 / cwnd per ACK
+    BOOST_REQUIRE_EQUAL(cc.window(), before + smss * smss / before);
+}
+
+BOOST_AUTO_TEST_CASE(test_new_reno_loss_events) {
+    tcp_new_reno cc;
+    cc.on_established(smss, 65535);
+
+    // Entering fast retransmit halves the flight into ssthresh and
+    // inflates the window by the three duplicate ACKs
+    cc.on_fast_retransmit(10 * smss, 0, smss, true);
+    BOOST_REQUIRE_EQUAL(cc.window(), 5 * smss + 3 * smss);
+
+    // Every further duplicate ACK inflates by one smss
+    cc.on_dup_ack(smss);
+    BOOST_REQUIRE_EQUAL(cc.window(), 9 * smss);
+
+    // A partial ACK deflates by the acknowledged amount, adding back
+    // one smss when at least a full segment was covered
+    cc.on_partial_ack(2 * smss, smss);
+    BOOST_REQUIRE_EQUAL(cc.window(), 8 * smss);
+
+    // A full ACK deflates back to at most ssthresh
+    cc.on_full_ack(4 * smss, smss);
+    BOOST_REQUIRE_EQUAL(cc.window(), 5 * smss);
+
+    // The first RTO collapses the window to one segment and re-arms
+    // slow start from half the flight
+    cc.on_rto(8 * smss, smss, true);
+    BOOST_REQUIRE_EQUAL(cc.window(), smss);
+
+    // The ssthresh floor is two segments
+    cc.on_rto(smss, smss, true);
+    BOOST_REQUIRE_EQUAL(cc.window(), smss);
+    cc.on_ack(smss, smss);
+    BOOST_REQUIRE_EQUAL(cc.window(), 2 * smss);
+}
+
+BOOST_AUTO_TEST_CASE(test_bbr_loss_tolerance) {
+    tcp_bbr cc;
+    cc.on_established(smss, 65535);
+    BOOST_REQUIRE_EQUAL(cc.window(), 4 * smss);
+
+    // Startup probes for bandwidth the way slow start does
+    cc.on_ack(smss, smss);
+    BOOST_REQUIRE_EQUAL(cc.window(), 5 * smss);
+
+    // Loss indications do not collapse the window
+    auto before = cc.window();
+    cc.on_fast_retransmit(4 * smss, 0, smss, true);
+    cc.on_dup_ack(smss);
+    cc.on_partial_ack(smss, smss);
+    cc.on_full_ack(2 * smss, smss);
+    BOOST_REQUIRE_EQUAL(cc.window(), before);
+
+    // Without a rate estimate there is no pacing
+    BOOST_REQUIRE_EQUAL(cc.pacing_allowance(10 * smss), 10 * smss);
+
+    // An RTO restarts from a modest, non-zero window
+    cc.on_rto(5 * smss, smss, true);
+    BOOST_REQUIRE_EQUAL(cc.window(), 4 * smss);
+}
+
+BOOST_AUTO_TEST_CASE(test_congestion_control_factory) {
+    auto reno = make_tcp_congestion_control(tcp_congestion_algorithm::new_reno);
+    auto bbr = make_tcp_congestion_control(tcp_congestion_algorithm::bbr);
+    reno->on_established(smss, 65535);
+    bbr->on_established(smss, 65535);
+    // The policies size their initial windows differently
+    BOOST_REQUIRE_EQUAL(reno->window(), 3 * smss);
+    BOOST_REQUIRE_EQUAL(bbr->window(), 4 * smss);
+}
@@ -0,0 +1,89 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB
+ */
+
+#define BOOST_TEST_MODULE core
+
+#include <boost/test/unit_test.hpp>
+#include <seastar/core/temporary_buffer.hh>
+#include <algorithm>
+#include <cstring>
+
+using namespace seastar;
+
+static bool stored_inside(const temporary_buffer<char>& buf) {
+    auto p = reinterpret_cast<uintptr_t>(buf.get());
+    auto obj = reinterpret_cast<uintptr_t>(&buf);
+    return p >= obj && p < obj + sizeof(buf);
+}
+
+BOOST_AUTO_TEST_CASE(test_small_buffers_are_stored_inline) {
+    temporary_buffer<char> small(temporary_buffer<char>::internal_size);
+    BOOST_REQUIRE(stored_inside(small));
+
+    temporary_buffer<char> large(temporary_buffer<char>::internal_size + 1);
+    BOOST_REQUIRE(!stored_inside(large));
+
+    // aligned() must keep its alignment guarantee, so it is always external
+    auto aligned = temporary_buffer<char>::aligned(4096, 4096);
+    BOOST_REQUIRE(!stored_inside(aligned));
+}
+
+BOOST_AUTO_TEST_CASE(test_move_preserves_contents) {
+    auto buf = temporary_buffer<char>::copy_of("hello, world");
+    BOOST_REQUIRE(stored_inside(buf));
+    auto moved = std::move(buf);
+    BOOST_REQUIRE_EQUAL(std::string_view(moved.get(), moved.size()), "hello, world");
+    BOOST_REQUIRE(!buf.size());
+}
+
+BOOST_AUTO_TEST_CASE(test_share_promotes_to_stable_storage) {
+    temporary_buffer<char> shared;
+    {
+        auto buf = temporary_buffer<char>::copy_of("transient");
+        shared = buf.share();
+        BOOST_REQUIRE(!stored_inside(shared));
+        BOOST_REQUIRE_EQUAL(shared.get(), buf.get());
+    }
+    // the original is gone; the shared view must still be readable
+    BOOST_REQUIRE_EQUAL(std::string_view(shared.get(), shared.size()), "transient");
+}
+
+BOOST_AUTO_TEST_CASE(test_release_promotes_to_stable_storage) {
+    auto buf = temporary_buffer<char>::copy_of("released");
+    auto d = buf.release();
+    BOOST_REQUIRE(!stored_inside(buf));
+    auto* p = buf.get();
+    {
+        auto dead = std::move(buf);
+    }
+    // the data is owned by the deleter now, not by the buffer object
+    BOOST_REQUIRE_EQUAL(std::string_view(p, 8), "released");
+}
+
+BOOST_AUTO_TEST_CASE(test_trim_and_clone_small) {
+    auto buf = temporary_buffer<char>::copy_of("0123456789");
+    buf.trim_front(2);
+    buf.trim(5);
+    BOOST_REQUIRE_EQUAL(std::string_view(buf.get(), buf.size()), "23456");
+    auto copy = buf.clone();
+    BOOST_REQUIRE(copy == buf);
+    BOOST_REQUIRE(copy.get() != buf.get());
+}
@@ -262,3 +262,44 @@ seastar::future<> test_thread_custom_stack_size_failure::run_test_case() const {
     });
 }
 #endif // SEASTAR_THREAD_STACK_GUARDS && __x86_64__
+
+SEASTAR_TEST_CASE(test_thread_arena_allocator) {
+    thread_attributes attr;
+    attr.arena_size = 64 * 1024;
+    return async(attr, [] {
+        auto allocator = thread_arena_allocator<char>();
+        auto* p1 = allocator.allocate(1024);
+        auto* p2 = allocator.allocate(1024);
+        // bump allocation: consecutive allocations come from the same arena
+        BOOST_REQUIRE(p2 > p1);
+        BOOST_REQUIRE(size_t(p2 - p1) >= 1024);
+        allocator.deallocate(p1, 1024);
+        allocator.deallocate(p2, 1024);
+
+        // an explicit epoch recycles the arena in one pointer reset
+        thread::reset_arena();
+        auto* p3 = allocator.allocate(1024);
+        BOOST_REQUIRE(p3 == p1);
+        allocator.deallocate(p3, 1024);
+        thread::reset_arena();
+
+        // requests the arena cannot satisfy fall back to the global
+        // allocator and must be freed for real
+        auto* big = allocator.allocate(1024 * 1024);
+        BOOST_REQUIRE(big != nullptr);
+        allocator.deallocate(big, 1024 * 1024);
+
+        // containers work through the adaptor
+        auto v = std::vector<int, thread_arena_allocator<int>>();
+        for (int i = 0; i < 1000; i++) {
+            v.push_back(i);
+        }
+        BOOST_REQUIRE_EQUAL(v.size(), 1000u);
+    }).then([] {
+        // outside a thread the adaptor is a plain global-allocator shim
+        auto allocator = thread_arena_allocator<char>();
+        auto* p = allocator.allocate(16);
+        BOOST_REQUIRE(p != nullptr);
+        allocator.deallocate(p, 16);
+    });
+}
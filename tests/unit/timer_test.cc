@@ -49,6 +49,7 @@ struct timer_test {
     timer<Clock> t5;
     promise<> pr1;
     promise<> pr2;
+    promise<> pr3;
 
     future<> run() {
         t1.set_callback([this] {
@@ -74,6 +75,8 @@ struct timer_test {
         t5.arm(800ms);
 
         return pr1.get_future().then([this] { return test_timer_cancelling(); }).then([this] {
+            return test_timer_postponing();
+        }).then([this] {
             return test_timer_with_scheduling_groups();
         });
     }
@@ -92,6 +95,22 @@ struct timer_test {
         return pr2.get_future().then([&t1] { delete &t1; });
     }
 
+    future<> test_timer_postponing() {
+        timer<Clock>& t1 = *new timer<Clock>();
+        auto start = Clock::now();
+        t1.set_callback([this, start] {
+            if (Clock::now() - start < 250ms) {
+                BUG();
+            }
+            OK();
+            fmt::print("postponed timer expired\n");
+            pr3.set_value();
+        });
+        t1.arm(100ms);
+        t1.postpone(start + 300ms);
+        return pr3.get_future().then([&t1] { delete &t1; });
+    }
+
     future<> test_timer_with_scheduling_groups() {
         return async([] {
             auto sg1 = create_scheduling_group("sg1", 100).get0();
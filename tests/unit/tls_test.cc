@@ -561,7 +561,9 @@ static future<> run_echo_test(sstring message,
                 sstring client_key = {},
                 bool do_read = true,
                 bool use_dh_params = true,
-                tls::dn_callback distinguished_name_callback = {}
+                tls::dn_callback distinguished_name_callback = {},
+                bool offload_handshake = false,
+                bool kernel_tls = false
 )
 {
     static const auto port = 4711;
@@ -582,6 +584,13 @@ static future<> run_echo_test(sstring message,
         }
     }
 
+    if (offload_handshake) {
+        certs->enable_handshake_offload();
+    }
+    if (kernel_tls) {
+        certs->enable_kernel_tls();
+    }
+
     return f.then([=] {
         return certs->set_x509_trust_file(trust, tls::x509_crt_format::PEM);
     }).then([=] {
@@ -654,6 +663,40 @@ SEASTAR_TEST_CASE(test_simple_x509_client_server_again) {
     return run_echo_test(message, 20, certfile("catest.pem"), "test.scylladb.org");
 }
 
+SEASTAR_TEST_CASE(test_simple_x509_client_server_offloaded_handshake) {
+    return run_echo_test(message, 20, certfile("catest.pem"), "test.scylladb.org",
+        certfile("test.crt"), certfile("test.key"), tls::client_auth::NONE,
+        {}, {}, true, true, {}, /* offload_handshake */ true);
+}
+
+SEASTAR_TEST_CASE(test_session_ticket_key_management) {
+    tls::credentials_builder b;
+    BOOST_REQUIRE(b.get_session_ticket_key().empty());
+    b.enable_session_tickets();
+    auto key = b.get_session_ticket_key();
+    BOOST_REQUIRE(!key.empty());
+    // a copy of the builder carries the same key, so credentials built
+    // from it on other shards can resume this shard's sessions
+    auto copy = b;
+    BOOST_REQUIRE(copy.get_session_ticket_key() == key);
+    b.rotate_session_ticket_key();
+    BOOST_REQUIRE(b.get_session_ticket_key() != key);
+    // the key survives building; a ticket-enabled server must still
+    // hand-shake regular clients
+    b.set_dh_level(tls::dh_params::level::MEDIUM);
+    auto creds = b.build_server_credentials();
+    BOOST_REQUIRE(creds);
+    return make_ready_future<>();
+}
+
+// Must pass whether or not the kernel supports TLS offload; the session
+// falls back to userspace record processing when it does not.
+SEASTAR_TEST_CASE(test_simple_x509_client_server_kernel_tls) {
+    return run_echo_test(message, 20, certfile("catest.pem"), "test.scylladb.org",
+        certfile("test.crt"), certfile("test.key"), tls::client_auth::NONE,
+        {}, {}, true, true, {}, false, /* kernel_tls */ true);
+}
+
 #if GNUTLS_VERSION_NUMBER >= 0x030600
 // Test #769 - do not set dh_params in server certs - let gnutls negotiate.
 SEASTAR_TEST_CASE(test_simple_server_default_dhparams) {
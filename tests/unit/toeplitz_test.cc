@@ -0,0 +1,65 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB
+ */
+
+#define BOOST_TEST_MODULE net
+
+#include <boost/test/unit_test.hpp>
+#include <seastar/net/toeplitz.hh>
+#include <array>
+#include <random>
+
+using namespace seastar;
+
+// The local-port steering in tcp::connect() relies on the Toeplitz hash
+// being linear in any single input byte: the hash of a tuple must equal
+// the hash of the tuple with that byte zeroed, XORed with the byte's
+// tabulated contribution.
+BOOST_AUTO_TEST_CASE(test_toeplitz_byte_contrib) {
+    std::default_random_engine eng(42);
+    std::uniform_int_distribution<unsigned> dist(0, 255);
+
+    for (auto key : { default_rsskey_40bytes, default_rsskey_52bytes }) {
+        // One table per byte of the TCP/IPv4 RSS tuple
+        std::vector<std::array<uint32_t, 256>> tables;
+        for (size_t off = 0; off < 12; off++) {
+            tables.push_back(toeplitz_byte_contrib(key, off));
+        }
+
+        for (int round = 0; round < 100; round++) {
+            std::array<uint8_t, 12> tuple;
+            for (auto& b : tuple) {
+                b = dist(eng);
+            }
+            auto hash = toeplitz_hash(key, tuple);
+
+            for (size_t off = 0; off < tuple.size(); off++) {
+                auto zeroed = tuple;
+                zeroed[off] = 0;
+                BOOST_REQUIRE_EQUAL(hash, toeplitz_hash(key, zeroed) ^ tables[off][tuple[off]]);
+            }
+
+            // Both port bytes at once, as connect() does it
+            auto zeroed = tuple;
+            zeroed[10] = zeroed[11] = 0;
+            BOOST_REQUIRE_EQUAL(hash, toeplitz_hash(key, zeroed) ^ tables[10][tuple[10]] ^ tables[11][tuple[11]]);
+        }
+    }
+}
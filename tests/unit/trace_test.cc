@@ -0,0 +1,81 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB
+ */
+
+#include <seastar/testing/test_case.hh>
+#include <seastar/testing/thread_test_case.hh>
+#include <seastar/core/trace.hh>
+#include <seastar/core/internal/trace.hh>
+#include <seastar/core/sleep.hh>
+#include <seastar/util/file.hh>
+#include <seastar/util/later.hh>
+#include <seastar/util/tmp_file.hh>
+#include <cstring>
+
+using namespace seastar;
+
+SEASTAR_THREAD_TEST_CASE(test_trace_toggle_and_record_order) {
+    BOOST_REQUIRE(!tracing_enabled());
+    set_tracing_enabled(true);
+    BOOST_REQUIRE(tracing_enabled());
+
+    // Run a few tasks so the reactor probes emit records
+    for (int i = 0; i < 10; i++) {
+        yield().get();
+    }
+
+    auto records = internal::local_trace_ring().snapshot();
+    BOOST_REQUIRE(!records.empty());
+    for (size_t i = 1; i < records.size(); i++) {
+        BOOST_REQUIRE_LE(records[i - 1].ts_ns, records[i].ts_ns);
+    }
+
+    set_tracing_enabled(false);
+    BOOST_REQUIRE(!tracing_enabled());
+    auto before = internal::local_trace_ring().snapshot().size();
+    yield().get();
+    // Disabled tracing must not grow the ring
+    BOOST_REQUIRE_EQUAL(internal::local_trace_ring().snapshot().size(), before);
+}
+
+SEASTAR_THREAD_TEST_CASE(test_trace_dump_format) {
+    set_tracing_enabled(true);
+    for (int i = 0; i < 10; i++) {
+        yield().get();
+    }
+    set_tracing_enabled(false);
+
+    tmp_dir::do_with_thread([] (tmp_dir& td) {
+        auto path = (td.get_path() / "trace.bin").native();
+        dump_trace(path).get();
+
+        auto data = util::read_entire_file_contiguous(path).get0();
+        internal::trace_file_header hdr;
+        BOOST_REQUIRE_GE(data.size(), sizeof(hdr));
+        std::memcpy(&hdr, data.data(), sizeof(hdr));
+        BOOST_REQUIRE_EQUAL(std::string(hdr.magic, 8), "SSTRACE1");
+        BOOST_REQUIRE_EQUAL(hdr.shard, this_shard_id());
+        BOOST_REQUIRE_EQUAL(hdr.record_size, sizeof(internal::trace_record));
+        // The payload is a whole number of records, and not empty
+        auto payload = data.size() - sizeof(hdr);
+        BOOST_REQUIRE(payload > 0);
+        BOOST_REQUIRE_EQUAL(payload % sizeof(internal::trace_record), 0);
+    }).get();
+}
@@ -152,3 +152,169 @@ SEASTAR_TEST_CASE(test_websocket_handler_registration) {
         BOOST_REQUIRE_EQUAL(rs_frame, response_str);
     });
 }
+
+SEASTAR_TEST_CASE(test_websocket_unmasking) {
+    return seastar::async([] {
+        loopback_connection_factory factory;
+        loopback_socket_impl lsi(factory);
+
+        auto acceptor = factory.get_server_socket().accept();
+        auto connector = lsi.connect(socket_address(), socket_address());
+        connected_socket sock = connector.get0();
+        auto input = sock.input();
+        auto output = sock.output();
+
+        // Setup server
+        websocket::server ws;
+        ws.register_handler("echo", [] (input_stream<char>& in,
+                        output_stream<char>& out) {
+            return repeat([&in, &out]() {
+                return in.read().then([&out](temporary_buffer<char> f) {
+                    if (f.empty()) {
+                        return make_ready_future<stop_iteration>(stop_iteration::yes);
+                    } else {
+                        return out.write(std::move(f)).then([&out]() {
+                            return out.flush().then([] {
+                                return make_ready_future<stop_iteration>(stop_iteration::no);
+                            });
+                        });
+                    }
+                });
+            });
+        });
+        websocket::connection conn(ws, acceptor.get0().connection);
+        future<> serve = conn.process();
+
+        auto close = defer([&conn, &input, &output, &serve] () noexcept {
+            conn.close().get();
+            input.close().get();
+            output.close().get();
+            serve.get();
+         });
+
+        // handshake
+        const std::string request =
+                "GET / HTTP/1.1\r\n"
+                "Upgrade: websocket\r\n"
+                "Connection: Upgrade\r\n"
+                "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+                "Sec-WebSocket-Version: 13\r\n"
+                "Sec-WebSocket-Protocol: echo\r\n"
+                "\r\n";
+        output.write(request).get();
+        output.flush().get();
+        input.read_exactly(186).get();
+
+        // A payload longer than 8 bytes and not a multiple of it, so
+        // unmasking covers both the word-wide stride and the byte tail
+        const std::string message = "HELLOWORLD123";
+        std::string masked = message;
+        const char key[4] = {'T', 'E', 'S', 'T'};
+        for (size_t i = 0; i < masked.size(); i++) {
+            masked[i] ^= key[i % 4];
+        }
+        const auto ws_frame = std::string("\202\215"
+            "TEST", 6) + masked;
+        const auto rs_frame = std::string("\202\015", 2) + message;
+        output.write(ws_frame).get();
+        output.flush().get();
+
+        auto response = input.read_exactly(rs_frame.size()).get();
+        auto response_str = std::string(response.begin(), response.end());
+        BOOST_REQUIRE_EQUAL(rs_frame, response_str);
+    });
+}
+
+SEASTAR_TEST_CASE(test_websocket_permessage_deflate) {
+    return seastar::async([] {
+        loopback_connection_factory factory;
+        loopback_socket_impl lsi(factory);
+
+        auto acceptor = factory.get_server_socket().accept();
+        auto connector = lsi.connect(socket_address(), socket_address());
+        connected_socket sock = connector.get0();
+        auto input = sock.input();
+        auto output = sock.output();
+
+        // Setup server
+        websocket::server ws;
+        ws.register_handler("echo", [] (input_stream<char>& in,
+                        output_stream<char>& out) {
+            return repeat([&in, &out]() {
+                return in.read().then([&out](temporary_buffer<char> f) {
+                    if (f.empty()) {
+                        return make_ready_future<stop_iteration>(stop_iteration::yes);
+                    } else {
+                        return out.write(std::move(f)).then([&out]() {
+                            return out.flush().then([] {
+                                return make_ready_future<stop_iteration>(stop_iteration::no);
+                            });
+                        });
+                    }
+                });
+            });
+        });
+        websocket::connection conn(ws, acceptor.get0().connection);
+        future<> serve = conn.process();
+
+        auto close = defer([&conn, &input, &output, &serve] () noexcept {
+            conn.close().get();
+            input.close().get();
+            output.close().get();
+            serve.get();
+         });
+
+        // handshake offering permessage-deflate
+        const std::string request =
+                "GET / HTTP/1.1\r\n"
+                "Upgrade: websocket\r\n"
+                "Connection: Upgrade\r\n"
+                "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+                "Sec-WebSocket-Version: 13\r\n"
+                "Sec-WebSocket-Protocol: echo\r\n"
+                "Sec-WebSocket-Extensions: permessage-deflate; client_max_window_bits\r\n"
+                "\r\n";
+        output.write(request).get();
+        output.flush().get();
+        http_response_parser parser;
+        parser.init();
+        input.consume(parser).get();
+        std::unique_ptr<http_response> resp = parser.get_parsed_response();
+        BOOST_ASSERT(resp);
+        sstring extensions = resp->_headers["Sec-WebSocket-Extensions"];
+        BOOST_REQUIRE(extensions.find("permessage-deflate") != sstring::npos);
+
+        // A compressed frame carrying "TEST": raw deflate with the
+        // trailing empty stored block stripped (RFC 7692 7.2.1), RSV1
+        // set, masked with an all-zero key
+        const auto ws_frame = std::string(
+            "\302\206"           // FIN | RSV1 | BINARY, masked, length 6
+            "\0\0\0\0"           // Masking key
+            "\012\161\015\016\001\000", 12);
+        output.write(ws_frame).get();
+        output.flush().get();
+
+        // The echoed payload is 4 bytes, below the compression
+        // threshold, so it comes back as a plain frame
+        const auto rs_frame = std::string("\202\004TEST", 6);
+        auto response = input.read_exactly(rs_frame.size()).get();
+        auto response_str = std::string(response.begin(), response.end());
+        BOOST_REQUIRE_EQUAL(rs_frame, response_str);
+
+        // A repetitive message longer than the threshold must come back
+        // compressed: RSV1 set and the payload much shorter than the
+        // original
+        const std::string message(256, 'A');
+        const auto long_frame = std::string("\202\376\001\000"  // masked, 16-bit length 256
+            "\0\0\0\0", 8) + message;
+        output.write(long_frame).get();
+        output.flush().get();
+
+        auto header = input.read_exactly(2).get();
+        BOOST_REQUIRE_EQUAL(uint8_t(header[0]), 0xC2); // FIN | RSV1 | BINARY
+        uint8_t payload_length = uint8_t(header[1]);
+        BOOST_REQUIRE(payload_length > 0 && payload_length < message.size());
+        // drain the compressed payload
+        input.read_exactly(payload_length).get();
+    });
+}
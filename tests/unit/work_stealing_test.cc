@@ -0,0 +1,67 @@
+/*
+ * This file is open source software, licensed to you under the terms
+ * of the Apache License, Version 2.0 (the "License").  See the NOTICE file
+ * distributed with this work for additional information regarding copyright
+ * ownership.  You may not use this file except in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*
+ * Copyright (C) 2026 ScyllaDB Ltd.
+ */
+
+#include <seastar/testing/test_case.hh>
+#include <seastar/testing/thread_test_case.hh>
+#include <seastar/core/work_stealing.hh>
+#include <seastar/core/smp.hh>
+#include <atomic>
+#include <memory>
+
+using namespace seastar;
+
+SEASTAR_THREAD_TEST_CASE(test_local_submit_and_drain) {
+    work_stealing_pool pool;
+    unsigned ran = 0;
+    constexpr unsigned count = 100;
+    for (unsigned i = 0; i < count; ++i) {
+        pool.submit([&ran] {
+            ++ran;
+            return make_ready_future<>();
+        });
+    }
+    BOOST_REQUIRE_EQUAL(pool.size(), count);
+    pool.drain().get();
+    BOOST_REQUIRE_EQUAL(ran, count);
+    BOOST_REQUIRE_EQUAL(pool.size(), 0u);
+    BOOST_REQUIRE(!pool.try_get());
+}
+
+SEASTAR_THREAD_TEST_CASE(test_idle_shards_steal_skewed_backlog) {
+    auto pool = std::make_shared<work_stealing_pool>();
+    auto ran = std::make_shared<std::atomic<unsigned>>(0);
+    constexpr unsigned count = 1000;
+    // Submit everything on shard 0 to create maximum skew...
+    for (unsigned i = 0; i < count; ++i) {
+        pool->submit([ran] {
+            ran->fetch_add(1, std::memory_order_relaxed);
+            return make_ready_future<>();
+        });
+    }
+    BOOST_REQUIRE_EQUAL(pool->size(), count);
+    // ...and drain from every shard: with more than one shard most of the
+    // backlog is consumed via stealing.
+    smp::invoke_on_all([pool] {
+        return pool->drain();
+    }).get();
+    BOOST_REQUIRE_EQUAL(ran->load(), count);
+    BOOST_REQUIRE_EQUAL(pool->size(), 0u);
+}